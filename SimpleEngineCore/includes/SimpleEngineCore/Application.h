@@ -3,10 +3,20 @@
 #include "SimpleEngineCore/Event.h"
 #include "SimpleEngineCore/Camera.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 namespace SimpleEngine {
 
+	// how frames are paced, vsync modes wait in swap on render thread, fixed rate waits on main thread before input
+	enum class FramePacing {
+		VSync,			// every vblank, no tearing
+		AdaptiveVSync,	// vsync, frame which missed vblank is shown at once and tears (vsync when not supported)
+		Uncapped,		// as fast as possible, for benchmarks
+		FixedRate		// no vsync, frames start at frame_rate_limit, saves power when display is faster
+	};
+
 	class Application {
 	public:
 		Application();
@@ -51,9 +61,183 @@ namespace SimpleEngine {
 
 		bool scroll = false;
 		bool scrollUp = false;
+
+		// LOD is switched when simplification error on the screen is bigger than this
+		float lod_pixel_error = 1.f;
+
+		// cascaded shadow of directional light
+		bool use_shadows = true;
+		float shadow_distance = 50.f;		// view depth where the last cascade ends
+		float shadow_split_lambda = 0.75f;	// 0 - uniform cascade splits, 1 - logarithmic
+
+		// positions only pass first, color pass then shades each pixel once (GL_EQUAL)
+		bool use_depth_prepass = true;
+		// float depth with far values near 0, infinite far plane
+		bool use_reverse_z = true;
+		// render thread draws with camera moved by input of the frame built while it renders (one frame less latency)
+		bool use_camera_late_latch = false;
+
+		// random point lights in addition to UI lights, to see how clustered lighting scales
+		size_t demo_lights_count = 0;
+
+		// entities behind ground and wall are not submitted, occluders are rasterized on CPU every frame
+		bool use_occlusion_culling = true;
+		// random small cubes around the wall, to see how much occlusion culling saves
+		size_t demo_objects_count = 0;
+		// demo objects are culled by compute shader against previous frame depth and drawn by one indirect call
+		bool use_gpu_driven = false;
+
+		// OpenGL submission on own thread overlapped with simulation of the next frame
+		// has to be set before start, ImGui viewports (separate OS windows) work only without it
+		bool use_render_thread = true;
+
+		// applied every frame, can be changed at any time
+		FramePacing frame_pacing = FramePacing::VSync;
+		float frame_rate_limit = 60.f;
+
+		// stats of the last rendered frame
+		size_t frame_draw_calls = 0;
+		size_t frame_triangles = 0;
+		float frame_cpu_time_ms = 0.f;
+		float frame_render_time_ms = 0.f;
+		float frame_latency_ms = 0.f;
+		size_t frame_lights = 0;
+		float frame_light_culling_ms = 0.f;	// assigning lights to clusters on main thread
+		static constexpr size_t s_max_shadow_cascades = 4;
+		float frame_shadow_cascade_ms[s_max_shadow_cascades] = {};	// GPU time of shadow pass per cascade
+		size_t frame_shadow_static_redraws = 0;	// cascades whose cached static casters were redrawn
+		uint64_t frame_prepass_fragments = 0;	// fragment shader invocations of depth pre-pass
+		uint64_t frame_color_fragments = 0;		// fragment shader invocations of color pass
+		size_t frame_culling_tested = 0;		// entities with bounds
+		size_t frame_frustum_culled = 0;
+		size_t frame_occlusion_culled = 0;
+		float frame_occlusion_ms = 0.f;			// occluder rasterization and draw list build with culling
+		size_t frame_gpu_instances = 0;			// sent to GPU driven renderer
+		size_t frame_gpu_visible_instances = 0;	// survived GPU culling, a few frames old
+		float frame_gpu_cull_ms = 0.f;			// GPU time of culling compute shader
+
+		// input event timestamp to end of swap of the frame which showed it, the last frames with input
+		static constexpr size_t s_input_latency_history = 240;
+		float input_latency_history[s_input_latency_history] = {};	// oldest first
+		size_t input_latency_samples = 0;
+		float input_latency_p50_ms = 0.f;
+		float input_latency_p95_ms = 0.f;
+		float input_latency_p99_ms = 0.f;
+		float input_latency_max_ms = 0.f;
+
+		// end of swap to end of the next swap of the last frames, stddev and p99 show stutter
+		static constexpr size_t s_frame_interval_history = 240;
+		float frame_interval_history[s_frame_interval_history] = {};	// oldest first
+		size_t frame_interval_samples = 0;
+		float frame_interval_mean_ms = 0.f;
+		float frame_interval_stddev_ms = 0.f;
+		float frame_interval_p99_ms = 0.f;
+		float frame_interval_max_ms = 0.f;
+		int frame_swap_interval = 0;			// applied by driver, 1 for adaptive vsync when it isn't supported
+		float frame_limiter_wait_ms = 0.f;		// main thread slept and spun before the frame
+		size_t frame_limiter_missed = 0;		// frames which came later than a whole period
+
+		// engine allocators per subsystem (MemoryTag), pools and arenas count their pages and blocks, not objects
+		static constexpr size_t s_memory_tags_count = 6;
+		const char* memory_tag_names[s_memory_tags_count] = {};
+		size_t memory_live_bytes[s_memory_tags_count] = {};
+		size_t memory_peak_bytes[s_memory_tags_count] = {};
+		size_t memory_live_allocations[s_memory_tags_count] = {};
+		uint64_t memory_total_allocations[s_memory_tags_count] = {};
+		size_t frame_arena_used = 0;			// per-frame temporaries in arena of frame packet
+		size_t frame_arena_capacity = 0;		// grows when a frame doesn't fit
+		size_t ecs_chunks = 0;					// chunks taken from pool of world
+		size_t ecs_chunk_pages = 0;
+
+		// GPU buffers and textures counted by engine, driver info is of the whole GPU
+		int gpu_memory_budget_mb = 0;			// 0 is no budget, above it textures and meshes not drawn recently are evicted
+		static constexpr size_t s_gpu_memory_categories_count = 5;
+		const char* gpu_memory_category_names[s_gpu_memory_categories_count] = {};
+		size_t gpu_memory_category_bytes[s_gpu_memory_categories_count] = {};
+		size_t gpu_memory_category_peak_bytes[s_gpu_memory_categories_count] = {};
+		size_t gpu_memory_category_allocations[s_gpu_memory_categories_count] = {};
+		static constexpr size_t s_gpu_memory_owners_max = 16;
+		const char* gpu_memory_owner_names[s_gpu_memory_owners_max] = {};
+		size_t gpu_memory_owner_bytes[s_gpu_memory_owners_max] = {};
+		size_t gpu_memory_owners_count = 0;		// biggest first
+		size_t gpu_memory_total_bytes = 0;
+		bool gpu_memory_driver_info = false;	// GL_NVX_gpu_memory_info or GL_ATI_meminfo
+		size_t gpu_memory_driver_total_bytes = 0;
+		size_t gpu_memory_driver_free_bytes = 0;
+		size_t gpu_memory_driver_evicted_bytes = 0;
+		size_t gpu_memory_evictables = 0;
+		size_t gpu_memory_resident = 0;
+		uint64_t gpu_memory_evictions = 0;
+
+		// textures, shaders, models and meshes shared by path and by content, unused ones are unloaded after grace period
+		static constexpr size_t s_asset_types_count = 5;
+		const char* asset_type_names[s_asset_types_count] = {};
+		size_t asset_ready[s_asset_types_count] = {};
+		size_t asset_loading[s_asset_types_count] = {};
+		size_t asset_failed[s_asset_types_count] = {};
+		size_t asset_unused[s_asset_types_count] = {};
+		uint64_t asset_hits[s_asset_types_count] = {};		// loads which found asset by path or by content
+		size_t asset_bytes[s_asset_types_count] = {};		// textures only
+		size_t asset_saved_bytes[s_asset_types_count] = {};	// texture memory which hits didn't allocate again
+		// finished loads are uploaded within these per frame (0 is no limit), the rest waits for the next frame
+		int upload_budget_kb = 8192;
+		float upload_budget_ms = 2.f;
+		size_t upload_frame_count = 0;
+		size_t upload_frame_bytes = 0;
+		float upload_frame_ms = 0.f;
+		size_t upload_queued = 0;
+		size_t upload_queued_bytes = 0;
+		size_t upload_peak_queued_bytes = 0;
+		uint64_t upload_deferred_frames = 0;
+
+		// cells of world around camera, SIMPLE_ENGINE_WORLD environment variable names world file
+		bool world_streaming = false;			// world is open
+		float world_load_radius = 64.f;
+		float world_unload_radius = 96.f;		// farther than load radius, so a cell on the edge isn't reloaded every frame
+		int world_max_loading_cells = 4;
+		size_t world_cells = 0;
+		size_t world_loaded_cells = 0;
+		size_t world_loading_cells = 0;
+		size_t world_peak_loaded_cells = 0;
+		size_t world_entities = 0;
+		uint64_t world_stream_ins = 0;
+		uint64_t world_evictions = 0;
+		float world_stream_in_last_ms = 0.f;	// from request of cell to its entities
+		float world_stream_in_average_ms = 0.f;
+		float world_stream_in_max_ms = 0.f;
+		size_t world_peak_gpu_bytes = 0;
+
+		// frames after warmup are built and drawn in no-alloc zones, works when engine is built with allocation hooks
+		size_t zero_alloc_warmup_frames = 300;
+		// > 0 closes app after warmup and that many checked frames, start() returns 1 if any of them allocated
+		// SIMPLE_ENGINE_ZERO_ALLOC_TEST environment variable sets it too
+		size_t zero_alloc_test_frames = 0;
+		uint64_t frame_heap_allocations = 0;	// heap calls of main and render thread inside of the last frame
+		uint64_t zero_alloc_violations = 0;		// heap calls inside of checked frames
 	private:
-		void draw();
+		// main thread: input, simulation, UI and frame packet
+		void update_frame();
+		// part of update_frame between input polling and submit, the part which has to be allocation-free
+		void build_frame();
+		// thread with OpenGL context: draws what packet describes
+		void render_frame(const struct FramePacket& packet);
+
 		std::unique_ptr<class Window> m_pWindow;
+		std::unique_ptr<class RenderThread> m_pRenderThread;
+		std::unique_ptr<class FramePacer> m_pFramePacer;
+
+		std::atomic<size_t> m_rendered_draw_calls{ 0 };
+		std::atomic<size_t> m_rendered_triangles{ 0 };
+		std::atomic<float> m_shadow_cascade_ms[s_max_shadow_cascades] = {};
+		std::atomic<size_t> m_shadow_static_redraws{ 0 };
+		std::atomic<uint64_t> m_prepass_fragments{ 0 };
+		std::atomic<uint64_t> m_color_fragments{ 0 };
+		std::atomic<size_t> m_gpu_visible_instances{ 0 };
+		std::atomic<float> m_gpu_cull_ms{ 0.f };
+		std::atomic<uint64_t> m_render_heap_allocations{ 0 };
+
+		uint64_t m_frames_count = 0;
+		bool m_check_allocations = false;
 
 		EventDispatcher m_event_dispatcher;
 		bool m_bCloseWindow = false;
@@ -37,6 +37,10 @@ namespace SimpleEngine {
 		float get_viewport_w() const { return m_viewport_width; };
 		float get_viewport_h() const { return m_viewport_height; };
 		void set_fov(const float fov);
+		// depth in [0, 1] from near (1) to far (0), perspective projection has infinite far plane
+		// far clip plane then only limits effects which need finite depth (shadows, light clusters)
+		void set_reverse_z(const bool reverse_z);
+		bool is_reverse_z() const { return m_reverse_z; }
 
 		const float get_far_clip_plane() const { return m_far_clip_plane; };
 		const float get_near_clip_plane() const { return m_near_clip_plane; };
@@ -76,6 +80,7 @@ namespace SimpleEngine {
 		float m_viewport_height{ 600.0f };
 
 		float m_fov{ 60.f }; // in degree 
+		bool m_reverse_z = false;
 
 		static constexpr glm::vec3 s_world_up{ 0.f, 0.f, 1.f };
 		static constexpr glm::vec3 s_world_right{ 0.f, -1.f, 0.f };
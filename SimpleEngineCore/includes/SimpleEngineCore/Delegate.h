@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SimpleEngine {
+
+	template<typename Signature, size_t Capacity = 48>
+	class Delegate;
+
+	// std::function without heap: callable is stored inside, too big callable doesn't compile
+	// one indirect call per invocation, trivially copyable callables (lambdas capturing pointers) are moved by memcpy
+	template<typename R, typename... Args, size_t Capacity>
+	class Delegate<R(Args...), Capacity> {
+	public:
+		Delegate() = default;
+
+		template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate>>>
+		Delegate(F&& callable) {
+			using T = std::decay_t<F>;
+			static_assert(sizeof(T) <= Capacity, "Callable is too big for delegate storage, capture less or by pointer");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Callable alignment is not supported");
+			static_assert(std::is_nothrow_move_constructible_v<T>, "Callable has to be nothrow movable");
+
+			new (m_storage) T(std::forward<F>(callable));
+			m_invoke = [](void* storage, Args... args) -> R {
+				return (*static_cast<T*>(storage))(std::forward<Args>(args)...);
+			};
+			if constexpr (!std::is_trivially_copyable_v<T>) {
+				m_manage = [](void* destination, void* source) {
+					T* object = static_cast<T*>(source);
+					if (destination != nullptr) {
+						new (destination) T(std::move(*object));
+					}
+					object->~T();
+				};
+			}
+		}
+
+		~Delegate() { reset(); }
+
+		Delegate(const Delegate&) = delete;
+		Delegate& operator=(const Delegate&) = delete;
+
+		Delegate(Delegate&& other) noexcept { move_from(other); }
+		Delegate& operator=(Delegate&& other) noexcept {
+			if (this != &other) {
+				reset();
+				move_from(other);
+			}
+			return *this;
+		}
+
+		void reset() {
+			if (m_manage != nullptr) {
+				m_manage(nullptr, m_storage);
+			}
+			m_invoke = nullptr;
+			m_manage = nullptr;
+		}
+
+		explicit operator bool() const { return m_invoke != nullptr; }
+
+		R operator()(Args... args) const {
+			return m_invoke(const_cast<unsigned char*>(m_storage), std::forward<Args>(args)...);
+		}
+
+	private:
+		using InvokeFn = R(*)(void*, Args...);
+		// moves source into destination and destroys source, only destroys when destination is null
+		using ManageFn = void(*)(void*, void*);
+
+		void move_from(Delegate& other) {
+			if (other.m_manage != nullptr) {
+				other.m_manage(m_storage, other.m_storage);
+			}
+			else if (other.m_invoke != nullptr) {
+				std::memcpy(m_storage, other.m_storage, Capacity);
+			}
+			m_invoke = other.m_invoke;
+			m_manage = other.m_manage;
+			other.m_invoke = nullptr;
+			other.m_manage = nullptr;
+		}
+
+		alignas(std::max_align_t) unsigned char m_storage[Capacity];
+		InvokeFn m_invoke = nullptr;
+		ManageFn m_manage = nullptr;
+	};
+}
@@ -1,9 +1,15 @@
 #pragma once
 
-#include <functional>
 #include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <variant>
 
 #include "Keys.h"
+#include "Delegate.h"
+#include "Log.h"
 
 namespace SimpleEngine {
 
@@ -27,26 +33,12 @@ namespace SimpleEngine {
 	struct BaseEvent {
 		virtual ~BaseEvent() = default;
 		virtual EventType get_type() const = 0;
-	};
-
-	class EventDispatcher {
-	public:
-		template<typename TEventType>
-		void add_event_listener(std::function<void(TEventType&)> callback) {
-			auto baseCallback = [callback](BaseEvent& e)
-				{
-					callback(static_cast<TEventType&>(e));
-				};
-			m_eventCallbacks[static_cast<size_t>(TEventType::type)] = std::move(baseCallback);
-		}
 
-		void dispatch(BaseEvent& event) {
-			auto& callback = m_eventCallbacks[static_cast<size_t>(event.get_type())];
-			if (callback)
-				callback(event);
-		}
-	private:
-		std::array<std::function<void(BaseEvent&)>, static_cast<size_t>(EventType::EventsCount)> m_eventCallbacks;
+		// set by listener to stop listeners with lower priority
+		bool handled = false;
+		// when window reported it, default for events made by code
+		// coalesced mouse moves and scrolls keep time of the first one
+		std::chrono::steady_clock::time_point timestamp;
 	};
 
 	struct EventWindowClosed : public BaseEvent {
@@ -129,7 +121,231 @@ namespace SimpleEngine {
 			const double xoffset, const double yoffset) :
 			xoffset(xoffset), yoffset(yoffset) {}
 		EventType get_type() const override { return type; }
-		const double xoffset; const double yoffset;
+		double xoffset; double yoffset;	// queued scrolls are summed
 		static const EventType type = EventType::MouseScroll;
 	};
+
+	// every event type by value, what event queue stores, monostate is empty slot
+	using AnyEvent = std::variant<std::monostate,
+		EventWindowResize, EventWindowClosed,
+		EventKeyPressed, EventKeyReleased,
+		EventMouseButtonPressed, EventMouseButtonReleased, EventMouseMoved,
+		EventMouseScroll>;
+
+	// listeners per event type sorted by priority, no heap allocations after construction
+	// events are dispatched right away or queued and dispatched together by flush (once per frame)
+	class EventDispatcher {
+	public:
+		// 0 is never a valid handle
+		using ListenerHandle = uint32_t;
+		static constexpr size_t s_max_listeners = 8;		// per event type
+		static constexpr size_t s_queue_capacity = 256;
+
+		struct Stats {
+			uint64_t queued = 0;
+			uint64_t coalesced = 0;		// mouse moves and scrolls merged into previous queued event
+			uint64_t dispatched = 0;
+			uint64_t overflow_flushes = 0;	// queue was full and flushed early
+		};
+
+		// higher priority is called first, equal priorities in order of adding
+		// listener must not add listeners while it is being called, removing is fine
+		template<typename TEvent, typename F>
+		ListenerHandle add_event_listener(F&& callback, const int priority = 0) {
+			Listeners& listeners = m_listeners[static_cast<size_t>(TEvent::type)];
+			if (listeners.count == s_max_listeners) {
+				LOG_ERROR("EventDispatcher: more than {0} listeners of event {1}", s_max_listeners, static_cast<int>(TEvent::type));
+				return 0;
+			}
+			if (m_dispatch_depth > 0) {
+				LOG_ERROR("EventDispatcher: listener added during dispatch is ignored");
+				return 0;
+			}
+
+			// the first listener with lower priority moves one slot to the right with everything after it
+			size_t position = listeners.count;
+			while (position > 0 && listeners.items[position - 1].priority < priority) {
+				listeners.items[position] = std::move(listeners.items[position - 1]);
+				--position;
+			}
+			Listener& listener = listeners.items[position];
+			listener.callback = [callback = std::forward<F>(callback)](BaseEvent& event) {
+				callback(static_cast<TEvent&>(event));
+			};
+			listener.priority = priority;
+			listener.handle = make_handle(TEvent::type);
+			++listeners.count;
+			return listener.handle;
+		}
+
+		// false when handle was already removed
+		bool remove_event_listener(const ListenerHandle handle) {
+			const size_t type = handle & s_type_mask;
+			if (handle == 0 || type >= m_listeners.size()) {
+				return false;
+			}
+			Listeners& listeners = m_listeners[type];
+			for (size_t i = 0; i < listeners.count; ++i) {
+				if (listeners.items[i].handle != handle) {
+					continue;
+				}
+				if (m_dispatch_depth > 0) {
+					// dispatch loop is iterating the array and may be inside this callback,
+					// compact resets it after the loop
+					listeners.items[i].handle = 0;
+					m_pending_compaction = true;
+					return true;
+				}
+				for (size_t j = i + 1; j < listeners.count; ++j) {
+					listeners.items[j - 1] = std::move(listeners.items[j]);
+				}
+				--listeners.count;
+				listeners.items[listeners.count].callback.reset();
+				return true;
+			}
+			return false;
+		}
+
+		template<typename TEvent>
+		void dispatch(TEvent& event) {
+			static_assert(std::is_base_of_v<BaseEvent, TEvent>, "Not an event");
+			dispatch_to(m_listeners[static_cast<size_t>(TEvent::type)], event);
+		}
+
+		void dispatch(BaseEvent& event) {
+			dispatch_to(m_listeners[static_cast<size_t>(event.get_type())], event);
+		}
+
+		// consecutive mouse moves keep only the last position, consecutive scrolls are summed
+		template<typename TEvent>
+		void queue(const TEvent& event) {
+			static_assert(std::is_base_of_v<BaseEvent, TEvent>, "Not an event");
+			++m_stats.queued;
+			if (m_queue_count > 0) {
+				AnyEvent& last = m_queue[(m_queue_head + m_queue_count - 1) % s_queue_capacity];
+				if constexpr (std::is_same_v<TEvent, EventMouseMoved>) {
+					if (EventMouseMoved* moved = std::get_if<EventMouseMoved>(&last)) {
+						moved->x = event.x;
+						moved->y = event.y;
+						++m_stats.coalesced;
+						return;
+					}
+				}
+				if constexpr (std::is_same_v<TEvent, EventMouseScroll>) {
+					if (EventMouseScroll* scroll = std::get_if<EventMouseScroll>(&last)) {
+						scroll->xoffset += event.xoffset;
+						scroll->yoffset += event.yoffset;
+						++m_stats.coalesced;
+						return;
+					}
+				}
+			}
+			if (m_queue_count == s_queue_capacity) {
+				// order matters more than batching, everything queued so far goes out now
+				++m_stats.overflow_flushes;
+				flush();
+			}
+			m_queue[(m_queue_head + m_queue_count) % s_queue_capacity].template emplace<TEvent>(event);
+			++m_queue_count;
+		}
+
+		// event of unknown type, e.g. from window callback
+		void queue(const BaseEvent& event) {
+			switch (event.get_type()) {
+			case EventType::WindowResize: queue(static_cast<const EventWindowResize&>(event)); break;
+			case EventType::WindowClose: queue(static_cast<const EventWindowClosed&>(event)); break;
+			case EventType::KeyPressed: queue(static_cast<const EventKeyPressed&>(event)); break;
+			case EventType::KeyReleased: queue(static_cast<const EventKeyReleased&>(event)); break;
+			case EventType::MouseButtonPressed: queue(static_cast<const EventMouseButtonPressed&>(event)); break;
+			case EventType::MouseButtonReleased: queue(static_cast<const EventMouseButtonReleased&>(event)); break;
+			case EventType::MouseMoved: queue(static_cast<const EventMouseMoved&>(event)); break;
+			case EventType::MouseScroll: queue(static_cast<const EventMouseScroll&>(event)); break;
+			default: break;
+			}
+		}
+
+		// dispatches queued events in order, events queued by listeners are dispatched too
+		void flush() {
+			while (m_queue_count > 0) {
+				// copy, listeners may queue more events and reuse the slot
+				AnyEvent queued = m_queue[m_queue_head];
+				m_queue_head = (m_queue_head + 1) % s_queue_capacity;
+				--m_queue_count;
+				std::visit([this](auto& event) {
+					if constexpr (!std::is_same_v<std::decay_t<decltype(event)>, std::monostate>) {
+						dispatch(event);
+					}
+				}, queued);
+			}
+		}
+
+		size_t get_queued_count() const { return m_queue_count; }
+		const Stats& get_stats() const { return m_stats; }
+
+	private:
+		static constexpr uint32_t s_type_mask = 0xff;
+
+		struct Listener {
+			Delegate<void(BaseEvent&)> callback;
+			int priority = 0;
+			ListenerHandle handle = 0;
+		};
+
+		struct Listeners {
+			std::array<Listener, s_max_listeners> items;
+			size_t count = 0;
+		};
+
+		// low byte is event type, the rest is a counter so removed handles are not reused soon
+		ListenerHandle make_handle(const EventType type) {
+			++m_next_handle;
+			return (m_next_handle << 8) | static_cast<uint32_t>(type);
+		}
+
+		void dispatch_to(Listeners& listeners, BaseEvent& event) {
+			++m_stats.dispatched;
+			++m_dispatch_depth;
+			for (size_t i = 0; i < listeners.count && !event.handled; ++i) {
+				const Listener& listener = listeners.items[i];
+				if (listener.handle != 0) {
+					listener.callback(event);
+				}
+			}
+			--m_dispatch_depth;
+			if (m_dispatch_depth == 0 && m_pending_compaction) {
+				compact();
+			}
+		}
+
+		// drops slots of listeners removed during dispatch
+		void compact() {
+			m_pending_compaction = false;
+			for (Listeners& listeners : m_listeners) {
+				size_t kept = 0;
+				for (size_t i = 0; i < listeners.count; ++i) {
+					if (listeners.items[i].handle != 0) {
+						if (kept != i) {
+							listeners.items[kept] = std::move(listeners.items[i]);
+						}
+						++kept;
+					}
+				}
+				for (size_t i = kept; i < listeners.count; ++i) {
+					listeners.items[i].callback.reset();
+				}
+				listeners.count = kept;
+			}
+		}
+
+		std::array<Listeners, static_cast<size_t>(EventType::EventsCount)> m_listeners;
+		uint32_t m_next_handle = 0;
+		int m_dispatch_depth = 0;
+		bool m_pending_compaction = false;
+
+		std::array<AnyEvent, s_queue_capacity> m_queue;
+		size_t m_queue_head = 0;
+		size_t m_queue_count = 0;
+
+		Stats m_stats;
+	};
 }
\ No newline at end of file
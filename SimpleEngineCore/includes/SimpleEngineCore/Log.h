@@ -1,17 +1,219 @@
 #pragma once
 
-#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
 
-namespace SimpleEngine {
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// lines below this level are compiled out: 0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 critical
+#ifndef SIMPLE_ENGINE_LOG_MIN_LEVEL
 #ifdef NDEBUG
-#define LOG_INFO(...) 
-#define LOG_WARN(...) 
-#define LOG_ERROR(...)
-#define LOG_CRIT(...) 
+#define SIMPLE_ENGINE_LOG_MIN_LEVEL 2
 #else
-#define LOG_INFO(...) spdlog::info(__VA_ARGS__)
-#define LOG_WARN(...) spdlog::warn(__VA_ARGS__)
-#define LOG_ERROR(...) spdlog::error(__VA_ARGS__)
-#define LOG_CRIT(...) spdlog::critical(__VA_ARGS__)
-#endif 
-}
\ No newline at end of file
+#define SIMPLE_ENGINE_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+namespace SimpleEngine {
+
+	// function and not comparison in macro: with level 0 "level >= 0" warns about always true comparison
+	constexpr bool is_log_level_compiled(const int level) { return level >= SIMPLE_ENGINE_LOG_MIN_LEVEL; }
+
+	enum class LogLevel : uint8_t {
+		Trace,
+		Debug,
+		Info,
+		Warn,
+		Error,
+		Critical,
+		Off
+	};
+
+	enum class LogCategory : uint8_t {
+		Core,
+		Render,
+		Input,
+		Assets,
+		GLDebug,
+		Count
+	};
+
+	// one line waiting in the ring: arguments are copied, text is formatted later by logger thread
+	struct LogRecord {
+		static constexpr size_t s_args_capacity = 96;
+		static constexpr size_t s_text_capacity = 880;	// strings from arguments, longer ones are cut
+
+		using FormatFn = void(*)(const LogRecord&, fmt::memory_buffer&);
+
+		std::chrono::system_clock::time_point time;
+		const char* format = nullptr;	// string literal
+		FormatFn format_fn = nullptr;
+		LogCategory category = LogCategory::Core;
+		LogLevel level = LogLevel::Info;
+		uint16_t text_size = 0;
+		alignas(std::max_align_t) unsigned char args[s_args_capacity];
+		char text[s_text_capacity];
+	};
+
+	// string argument copied into record text
+	struct LogTextRef {
+		uint16_t offset = 0;
+		uint16_t size = 0;
+	};
+
+	template<typename T, bool = std::is_enum_v<T>>
+	struct LogValue {
+		using type = T;
+	};
+
+	// enums are printed as numbers
+	template<typename T>
+	struct LogValue<T, true> {
+		using type = std::underlying_type_t<T>;
+	};
+
+	// how argument is kept in record: values as they are, strings as copies in record text
+	template<typename T, typename = void>
+	struct LogArg {
+		static_assert(std::is_trivially_copyable_v<T>, "Log argument has to be trivially copyable or a string");
+		using Stored = typename LogValue<T>::type;
+		static Stored store(const T& value, LogRecord&) { return static_cast<Stored>(value); }
+		static const Stored& load(const Stored& value, const LogRecord&) { return value; }
+	};
+
+	struct LogStringArg {
+		static LogTextRef store(const std::string_view value, LogRecord& record) {
+			LogTextRef ref;
+			ref.offset = record.text_size;
+			ref.size = static_cast<uint16_t>(std::min(value.size(), LogRecord::s_text_capacity - record.text_size));
+			std::memcpy(record.text + ref.offset, value.data(), ref.size);
+			record.text_size += ref.size;
+			return ref;
+		}
+		static fmt::string_view load(const LogTextRef ref, const LogRecord& record) {
+			return fmt::string_view(record.text + ref.offset, ref.size);
+		}
+	};
+
+	template<typename T>
+	struct LogArg<T, std::enable_if_t<std::is_same_v<T, const char*> || std::is_same_v<T, char*>>> : LogStringArg {
+		using Stored = LogTextRef;
+		static LogTextRef store(const char* value, LogRecord& record) {
+			return LogStringArg::store(value != nullptr ? std::string_view(value) : std::string_view("(null)"), record);
+		}
+	};
+
+	template<typename T>
+	struct LogArg<T, std::enable_if_t<std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>>> : LogStringArg {
+		using Stored = LogTextRef;
+	};
+
+	// lines are put into lock-free ring by any thread and formatted and written by logger thread
+	// until init and after shutdown lines are written on calling thread
+	class Log {
+	public:
+		struct Stats {
+			uint64_t written = 0;	// put into ring
+			uint64_t dropped = 0;	// ring was full
+		};
+
+		// starts logger thread and flushes it on crash (fatal signals, std::terminate)
+		static void init();
+		// writes everything which is in ring and stops logger thread
+		static void shutdown();
+		// returns when everything logged before the call is written
+		static void flush();
+
+		static void set_level(const LogCategory category, const LogLevel level) {
+			s_levels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+		}
+		static LogLevel get_level(const LogCategory category) {
+			return static_cast<LogLevel>(s_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+		}
+		static bool is_enabled(const LogCategory category, const LogLevel level) {
+			return static_cast<uint8_t>(level) >= s_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+		}
+		static const char* get_category_name(const LogCategory category);
+		static Stats get_stats();
+
+		// format has to be a string literal, it is read when line is formatted
+		template<typename... Args>
+		static void write(const LogCategory category, const LogLevel level, const char* format, const Args&... args) {
+			using Stored = std::tuple<typename LogArg<std::decay_t<Args>>::Stored...>;
+			static_assert(sizeof(Stored) <= LogRecord::s_args_capacity, "Too many log arguments");
+			static_assert(alignof(Stored) <= alignof(std::max_align_t), "Log argument alignment is not supported");
+			static_assert(std::is_trivially_destructible_v<Stored>, "Log arguments have to be trivially destructible");
+
+			size_t ticket = 0;
+			LogRecord* record = begin_record(ticket);
+			if (record == nullptr) {
+				return;
+			}
+			record->time = std::chrono::system_clock::now();
+			record->format = format;
+			record->format_fn = &format_record<Stored, Args...>;
+			record->category = category;
+			record->level = level;
+			record->text_size = 0;
+			new (record->args) Stored(LogArg<std::decay_t<Args>>::store(args, *record)...);
+			end_record(record, ticket);
+		}
+
+	private:
+		template<typename Stored, typename... Args>
+		static void format_record(const LogRecord& record, fmt::memory_buffer& out) {
+			format_stored<Stored, Args...>(record, out, std::index_sequence_for<Args...>());
+		}
+
+		template<typename Stored, typename... Args, size_t... I>
+		static void format_stored(const LogRecord& record, fmt::memory_buffer& out, std::index_sequence<I...>) {
+			const Stored& stored = *std::launder(reinterpret_cast<const Stored*>(record.args));
+			auto loaded = std::make_tuple(LogArg<std::decay_t<Args>>::load(std::get<I>(stored), record)...);
+			std::apply([&](auto&... values) {
+				fmt::vformat_to(std::back_inserter(out), fmt::string_view(record.format), fmt::make_format_args(values...));
+			}, loaded);
+		}
+
+		// nullptr when ring is full, without logger thread returns thread local record which end_record writes at once
+		static LogRecord* begin_record(size_t& ticket);
+		static void end_record(LogRecord* record, const size_t ticket);
+
+		static std::atomic<uint8_t> s_levels[static_cast<size_t>(LogCategory::Count)];
+	};
+}
+
+// "" format makes sure format is a string literal
+#define SIMPLE_ENGINE_LOG(level, category, format, ...) \
+	do { \
+		if constexpr (::SimpleEngine::is_log_level_compiled(static_cast<int>(::SimpleEngine::LogLevel::level))) { \
+			if (::SimpleEngine::Log::is_enabled(::SimpleEngine::LogCategory::category, ::SimpleEngine::LogLevel::level)) { \
+				::SimpleEngine::Log::write(::SimpleEngine::LogCategory::category, ::SimpleEngine::LogLevel::level, "" format, ##__VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+#define LOG_TRACE(...) SIMPLE_ENGINE_LOG(Trace, Core, __VA_ARGS__)
+#define LOG_DEBUG(...) SIMPLE_ENGINE_LOG(Debug, Core, __VA_ARGS__)
+#define LOG_INFO(...) SIMPLE_ENGINE_LOG(Info, Core, __VA_ARGS__)
+#define LOG_WARN(...) SIMPLE_ENGINE_LOG(Warn, Core, __VA_ARGS__)
+#define LOG_ERROR(...) SIMPLE_ENGINE_LOG(Error, Core, __VA_ARGS__)
+#define LOG_CRIT(...) SIMPLE_ENGINE_LOG(Critical, Core, __VA_ARGS__)
+
+// category is a LogCategory name: LOG_INFO_TO(Render, "...")
+#define LOG_TRACE_TO(category, ...) SIMPLE_ENGINE_LOG(Trace, category, __VA_ARGS__)
+#define LOG_DEBUG_TO(category, ...) SIMPLE_ENGINE_LOG(Debug, category, __VA_ARGS__)
+#define LOG_INFO_TO(category, ...) SIMPLE_ENGINE_LOG(Info, category, __VA_ARGS__)
+#define LOG_WARN_TO(category, ...) SIMPLE_ENGINE_LOG(Warn, category, __VA_ARGS__)
+#define LOG_ERROR_TO(category, ...) SIMPLE_ENGINE_LOG(Error, category, __VA_ARGS__)
+#define LOG_CRIT_TO(category, ...) SIMPLE_ENGINE_LOG(Critical, category, __VA_ARGS__)
@@ -0,0 +1,5 @@
+#version 460
+
+// only depth is written
+void main() {
+}
@@ -0,0 +1,24 @@
+#version 450
+
+layout(location = 0) in vec3 vertex_position;
+layout(location = 3) in int instance_index;
+
+struct GpuInstance {
+	mat4 model;
+	vec4 normal[3];
+	vec4 boundsCenter;
+	vec4 boundsExtent;
+};
+
+layout(std430, binding = 3) readonly buffer GpuInstances {
+	GpuInstance instances[];
+};
+
+uniform mat4 view_projection;
+
+// depth pre-pass and color pass have to produce bit exact depth for GL_EQUAL test
+invariant gl_Position;
+
+void main() {
+	gl_Position = view_projection * (instances[instance_index].model * vec4(vertex_position, 1.0));
+}
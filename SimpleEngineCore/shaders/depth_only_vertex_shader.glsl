@@ -0,0 +1,12 @@
+#version 460
+
+layout(location = 0) in vec3 vertex_position;
+
+uniform mat4 mvp_mat;
+
+// depth pre-pass and color pass have to produce bit exact depth for GL_EQUAL test
+invariant gl_Position;
+
+void main() {
+	gl_Position = mvp_mat * vec4(vertex_position, 1.0);
+}
@@ -0,0 +1,48 @@
+#version 450
+
+// one level of depth pyramid, every texel keeps the farthest depth of source texels it covers
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// scene depth for level 0, previous pyramid level otherwise
+uniform sampler2D sourceDepth;
+uniform int sourceLevel;
+uniform ivec2 sourceSize;
+uniform ivec2 destinationSize;
+// with reverse-Z far plane is 0, so the farthest depth is the minimum
+uniform bool reverseZ;
+
+layout(r32f, binding = 0) writeonly uniform image2D destination;
+
+float farthest(float a, float b) {
+	return reverseZ ? min(a, b) : max(a, b);
+}
+
+float fetch(ivec2 texel) {
+	return texelFetch(sourceDepth, min(texel, sourceSize - 1), sourceLevel).r;
+}
+
+void main() {
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, destinationSize))) {
+		return;
+	}
+
+	ivec2 source = texel * 2;
+	float depth = farthest(farthest(fetch(source), fetch(source + ivec2(1, 0))),
+		farthest(fetch(source + ivec2(0, 1)), fetch(source + ivec2(1, 1))));
+
+	// odd source size: the last row and column also cover the texel left over
+	bool extra_x = (sourceSize.x & 1) != 0 && texel.x == destinationSize.x - 1;
+	bool extra_y = (sourceSize.y & 1) != 0 && texel.y == destinationSize.y - 1;
+	if (extra_x) {
+		depth = farthest(depth, farthest(fetch(source + ivec2(2, 0)), fetch(source + ivec2(2, 1))));
+	}
+	if (extra_y) {
+		depth = farthest(depth, farthest(fetch(source + ivec2(0, 2)), fetch(source + ivec2(1, 2))));
+	}
+	if (extra_x && extra_y) {
+		depth = farthest(depth, fetch(source + ivec2(2, 2)));
+	}
+
+	imageStore(destination, texel, vec4(depth));
+}
@@ -0,0 +1,128 @@
+#version 450
+
+// one invocation per instance: frustum and Hi-Z occlusion test, survivors get a draw command
+layout(local_size_x = 64) in;
+
+struct GpuInstance {
+	mat4 model;
+	vec4 normal[3];
+	vec4 boundsCenter;	// local box
+	vec4 boundsExtent;
+};
+
+// DrawElementsIndirectCommand
+struct DrawCommand {
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 3) readonly buffer GpuInstances {
+	GpuInstance instances[];
+};
+layout(std430, binding = 4) writeonly buffer DrawCommands {
+	DrawCommand commands[];
+};
+// cleared to 0 before dispatch, becomes draw count of multi draw indirect count
+layout(std430, binding = 5) buffer DrawCount {
+	uint drawCount;
+};
+
+uniform uint instanceCount;
+uniform uint indexCount;
+uniform mat4 viewProjection;
+uniform bool reverseZ;
+
+// depth pyramid of previous frame, level 0 is half of viewport
+uniform bool hizEnabled;
+uniform sampler2D hiz;
+uniform int hizLevels;
+uniform mat4 previousViewProjection;
+uniform vec2 viewportSize;
+
+float farthest(float a, float b) {
+	return reverseZ ? min(a, b) : max(a, b);
+}
+
+float nearest(float a, float b) {
+	return reverseZ ? max(a, b) : min(a, b);
+}
+
+bool is_outside_frustum(vec3 center, vec3 extent) {
+	// the whole box has to be outside of one plane
+	bvec4 all_outside = bvec4(true);
+	bool all_behind = true;
+	bool all_far = !reverseZ; // reverse-Z projection has no far plane
+	for (int i = 0; i < 8; ++i) {
+		vec3 corner = center + extent * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip = viewProjection * vec4(corner, 1.0);
+		all_outside = bvec4(all_outside.x && clip.x < -clip.w, all_outside.y && clip.x > clip.w,
+			all_outside.z && clip.y < -clip.w, all_outside.w && clip.y > clip.w);
+		all_behind = all_behind && clip.w <= 0.0;
+		all_far = all_far && clip.z > clip.w;
+	}
+	return any(all_outside) || all_behind || all_far;
+}
+
+bool is_occluded(vec3 center, vec3 extent) {
+	vec2 uv_min = vec2(1.0);
+	vec2 uv_max = vec2(0.0);
+	float box_depth = reverseZ ? 0.0 : 1.0;
+	for (int i = 0; i < 8; ++i) {
+		vec3 corner = center + extent * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip = previousViewProjection * vec4(corner, 1.0);
+		if (clip.w <= 1e-4) {
+			// crosses camera plane, projected rectangle is unbounded
+			return false;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		uv_min = min(uv_min, ndc.xy * 0.5 + 0.5);
+		uv_max = max(uv_max, ndc.xy * 0.5 + 0.5);
+		// window depth: [0, 1] clip depth with reverse-Z, [-1, 1] otherwise
+		box_depth = nearest(box_depth, reverseZ ? ndc.z : ndc.z * 0.5 + 0.5);
+	}
+	uv_min = clamp(uv_min, 0.0, 1.0);
+	uv_max = clamp(uv_max, 0.0, 1.0);
+
+	// level where the rectangle touches at most 2 x 2 texels, texel of level L covers 2^(L + 1) pixels
+	vec2 pixels_min = uv_min * viewportSize;
+	vec2 pixels_max = uv_max * viewportSize;
+	vec2 size = pixels_max - pixels_min;
+	int level = int(ceil(log2(max(max(size.x, size.y), 1.0)))) - 1;
+	level = clamp(level, 0, hizLevels - 1);
+
+	ivec2 level_size = textureSize(hiz, level);
+	ivec2 texel_min = min(ivec2(pixels_min) >> (level + 1), level_size - 1);
+	ivec2 texel_max = min(ivec2(pixels_max) >> (level + 1), level_size - 1);
+
+	float occluder_depth = farthest(
+		farthest(texelFetch(hiz, texel_min, level).r, texelFetch(hiz, ivec2(texel_max.x, texel_min.y), level).r),
+		farthest(texelFetch(hiz, ivec2(texel_min.x, texel_max.y), level).r, texelFetch(hiz, texel_max, level).r));
+
+	return reverseZ ? box_depth < occluder_depth : box_depth > occluder_depth;
+}
+
+void main() {
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= instanceCount) {
+		return;
+	}
+
+	GpuInstance instance = instances[index];
+	// world space box around transformed local box
+	vec3 center = (instance.model * vec4(instance.boundsCenter.xyz, 1.0)).xyz;
+	mat3 abs_model = mat3(abs(instance.model[0].xyz), abs(instance.model[1].xyz), abs(instance.model[2].xyz));
+	vec3 extent = abs_model * instance.boundsExtent.xyz;
+
+	if (is_outside_frustum(center, extent)) {
+		return;
+	}
+	if (hizEnabled && is_occluded(center, extent)) {
+		return;
+	}
+
+	uint slot = atomicAdd(drawCount, 1u);
+	commands[slot] = DrawCommand(indexCount, 1u, 0u, 0, index);
+}
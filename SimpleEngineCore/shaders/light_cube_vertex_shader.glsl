@@ -4,6 +4,9 @@ layout(location = 0) in vec3 vertex_position;
 
 uniform mat4 mvp_mat;
 
+// bit exact with depth_only_vertex_shader for GL_EQUAL after depth pre-pass
+invariant gl_Position;
+
 void main() {
-	gl_Position = mvp_mat * vec4(vertex_position * 0.05f, 1.0);
+	gl_Position = mvp_mat * vec4(vertex_position, 1.0); // scale is in mvp_mat (quantized meshes need it there)
 }
\ No newline at end of file
@@ -15,37 +15,24 @@ struct DirectionalLight {
     vec3 direction;
 };
 
-struct PointLight {
-    vec3 ambient;
-    float ambientIntensity;
-    vec3 diffuse;
-    float diffuseIntensity;
-    vec3 specular;
-    float specularIntensity;
-
-    vec3 position;
-
-    float constant;
-    float linear;
-    float quadratic;
+// point or spot light, cosCutOff < -1 for point light
+struct ClusterLight {
+    vec4 positionRange;
+    vec4 directionCosCutOff;
+    vec4 diffuse;     // color * intensity
+    vec4 specular;
+    vec4 attenuation; // constant, linear, quadratic
 };
 
-struct SpotLight {
-    vec3 ambient;
-    float ambientIntensity;
-    vec3 diffuse;
-    float diffuseIntensity;
-    vec3 specular;
-    float specularIntensity;
-
-    vec3 position;
-    vec3 direction;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    float cutOff;  // result of cos(cutoff)
+layout(std430, binding = 0) readonly buffer ClusterLights {
+    ClusterLight lights[];
+};
+// offset and count in lightIndices for every cluster
+layout(std430, binding = 1) readonly buffer ClusterRanges {
+    uvec2 clusterRanges[];
+};
+layout(std430, binding = 2) readonly buffer ClusterIndices {
+    uint lightIndices[];
 };
 
 struct Material {
@@ -57,37 +44,71 @@ struct Material {
 
 uniform vec3 globalAmbient;
 uniform DirectionalLight directionalLight;
-uniform PointLight pointLight;
-uniform SpotLight spotLight;
 uniform Material material;
 uniform vec3 cam_pos;
 uniform bool useDirLight;
-uniform bool usePointLight;
-uniform bool useSpotLight;
+uniform mat4 view_mat;
+uniform ivec3 clusterGrid;     // tiles x, tiles y, depth slices
+uniform vec2 clusterTileSize;  // in pixels
+uniform vec2 clusterZParams;   // slice = log(view depth) * x + y
+
+// directional light shadow cascades
+const int MAX_SHADOW_CASCADES = 4;
+uniform sampler2DArrayShadow shadowMap;
+uniform int shadowCascadesCount;   // 0 - no shadows
+uniform mat4 shadowMatrices[MAX_SHADOW_CASCADES];
+uniform float shadowSplits[MAX_SHADOW_CASCADES]; // view depth where cascade ends
 
 out vec4 frag_color;
 
-// Function to compute point light contribution
-vec3 ComputePointLight(vec3 frag_pos, vec3 frag_normal, vec3 view_direction, vec3 sampledDiffuse, vec3 sampledSpecular) {
+// Function to compute point or spot light contribution
+vec3 ComputeClusterLight(ClusterLight light, vec3 frag_pos, vec3 frag_normal, vec3 view_direction, vec3 sampledDiffuse, vec3 sampledSpecular) {
+    vec3 light_direction = normalize(light.positionRange.xyz - frag_pos);
+
+    // No contribution outside the spotlight's cutoff
+    if (light.directionCosCutOff.w >= -1.0 && dot(light_direction, -light.directionCosCutOff.xyz) <= light.directionCosCutOff.w) {
+        return vec3(0.0);
+    }
+
     // Distance and attenuation
-    float distance = length(pointLight.position - frag_pos);
-    float attenuation = 1.0 / (pointLight.constant +
-        pointLight.linear * distance +
-        pointLight.quadratic * (distance * distance));
+    float distance = length(light.positionRange.xyz - frag_pos);
+    float attenuation = 1.0 / (light.attenuation.x +
+        light.attenuation.y * distance +
+        light.attenuation.z * (distance * distance));
 
     // Diffuse
-    vec3 light_direction = normalize(pointLight.position - frag_pos);
-    vec3 diffuse = attenuation * pointLight.diffuseIntensity * pointLight.diffuse *
+    vec3 diffuse = attenuation * light.diffuse.rgb *
         sampledDiffuse * max(dot(light_direction, frag_normal), 0.0);
 
     // Specular
     vec3 reflected_direction = reflect(-light_direction, frag_normal);
-    vec3 specular = attenuation * pointLight.specularIntensity * pointLight.specular *
+    vec3 specular = attenuation * light.specular.rgb *
         sampledSpecular * pow(max(dot(reflected_direction, view_direction), 0.0), material.shininess);
 
     return diffuse + specular;
 }
 
+// 1 - lit, 0 - in shadow, 3x3 PCF of hardware compared samples
+float ComputeShadow(vec3 frag_pos, float view_depth) {
+    int cascade = 0;
+    while (cascade < shadowCascadesCount && view_depth > shadowSplits[cascade]) {
+        ++cascade;
+    }
+    if (cascade >= shadowCascadesCount) {
+        return 1.0;
+    }
+    vec4 light_pos = shadowMatrices[cascade] * vec4(frag_pos, 1.0);
+    vec3 coords = light_pos.xyz / light_pos.w * 0.5 + 0.5;
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, float(cascade), coords.z));
+        }
+    }
+    return lit / 9.0;
+}
+
 // Function to compute directional light contribution
 vec3 ComputeDirectionalLight(vec3 frag_normal, vec3 view_direction, vec3 sampledDiffuse, vec3 sampledSpecular) {
     // Diffuse
@@ -103,31 +124,12 @@ vec3 ComputeDirectionalLight(vec3 frag_normal, vec3 view_direction, vec3 sampled
     return diffuse + specular;
 }
 
-// Function to compute spot light contribution
-vec3 ComputeSpotLight(vec3 frag_pos, vec3 frag_normal, vec3 view_direction, vec3 sampledDiffuse, vec3 sampledSpecular) {
-    vec3 frag_direction = normalize(spotLight.position - frag_pos);
-    float theta = dot(frag_direction, normalize(-spotLight.direction));
-
-    // Distance and attenuation
-    float distance = length(spotLight.position - frag_pos);
-    float attenuation = 1.0 / (spotLight.constant +
-        spotLight.linear * distance +
-        spotLight.quadratic * (distance * distance));
-
-    if (theta > spotLight.cutOff) {
-        // Diffuse
-        vec3 light_direction = normalize(spotLight.position - frag_pos);
-        vec3 diffuse = attenuation * spotLight.diffuseIntensity * spotLight.diffuse *
-            sampledDiffuse * max(dot(light_direction, frag_normal), 0.0);
-
-        // Specular
-        vec3 reflected_direction = reflect(-light_direction, frag_normal);
-        vec3 specular = attenuation * spotLight.specularIntensity * spotLight.specular *
-            sampledSpecular * pow(max(dot(reflected_direction, view_direction), 0.0), material.shininess);
-
-        return diffuse + specular;
-    }
-    return vec3(0.0);  // No contribution outside the spotlight's cutoff
+// Cluster of fragment from its screen position and view depth
+uint GetClusterIndex(float view_depth) {
+    int slice = int(floor(log(max(view_depth, 1e-6)) * clusterZParams.x + clusterZParams.y));
+    ivec2 tile = ivec2(gl_FragCoord.xy / clusterTileSize);
+    ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), clusterGrid - 1);
+    return uint(cluster.x + cluster.y * clusterGrid.x + cluster.z * clusterGrid.x * clusterGrid.y);
 }
 
 void main() {
@@ -145,24 +147,20 @@ void main() {
     if (useDirLight) {
         ambient_light += directionalLight.ambientIntensity * directionalLight.ambient * sampledDiffuse;
     }
-    if (usePointLight) {
-        ambient_light += pointLight.ambientIntensity * pointLight.ambient * sampledDiffuse;
-    }
-    if (useSpotLight) {
-        ambient_light += spotLight.ambientIntensity * spotLight.ambient * sampledDiffuse;
-    }
 
     // Compute light contributions
     vec3 total_light = ambient_light;
 
+    float view_depth = -(view_mat * vec4(frag_pos, 1.0)).z;
     if (useDirLight) {
-        total_light += ComputeDirectionalLight(normal, view_direction, sampledDiffuse, sampledSpecular);
+        total_light += ComputeShadow(frag_pos, view_depth) *
+            ComputeDirectionalLight(normal, view_direction, sampledDiffuse, sampledSpecular);
     }
-    if (usePointLight) {
-        total_light += ComputePointLight(frag_pos, normal, view_direction, sampledDiffuse, sampledSpecular);
-    }
-    if (useSpotLight) {
-        total_light += ComputeSpotLight(frag_pos, normal, view_direction, sampledDiffuse, sampledSpecular);
+
+    // only lights assigned to cluster of this fragment
+    uvec2 range = clusterRanges[GetClusterIndex(view_depth)];
+    for (uint i = range.x; i < range.x + range.y; ++i) {
+        total_light += ComputeClusterLight(lights[lightIndices[i]], frag_pos, normal, view_direction, sampledDiffuse, sampledSpecular);
     }
 
     // Set final fragment color
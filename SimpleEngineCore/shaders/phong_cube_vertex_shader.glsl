@@ -8,6 +8,9 @@ uniform mat4 m_mat;
 uniform mat3 normal_mat; 
 uniform mat4 mvp_mat;
 
+// bit exact with depth_only_vertex_shader for GL_EQUAL after depth pre-pass
+invariant gl_Position;
+
 out vec3 frag_pos;
 out vec3 frag_normal;
 out vec2 tex_coord;
@@ -0,0 +1,39 @@
+#version 450
+
+layout(location = 0) in vec3 vertex_position;
+layout(location = 1) in vec3 vertex_normal;
+layout(location = 2) in vec2 texture_coord;
+// index into instances, advances per instance and starts at baseInstance of indirect command
+layout(location = 3) in int instance_index;
+
+struct GpuInstance {
+	mat4 model;
+	vec4 normal[3];		// columns of normal matrix
+	vec4 boundsCenter;	// local box
+	vec4 boundsExtent;
+};
+
+layout(std430, binding = 3) readonly buffer GpuInstances {
+	GpuInstance instances[];
+};
+
+uniform mat4 view_projection;
+
+// bit exact with depth_only_instanced_vertex_shader for GL_EQUAL after depth pre-pass
+invariant gl_Position;
+
+out vec3 frag_pos;
+out vec3 frag_normal;
+out vec2 tex_coord;
+
+void main() {
+	GpuInstance instance = instances[instance_index];
+	mat3 normal_mat = mat3(instance.normal[0].xyz, instance.normal[1].xyz, instance.normal[2].xyz);
+
+	tex_coord = texture_coord;
+
+	vec4 world_pos = instance.model * vec4(vertex_position, 1.0);
+	frag_pos = world_pos.xyz;
+	frag_normal = normal_mat * vertex_normal;
+	gl_Position = view_projection * world_pos;
+}
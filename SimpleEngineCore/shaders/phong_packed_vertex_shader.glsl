@@ -0,0 +1,35 @@
+#version 460
+
+// the same as phong_cube_vertex_shader but for PackedVertex (VertexPacking.h)
+// position comes as unorm16/half and is restored by m_mat (it contains quantization matrix)
+// normal comes as 2 x snorm16 in octahedral encoding
+layout(location = 0) in vec3 vertex_position;
+layout(location = 1) in vec2 vertex_normal_oct;
+layout(location = 2) in vec2 texture_coord;
+
+uniform mat4 m_mat;
+uniform mat3 normal_mat; 
+uniform mat4 mvp_mat;
+
+// bit exact with depth_only_vertex_shader for GL_EQUAL after depth pre-pass
+invariant gl_Position;
+
+out vec3 frag_pos;
+out vec3 frag_normal;
+out vec2 tex_coord;
+
+vec3 oct_decode(vec2 e) {
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+void main() {
+	tex_coord = texture_coord;
+
+	frag_pos = vec3(m_mat * vec4(vertex_position, 1.0));
+	frag_normal = normal_mat * oct_decode(vertex_normal_oct);
+	gl_Position = mvp_mat * vec4(vertex_position, 1.0);
+}
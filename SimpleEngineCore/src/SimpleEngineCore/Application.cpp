@@ -12,123 +12,264 @@
 #include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.h"
 #include "SimpleEngineCore/Rendering/OpenGL/Texture2D.h"
 #include "SimpleEngineCore/Rendering/OpenGL/Mesh.h"
+#include "SimpleEngineCore/Rendering/OpenGL/FrameBuffer.h"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuQuery.h"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuMemory.h"
+#include "SimpleEngineCore/Rendering/RenderThread.h"
+#include "SimpleEngineCore/Rendering/ClusteredLighting.h"
+#include "SimpleEngineCore/Rendering/ShadowRenderer.h"
+#include "SimpleEngineCore/Rendering/OcclusionCulling.h"
+#include "SimpleEngineCore/Rendering/GpuDrivenRenderer.h"
+#include "SimpleEngineCore/Rendering/InputLatency.h"
+#include "SimpleEngineCore/Rendering/FramePacer.h"
+#include "SimpleEngineCore/Scene/SceneGraph.h"
+#include "SimpleEngineCore/Scene/WorldStreamer.h"
+#include "SimpleEngineCore/ECS/World.h"
+#include "SimpleEngineCore/ECS/Components.h"
+#include "SimpleEngineCore/ECS/Systems.h"
 #include "SimpleEngineCore/Modules/UIModule.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Memory/MemoryTracker.h"
+#include "SimpleEngineCore/Memory/AllocationTracker.h"
+#include "SimpleEngineCore/Assets/AssetManager.h"
+#include "SimpleEngineCore/Assets/AssetCooker.h"
+#include "SimpleEngineCore/IO/AsyncIO.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/IO/PackArchive.h"
+#include "SimpleEngineCore/Utils.h"
 
 #include <GLFW/glfw3.h>
 
 #include <iostream>
 #include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
 
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
 #include <imgui/backends/imgui_impl_glfw.h>
 
 #include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
 
-std::vector<GLfloat> verticesCube = {
-	//    position             normal            UV                  index
-	// FRONT
-	-1.0f, -1.f, -1.f,    -1.f,  0.f,  0.f,     0.f, 0.f,              // 0
-	-1.0f,  1.f, -1.f,    -1.f,  0.f,  0.f,     1.f, 0.f,              // 1
-	-1.0f,  1.f,  1.f,    -1.f,  0.f,  0.f,     1.f, 1.f,              // 2
-	-1.0f, -1.f,  1.f,    -1.f,  0.f,  0.f,     0.f, 1.f,              // 3
-	// BACK                                  
-	 1.0f, -1.f, -1.f,     1.f,  0.f,  0.f,     1.f, 0.f,              // 4
-	 1.0f,  1.f, -1.f,     1.f,  0.f,  0.f,     0.f, 0.f,              // 5
-	 1.0f,  1.f,  1.f,     1.f,  0.f,  0.f,     0.f, 1.f,              // 6
-	 1.0f, -1.f,  1.f,     1.f,  0.f,  0.f,     1.f, 1.f,              // 7
-	 // RIGHT
-	 -1.0f,  1.f, -1.f,     0.f,  1.f,  0.f,     0.f, 0.f,              // 8
-	  1.0f,  1.f, -1.f,     0.f,  1.f,  0.f,     1.f, 0.f,              // 9
-	  1.0f,  1.f,  1.f,     0.f,  1.f,  0.f,     1.f, 1.f,              // 10
-	 -1.0f,  1.f,  1.f,     0.f,  1.f,  0.f,     0.f, 1.f,              // 11
-	 // LEFT
-	 -1.0f, -1.f, -1.f,     0.f, -1.f,  0.f,     1.f, 0.f,              // 12
-	  1.0f, -1.f, -1.f,     0.f, -1.f,  0.f,     0.f, 0.f,              // 13
-	  1.0f, -1.f,  1.f,     0.f, -1.f,  0.f,     0.f, 1.f,              // 14
-	 -1.0f, -1.f,  1.f,     0.f, -1.f,  0.f,     1.f, 1.f,              // 15
-	 // TOP
-	 -1.0f, -1.f,  1.f,     0.f,  0.f,  1.f,     0.f, 0.f,              // 16
-	 -1.0f,  1.f,  1.f,     0.f,  0.f,  1.f,     1.f, 0.f,              // 17
-	  1.0f,  1.f,  1.f,     0.f,  0.f,  1.f,     1.f, 1.f,              // 18
-	  1.0f, -1.f,  1.f,     0.f,  0.f,  1.f,     0.f, 1.f,              // 19
-	  // BOTTOM
-	  -1.0f, -1.f, -1.f,    0.f,  0.f, -1.f,     0.f, 1.f,              // 20
-	  -1.0f,  1.f, -1.f,    0.f,  0.f, -1.f,     1.f, 1.f,              // 21
-	   1.0f,  1.f, -1.f,    0.f,  0.f, -1.f,     1.f, 0.f,              // 22
-	   1.0f, -1.f, -1.f,    0.f,  0.f, -1.f,     0.f, 0.f,              // 23
-};
-
-std::vector<GLuint> indicesCube = {
-	0,   1,  2,  2,  3,  0, // front
-	4,   5,  6,  6,  7,  4, // back
-	8,   9, 10, 10, 11,  8, // right
-	12, 13, 14, 14, 15, 12, // left
-	16, 17, 18, 18, 19, 16, // top
-	20, 21, 22, 22, 23, 20  // bottom
-};
+namespace SimpleEngine {
+	// GPU resources are assets, entities only point to them
+	AssetRef<Mesh> cubeMesh;
+	AssetRef<Model> lightModel;
+
+	World world;
+	// cells of world file around camera, on top of demo scene
+	WorldStreamer worldStreamer;
+	Entity cubeEntity;
+	Entity groundCubeEntity;
+	Entity wallCubeEntity;
+	Entity pointLightEntity;
+
+	SceneGraph scene;
+	SceneGraph::NodeId sceneRootNode = SceneGraph::s_invalid_node;
+	SceneGraph::NodeId cubeNode = SceneGraph::s_invalid_node;
+	SceneGraph::NodeId pointLightNode = SceneGraph::s_invalid_node;
+	glm::mat4 cubeLocalMatrix{ 1.f };
+	float cubeNodeScale = 1.f;
+	glm::vec3 pointLightNodePosition{ 0.f };
+
+	// point and spot lights are culled per cluster on main thread and read from buffers by phong shader
+	ClusterLightAssigner lightAssigner;
+	std::unique_ptr<ClusterLightBuffers> lightBuffers;
+
+	// directional light shadow, static casters are cached on render thread
+	std::unique_ptr<ShadowRenderer> shadowRenderer;
+	static_assert(Application::s_max_shadow_cascades == ShadowCascades::s_max_cascades, "Shadow stats size");
+	static_assert(Application::s_input_latency_history == LatencyProbe::s_history_size, "Input latency history size");
+	static_assert(Application::s_frame_interval_history == LatencyProbe::s_history_size, "Frame interval history size");
+	static_assert(Application::s_memory_tags_count == static_cast<size_t>(MemoryTag::Count), "Memory tags count");
+	static_assert(Application::s_asset_types_count == static_cast<size_t>(AssetType::Count), "Asset types count");
+
+	// scene goes to offscreen float depth target and is copied to window before UI
+	std::unique_ptr<FrameBuffer> sceneFramebuffer;
+	std::unique_ptr<ShaderProgram> depthProgram;
+	std::unique_ptr<GpuQuery> prepassFragmentsQuery;
+	std::unique_ptr<GpuQuery> colorFragmentsQuery;
+
+	// CPU depth of ground and wall, entities hidden by them are not drawn
+	OccluderMesh occluderBox = OccluderMesh::make_box();
+	OcclusionBuffer occlusionBuffer;
+
+	// demo objects culled by compute shader and drawn by one indirect call
+	std::unique_ptr<GpuDrivenRenderer> gpuDrivenRenderer;
+
+	// the oldest input event dispatched since the last packet, recorded before any other listener runs
+	constexpr int s_input_probe_priority = std::numeric_limits<int>::max();
+	bool frameHasInputEvent = false;
+	FramePacket::Clock::time_point frameInputEventTime;
+	CameraLatch cameraLatch;
+
+	template<typename TEvent>
+	void add_input_probe(EventDispatcher& dispatcher) {
+		dispatcher.add_event_listener<TEvent>([](TEvent& event) {
+			if (!frameHasInputEvent || event.timestamp < frameInputEventTime) {
+				frameInputEventTime = event.timestamp;
+				frameHasInputEvent = true;
+			}
+		}, s_input_probe_priority);
+	}
 
+	int get_swap_interval(const FramePacing pacing) {
+		switch (pacing) {
+		case FramePacing::VSync: return 1;
+		case FramePacing::AdaptiveVSync: return -1;
+		case FramePacing::Uncapped:
+		case FramePacing::FixedRate: return 0;
+		}
+		return 1;
+	}
 
-namespace SimpleEngine {
-	std::unique_ptr<Cube> cube;
-	std::unique_ptr<LightCube> lightCube;
-	std::unique_ptr<Cube> groundCube;
-	std::unique_ptr<Model> model;
+	// randomly placed point lights above the ground, seed is fixed so every run looks the same
+	std::vector<Entity> demoLightEntities;
+	std::mt19937 demoLightsRandom{ 1234 };
 
-	std::unique_ptr<Cube> directionalLightCube;
+	void update_demo_lights(const size_t count) {
+		while (demoLightEntities.size() > count) {
+			world.destroy(demoLightEntities.back());
+			demoLightEntities.pop_back();
+		}
+		std::uniform_real_distribution<float> horizontal(-40.f, 40.f);
+		std::uniform_real_distribution<float> height(-0.5f, 2.f);
+		std::uniform_real_distribution<float> color(0.2f, 1.f);
+		while (demoLightEntities.size() < count) {
+			const glm::vec3 light_color(color(demoLightsRandom), color(demoLightsRandom), color(demoLightsRandom));
+			LightComponent light;
+			light.light = SpotLight(glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f),
+				glm::vec3(0.f), light_color, light_color, 0.f, 1.f, 0.5f, 1.f, 0.35f, 0.44f);
+			TransformComponent transform;
+			transform.model_matrix = make_local_matrix(
+				glm::vec3(horizontal(demoLightsRandom), horizontal(demoLightsRandom), height(demoLightsRandom)), glm::vec3(0), glm::vec3(1.f));
+			demoLightEntities.push_back(world.create(std::move(light), std::move(transform)));
+		}
+	}
+
+	// small textured cubes on both sides of the wall
+	Cube* demoObjectDrawable = nullptr;
+	std::vector<Entity> demoObjectEntities;
+	std::mt19937 demoObjectsRandom{ 4321 };
+
+	void update_demo_objects(const size_t count) {
+		while (demoObjectEntities.size() > count) {
+			world.destroy(demoObjectEntities.back());
+			demoObjectEntities.pop_back();
+		}
+		std::uniform_real_distribution<float> horizontal(-40.f, 40.f);
+		std::uniform_real_distribution<float> scale(0.2f, 0.6f);
+		while (demoObjectEntities.size() < count) {
+			const float object_scale = scale(demoObjectsRandom);
+			TransformComponent transform;
+			transform.model_matrix = make_local_matrix(
+				glm::vec3(horizontal(demoObjectsRandom), horizontal(demoObjectsRandom), -1.f + object_scale), glm::vec3(0), glm::vec3(object_scale));
+			transform.normal_matrix = glm::transpose(glm::inverse(glm::mat3(transform.model_matrix)));
+			demoObjectEntities.push_back(world.create(std::move(transform),
+				MeshComponent{ demoObjectDrawable }, MaterialComponent{ Material() },
+				BoundsComponent{ glm::vec3(0.f), glm::vec3(1.f) }, GpuInstanceComponent{}));
+		}
+	}
+
+	// light model is drawn at point light position
+	glm::mat4 get_point_light_local_matrix(const glm::vec3& position) {
+		const glm::mat4 rotate_mat = glm::rotate(glm::mat4(1.0f), glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f));
+		return rotate_mat * make_local_matrix(position, glm::vec3(0), glm::vec3(3 * 0.05f));
+	}
 
 	Application::Application() {
+		Log::init();
+		AllocationTracker::init();
 		LOG_INFO("Starting Application");
 	}
 
 	Application::~Application() {
 		LOG_INFO("Closing Application");
+		Log::shutdown();
 	}
 
 	int Application::start(unsigned int window_width, unsigned int window_heigth, const char* title) {
-		m_pWindow = std::make_unique<Window>(title, window_width, window_heigth);
+		JobSystem::init();
+		// loose files for development, archive mounted over them gives packed files first
+		FileSystem::mount_directory("", getBasePath());
+		// changed assets are cooked before packing, so archive gets them too
+		if (std::getenv("SIMPLE_ENGINE_COOK")) {
+			AssetCooker::cook(getBasePath(), { "shaders", "textures", "models", "worlds" }, getBasePath() / "cooked", AssetCooker::Settings());
+		}
+		if (const char* pack_path = std::getenv("SIMPLE_ENGINE_PACK")) {
+			if (std::getenv("SIMPLE_ENGINE_BUILD_PACK")) {
+				std::vector<std::filesystem::path> packed = { "shaders", "textures", "models", "worlds" };
+				if (std::filesystem::is_directory(getBasePath() / "cooked")) {
+					packed.push_back("cooked");
+				}
+				PackArchive::build(getBasePath(), packed, pack_path, PackArchive::BuildSettings());
+			}
+			FileSystem::mount_archive("", pack_path);
+		}
+		// source paths give cooked files from here on, sources are used for what was not cooked
+		if (FileSystem::exists("cooked/manifest.txt")) {
+			FileSystem::mount_manifest("cooked/manifest.txt");
+		}
+		AsyncIO::Settings io_settings;
+		if (const char* io_backend = std::getenv("SIMPLE_ENGINE_IO")) {
+			io_settings.use_io_uring = std::strcmp(io_backend, "threads") != 0;
+		}
+		AsyncIO::init(io_settings);
+		if (const char* test_frames = std::getenv("SIMPLE_ENGINE_ZERO_ALLOC_TEST")) {
+			zero_alloc_test_frames = std::max<size_t>(std::strtoul(test_frames, nullptr, 10), 1);
+		}
+		m_pWindow = std::make_unique<Window>(title, window_width, window_heigth, !use_render_thread);
 		camera.set_viewport_size(static_cast<float>(window_width), static_cast<float>(window_heigth));
+		add_input_probe<EventKeyPressed>(m_event_dispatcher);
+		add_input_probe<EventKeyReleased>(m_event_dispatcher);
+		add_input_probe<EventMouseButtonPressed>(m_event_dispatcher);
+		add_input_probe<EventMouseButtonReleased>(m_event_dispatcher);
+		add_input_probe<EventMouseMoved>(m_event_dispatcher);
+		add_input_probe<EventMouseScroll>(m_event_dispatcher);
 		m_event_dispatcher.add_event_listener<EventMouseMoved>(
 			[](EventMouseMoved& event) {
-				//LOG_INFO("[MouseMoved] Mouse moved to {0}x{1}", event.x, event.y);
+				LOG_TRACE_TO(Input, "[MouseMoved] Mouse moved to {0}x{1}", event.x, event.y);
 			}
 		);
 		m_event_dispatcher.add_event_listener<EventWindowResize>(
 			[&](EventWindowResize& event) {
-				LOG_INFO("[WindowResized] Window resized to {0}x{1}", event.w, event.h);
+				LOG_INFO_TO(Input, "[WindowResized] Window resized to {0}x{1}", event.w, event.h);
 				camera.set_viewport_size(static_cast<float>(event.w), static_cast<float>(event.h));
-
-				draw();
 			}
 		);
 		m_event_dispatcher.add_event_listener<EventWindowClosed>(
 			[&](EventWindowClosed& event) {
-				LOG_INFO("[WindowClosed]");
+				LOG_INFO_TO(Input, "[WindowClosed]");
 				close();
 			}
 		);
 		m_event_dispatcher.add_event_listener<EventKeyPressed>(
 			[&](EventKeyPressed& event) {
-				LOG_INFO("[EventKeyPressed]");
+				LOG_DEBUG_TO(Input, "[EventKeyPressed] {0}", event.key_code);
 				Input::PressKey(event.key_code);
 			}
 		);
 		m_event_dispatcher.add_event_listener<EventKeyReleased>(
 			[&](EventKeyReleased& event) {
-				LOG_INFO("[EventKeyReleased]");
+				LOG_DEBUG_TO(Input, "[EventKeyReleased] {0}", event.key_code);
 				Input::ReleaseKey(event.key_code);
 			}
 		);
 		m_event_dispatcher.add_event_listener<EventMouseButtonPressed>(
 			[&](EventMouseButtonPressed& event) {
-				LOG_INFO("[EventMouseButtonPressed]");
+				LOG_DEBUG_TO(Input, "[EventMouseButtonPressed] {0}", event.mouse_button_code);
 				Input::PressMouseButton(event.mouse_button_code);
 				on_mouse_button_event(event.mouse_button_code, event.x_pos, event.y_pos, true);
 			}
 		);
 		m_event_dispatcher.add_event_listener<EventMouseButtonReleased>(
 			[&](EventMouseButtonReleased& event) {
-				LOG_INFO("[EventMouseButtonReleased]");
+				LOG_DEBUG_TO(Input, "[EventMouseButtonReleased] {0}", event.mouse_button_code);
 				Input::ReleaseMouseButton(event.mouse_button_code);
 				on_mouse_button_event(event.mouse_button_code, event.x_pos, event.y_pos, false);
 			}
@@ -136,7 +277,7 @@ namespace SimpleEngine {
 
 		m_event_dispatcher.add_event_listener<EventMouseScroll>(
 			[&](EventMouseScroll& event) {
-				LOG_INFO("[EventMouseScroll] xoffset{0} and yoffset{1}", event.xoffset, event.yoffset);
+				LOG_DEBUG_TO(Input, "[EventMouseScroll] xoffset {0} and yoffset {1}", event.xoffset, event.yoffset);
 				scroll = true;
 				if (event.yoffset > 0)
 					scrollUp = true;
@@ -145,124 +286,208 @@ namespace SimpleEngine {
 			}
 		);
 
+		// GLFW callbacks only queue, everything polled in a frame is dispatched at once after poll
 		m_pWindow->set_event_callback(
 			[&](BaseEvent& event) {
-				m_event_dispatcher.dispatch(event);
+				m_event_dispatcher.queue(event);
 			});
 
-		DirectionalLight dirLight(
-			directional_light_direction, light_ambient_factor, light_diffuse_factor, light_specular_factor,
-			light_ambient_intensity, light_diffuse_intensity, light_specular_intensity);
-		PointLight pointLight(
-			point_light_position, light_ambient_factor, light_diffuse_factor, light_specular_factor,
-			light_ambient_intensity, light_diffuse_intensity, light_specular_intensity);
-		SpotLight spotLight(camera.get_camera_pos(), camera.get_camera_direction(),
-			light_ambient_factor, light_diffuse_factor, light_specular_factor,
-			light_ambient_intensity, light_diffuse_intensity, light_specular_intensity);
-
 		// Textures paths
-		std::filesystem::path cubeDiffuseTexturePath = getBasePath() / "textures" / "material.diffuse.png";
-		std::filesystem::path cubeSpecularTexturePath = getBasePath() / "textures" / "material.specular.png";
+		std::filesystem::path cubeDiffuseTexturePath = "textures/material.diffuse.png";
+		std::filesystem::path cubeSpecularTexturePath = "textures/material.specular.png";
 		std::vector<std::filesystem::path> v_texturePaths;
 		v_texturePaths.push_back(cubeDiffuseTexturePath);
 		v_texturePaths.push_back(cubeSpecularTexturePath);
-		// Cube with 2 textures
+
+		std::filesystem::path lightModelPath = "models/cube/cube.obj";
+		std::filesystem::path lightVertexShaderPath = "shaders/light_cube_vertex_shader.glsl";
+		std::filesystem::path lightFragShaderPath = "shaders/light_cube_fragment_shader.glsl";
+
+		// files of the scene are read and decoded by jobs together, meshes below find them loaded
 		{
-			std::filesystem::path shaderPath = getBasePath() / "shaders";
+			const auto preload_start = std::chrono::steady_clock::now();
+			AssetBatch scenePreload;
+			{
+				GpuMemoryScope gpu_memory_owner("Cube");
+				for (const std::filesystem::path& texturePath : v_texturePaths) {
+					scenePreload.add_texture(texturePath);
+				}
+			}
+			{
+				GpuMemoryScope gpu_memory_owner("Light model");
+				scenePreload.add_model(lightModelPath, MeshType::LightCube, lightVertexShaderPath, lightFragShaderPath);
+			}
+			scenePreload.wait();
+			if (scenePreload.get_failed_count() > 0) {
+				LOG_ERROR("{0} scene assets failed to load", scenePreload.get_failed_count());
+			}
+			const FileSystem::Stats file_stats = FileSystem::get_stats();
+			const AsyncIO::Stats io_stats = AsyncIO::get_stats();
+			LOG_INFO_TO(Assets, "Scene preload: {0:.1f} ms, {1} files, {2} bytes, {3} from archive ({4} without copy), "
+				"{5} async reads by {6} ({7} bytes)",
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - preload_start).count(),
+				file_stats.files_read, file_stats.bytes_read, file_stats.archive_reads, file_stats.mapped_reads,
+				io_stats.requests, AsyncIO::get_backend_name(AsyncIO::get_backend()), io_stats.bytes_read);
+		}
+
+		// cube and ground are children of scene root, moving root moves both
+		sceneRootNode = scene.create_node();
+
+		// Cube with 2 textures, the same mesh is used for ground
+		{
+			GpuMemoryScope gpu_memory_owner("Cube");
+			std::filesystem::path shaderPath = "shaders";
 			std::filesystem::path vertex_shader_path = shaderPath / "phong_cube_vertex_shader.glsl";
 			std::filesystem::path frag_shader_path = shaderPath / "phong_cube_fragment_shader.glsl";
 
-			cube = std::make_unique<Cube>(
-				Material(),
+			cubeMesh = AssetRef<Mesh>(AssetManager::add_mesh("Textured cube", std::make_unique<Cube>(
 				vertex_shader_path,
 				frag_shader_path,
-				glm::vec3{ -2.f, -2.f, 4.f },
 				v_texturePaths,
-				verticesCube,
-				indicesCube,
-				camera,
-				dirLight, useDirectionalLight,
-				pointLight, usePointLight,
-				spotLight, useSpotLight,
-				glm::vec3(0), glm::vec3(cube_scale_factor)
-			);
+				Primitive::Cube
+			)));
+			Cube* texturedCube = static_cast<Cube*>(cubeMesh.get());
+
+			cubeLocalMatrix = make_local_matrix(glm::vec3{ -2.f, -2.f, 4.f }, glm::vec3(0), glm::vec3(1.f));
+			cubeNode = scene.create_node(sceneRootNode, cubeLocalMatrix);
+			cubeNodeScale = 1.f;
+			cubeEntity = world.create(
+				SceneNodeComponent{ cubeNode }, TransformComponent{},
+				MeshComponent{ texturedCube }, MaterialComponent{ Material(glm::vec3(1.f), cube_shininess) },
+				ShadowCasterComponent{ false }, BoundsComponent{ glm::vec3(0.f), glm::vec3(1.f) });
+
+			const SceneGraph::NodeId groundCubeNode = scene.create_node(sceneRootNode,
+				make_local_matrix(glm::vec3{ 0, 0, -2 }, glm::vec3(0), glm::vec3{ 50, 50, 1 }));
+			groundCubeEntity = world.create(
+				SceneNodeComponent{ groundCubeNode }, TransformComponent{},
+				MeshComponent{ texturedCube }, MaterialComponent{ Material() },
+				ShadowCasterComponent{ true }, BoundsComponent{ glm::vec3(0.f), glm::vec3(1.f) },
+				OccluderComponent{ &occluderBox });
+
+			const SceneGraph::NodeId wallCubeNode = scene.create_node(sceneRootNode,
+				make_local_matrix(glm::vec3{ 10, 0, 2 }, glm::vec3(0), glm::vec3{ 0.5f, 20, 3 }));
+			wallCubeEntity = world.create(
+				SceneNodeComponent{ wallCubeNode }, TransformComponent{},
+				MeshComponent{ texturedCube }, MaterialComponent{ Material() },
+				ShadowCasterComponent{ true }, BoundsComponent{ glm::vec3(0.f), glm::vec3(1.f) },
+				OccluderComponent{ &occluderBox });
+			demoObjectDrawable = texturedCube;
 		}
 
-		// Directional light cube (to immitate it)
+		// Model testing, follows point light
 		{
-			std::filesystem::path shaderPath = getBasePath() / "shaders";
-			std::filesystem::path vertex_shader_path = shaderPath / "phong_cube_vertex_shader.glsl";
-			std::filesystem::path frag_shader_path = shaderPath / "phong_cube_fragment_shader.glsl";
-			std::vector<std::filesystem::path> v_texturePathsEmpty;
-			directionalLightCube = std::make_unique<Cube>(
-				Material(glm::vec3(1), 0),
-				vertex_shader_path,
-				frag_shader_path,
-				glm::vec3{ 0.f, 0.f, 10.f },
-				v_texturePathsEmpty,
-				verticesCube,
-				indicesCube,
-				camera,
-				dirLight, false,
-				pointLight, false,
-				spotLight, false,
-				dirLight.direction, glm::vec3(0.1, 0.1, 0.5)
-			);
-		}
-
-		// Light cube 
-		{
-			std::filesystem::path shaderPath = getBasePath() / "shaders";
-			std::filesystem::path vertex_shader_path = shaderPath / "light_cube_vertex_shader.glsl";
-			std::filesystem::path frag_shader_path = shaderPath / "light_cube_fragment_shader.glsl";
-			lightCube = std::make_unique<LightCube>(
-				verticesCube, indicesCube,
-				vertex_shader_path, frag_shader_path,
-				camera, pointLight
-			);
+			GpuMemoryScope gpu_memory_owner("Light model");
+			lightModel = AssetRef<Model>(AssetManager::load_model(
+				lightModelPath, MeshType::LightCube, lightVertexShaderPath, lightFragShaderPath));
+			AssetManager::wait(lightModel.get_handle());
+
+			pointLightNodePosition = point_light_position;
+			pointLightNode = scene.create_node(SceneGraph::s_invalid_node, get_point_light_local_matrix(pointLightNodePosition));
+			if (lightModel.get()) {
+				BoundsComponent lightModelBounds;
+				float lightModelRadius = 0.f;
+				lightModel->GetBoundingSphere(lightModelBounds.center, lightModelRadius);
+				lightModelBounds.extent = glm::vec3(lightModelRadius);
+				pointLightEntity = world.create(
+					SceneNodeComponent{ pointLightNode }, TransformComponent{},
+					MeshComponent{ lightModel.get() }, MaterialComponent{ Material() }, std::move(lightModelBounds));
+			}
+			else {
+				// light still moves, only nothing is drawn at its position
+				pointLightEntity = world.create(SceneNodeComponent{ pointLightNode }, TransformComponent{});
+			}
+		}
+
+		// only the list of cells is read here, cells are streamed in by frames around camera
+		if (const char* world_path = std::getenv("SIMPLE_ENGINE_WORLD")) {
+			world_streaming = worldStreamer.open(world_path, world);
 		}
 
-		// Ground cube 
 		{
-			std::filesystem::path shaderPath = getBasePath() / "shaders";
-			std::filesystem::path vertex_shader_path = shaderPath / "phong_cube_vertex_shader.glsl";
-			std::filesystem::path frag_shader_path = shaderPath / "phong_cube_fragment_shader.glsl";
-			//std::filesystem::path groundCubeTexturePath = getBasePath() / "textures" / "dirt.png";
-			//std::vector<std::filesystem::path> v_texturePaths;
-			groundCube = std::make_unique<Cube>(
-				Material(),
-				vertex_shader_path,
-				frag_shader_path,
-				glm::vec3{ 0,0,-2 },
-				v_texturePaths,
-				verticesCube,
-				indicesCube, camera,
-				dirLight, useDirectionalLight,
-				pointLight, usePointLight,
-				spotLight, useSpotLight,
-				glm::vec3(0), glm::vec3{ 50, 50, 1 }
-			);
+			GpuMemoryScope gpu_memory_owner("Clustered lights");
+			lightBuffers = std::make_unique<ClusterLightBuffers>();
+		}
+		{
+			GpuMemoryScope gpu_memory_owner("Shadows");
+			shadowRenderer = std::make_unique<ShadowRenderer>();
+		}
+		{
+			GpuMemoryScope gpu_memory_owner("Scene framebuffer");
+			sceneFramebuffer = std::make_unique<FrameBuffer>(m_pWindow->get_framebuffer_width(), m_pWindow->get_framebuffer_height());
+		}
+		{
+			std::filesystem::path shaderPath = "shaders";
+			depthProgram = std::make_unique<ShaderProgram>(
+				(shaderPath / "depth_only_vertex_shader.glsl").string(),
+				(shaderPath / "depth_only_fragment_shader.glsl").string());
+			if (!depthProgram->is_compiled()) {
+				LOG_CRIT("Depth only shader program is not compiled, depth pre-pass is disabled");
+				use_depth_prepass = false;
+			}
 		}
+		prepassFragmentsQuery = std::make_unique<GpuQuery>(GpuQuery::EType::FragmentShaderInvocations);
+		colorFragmentsQuery = std::make_unique<GpuQuery>(GpuQuery::EType::FragmentShaderInvocations);
 
-		// Model testing
 		{
-			std::filesystem::path shaderPath = getBasePath() / "shaders";
-			std::filesystem::path vertex_shader_path = shaderPath / "light_cube_vertex_shader.glsl";
-			std::filesystem::path frag_shader_path = shaderPath / "light_cube_fragment_shader.glsl";
-			std::filesystem::path modelPath = getBasePath() / "models/cube";
-			model = std::make_unique<Model>(
-				MeshType::LightCube, modelPath / "cube.obj",
-				vertex_shader_path, frag_shader_path
-			);
+			GpuMemoryScope gpu_memory_owner("GPU driven");
+			gpuDrivenRenderer = std::make_unique<GpuDrivenRenderer>(*demoObjectDrawable);
+		}
+		if (!gpuDrivenRenderer->is_ready()) {
+			use_gpu_driven = false;
+		}
+		if (!Renderer_OpenGL::supports_indirect_count()) {
+			LOG_INFO("No OpenGL 4.6, GPU driven renderer issues all indirect commands");
 		}
 
 		Renderer_OpenGL::enable_depth_testing();
+
+		// all resources are created, from now on OpenGL is used only from render_frame
+		m_pFramePacer = std::make_unique<FramePacer>();
+		m_pRenderThread = std::make_unique<RenderThread>();
+		m_pRenderThread->start(*m_pWindow, [this](const FramePacket& packet) { render_frame(packet); }, use_render_thread);
 		while (!m_bCloseWindow) {
-			draw();
+			update_frame();
 		}
 
 		// clean up
+		m_pRenderThread->stop();
+		m_pRenderThread = nullptr;
+		m_pFramePacer = nullptr;
+		// GPU resources are deleted while context still exists
+		world.destroy(cubeEntity);
+		world.destroy(groundCubeEntity);
+		world.destroy(wallCubeEntity);
+		world.destroy(pointLightEntity);
+		update_demo_lights(0);
+		update_demo_objects(0);
+		worldStreamer.close(world);
+		gpuDrivenRenderer = nullptr;
+		cubeMesh.reset();
+		lightModel.reset();
+		lightBuffers = nullptr;
+		shadowRenderer = nullptr;
+		sceneFramebuffer = nullptr;
+		depthProgram = nullptr;
+		prepassFragmentsQuery = nullptr;
+		colorFragmentsQuery = nullptr;
+		AssetManager::shutdown();
+		AsyncIO::shutdown();
+		FileSystem::unmount_all();
+		JobSystem::shutdown();
 		m_pWindow = nullptr;
+
+		if (zero_alloc_test_frames > 0) {
+			if (!AllocationTracker::is_enabled()) {
+				LOG_ERROR("Zero allocation test needs engine built with SIMPLE_ENGINE_ALLOCATION_HOOKS");
+				return 1;
+			}
+			AllocationTracker::report_violations();
+			if (zero_alloc_violations > 0) {
+				LOG_ERROR("Zero allocation test failed: {0} heap calls in {1} frames", zero_alloc_violations, zero_alloc_test_frames);
+				return 1;
+			}
+			LOG_INFO("Zero allocation test passed: {0} frames without heap calls", zero_alloc_test_frames);
+		}
 		return 0;
 	}
 
@@ -270,62 +495,392 @@ namespace SimpleEngine {
 		return m_pWindow->get_current_cursor_pos();
 	}
 
-	void Application::draw()
+	void Application::update_frame()
 	{
-		Renderer_OpenGL::set_clear_color(
-			m_background_color[0], m_background_color[1], m_background_color[2], m_background_color[3]);
-		Renderer_OpenGL::clear();
+		// limiter waits before input is polled, so the wait doesn't add to input latency
+		m_pFramePacer->set_target_rate(frame_pacing == FramePacing::FixedRate ? frame_rate_limit : 0.f);
+		frame_limiter_wait_ms = m_pFramePacer->wait();
+		frame_limiter_missed = m_pFramePacer->get_missed_frames();
+
+		m_pWindow->poll_events();
 
-		DirectionalLight dirLight(
+		m_check_allocations = AllocationTracker::is_enabled() && m_frames_count >= zero_alloc_warmup_frames;
+		const uint64_t allocations_before = AllocationTracker::get_thread_counters().allocations;
+		{
+			NoAllocScope no_alloc_scope("update_frame", m_check_allocations);
+			build_frame();
+		}
+		// render thread count is of the previous packet, with render thread off it's this one
+		frame_heap_allocations = AllocationTracker::get_thread_counters().allocations - allocations_before +
+			m_render_heap_allocations.load(std::memory_order_relaxed);
+
+		m_pRenderThread->submit_frame();
+		++m_frames_count;
+
+		if (m_check_allocations) {
+			zero_alloc_violations = AllocationTracker::get_violations_count();
+			AllocationTracker::report_violations();
+		}
+		if (zero_alloc_test_frames > 0 && m_frames_count >= zero_alloc_warmup_frames + zero_alloc_test_frames) {
+			close();
+		}
+	}
+
+	void Application::build_frame()
+	{
+		m_event_dispatcher.flush();
+
+		const RenderThread::Stats render_stats = m_pRenderThread->get_stats();
+		frame_cpu_time_ms = render_stats.cpu_frame_ms;
+		frame_render_time_ms = render_stats.render_ms;
+		frame_latency_ms = render_stats.latency_ms;
+		frame_draw_calls = m_rendered_draw_calls.load(std::memory_order_relaxed);
+		frame_triangles = m_rendered_triangles.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < s_max_shadow_cascades; ++i) {
+			frame_shadow_cascade_ms[i] = m_shadow_cascade_ms[i].load(std::memory_order_relaxed);
+		}
+		frame_shadow_static_redraws = m_shadow_static_redraws.load(std::memory_order_relaxed);
+		frame_prepass_fragments = m_prepass_fragments.load(std::memory_order_relaxed);
+		frame_color_fragments = m_color_fragments.load(std::memory_order_relaxed);
+		frame_gpu_visible_instances = m_gpu_visible_instances.load(std::memory_order_relaxed);
+		frame_gpu_cull_ms = m_gpu_cull_ms.load(std::memory_order_relaxed);
+		const LatencyProbe& input_latency = m_pRenderThread->get_input_latency();
+		input_latency_samples = input_latency.get_history(input_latency_history, s_input_latency_history);
+		const LatencyProbe::Summary latency_summary = input_latency.get_summary();
+		input_latency_p50_ms = latency_summary.p50_ms;
+		input_latency_p95_ms = latency_summary.p95_ms;
+		input_latency_p99_ms = latency_summary.p99_ms;
+		input_latency_max_ms = latency_summary.max_ms;
+		const LatencyProbe& frame_intervals = m_pRenderThread->get_frame_intervals();
+		frame_interval_samples = frame_intervals.get_history(frame_interval_history, s_frame_interval_history);
+		const LatencyProbe::Summary interval_summary = frame_intervals.get_summary();
+		frame_interval_mean_ms = interval_summary.mean_ms;
+		frame_interval_stddev_ms = interval_summary.stddev_ms;
+		frame_interval_p99_ms = interval_summary.p99_ms;
+		frame_interval_max_ms = interval_summary.max_ms;
+		frame_swap_interval = render_stats.swap_interval;
+		for (size_t i = 0; i < s_memory_tags_count; ++i) {
+			const MemoryTracker::Stats memory_stats = MemoryTracker::get_stats(static_cast<MemoryTag>(i));
+			memory_tag_names[i] = MemoryTracker::get_tag_name(static_cast<MemoryTag>(i));
+			memory_live_bytes[i] = memory_stats.live_bytes;
+			memory_peak_bytes[i] = memory_stats.peak_bytes;
+			memory_live_allocations[i] = memory_stats.live_allocations;
+			memory_total_allocations[i] = memory_stats.total_allocations;
+		}
+		const FixedPool::Stats chunk_pool_stats = world.get_chunk_pool_stats();
+		ecs_chunks = chunk_pool_stats.live_blocks;
+		ecs_chunk_pages = chunk_pool_stats.pages;
+		GpuMemory::set_budget(static_cast<size_t>(gpu_memory_budget_mb) << 20);
+		static_assert(s_gpu_memory_categories_count == static_cast<size_t>(GpuMemoryCategory::Count));
+		for (size_t i = 0; i < s_gpu_memory_categories_count; ++i) {
+			const GpuMemory::CategoryStats category_stats = GpuMemory::get_category_stats(static_cast<GpuMemoryCategory>(i));
+			gpu_memory_category_names[i] = GpuMemory::get_category_name(static_cast<GpuMemoryCategory>(i));
+			gpu_memory_category_bytes[i] = category_stats.bytes;
+			gpu_memory_category_peak_bytes[i] = category_stats.peak_bytes;
+			gpu_memory_category_allocations[i] = category_stats.allocations;
+		}
+		GpuMemory::OwnerStats gpu_owners[s_gpu_memory_owners_max];
+		gpu_memory_owners_count = GpuMemory::get_owner_stats(gpu_owners, s_gpu_memory_owners_max);
+		for (size_t i = 0; i < gpu_memory_owners_count; ++i) {
+			gpu_memory_owner_names[i] = gpu_owners[i].owner;
+			gpu_memory_owner_bytes[i] = gpu_owners[i].bytes;
+		}
+		gpu_memory_total_bytes = GpuMemory::get_total_bytes();
+		const GpuMemory::DriverInfo gpu_driver_info = GpuMemory::get_driver_info();
+		gpu_memory_driver_info = gpu_driver_info.available;
+		gpu_memory_driver_total_bytes = gpu_driver_info.total_bytes;
+		gpu_memory_driver_free_bytes = gpu_driver_info.free_bytes;
+		gpu_memory_driver_evicted_bytes = gpu_driver_info.evicted_bytes;
+		const GpuMemory::ResidencyStats residency_stats = GpuMemory::get_residency_stats();
+		gpu_memory_evictables = residency_stats.evictables;
+		gpu_memory_resident = residency_stats.resident;
+		gpu_memory_evictions = residency_stats.evictions;
+
+		for (size_t i = 0; i < s_asset_types_count; ++i) {
+			const AssetType type = static_cast<AssetType>(i);
+			const AssetManager::Stats asset_stats = AssetManager::get_stats(type);
+			asset_type_names[i] = AssetManager::get_type_name(type);
+			asset_ready[i] = asset_stats.ready;
+			asset_loading[i] = asset_stats.loading;
+			asset_failed[i] = asset_stats.failed;
+			asset_unused[i] = asset_stats.unused;
+			asset_hits[i] = asset_stats.path_hits + asset_stats.content_hits;
+			asset_bytes[i] = asset_stats.bytes;
+			asset_saved_bytes[i] = asset_stats.saved_bytes;
+		}
+		AssetManager::set_upload_budget(static_cast<size_t>(std::max(upload_budget_kb, 0)) << 10,
+			std::max(upload_budget_ms, 0.f));
+		const AssetManager::UploadStats upload_stats = AssetManager::get_upload_stats();
+		upload_frame_count = upload_stats.frame_uploads;
+		upload_frame_bytes = upload_stats.frame_bytes;
+		upload_frame_ms = static_cast<float>(upload_stats.frame_ms);
+		upload_queued = upload_stats.queued;
+		upload_queued_bytes = upload_stats.queued_bytes;
+		upload_peak_queued_bytes = upload_stats.peak_queued_bytes;
+		upload_deferred_frames = upload_stats.deferred_frames;
+
+		on_update();
+
+		// everything below (draw list, clusters, cascades) uses projection of this frame
+		camera.set_reverse_z(use_reverse_z);
+
+		if (camera.if_update_view_matrix()) {
+			camera.update_view_matrix();
+			camera.set_update_view_matirx(false);
+		}
+		// render thread may still be drawing the previous packet, it can take this camera for it
+		cameraLatch.publish(camera, frameHasInputEvent, frameInputEventTime);
+
+		// entities of cells streamed in here are in draw list of this frame
+		if (world_streaming) {
+			WorldStreamer::Settings streamer_settings;
+			streamer_settings.load_radius = world_load_radius;
+			streamer_settings.unload_radius = world_unload_radius;
+			streamer_settings.max_loading_cells = static_cast<size_t>(std::max(world_max_loading_cells, 1));
+			worldStreamer.set_settings(streamer_settings);
+			worldStreamer.update(world, camera.get_position());
+			const WorldStreamer::Stats& world_stats = worldStreamer.get_stats();
+			world_cells = world_stats.cells;
+			world_loaded_cells = world_stats.loaded_cells;
+			world_loading_cells = world_stats.loading_cells;
+			world_peak_loaded_cells = world_stats.peak_loaded_cells;
+			world_entities = world_stats.entities;
+			world_stream_ins = world_stats.stream_ins;
+			world_evictions = world_stats.evictions;
+			world_stream_in_last_ms = static_cast<float>(world_stats.last_stream_in_ms);
+			world_stream_in_average_ms = static_cast<float>(world_stats.average_stream_in_ms);
+			world_stream_in_max_ms = static_cast<float>(world_stats.max_stream_in_ms);
+			world_peak_gpu_bytes = world_stats.peak_gpu_bytes;
+		}
+
+		// cube was created with scale 1, slider scales it on top of that
+		if (cube_scale_factor != cubeNodeScale) {
+			cubeNodeScale = cube_scale_factor;
+			scene.set_local_matrix(cubeNode, glm::scale(cubeLocalMatrix, glm::vec3(cube_scale_factor)));
+		}
+		if (point_light_position != pointLightNodePosition) {
+			pointLightNodePosition = point_light_position;
+			scene.set_local_matrix(pointLightNode, get_point_light_local_matrix(pointLightNodePosition));
+		}
+		if (MaterialComponent* cubeMaterial = world.get<MaterialComponent>(cubeEntity)) {
+			cubeMaterial->material.shininess = cube_shininess;
+		}
+		update_demo_lights(demo_lights_count);
+		update_demo_objects(demo_objects_count);
+		scene.update();
+		Systems::sync_transforms(world, scene);
+
+		FramePacket& packet = m_pRenderThread->begin_frame();
+		packet.swap_interval = get_swap_interval(frame_pacing);
+		packet.viewport_width = m_pWindow->get_framebuffer_width();
+		packet.viewport_height = m_pWindow->get_framebuffer_height();
+		for (int i = 0; i < 4; ++i) {
+			packet.background_color[i] = m_background_color[i];
+		}
+		packet.camera = camera;
+
+		packet.directional_light = DirectionalLight(
 			directional_light_direction, light_ambient_factor, light_diffuse_factor, light_specular_factor,
 			light_ambient_intensity, light_diffuse_intensity, light_specular_intensity);
-		PointLight pointLight(
+		packet.point_light = PointLight(
 			point_light_position, light_ambient_factor, light_diffuse_factor, light_specular_factor,
 			light_ambient_intensity, light_diffuse_intensity, light_specular_intensity);
-		SpotLight spotLight(camera.get_camera_pos(), camera.get_camera_direction(),
+		packet.use_directional_light = useDirectionalLight;
+
+		// lights from UI go first, then light entities
+		const SpotLight spot_light(camera.get_camera_pos(), camera.get_camera_direction(),
 			light_ambient_factor, light_diffuse_factor, light_specular_factor,
 			light_ambient_intensity, light_diffuse_intensity, light_specular_intensity);
+		packet.ambient_light = glm::vec3(0.2f);
+		packet.lights.clear();
+		if (usePointLight) {
+			packet.lights.push_back(ClusterLight::from_point_light(packet.point_light));
+			packet.ambient_light += packet.point_light.get_ambient();
+		}
+		if (useSpotLight) {
+			packet.lights.push_back(ClusterLight::from_spot_light(spot_light));
+			packet.ambient_light += spot_light.get_ambient();
+		}
+		Systems::gather_lights(world, packet.lights);
+
+		const auto light_culling_start = std::chrono::steady_clock::now();
+		lightAssigner.assign(camera, packet.viewport_width, packet.viewport_height,
+			packet.lights, packet.cluster_grid, packet.cluster_lists);
+		frame_light_culling_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - light_culling_start).count();
+		frame_lights = packet.lights.size();
+
+		packet.use_depth_prepass = use_depth_prepass;
+		packet.reverse_z = camera.is_reverse_z();
+		packet.late_latch_camera = use_camera_late_latch;
+		packet.has_input_event = frameHasInputEvent;
+		packet.input_event_time = frameInputEventTime;
+		frameHasInputEvent = false;
+
+		packet.shadow_cascades.count = 0;
+		if (use_shadows && useDirectionalLight) {
+			ShadowSettings shadow_settings;
+			shadow_settings.max_distance = shadow_distance;
+			shadow_settings.split_lambda = shadow_split_lambda;
+			ShadowCascades::build(camera, directional_light_direction, shadow_settings, packet.shadow_cascades);
+		}
+		packet.static_shadow_version = Systems::gather_shadow_casters(world,
+			packet.static_shadow_casters, packet.dynamic_shadow_casters);
+
+		const auto occlusion_start = std::chrono::steady_clock::now();
+		if (use_occlusion_culling) {
+			ArenaVector<Occluder> occluders{ ArenaAllocator<Occluder>(packet.arena) };
+			Systems::gather_occluders(world, occluders);
+			occlusionBuffer.render(camera, occluders);
+		}
+		const CullingStats culling_stats = Systems::build_draw_list(world, camera, lod_pixel_error,
+			packet.draws, use_occlusion_culling ? &occlusionBuffer : nullptr, use_gpu_driven);
+		frame_occlusion_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - occlusion_start).count();
+		frame_culling_tested = culling_stats.tested;
+		frame_frustum_culled = culling_stats.outside_frustum;
+		frame_occlusion_culled = culling_stats.occluded;
+
+		packet.use_gpu_driven = use_gpu_driven;
+		packet.gpu_instances.clear();
+		if (use_gpu_driven) {
+			Systems::gather_gpu_instances(world, packet.gpu_instances);
+		}
+		frame_gpu_instances = packet.gpu_instances.size();
+		frame_arena_used = packet.arena.get_used();
+		frame_arena_capacity = packet.arena.get_capacity();
 
-		if (camera.if_update_view_matrix()) {
-			camera.update_view_matrix();
-			camera.set_update_view_matirx(false);
+		UIModule::on_ui_build_begin();
+		on_ui_draw();
+		UIModule::on_ui_build_end(packet.ui_draw_data);
+
+		packet.check_allocations = m_check_allocations;
+	}
+
+	void Application::render_frame(const FramePacket& packet)
+	{
+		// buffer swap and window calls of render thread are outside of zone, drivers may allocate there
+		const uint64_t allocations_before = AllocationTracker::get_thread_counters().allocations;
+		NoAllocScope no_alloc_scope("render_frame", packet.check_allocations);
+
+		// results of background jobs which need OpenGL context, finished asset loads within upload budget
+		JobSystem::process_main_thread_jobs();
+		AssetManager::process_uploads();
+
+		m_rendered_draw_calls.store(Renderer_OpenGL::get_frame_stats().draw_calls, std::memory_order_relaxed);
+		m_rendered_triangles.store(Renderer_OpenGL::get_frame_stats().triangles, std::memory_order_relaxed);
+		Renderer_OpenGL::reset_frame_stats();
+
+		shadowRenderer->render(packet.shadow_cascades,
+			packet.static_shadow_casters, packet.dynamic_shadow_casters, packet.static_shadow_version);
+		const ShadowRenderer::Stats& shadow_stats = shadowRenderer->get_stats();
+		for (size_t i = 0; i < s_max_shadow_cascades; ++i) {
+			m_shadow_cascade_ms[i].store(shadow_stats.cascade_ms[i], std::memory_order_relaxed);
+		}
+		m_shadow_static_redraws.store(shadow_stats.static_redraws, std::memory_order_relaxed);
+
+		// late-latch: newer camera than the one packet was built with, culling and light clusters stay from packet
+		// so objects at screen edges may come one frame late when camera turns fast
+		Camera latched_camera;
+		bool latched_has_input = false;
+		FramePacket::Clock::time_point latched_input_time;
+		const bool use_latched_camera = packet.late_latch_camera &&
+			cameraLatch.get(latched_camera, latched_has_input, latched_input_time) &&
+			latched_camera.is_reverse_z() == packet.reverse_z &&
+			latched_camera.get_viewport_w() == packet.camera.get_viewport_w() &&
+			latched_camera.get_viewport_h() == packet.camera.get_viewport_h();
+		const Camera& frame_camera = use_latched_camera ? latched_camera : packet.camera;
+		if (use_latched_camera && latched_has_input) {
+			m_pRenderThread->set_presented_input_time(latched_input_time);
 		}
 
-		cube->UpdateLight(
-			dirLight, useDirectionalLight,
-			pointLight, usePointLight,
-			spotLight, useSpotLight
-		);
-		cube->UpdateCamera(camera);
-		cube->Draw();
-
-		/*directionalLightCube->UpdateDirVector(dirLight.direction);
-		directionalLightCube->UpdateCamera(camera);
-		directionalLightCube->Draw();
-
-		lightCube->UpdateLight(pointLight);
-		lightCube->UpdateCamera(camera);
-		lightCube->Draw();
-		*/
-
-		groundCube->UpdateLight(
-			dirLight, useDirectionalLight,
-			pointLight, usePointLight,
-			spotLight, useSpotLight
-		);
-		groundCube->UpdateCamera(camera);
-		groundCube->Draw();
+		// commands of visible instances for both passes, occlusion uses depth of the previous frame
+		const glm::mat4 view_projection = frame_camera.get_projection_matrix() * frame_camera.get_view_matrix();
+		if (packet.use_gpu_driven) {
+			gpuDrivenRenderer->cull(packet.gpu_instances, view_projection, packet.reverse_z);
+			m_gpu_visible_instances.store(gpuDrivenRenderer->get_stats().visible_instances, std::memory_order_relaxed);
+			m_gpu_cull_ms.store(gpuDrivenRenderer->get_stats().cull_ms, std::memory_order_relaxed);
+		}
+		else {
+			gpuDrivenRenderer->invalidate_depth_pyramid();
+		}
 
-		model->UpdateLight(pointLight);
-		model->UpdateCamera(camera);
-		model->Draw();
+		sceneFramebuffer->resize(packet.viewport_width, packet.viewport_height);
+		sceneFramebuffer->bind();
+		Renderer_OpenGL::set_reverse_z(packet.reverse_z);
+		const Renderer_OpenGL::EDepthFunc depth_func = packet.reverse_z
+			? Renderer_OpenGL::EDepthFunc::Greater : Renderer_OpenGL::EDepthFunc::Less;
+		Renderer_OpenGL::set_depth_func(depth_func);
+		Renderer_OpenGL::set_viewport(packet.viewport_width, packet.viewport_height);
+		Renderer_OpenGL::set_clear_color(
+			packet.background_color[0], packet.background_color[1], packet.background_color[2], packet.background_color[3]);
+		Renderer_OpenGL::clear();
 
-		UIModule::on_ui_draw_begin();
-		on_ui_draw();
-		UIModule::on_ui_draw_end();
+		lightBuffers->upload(packet.lights, packet.cluster_lists);
+		lightBuffers->bind();
+		shadowRenderer->bind_shadow_map();
+
+		const DrawContext context{
+			frame_camera,
+			packet.directional_light, packet.point_light,
+			packet.use_directional_light, packet.ambient_light, packet.cluster_grid, packet.shadow_cascades
+		};
+
+		// mvp of draw items was computed with packet camera
+		DrawInstance latched_instance;
+		const auto get_instance = [&](const DrawItem& draw_item) -> const DrawInstance& {
+			if (!use_latched_camera) {
+				return draw_item.instance;
+			}
+			latched_instance = draw_item.instance;
+			latched_instance.mvp_matrix = view_projection * draw_item.instance.model_matrix;
+			return latched_instance;
+		};
+
+		// nearest depth of every pixel first, color pass then runs fragment shader only for visible surface
+		if (packet.use_depth_prepass) {
+			Renderer_OpenGL::set_color_write(false);
+			depthProgram->bind();
+			prepassFragmentsQuery->begin();
+			for (const DrawItem& draw_item : packet.draws) {
+				draw_item.drawable->DrawDepthPrepass(context, get_instance(draw_item), *depthProgram);
+			}
+			if (packet.use_gpu_driven) {
+				gpuDrivenRenderer->draw_depth(view_projection);
+			}
+			prepassFragmentsQuery->end();
+			Renderer_OpenGL::set_color_write(true);
+			Renderer_OpenGL::set_depth_write(false);
+			Renderer_OpenGL::set_depth_func(Renderer_OpenGL::EDepthFunc::Equal);
+		}
+		m_prepass_fragments.store(packet.use_depth_prepass ? prepassFragmentsQuery->get_result() : 0, std::memory_order_relaxed);
 
-		m_pWindow->on_update();
-		on_update();
+		colorFragmentsQuery->begin();
+		for (const DrawItem& draw_item : packet.draws) {
+			draw_item.drawable->Draw(context, get_instance(draw_item));
+		}
+		if (packet.use_gpu_driven) {
+			gpuDrivenRenderer->draw(context, view_projection);
+		}
+		colorFragmentsQuery->end();
+		m_color_fragments.store(colorFragmentsQuery->get_result(), std::memory_order_relaxed);
+
+		Renderer_OpenGL::set_depth_write(true);
+		Renderer_OpenGL::set_depth_func(depth_func);
+		sceneFramebuffer->blit_to_default();
+		FrameBuffer::unbind();
+
+		if (packet.use_gpu_driven) {
+			gpuDrivenRenderer->update_depth_pyramid(sceneFramebuffer->get_depth_texture(),
+				sceneFramebuffer->get_width(), sceneFramebuffer->get_height(), view_projection, packet.reverse_z);
+		}
+
+		UIModule::render_draw_data(packet.ui_draw_data);
+		// resources this frame didn't draw can be evicted now
+		GpuMemory::end_frame();
+		// assets nothing references for a while are unloaded
+		AssetManager::update();
+
+		m_render_heap_allocations.store(AllocationTracker::get_thread_counters().allocations - allocations_before,
+			std::memory_order_relaxed);
 	}
 
 }
\ No newline at end of file
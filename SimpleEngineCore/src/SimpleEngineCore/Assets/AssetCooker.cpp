@@ -0,0 +1,615 @@
+#include "AssetCooker.h"
+#include "CookedFormats.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/IO/AssimpIOSystem.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/IO/XxHash.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Rendering/MeshSimplifier.h"
+#include "SimpleEngineCore/Scene/WorldLayout.h"
+
+#include "stb_image.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	namespace {
+		enum class CookKind : uint8_t {
+			Texture,
+			Shader,
+			Model,
+			World,
+			None
+		};
+
+		// bumped when cooked format or the way of cooking changes, every asset of the kind is cooked again
+		constexpr uint64_t s_cook_versions[] = { 1, 1, 2, 2 };
+		constexpr const char* s_cooked_extensions[] = { ".tex", "", ".mesh", ".cells" };
+
+		constexpr const char* s_state_name = "cook_state.txt";
+		constexpr std::string_view s_state_header = "SimpleEngine cook state 1";
+
+		CookKind get_kind(const std::filesystem::path& path)
+		{
+			std::string extension = path.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(),
+				[](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+			if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp"
+				|| extension == ".tga" || extension == ".psd" || extension == ".hdr") {
+				return CookKind::Texture;
+			}
+			if (extension == ".glsl" || extension == ".vert" || extension == ".frag" || extension == ".geom"
+				|| extension == ".comp") {
+				return CookKind::Shader;
+			}
+			// materials (.mtl) and other files models read are dependencies, not assets
+			if (extension == ".obj" || extension == ".3ds" || extension == ".fbx" || extension == ".dae"
+				|| extension == ".gltf" || extension == ".glb" || extension == ".ply" || extension == ".stl") {
+				return CookKind::Model;
+			}
+			if (extension == ".world") {
+				return CookKind::World;
+			}
+			return CookKind::None;
+		}
+
+		// paths are relative to root with '/' separators
+		struct FileState {
+			uint64_t size = 0;
+			int64_t write_time = 0;
+			uint64_t hash = 0;		// 0 when file is missing
+		};
+
+		struct AssetRecord {
+			uint64_t key = 0;
+			std::string output;		// relative to output, empty when cooking failed
+			std::vector<std::string> dependencies;
+		};
+
+		struct CookState {
+			std::unordered_map<std::string, FileState> files;
+			std::unordered_map<std::string, AssetRecord> assets;
+		};
+
+		std::vector<std::string_view> split(const std::string_view line, const char separator)
+		{
+			std::vector<std::string_view> parts;
+			size_t begin = 0;
+			while (true) {
+				const size_t end = line.find(separator, begin);
+				parts.push_back(line.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin));
+				if (end == std::string_view::npos) {
+					return parts;
+				}
+				begin = end + 1;
+			}
+		}
+
+		template<typename T>
+		bool parse_number(const std::string_view text, T& value, const int base = 10)
+		{
+			const std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value, base);
+			return result.ec == std::errc() && result.ptr == text.data() + text.size();
+		}
+
+		template<typename T>
+		void append_number(std::string& text, const T value, const int base = 10)
+		{
+			char buffer[24];
+			const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, base);
+			text.append(buffer, result.ptr);
+		}
+
+		bool read_disk(const std::filesystem::path& path, std::string& text)
+		{
+			FileData data;
+			if (!FileSystem::read(path, data)) {
+				return false;
+			}
+			text.assign(reinterpret_cast<const char*>(data.data()), data.size());
+			return true;
+		}
+
+		bool write_disk(const std::filesystem::path& path, const void* data, const size_t size)
+		{
+			std::error_code error;
+			std::filesystem::create_directories(path.parent_path(), error);
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				return false;
+			}
+			file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			file.close();
+			return !file.fail();
+		}
+
+		// lines of "F<tab>size<tab>time<tab>hash<tab>path" and "A<tab>key<tab>source<tab>output<tab>dependencies..."
+		// damaged lines are skipped, their assets are cooked again
+		void load_state(const std::filesystem::path& path, CookState& state)
+		{
+			std::string text;
+			if (!read_disk(path, text) || text.compare(0, s_state_header.size(), s_state_header) != 0) {
+				return;
+			}
+			for (const std::string_view line : split(text, '\n')) {
+				const std::vector<std::string_view> parts = split(line, '\t');
+				if (parts[0] == "F" && parts.size() == 5) {
+					FileState file;
+					if (parse_number(parts[1], file.size) && parse_number(parts[2], file.write_time)
+						&& parse_number(parts[3], file.hash, 16)) {
+						state.files.emplace(std::string(parts[4]), file);
+					}
+				}
+				else if (parts[0] == "A" && parts.size() >= 4) {
+					AssetRecord asset;
+					if (parse_number(parts[1], asset.key, 16)) {
+						asset.output = std::string(parts[3]);
+						for (size_t i = 4; i < parts.size(); ++i) {
+							asset.dependencies.emplace_back(parts[i]);
+						}
+						state.assets.emplace(std::string(parts[2]), std::move(asset));
+					}
+				}
+			}
+		}
+
+		bool save_state(const std::filesystem::path& path, const CookState& state)
+		{
+			std::string text(s_state_header);
+			text += '\n';
+			for (const auto& file : state.files) {
+				text += "F\t";
+				append_number(text, file.second.size);
+				text += '\t';
+				append_number(text, file.second.write_time);
+				text += '\t';
+				append_number(text, file.second.hash, 16);
+				text += '\t';
+				text += file.first;
+				text += '\n';
+			}
+			for (const auto& asset : state.assets) {
+				text += "A\t";
+				append_number(text, asset.second.key, 16);
+				text += '\t';
+				text += asset.first;
+				text += '\t';
+				text += asset.second.output;
+				for (const std::string& dependency : asset.second.dependencies) {
+					text += '\t';
+					text += dependency;
+				}
+				text += '\n';
+			}
+			return write_disk(path, text.data(), text.size());
+		}
+
+		bool get_file_time(const std::filesystem::path& path, uint64_t& size, int64_t& write_time)
+		{
+			std::error_code error;
+			size = std::filesystem::file_size(path, error);
+			if (error) {
+				return false;
+			}
+			write_time = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+			return !error;
+		}
+
+		// file is read only when its size or write time is not what it was at the last cook
+		// returns true when file was read
+		bool update_file(const std::filesystem::path& root, const std::string& path, const CookState& previous, FileState& file)
+		{
+			if (!get_file_time(root / path, file.size, file.write_time)) {
+				file = FileState();
+				return false;
+			}
+			const auto it = previous.files.find(path);
+			if (it != previous.files.end() && it->second.size == file.size && it->second.write_time == file.write_time) {
+				file.hash = it->second.hash;
+				return false;
+			}
+			FileData data;
+			file.hash = FileSystem::read(root / path, data) ? xxhash64(data.data(), data.size()) : 0;
+			return true;
+		}
+
+		uint64_t get_settings_hash(const CookKind kind, const AssetCooker::Settings& settings)
+		{
+			switch (kind) {
+			case CookKind::Texture:
+				return settings.decode_textures ? 1 : 0;
+			case CookKind::Shader:
+				return settings.strip_shader_comments ? 1 : 0;
+			default:
+				return 0;
+			}
+		}
+
+		// what cooked file is made of: source, every dependency, cooker version and settings
+		uint64_t get_cook_key(const CookKind kind, const AssetCooker::Settings& settings, const std::string& source,
+			const std::vector<std::string>& dependencies, const std::unordered_map<std::string, FileState>& files)
+		{
+			std::vector<uint64_t> values;
+			values.reserve(3 + dependencies.size() * 2);
+			values.push_back(s_cook_versions[static_cast<size_t>(kind)]);
+			values.push_back(get_settings_hash(kind, settings));
+			values.push_back(files.at(source).hash);
+			for (const std::string& dependency : dependencies) {
+				values.push_back(xxhash64(dependency.data(), dependency.size()));
+				const auto it = files.find(dependency);
+				values.push_back(it != files.end() ? it->second.hash : 0);
+			}
+			return xxhash64(values.data(), values.size() * sizeof(uint64_t));
+		}
+
+		bool cook_texture(const FileData& source, const AssetCooker::Settings& settings, std::vector<uint8_t>& cooked)
+		{
+			if (!settings.decode_textures) {
+				cooked.assign(source.data(), source.data() + source.size());
+				return true;
+			}
+			int width = 0;
+			int height = 0;
+			int channels = 0;
+			unsigned char* pixels = stbi_load_from_memory(source.data(), static_cast<int>(source.size()), &width, &height, &channels, 4);
+			if (!pixels) {
+				return false;
+			}
+			CookedTextureHeader header;
+			header.width = static_cast<uint32_t>(width);
+			header.height = static_cast<uint32_t>(height);
+			const size_t pixels_size = static_cast<size_t>(width) * height * 4;
+			cooked.resize(sizeof(header) + pixels_size);
+			std::memcpy(cooked.data(), &header, sizeof(header));
+			std::memcpy(cooked.data() + sizeof(header), pixels, pixels_size);
+			stbi_image_free(pixels);
+			return true;
+		}
+
+		// comments become spaces and keep their line breaks, #version stays the first line
+		void cook_shader(const FileData& source, const AssetCooker::Settings& settings, std::vector<uint8_t>& cooked)
+		{
+			cooked.assign(source.data(), source.data() + source.size());
+			if (!settings.strip_shader_comments) {
+				return;
+			}
+			std::vector<uint8_t> stripped;
+			stripped.reserve(cooked.size());
+			for (size_t i = 0; i < cooked.size(); ++i) {
+				if (cooked[i] == '/' && i + 1 < cooked.size() && cooked[i + 1] == '/') {
+					while (i < cooked.size() && cooked[i] != '\n') {
+						++i;
+					}
+					if (i < cooked.size()) {
+						stripped.push_back('\n');
+					}
+				}
+				else if (cooked[i] == '/' && i + 1 < cooked.size() && cooked[i + 1] == '*') {
+					stripped.push_back(' ');
+					for (i += 2; i < cooked.size() && !(cooked[i] == '*' && i + 1 < cooked.size() && cooked[i + 1] == '/'); ++i) {
+						if (cooked[i] == '\n') {
+							stripped.push_back('\n');
+						}
+					}
+					++i;
+				}
+				else {
+					stripped.push_back(cooked[i]);
+				}
+			}
+			cooked = std::move(stripped);
+		}
+
+		void append_node_meshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& meshes)
+		{
+			for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
+				meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+			}
+			for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+				append_node_meshes(node->mChildren[i], scene, meshes);
+			}
+		}
+
+		// meshes in the order Model processes nodes, with the same import flags
+		// LOD chain is generated here with default LodSettings, the same ones AssetManager loads models with
+		// files importer looks at are dependencies: materials of obj, external buffers of gltf
+		bool cook_model(const std::filesystem::path& path, std::vector<uint8_t>& cooked, std::vector<std::string>& used_files)
+		{
+			Assimp::Importer import;
+			import.SetIOHandler(new AssimpIOSystem(&used_files));
+			const aiScene* scene = import.ReadFile(path.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
+			if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
+				LOG_ERROR_TO(Assets, "Failed to import {0}: {1}", path.string(), import.GetErrorString());
+				return false;
+			}
+			std::vector<const aiMesh*> meshes;
+			append_node_meshes(scene->mRootNode, scene, meshes);
+
+			CookedModelHeader header;
+			header.meshes_count = static_cast<uint32_t>(meshes.size());
+			cooked.assign(reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header + 1));
+			std::vector<float> vertices;
+			std::vector<uint32_t> indices;
+			std::vector<glm::vec3> positions;
+			std::vector<CookedMeshLod> cooked_lods;
+			for (const aiMesh* mesh : meshes) {
+				vertices.clear();
+				vertices.reserve(static_cast<size_t>(mesh->mNumVertices) * 8);
+				for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+					const aiVector3D& position = mesh->mVertices[i];
+					vertices.insert(vertices.end(), { position.x, position.y, position.z });
+					if (mesh->mNormals) {
+						vertices.insert(vertices.end(), { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z });
+					}
+					else {
+						vertices.insert(vertices.end(), { 0.f, 0.f, 0.f });
+					}
+					if (mesh->mTextureCoords[0]) {
+						vertices.insert(vertices.end(), { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y });
+					}
+					else {
+						vertices.insert(vertices.end(), { 0.f, 0.f });
+					}
+				}
+				indices.clear();
+				for (unsigned int i = 0; i < mesh->mNumFaces; ++i) {
+					const aiFace& face = mesh->mFaces[i];
+					indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+				}
+				positions.resize(mesh->mNumVertices);
+				for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+					positions[i] = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+				}
+				const std::vector<LodLevel> lods = generate_lod_chain(positions, indices, LodSettings());
+				cooked_lods.clear();
+				for (const LodLevel& lod : lods) {
+					cooked_lods.push_back(CookedMeshLod{ lod.first_index, lod.index_count, lod.error });
+				}
+
+				CookedMeshView cooked_mesh;
+				cooked_mesh.vertices = reinterpret_cast<const uint8_t*>(vertices.data());
+				cooked_mesh.vertices_count = mesh->mNumVertices;
+				cooked_mesh.indices = reinterpret_cast<const uint8_t*>(indices.data());
+				cooked_mesh.indices_count = static_cast<uint32_t>(indices.size());
+				cooked_mesh.lods = reinterpret_cast<const uint8_t*>(cooked_lods.data());
+				cooked_mesh.lods_count = static_cast<uint32_t>(cooked_lods.size());
+				write_cooked_mesh(cooked_mesh, cooked);
+			}
+			return true;
+		}
+
+		struct CookTask {
+			std::string source;
+			CookKind kind = CookKind::None;
+			bool cooked = false;
+			std::vector<std::string> dependencies;
+		};
+
+		// writes cooked file, dependencies are found while cooking
+		void cook_asset(const std::filesystem::path& root, const std::filesystem::path& output,
+			const AssetCooker::Settings& settings, CookTask& task)
+		{
+			const std::filesystem::path source_path = root / task.source;
+			std::vector<uint8_t> cooked;
+			bool cooked_ok = false;
+			if (task.kind == CookKind::Model) {
+				std::vector<std::string> used_files;
+				cooked_ok = cook_model(source_path, cooked, used_files);
+				for (const std::string& used_file : used_files) {
+					std::string dependency = std::filesystem::path(used_file).lexically_relative(root).generic_string();
+					if (!dependency.empty() && dependency != task.source) {
+						task.dependencies.push_back(std::move(dependency));
+					}
+				}
+				std::sort(task.dependencies.begin(), task.dependencies.end());
+				task.dependencies.erase(std::unique(task.dependencies.begin(), task.dependencies.end()), task.dependencies.end());
+			}
+			else {
+				FileData source;
+				if (!FileSystem::read(source_path, source)) {
+					LOG_ERROR_TO(Assets, "Failed to read {0}", source_path.string());
+					return;
+				}
+				if (task.kind == CookKind::Texture) {
+					cooked_ok = cook_texture(source, settings, cooked);
+					if (!cooked_ok) {
+						LOG_ERROR_TO(Assets, "Failed to decode {0}: {1}", source_path.string(), stbi_failure_reason());
+					}
+				}
+				else if (task.kind == CookKind::World) {
+					// models are only named, they are cooked as assets of their own
+					WorldLayout layout;
+					std::string world_error;
+					cooked_ok = parse_world_source(source.data(), source.size(), layout, world_error) &&
+						write_cooked_world(layout, cooked);
+					if (!cooked_ok) {
+						LOG_ERROR_TO(Assets, "Failed to parse {0}: {1}", source_path.string(), world_error);
+					}
+				}
+				else {
+					cook_shader(source, settings, cooked);
+					cooked_ok = true;
+				}
+			}
+			if (!cooked_ok) {
+				return;
+			}
+			const std::filesystem::path output_path = output / (task.source + s_cooked_extensions[static_cast<size_t>(task.kind)]);
+			task.cooked = write_disk(output_path, cooked.data(), cooked.size());
+			if (!task.cooked) {
+				LOG_ERROR_TO(Assets, "Failed to write {0}", output_path.string());
+			}
+		}
+	}
+
+	bool AssetCooker::cook(const std::filesystem::path& root_directory, const std::vector<std::filesystem::path>& directories,
+		const std::filesystem::path& output_directory, const Settings& settings, Stats* stats)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		std::error_code error;
+		// absolute, relative paths would be searched in mounts by importer
+		const std::filesystem::path root = std::filesystem::weakly_canonical(root_directory, error);
+		const std::filesystem::path output = std::filesystem::weakly_canonical(output_directory, error);
+		CookState previous;
+		load_state(output / s_state_name, previous);
+
+		std::vector<std::string> sources;
+		for (const std::filesystem::path& directory : directories) {
+			const std::filesystem::path directory_path = std::filesystem::weakly_canonical(root / directory, error);
+			for (std::filesystem::recursive_directory_iterator it(directory_path, error), end; !error && it != end; it.increment(error)) {
+				// output may be inside of cooked directories
+				if (it->is_directory(error) && it->path() == output) {
+					it.disable_recursion_pending();
+				}
+				else if (it->is_regular_file(error) && get_kind(it->path()) != CookKind::None) {
+					sources.push_back(it->path().lexically_relative(root).generic_string());
+				}
+			}
+			if (error) {
+				LOG_ERROR_TO(Assets, "Failed to list {0}: {1}", (root / directory).string(), error.message());
+				return false;
+			}
+		}
+		std::sort(sources.begin(), sources.end());
+		sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+		// sources and what they depended on at the last cook are checked, in parallel, most of them by time alone
+		CookState state;
+		for (const std::string& source : sources) {
+			state.files.emplace(source, FileState());
+			const auto it = previous.assets.find(source);
+			if (it != previous.assets.end()) {
+				for (const std::string& dependency : it->second.dependencies) {
+					state.files.emplace(dependency, FileState());
+				}
+			}
+		}
+		std::vector<std::pair<const std::string, FileState>*> files;
+		files.reserve(state.files.size());
+		for (auto& file : state.files) {
+			files.push_back(&file);
+		}
+		std::atomic<size_t> hashed_files{ 0 };
+		JobSystem::parallel_for(files.size(), JobSystem::get_batch_size(files.size()), [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				if (update_file(root, files[i]->first, previous, files[i]->second)) {
+					hashed_files.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+
+		Stats cook_stats;
+		cook_stats.assets = sources.size();
+		cook_stats.hashed_files = hashed_files.load(std::memory_order_relaxed);
+		std::vector<CookTask> tasks;
+		for (const std::string& source : sources) {
+			const CookKind kind = get_kind(source);
+			const auto it = previous.assets.find(source);
+			if (it != previous.assets.end()) {
+				const AssetRecord& record = it->second;
+				const uint64_t key = get_cook_key(kind, settings, source, record.dependencies, state.files);
+				// failed asset is not tried again until something it is made of changes
+				if (key == record.key && (record.output.empty() || std::filesystem::is_regular_file(output / record.output, error))) {
+					state.assets.emplace(source, record);
+					if (record.output.empty()) {
+						++cook_stats.failed;
+					}
+					else {
+						++cook_stats.up_to_date;
+					}
+					continue;
+				}
+			}
+			CookTask task;
+			task.source = source;
+			task.kind = kind;
+			tasks.push_back(std::move(task));
+		}
+
+		// assets take from microseconds to seconds, so every thread takes the next one when it is done
+		// instead of a job per asset, thousands of those would not fit job ring
+		std::atomic<size_t> next_task{ 0 };
+		JobSystem::parallel_for(JobSystem::get_threads_count(), 1, [&](const size_t, const size_t) {
+			for (size_t i = next_task.fetch_add(1); i < tasks.size(); i = next_task.fetch_add(1)) {
+				cook_asset(root, output, settings, tasks[i]);
+			}
+		});
+
+		for (CookTask& task : tasks) {
+			for (const std::string& dependency : task.dependencies) {
+				if (state.files.find(dependency) == state.files.end() && update_file(root, dependency, previous, state.files[dependency])) {
+					++cook_stats.hashed_files;
+				}
+			}
+			AssetRecord record;
+			record.key = get_cook_key(task.kind, settings, task.source, task.dependencies, state.files);
+			const std::string cooked = task.source + s_cooked_extensions[static_cast<size_t>(task.kind)];
+			if (task.cooked) {
+				record.output = cooked;
+				++cook_stats.cooked;
+			}
+			else {
+				// cooked file of older source is not left to be packed
+				std::filesystem::remove(output / cooked, error);
+				++cook_stats.failed;
+			}
+			record.dependencies = std::move(task.dependencies);
+			state.assets.emplace(task.source, std::move(record));
+		}
+
+		for (const auto& asset : previous.assets) {
+			if (state.assets.find(asset.first) == state.assets.end()) {
+				if (!asset.second.output.empty()) {
+					std::filesystem::remove(output / asset.second.output, error);
+				}
+				++cook_stats.removed;
+			}
+		}
+
+		// nothing is written when nothing changed, so a cook without changes only looks at files
+		const bool changed = !tasks.empty() || cook_stats.removed > 0 || cook_stats.hashed_files > 0
+			|| state.files.size() != previous.files.size();
+		if (changed || !std::filesystem::is_regular_file(output / s_manifest_name, error)) {
+			std::string manifest = "# source path<tab>cooked path relative to this file\n";
+			for (const std::string& source : sources) {
+				const AssetRecord& record = state.assets.at(source);
+				if (!record.output.empty()) {
+					manifest += source;
+					manifest += '\t';
+					manifest += record.output;
+					manifest += '\n';
+				}
+			}
+			// state goes last, if manifest was not written the next cook writes it again
+			if (!write_disk(output / s_manifest_name, manifest.data(), manifest.size())
+				|| !save_state(output / s_state_name, state)) {
+				LOG_ERROR_TO(Assets, "Failed to write cook state to {0}", output_directory.string());
+				return false;
+			}
+		}
+
+		cook_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		LOG_INFO_TO(Assets, "Cooked {0} of {1} assets in {2:.3f} s: {3} up to date, {4} failed, {5} removed, {6} files hashed",
+			cook_stats.cooked, cook_stats.assets, cook_stats.seconds, cook_stats.up_to_date, cook_stats.failed,
+			cook_stats.removed, cook_stats.hashed_files);
+		if (stats) {
+			*stats = cook_stats;
+		}
+		return true;
+	}
+}
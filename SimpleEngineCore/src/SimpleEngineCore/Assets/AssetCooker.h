@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// turns source assets into files runtime loads without parsing or decoding:
+	// textures into RGBA8 pixels, models into vertex and index arrays, shaders without comments,
+	// worlds (.world) into cells with their model lists
+	// an asset is cooked again only when content of its source, of a file it depends on or settings changed
+	// cook_state.txt in output keeps size, write time and hash of every file, so unchanged files are not read
+	// manifest.txt in output maps source paths to cooked files, FileSystem::mount_manifest makes loaders use them
+	class AssetCooker {
+	public:
+		struct Settings {
+			bool decode_textures = true;		// false - textures are copied as they are
+			bool strip_shader_comments = true;	// lines stay where they were, compile errors point to source lines
+		};
+
+		struct Stats {
+			size_t assets = 0;
+			size_t cooked = 0;
+			size_t up_to_date = 0;
+			size_t failed = 0;			// logged and left out of manifest, cooked again when something changes
+			size_t removed = 0;			// cooked files of sources which are gone
+			size_t hashed_files = 0;	// read because their size or write time changed
+			double seconds = 0.0;
+		};
+
+		static constexpr const char* s_manifest_name = "manifest.txt";
+
+		// sources from directories under root, output is skipped if it is among them
+		// manifest paths are relative to root and to output, so output is usually root / "cooked"
+		// dirty assets are cooked on job threads, false when output can't be written
+		static bool cook(const std::filesystem::path& root, const std::vector<std::filesystem::path>& directories,
+			const std::filesystem::path& output, const Settings& settings, Stats* stats = nullptr);
+	};
+}
@@ -0,0 +1,1069 @@
+#include "AssetManager.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/IO/AsyncIO.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/IO/XxHash.h"
+#include "SimpleEngineCore/Assets/CookedFormats.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Memory/MemoryTracker.h"
+#include "SimpleEngineCore/Rendering/OpenGL/Texture2D.h"
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.h"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuMemory.h"
+#include "SimpleEngineCore/Rendering/OpenGL/MeshGeometry.h"
+#include "SimpleEngineCore/Rendering/OpenGL/Mesh.h"
+#include "SimpleEngineCore/Rendering/Primitives.h"
+#include "SimpleEngineCore/Rendering/FramePacket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	namespace {
+		template<typename T>
+		struct AssetSlot {
+			std::atomic<uint32_t> generation{ 1 };
+			std::atomic<AssetState> state{ AssetState::Empty };
+			// below is under pool mutex, asset and alias are written before state is Ready
+			uint32_t refs = 0;
+			uint32_t alias = 0;			// slot with the same bytes, this one holds a reference of it
+			uint64_t content_hash = 0;
+			uint64_t unused_since = 0;	// frame when the last reference was released
+			size_t bytes = 0;
+			std::string key;
+			std::unique_ptr<T> asset;
+		};
+
+		// slots are in chunks which never move, so lookups by handle don't lock
+		template<typename T>
+		struct AssetPool {
+			static constexpr size_t s_chunk_size = 256;
+			static constexpr size_t s_max_chunks = 64;
+
+			std::atomic<AssetSlot<T>*> chunks[s_max_chunks] = {};
+			std::mutex mutex;
+			uint32_t slots_count = 1;	// slot 0 is never used, index 0 is invalid handle
+			std::vector<uint32_t> free_slots;
+			std::vector<uint32_t> unused;	// slots without references, released first are first
+			std::unordered_map<std::string, uint32_t> by_key;
+			std::unordered_map<uint64_t, uint32_t> by_hash;
+			uint64_t path_hits = 0;
+			uint64_t content_hits = 0;
+			size_t saved_bytes = 0;
+			uint64_t unloads = 0;
+
+			AssetSlot<T>* find(const uint32_t index) const {
+				const size_t chunk = index / s_chunk_size;
+				if (index == 0 || chunk >= s_max_chunks) {
+					return nullptr;
+				}
+				AssetSlot<T>* slots = chunks[chunk].load(std::memory_order_acquire);
+				return slots != nullptr ? &slots[index % s_chunk_size] : nullptr;
+			}
+
+			AssetSlot<T>& at(const uint32_t index) const { return *find(index); }
+
+			AssetHandle<T> get_handle(const uint32_t index) const {
+				return AssetHandle<T>{ index, at(index).generation.load(std::memory_order_relaxed) };
+			}
+
+			// under mutex, new slot with one reference
+			AssetHandle<T> create(const std::string& key, const AssetState state) {
+				uint32_t index = 0;
+				if (!free_slots.empty()) {
+					index = free_slots.back();
+					free_slots.pop_back();
+				}
+				else {
+					const size_t chunk = slots_count / s_chunk_size;
+					if (chunk >= s_max_chunks) {
+						LOG_ERROR_TO(Assets, "Asset pool is full, {0} is not loaded", key);
+						return AssetHandle<T>();
+					}
+					if (chunks[chunk].load(std::memory_order_relaxed) == nullptr) {
+						void* memory = MemoryTracker::allocate(sizeof(AssetSlot<T>) * s_chunk_size, alignof(AssetSlot<T>), MemoryTag::Assets);
+						AssetSlot<T>* slots = static_cast<AssetSlot<T>*>(memory);
+						for (size_t i = 0; i < s_chunk_size; ++i) {
+							new (&slots[i]) AssetSlot<T>();
+						}
+						chunks[chunk].store(slots, std::memory_order_release);
+					}
+					index = slots_count++;
+				}
+				AssetSlot<T>& slot = at(index);
+				slot.refs = 1;
+				slot.alias = 0;
+				slot.content_hash = 0;
+				slot.bytes = 0;
+				slot.key = key;
+				slot.state.store(state, std::memory_order_release);
+				if (!key.empty()) {
+					by_key[key] = index;
+				}
+				return get_handle(index);
+			}
+
+			// under mutex
+			void add_reference(const uint32_t index) {
+				AssetSlot<T>& slot = at(index);
+				if (slot.refs++ == 0) {
+					unused.erase(std::find(unused.begin(), unused.end(), index));
+				}
+			}
+
+			void remove_reference(const uint32_t index, const uint64_t frame) {
+				AssetSlot<T>& slot = at(index);
+				if (--slot.refs == 0) {
+					slot.unused_since = frame;
+					unused.push_back(index);
+				}
+			}
+
+			// under mutex, when asset with the same bytes is ready this slot only points to it
+			bool link_to_same_content(const uint32_t index, const uint64_t content_hash) {
+				AssetSlot<T>& slot = at(index);
+				slot.content_hash = content_hash;
+				const auto it = by_hash.find(content_hash);
+				if (it == by_hash.end() || it->second == index) {
+					return false;
+				}
+				add_reference(it->second);
+				slot.alias = it->second;
+				++content_hits;
+				saved_bytes += at(it->second).bytes;
+				slot.state.store(AssetState::Ready, std::memory_order_release);
+				return true;
+			}
+
+			// under mutex, asset is destroyed by caller outside of the lock
+			std::unique_ptr<T> unload(const uint32_t index, const uint64_t frame, const bool release_alias = true) {
+				AssetSlot<T>& slot = at(index);
+				const auto key_it = by_key.find(slot.key);
+				if (key_it != by_key.end() && key_it->second == index) {
+					by_key.erase(key_it);
+				}
+				const auto hash_it = by_hash.find(slot.content_hash);
+				if (hash_it != by_hash.end() && hash_it->second == index) {
+					by_hash.erase(hash_it);
+				}
+				if (slot.alias != 0 && release_alias) {
+					remove_reference(slot.alias, frame);
+				}
+				uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+				if (generation == 0) {
+					generation = 1;
+				}
+				slot.generation.store(generation, std::memory_order_release);
+				slot.state.store(AssetState::Empty, std::memory_order_release);
+				slot.refs = 0;
+				slot.alias = 0;
+				slot.content_hash = 0;
+				slot.bytes = 0;
+				slot.key.clear();
+				free_slots.push_back(index);
+				++unloads;
+				return std::move(slot.asset);
+			}
+
+			// under mutex, after every asset was destroyed
+			void release_chunks() {
+				for (size_t chunk = 0; chunk < s_max_chunks; ++chunk) {
+					AssetSlot<T>* slots = chunks[chunk].exchange(nullptr, std::memory_order_acq_rel);
+					if (slots == nullptr) {
+						continue;
+					}
+					for (size_t i = 0; i < s_chunk_size; ++i) {
+						slots[i].~AssetSlot<T>();
+					}
+					MemoryTracker::deallocate(slots, sizeof(AssetSlot<T>) * s_chunk_size, alignof(AssetSlot<T>), MemoryTag::Assets);
+				}
+				slots_count = 1;
+				free_slots.clear();
+				unused.clear();
+				by_key.clear();
+				by_hash.clear();
+			}
+		};
+
+		AssetPool<Texture2D> s_textures;
+		AssetPool<ShaderProgram> s_shaders;
+		AssetPool<Model> s_models;
+		AssetPool<Mesh> s_meshes;
+		AssetPool<MeshGeometry> s_geometry;
+
+		std::atomic<uint64_t> s_frame{ 0 };
+		std::atomic<size_t> s_pending_loads{ 0 };
+		std::atomic<uint64_t> s_grace_frames{ AssetManager::s_default_grace_frames };
+		std::atomic<size_t> s_max_unused{ AssetManager::s_default_max_unused };
+
+		// finished loads wait here for the thread with OpenGL context, each frame takes what fits into budgets
+		// counter of load stays held until its upload is done
+		struct PendingUpload {
+			void (*upload)(void* load) = nullptr;
+			void* load = nullptr;
+			size_t bytes = 0;		// estimate of what goes to GPU
+			JobCounter* counter = nullptr;
+		};
+
+		struct UploadQueue {
+			std::mutex mutex;
+			std::deque<PendingUpload> pending;
+			size_t budget_bytes = 0;
+			double budget_ms = 0.0;
+			AssetManager::UploadStats stats;
+		};
+		UploadQueue s_uploads;
+
+		// any thread
+		void queue_upload(void (*upload)(void* load), void* load, const size_t bytes, JobCounter* counter)
+		{
+			if (counter) {
+				JobSystem::hold(*counter);
+			}
+			std::lock_guard<std::mutex> lock(s_uploads.mutex);
+			s_uploads.pending.push_back(PendingUpload{ upload, load, bytes, counter });
+			s_uploads.stats.queued = s_uploads.pending.size();
+			s_uploads.stats.queued_bytes += bytes;
+			s_uploads.stats.peak_queued_bytes = std::max(s_uploads.stats.peak_queued_bytes, s_uploads.stats.queued_bytes);
+		}
+
+		// thread with OpenGL context, 0 is no limit, the first upload goes even when it is bigger than budget
+		void run_uploads(const size_t budget_bytes, const double budget_ms, const bool count_frame)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			size_t uploads = 0;
+			size_t bytes = 0;
+			bool deferred = false;
+			while (true) {
+				PendingUpload upload;
+				{
+					std::lock_guard<std::mutex> lock(s_uploads.mutex);
+					if (s_uploads.pending.empty()) {
+						break;
+					}
+					upload = s_uploads.pending.front();
+					if (uploads > 0) {
+						const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+						if ((budget_bytes > 0 && bytes + upload.bytes > budget_bytes) || (budget_ms > 0.0 && elapsed_ms >= budget_ms)) {
+							deferred = true;
+							break;
+						}
+					}
+					s_uploads.pending.pop_front();
+					s_uploads.stats.queued = s_uploads.pending.size();
+					s_uploads.stats.queued_bytes -= upload.bytes;
+				}
+				upload.upload(upload.load);
+				if (upload.counter) {
+					JobSystem::release(*upload.counter);
+				}
+				++uploads;
+				bytes += upload.bytes;
+			}
+			std::lock_guard<std::mutex> lock(s_uploads.mutex);
+			s_uploads.stats.uploads += uploads;
+			s_uploads.stats.bytes += bytes;
+			if (count_frame) {
+				s_uploads.stats.frame_uploads = uploads;
+				s_uploads.stats.frame_bytes = bytes;
+				s_uploads.stats.frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				s_uploads.stats.deferred_frames += deferred ? 1 : 0;
+			}
+		}
+
+		template<typename T> AssetPool<T>& get_pool();
+		template<> AssetPool<Texture2D>& get_pool<Texture2D>() { return s_textures; }
+		template<> AssetPool<ShaderProgram>& get_pool<ShaderProgram>() { return s_shaders; }
+		template<> AssetPool<Model>& get_pool<Model>() { return s_models; }
+		template<> AssetPool<Mesh>& get_pool<Mesh>() { return s_meshes; }
+		template<> AssetPool<MeshGeometry>& get_pool<MeshGeometry>() { return s_geometry; }
+
+		// hash so far is the seed of the next part
+		uint64_t hash_bytes(const uint64_t hash, const void* data, const size_t size)
+		{
+			return xxhash64(data, size, hash);
+		}
+		constexpr uint64_t s_hash_seed = 14695981039346656037ull;
+
+		// the same file by any relative path or through links is one key
+		// virtual paths are not on disk, mounts decide where they are
+		std::string get_canonical_key(const std::filesystem::path& path)
+		{
+			if (path.is_relative()) {
+				return FileSystem::get_virtual_path(path);
+			}
+			std::error_code error;
+			const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+			return error ? path.lexically_normal().generic_string() : canonical.generic_string();
+		}
+
+		// existing asset of key gets one more reference
+		template<typename T>
+		bool find_loaded(AssetPool<T>& pool, const std::string& key, AssetHandle<T>& handle)
+		{
+			const auto it = pool.by_key.find(key);
+			if (it == pool.by_key.end()) {
+				return false;
+			}
+			pool.add_reference(it->second);
+			++pool.path_hits;
+			const AssetSlot<T>& slot = pool.at(it->second);
+			pool.saved_bytes += slot.alias != 0 ? pool.at(slot.alias).bytes : slot.bytes;
+			handle = pool.get_handle(it->second);
+			return true;
+		}
+
+		// on thread with OpenGL context, asset is nullptr when load failed
+		template<typename T>
+		void finish_load(AssetPool<T>& pool, const AssetHandle<T> handle, std::unique_ptr<T> asset, const size_t bytes)
+		{
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex);
+				AssetSlot<T>& slot = pool.at(handle.index);
+				if (asset) {
+					slot.asset = std::move(asset);
+					slot.bytes = bytes;
+					if (slot.content_hash != 0) {
+						pool.by_hash.emplace(slot.content_hash, handle.index);
+					}
+					slot.state.store(AssetState::Ready, std::memory_order_release);
+				}
+				else {
+					slot.state.store(AssetState::Failed, std::memory_order_release);
+				}
+			}
+			s_pending_loads.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		template<typename T>
+		void finish_as_same_content(AssetPool<T>& pool, const AssetHandle<T> handle, const uint64_t content_hash, bool& linked)
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			linked = pool.link_to_same_content(handle.index, content_hash);
+			if (linked) {
+				s_pending_loads.fetch_sub(1, std::memory_order_acq_rel);
+			}
+		}
+
+		// RGBA8 with full mip chain, the same as Texture2D allocates
+		size_t get_texture_bytes(const int width, const int height)
+		{
+			size_t bytes = 0;
+			int w = width;
+			int h = height;
+			while (true) {
+				bytes += static_cast<size_t>(w) * h * 4;
+				if (w == 1 && h == 1) {
+					break;
+				}
+				w = std::max(w >> 1, 1);
+				h = std::max(h >> 1, 1);
+			}
+			return bytes;
+		}
+
+		struct TextureLoad {
+			AssetHandle<Texture2D> handle;
+			std::string path;
+			const char* owner = nullptr;
+			JobCounter* counter = nullptr;
+			uint64_t content_hash = 0;
+			unsigned char* pixels = nullptr;
+			int width = 0;
+			int height = 0;
+			bool decode_skipped = false;
+		};
+
+		// evicted texture, it is not an asset of the pool, texture is found through reload
+		struct TextureReloadLoad {
+			std::shared_ptr<TextureReload> reload;
+			std::string path;
+			unsigned char* pixels = nullptr;
+			int width = 0;
+			int height = 0;
+		};
+
+		struct ShaderLoad {
+			AssetHandle<ShaderProgram> handle;
+			std::string vertex_shader_path;
+			std::string frag_shader_path;
+		};
+
+		struct ModelLoad {
+			AssetHandle<Model> handle;
+			std::string path;
+			std::string vertex_shader_path;
+			std::string frag_shader_path;
+			MeshType mesh_type;
+			const char* owner = nullptr;
+			JobCounter* counter = nullptr;
+			uint64_t content_hash = 0;
+			std::vector<MeshData> meshes;
+			size_t gpu_bytes = 0;
+		};
+
+		// worker: file bytes are hashed before decoding, the same image under other name is not decoded again
+		// stored archive entry and small file in I/O buffer are decoded without copy
+		void decode_texture(TextureLoad& load, const FileData& bytes, const bool skip_known_content)
+		{
+			load.content_hash = hash_bytes(s_hash_seed, bytes.data(), bytes.size());
+			if (skip_known_content) {
+				std::lock_guard<std::mutex> lock(s_textures.mutex);
+				load.decode_skipped = s_textures.by_hash.find(load.content_hash) != s_textures.by_hash.end();
+				if (load.decode_skipped) {
+					return;
+				}
+			}
+			load.pixels = load_texture_pixels(bytes.data(), bytes.size(), load.width, load.height);
+			if (!load.pixels) {
+				LOG_ERROR_TO(Assets, "Failed to decode {0}: {1}", load.path, stbi_failure_reason());
+			}
+		}
+
+		// thread with OpenGL context
+		void upload_texture(TextureLoad* load)
+		{
+			bool linked = false;
+			if (load->content_hash != 0) {
+				finish_as_same_content(s_textures, load->handle, load->content_hash, linked);
+			}
+			if (!linked) {
+				if (load->decode_skipped) {
+					// asset with the same bytes was unloaded in between
+					FileData bytes;
+					if (FileSystem::read(load->path, bytes)) {
+						decode_texture(*load, bytes, false);
+					}
+					else {
+						LOG_ERROR_TO(Assets, "Failed to find: {0}", load->path);
+					}
+				}
+				std::unique_ptr<Texture2D> texture;
+				size_t bytes = 0;
+				if (load->pixels) {
+					GpuMemoryScope gpu_memory_owner(load->owner);
+					texture = std::make_unique<Texture2D>(load->path, load->pixels, load->width, load->height);
+					bytes = get_texture_bytes(load->width, load->height);
+				}
+				finish_load(s_textures, load->handle, std::move(texture), bytes);
+			}
+			if (load->pixels) {
+				free_texture_pixels(load->pixels);
+			}
+			delete load;
+		}
+
+		// thread with OpenGL context, texture destroyed meanwhile drops the pixels
+		void upload_reloaded_texture(TextureReloadLoad* load)
+		{
+			if (load->reload->texture) {
+				load->reload->texture->finish_reload(load->pixels, load->width, load->height);
+			}
+			if (load->pixels) {
+				free_texture_pixels(load->pixels);
+			}
+			delete load;
+			s_pending_loads.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		// thread with OpenGL context
+		void create_shader(ShaderLoad* load)
+		{
+			const std::filesystem::path paths[] = { load->vertex_shader_path, load->frag_shader_path };
+			FileData files[2];
+			if (FileSystem::read_batch(paths, files, 2) != 2) {
+				LOG_ERROR_TO(Assets, "Failed to find: {0} or {1}", load->vertex_shader_path, load->frag_shader_path);
+				finish_load(s_shaders, load->handle, std::unique_ptr<ShaderProgram>(), 0);
+				delete load;
+				return;
+			}
+			// size between sources, so bytes moved from one stage to other don't give the same hash
+			const size_t vertex_size = files[0].size();
+			uint64_t content_hash = hash_bytes(s_hash_seed, &vertex_size, sizeof(vertex_size));
+			content_hash = hash_bytes(content_hash, files[0].data(), files[0].size());
+			content_hash = hash_bytes(content_hash, files[1].data(), files[1].size());
+
+			bool linked = false;
+			finish_as_same_content(s_shaders, load->handle, content_hash, linked);
+			if (!linked) {
+				std::unique_ptr<ShaderProgram> program;
+				try {
+					program = std::make_unique<ShaderProgram>(load->vertex_shader_path, load->frag_shader_path);
+				}
+				catch (const std::exception& e) {
+					LOG_ERROR_TO(Assets, "Shader {0} is not loaded: {1}", load->vertex_shader_path, e.what());
+				}
+				if (program && !program->is_compiled()) {
+					program = nullptr;
+				}
+				finish_load(s_shaders, load->handle, std::move(program), 0);
+			}
+			delete load;
+		}
+
+		// worker: import, vertex packing and LOD chains are done here, so upload only creates buffers
+		void read_model(ModelLoad& load, const FileData& bytes)
+		{
+			const int mesh_type = static_cast<int>(load.mesh_type);
+			load.content_hash = hash_bytes(s_hash_seed, bytes.data(), bytes.size());
+			load.content_hash = hash_bytes(load.content_hash, &mesh_type, sizeof(mesh_type));
+			load.content_hash = hash_bytes(load.content_hash, load.vertex_shader_path.data(), load.vertex_shader_path.size());
+			load.content_hash = hash_bytes(load.content_hash, load.frag_shader_path.data(), load.frag_shader_path.size());
+			Model::Import(load.path, bytes, LodSettings(), load.meshes);
+			for (const MeshData& mesh : load.meshes) {
+				load.gpu_bytes += mesh.get_gpu_bytes();
+			}
+		}
+
+		// thread with OpenGL context
+		void create_model(ModelLoad* load)
+		{
+			bool linked = false;
+			if (load->content_hash != 0) {
+				finish_as_same_content(s_models, load->handle, load->content_hash, linked);
+			}
+			if (!linked) {
+				std::unique_ptr<Model> model;
+				try {
+					GpuMemoryScope gpu_memory_owner(load->owner);
+					model = std::make_unique<Model>(load->mesh_type, load->path, std::move(load->meshes),
+						load->vertex_shader_path, load->frag_shader_path);
+				}
+				catch (const std::exception& e) {
+					LOG_ERROR_TO(Assets, "Model {0} is not loaded: {1}", load->path, e.what());
+				}
+				if (model && !model->IsLoaded()) {
+					model = nullptr;
+				}
+				finish_load(s_models, load->handle, std::move(model), 0);
+			}
+			delete load;
+		}
+
+		template<typename T>
+		void count_stats(AssetPool<T>& pool, AssetManager::Stats& stats)
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			for (uint32_t index = 1; index < pool.slots_count; ++index) {
+				const AssetSlot<T>& slot = pool.at(index);
+				switch (slot.state.load(std::memory_order_relaxed)) {
+				case AssetState::Loading: ++stats.loading; break;
+				case AssetState::Ready: ++stats.ready; stats.bytes += slot.bytes; break;
+				case AssetState::Failed: ++stats.failed; break;
+				default: break;
+				}
+			}
+			stats.unused = pool.unused.size();
+			stats.path_hits = pool.path_hits;
+			stats.content_hits = pool.content_hits;
+			stats.saved_bytes = pool.saved_bytes;
+			stats.unloads = pool.unloads;
+		}
+
+		// a few per frame so one frame doesn't destroy a whole level
+		constexpr size_t s_max_unloads_per_update = 16;
+
+		template<typename T>
+		void unload_unused(AssetPool<T>& pool, const uint64_t frame)
+		{
+			std::unique_ptr<T> unloaded[s_max_unloads_per_update];
+			size_t unloaded_count = 0;
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex);
+				if (pool.unused.empty()) {
+					return;
+				}
+				const uint64_t grace_frames = s_grace_frames.load(std::memory_order_relaxed);
+				const size_t max_unused = s_max_unused.load(std::memory_order_relaxed);
+				size_t i = 0;
+				while (i < pool.unused.size() && unloaded_count < s_max_unloads_per_update) {
+					const uint32_t index = pool.unused[i];
+					const AssetSlot<T>& slot = pool.at(index);
+					// packets still in flight may point at it, so even over max unused it waits for them
+					const uint64_t unused_frames = frame - slot.unused_since;
+					const bool expired = unused_frames >= FramePacket::s_frames_in_flight
+						&& (unused_frames >= grace_frames || pool.unused.size() > max_unused);
+					// loads finish into their slot, unused while loading waits for it
+					if (!expired || slot.state.load(std::memory_order_relaxed) == AssetState::Loading) {
+						++i;
+						continue;
+					}
+					pool.unused.erase(pool.unused.begin() + i);
+					unloaded[unloaded_count++] = pool.unload(index, frame);
+				}
+			}
+			// destructors release references of other assets and delete OpenGL objects
+			for (size_t i = 0; i < unloaded_count; ++i) {
+				unloaded[i] = nullptr;
+			}
+		}
+
+		template<typename T>
+		void unload_all(AssetPool<T>& pool, const AssetType type)
+		{
+			std::vector<std::unique_ptr<T>> unloaded;
+			{
+				std::lock_guard<std::mutex> lock(pool.mutex);
+				// unused alias in grace period still holds a reference, it is not a leak
+				std::vector<uint32_t> alias_refs(pool.slots_count, 0);
+				for (uint32_t index = 1; index < pool.slots_count; ++index) {
+					const AssetSlot<T>& slot = pool.at(index);
+					if (slot.state.load(std::memory_order_relaxed) != AssetState::Empty && slot.alias != 0) {
+						++alias_refs[slot.alias];
+					}
+				}
+				size_t referenced = 0;
+				for (uint32_t index = 1; index < pool.slots_count; ++index) {
+					AssetSlot<T>& slot = pool.at(index);
+					if (slot.state.load(std::memory_order_relaxed) == AssetState::Empty) {
+						continue;
+					}
+					if (slot.refs > alias_refs[index]) {
+						++referenced;
+					}
+					unloaded.push_back(pool.unload(index, 0, false));
+				}
+				if (referenced > 0) {
+					LOG_WARN_TO(Assets, "{0} assets of {1} are still referenced at shutdown", referenced,
+						AssetManager::get_type_name(type));
+				}
+			}
+			unloaded.clear();
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			pool.release_chunks();
+		}
+
+		// waiting thread uploads everything, budgets are for frames
+		template<typename T>
+		void wait_until_loaded(const AssetHandle<T> handle)
+		{
+			while (AssetManager::get_state(handle) == AssetState::Loading) {
+				JobSystem::process_main_thread_jobs();
+				run_uploads(0, 0.0, false);
+				if (!JobSystem::execute_one_job()) {
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+	AssetHandle<Texture2D> AssetManager::load_texture(const std::filesystem::path& path, JobCounter* counter)
+	{
+		const std::string key = get_canonical_key(path);
+		AssetHandle<Texture2D> handle;
+		{
+			std::lock_guard<std::mutex> lock(s_textures.mutex);
+			if (find_loaded(s_textures, key, handle)) {
+				return handle;
+			}
+			handle = s_textures.create(key, AssetState::Loading);
+			if (!handle.is_valid()) {
+				return handle;
+			}
+		}
+		s_pending_loads.fetch_add(1, std::memory_order_acq_rel);
+
+		TextureLoad* load = new TextureLoad();
+		load->handle = handle;
+		load->path = path.string();
+		load->owner = GpuMemoryScope::get_current_owner();
+		load->counter = counter;
+		// decoding job starts when the file is read, reads of other textures go on meanwhile
+		AsyncIO::read(path, IoPriority::Normal, [](const IoStatus status, FileData& bytes, void* user_data) {
+			TextureLoad* load = static_cast<TextureLoad*>(user_data);
+			if (status == IoStatus::Done) {
+				decode_texture(*load, bytes, true);
+			}
+			else {
+				LOG_ERROR_TO(Assets, "Failed to find: {0}", load->path);
+			}
+			const size_t upload_bytes = load->pixels ? get_texture_bytes(load->width, load->height) : 0;
+			queue_upload([](void* load) { upload_texture(static_cast<TextureLoad*>(load)); }, load, upload_bytes, load->counter);
+		}, load, counter);
+		return handle;
+	}
+
+	void AssetManager::reload_texture(std::shared_ptr<TextureReload> reload, const std::string& path)
+	{
+		s_pending_loads.fetch_add(1, std::memory_order_acq_rel);
+		TextureReloadLoad* load = new TextureReloadLoad();
+		load->reload = std::move(reload);
+		load->path = path;
+		AsyncIO::read(path, IoPriority::Normal, [](const IoStatus status, FileData& bytes, void* user_data) {
+			TextureReloadLoad* load = static_cast<TextureReloadLoad*>(user_data);
+			if (status == IoStatus::Done) {
+				load->pixels = load_texture_pixels(bytes.data(), bytes.size(), load->width, load->height);
+				if (!load->pixels) {
+					LOG_ERROR_TO(Assets, "Failed to decode {0}: {1}", load->path, stbi_failure_reason());
+				}
+			}
+			else {
+				LOG_ERROR_TO(Assets, "Failed to find: {0}", load->path);
+			}
+			const size_t upload_bytes = load->pixels ? get_texture_bytes(load->width, load->height) : 0;
+			queue_upload([](void* load) { upload_reloaded_texture(static_cast<TextureReloadLoad*>(load)); }, load, upload_bytes, nullptr);
+		}, load, nullptr);
+	}
+
+	AssetHandle<ShaderProgram> AssetManager::load_shader(const std::filesystem::path& vertex_shader_path,
+		const std::filesystem::path& frag_shader_path, JobCounter* counter)
+	{
+		const std::string key = get_canonical_key(vertex_shader_path) + '|' + get_canonical_key(frag_shader_path);
+		AssetHandle<ShaderProgram> handle;
+		{
+			std::lock_guard<std::mutex> lock(s_shaders.mutex);
+			if (find_loaded(s_shaders, key, handle)) {
+				return handle;
+			}
+			handle = s_shaders.create(key, AssetState::Loading);
+			if (!handle.is_valid()) {
+				return handle;
+			}
+		}
+		s_pending_loads.fetch_add(1, std::memory_order_acq_rel);
+
+		ShaderLoad* load = new ShaderLoad();
+		load->handle = handle;
+		load->vertex_shader_path = vertex_shader_path.string();
+		load->frag_shader_path = frag_shader_path.string();
+		// nothing is uploaded, but compiling takes time of the frame
+		queue_upload([](void* load) { create_shader(static_cast<ShaderLoad*>(load)); }, load, 0, counter);
+		return handle;
+	}
+
+	AssetHandle<Model> AssetManager::load_model(const std::filesystem::path& path, const MeshType mesh_type,
+		const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path, JobCounter* counter)
+	{
+		const std::string key = get_canonical_key(path) + '|' + std::to_string(static_cast<int>(mesh_type)) + '|' +
+			get_canonical_key(vertex_shader_path) + '|' + get_canonical_key(frag_shader_path);
+		AssetHandle<Model> handle;
+		{
+			std::lock_guard<std::mutex> lock(s_models.mutex);
+			if (find_loaded(s_models, key, handle)) {
+				return handle;
+			}
+			handle = s_models.create(key, AssetState::Loading);
+			if (!handle.is_valid()) {
+				return handle;
+			}
+		}
+		s_pending_loads.fetch_add(1, std::memory_order_acq_rel);
+
+		ModelLoad* load = new ModelLoad();
+		load->handle = handle;
+		load->path = path.string();
+		load->vertex_shader_path = vertex_shader_path.string();
+		load->frag_shader_path = frag_shader_path.string();
+		load->mesh_type = mesh_type;
+		load->owner = GpuMemoryScope::get_current_owner();
+		load->counter = counter;
+		AsyncIO::read(path, IoPriority::Normal, [](const IoStatus status, FileData& bytes, void* user_data) {
+			ModelLoad* load = static_cast<ModelLoad*>(user_data);
+			if (status == IoStatus::Done) {
+				read_model(*load, bytes);
+			}
+			else {
+				LOG_ERROR_TO(Assets, "Failed to find: {0}", load->path);
+			}
+			queue_upload([](void* load) { create_model(static_cast<ModelLoad*>(load)); }, load, load->gpu_bytes, load->counter);
+		}, load, counter);
+		return handle;
+	}
+
+	AssetHandle<Mesh> AssetManager::add_mesh(const std::string& name, std::unique_ptr<Mesh> mesh)
+	{
+		AssetHandle<Mesh> handle;
+		std::lock_guard<std::mutex> lock(s_meshes.mutex);
+		if (find_loaded(s_meshes, name, handle)) {
+			return handle;
+		}
+		handle = s_meshes.create(name, AssetState::Loading);
+		if (handle.is_valid()) {
+			AssetSlot<Mesh>& slot = s_meshes.at(handle.index);
+			slot.asset = std::move(mesh);
+			slot.state.store(AssetState::Ready, std::memory_order_release);
+		}
+		return handle;
+	}
+
+	AssetHandle<Mesh> AssetManager::find_mesh(const std::string& name)
+	{
+		AssetHandle<Mesh> handle;
+		std::lock_guard<std::mutex> lock(s_meshes.mutex);
+		find_loaded(s_meshes, name, handle);
+		return handle;
+	}
+
+	AssetHandle<MeshGeometry> AssetManager::add_geometry(const std::string& name,
+		std::vector<float> vertices, std::vector<uint32_t> indices, const GeometryAccess access)
+	{
+		// arrays without CPU copy can't be shared with geometry which has to keep one
+		const size_t vertices_count = vertices.size();
+		uint64_t content_hash = hash_bytes(s_hash_seed, &access, sizeof(access));
+		content_hash = hash_bytes(content_hash, &vertices_count, sizeof(vertices_count));
+		content_hash = hash_bytes(content_hash, vertices.data(), vertices.size() * sizeof(float));
+		content_hash = hash_bytes(content_hash, indices.data(), indices.size() * sizeof(uint32_t));
+
+		AssetHandle<MeshGeometry> handle;
+		{
+			std::lock_guard<std::mutex> lock(s_geometry.mutex);
+			if (find_loaded(s_geometry, name, handle)) {
+				return handle;
+			}
+			handle = s_geometry.create(name, AssetState::Loading);
+			if (!handle.is_valid() || s_geometry.link_to_same_content(handle.index, content_hash)) {
+				return handle;
+			}
+		}
+		// upload outside of the lock, slot is Loading until then
+		std::unique_ptr<MeshGeometry> geometry = std::make_unique<MeshGeometry>(std::move(vertices), std::move(indices), access);
+		std::lock_guard<std::mutex> lock(s_geometry.mutex);
+		AssetSlot<MeshGeometry>& slot = s_geometry.at(handle.index);
+		slot.bytes = geometry->get_gpu_bytes();
+		slot.asset = std::move(geometry);
+		s_geometry.by_hash.emplace(content_hash, handle.index);
+		slot.state.store(AssetState::Ready, std::memory_order_release);
+		return handle;
+	}
+
+	AssetHandle<MeshGeometry> AssetManager::get_primitive(const Primitive primitive)
+	{
+		const std::string name = std::string("Primitive ") + get_primitive_name(primitive);
+		AssetHandle<MeshGeometry> handle;
+		{
+			std::lock_guard<std::mutex> lock(s_geometry.mutex);
+			if (find_loaded(s_geometry, name, handle)) {
+				return handle;
+			}
+		}
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		generate_primitive(primitive, vertices, indices);
+		GpuMemoryScope gpu_memory_owner("Primitives");
+		return add_geometry(name, std::move(vertices), std::move(indices), GeometryAccess::GpuOnly);
+	}
+
+	template<typename T>
+	void AssetManager::acquire(const AssetHandle<T> handle)
+	{
+		AssetPool<T>& pool = get_pool<T>();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		const AssetSlot<T>* slot = pool.find(handle.index);
+		if (slot != nullptr && slot->generation.load(std::memory_order_relaxed) == handle.generation) {
+			pool.add_reference(handle.index);
+		}
+	}
+
+	template<typename T>
+	void AssetManager::release(AssetHandle<T>& handle)
+	{
+		if (!handle.is_valid()) {
+			return;
+		}
+		AssetPool<T>& pool = get_pool<T>();
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			const AssetSlot<T>* slot = pool.find(handle.index);
+			// after shutdown slot is gone or belongs to other asset
+			if (slot != nullptr && slot->generation.load(std::memory_order_relaxed) == handle.generation && slot->refs > 0) {
+				pool.remove_reference(handle.index, s_frame.load(std::memory_order_relaxed));
+			}
+		}
+		handle = AssetHandle<T>();
+	}
+
+	template<typename T>
+	T* AssetManager::get(const AssetHandle<T> handle)
+	{
+		AssetPool<T>& pool = get_pool<T>();
+		const AssetSlot<T>* slot = pool.find(handle.index);
+		if (slot == nullptr || slot->generation.load(std::memory_order_acquire) != handle.generation ||
+			slot->state.load(std::memory_order_acquire) != AssetState::Ready) {
+			return nullptr;
+		}
+		if (slot->alias != 0) {
+			slot = pool.find(slot->alias);
+		}
+		return slot->asset.get();
+	}
+
+	template<typename T>
+	AssetState AssetManager::get_state(const AssetHandle<T> handle)
+	{
+		const AssetSlot<T>* slot = get_pool<T>().find(handle.index);
+		if (slot == nullptr || slot->generation.load(std::memory_order_acquire) != handle.generation) {
+			return AssetState::Empty;
+		}
+		return slot->state.load(std::memory_order_acquire);
+	}
+
+	template<typename T>
+	void AssetManager::wait(const AssetHandle<T> handle)
+	{
+		wait_until_loaded(handle);
+	}
+
+#define SIMPLE_ENGINE_ASSET_TYPE(T) \
+	template void AssetManager::acquire<T>(const AssetHandle<T>); \
+	template void AssetManager::release<T>(AssetHandle<T>&); \
+	template T* AssetManager::get<T>(const AssetHandle<T>); \
+	template AssetState AssetManager::get_state<T>(const AssetHandle<T>); \
+	template void AssetManager::wait<T>(const AssetHandle<T>);
+
+	SIMPLE_ENGINE_ASSET_TYPE(Texture2D)
+	SIMPLE_ENGINE_ASSET_TYPE(ShaderProgram)
+	SIMPLE_ENGINE_ASSET_TYPE(Model)
+	SIMPLE_ENGINE_ASSET_TYPE(Mesh)
+	SIMPLE_ENGINE_ASSET_TYPE(MeshGeometry)
+#undef SIMPLE_ENGINE_ASSET_TYPE
+
+	void AssetManager::wait_for_loads()
+	{
+		while (s_pending_loads.load(std::memory_order_acquire) > 0) {
+			JobSystem::process_main_thread_jobs();
+			run_uploads(0, 0.0, false);
+			if (!JobSystem::execute_one_job()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	size_t AssetManager::get_pending_loads()
+	{
+		return s_pending_loads.load(std::memory_order_relaxed);
+	}
+
+	void AssetManager::set_unload_policy(const uint64_t grace_frames, const size_t max_unused)
+	{
+		s_grace_frames.store(grace_frames, std::memory_order_relaxed);
+		s_max_unused.store(max_unused, std::memory_order_relaxed);
+	}
+
+	void AssetManager::set_upload_budget(const size_t bytes_per_frame, const double milliseconds_per_frame)
+	{
+		std::lock_guard<std::mutex> lock(s_uploads.mutex);
+		s_uploads.budget_bytes = bytes_per_frame;
+		s_uploads.budget_ms = milliseconds_per_frame;
+	}
+
+	void AssetManager::process_uploads()
+	{
+		size_t budget_bytes = 0;
+		double budget_ms = 0.0;
+		{
+			std::lock_guard<std::mutex> lock(s_uploads.mutex);
+			budget_bytes = s_uploads.budget_bytes;
+			budget_ms = s_uploads.budget_ms;
+		}
+		run_uploads(budget_bytes, budget_ms, true);
+	}
+
+	AssetManager::UploadStats AssetManager::get_upload_stats()
+	{
+		std::lock_guard<std::mutex> lock(s_uploads.mutex);
+		return s_uploads.stats;
+	}
+
+	void AssetManager::update()
+	{
+		const uint64_t frame = s_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+		// models and meshes hold references of shaders, textures and geometry, so those are released before
+		unload_unused(s_models, frame);
+		unload_unused(s_meshes, frame);
+		unload_unused(s_geometry, frame);
+		unload_unused(s_shaders, frame);
+		unload_unused(s_textures, frame);
+	}
+
+	void AssetManager::shutdown()
+	{
+		wait_for_loads();
+		unload_all(s_models, AssetType::Model);
+		unload_all(s_meshes, AssetType::Mesh);
+		unload_all(s_geometry, AssetType::Geometry);
+		unload_all(s_shaders, AssetType::Shader);
+		unload_all(s_textures, AssetType::Texture);
+	}
+
+	AssetManager::Stats AssetManager::get_stats(const AssetType type)
+	{
+		Stats stats;
+		switch (type) {
+		case AssetType::Texture: count_stats(s_textures, stats); break;
+		case AssetType::Shader: count_stats(s_shaders, stats); break;
+		case AssetType::Model: count_stats(s_models, stats); break;
+		case AssetType::Mesh: count_stats(s_meshes, stats); break;
+		case AssetType::Geometry: count_stats(s_geometry, stats); break;
+		default: break;
+		}
+		return stats;
+	}
+
+	const char* AssetManager::get_type_name(const AssetType type)
+	{
+		switch (type) {
+		case AssetType::Texture: return "Textures";
+		case AssetType::Shader: return "Shaders";
+		case AssetType::Model: return "Models";
+		case AssetType::Mesh: return "Meshes";
+		case AssetType::Geometry: return "Geometry";
+		default: return "Unknown";
+		}
+	}
+
+	AssetHandle<Texture2D> AssetBatch::add_texture(const std::filesystem::path& path)
+	{
+		m_textures.emplace_back(AssetManager::load_texture(path));
+		return m_textures.back().get_handle();
+	}
+
+	AssetHandle<ShaderProgram> AssetBatch::add_shader(const std::filesystem::path& vertex_shader_path,
+		const std::filesystem::path& frag_shader_path)
+	{
+		m_shaders.emplace_back(AssetManager::load_shader(vertex_shader_path, frag_shader_path));
+		return m_shaders.back().get_handle();
+	}
+
+	AssetHandle<Model> AssetBatch::add_model(const std::filesystem::path& path, const MeshType mesh_type,
+		const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path)
+	{
+		m_models.emplace_back(AssetManager::load_model(path, mesh_type, vertex_shader_path, frag_shader_path));
+		return m_models.back().get_handle();
+	}
+
+	bool AssetBatch::is_done() const
+	{
+		const auto loading = [](const auto& asset) { return asset.get_state() == AssetState::Loading; };
+		return std::none_of(m_textures.begin(), m_textures.end(), loading) &&
+			std::none_of(m_shaders.begin(), m_shaders.end(), loading) &&
+			std::none_of(m_models.begin(), m_models.end(), loading);
+	}
+
+	void AssetBatch::wait() const
+	{
+		for (const AssetRef<Texture2D>& texture : m_textures) {
+			AssetManager::wait(texture.get_handle());
+		}
+		for (const AssetRef<ShaderProgram>& shader : m_shaders) {
+			AssetManager::wait(shader.get_handle());
+		}
+		for (const AssetRef<Model>& model : m_models) {
+			AssetManager::wait(model.get_handle());
+		}
+	}
+
+	size_t AssetBatch::get_failed_count() const
+	{
+		const auto failed = [](const auto& asset) { return asset.get_state() == AssetState::Failed; };
+		return std::count_if(m_textures.begin(), m_textures.end(), failed) +
+			std::count_if(m_shaders.begin(), m_shaders.end(), failed) +
+			std::count_if(m_models.begin(), m_models.end(), failed);
+	}
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class Texture2D;
+	struct TextureReload;
+	class ShaderProgram;
+	class Model;
+	class Mesh;
+	class MeshGeometry;
+	class JobCounter;
+	enum class MeshType;
+	enum class GeometryAccess : uint8_t;
+	enum class Primitive : uint8_t;
+
+	enum class AssetType : uint8_t {
+		Texture,
+		Shader,
+		Model,
+		Mesh,
+		Geometry,
+		Count
+	};
+
+	enum class AssetState : uint8_t {
+		Empty,		// handle is invalid or asset was unloaded
+		Loading,
+		Ready,
+		Failed
+	};
+
+	// slot of asset and generation of the slot, handle of unloaded asset never finds the next asset in the same slot
+	template<typename T>
+	struct AssetHandle {
+		uint32_t index = 0;		// 0 is invalid
+		uint32_t generation = 0;
+
+		bool is_valid() const { return index != 0; }
+		bool operator==(const AssetHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const AssetHandle& other) const { return !(*this == other); }
+	};
+
+	// textures, shaders, models, meshes and geometry shared by everything which uses the same file or the same bytes
+	// assets without references stay cached for a grace period and are unloaded the oldest first
+	// references and lookups are from any thread, assets are created and destroyed on the thread with OpenGL context
+	class AssetManager {
+	public:
+		struct Stats {
+			size_t loading = 0;
+			size_t ready = 0;
+			size_t failed = 0;
+			size_t unused = 0;			// no references, unloaded after grace period
+			size_t bytes = 0;			// GPU memory of ready textures and geometry, 0 for other types
+			uint64_t path_hits = 0;		// load of path which was already loaded
+			uint64_t content_hits = 0;	// other path, but the same bytes
+			size_t saved_bytes = 0;		// GPU memory hits didn't allocate again
+			uint64_t unloads = 0;
+		};
+
+		struct UploadStats {
+			uint64_t uploads = 0;
+			uint64_t bytes = 0;
+			size_t queued = 0;				// finished loads waiting for the thread with OpenGL context
+			size_t queued_bytes = 0;
+			size_t peak_queued_bytes = 0;
+			size_t frame_uploads = 0;		// of the last process_uploads
+			size_t frame_bytes = 0;
+			double frame_ms = 0.0;
+			uint64_t deferred_frames = 0;	// budget was spent and the rest waited for the next frame
+		};
+
+		static constexpr uint64_t s_default_grace_frames = 600;
+		static constexpr size_t s_default_max_unused = 64;
+
+		// loads of the same canonical path or of files with the same bytes give one asset
+		// returned handle owns one reference, AssetRef adopts it, counter is decremented when load finished
+		// texture file is read and decoded by a job, upload happens in process_uploads
+		static AssetHandle<Texture2D> load_texture(const std::filesystem::path& path, JobCounter* counter = nullptr);
+		// evicted texture, the same read, decode and budgeted upload, then Texture2D::finish_reload
+		static void reload_texture(std::shared_ptr<TextureReload> reload, const std::string& path);
+		// model file is read in the background, shaders and models are created in process_uploads
+		static AssetHandle<ShaderProgram> load_shader(const std::filesystem::path& vertex_shader_path,
+			const std::filesystem::path& frag_shader_path, JobCounter* counter = nullptr);
+		static AssetHandle<Model> load_model(const std::filesystem::path& path, const MeshType mesh_type,
+			const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path,
+			JobCounter* counter = nullptr);
+		// mesh built in code, the same name gives the first mesh and this one is destroyed
+		// meshes share buffers through their geometry, so only names are compared
+		// on the thread with OpenGL context
+		static AssetHandle<Mesh> add_mesh(const std::string& name, std::unique_ptr<Mesh> mesh);
+		// invalid handle when there is no mesh with this name
+		static AssetHandle<Mesh> find_mesh(const std::string& name);
+		// the same vertices, indices and access give the geometry which is already uploaded, name may be empty
+		// on the thread with OpenGL context
+		static AssetHandle<MeshGeometry> add_geometry(const std::string& name,
+			std::vector<float> vertices, std::vector<uint32_t> indices, const GeometryAccess access);
+		// cube, sphere or plane uploaded on the first call, GPU only, on the thread with OpenGL context
+		static AssetHandle<MeshGeometry> get_primitive(const Primitive primitive);
+
+		template<typename T>
+		static void acquire(const AssetHandle<T> handle);
+		// handle is reset, asset is unloaded after grace period when it was the last reference
+		template<typename T>
+		static void release(AssetHandle<T>& handle);
+
+		// nullptr until asset is ready, asset stays alive while caller holds its reference
+		template<typename T>
+		static T* get(const AssetHandle<T> handle);
+		template<typename T>
+		static AssetState get_state(const AssetHandle<T> handle);
+		// runs jobs, main thread jobs and uploads without budget until asset is loaded
+		// has to be the thread with OpenGL context
+		template<typename T>
+		static void wait(const AssetHandle<T> handle);
+		static void wait_for_loads();
+		static size_t get_pending_loads();
+
+		// unused assets older than grace frames are unloaded, and the oldest ones above max unused count
+		// never before frame packets which could draw them are rendered (FramePacket::s_frames_in_flight)
+		static void set_unload_policy(const uint64_t grace_frames, const size_t max_unused);
+		// uploads of one process_uploads stop when either budget is spent, 0 is no limit
+		// at least one upload is done every time, so asset bigger than budget isn't stuck
+		static void set_upload_budget(const size_t bytes_per_frame, const double milliseconds_per_frame);
+		// once per frame on the thread with OpenGL context, finished loads are uploaded oldest first
+		static void process_uploads();
+		static UploadStats get_upload_stats();
+		// once per frame on the thread with OpenGL context
+		static void update();
+		// after everything released its references, waits for loads and unloads every asset
+		static void shutdown();
+
+		static Stats get_stats(const AssetType type);
+		static const char* get_type_name(const AssetType type);
+	};
+
+	// owns one reference of asset
+	template<typename T>
+	class AssetRef {
+	public:
+		AssetRef() = default;
+		// adopts reference of handle returned by load
+		explicit AssetRef(const AssetHandle<T> handle) : m_handle(handle) {}
+		~AssetRef() { reset(); }
+
+		AssetRef(const AssetRef& other) : m_handle(other.m_handle) {
+			AssetManager::acquire(m_handle);
+		}
+		AssetRef& operator=(const AssetRef& other) {
+			if (this != &other) {
+				AssetManager::acquire(other.m_handle);
+				reset();
+				m_handle = other.m_handle;
+			}
+			return *this;
+		}
+		AssetRef(AssetRef&& other) noexcept : m_handle(std::exchange(other.m_handle, AssetHandle<T>())) {}
+		AssetRef& operator=(AssetRef&& other) noexcept {
+			if (this != &other) {
+				reset();
+				m_handle = std::exchange(other.m_handle, AssetHandle<T>());
+			}
+			return *this;
+		}
+
+		void reset() { AssetManager::release(m_handle); }
+
+		T* get() const { return AssetManager::get(m_handle); }
+		T* operator->() const { return get(); }
+		T& operator*() const { return *get(); }
+		AssetState get_state() const { return AssetManager::get_state(m_handle); }
+		AssetHandle<T> get_handle() const { return m_handle; }
+		bool is_valid() const { return m_handle.is_valid(); }
+
+	private:
+		AssetHandle<T> m_handle;
+	};
+
+	// loads started together decode in parallel, references are kept until batch is destroyed
+	class AssetBatch {
+	public:
+		AssetHandle<Texture2D> add_texture(const std::filesystem::path& path);
+		AssetHandle<ShaderProgram> add_shader(const std::filesystem::path& vertex_shader_path,
+			const std::filesystem::path& frag_shader_path);
+		AssetHandle<Model> add_model(const std::filesystem::path& path, const MeshType mesh_type,
+			const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path);
+
+		bool is_done() const;
+		// has to be the thread with OpenGL context
+		void wait() const;
+		// assets of this batch which were not loaded
+		size_t get_failed_count() const;
+
+	private:
+		std::vector<AssetRef<Texture2D>> m_textures;
+		std::vector<AssetRef<ShaderProgram>> m_shaders;
+		std::vector<AssetRef<Model>> m_models;
+	};
+}
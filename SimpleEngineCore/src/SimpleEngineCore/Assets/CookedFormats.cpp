@@ -0,0 +1,129 @@
+#include "CookedFormats.h"
+
+#include "stb_image.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	unsigned char* load_texture_pixels(const uint8_t* data, const size_t size, int& width, int& height)
+	{
+		CookedTextureHeader header;
+		if (size >= sizeof(header)) {
+			std::memcpy(&header, data, sizeof(header));
+		}
+		const uint64_t pixels_size = static_cast<uint64_t>(header.width) * header.height * 4;
+		const bool cooked = size >= sizeof(header) && header.magic == CookedTextureHeader::s_magic
+			&& header.version == CookedTextureHeader::s_version && header.width > 0 && header.height > 0
+			&& header.width <= 1u << 16 && header.height <= 1u << 16 && pixels_size == size - sizeof(header);
+		if (!cooked) {
+			// damaged cooked file gets here too, stb tells that format is unknown
+			int channels = 0;
+			return stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, 4);
+		}
+		// malloc like stb, so both are freed the same way
+		unsigned char* pixels = static_cast<unsigned char*>(std::malloc(static_cast<size_t>(pixels_size)));
+		if (pixels) {
+			std::memcpy(pixels, data + sizeof(header), static_cast<size_t>(pixels_size));
+			width = static_cast<int>(header.width);
+			height = static_cast<int>(header.height);
+		}
+		return pixels;
+	}
+
+	void free_texture_pixels(unsigned char* pixels)
+	{
+		stbi_image_free(pixels);
+	}
+
+	bool is_cooked_model(const uint8_t* data, const size_t size)
+	{
+		CookedModelHeader header;
+		if (size < sizeof(header)) {
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		return header.magic == CookedModelHeader::s_magic;
+	}
+
+	void write_cooked_mesh(const CookedMeshView& mesh, std::vector<uint8_t>& bytes)
+	{
+		CookedMeshHeader header;
+		header.vertices_count = mesh.vertices_count;
+		header.indices_count = mesh.indices_count;
+		header.lods_count = mesh.lods_count;
+		const size_t vertices_size = static_cast<size_t>(mesh.vertices_count) * s_cooked_vertex_size;
+		const size_t indices_size = static_cast<size_t>(mesh.indices_count) * sizeof(uint32_t);
+		const size_t lods_size = static_cast<size_t>(mesh.lods_count) * sizeof(CookedMeshLod);
+		const size_t offset = bytes.size();
+		bytes.resize(offset + sizeof(header) + vertices_size + indices_size + lods_size);
+		uint8_t* out = bytes.data() + offset;
+		std::memcpy(out, &header, sizeof(header));
+		out += sizeof(header);
+		if (vertices_size > 0) {
+			std::memcpy(out, mesh.vertices, vertices_size);
+		}
+		out += vertices_size;
+		if (indices_size > 0) {
+			std::memcpy(out, mesh.indices, indices_size);
+		}
+		out += indices_size;
+		if (lods_size > 0) {
+			std::memcpy(out, mesh.lods, lods_size);
+		}
+	}
+
+	bool read_cooked_model(const uint8_t* data, const size_t size, std::vector<CookedMeshView>& meshes)
+	{
+		meshes.clear();
+		CookedModelHeader header;
+		if (size < sizeof(header)) {
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (header.magic != CookedModelHeader::s_magic || header.version != CookedModelHeader::s_version) {
+			return false;
+		}
+		size_t offset = sizeof(header);
+		for (uint32_t i = 0; i < header.meshes_count; ++i) {
+			CookedMeshHeader mesh_header;
+			if (size - offset < sizeof(mesh_header)) {
+				meshes.clear();
+				return false;
+			}
+			std::memcpy(&mesh_header, data + offset, sizeof(mesh_header));
+			offset += sizeof(mesh_header);
+			const uint64_t vertices_size = static_cast<uint64_t>(mesh_header.vertices_count) * s_cooked_vertex_size;
+			const uint64_t indices_size = static_cast<uint64_t>(mesh_header.indices_count) * sizeof(uint32_t);
+			const uint64_t lods_size = static_cast<uint64_t>(mesh_header.lods_count) * sizeof(CookedMeshLod);
+			if (size - offset < vertices_size + indices_size + lods_size) {
+				meshes.clear();
+				return false;
+			}
+			CookedMeshView mesh;
+			mesh.vertices = data + offset;
+			mesh.vertices_count = mesh_header.vertices_count;
+			mesh.indices = data + offset + vertices_size;
+			mesh.indices_count = mesh_header.indices_count;
+			mesh.lods = data + offset + vertices_size + indices_size;
+			mesh.lods_count = mesh_header.lods_count;
+			// levels are drawn as ranges of indices, so they have to be inside of them
+			for (uint32_t j = 0; j < mesh.lods_count; ++j) {
+				CookedMeshLod lod;
+				std::memcpy(&lod, mesh.lods + j * sizeof(lod), sizeof(lod));
+				if (lod.first_index > mesh.indices_count || lod.index_count > mesh.indices_count - lod.first_index) {
+					meshes.clear();
+					return false;
+				}
+			}
+			meshes.push_back(mesh);
+			offset += static_cast<size_t>(vertices_size + indices_size + lods_size);
+		}
+		if (offset != size) {
+			meshes.clear();
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// files written by AssetCooker, little-endian, every part is 4 byte aligned
+	// runtime loaders take cooked and source files alike, manifest decides which one a path gives
+
+	// header and RGBA8 pixels, rows from the top like stb gives them, so upload skips decoding
+	struct CookedTextureHeader {
+		static constexpr uint32_t s_magic = 0x58544553;	// "SETX"
+		static constexpr uint32_t s_version = 1;
+
+		uint32_t magic = s_magic;
+		uint32_t version = s_version;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+	static_assert(sizeof(CookedTextureHeader) == 16, "CookedTextureHeader is part of file format");
+
+	// header, then for every mesh: CookedMeshHeader, vertices, indices of all LOD levels, levels
+	// vertex is 8 floats: position, normal, texture coordinates, the same as Vertex
+	struct CookedModelHeader {
+		static constexpr uint32_t s_magic = 0x444d4553;	// "SEMD"
+		static constexpr uint32_t s_version = 2;
+
+		uint32_t magic = s_magic;
+		uint32_t version = s_version;
+		uint32_t meshes_count = 0;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(CookedModelHeader) == 16, "CookedModelHeader is part of file format");
+
+	struct CookedMeshHeader {
+		uint32_t vertices_count = 0;
+		uint32_t indices_count = 0;		// every level, one after another
+		uint32_t lods_count = 0;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(CookedMeshHeader) == 16, "CookedMeshHeader is part of file format");
+
+	// LOD chain is generated by cooker, so loading cooked model doesn't run the simplifier
+	struct CookedMeshLod {
+		uint32_t first_index = 0;
+		uint32_t index_count = 0;
+		float error = 0.f;			// in model units, like LodLevel
+	};
+	static_assert(sizeof(CookedMeshLod) == 12, "CookedMeshLod is part of file format");
+
+	constexpr size_t s_cooked_vertex_size = 8 * sizeof(float);
+
+	// world split into cells: header, models, cells, model indices of cells, objects, strings
+	// model indices and objects of a cell are one range each, so a cell is streamed in without looking at others
+	struct CookedWorldHeader {
+		static constexpr uint32_t s_magic = 0x44574553;	// "SEWD"
+		static constexpr uint32_t s_version = 2;
+
+		uint32_t magic = s_magic;
+		uint32_t version = s_version;
+		float cell_size = 0.f;
+		uint32_t models_count = 0;
+		uint32_t cells_count = 0;
+		uint32_t cell_models_count = 0;
+		uint32_t objects_count = 0;
+		uint32_t strings_size = 0;
+	};
+	static_assert(sizeof(CookedWorldHeader) == 32, "CookedWorldHeader is part of file format");
+
+	// offsets of zero terminated paths in strings
+	struct CookedWorldModel {
+		uint32_t path = 0;
+		uint32_t vertex_shader_path = 0;
+		uint32_t frag_shader_path = 0;
+		uint32_t mesh_type = 0;		// MeshType
+	};
+	static_assert(sizeof(CookedWorldModel) == 16, "CookedWorldModel is part of file format");
+
+	struct CookedWorldCell {
+		int32_t x = 0;
+		int32_t y = 0;
+		uint32_t first_model = 0;
+		uint32_t models_count = 0;
+		uint32_t first_object = 0;
+		uint32_t objects_count = 0;
+	};
+	static_assert(sizeof(CookedWorldCell) == 24, "CookedWorldCell is part of file format");
+
+	struct CookedWorldObject {
+		uint32_t model = 0;		// index of world model, not of cell list
+		float position[3] = {};
+		float scale = 1.f;
+	};
+	static_assert(sizeof(CookedWorldObject) == 20, "CookedWorldObject is part of file format");
+
+	// one mesh inside of cooked model bytes, arrays may be unaligned, copy them out with memcpy
+	struct CookedMeshView {
+		const uint8_t* vertices = nullptr;
+		uint32_t vertices_count = 0;
+		const uint8_t* indices = nullptr;
+		uint32_t indices_count = 0;
+		const uint8_t* lods = nullptr;	// CookedMeshLod
+		uint32_t lods_count = 0;
+	};
+
+	// RGBA8 of cooked texture or of png, jpg and other formats stb decodes, nullptr when neither
+	// result is freed with free_texture_pixels
+	unsigned char* load_texture_pixels(const uint8_t* data, const size_t size, int& width, int& height);
+	void free_texture_pixels(unsigned char* pixels);
+
+	bool is_cooked_model(const uint8_t* data, const size_t size);
+	// appends mesh after model header, which counts it
+	void write_cooked_mesh(const CookedMeshView& mesh, std::vector<uint8_t>& bytes);
+	// false when bytes are not a cooked model of this version, it is cut short or a level is out of indices
+	bool read_cooked_model(const uint8_t* data, const size_t size, std::vector<CookedMeshView>& meshes);
+}
@@ -3,6 +3,8 @@
 #include <glm/trigonometric.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cmath>
+
 namespace SimpleEngine {
 	Camera::Camera(const glm::vec3& position,
 		const glm::vec3& rotation,
@@ -43,6 +45,14 @@ namespace SimpleEngine {
 		m_fov = fov;
 		update_projection_matrix();
 	}
+	void Camera::set_reverse_z(const bool reverse_z)
+	{
+		if (m_reverse_z == reverse_z) {
+			return;
+		}
+		m_reverse_z = reverse_z;
+		update_projection_matrix();
+	}
 	void Camera::update_view_matrix()
 	{
 		float roll_in_radians_x = glm::radians(m_rotation.x);
@@ -88,7 +98,17 @@ namespace SimpleEngine {
 			//float f = 100;
 			//float n = 0.1f;
 			// note we write row of matrix like column so it looks rotated or trasnposed
-			m_projection_matrix = glm::perspective(glm::radians(m_fov), m_viewport_width / m_viewport_height, m_near_clip_plane, m_far_clip_plane);
+			if (m_reverse_z) {
+				// clip z = near, clip w = view depth -> depth = near / view depth, 1 on near plane and 0 at infinity
+				const float f = 1.f / std::tan(glm::radians(m_fov) * 0.5f);
+				m_projection_matrix = glm::mat4(f / (m_viewport_width / m_viewport_height), 0, 0, 0,
+					0, f, 0, 0,
+					0, 0, 0, -1,
+					0, 0, m_near_clip_plane, 0);
+			}
+			else {
+				m_projection_matrix = glm::perspective(glm::radians(m_fov), m_viewport_width / m_viewport_height, m_near_clip_plane, m_far_clip_plane);
+			}
 			//m_projection_matrix = glm::mat4(n / r, 0, 0, 0,
 			//	0, n / t, 0, 0,
 			//	0, 0, (-f - n) / (f - n), -1,
@@ -100,10 +120,19 @@ namespace SimpleEngine {
 			float t = 2;
 			float f = 100;
 			float n = 0.1f;
-			m_projection_matrix = glm::mat4(1 / r, 0, 0, 0,
-				0, 1 / t, 0, 0,
-				0, 0, -2 / (f - n), 0,
-				0, 0, (-f - n) / (f - n), 1);
+			if (m_reverse_z) {
+				// near -> 1, far -> 0
+				m_projection_matrix = glm::mat4(1 / r, 0, 0, 0,
+					0, 1 / t, 0, 0,
+					0, 0, 1 / (f - n), 0,
+					0, 0, f / (f - n), 1);
+			}
+			else {
+				m_projection_matrix = glm::mat4(1 / r, 0, 0, 0,
+					0, 1 / t, 0, 0,
+					0, 0, -2 / (f - n), 0,
+					0, 0, (-f - n) / (f - n), 1);
+			}
 		}
 	}
 	void Camera::set_position(const glm::vec3& position)
@@ -0,0 +1,31 @@
+#include "Components.h"
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+namespace SimpleEngine {
+
+	glm::mat4 make_local_matrix(const glm::vec3& position, const glm::vec3& direction, const glm::vec3& scale)
+	{
+		glm::mat4 rotate_mat = glm::mat4(1.0f);
+		if (direction != glm::vec3(0)) {
+			const glm::vec3 normalized_direction = glm::normalize(direction);
+			// mesh looks along Z
+			const glm::vec3 forward = glm::vec3(0.0f, 0.0f, 1.0f);
+			const glm::vec3 axis = glm::cross(forward, normalized_direction);
+			// zero axis - vectors are collinear and no rotation is needed
+			if (glm::length(axis) > 0.0f) {
+				const float angle = glm::acos(glm::dot(forward, normalized_direction));
+				rotate_mat = glm::rotate(glm::mat4(1.0f), angle, axis);
+			}
+		}
+		const glm::mat4 scale_mat = glm::scale(glm::mat4(1.0f), scale);
+		const glm::mat4 translate_mat(
+			1, 0, 0, 0,
+			0, 1, 0, 0,
+			0, 0, 1, 0,
+			position[0], position[1], position[2], 1);
+		return translate_mat * rotate_mat * scale_mat;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SimpleEngineCore/Rendering/OpenGL/Material.h"
+#include "SimpleEngineCore/Rendering/OpenGL/Light.h"
+#include "SimpleEngineCore/Scene/SceneGraph.h"
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	class Drawable;
+	struct OccluderMesh;
+
+	// world matrices, written by transform system, read when draw list is built
+	struct TransformComponent {
+		glm::mat4 model_matrix{ 1.f };
+		glm::mat3 normal_matrix{ 1.f };
+	};
+
+	// entity is placed by scene graph node
+	struct SceneNodeComponent {
+		SceneGraph::NodeId node = SceneGraph::s_invalid_node;
+	};
+
+	// shared GPU resource, not owned by entity
+	struct MeshComponent {
+		Drawable* drawable = nullptr;
+		uint32_t lod = 0;	// level of detail of the last frame, selection keeps it until the next one is clearly better
+	};
+
+	struct MaterialComponent {
+		Material material;
+	};
+
+	// point or spot light placed by TransformComponent, spot shines along +Z of model matrix
+	// position and direction of light itself are ignored
+	struct LightComponent {
+		SpotLight light;
+		bool is_spot = false;
+	};
+
+	// entity with mesh and transform is drawn into directional light shadow map
+	// static casters are cached, moving them is allowed but redraws the whole static layer
+	struct ShadowCasterComponent {
+		bool is_static = true;
+	};
+
+	// model space box (center, half size) around mesh, entities without it are never culled
+	struct BoundsComponent {
+		glm::vec3 center{ 0.f };
+		glm::vec3 extent{ 0.f };
+	};
+
+	// entity hides what is behind it in occlusion buffer, mesh is placed by TransformComponent
+	struct OccluderComponent {
+		const OccluderMesh* mesh = nullptr;
+	};
+
+	// entity is drawn by GPU driven renderer (compute culling, one indirect draw) when it is enabled
+	// its mesh has to be the one renderer was made for, bounds are needed for culling
+	struct GpuInstanceComponent {
+	};
+
+	// translate * rotation of +Z to direction * scale, zero direction - no rotation
+	glm::mat4 make_local_matrix(const glm::vec3& position, const glm::vec3& direction, const glm::vec3& scale);
+}
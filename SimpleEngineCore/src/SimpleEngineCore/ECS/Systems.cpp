@@ -0,0 +1,187 @@
+#include "Systems.h"
+
+#include "World.h"
+#include "Components.h"
+#include "SimpleEngineCore/Rendering/FramePacket.h"
+#include "SimpleEngineCore/Rendering/ClusteredLighting.h"
+#include "SimpleEngineCore/Rendering/ShadowCascades.h"
+#include "SimpleEngineCore/Rendering/OcclusionCulling.h"
+#include "SimpleEngineCore/Rendering/GpuDrivenRenderer.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+#include "SimpleEngineCore/Camera.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace SimpleEngine {
+
+	namespace {
+		// FNV-1a
+		uint64_t hash_bytes(uint64_t hash, const void* data, const size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i) {
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+			return hash;
+		}
+	}
+
+	void Systems::sync_transforms(World& world, const SceneGraph& scene)
+	{
+		world.parallel_for_each<SceneNodeComponent, TransformComponent>(
+			[&scene](const Entity, const SceneNodeComponent& node, TransformComponent& transform) {
+				transform.model_matrix = scene.get_world_matrix(node.node);
+				transform.normal_matrix = scene.get_normal_matrix(node.node);
+			});
+	}
+
+	CullingStats Systems::build_draw_list(World& world, const Camera& camera, const float lod_pixel_error,
+		std::vector<DrawItem>& draws, const OcclusionBuffer* occlusion, const bool skip_gpu_instances)
+	{
+		const glm::mat4 view_projection = camera.get_projection_matrix() * camera.get_view_matrix();
+		std::atomic<size_t> tested{ 0 };
+		std::atomic<size_t> outside_frustum{ 0 };
+		std::atomic<size_t> occluded{ 0 };
+		std::atomic<size_t> skipped{ 0 };
+
+		// every chunk writes own range, capacity of packet vector is reused between frames
+		draws.resize(world.count<MeshComponent, TransformComponent, MaterialComponent>());
+		world.parallel_for_each_chunk<MeshComponent, TransformComponent, MaterialComponent>(
+			[&](const size_t first, const size_t count, const Entity* entities,
+				MeshComponent* meshes, const TransformComponent* transforms, const MaterialComponent* materials) {
+				if (skip_gpu_instances && world.has<GpuInstanceComponent>(entities[0])) {
+					for (size_t i = 0; i < count; ++i) {
+						draws[first + i].drawable = nullptr;
+					}
+					skipped.fetch_add(count, std::memory_order_relaxed);
+					return;
+				}
+				for (size_t i = 0; i < count; ++i) {
+					DrawItem& item = draws[first + i];
+					item.drawable = meshes[i].drawable;
+					item.instance.model_matrix = transforms[i].model_matrix;
+					item.instance.normal_matrix = transforms[i].normal_matrix;
+					item.instance.material = materials[i].material;
+				}
+				SimdMath::compute_mvp_matrices(view_projection,
+					&draws[first].instance.model_matrix, &draws[first].instance.mvp_matrix, count, sizeof(DrawItem), sizeof(DrawItem));
+
+				// all entities of chunk have the same components, entity i is row i
+				const BoundsComponent* bounds = occlusion != nullptr ? world.get<BoundsComponent>(entities[0]) : nullptr;
+				if (bounds != nullptr) {
+					size_t chunk_outside_frustum = 0;
+					size_t chunk_occluded = 0;
+					for (size_t i = 0; i < count; ++i) {
+						DrawItem& item = draws[first + i];
+						switch (occlusion->test_box(item.instance.mvp_matrix, bounds[i].center, bounds[i].extent)) {
+						case OcclusionBuffer::EVisibility::OutsideFrustum:
+							++chunk_outside_frustum;
+							item.drawable = nullptr;
+							break;
+						case OcclusionBuffer::EVisibility::Occluded:
+							++chunk_occluded;
+							item.drawable = nullptr;
+							break;
+						default:
+							break;
+						}
+					}
+					tested.fetch_add(count, std::memory_order_relaxed);
+					outside_frustum.fetch_add(chunk_outside_frustum, std::memory_order_relaxed);
+					occluded.fetch_add(chunk_occluded, std::memory_order_relaxed);
+				}
+
+				// level is kept per entity, every instance of shared model has own hysteresis
+				for (size_t i = 0; i < count; ++i) {
+					DrawItem& item = draws[first + i];
+					if (item.drawable != nullptr) {
+						meshes[i].lod = item.drawable->SelectLod(camera, item.instance.model_matrix, lod_pixel_error, meshes[i].lod);
+						item.instance.lod = meshes[i].lod;
+					}
+				}
+			});
+
+		CullingStats stats;
+		stats.tested = tested.load(std::memory_order_relaxed);
+		stats.outside_frustum = outside_frustum.load(std::memory_order_relaxed);
+		stats.occluded = occluded.load(std::memory_order_relaxed);
+		if (stats.outside_frustum + stats.occluded + skipped.load(std::memory_order_relaxed) > 0) {
+			draws.erase(std::remove_if(draws.begin(), draws.end(),
+				[](const DrawItem& item) { return item.drawable == nullptr; }), draws.end());
+		}
+		return stats;
+	}
+
+	void Systems::gather_lights(World& world, std::vector<ClusterLight>& lights)
+	{
+		const size_t base = lights.size();
+		lights.resize(base + world.count<LightComponent, TransformComponent>());
+		world.parallel_for_each_chunk<LightComponent, TransformComponent>(
+			[&lights, base](const size_t first, const size_t count, const Entity*,
+				const LightComponent* light_components, const TransformComponent* transforms) {
+				for (size_t i = 0; i < count; ++i) {
+					const glm::mat4& model = transforms[i].model_matrix;
+					if (light_components[i].is_spot) {
+						SpotLight light = light_components[i].light;
+						light.position = glm::vec3(model[3]);
+						light.direction = glm::vec3(model[2]);
+						lights[base + first + i] = ClusterLight::from_spot_light(light);
+					}
+					else {
+						PointLight light = light_components[i].light;
+						light.position = glm::vec3(model[3]);
+						lights[base + first + i] = ClusterLight::from_point_light(light);
+					}
+				}
+			});
+	}
+
+	uint64_t Systems::gather_shadow_casters(World& world,
+		std::vector<ShadowCaster>& static_casters, std::vector<ShadowCaster>& dynamic_casters)
+	{
+		static_casters.clear();
+		dynamic_casters.clear();
+		uint64_t static_hash = 14695981039346656037ull;
+		world.for_each<ShadowCasterComponent, MeshComponent, TransformComponent>(
+			[&](const Entity, const ShadowCasterComponent& caster, const MeshComponent& mesh, const TransformComponent& transform) {
+				// cached static casters keep the finest level, their map is not redrawn when camera moves
+				if (caster.is_static) {
+					static_casters.push_back({ mesh.drawable, transform.model_matrix, 0 });
+					static_hash = hash_bytes(static_hash, &mesh.drawable, sizeof(mesh.drawable));
+					static_hash = hash_bytes(static_hash, &transform.model_matrix, sizeof(transform.model_matrix));
+				}
+				else {
+					dynamic_casters.push_back({ mesh.drawable, transform.model_matrix, mesh.lod });
+				}
+			});
+		return static_hash;
+	}
+
+	void Systems::gather_occluders(World& world, ArenaVector<Occluder>& occluders)
+	{
+		occluders.clear();
+		world.for_each<OccluderComponent, TransformComponent>(
+			[&occluders](const Entity, const OccluderComponent& occluder, const TransformComponent& transform) {
+				occluders.push_back({ occluder.mesh, transform.model_matrix });
+			});
+	}
+
+	void Systems::gather_gpu_instances(World& world, std::vector<GpuInstance>& instances)
+	{
+		instances.resize(world.count<GpuInstanceComponent, TransformComponent, BoundsComponent>());
+		world.parallel_for_each_chunk<GpuInstanceComponent, TransformComponent, BoundsComponent>(
+			[&instances](const size_t first, const size_t count, const Entity*,
+				const GpuInstanceComponent*, const TransformComponent* transforms, const BoundsComponent* bounds) {
+				for (size_t i = 0; i < count; ++i) {
+					GpuInstance& instance = instances[first + i];
+					instance.model = transforms[i].model_matrix;
+					for (int column = 0; column < 3; ++column) {
+						instance.normal[column] = glm::vec4(transforms[i].normal_matrix[column], 0.f);
+					}
+					instance.bounds_center = glm::vec4(bounds[i].center, 1.f);
+					instance.bounds_extent = glm::vec4(bounds[i].extent, 0.f);
+				}
+			});
+	}
+}
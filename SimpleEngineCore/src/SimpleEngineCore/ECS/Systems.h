@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SimpleEngineCore/Memory/LinearArena.h"
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class World;
+	class Camera;
+	class SceneGraph;
+	struct DrawItem;
+	struct ClusterLight;
+	struct ShadowCaster;
+	struct Occluder;
+	struct GpuInstance;
+	class OcclusionBuffer;
+
+	struct CullingStats {
+		size_t tested = 0;			// entities with bounds
+		size_t outside_frustum = 0;
+		size_t occluded = 0;
+	};
+
+	// per frame passes over world, all run chunks on job system threads
+	class Systems {
+	public:
+		// copies world and normal matrices of scene graph nodes to TransformComponent, scene has to be updated
+		static void sync_transforms(World& world, const SceneGraph& scene);
+		// one item per entity with mesh, transform and material, order is chunk order
+		// with occlusion buffer entities with bounds outside of frustum or behind occluders are skipped
+		// skip_gpu_instances leaves out entities with GpuInstanceComponent, they are gathered by gather_gpu_instances
+		// level of detail of visible entities is selected for camera and kept in MeshComponent
+		static CullingStats build_draw_list(World& world, const Camera& camera, const float lod_pixel_error,
+			std::vector<DrawItem>& draws, const OcclusionBuffer* occlusion = nullptr, const bool skip_gpu_instances = false);
+		// appends one light per entity with light and transform
+		static void gather_lights(World& world, std::vector<ClusterLight>& lights);
+		// splits shadow casters, returns hash of static casters which changes when any of them is added, removed or moved
+		static uint64_t gather_shadow_casters(World& world,
+			std::vector<ShadowCaster>& static_casters, std::vector<ShadowCaster>& dynamic_casters);
+		static void gather_occluders(World& world, ArenaVector<Occluder>& occluders);
+		// one instance per entity with GpuInstanceComponent, transform and bounds, order is chunk order
+		static void gather_gpu_instances(World& world, std::vector<GpuInstance>& instances);
+	};
+}
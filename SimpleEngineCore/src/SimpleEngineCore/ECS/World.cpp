@@ -0,0 +1,240 @@
+#include "World.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <mutex>
+
+namespace SimpleEngine {
+
+	namespace {
+		std::mutex s_registry_mutex;
+		std::vector<ComponentInfo> s_component_infos;
+
+		size_t align_up(const size_t value, const size_t alignment) {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	ComponentTypeId ComponentRegistry::register_type(const ComponentInfo& info)
+	{
+		std::lock_guard<std::mutex> lock(s_registry_mutex);
+		if (s_component_infos.size() >= s_max_component_types) {
+			LOG_CRIT("ECS: more than {0} component types", s_max_component_types);
+			return s_max_component_types - 1;
+		}
+		s_component_infos.reserve(s_max_component_types); // infos are read without lock, they must not move
+		s_component_infos.push_back(info);
+		return static_cast<ComponentTypeId>(s_component_infos.size() - 1);
+	}
+
+	const ComponentInfo& ComponentRegistry::get_info(const ComponentTypeId id)
+	{
+		return s_component_infos[id];
+	}
+
+	Archetype::Archetype(const ComponentMask mask, FixedPool& chunk_pool)
+		: m_mask(mask), m_chunk_pool(chunk_pool)
+	{
+		size_t row_size = sizeof(Entity);
+		for (ComponentTypeId type = 0; type < s_max_component_types; ++type) {
+			if (mask & (ComponentMask(1) << type)) {
+				m_types.push_back(type);
+				row_size += ComponentRegistry::get_info(type).size;
+			}
+		}
+
+		// as many rows as fit in chunk with alignment padding between arrays
+		if (row_size > s_chunk_size) {
+			m_chunk_bytes = align_up(row_size + s_chunk_alignment * m_types.size(), s_chunk_alignment);
+			LOG_WARN("ECS: archetype row of {0} bytes doesn't fit in chunk, chunk is {1} bytes", row_size, m_chunk_bytes);
+		}
+		for (m_capacity = static_cast<uint32_t>(m_chunk_bytes / row_size); m_capacity > 1; --m_capacity) {
+			size_t offset = m_capacity * sizeof(Entity);
+			for (const ComponentTypeId type : m_types) {
+				const ComponentInfo& info = ComponentRegistry::get_info(type);
+				offset = align_up(offset, info.alignment);
+				offset += m_capacity * info.size;
+			}
+			if (offset <= m_chunk_bytes) {
+				break;
+			}
+		}
+		size_t offset = m_capacity * sizeof(Entity);
+		for (const ComponentTypeId type : m_types) {
+			const ComponentInfo& info = ComponentRegistry::get_info(type);
+			offset = align_up(offset, info.alignment);
+			m_offsets[type] = static_cast<uint32_t>(offset);
+			offset += m_capacity * info.size;
+		}
+	}
+
+	Archetype::~Archetype()
+	{
+		for (Chunk& chunk : m_chunks) {
+			for (const ComponentTypeId type : m_types) {
+				const ComponentInfo& info = ComponentRegistry::get_info(type);
+				for (uint32_t row = 0; row < chunk.count; ++row) {
+					info.destroy(get_component(chunk, type, row));
+				}
+			}
+			free_chunk(chunk.data);
+		}
+	}
+
+	size_t Archetype::get_entities_count() const
+	{
+		return m_chunks.empty() ? 0 : (m_chunks.size() - 1) * m_capacity + m_chunks.back().count;
+	}
+
+	void Archetype::allocate_row(uint32_t& chunk_index, uint32_t& row)
+	{
+		if (m_chunks.empty() || m_chunks.back().count == m_capacity) {
+			Chunk chunk;
+			chunk.data = allocate_chunk();
+			m_chunks.push_back(chunk);
+		}
+		chunk_index = static_cast<uint32_t>(m_chunks.size() - 1);
+		row = m_chunks.back().count++;
+	}
+
+	Entity Archetype::remove_row(const uint32_t chunk_index, const uint32_t row)
+	{
+		Chunk& chunk = m_chunks[chunk_index];
+		Chunk& last_chunk = m_chunks.back();
+		const uint32_t last_row = last_chunk.count - 1;
+		const bool is_last = &chunk == &last_chunk && row == last_row;
+
+		Entity moved_entity;
+		for (const ComponentTypeId type : m_types) {
+			const ComponentInfo& info = ComponentRegistry::get_info(type);
+			void* component = get_component(chunk, type, row);
+			info.destroy(component);
+			if (!is_last) {
+				// keep chunks dense - last row fills the hole
+				void* last_component = get_component(last_chunk, type, last_row);
+				info.move_construct(component, last_component);
+				info.destroy(last_component);
+			}
+		}
+		if (!is_last) {
+			moved_entity = get_entities(last_chunk)[last_row];
+			get_entities(chunk)[row] = moved_entity;
+		}
+
+		if (--last_chunk.count == 0) {
+			free_chunk(last_chunk.data);
+			m_chunks.pop_back();
+		}
+		return moved_entity;
+	}
+
+	unsigned char* Archetype::allocate_chunk()
+	{
+		if (m_chunk_bytes == m_chunk_pool.get_block_size()) {
+			return static_cast<unsigned char*>(m_chunk_pool.allocate());
+		}
+		return static_cast<unsigned char*>(MemoryTracker::allocate(m_chunk_bytes, s_chunk_alignment, MemoryTag::ECS));
+	}
+
+	void Archetype::free_chunk(unsigned char* data)
+	{
+		if (m_chunk_bytes == m_chunk_pool.get_block_size()) {
+			m_chunk_pool.free(data);
+			return;
+		}
+		MemoryTracker::deallocate(data, m_chunk_bytes, s_chunk_alignment, MemoryTag::ECS);
+	}
+
+	Archetype& World::get_or_create_archetype(const ComponentMask mask)
+	{
+		auto it = m_archetype_by_mask.find(mask);
+		if (it != m_archetype_by_mask.end()) {
+			return *it->second;
+		}
+		m_archetypes.push_back(std::make_unique<Archetype>(mask, m_chunk_pool));
+		Archetype* archetype = m_archetypes.back().get();
+		m_archetype_by_mask.emplace(mask, archetype);
+		return *archetype;
+	}
+
+	Entity World::allocate_entity()
+	{
+		Entity entity;
+		if (!m_free_indices.empty()) {
+			entity.index = m_free_indices.back();
+			m_free_indices.pop_back();
+		}
+		else {
+			entity.index = static_cast<uint32_t>(m_records.size());
+			m_records.emplace_back();
+		}
+		entity.generation = m_records[entity.index].generation;
+		return entity;
+	}
+
+	void World::destroy(const Entity entity)
+	{
+		if (!is_alive(entity)) {
+			return;
+		}
+		EntityRecord& record = m_records[entity.index];
+		const Entity moved_entity = record.archetype->remove_row(record.chunk, record.row);
+		on_row_removed(moved_entity, record.chunk, record.row);
+
+		record.archetype = nullptr;
+		++record.generation; // old handles become invalid
+		m_free_indices.push_back(entity.index);
+	}
+
+	const World::EntityRecord& World::move_entity(const Entity entity, Archetype& to)
+	{
+		EntityRecord& record = m_records[entity.index];
+		Archetype& from = *record.archetype;
+		const Archetype::Chunk& from_chunk = from.get_chunk(record.chunk);
+
+		uint32_t chunk_index = 0;
+		uint32_t row = 0;
+		to.allocate_row(chunk_index, row);
+		const Archetype::Chunk& to_chunk = to.get_chunk(chunk_index);
+		to.get_entities(to_chunk)[row] = entity;
+		for (const ComponentTypeId type : from.get_types()) {
+			if (to.get_mask() & (ComponentMask(1) << type)) {
+				ComponentRegistry::get_info(type).move_construct(
+					to.get_component(to_chunk, type, row), from.get_component(from_chunk, type, record.row));
+			}
+		}
+
+		// moved-from components are destroyed here
+		const Entity moved_entity = from.remove_row(record.chunk, record.row);
+		on_row_removed(moved_entity, record.chunk, record.row);
+
+		record.archetype = &to;
+		record.chunk = chunk_index;
+		record.row = row;
+		return record;
+	}
+
+	void World::on_row_removed(const Entity moved_entity, const uint32_t chunk, const uint32_t row)
+	{
+		if (moved_entity.is_valid()) {
+			EntityRecord& moved_record = m_records[moved_entity.index];
+			moved_record.chunk = chunk;
+			moved_record.row = row;
+		}
+	}
+
+	void World::collect_chunks(const ComponentMask mask)
+	{
+		m_query_chunks.clear();
+		size_t first = 0;
+		for (const std::unique_ptr<Archetype>& archetype : m_archetypes) {
+			if ((archetype->get_mask() & mask) != mask) {
+				continue;
+			}
+			for (size_t i = 0; i < archetype->get_chunks_count(); ++i) {
+				m_query_chunks.push_back({ archetype.get(), static_cast<uint32_t>(i), first });
+				first += archetype->get_chunk(i).count;
+			}
+		}
+	}
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Memory/FixedPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct Entity {
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool is_valid() const { return index != UINT32_MAX; }
+		bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Entity& other) const { return !(*this == other); }
+	};
+
+	using ComponentTypeId = uint32_t;
+	using ComponentMask = uint64_t;
+	constexpr size_t s_max_component_types = 64;
+
+	// how to move and destroy component without knowing its type (components move between archetypes)
+	struct ComponentInfo {
+		size_t size = 0;
+		size_t alignment = 0;
+		void (*move_construct)(void* dst, void* src) = nullptr;
+		void (*destroy)(void* ptr) = nullptr;
+	};
+
+	class ComponentRegistry {
+	public:
+		template<typename T>
+		static ComponentTypeId get_id() {
+			static const ComponentTypeId id = register_type(make_info<T>());
+			return id;
+		}
+		template<typename T>
+		static ComponentMask get_mask() { return ComponentMask(1) << get_id<T>(); }
+
+		static const ComponentInfo& get_info(const ComponentTypeId id);
+
+	private:
+		template<typename T>
+		static ComponentInfo make_info() {
+			static_assert(alignof(T) <= 64, "Component alignment is bigger than chunk alignment");
+			ComponentInfo info;
+			info.size = sizeof(T);
+			info.alignment = alignof(T);
+			info.move_construct = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); };
+			info.destroy = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+			return info;
+		}
+		static ComponentTypeId register_type(const ComponentInfo& info);
+	};
+
+	// all entities with exactly the same set of components
+	// stored in 16KB chunks, inside of chunk every component is own array (SoA)
+	// chunks come from pool of world, bigger ones for oversize rows from heap
+	class Archetype {
+	public:
+		static constexpr size_t s_chunk_size = 16 * 1024;
+		static constexpr size_t s_chunk_alignment = 64;
+
+		struct Chunk {
+			unsigned char* data = nullptr;
+			uint32_t count = 0;
+		};
+
+		Archetype(const ComponentMask mask, FixedPool& chunk_pool);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		ComponentMask get_mask() const { return m_mask; }
+		const std::vector<ComponentTypeId>& get_types() const { return m_types; }
+		uint32_t get_capacity() const { return m_capacity; }
+		size_t get_chunks_count() const { return m_chunks.size(); }
+		Chunk& get_chunk(const size_t index) { return m_chunks[index]; }
+		size_t get_entities_count() const;
+
+		Entity* get_entities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data); }
+		void* get_component(const Chunk& chunk, const ComponentTypeId type, const uint32_t row) const {
+			return chunk.data + m_offsets[type] + row * ComponentRegistry::get_info(type).size;
+		}
+		template<typename T>
+		T* get_array(const Chunk& chunk) const {
+			return reinterpret_cast<T*>(chunk.data + m_offsets[ComponentRegistry::get_id<T>()]);
+		}
+
+		// new row at the end, components are not constructed
+		void allocate_row(uint32_t& chunk_index, uint32_t& row);
+		// destroys components of row and moves the last row to its place
+		// returns entity which was moved (invalid if row was the last one)
+		Entity remove_row(const uint32_t chunk_index, const uint32_t row);
+
+	private:
+		unsigned char* allocate_chunk();
+		void free_chunk(unsigned char* data);
+
+		ComponentMask m_mask;
+		FixedPool& m_chunk_pool;
+		std::vector<ComponentTypeId> m_types;
+		uint32_t m_offsets[s_max_component_types] = {};
+		uint32_t m_capacity = 0;
+		size_t m_chunk_bytes = s_chunk_size;
+		TaggedVector<Chunk, MemoryTag::ECS> m_chunks;	// all are full except the last one
+	};
+
+	// structural changes (create, destroy, add, remove) are not thread safe
+	// and are not allowed while iterating, components themselves can be changed from parallel queries
+	class World {
+	public:
+		World() = default;
+		~World() = default;
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		template<typename... Ts>
+		Entity create(Ts&&... components) {
+			Archetype& archetype = get_or_create_archetype(get_mask<std::decay_t<Ts>...>());
+			const Entity entity = allocate_entity();
+			EntityRecord& record = m_records[entity.index];
+			record.archetype = &archetype;
+			archetype.allocate_row(record.chunk, record.row);
+
+			const Archetype::Chunk& chunk = archetype.get_chunk(record.chunk);
+			archetype.get_entities(chunk)[record.row] = entity;
+			(construct<std::decay_t<Ts>>(archetype, chunk, record.row, std::forward<Ts>(components)), ...);
+			return entity;
+		}
+
+		void destroy(const Entity entity);
+		bool is_alive(const Entity entity) const {
+			return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation
+				&& m_records[entity.index].archetype != nullptr;
+		}
+
+		// nullptr if entity doesn't have such component
+		template<typename T>
+		T* get(const Entity entity) {
+			if (!is_alive(entity)) {
+				return nullptr;
+			}
+			const EntityRecord& record = m_records[entity.index];
+			if (!(record.archetype->get_mask() & ComponentRegistry::get_mask<T>())) {
+				return nullptr;
+			}
+			return record.archetype->get_array<T>(record.archetype->get_chunk(record.chunk)) + record.row;
+		}
+
+		template<typename T>
+		bool has(const Entity entity) const {
+			return is_alive(entity) && (m_records[entity.index].archetype->get_mask() & ComponentRegistry::get_mask<T>());
+		}
+
+		// moves entity to archetype with T, or replaces T if entity has it
+		template<typename T>
+		void add(const Entity entity, T&& component) {
+			using Component = std::decay_t<T>;
+			if (Component* existing = get<Component>(entity)) {
+				*existing = std::forward<T>(component);
+				return;
+			}
+			if (!is_alive(entity)) {
+				return;
+			}
+			Archetype& archetype = get_or_create_archetype(
+				m_records[entity.index].archetype->get_mask() | ComponentRegistry::get_mask<Component>());
+			const EntityRecord& record = move_entity(entity, archetype);
+			construct<Component>(archetype, archetype.get_chunk(record.chunk), record.row, std::forward<T>(component));
+		}
+
+		template<typename T>
+		void remove(const Entity entity) {
+			if (!has<T>(entity)) {
+				return;
+			}
+			Archetype& archetype = get_or_create_archetype(
+				m_records[entity.index].archetype->get_mask() & ~ComponentRegistry::get_mask<T>());
+			move_entity(entity, archetype);
+		}
+
+		// f(Entity, Ts&...)
+		template<typename... Ts, typename F>
+		void for_each(F&& f) {
+			for_each_chunk<Ts...>([&f](const size_t, const size_t count, const Entity* entities, Ts*... components) {
+				for (size_t i = 0; i < count; ++i) {
+					f(entities[i], components[i]...);
+				}
+			});
+		}
+
+		// f(first, count, entities, Ts* arrays...), first - index of chunk first entity among all entities of query
+		template<typename... Ts, typename F>
+		void for_each_chunk(F&& f) {
+			const ComponentMask mask = get_mask<Ts...>();
+			size_t first = 0;
+			for (const std::unique_ptr<Archetype>& archetype : m_archetypes) {
+				if ((archetype->get_mask() & mask) != mask) {
+					continue;
+				}
+				for (size_t i = 0; i < archetype->get_chunks_count(); ++i) {
+					const Archetype::Chunk& chunk = archetype->get_chunk(i);
+					f(first, static_cast<size_t>(chunk.count), archetype->get_entities(chunk), archetype->get_array<Ts>(chunk)...);
+					first += chunk.count;
+				}
+			}
+		}
+
+		// same as for_each_chunk, chunks are spread between job system threads
+		template<typename... Ts, typename F>
+		void parallel_for_each_chunk(const F& f) {
+			collect_chunks(get_mask<Ts...>());
+			const std::vector<ChunkRef>& chunks = m_query_chunks;
+			JobSystem::parallel_for(chunks.size(), JobSystem::get_batch_size(chunks.size(), 1),
+				[&chunks, &f](const size_t begin, const size_t end) {
+					for (size_t i = begin; i < end; ++i) {
+						const ChunkRef& ref = chunks[i];
+						const Archetype::Chunk& chunk = ref.archetype->get_chunk(ref.chunk);
+						f(ref.first, static_cast<size_t>(chunk.count), ref.archetype->get_entities(chunk), ref.archetype->template get_array<Ts>(chunk)...);
+					}
+				});
+		}
+
+		template<typename... Ts, typename F>
+		void parallel_for_each(const F& f) {
+			parallel_for_each_chunk<Ts...>([&f](const size_t, const size_t count, const Entity* entities, Ts*... components) {
+				for (size_t i = 0; i < count; ++i) {
+					f(entities[i], components[i]...);
+				}
+			});
+		}
+
+		// how many entities have all Ts
+		template<typename... Ts>
+		size_t count() const {
+			const ComponentMask mask = get_mask<Ts...>();
+			size_t result = 0;
+			for (const std::unique_ptr<Archetype>& archetype : m_archetypes) {
+				if ((archetype->get_mask() & mask) == mask) {
+					result += archetype->get_entities_count();
+				}
+			}
+			return result;
+		}
+
+		size_t get_entities_count() const { return m_records.size() - m_free_indices.size(); }
+		size_t get_archetypes_count() const { return m_archetypes.size(); }
+		FixedPool::Stats get_chunk_pool_stats() const { return m_chunk_pool.get_stats(); }
+
+	private:
+		static constexpr size_t s_chunks_per_page = 16;
+
+		struct EntityRecord {
+			Archetype* archetype = nullptr;
+			uint32_t chunk = 0;
+			uint32_t row = 0;
+			uint32_t generation = 0;
+		};
+
+		struct ChunkRef {
+			Archetype* archetype;
+			uint32_t chunk;
+			size_t first;
+		};
+
+		template<typename... Ts>
+		static ComponentMask get_mask() {
+			return (ComponentMask(0) | ... | ComponentRegistry::get_mask<Ts>());
+		}
+
+		template<typename T, typename Arg>
+		static void construct(Archetype& archetype, const Archetype::Chunk& chunk, const uint32_t row, Arg&& arg) {
+			new (archetype.get_array<T>(chunk) + row) T(std::forward<Arg>(arg));
+		}
+
+		Archetype& get_or_create_archetype(const ComponentMask mask);
+		Entity allocate_entity();
+		// moves components which exist in both archetypes, others are destroyed
+		const EntityRecord& move_entity(const Entity entity, Archetype& to);
+		void on_row_removed(const Entity moved_entity, const uint32_t chunk, const uint32_t row);
+		void collect_chunks(const ComponentMask mask);
+
+		TaggedVector<EntityRecord, MemoryTag::ECS> m_records;
+		TaggedVector<uint32_t, MemoryTag::ECS> m_free_indices;
+
+		// destroyed after archetypes which give chunks back to it
+		FixedPool m_chunk_pool{ Archetype::s_chunk_size, Archetype::s_chunk_alignment, s_chunks_per_page, MemoryTag::ECS };
+		std::vector<std::unique_ptr<Archetype>> m_archetypes;
+		std::unordered_map<ComponentMask, Archetype*> m_archetype_by_mask;
+
+		std::vector<ChunkRef> m_query_chunks;	// reused by parallel queries
+	};
+}
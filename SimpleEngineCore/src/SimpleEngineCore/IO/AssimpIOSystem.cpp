@@ -0,0 +1,77 @@
+#include "AssimpIOSystem.h"
+#include "FileSystem.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace SimpleEngine {
+
+	namespace {
+		class FileDataStream : public Assimp::IOStream {
+		public:
+			explicit FileDataStream(FileData&& data) : m_data(std::move(data)) {}
+
+			size_t Read(void* buffer, size_t size, size_t count) override {
+				if (size == 0) {
+					return 0;
+				}
+				// only whole items, like fread
+				count = std::min(count, (m_data.size() - m_position) / size);
+				std::memcpy(buffer, m_data.data() + m_position, count * size);
+				m_position += count * size;
+				return count;
+			}
+			size_t Write(const void*, size_t, size_t) override { return 0; }
+			aiReturn Seek(size_t offset, aiOrigin origin) override {
+				size_t position = offset;
+				if (origin == aiOrigin_CUR) {
+					position = m_position + offset;
+				}
+				else if (origin == aiOrigin_END) {
+					position = m_data.size() - offset;
+				}
+				if (position > m_data.size()) {
+					return aiReturn_FAILURE;
+				}
+				m_position = position;
+				return aiReturn_SUCCESS;
+			}
+			size_t Tell() const override { return m_position; }
+			size_t FileSize() const override { return m_data.size(); }
+			void Flush() override {}
+
+		private:
+			FileData m_data;
+			size_t m_position = 0;
+		};
+	}
+
+	bool AssimpIOSystem::Exists(const char* file) const
+	{
+		if (m_used_files) {
+			m_used_files->push_back(file);
+		}
+		return FileSystem::exists(file);
+	}
+
+	Assimp::IOStream* AssimpIOSystem::Open(const char* file, const char* mode)
+	{
+		if (std::strchr(mode, 'w') || std::strchr(mode, 'a')) {
+			return nullptr;
+		}
+		if (m_used_files) {
+			m_used_files->push_back(file);
+		}
+		FileData data;
+		if (!FileSystem::read(file, data)) {
+			return nullptr;
+		}
+		return new FileDataStream(std::move(data));
+	}
+
+	void AssimpIOSystem::Close(Assimp::IOStream* stream)
+	{
+		delete stream;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// assimp opens model and its material files through FileSystem, so models load from archives too
+	// importer takes ownership: import.SetIOHandler(new AssimpIOSystem())
+	class AssimpIOSystem : public Assimp::IOSystem {
+	public:
+		AssimpIOSystem() = default;
+		// every path importer looks for or opens is added, missing files too, they are what model depends on
+		explicit AssimpIOSystem(std::vector<std::string>* used_files) : m_used_files(used_files) {}
+
+		bool Exists(const char* file) const override;
+		char getOsSeparator() const override { return '/'; }
+		// files are read whole into memory, write modes are not supported
+		Assimp::IOStream* Open(const char* file, const char* mode = "rb") override;
+		void Close(Assimp::IOStream* stream) override;
+
+	private:
+		std::vector<std::string>* m_used_files = nullptr;
+	};
+}
@@ -0,0 +1,630 @@
+#include "AsyncIO.h"
+#include "IoUring.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleEngine {
+
+	namespace {
+		// one read of a big file is split, so cancel waits for one chunk at most
+		constexpr uint64_t s_chunk_size = 1024 * 1024;
+		// completed reads whose callback jobs didn't run yet, reading stops above it
+		// so decoding which can't keep up doesn't fill memory and job ring of other threads
+		constexpr uint32_t s_max_finishing = 1024;
+
+		struct NativeFile {
+#ifdef _WIN32
+			HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+			int fd = -1;
+#endif
+		};
+
+		bool open_file(const std::filesystem::path& path, NativeFile& file, uint64_t& size)
+		{
+#ifdef _WIN32
+			file.handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			LARGE_INTEGER file_size;
+			if (file.handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file.handle, &file_size)) {
+				return false;
+			}
+			size = static_cast<uint64_t>(file_size.QuadPart);
+#else
+			file.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat info;
+			if (file.fd < 0 || fstat(file.fd, &info) != 0) {
+				return false;
+			}
+			size = static_cast<uint64_t>(info.st_size);
+#endif
+			return true;
+		}
+
+		// bytes read, 0 at the end of file, -1 on error
+		int64_t read_file_at(const NativeFile& file, uint8_t* buffer, const uint32_t size, const uint64_t offset)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD read = 0;
+			if (!ReadFile(file.handle, buffer, size, &read, &overlapped)) {
+				return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+			}
+			return read;
+#else
+			ssize_t read = 0;
+			do {
+				read = pread(file.fd, buffer, size, static_cast<off_t>(offset));
+			} while (read < 0 && errno == EINTR);
+			return read;
+#endif
+		}
+
+		void close_file(NativeFile& file)
+		{
+#ifdef _WIN32
+			if (file.handle != INVALID_HANDLE_VALUE) {
+				CloseHandle(file.handle);
+				file.handle = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (file.fd >= 0) {
+				::close(file.fd);
+				file.fd = -1;
+			}
+#endif
+		}
+
+		// registered buffers, FileData which views one gives it back when it is reset
+		struct BufferPool {
+			std::unique_ptr<uint8_t[]> memory;
+			size_t buffer_size = 0;
+			std::vector<uint8_t*> buffers;
+			std::mutex mutex;
+			std::vector<int> free;
+
+			// -1 when every buffer is viewed by somebody
+			int acquire() {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (free.empty()) {
+					return -1;
+				}
+				const int index = free.back();
+				free.pop_back();
+				return index;
+			}
+
+			void release(const int index) {
+				std::lock_guard<std::mutex> lock(mutex);
+				free.push_back(index);
+			}
+		};
+
+		struct IoRequest {
+			IoRequestId id = 0;
+			std::filesystem::path path;
+			IoPriority priority = IoPriority::Normal;
+			AsyncIO::Callback callback = nullptr;
+			void* user_data = nullptr;
+			JobCounter* counter = nullptr;
+			std::atomic<bool> cancelled{ false };
+			bool queued = true;		// under mutex, false once backend took it
+
+			IoStatus status = IoStatus::Failed;
+			bool read_by_job = false;	// archive entry or missing file, FileSystem::read in the job
+			FileData data;
+			std::vector<uint8_t> bytes;		// when it is not read into registered buffer
+			NativeFile file;
+			uint64_t size = 0;
+			uint64_t done = 0;
+			uint8_t* target = nullptr;
+			int buffer_index = -1;
+		};
+
+		struct AsyncIOData {
+			AsyncIO::Settings settings;
+			AsyncIO::Backend backend = AsyncIO::Backend::None;
+
+			std::mutex mutex;
+			std::condition_variable condition;
+			std::deque<IoRequest*> queues[static_cast<size_t>(IoPriority::Count)];
+			// not completed yet, for cancel
+			std::unordered_map<IoRequestId, IoRequest*> requests;
+			IoRequestId next_id = 1;
+			uint32_t low_limit = 1;		// of active low priority reads
+			uint32_t active_low = 0;	// taken by backend and not completed
+			uint32_t finishing = 0;
+			bool running = false;
+
+			std::vector<std::thread> threads;
+			IoUring ring;
+			std::shared_ptr<BufferPool> pool;
+		};
+
+		struct Counters {
+			std::atomic<uint64_t> requests{ 0 };
+			std::atomic<uint64_t> done{ 0 };
+			std::atomic<uint64_t> failed{ 0 };
+			std::atomic<uint64_t> cancelled{ 0 };
+			std::atomic<uint64_t> bytes_read{ 0 };
+			std::atomic<uint64_t> submits{ 0 };
+			std::atomic<uint64_t> buffer_reads{ 0 };
+			std::atomic<uint64_t> archive_reads{ 0 };
+		};
+
+		AsyncIOData s_data;
+		Counters s_counters;
+
+		// under mutex
+		bool can_take_request()
+		{
+			if (s_data.finishing >= s_max_finishing) {
+				return false;
+			}
+			for (size_t i = 0; i < static_cast<size_t>(IoPriority::Low); ++i) {
+				if (!s_data.queues[i].empty()) {
+					return true;
+				}
+			}
+			return !s_data.queues[static_cast<size_t>(IoPriority::Low)].empty() && s_data.active_low < s_data.low_limit;
+		}
+
+		// under mutex, the most urgent request, low priority only while it leaves room for others
+		IoRequest* take_request()
+		{
+			if (s_data.finishing >= s_max_finishing) {
+				return nullptr;
+			}
+			for (size_t i = 0; i < static_cast<size_t>(IoPriority::Count); ++i) {
+				std::deque<IoRequest*>& queue = s_data.queues[i];
+				if (queue.empty() || (i == static_cast<size_t>(IoPriority::Low) && s_data.active_low >= s_data.low_limit)) {
+					continue;
+				}
+				IoRequest* request = queue.front();
+				queue.pop_front();
+				request->queued = false;
+				if (request->priority == IoPriority::Low) {
+					++s_data.active_low;
+				}
+				return request;
+			}
+			return nullptr;
+		}
+
+		// job: archive entries are read here, then callback sees the bytes
+		void finish_request(IoRequest* request)
+		{
+			if (request->status == IoStatus::Done && request->read_by_job) {
+				s_counters.archive_reads.fetch_add(1, std::memory_order_relaxed);
+				if (!FileSystem::read(request->path, request->data)) {
+					request->status = IoStatus::Failed;
+				}
+			}
+			switch (request->status) {
+			case IoStatus::Done:
+				s_counters.done.fetch_add(1, std::memory_order_relaxed);
+				s_counters.bytes_read.fetch_add(request->data.size(), std::memory_order_relaxed);
+				break;
+			case IoStatus::Failed:
+				s_counters.failed.fetch_add(1, std::memory_order_relaxed);
+				request->data.reset();
+				break;
+			case IoStatus::Cancelled:
+				s_counters.cancelled.fetch_add(1, std::memory_order_relaxed);
+				request->data.reset();
+				break;
+			}
+			request->callback(request->status, request->data, request->user_data);
+			JobCounter* counter = request->counter;
+			delete request;
+			{
+				std::lock_guard<std::mutex> lock(s_data.mutex);
+				--s_data.finishing;
+			}
+			s_data.condition.notify_one();
+			if (counter) {
+				JobSystem::release(*counter);
+			}
+		}
+
+		// from any thread, request is not touched by backend after this
+		void complete_request(IoRequest* request, const IoStatus status)
+		{
+			close_file(request->file);
+			{
+				std::lock_guard<std::mutex> lock(s_data.mutex);
+				// cancel which returned true always gives Cancelled, even when the last chunk has arrived
+				request->status = request->cancelled.load(std::memory_order_relaxed) ? IoStatus::Cancelled : status;
+				s_data.requests.erase(request->id);
+				++s_data.finishing;
+				if (!request->queued && request->priority == IoPriority::Low) {
+					--s_data.active_low;
+				}
+			}
+			// low priority request may wait for this one
+			s_data.condition.notify_one();
+			JobSystem::run([request]() { finish_request(request); });
+		}
+
+		// false when request completed without a read
+		bool open_request(IoRequest* request)
+		{
+			if (request->cancelled.load(std::memory_order_acquire)) {
+				complete_request(request, IoStatus::Cancelled);
+				return false;
+			}
+			const std::filesystem::path disk_path = FileSystem::get_disk_path(request->path);
+			if (disk_path.empty()) {
+				request->read_by_job = true;
+				complete_request(request, IoStatus::Done);
+				return false;
+			}
+			if (!open_file(disk_path, request->file, request->size) || request->size > SIZE_MAX) {
+				complete_request(request, IoStatus::Failed);
+				return false;
+			}
+			if (request->size == 0) {
+				complete_request(request, IoStatus::Done);
+				return false;
+			}
+			return true;
+		}
+
+		void set_read_data(IoRequest* request)
+		{
+			if (request->buffer_index >= 0) {
+				const std::shared_ptr<BufferPool>& pool = s_data.pool;
+				const int index = request->buffer_index;
+				request->data.assign_view(request->target, static_cast<size_t>(request->size),
+					std::shared_ptr<const void>(request->target, [pool, index](const void*) { pool->release(index); }));
+			}
+			else {
+				request->data.assign(std::move(request->bytes));
+			}
+		}
+
+		uint32_t get_chunk_size(const IoRequest* request)
+		{
+			return static_cast<uint32_t>(std::min(request->size - request->done, s_chunk_size));
+		}
+
+		void prepare_chunk(IoRequest* request)
+		{
+#ifdef _WIN32
+			// io_uring is never there
+			const int fd = -1;
+#else
+			const int fd = request->file.fd;
+#endif
+			// never fails, every read in flight has at most one entry and queue has depth entries
+			s_data.ring.prepare_read(fd, request->target + request->done, get_chunk_size(request),
+				request->done, reinterpret_cast<uint64_t>(request), request->buffer_index);
+		}
+
+		// the only thread which touches ring
+		// reads of all new requests and of next chunks go to kernel by one syscall
+		void io_uring_loop()
+		{
+			uint32_t in_flight = 0;
+			BufferPool* pool = s_data.pool.get();
+			while (true) {
+				{
+					std::unique_lock<std::mutex> lock(s_data.mutex);
+					if (in_flight == 0) {
+						s_data.condition.wait(lock, []() { return !s_data.running || can_take_request(); });
+						if (!s_data.running && !can_take_request()) {
+							return;
+						}
+					}
+				}
+				// new requests wait for the next completion when thread is inside of submit
+				while (in_flight < s_data.settings.queue_depth) {
+					IoRequest* request = nullptr;
+					{
+						std::lock_guard<std::mutex> lock(s_data.mutex);
+						request = take_request();
+					}
+					if (!request) {
+						break;
+					}
+					if (!open_request(request)) {
+						continue;
+					}
+					request->buffer_index = pool && request->size <= pool->buffer_size ? pool->acquire() : -1;
+					if (request->buffer_index >= 0) {
+						request->target = pool->buffers[request->buffer_index];
+						s_counters.buffer_reads.fetch_add(1, std::memory_order_relaxed);
+					}
+					else {
+						request->bytes.resize(static_cast<size_t>(request->size));
+						request->target = request->bytes.data();
+					}
+					prepare_chunk(request);
+					++in_flight;
+				}
+				if (in_flight == 0) {
+					continue;
+				}
+
+				const int submitted = s_data.ring.submit(1);
+				if (submitted < 0 && submitted != -EBUSY && submitted != -EAGAIN) {
+					LOG_ERROR_TO(Assets, "AsyncIO: io_uring submit failed: {0}", std::strerror(-submitted));
+					std::this_thread::yield();
+				}
+				s_counters.submits.fetch_add(1, std::memory_order_relaxed);
+
+				IoUring::Completion completion;
+				while (s_data.ring.pop_completion(completion)) {
+					--in_flight;
+					IoRequest* request = reinterpret_cast<IoRequest*>(completion.user_data);
+					if (completion.result == -EINTR || completion.result == -EAGAIN) {
+						prepare_chunk(request);
+						++in_flight;
+						continue;
+					}
+					if (completion.result <= 0) {
+						// 0 - file became shorter after it was opened
+						if (completion.result < 0) {
+							LOG_ERROR_TO(Assets, "Failed to read {0}: {1}", request->path.string(), std::strerror(-completion.result));
+						}
+						if (request->buffer_index >= 0) {
+							pool->release(request->buffer_index);
+						}
+						complete_request(request, IoStatus::Failed);
+						continue;
+					}
+					request->done += static_cast<uint64_t>(completion.result);
+					if (request->done < request->size && !request->cancelled.load(std::memory_order_acquire)) {
+						prepare_chunk(request);
+						++in_flight;
+						continue;
+					}
+					if (request->done < request->size) {
+						if (request->buffer_index >= 0) {
+							pool->release(request->buffer_index);
+						}
+						complete_request(request, IoStatus::Cancelled);
+						continue;
+					}
+					set_read_data(request);
+					complete_request(request, IoStatus::Done);
+				}
+			}
+		}
+
+		// blocking reads, each thread has one request at a time
+		void threads_loop()
+		{
+			while (true) {
+				IoRequest* request = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(s_data.mutex);
+					s_data.condition.wait(lock, []() { return !s_data.running || can_take_request(); });
+					request = take_request();
+					if (!request) {
+						if (!s_data.running) {
+							return;
+						}
+						continue;
+					}
+				}
+				if (!open_request(request)) {
+					continue;
+				}
+				request->bytes.resize(static_cast<size_t>(request->size));
+				request->target = request->bytes.data();
+				IoStatus status = IoStatus::Done;
+				while (request->done < request->size) {
+					if (request->cancelled.load(std::memory_order_acquire)) {
+						status = IoStatus::Cancelled;
+						break;
+					}
+					const int64_t read = read_file_at(request->file, request->target + request->done,
+						get_chunk_size(request), request->done);
+					if (read <= 0) {
+						LOG_ERROR_TO(Assets, "Failed to read {0}", request->path.string());
+						status = IoStatus::Failed;
+						break;
+					}
+					request->done += static_cast<uint64_t>(read);
+				}
+				if (status == IoStatus::Done) {
+					set_read_data(request);
+				}
+				complete_request(request, status);
+			}
+		}
+	}
+
+	void AsyncIO::init(const Settings& settings)
+	{
+		if (s_data.backend != Backend::None) {
+			return;
+		}
+		s_data.settings = settings;
+		s_data.settings.queue_depth = std::max<uint32_t>(settings.queue_depth, 1);
+		s_data.settings.threads_count = std::max<uint32_t>(settings.threads_count, 1);
+		s_data.running = true;
+
+		if (settings.use_io_uring && s_data.ring.init(s_data.settings.queue_depth)) {
+			s_data.backend = Backend::IoUring;
+			s_data.settings.queue_depth = std::min(s_data.settings.queue_depth, s_data.ring.get_entries());
+			s_data.low_limit = std::max<uint32_t>(s_data.settings.queue_depth / 2, 1);
+			if (settings.buffers_count > 0 && settings.buffer_size > 0) {
+				std::shared_ptr<BufferPool> pool = std::make_shared<BufferPool>();
+				pool->buffer_size = settings.buffer_size;
+				pool->memory.reset(new uint8_t[size_t(settings.buffers_count) * settings.buffer_size]);
+				for (uint32_t i = 0; i < settings.buffers_count; ++i) {
+					pool->buffers.push_back(pool->memory.get() + size_t(i) * settings.buffer_size);
+					pool->free.push_back(static_cast<int>(settings.buffers_count - 1 - i));
+				}
+				if (s_data.ring.register_buffers(pool->buffers.data(), pool->buffer_size, settings.buffers_count)) {
+					s_data.pool = std::move(pool);
+				}
+				else {
+					LOG_WARN_TO(Assets, "AsyncIO: buffers are not registered, every read allocates");
+				}
+			}
+			s_data.threads.emplace_back(io_uring_loop);
+		}
+		else {
+			s_data.backend = Backend::Threads;
+			s_data.low_limit = std::max<uint32_t>(s_data.settings.threads_count / 2, 1);
+			for (uint32_t i = 0; i < s_data.settings.threads_count; ++i) {
+				s_data.threads.emplace_back(threads_loop);
+			}
+		}
+		LOG_INFO_TO(Assets, "AsyncIO: {0}, {1} reads in flight, {2} registered buffers", get_backend_name(s_data.backend),
+			s_data.backend == Backend::IoUring ? s_data.settings.queue_depth : s_data.settings.threads_count,
+			s_data.pool ? s_data.pool->buffers.size() : 0);
+	}
+
+	void AsyncIO::shutdown()
+	{
+		if (s_data.backend == Backend::None) {
+			return;
+		}
+		std::vector<IoRequest*> queued;
+		{
+			std::lock_guard<std::mutex> lock(s_data.mutex);
+			s_data.running = false;
+			for (std::deque<IoRequest*>& queue : s_data.queues) {
+				queued.insert(queued.end(), queue.begin(), queue.end());
+				queue.clear();
+			}
+		}
+		for (IoRequest* request : queued) {
+			complete_request(request, IoStatus::Cancelled);
+		}
+		s_data.condition.notify_all();
+		for (std::thread& thread : s_data.threads) {
+			thread.join();
+		}
+		s_data.threads.clear();
+		s_data.ring.close();
+		// views of buffers keep pool alive
+		s_data.pool.reset();
+		s_data.backend = Backend::None;
+
+		const Stats stats = get_stats();
+		LOG_INFO_TO(Assets, "AsyncIO: {0} reads, {1} failed, {2} cancelled, {3} bytes, {4} submits",
+			stats.requests, stats.failed, stats.cancelled, stats.bytes_read, stats.submits);
+	}
+
+	bool AsyncIO::is_initialized()
+	{
+		return s_data.backend != Backend::None;
+	}
+
+	IoRequestId AsyncIO::read(const std::filesystem::path& path, const IoPriority priority,
+		Callback callback, void* user_data, JobCounter* counter)
+	{
+		s_counters.requests.fetch_add(1, std::memory_order_relaxed);
+		if (s_data.backend == Backend::None) {
+			FileData data;
+			const bool read = FileSystem::read(path, data);
+			(read ? s_counters.done : s_counters.failed).fetch_add(1, std::memory_order_relaxed);
+			s_counters.bytes_read.fetch_add(data.size(), std::memory_order_relaxed);
+			callback(read ? IoStatus::Done : IoStatus::Failed, data, user_data);
+			return 0;
+		}
+
+		IoRequest* request = new IoRequest();
+		request->path = path;
+		request->priority = priority < IoPriority::Count ? priority : IoPriority::Normal;
+		request->callback = callback;
+		request->user_data = user_data;
+		request->counter = counter;
+		if (counter) {
+			JobSystem::hold(*counter);
+		}
+		IoRequestId id = 0;
+		{
+			std::lock_guard<std::mutex> lock(s_data.mutex);
+			id = s_data.next_id++;
+			request->id = id;
+			s_data.requests.emplace(id, request);
+			s_data.queues[static_cast<size_t>(request->priority)].push_back(request);
+		}
+		s_data.condition.notify_one();
+		return id;
+	}
+
+	bool AsyncIO::cancel(const IoRequestId id)
+	{
+		IoRequest* queued = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(s_data.mutex);
+			const auto it = s_data.requests.find(id);
+			if (it == s_data.requests.end()) {
+				return false;
+			}
+			IoRequest* request = it->second;
+			request->cancelled.store(true, std::memory_order_release);
+			if (request->queued) {
+				std::deque<IoRequest*>& queue = s_data.queues[static_cast<size_t>(request->priority)];
+				queue.erase(std::find(queue.begin(), queue.end(), request));
+				s_data.requests.erase(it);
+				queued = request;
+			}
+		}
+		if (queued) {
+			complete_request(queued, IoStatus::Cancelled);
+		}
+		return true;
+	}
+
+	AsyncIO::Backend AsyncIO::get_backend()
+	{
+		return s_data.backend;
+	}
+
+	const char* AsyncIO::get_backend_name(const Backend backend)
+	{
+		switch (backend) {
+		case Backend::IoUring:
+			return "io_uring";
+		case Backend::Threads:
+			return "threads";
+		default:
+			return "none";
+		}
+	}
+
+	AsyncIO::Stats AsyncIO::get_stats()
+	{
+		Stats stats;
+		stats.requests = s_counters.requests.load(std::memory_order_relaxed);
+		stats.done = s_counters.done.load(std::memory_order_relaxed);
+		stats.failed = s_counters.failed.load(std::memory_order_relaxed);
+		stats.cancelled = s_counters.cancelled.load(std::memory_order_relaxed);
+		stats.bytes_read = s_counters.bytes_read.load(std::memory_order_relaxed);
+		stats.submits = s_counters.submits.load(std::memory_order_relaxed);
+		stats.buffer_reads = s_counters.buffer_reads.load(std::memory_order_relaxed);
+		stats.archive_reads = s_counters.archive_reads.load(std::memory_order_relaxed);
+		return stats;
+	}
+}
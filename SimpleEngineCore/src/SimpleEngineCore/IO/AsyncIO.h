@@ -0,0 +1,82 @@
+#pragma once
+
+#include "FileSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace SimpleEngine {
+
+	class JobCounter;
+
+	enum class IoPriority : uint8_t {
+		High,		// needed now, goes before everything queued
+		Normal,
+		Low,		// streaming ahead, never takes more than half of queue
+		Count
+	};
+
+	enum class IoStatus : uint8_t {
+		Done,
+		Failed,
+		Cancelled
+	};
+
+	using IoRequestId = uint64_t;	// 0 is invalid
+
+	// whole file reads in the background: io_uring on Linux, blocking reads on a few threads elsewhere
+	// or when io_uring is not allowed, completion callback runs as a job so decoding overlaps reads in flight
+	class AsyncIO {
+	public:
+		enum class Backend : uint8_t {
+			None,
+			IoUring,
+			Threads
+		};
+
+		struct Settings {
+			uint32_t queue_depth = 64;		// reads in flight
+			uint32_t threads_count = 4;		// of thread backend
+			// registered with io_uring, files which fit are read into them and given as a view
+			uint32_t buffers_count = 32;
+			uint32_t buffer_size = 256 * 1024;
+			bool use_io_uring = true;
+		};
+
+		struct Stats {
+			uint64_t requests = 0;
+			uint64_t done = 0;
+			uint64_t failed = 0;
+			uint64_t cancelled = 0;
+			uint64_t bytes_read = 0;
+			uint64_t submits = 0;			// syscalls which sent reads to kernel
+			uint64_t buffer_reads = 0;		// into registered buffers
+			uint64_t archive_reads = 0;		// given to FileSystem, entries are already mapped
+		};
+
+		// data is empty unless status is Done, it may be a view and is valid until reset
+		// user_data belongs to caller, callback is the last place which sees it
+		using Callback = void(*)(const IoStatus status, FileData& data, void* user_data);
+
+		static void init() { init(Settings()); }
+		// after JobSystem::init, SIMPLE_ENGINE_IO=threads turns io_uring off
+		static void init(const Settings& settings);
+		// queued reads are cancelled, reads in flight are finished
+		static void shutdown();
+		static bool is_initialized();
+
+		// path is virtual, loose files are read by backend, archive entries by the job from mapping
+		// callback is called exactly once and counter (if any) is done after it
+		// without init the file is read and callback called right here
+		static IoRequestId read(const std::filesystem::path& path, const IoPriority priority,
+			Callback callback, void* user_data, JobCounter* counter = nullptr);
+		// queued read completes as Cancelled at once, read in flight when its current chunk arrives
+		// false when read has already completed
+		static bool cancel(const IoRequestId id);
+
+		static Backend get_backend();
+		static const char* get_backend_name(const Backend backend);
+		static Stats get_stats();
+	};
+}
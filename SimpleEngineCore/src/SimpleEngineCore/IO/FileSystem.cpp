@@ -0,0 +1,383 @@
+#include "FileSystem.h"
+#include "PackArchive.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	namespace {
+		struct Mount {
+			std::string point;	// "" or ends with '/'
+			std::filesystem::path directory;
+			std::shared_ptr<const PackArchive> archive;
+		};
+		struct MountState {
+			std::vector<Mount> mounts;
+			// virtual path of source asset -> virtual path of its cooked file, from mounted manifests
+			std::unordered_map<std::string, std::string> redirects;
+		};
+
+		// readers take the current state and search it without lock, mount replaces the whole state
+		std::mutex s_mounts_mutex;
+		std::shared_ptr<const MountState> s_mounts = std::make_shared<const MountState>();
+
+		struct Counters {
+			std::atomic<uint64_t> files_read{ 0 };
+			std::atomic<uint64_t> bytes_read{ 0 };
+			std::atomic<uint64_t> archive_reads{ 0 };
+			std::atomic<uint64_t> mapped_reads{ 0 };
+			std::atomic<uint64_t> failed_reads{ 0 };
+		};
+		Counters s_counters;
+
+		std::shared_ptr<const MountState> get_mounts()
+		{
+			std::lock_guard<std::mutex> lock(s_mounts_mutex);
+			return s_mounts;
+		}
+
+		void add_mount(Mount&& mount)
+		{
+			std::lock_guard<std::mutex> lock(s_mounts_mutex);
+			std::shared_ptr<MountState> state = std::make_shared<MountState>(*s_mounts);
+			state->mounts.push_back(std::move(mount));
+			s_mounts = std::move(state);
+		}
+
+		// manifest mounted later replaces redirects of the same paths
+		void add_redirects(std::unordered_map<std::string, std::string>&& redirects)
+		{
+			std::lock_guard<std::mutex> lock(s_mounts_mutex);
+			std::shared_ptr<MountState> state = std::make_shared<MountState>(*s_mounts);
+			for (auto& redirect : redirects) {
+				state->redirects[redirect.first] = std::move(redirect.second);
+			}
+			s_mounts = std::move(state);
+		}
+
+		std::string get_mount_point(const std::string& mount_point)
+		{
+			std::string point = FileSystem::get_virtual_path(mount_point);
+			if (point == ".") {
+				point.clear();
+			}
+			if (!point.empty() && point.back() != '/') {
+				point += '/';
+			}
+			return point;
+		}
+
+		bool read_disk(const std::filesystem::path& path, std::vector<uint8_t>& bytes)
+		{
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file.is_open()) {
+				return false;
+			}
+			const std::streamsize size = file.tellg();
+			if (size < 0) {
+				return false;
+			}
+			bytes.resize(static_cast<size_t>(size));
+			file.seekg(0);
+			return file.read(reinterpret_cast<char*>(bytes.data()), size).good() || size == 0;
+		}
+	}
+
+	// where file of one path is: archive entry or file on disk
+	struct FileSystem::Location {
+		std::shared_ptr<const PackArchive> archive;
+		const PackEntry* entry = nullptr;
+		std::filesystem::path disk_path;
+
+		bool find(const MountState& state, const std::filesystem::path& path) {
+			if (path.is_absolute()) {
+				disk_path = path;
+				return true;
+			}
+			const std::string virtual_path = get_virtual_path(path);
+			if (!state.redirects.empty()) {
+				// source is the fallback when cooked file is gone
+				const auto it = state.redirects.find(virtual_path);
+				if (it != state.redirects.end() && find_virtual(state.mounts, it->second)) {
+					return true;
+				}
+			}
+			return find_virtual(state.mounts, virtual_path);
+		}
+
+		bool find_virtual(const std::vector<Mount>& mounts, const std::string& virtual_path) {
+			for (auto it = mounts.rbegin(); it != mounts.rend(); ++it) {
+				if (virtual_path.compare(0, it->point.size(), it->point) != 0) {
+					continue;
+				}
+				const std::string_view relative = std::string_view(virtual_path).substr(it->point.size());
+				if (it->archive) {
+					entry = it->archive->find(relative);
+					if (entry) {
+						archive = it->archive;
+						return true;
+					}
+				}
+				else {
+					std::error_code error;
+					std::filesystem::path file_path = it->directory / relative;
+					if (std::filesystem::is_regular_file(file_path, error)) {
+						disk_path = std::move(file_path);
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+	};
+
+	FileData::FileData(FileData&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	FileData& FileData::operator=(FileData&& other) noexcept
+	{
+		if (this != &other) {
+			// moved vector keeps its buffer but that is not guaranteed, so pointer into it is taken again
+			const bool points_into_bytes = other.m_data == other.m_bytes.data();
+			m_bytes = std::move(other.m_bytes);
+			m_owner = std::move(other.m_owner);
+			m_data = points_into_bytes ? m_bytes.data() : other.m_data;
+			m_size = other.m_size;
+			other.m_data = nullptr;
+			other.m_size = 0;
+			other.m_bytes.clear();
+		}
+		return *this;
+	}
+
+	void FileData::reset()
+	{
+		m_data = nullptr;
+		m_size = 0;
+		m_bytes.clear();
+		m_owner.reset();
+	}
+
+	void FileData::assign(std::vector<uint8_t>&& bytes)
+	{
+		m_owner.reset();
+		m_bytes = std::move(bytes);
+		m_data = m_bytes.data();
+		m_size = m_bytes.size();
+	}
+
+	void FileData::assign_view(const uint8_t* data, const size_t size, std::shared_ptr<const void> owner)
+	{
+		m_bytes.clear();
+		m_data = data;
+		m_size = size;
+		m_owner = std::move(owner);
+	}
+
+	bool FileSystem::mount_directory(const std::string& mount_point, const std::filesystem::path& directory)
+	{
+		std::error_code error;
+		if (!std::filesystem::is_directory(directory, error)) {
+			LOG_ERROR_TO(Assets, "Failed to mount {0}: not a directory", directory.string());
+			return false;
+		}
+		Mount mount;
+		mount.point = get_mount_point(mount_point);
+		mount.directory = directory;
+		LOG_INFO_TO(Assets, "Mounted directory {0} at '{1}'", directory.string(), mount.point);
+		add_mount(std::move(mount));
+		return true;
+	}
+
+	bool FileSystem::mount_archive(const std::string& mount_point, const std::filesystem::path& archive_path)
+	{
+		std::shared_ptr<PackArchive> archive = std::make_shared<PackArchive>();
+		if (!archive->open(archive_path)) {
+			return false;
+		}
+		Mount mount;
+		mount.point = get_mount_point(mount_point);
+		mount.archive = std::move(archive);
+		LOG_INFO_TO(Assets, "Mounted archive {0} at '{1}': {2} files", archive_path.string(), mount.point,
+			mount.archive->get_entries_count());
+		add_mount(std::move(mount));
+		return true;
+	}
+
+	bool FileSystem::mount_manifest(const std::filesystem::path& manifest_path)
+	{
+		std::string text;
+		if (!read_text(manifest_path, text)) {
+			LOG_ERROR_TO(Assets, "Failed to mount manifest {0}: no such file", manifest_path.string());
+			return false;
+		}
+		// cooked paths are relative to manifest
+		std::string directory = std::filesystem::path(get_virtual_path(manifest_path)).parent_path().generic_string();
+		if (!directory.empty()) {
+			directory += '/';
+		}
+		std::unordered_map<std::string, std::string> redirects;
+		size_t begin = 0;
+		while (begin < text.size()) {
+			size_t end = text.find('\n', begin);
+			if (end == std::string::npos) {
+				end = text.size();
+			}
+			const std::string_view line = std::string_view(text).substr(begin, end - begin);
+			begin = end + 1;
+			const size_t tab = line.find('\t');
+			if (line.empty() || line[0] == '#' || tab == std::string_view::npos) {
+				continue;
+			}
+			redirects[get_virtual_path(std::string(line.substr(0, tab)))] = directory + std::string(line.substr(tab + 1));
+		}
+		LOG_INFO_TO(Assets, "Mounted manifest {0}: {1} cooked files", manifest_path.string(), redirects.size());
+		add_redirects(std::move(redirects));
+		return true;
+	}
+
+	void FileSystem::unmount_all()
+	{
+		std::lock_guard<std::mutex> lock(s_mounts_mutex);
+		s_mounts = std::make_shared<const MountState>();
+	}
+
+	bool FileSystem::exists(const std::filesystem::path& path)
+	{
+		Location location;
+		if (!location.find(*get_mounts(), path)) {
+			return false;
+		}
+		std::error_code error;
+		return location.entry || std::filesystem::is_regular_file(location.disk_path, error);
+	}
+
+	bool FileSystem::read_location(const Location& location, FileData& data)
+	{
+		data.reset();
+		bool read = false;
+		if (location.entry) {
+			s_counters.archive_reads.fetch_add(1, std::memory_order_relaxed);
+			// whole entry is read in one request instead of a page fault at a time
+			location.archive->prefetch(*location.entry);
+			if (const uint8_t* stored = location.archive->get_stored_data(*location.entry)) {
+				data.m_data = stored;
+				data.m_size = static_cast<size_t>(location.entry->size);
+				data.m_owner = location.archive;
+				s_counters.mapped_reads.fetch_add(1, std::memory_order_relaxed);
+				read = true;
+			}
+			else {
+				read = location.archive->decompress(*location.entry, data.m_bytes);
+			}
+		}
+		else {
+			read = read_disk(location.disk_path, data.m_bytes);
+		}
+		if (!read) {
+			data.reset();
+			s_counters.failed_reads.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		if (data.is_owned()) {
+			data.m_data = data.m_bytes.data();
+			data.m_size = data.m_bytes.size();
+		}
+		s_counters.files_read.fetch_add(1, std::memory_order_relaxed);
+		s_counters.bytes_read.fetch_add(data.m_size, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool FileSystem::read(const std::filesystem::path& path, FileData& data)
+	{
+		Location location;
+		if (!location.find(*get_mounts(), path)) {
+			data.reset();
+			s_counters.failed_reads.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		return read_location(location, data);
+	}
+
+	bool FileSystem::read_text(const std::filesystem::path& path, std::string& text)
+	{
+		FileData data;
+		if (!read(path, data)) {
+			text.clear();
+			return false;
+		}
+		text.assign(reinterpret_cast<const char*>(data.data()), data.size());
+		return true;
+	}
+
+	size_t FileSystem::read_batch(const std::filesystem::path* paths, FileData* data, const size_t count)
+	{
+		const std::shared_ptr<const MountState> mounts = get_mounts();
+		std::vector<Location> locations(count);
+		std::vector<size_t> packed;
+		for (size_t i = 0; i < count; ++i) {
+			if (locations[i].find(*mounts, paths[i]) && locations[i].entry) {
+				packed.push_back(i);
+			}
+		}
+		// in archive order, so the disk gets requests for all pages before the first one is touched
+		std::sort(packed.begin(), packed.end(), [&locations](const size_t a, const size_t b) {
+			const Location& la = locations[a];
+			const Location& lb = locations[b];
+			return la.archive != lb.archive ? la.archive < lb.archive : la.entry->offset < lb.entry->offset;
+		});
+		for (const size_t i : packed) {
+			locations[i].archive->prefetch(*locations[i].entry);
+		}
+
+		std::atomic<size_t> read_count{ 0 };
+		JobSystem::parallel_for(count, JobSystem::get_batch_size(count, 1), [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const bool found = locations[i].entry || !locations[i].disk_path.empty();
+				if (found && read_location(locations[i], data[i])) {
+					read_count.fetch_add(1, std::memory_order_relaxed);
+				}
+				else if (!found) {
+					data[i].reset();
+					s_counters.failed_reads.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+		return read_count.load(std::memory_order_relaxed);
+	}
+
+	std::filesystem::path FileSystem::get_disk_path(const std::filesystem::path& path)
+	{
+		Location location;
+		if (!location.find(*get_mounts(), path)) {
+			return std::filesystem::path();
+		}
+		return location.disk_path;
+	}
+
+	std::string FileSystem::get_virtual_path(const std::filesystem::path& path)
+	{
+		return path.lexically_normal().generic_string();
+	}
+
+	FileSystem::Stats FileSystem::get_stats()
+	{
+		Stats stats;
+		stats.files_read = s_counters.files_read.load(std::memory_order_relaxed);
+		stats.bytes_read = s_counters.bytes_read.load(std::memory_order_relaxed);
+		stats.archive_reads = s_counters.archive_reads.load(std::memory_order_relaxed);
+		stats.mapped_reads = s_counters.mapped_reads.load(std::memory_order_relaxed);
+		stats.failed_reads = s_counters.failed_reads.load(std::memory_order_relaxed);
+		return stats;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// bytes of one file: a view of uncompressed archive entry or of I/O buffer, or own copy
+	// view keeps what it points into alive, so it is valid after unmount too
+	class FileData {
+	public:
+		FileData() = default;
+		// m_data points into m_bytes when bytes are owned, copy would point into the source
+		FileData(const FileData&) = delete;
+		FileData& operator=(const FileData&) = delete;
+		FileData(FileData&& other) noexcept;
+		FileData& operator=(FileData&& other) noexcept;
+
+		const uint8_t* data() const { return m_data; }
+		size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		// false when bytes are a view
+		bool is_owned() const { return !m_owner; }
+		void reset();
+
+		// for readers outside of FileSystem
+		void assign(std::vector<uint8_t>&& bytes);
+		void assign_view(const uint8_t* data, const size_t size, std::shared_ptr<const void> owner);
+
+	private:
+		friend class FileSystem;
+
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+		std::vector<uint8_t> m_bytes;
+		std::shared_ptr<const void> m_owner;
+	};
+
+	// virtual paths are relative with '/' separators, mounted later is searched first
+	// so archive mounted over directory gives packed files and directory gives the rest
+	// absolute paths are read from disk as they are
+	// reads are from any thread, mounts are changed while nothing is loading
+	class FileSystem {
+	public:
+		struct Stats {
+			uint64_t files_read = 0;
+			uint64_t bytes_read = 0;		// after decompression
+			uint64_t archive_reads = 0;
+			uint64_t mapped_reads = 0;		// archive entries given without copy
+			uint64_t failed_reads = 0;
+		};
+
+		// mount point is a prefix of virtual paths, "" mounts root
+		static bool mount_directory(const std::string& mount_point, const std::filesystem::path& directory);
+		static bool mount_archive(const std::string& mount_point, const std::filesystem::path& archive_path);
+		// lines of "source path<tab>cooked path" written by AssetCooker, after it source paths give cooked files
+		// manifest is read through mounts, so it may be packed with cooked files
+		static bool mount_manifest(const std::filesystem::path& manifest_path);
+		static void unmount_all();
+
+		static bool exists(const std::filesystem::path& path);
+		static bool read(const std::filesystem::path& path, FileData& data);
+		// shader sources, always a copy
+		static bool read_text(const std::filesystem::path& path, std::string& text);
+		// archive entries of all paths are prefetched together, then read and decompressed in parallel
+		// returns count of files which were read
+		static size_t read_batch(const std::filesystem::path* paths, FileData* data, const size_t count);
+
+		// file on disk which the path gives, empty when it is an archive entry or there is no such file
+		static std::filesystem::path get_disk_path(const std::filesystem::path& path);
+
+		// normalized virtual path, the same file by any relative path gives the same one
+		static std::string get_virtual_path(const std::filesystem::path& path);
+
+		static Stats get_stats();
+
+	private:
+		struct Location;
+		static bool read_location(const Location& location, FileData& data);
+	};
+}
@@ -0,0 +1,242 @@
+#include "IoUring.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#endif
+
+namespace SimpleEngine {
+
+#ifdef __linux__
+	namespace {
+		int io_uring_setup(const uint32_t entries, io_uring_params* params)
+		{
+			return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+		}
+
+		int io_uring_enter(const int fd, const uint32_t to_submit, const uint32_t min_complete, const uint32_t flags)
+		{
+			return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+		}
+
+		int io_uring_register(const int fd, const uint32_t opcode, const void* arg, const uint32_t count)
+		{
+			return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+		}
+
+		uint32_t load_acquire(const uint32_t* p)
+		{
+			return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+		}
+
+		void store_release(uint32_t* p, const uint32_t value)
+		{
+			__atomic_store_n(p, value, __ATOMIC_RELEASE);
+		}
+
+		void* map_ring(const int fd, const size_t size, const off_t offset)
+		{
+			void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+			return ring == MAP_FAILED ? nullptr : ring;
+		}
+
+		// IORING_OP_READ is from 5.6, older kernels only had readv
+		bool is_read_supported(const int fd)
+		{
+			constexpr uint32_t ops_count = 256;
+			std::vector<uint8_t> memory(sizeof(io_uring_probe) + ops_count * sizeof(io_uring_probe_op));
+			io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+			if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, ops_count) < 0) {
+				return false;
+			}
+			return probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+		}
+	}
+#endif
+
+	IoUring::~IoUring()
+	{
+		close();
+	}
+
+	bool IoUring::init(const uint32_t entries)
+	{
+		close();
+#ifdef __linux__
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		const int fd = io_uring_setup(entries, &params);
+		if (fd < 0) {
+			return false;
+		}
+		m_fd = fd;
+		if (!is_read_supported(fd)) {
+			close();
+			return false;
+		}
+
+		m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		// since 5.4 both rings are one mapping
+		const bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single_map) {
+			m_sq_ring_size = m_cq_ring_size = m_sq_ring_size > m_cq_ring_size ? m_sq_ring_size : m_cq_ring_size;
+		}
+		m_sq_ring = map_ring(fd, m_sq_ring_size, IORING_OFF_SQ_RING);
+		m_cq_ring = single_map ? m_sq_ring : map_ring(fd, m_cq_ring_size, IORING_OFF_CQ_RING);
+		m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqes = map_ring(fd, m_sqes_size, IORING_OFF_SQES);
+		if (!m_sq_ring || !m_cq_ring || !m_sqes) {
+			close();
+			return false;
+		}
+
+		uint8_t* sq = static_cast<uint8_t*>(m_sq_ring);
+		m_sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+		m_sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+		m_sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+		m_sq_entries = params.sq_entries;
+		// slot i of the ring always points to sqe i, sqes are used in ring order
+		uint32_t* sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+		for (uint32_t i = 0; i < m_sq_entries; ++i) {
+			sq_array[i] = i;
+		}
+		m_sq_local_tail = *m_sq_tail;
+
+		uint8_t* cq = static_cast<uint8_t*>(m_cq_ring);
+		m_cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+		m_cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+		m_cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+		m_cqes = cq + params.cq_off.cqes;
+		return true;
+#else
+		(void)entries;
+		return false;
+#endif
+	}
+
+	void IoUring::close()
+	{
+#ifdef __linux__
+		if (m_sqes) {
+			munmap(m_sqes, m_sqes_size);
+		}
+		if (m_cq_ring && m_cq_ring != m_sq_ring) {
+			munmap(m_cq_ring, m_cq_ring_size);
+		}
+		if (m_sq_ring) {
+			munmap(m_sq_ring, m_sq_ring_size);
+		}
+		if (m_fd >= 0) {
+			// registered buffers are unregistered with ring
+			::close(m_fd);
+		}
+#endif
+		m_fd = -1;
+		m_sq_ring = nullptr;
+		m_cq_ring = nullptr;
+		m_sqes = nullptr;
+		m_sq_head = m_sq_tail = m_cq_head = m_cq_tail = nullptr;
+		m_cqes = nullptr;
+		m_sq_entries = 0;
+		m_sq_local_tail = 0;
+	}
+
+	bool IoUring::register_buffers(uint8_t* const* buffers, const size_t buffer_size, const uint32_t count)
+	{
+#ifdef __linux__
+		if (m_fd < 0 || count == 0) {
+			return false;
+		}
+		std::vector<iovec> vectors(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			vectors[i].iov_base = buffers[i];
+			vectors[i].iov_len = buffer_size;
+		}
+		// fails when pinned memory is above RLIMIT_MEMLOCK on older kernels, reads still work without it
+		return io_uring_register(m_fd, IORING_REGISTER_BUFFERS, vectors.data(), count) == 0;
+#else
+		(void)buffers;
+		(void)buffer_size;
+		(void)count;
+		return false;
+#endif
+	}
+
+	bool IoUring::prepare_read(const int fd, void* buffer, const uint32_t size, const uint64_t offset,
+		const uint64_t user_data, const int buffer_index)
+	{
+#ifdef __linux__
+		if (m_fd < 0 || m_sq_local_tail - load_acquire(m_sq_head) >= m_sq_entries) {
+			return false;
+		}
+		io_uring_sqe* sqe = static_cast<io_uring_sqe*>(m_sqes) + (m_sq_local_tail & m_sq_mask);
+		std::memset(sqe, 0, sizeof(*sqe));
+		sqe->opcode = buffer_index >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+		sqe->fd = fd;
+		sqe->addr = reinterpret_cast<uint64_t>(buffer);
+		sqe->len = size;
+		sqe->off = offset;
+		sqe->user_data = user_data;
+		sqe->buf_index = static_cast<uint16_t>(buffer_index >= 0 ? buffer_index : 0);
+		++m_sq_local_tail;
+		return true;
+#else
+		(void)fd;
+		(void)buffer;
+		(void)size;
+		(void)offset;
+		(void)user_data;
+		(void)buffer_index;
+		return false;
+#endif
+	}
+
+	int IoUring::submit(const uint32_t wait_count)
+	{
+#ifdef __linux__
+		if (m_fd < 0) {
+			return -EBADF;
+		}
+		store_release(m_sq_tail, m_sq_local_tail);
+		const uint32_t to_submit = m_sq_local_tail - load_acquire(m_sq_head);
+		const uint32_t flags = wait_count > 0 ? IORING_ENTER_GETEVENTS : 0;
+		int result = 0;
+		do {
+			result = io_uring_enter(m_fd, to_submit, wait_count, flags);
+		} while (result < 0 && errno == EINTR);
+		return result < 0 ? -errno : result;
+#else
+		(void)wait_count;
+		return -1;
+#endif
+	}
+
+	bool IoUring::pop_completion(Completion& completion)
+	{
+#ifdef __linux__
+		if (m_fd < 0) {
+			return false;
+		}
+		const uint32_t head = *m_cq_head;
+		if (head == load_acquire(m_cq_tail)) {
+			return false;
+		}
+		const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(m_cqes)[head & m_cq_mask];
+		completion.user_data = cqe.user_data;
+		completion.result = cqe.res;
+		store_release(m_cq_head, head + 1);
+		return true;
+#else
+		(void)completion;
+		return false;
+#endif
+	}
+}
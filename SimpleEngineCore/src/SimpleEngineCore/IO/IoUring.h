@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// one io_uring set up by raw syscalls, without liburing, init fails on kernels before 5.1 and on other systems
+	// owned by one thread: reads are prepared, sent to kernel together by one syscall, then completions are popped
+	class IoUring {
+	public:
+		struct Completion {
+			uint64_t user_data = 0;
+			int32_t result = 0;		// bytes read or -errno
+		};
+
+		IoUring() = default;
+		~IoUring();
+
+		IoUring(const IoUring&) = delete;
+		IoUring& operator=(const IoUring&) = delete;
+
+		// false when kernel has no io_uring or it is not allowed (seccomp, sysctl)
+		bool init(const uint32_t entries);
+		void close();
+		bool is_open() const { return m_fd >= 0; }
+		uint32_t get_entries() const { return m_sq_entries; }
+
+		// pinned once, so reads into them don't map user pages every time
+		bool register_buffers(uint8_t* const* buffers, const size_t buffer_size, const uint32_t count);
+
+		// buffer_index of registered buffer or -1, false when submission queue is full
+		bool prepare_read(const int fd, void* buffer, const uint32_t size, const uint64_t offset,
+			const uint64_t user_data, const int buffer_index = -1);
+		// sends prepared reads and waits until at least wait_count completions are there
+		// returns count of sent reads or -errno
+		int submit(const uint32_t wait_count);
+		// false when there is no completion
+		bool pop_completion(Completion& completion);
+
+	private:
+		int m_fd = -1;
+
+		// rings are shared with kernel, head and tail are written by the other side
+		void* m_sq_ring = nullptr;
+		size_t m_sq_ring_size = 0;
+		void* m_cq_ring = nullptr;
+		size_t m_cq_ring_size = 0;
+		void* m_sqes = nullptr;
+		size_t m_sqes_size = 0;
+
+		uint32_t* m_sq_head = nullptr;
+		uint32_t* m_sq_tail = nullptr;
+		uint32_t m_sq_mask = 0;
+		uint32_t m_sq_entries = 0;
+		uint32_t* m_cq_head = nullptr;
+		uint32_t* m_cq_tail = nullptr;
+		uint32_t m_cq_mask = 0;
+		void* m_cqes = nullptr;
+
+		uint32_t m_sq_local_tail = 0;	// prepared, kernel sees them after submit
+	};
+}
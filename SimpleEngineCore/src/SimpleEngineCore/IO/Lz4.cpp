@@ -0,0 +1,193 @@
+#include "Lz4.h"
+
+#include <cstring>
+#include <memory>
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr size_t s_min_match = 4;
+		// format rules: the last 5 bytes are literals and the last match starts 12 bytes before the end
+		constexpr size_t s_last_literals = 5;
+		constexpr size_t s_match_limit = 12;
+		constexpr size_t s_max_offset = 65535;
+		constexpr uint32_t s_hash_bits = 16;
+
+		uint32_t read32(const uint8_t* p)
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint32_t hash4(const uint32_t value)
+		{
+			return (value * 2654435761u) >> (32 - s_hash_bits);
+		}
+
+		size_t get_length_bytes(const size_t length)
+		{
+			return length >= 15 ? (length - 15) / 255 + 1 : 0;
+		}
+
+		uint8_t* write_length(uint8_t* out, size_t length)
+		{
+			for (length -= 15; length >= 255; length -= 255) {
+				*out++ = 255;
+			}
+			*out++ = static_cast<uint8_t>(length);
+			return out;
+		}
+
+		// literals and then match, match_length 0 is the last sequence without match
+		bool write_sequence(const uint8_t* literals, const size_t literals_length, const size_t offset,
+			const size_t match_length, uint8_t*& out, const uint8_t* out_end)
+		{
+			const size_t match_code = match_length > 0 ? match_length - s_min_match : 0;
+			const size_t needed = 1 + get_length_bytes(literals_length) + literals_length
+				+ (match_length > 0 ? 2 + get_length_bytes(match_code) : 0);
+			if (needed > static_cast<size_t>(out_end - out)) {
+				return false;
+			}
+			uint8_t* token = out++;
+			*token = static_cast<uint8_t>((literals_length >= 15 ? 15 : literals_length) << 4);
+			if (literals_length >= 15) {
+				out = write_length(out, literals_length);
+			}
+			if (literals_length > 0) {
+				std::memcpy(out, literals, literals_length);
+				out += literals_length;
+			}
+			if (match_length > 0) {
+				*out++ = static_cast<uint8_t>(offset & 0xff);
+				*out++ = static_cast<uint8_t>(offset >> 8);
+				*token |= static_cast<uint8_t>(match_code >= 15 ? 15 : match_code);
+				if (match_code >= 15) {
+					out = write_length(out, match_code);
+				}
+			}
+			return true;
+		}
+
+		// false when length bytes run out of input
+		bool read_length(const uint8_t* src, const size_t size, size_t& ip, size_t& length)
+		{
+			uint8_t byte = 0;
+			do {
+				if (ip >= size) {
+					return false;
+				}
+				byte = src[ip++];
+				length += byte;
+			} while (byte == 255);
+			return true;
+		}
+	}
+
+	size_t lz4_get_compress_bound(const size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	size_t lz4_compress(const uint8_t* src, const size_t size, uint8_t* dst, const size_t capacity)
+	{
+		uint8_t* out = dst;
+		const uint8_t* out_end = dst + capacity;
+		size_t anchor = 0;
+		if (size > s_match_limit) {
+			// positions of the last 4 bytes with the same hash, 0 is also a valid position, bytes are compared anyway
+			std::unique_ptr<uint32_t[]> table(new uint32_t[size_t(1) << s_hash_bits]());
+			const size_t match_start_limit = size - s_match_limit;
+			const size_t match_end_limit = size - s_last_literals;
+			size_t ip = 1;
+			while (ip <= match_start_limit) {
+				const uint32_t sequence = read32(src + ip);
+				const uint32_t hash = hash4(sequence);
+				const size_t ref = table[hash];
+				table[hash] = static_cast<uint32_t>(ip);
+				if (ip - ref > s_max_offset || read32(src + ref) != sequence) {
+					++ip;
+					continue;
+				}
+				size_t match_length = s_min_match;
+				while (ip + match_length < match_end_limit && src[ref + match_length] == src[ip + match_length]) {
+					++match_length;
+				}
+				if (!write_sequence(src + anchor, ip - anchor, ip - ref, match_length, out, out_end)) {
+					return 0;
+				}
+				ip += match_length;
+				anchor = ip;
+			}
+		}
+		if (!write_sequence(src + anchor, size - anchor, 0, 0, out, out_end)) {
+			return 0;
+		}
+		return static_cast<size_t>(out - dst);
+	}
+
+	bool lz4_decompress(const uint8_t* src, const size_t size, uint8_t* dst, const size_t dst_size)
+	{
+		size_t ip = 0;
+		size_t op = 0;
+		while (ip < size) {
+			const uint8_t token = src[ip++];
+			size_t literals_length = token >> 4;
+			if (literals_length == 15 && !read_length(src, size, ip, literals_length)) {
+				return false;
+			}
+			if (literals_length > size - ip || literals_length > dst_size - op) {
+				return false;
+			}
+			// short literals are copied as fixed 16 bytes when both buffers have room,
+			// the extra bytes are written over by the next sequence
+			if (literals_length <= 16 && size - ip >= 16 && dst_size - op >= 16) {
+				std::memcpy(dst + op, src + ip, 16);
+			}
+			else if (literals_length > 0) {
+				std::memcpy(dst + op, src + ip, literals_length);
+			}
+			ip += literals_length;
+			op += literals_length;
+			if (ip == size) {
+				// the last sequence has no match
+				return op == dst_size;
+			}
+
+			if (size - ip < 2) {
+				return false;
+			}
+			const size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+			ip += 2;
+			if (offset == 0 || offset > op) {
+				return false;
+			}
+			size_t match_length = token & 15;
+			if (match_length == 15 && !read_length(src, size, ip, match_length)) {
+				return false;
+			}
+			match_length += s_min_match;
+			if (match_length > dst_size - op) {
+				return false;
+			}
+			// 8 byte blocks never read bytes they write when offset is 8 or more
+			if (offset >= 8 && dst_size - op >= match_length + 8) {
+				for (size_t done = 0; done < match_length; done += 8) {
+					std::memcpy(dst + op + done, dst + op + done - offset, 8);
+				}
+				op += match_length;
+				continue;
+			}
+			// match can overlap bytes it writes, then it repeats the last offset bytes
+			// and already written repeats are copied as one block, twice as long each time
+			for (size_t done = 0; done < match_length;) {
+				const size_t step = (done / offset + 1) * offset;
+				const size_t length = step < match_length - done ? step : match_length - done;
+				std::memcpy(dst + op + done, dst + op + done - step, length);
+				done += length;
+			}
+			op += match_length;
+		}
+		return size == 0 && dst_size == 0;
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// LZ4 block format (no frame header), blocks decode with the reference decoder too
+	// compression is greedy with one hash table, made for packing archives offline
+
+	// worst case size of compressed block
+	size_t lz4_get_compress_bound(const size_t size);
+	// 0 when output doesn't fit into capacity
+	size_t lz4_compress(const uint8_t* src, const size_t size, uint8_t* dst, const size_t capacity);
+	// false when block is damaged or doesn't decode to exactly dst_size bytes
+	bool lz4_decompress(const uint8_t* src, const size_t size, uint8_t* dst, const size_t dst_size);
+}
@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleEngine {
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: m_data(std::exchange(other.m_data, nullptr))
+		, m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+		, m_file(std::exchange(other.m_file, nullptr))
+		, m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+	{
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other) {
+			close();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+			m_file = std::exchange(other.m_file, nullptr);
+			m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+	bool MappedFile::open(const std::filesystem::path& path)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		m_file = file;
+		m_mapping = mapping;
+		m_data = static_cast<const uint8_t*>(data);
+		m_size = static_cast<size_t>(size.QuadPart);
+#else
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+			::close(fd);
+			return false;
+		}
+		void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		// mapping keeps its own reference of file
+		::close(fd);
+		if (data == MAP_FAILED) {
+			return false;
+		}
+		m_data = static_cast<const uint8_t*>(data);
+		m_size = static_cast<size_t>(info.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (!m_data) {
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		m_file = nullptr;
+		m_mapping = nullptr;
+#else
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	void MappedFile::prefetch(const size_t offset, const size_t size) const
+	{
+		if (!m_data || offset >= m_size || size == 0) {
+			return;
+		}
+		const size_t length = size < m_size - offset ? size : m_size - offset;
+#ifdef _WIN32
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<uint8_t*>(m_data + offset);
+		range.NumberOfBytes = length;
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		// madvise needs page aligned address
+		const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		const size_t begin = offset & ~(page_size - 1);
+		madvise(const_cast<uint8_t*>(m_data + begin), length + (offset - begin), MADV_WILLNEED);
+#endif
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace SimpleEngine {
+
+	// whole file mapped read-only, pages are read by the OS on first access and shared with its file cache
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// false when file can't be opened, empty file is not mapped
+		bool open(const std::filesystem::path& path);
+		void close();
+
+		// hint to read range ahead, pages arrive in the background
+		void prefetch(const size_t offset, const size_t size) const;
+
+		bool is_open() const { return m_data != nullptr; }
+		const uint8_t* get_data() const { return m_data; }
+		size_t get_size() const { return m_size; }
+
+	private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+}
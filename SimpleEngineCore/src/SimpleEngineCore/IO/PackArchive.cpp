@@ -0,0 +1,229 @@
+#include "PackArchive.h"
+#include "Lz4.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace SimpleEngine {
+
+	namespace {
+		uint64_t align_up(const uint64_t value)
+		{
+			return (value + s_pack_alignment - 1) & ~(s_pack_alignment - 1);
+		}
+
+		bool read_source(const std::filesystem::path& path, std::vector<uint8_t>& bytes)
+		{
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file.is_open()) {
+				return false;
+			}
+			const std::streamsize size = file.tellg();
+			if (size < 0) {
+				return false;
+			}
+			bytes.resize(static_cast<size_t>(size));
+			file.seekg(0);
+			return file.read(reinterpret_cast<char*>(bytes.data()), size).good() || size == 0;
+		}
+	}
+
+	bool PackArchive::open(const std::filesystem::path& path)
+	{
+		m_path = path;
+		if (!m_file.open(path)) {
+			LOG_ERROR_TO(Assets, "Failed to open archive {0}", path.string());
+			return false;
+		}
+		const uint8_t* data = m_file.get_data();
+		const size_t size = m_file.get_size();
+		PackHeader header;
+		if (size < sizeof(header)) {
+			LOG_ERROR_TO(Assets, "Archive {0} is too small", path.string());
+			m_file.close();
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (header.magic != PackHeader::s_magic || header.version != PackHeader::s_version) {
+			LOG_ERROR_TO(Assets, "Archive {0} has unknown format or version {1}", path.string(), header.version);
+			m_file.close();
+			return false;
+		}
+		const uint64_t names_begin = sizeof(header) + uint64_t(header.entries_count) * sizeof(PackEntry);
+		if (names_begin + header.names_size > size) {
+			LOG_ERROR_TO(Assets, "Archive {0} has table of contents out of file", path.string());
+			m_file.close();
+			return false;
+		}
+		m_entries = reinterpret_cast<const PackEntry*>(data + sizeof(header));
+		m_entries_count = header.entries_count;
+		m_names = reinterpret_cast<const char*>(data + names_begin);
+
+		// checked once here, so lookups and reads trust entries
+		for (size_t i = 0; i < m_entries_count; ++i) {
+			const PackEntry& entry = m_entries[i];
+			const bool valid = uint64_t(entry.name_offset) + entry.name_length <= header.names_size
+				&& entry.offset <= size && entry.stored_size <= size - entry.offset
+				&& (entry.compression == PackCompression::Lz4
+					|| (entry.compression == PackCompression::None && entry.stored_size == entry.size))
+				&& (i == 0 || get_name(m_entries[i - 1]) < get_name(entry));
+			if (!valid) {
+				LOG_ERROR_TO(Assets, "Archive {0} has damaged entry {1}", path.string(), i);
+				m_entries = nullptr;
+				m_entries_count = 0;
+				m_names = nullptr;
+				m_file.close();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const PackEntry* PackArchive::find(const std::string_view name) const
+	{
+		const PackEntry* end = m_entries + m_entries_count;
+		const PackEntry* it = std::lower_bound(m_entries, end, name,
+			[this](const PackEntry& entry, const std::string_view value) { return get_name(entry) < value; });
+		return it != end && get_name(*it) == name ? it : nullptr;
+	}
+
+	std::string_view PackArchive::get_name(const PackEntry& entry) const
+	{
+		return std::string_view(m_names + entry.name_offset, entry.name_length);
+	}
+
+	const uint8_t* PackArchive::get_stored_data(const PackEntry& entry) const
+	{
+		return entry.compression == PackCompression::None ? m_file.get_data() + entry.offset : nullptr;
+	}
+
+	bool PackArchive::decompress(const PackEntry& entry, std::vector<uint8_t>& bytes) const
+	{
+		const uint8_t* stored = m_file.get_data() + entry.offset;
+		const size_t stored_size = static_cast<size_t>(entry.stored_size);
+		bytes.resize(static_cast<size_t>(entry.size));
+		switch (entry.compression) {
+		case PackCompression::None:
+			std::copy(stored, stored + stored_size, bytes.begin());
+			return true;
+		case PackCompression::Lz4:
+			if (lz4_decompress(stored, stored_size, bytes.data(), bytes.size())) {
+				return true;
+			}
+			break;
+		default:
+			break;
+		}
+		LOG_ERROR_TO(Assets, "Archive {0}: entry {1} is damaged", m_path.string(), get_name(entry));
+		bytes.clear();
+		return false;
+	}
+
+	void PackArchive::prefetch(const PackEntry& entry) const
+	{
+		m_file.prefetch(static_cast<size_t>(entry.offset), static_cast<size_t>(entry.stored_size));
+	}
+
+	bool PackArchive::build(const std::filesystem::path& root, const std::vector<std::filesystem::path>& directories,
+		const std::filesystem::path& output, const BuildSettings& settings, BuildStats* stats)
+	{
+		std::vector<std::string> names;
+		std::error_code error;
+		// archive may be written into one of packed directories
+		const std::filesystem::path output_path = std::filesystem::weakly_canonical(output, error);
+		for (const std::filesystem::path& directory : directories) {
+			for (std::filesystem::recursive_directory_iterator it(root / directory, error), end; !error && it != end; it.increment(error)) {
+				if (it->is_regular_file(error) && std::filesystem::weakly_canonical(it->path(), error) != output_path) {
+					names.push_back(it->path().lexically_relative(root).generic_string());
+				}
+			}
+			if (error) {
+				LOG_ERROR_TO(Assets, "Failed to list {0}: {1}", (root / directory).string(), error.message());
+				return false;
+			}
+		}
+		std::sort(names.begin(), names.end());
+		names.erase(std::unique(names.begin(), names.end()), names.end());
+
+		PackHeader header;
+		header.entries_count = static_cast<uint32_t>(names.size());
+		std::vector<PackEntry> entries(names.size());
+		std::string names_block;
+		for (size_t i = 0; i < names.size(); ++i) {
+			entries[i].name_offset = static_cast<uint32_t>(names_block.size());
+			entries[i].name_length = static_cast<uint32_t>(names[i].size());
+			names_block += names[i];
+		}
+		header.names_size = static_cast<uint32_t>(names_block.size());
+
+		std::ofstream file(output, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			LOG_ERROR_TO(Assets, "Failed to create archive {0}", output.string());
+			return false;
+		}
+		// table of contents is written last, when offsets and sizes are known
+		const uint64_t toc_size = sizeof(header) + entries.size() * sizeof(PackEntry) + names_block.size();
+		uint64_t offset = align_up(toc_size);
+
+		BuildStats build_stats;
+		std::vector<uint8_t> bytes;
+		std::vector<uint8_t> compressed;
+		for (size_t i = 0; i < names.size(); ++i) {
+			if (!read_source(root / names[i], bytes)) {
+				LOG_ERROR_TO(Assets, "Failed to read {0}", (root / names[i]).string());
+				return false;
+			}
+			PackEntry& entry = entries[i];
+			entry.offset = offset;
+			entry.size = bytes.size();
+			entry.stored_size = bytes.size();
+			const uint8_t* stored = bytes.data();
+			// compressor hash table keeps 32 bit positions
+			if (settings.compression == PackCompression::Lz4 && !bytes.empty()
+				&& bytes.size() <= std::numeric_limits<uint32_t>::max()) {
+				compressed.resize(lz4_get_compress_bound(bytes.size()));
+				const size_t capacity = static_cast<size_t>(bytes.size() * (1.f - settings.min_saving));
+				const size_t compressed_size = lz4_compress(bytes.data(), bytes.size(), compressed.data(), capacity);
+				if (compressed_size > 0) {
+					entry.compression = PackCompression::Lz4;
+					entry.stored_size = compressed_size;
+					stored = compressed.data();
+					++build_stats.compressed_files;
+				}
+			}
+			file.seekp(static_cast<std::streamoff>(offset));
+			file.write(reinterpret_cast<const char*>(stored), static_cast<std::streamsize>(entry.stored_size));
+			offset = align_up(offset + entry.stored_size);
+			build_stats.bytes += entry.size;
+		}
+		// file ends at aligned size too, so the last entry can be read by whole sectors
+		const uint64_t written = entries.empty() ? toc_size : entries.back().offset + entries.back().stored_size;
+		if (offset > written) {
+			const char zero = 0;
+			file.seekp(static_cast<std::streamoff>(offset - 1));
+			file.write(&zero, 1);
+		}
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(PackEntry)));
+		file.write(names_block.data(), static_cast<std::streamsize>(names_block.size()));
+		file.close();
+		if (!file) {
+			LOG_ERROR_TO(Assets, "Failed to write archive {0}", output.string());
+			return false;
+		}
+
+		build_stats.files = names.size();
+		build_stats.archive_bytes = offset;
+		LOG_INFO_TO(Assets, "Archive {0}: {1} files, {2} compressed, {3} -> {4} bytes", output.string(),
+			build_stats.files, build_stats.compressed_files, build_stats.bytes, build_stats.archive_bytes);
+		if (stats) {
+			*stats = build_stats;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SimpleEngine {
+
+	enum class PackCompression : uint32_t {
+		None,	// entry is read straight from mapped archive
+		Lz4
+	};
+
+	// little-endian file layout: header, entries sorted by name, names, then data of every entry at aligned offset
+	struct PackHeader {
+		static constexpr uint32_t s_magic = 0x4b504553;	// "SEPK"
+		static constexpr uint32_t s_version = 1;
+
+		uint32_t magic = s_magic;
+		uint32_t version = s_version;
+		uint32_t entries_count = 0;
+		uint32_t names_size = 0;
+	};
+	static_assert(sizeof(PackHeader) == 16, "PackHeader is part of file format");
+
+	struct PackEntry {
+		uint64_t offset = 0;		// from the start of archive, multiple of s_pack_alignment
+		uint64_t stored_size = 0;	// bytes in archive
+		uint64_t size = 0;			// bytes after decompression
+		uint32_t name_offset = 0;	// in names block, names are '/' separated and not terminated
+		uint32_t name_length = 0;
+		PackCompression compression = PackCompression::None;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(PackEntry) == 40, "PackEntry is part of file format");
+
+	// entries start on page and sector boundary, so one entry is never split between more pages than it needs
+	constexpr uint64_t s_pack_alignment = 4096;
+
+	// read-only archive mapped into memory, lookups and reads are from any thread
+	class PackArchive {
+	public:
+		struct BuildSettings {
+			PackCompression compression = PackCompression::Lz4;
+			// compressed entry is kept only when it is at least this much smaller, png and jpg mostly aren't
+			float min_saving = 0.05f;
+		};
+
+		struct BuildStats {
+			size_t files = 0;
+			size_t compressed_files = 0;
+			uint64_t bytes = 0;			// of source files
+			uint64_t archive_bytes = 0;
+		};
+
+		// false when file is not an archive of this version or its entries are out of file
+		bool open(const std::filesystem::path& path);
+
+		// name relative to archive root with '/' separators, nullptr when there is no such entry
+		const PackEntry* find(const std::string_view name) const;
+		std::string_view get_name(const PackEntry& entry) const;
+		size_t get_entries_count() const { return m_entries_count; }
+		const PackEntry& get_entry(const size_t index) const { return m_entries[index]; }
+
+		// bytes of uncompressed entry inside of mapping, nullptr for compressed one
+		const uint8_t* get_stored_data(const PackEntry& entry) const;
+		// decompresses entry, false when it is damaged
+		bool decompress(const PackEntry& entry, std::vector<uint8_t>& bytes) const;
+		// starts reading entry pages, so a batch of reads waits for disk once
+		void prefetch(const PackEntry& entry) const;
+
+		const std::filesystem::path& get_path() const { return m_path; }
+
+		// files from directories under root, names are relative to root, the output is written again
+		static bool build(const std::filesystem::path& root, const std::vector<std::filesystem::path>& directories,
+			const std::filesystem::path& output, const BuildSettings& settings, BuildStats* stats = nullptr);
+
+	private:
+		std::filesystem::path m_path;
+		MappedFile m_file;
+		const PackEntry* m_entries = nullptr;
+		size_t m_entries_count = 0;
+		const char* m_names = nullptr;
+	};
+}
@@ -0,0 +1,99 @@
+#include "XxHash.h"
+
+#include <cstring>
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr uint64_t s_prime1 = 11400714785074694791ull;
+		constexpr uint64_t s_prime2 = 14029467366897019727ull;
+		constexpr uint64_t s_prime3 = 1609587929392839161ull;
+		constexpr uint64_t s_prime4 = 9650029242287828579ull;
+		constexpr uint64_t s_prime5 = 2870177450012600261ull;
+
+		// little-endian like every platform engine runs on
+		uint64_t read64(const uint8_t* p)
+		{
+			uint64_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint32_t read32(const uint8_t* p)
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint64_t rotl(const uint64_t value, const int bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		uint64_t round(uint64_t accumulator, const uint64_t input)
+		{
+			accumulator += input * s_prime2;
+			accumulator = rotl(accumulator, 31);
+			return accumulator * s_prime1;
+		}
+
+		uint64_t merge_round(uint64_t hash, const uint64_t accumulator)
+		{
+			hash ^= round(0, accumulator);
+			return hash * s_prime1 + s_prime4;
+		}
+	}
+
+	uint64_t xxhash64(const void* data, const size_t size, const uint64_t seed)
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = p + size;
+		uint64_t hash;
+		if (size >= 32) {
+			// four independent lanes, so multiplies of one stripe overlap
+			uint64_t v1 = seed + s_prime1 + s_prime2;
+			uint64_t v2 = seed + s_prime2;
+			uint64_t v3 = seed;
+			uint64_t v4 = seed - s_prime1;
+			const uint8_t* const limit = end - 32;
+			do {
+				v1 = round(v1, read64(p));
+				v2 = round(v2, read64(p + 8));
+				v3 = round(v3, read64(p + 16));
+				v4 = round(v4, read64(p + 24));
+				p += 32;
+			} while (p <= limit);
+			hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			hash = merge_round(hash, v1);
+			hash = merge_round(hash, v2);
+			hash = merge_round(hash, v3);
+			hash = merge_round(hash, v4);
+		}
+		else {
+			hash = seed + s_prime5;
+		}
+		hash += static_cast<uint64_t>(size);
+
+		for (; p + 8 <= end; p += 8) {
+			hash ^= round(0, read64(p));
+			hash = rotl(hash, 27) * s_prime1 + s_prime4;
+		}
+		if (p + 4 <= end) {
+			hash ^= static_cast<uint64_t>(read32(p)) * s_prime1;
+			hash = rotl(hash, 23) * s_prime2 + s_prime3;
+			p += 4;
+		}
+		for (; p < end; ++p) {
+			hash ^= *p * s_prime5;
+			hash = rotl(hash, 11) * s_prime1;
+		}
+
+		hash ^= hash >> 33;
+		hash *= s_prime2;
+		hash ^= hash >> 29;
+		hash *= s_prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+}
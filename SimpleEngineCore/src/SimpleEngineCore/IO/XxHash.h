@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// XXH64, hashes match the reference implementation, so they can be kept in files between runs
+	// about as fast as memory reads, content of big files is hashed in the time it takes to read them
+	uint64_t xxhash64(const void* data, const size_t size, const uint64_t seed = 0);
+}
@@ -0,0 +1,411 @@
+#include "JobSystem.h"
+#include "WorkStealingDeque.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <random>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr size_t s_deque_capacity = 4096;
+		// every worker allocates jobs from own ring, so at most this many jobs of one thread can be alive
+		// (all other threads together have one ring)
+		constexpr size_t s_jobs_per_thread = 4096;
+
+		struct JobRing {
+			std::unique_ptr<Job[]> jobs{ new Job[s_jobs_per_thread] };
+			size_t next = 0;
+		};
+
+		struct WorkerData {
+			WorkStealingDeque<Job*> deque{ s_deque_capacity };
+		};
+
+		struct JobSystemData {
+			std::vector<std::unique_ptr<WorkerData>> workers; // [0] - main thread
+			std::vector<std::thread> threads;
+
+			// jobs from threads which are not workers (no own deque)
+			std::mutex injected_mutex;
+			std::deque<Job*> injected_jobs;
+
+			std::mutex main_thread_mutex;
+			std::vector<Job*> main_thread_jobs;
+			std::atomic<std::thread::id> gl_thread;
+
+			// threads which are not workers (file reads) share one ring, their jobs may run after they exit
+			JobRing other_threads_jobs;
+			std::atomic<size_t> other_threads_next{ 0 };
+
+			std::atomic<bool> running{ false };
+			std::atomic<int> pending_jobs{ 0 };
+			std::atomic<int> sleeping_workers{ 0 };
+			std::mutex sleep_mutex;
+			std::condition_variable sleep_cv;
+		};
+
+		JobSystemData s_data;
+		thread_local int s_thread_index = -1;
+		thread_local JobRing s_job_ring;
+		thread_local bool s_ring_full_reported = false;
+
+		// marks slot of shared ring taken by a thread which didn't write its job yet, never called
+		void claimed_job(Job&) {}
+		thread_local std::minstd_rand s_random{ std::random_device{}() };
+
+		void pin_current_thread(const uint32_t core) {
+#ifdef _WIN32
+			SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(core % CPU_SETSIZE, &set);
+			pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+			(void)core;
+#endif
+		}
+
+		void wake_workers() {
+			if (s_data.sleeping_workers.load(std::memory_order_seq_cst) > 0) {
+				// take lock so worker can't miss notify between predicate check and wait
+				{ std::lock_guard<std::mutex> lock(s_data.sleep_mutex); }
+				s_data.sleep_cv.notify_one();
+			}
+		}
+	}
+
+	std::atomic<bool> JobSystem::s_initialized{ false };
+
+	void JobSystem::init(const Settings& settings)
+	{
+		if (s_initialized) {
+			return;
+		}
+		uint32_t workers_count = settings.workers_count;
+		if (workers_count == 0) {
+			const uint32_t hardware = std::thread::hardware_concurrency();
+			workers_count = hardware > 1 ? hardware - 1 : 0;
+		}
+
+		s_thread_index = 0;
+		s_data.gl_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+		s_data.running = true;
+		s_data.workers.clear();
+		for (uint32_t i = 0; i < workers_count + 1; ++i) {
+			s_data.workers.push_back(std::make_unique<WorkerData>());
+		}
+		if (settings.pin_threads) {
+			pin_current_thread(0);
+		}
+		s_initialized = true;
+		for (uint32_t i = 1; i <= workers_count; ++i) {
+			s_data.threads.emplace_back([i, pin = settings.pin_threads]() {
+				if (pin) {
+					pin_current_thread(i);
+				}
+				worker_loop(i);
+			});
+		}
+		LOG_INFO("JobSystem: {0} workers + main thread{1}", workers_count, settings.pin_threads ? " (pinned)" : "");
+	}
+
+	void JobSystem::shutdown()
+	{
+		if (!s_initialized) {
+			return;
+		}
+		// finish what is left so nobody waits forever
+		Job* job = nullptr;
+		while ((job = find_job()) != nullptr) {
+			execute(job);
+		}
+		process_main_thread_jobs();
+
+		{
+			std::lock_guard<std::mutex> lock(s_data.sleep_mutex);
+			s_data.running = false;
+		}
+		s_data.sleep_cv.notify_all();
+		for (std::thread& t : s_data.threads) {
+			t.join();
+		}
+		s_data.threads.clear();
+		s_data.workers.clear();
+		s_initialized = false;
+	}
+
+	uint32_t JobSystem::get_threads_count()
+	{
+		return s_initialized ? static_cast<uint32_t>(s_data.workers.size()) : 1;
+	}
+
+	int JobSystem::get_thread_index()
+	{
+		return s_thread_index;
+	}
+
+	void JobSystem::set_gl_thread(const std::thread::id id)
+	{
+		s_data.gl_thread.store(id, std::memory_order_release);
+	}
+
+	bool JobSystem::is_gl_thread()
+	{
+		return s_data.gl_thread.load(std::memory_order_acquire) == std::this_thread::get_id();
+	}
+
+	size_t JobSystem::get_batch_size(const size_t count, const size_t min_batch_size)
+	{
+		// ~4 batches per thread so fast threads can steal from slow ones
+		const size_t batches = static_cast<size_t>(get_threads_count()) * 4;
+		const size_t batch = (count + batches - 1) / batches;
+		return batch > min_batch_size ? batch : min_batch_size;
+	}
+
+	Job* JobSystem::allocate_job()
+	{
+		Job* job = nullptr;
+		const bool shared_ring = s_thread_index < 0;
+		if (shared_ring) {
+			const size_t index = s_data.other_threads_next.fetch_add(1, std::memory_order_relaxed);
+			job = &s_data.other_threads_jobs.jobs[index & (s_jobs_per_thread - 1)];
+		}
+		else {
+			job = &s_job_ring.jobs[s_job_ring.next & (s_jobs_per_thread - 1)];
+			++s_job_ring.next;
+		}
+		// ring wrapped around onto a job which didn't start yet, help until it does instead of overwriting it
+		// other threads can get the same slot of shared ring one lap apart, so there it is claimed
+		const auto is_free = [job, shared_ring]() {
+			Job::Function expected = nullptr;
+			return shared_ring
+				? job->function.compare_exchange_strong(expected, &claimed_job, std::memory_order_acquire, std::memory_order_relaxed)
+				: job->function.load(std::memory_order_acquire) == nullptr;
+		};
+		while (!is_free()) {
+			if (!s_ring_full_reported) {
+				LOG_WARN("JobSystem: more than {0} jobs of one thread in flight, waiting for a free slot", s_jobs_per_thread);
+				s_ring_full_reported = true;
+			}
+			if (is_gl_thread()) {
+				process_main_thread_jobs();
+			}
+			if (!execute_one_job()) {
+				std::this_thread::yield();
+			}
+		}
+		return job;
+	}
+
+	void JobSystem::schedule(Job* job)
+	{
+		if (!s_initialized) {
+			execute(job); // no workers - behave like a simple function call
+			return;
+		}
+		const int index = s_thread_index;
+		const bool is_worker = index >= 0 && static_cast<size_t>(index) < s_data.workers.size();
+		if (is_worker) {
+			if (!s_data.workers[index]->deque.push(job)) {
+				execute(job); // deque is full, no reason to wait
+				return;
+			}
+		}
+		else {
+			std::lock_guard<std::mutex> lock(s_data.injected_mutex);
+			s_data.injected_jobs.push_back(job);
+		}
+		s_data.pending_jobs.fetch_add(1, std::memory_order_seq_cst);
+		wake_workers();
+	}
+
+	void JobSystem::schedule_after(JobCounter& dependency, Job* job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(dependency.m_continuations_mutex);
+			if (!dependency.is_done()) {
+				if (dependency.m_continuations_count < JobCounter::s_max_continuations) {
+					dependency.m_continuations[dependency.m_continuations_count++] = job;
+					return;
+				}
+				LOG_ERROR("JobCounter: too many continuations, job waits on a thread");
+			}
+		}
+		if (!dependency.is_done()) {
+			wait(dependency);
+		}
+		schedule(job);
+	}
+
+	void JobSystem::schedule_on_main_thread(Job* job)
+	{
+		if (!s_initialized && is_gl_thread()) {
+			execute(job);
+			return;
+		}
+		std::lock_guard<std::mutex> lock(s_data.main_thread_mutex);
+		s_data.main_thread_jobs.push_back(job);
+	}
+
+	void JobSystem::process_main_thread_jobs()
+	{
+		if (!is_gl_thread()) {
+			return;
+		}
+		std::vector<Job*> jobs;
+		{
+			std::lock_guard<std::mutex> lock(s_data.main_thread_mutex);
+			jobs.swap(s_data.main_thread_jobs);
+		}
+		for (Job* job : jobs) {
+			execute(job);
+		}
+	}
+
+	void JobSystem::execute(Job* job)
+	{
+		// function frees the slot before it runs the lambda, owner may reuse it at once
+		JobCounter* counter = job->counter;
+		job->function.load(std::memory_order_relaxed)(*job);
+		if (counter) {
+			release(*counter);
+		}
+	}
+
+	void JobSystem::hold(JobCounter& counter)
+	{
+		counter.m_value.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void JobSystem::release(JobCounter& counter)
+	{
+		// not the last job - just decrement and never touch counter again
+		int value = counter.m_value.load(std::memory_order_relaxed);
+		while (value > 1) {
+			if (counter.m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel)) {
+				return;
+			}
+		}
+		// last job of the counter - release everything which waits for it
+		// counter reaches 0 under the lock, so wait() can't destroy it while it is still used here
+		Job* continuations[JobCounter::s_max_continuations];
+		size_t continuations_count = 0;
+		{
+			std::lock_guard<std::mutex> lock(counter.m_continuations_mutex);
+			if (counter.m_value.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+				return; // more jobs were added meanwhile
+			}
+			continuations_count = counter.m_continuations_count;
+			for (size_t i = 0; i < continuations_count; ++i) {
+				continuations[i] = counter.m_continuations[i];
+			}
+			counter.m_continuations_count = 0;
+		}
+		for (size_t i = 0; i < continuations_count; ++i) {
+			schedule(continuations[i]);
+		}
+	}
+
+	Job* JobSystem::find_job()
+	{
+		if (!s_initialized) {
+			return nullptr;
+		}
+		Job* job = nullptr;
+		const int index = s_thread_index;
+		const size_t workers_count = s_data.workers.size();
+
+		// 1. own deque
+		if (index >= 0 && static_cast<size_t>(index) < workers_count && s_data.workers[index]->deque.pop(job)) {
+			s_data.pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+		// 2. jobs from outside
+		{
+			std::unique_lock<std::mutex> lock(s_data.injected_mutex, std::try_to_lock);
+			if (lock.owns_lock() && !s_data.injected_jobs.empty()) {
+				job = s_data.injected_jobs.front();
+				s_data.injected_jobs.pop_front();
+				s_data.pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		// 3. steal starting from random victim
+		const size_t start = s_random() % workers_count;
+		for (size_t i = 0; i < workers_count; ++i) {
+			const size_t victim = (start + i) % workers_count;
+			if (static_cast<int>(victim) == index) {
+				continue;
+			}
+			if (s_data.workers[victim]->deque.steal(job)) {
+				s_data.pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void JobSystem::wait(JobCounter& counter)
+	{
+		while (!counter.is_done()) {
+			if (Job* job = find_job()) {
+				execute(job);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+		// last job may still hold the lock
+		std::lock_guard<std::mutex> lock(counter.m_continuations_mutex);
+	}
+
+	bool JobSystem::execute_one_job()
+	{
+		Job* job = find_job();
+		if (!job) {
+			return false;
+		}
+		execute(job);
+		return true;
+	}
+
+	void JobSystem::worker_loop(const uint32_t index)
+	{
+		s_thread_index = static_cast<int>(index);
+		uint32_t idle_spins = 0;
+
+		while (s_data.running.load(std::memory_order_relaxed)) {
+			if (Job* job = find_job()) {
+				execute(job);
+				idle_spins = 0;
+				continue;
+			}
+			// spin a little, new jobs usually come in bursts
+			if (++idle_spins < 64) {
+				std::this_thread::yield();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(s_data.sleep_mutex);
+			s_data.sleeping_workers.fetch_add(1, std::memory_order_seq_cst);
+			s_data.sleep_cv.wait(lock, []() {
+				return s_data.pending_jobs.load(std::memory_order_seq_cst) > 0 || !s_data.running.load();
+			});
+			s_data.sleeping_workers.fetch_sub(1, std::memory_order_seq_cst);
+			idle_spins = 0;
+		}
+	}
+}
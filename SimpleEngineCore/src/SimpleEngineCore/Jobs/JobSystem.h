@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct Job;
+
+	// how many jobs are still in flight, jobs can wait for it or run after it
+	class JobCounter {
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool is_done() const { return m_value.load(std::memory_order_acquire) == 0; }
+		int get_value() const { return m_value.load(std::memory_order_acquire); }
+
+	private:
+		friend class JobSystem;
+
+		static constexpr size_t s_max_continuations = 16;
+
+		std::atomic<int> m_value{ 0 };
+		std::mutex m_continuations_mutex;
+		Job* m_continuations[s_max_continuations] = {};
+		size_t m_continuations_count = 0;
+	};
+
+	// one cache line, lambda is stored inside so scheduling doesn't touch the heap
+	struct alignas(64) Job {
+		using Function = void(*)(Job&);
+
+		// null while slot of the ring is free, cleared when the job starts (lambda is moved out of the slot first)
+		std::atomic<Function> function{ nullptr };
+		JobCounter* counter = nullptr;
+		alignas(16) unsigned char payload[48];
+	};
+	static_assert(sizeof(Job) == 64, "Job has to fit one cache line");
+
+	class JobSystem {
+	public:
+		struct Settings {
+			uint32_t workers_count = 0; // 0 - one worker per hardware thread except main
+			bool pin_threads = false;   // worker i runs only on core i + 1, main thread on core 0
+		};
+
+		static void init() { init(Settings()); }
+		static void init(const Settings& settings);
+		static void shutdown();
+
+		static bool is_initialized() { return s_initialized.load(std::memory_order_acquire); }
+		// workers + main thread
+		static uint32_t get_threads_count();
+		// 0 - main thread, 1..N workers, -1 any other thread
+		static int get_thread_index();
+		static bool is_main_thread() { return get_thread_index() == 0; }
+		// thread which owns OpenGL context and runs main thread jobs, thread of init until set
+		static void set_gl_thread(const std::thread::id id);
+		static bool is_gl_thread();
+
+		// f() runs on any thread, counter (if any) is incremented now and decremented after f
+		template<typename F>
+		static void run(F&& f, JobCounter* counter = nullptr) {
+			schedule(create_job(std::forward<F>(f), counter));
+		}
+
+		// f() is scheduled only when dependency reaches 0, nobody waits on a thread for it
+		template<typename F>
+		static void run_after(JobCounter& dependency, F&& f, JobCounter* counter = nullptr) {
+			schedule_after(dependency, create_job(std::forward<F>(f), counter));
+		}
+
+		// f() runs inside of process_main_thread_jobs on thread which owns OpenGL context (OpenGL calls)
+		template<typename F>
+		static void run_on_main_thread(F&& f, JobCounter* counter = nullptr) {
+			schedule_on_main_thread(create_job(std::forward<F>(f), counter));
+		}
+		// does nothing on any thread except gl thread
+		static void process_main_thread_jobs();
+
+		// counter stays above 0 from hold until release, for work which is not a job (file reads)
+		// release runs jobs which wait for counter when it was the last one
+		static void hold(JobCounter& counter);
+		static void release(JobCounter& counter);
+
+		// executes other jobs until counter is 0, so waiting thread is not wasted
+		// counter can be destroyed only after wait returned (is_done alone is not enough)
+		static void wait(JobCounter& counter);
+		// runs one queued job on this thread, false when there was none
+		// for waits on something which is not a counter
+		static bool execute_one_job();
+
+		// f(begin, end) for [0, count) split into batches of batch_size
+		// f has to stay alive until counter is done
+		template<typename F>
+		static void parallel_for_async(const size_t count, const size_t batch_size, const F& f, JobCounter& counter) {
+			const size_t batch = batch_size > 0 ? batch_size : 1;
+			for (size_t begin = 0; begin < count; begin += batch) {
+				const size_t end = begin + batch < count ? begin + batch : count;
+				const F* pf = &f;
+				run([pf, begin, end]() { (*pf)(begin, end); }, &counter);
+			}
+		}
+
+		template<typename F>
+		static void parallel_for(const size_t count, const size_t batch_size, const F& f) {
+			if (count == 0) {
+				return;
+			}
+			if (!is_initialized() || count <= batch_size) {
+				f(size_t(0), count);
+				return;
+			}
+			JobCounter counter;
+			parallel_for_async(count, batch_size, f, counter);
+			wait(counter);
+		}
+
+		// batch size which gives every thread a few batches for balancing
+		static size_t get_batch_size(const size_t count, const size_t min_batch_size = 64);
+
+	private:
+		template<typename F>
+		static Job* create_job(F&& f, JobCounter* counter) {
+			using Functor = std::decay_t<F>;
+			static_assert(sizeof(Functor) <= sizeof(Job::payload), "Job lambda captures too much, capture pointers");
+			static_assert(alignof(Functor) <= 16, "Job lambda is over aligned");
+
+			Job* job = allocate_job();
+			new (job->payload) Functor(std::forward<F>(f));
+			job->counter = counter;
+			job->function.store([](Job& j) {
+				// job which spawns and waits for other jobs may run long, its slot is free meanwhile
+				Functor* functor = std::launder(reinterpret_cast<Functor*>(j.payload));
+				Functor local(std::move(*functor));
+				functor->~Functor();
+				j.function.store(nullptr, std::memory_order_release);
+				local();
+			}, std::memory_order_relaxed);
+			if (counter) {
+				counter->m_value.fetch_add(1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		// next slot of the thread's ring, waits (running other jobs) while that slot is still in flight
+		static Job* allocate_job();
+		static void schedule(Job* job);
+		static void schedule_after(JobCounter& dependency, Job* job);
+		static void schedule_on_main_thread(Job* job);
+		static void execute(Job* job);
+		static Job* find_job();
+		static void worker_loop(const uint32_t index);
+
+		static std::atomic<bool> s_initialized;
+	};
+}
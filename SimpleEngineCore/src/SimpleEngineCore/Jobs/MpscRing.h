@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace SimpleEngine {
+
+	// lock-free bounded ring for any number of producers and one consumer thread
+	// every slot has a sequence number: producer claims position with CAS, fills slot in place and publishes it,
+	// consumer sees slots in claim order and gives them back one lap later
+	template<typename T, size_t Capacity>
+	class MpscRing {
+	public:
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity has to be power of two");
+
+		MpscRing() {
+			for (size_t i = 0; i < Capacity; ++i) {
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+		MpscRing(const MpscRing&) = delete;
+		MpscRing& operator=(const MpscRing&) = delete;
+
+		// any thread, nullptr if ring is full, ticket is passed to end_push
+		T* try_begin_push(size_t& ticket) {
+			size_t position = m_head.load(std::memory_order_relaxed);
+			while (true) {
+				Slot& slot = m_slots[position & (Capacity - 1)];
+				const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+				const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+				if (difference == 0) {
+					if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						ticket = position;
+						return &slot.item;
+					}
+				}
+				else if (difference < 0) {
+					// consumer didn't give this slot back yet
+					return nullptr;
+				}
+				else {
+					position = m_head.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// makes slot from try_begin_push visible to consumer
+		void end_push(const size_t ticket) {
+			m_slots[ticket & (Capacity - 1)].sequence.store(ticket + 1, std::memory_order_release);
+		}
+
+		// consumer only, nullptr if ring is empty or the oldest claimed slot isn't published yet
+		T* try_front() {
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			Slot& slot = m_slots[tail & (Capacity - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+				return nullptr;
+			}
+			return &slot.item;
+		}
+
+		// consumer only, gives slot from try_front back to producers
+		void pop() {
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			m_slots[tail & (Capacity - 1)].sequence.store(tail + Capacity, std::memory_order_release);
+			m_tail.store(tail + 1, std::memory_order_release);
+		}
+
+		// nothing claimed which consumer didn't pop yet
+		bool empty() const {
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		struct Slot {
+			std::atomic<size_t> sequence{ 0 };
+			T item;
+		};
+
+		std::array<Slot, Capacity> m_slots;
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+	};
+}
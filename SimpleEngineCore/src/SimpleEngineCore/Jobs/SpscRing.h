@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace SimpleEngine {
+
+	// lock-free ring for exactly one producer and one consumer thread
+	// items live inside of ring and are reused, so producer fills slot in place and publishes it
+	template<typename T, size_t Capacity>
+	class SpscRing {
+	public:
+		static_assert(Capacity >= 2, "SpscRing needs at least 2 slots");
+
+		SpscRing() = default;
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		// producer only, nullptr if consumer still holds all slots
+		T* try_begin_push() {
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+				return nullptr;
+			}
+			return &m_items[head % Capacity];
+		}
+
+		// producer only, makes slot from try_begin_push visible to consumer
+		void end_push() {
+			m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// consumer only, nullptr if ring is empty
+		T* try_front() {
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail == m_head.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+			return &m_items[tail % Capacity];
+		}
+
+		// consumer only, gives slot from try_front back to producer
+		void pop() {
+			m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		bool empty() const {
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::array<T, Capacity> m_items;
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+	};
+}
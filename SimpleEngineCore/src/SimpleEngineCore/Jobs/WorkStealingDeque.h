@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Chase-Lev work stealing deque with fixed capacity
+	// (memory orders from "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013)
+	// owner thread works with bottom (push / pop, LIFO - hot in cache)
+	// other threads steal from top (FIFO - oldest and usually biggest work)
+	template<typename T>
+	class WorkStealingDeque {
+	public:
+		explicit WorkStealingDeque(const size_t capacity = 4096)
+			: m_items(capacity), m_mask(static_cast<int64_t>(capacity) - 1) {
+			// capacity has to be power of 2 to use mask instead of modulo
+		}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		// owner only, false if deque is full
+		bool push(T item) {
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			const int64_t top = m_top.load(std::memory_order_acquire);
+			if (bottom - top > m_mask) {
+				return false;
+			}
+			m_items[bottom & m_mask].store(item, std::memory_order_relaxed);
+			// release store instead of release fence, same cost on x86 and ThreadSanitizer understands it
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		// owner only
+		bool pop(T& item) {
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom) {
+				// empty
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return false;
+			}
+			item = m_items[bottom & m_mask].load(std::memory_order_relaxed);
+			if (top != bottom) {
+				return true; // more than one item, no race with thieves
+			}
+			// last item - race with steal
+			const bool won = m_top.compare_exchange_strong(top, top + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return won;
+		}
+
+		// any thread
+		bool steal(T& item) {
+			int64_t top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+			if (top >= bottom) {
+				return false;
+			}
+			item = m_items[top & m_mask].load(std::memory_order_relaxed);
+			return m_top.compare_exchange_strong(top, top + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+		}
+
+		size_t size_approx() const {
+			const int64_t size = m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed);
+			return size > 0 ? static_cast<size_t>(size) : 0;
+		}
+
+	private:
+		// top and bottom on different cache lines, thieves hammer top
+		alignas(64) std::atomic<int64_t> m_top{ 0 };
+		alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+		alignas(64) std::vector<std::atomic<T>> m_items;
+		const int64_t m_mask;
+	};
+}
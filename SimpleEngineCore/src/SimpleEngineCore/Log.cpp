@@ -1,6 +1,367 @@
 #include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/Jobs/MpscRing.h"
+
+#include <spdlog/spdlog.h>
+
+#include <csignal>
+#include <exception>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
 namespace SimpleEngine {
 
+	std::atomic<uint8_t> Log::s_levels[static_cast<size_t>(LogCategory::Count)] = {
+		static_cast<uint8_t>(LogLevel::Info),	// Core
+		static_cast<uint8_t>(LogLevel::Info),	// Render
+		static_cast<uint8_t>(LogLevel::Info),	// Input
+		static_cast<uint8_t>(LogLevel::Info),	// Assets
+		static_cast<uint8_t>(LogLevel::Info)	// GLDebug
+	};
+
+	namespace {
+		constexpr size_t s_ring_size = 512;
+		// ticket of record which is written on calling thread
+		constexpr size_t s_local_ticket = ~size_t(0);
+
+		MpscRing<LogRecord, s_ring_size> s_ring;
+		std::atomic<bool> s_running{ false };
+		std::thread s_thread;
+		std::thread::id s_thread_id;
+
+		// logger thread sleeps when ring is empty and wakes up by timeout
+		// producers wake it earlier only for warnings and worse or when ring fills up, waking it costs a syscall
+		constexpr int s_wakeup_period_ms = 10;
+		constexpr size_t s_wakeup_lines = s_ring_size / 4;
+		std::atomic<bool> s_sleeping{ false };
+
+		// crash handler waits so long for logger thread to write the ring out, then process dies anyway
+		constexpr int s_crash_flush_timeout_ms = 500;
+		std::atomic<bool> s_crashing{ false };
+		std::atomic<bool> s_crash_flushed{ false };
+
+		// wakeup is a pipe (an event on windows) and not a condition variable:
+		// writing into a pipe is async signal safe, so fatal signal handler can wake logger thread too
+#ifdef _WIN32
+		HANDLE s_wakeup_event = nullptr;
+#else
+		int s_wakeup_pipe[2] = { -1, -1 };
+#endif
+
+		// opened once and never closed: a late producer must not write into a descriptor which got reused
+		bool open_wakeup() {
+#ifdef _WIN32
+			if (s_wakeup_event == nullptr) {
+				s_wakeup_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+			}
+			return s_wakeup_event != nullptr;
+#else
+			if (s_wakeup_pipe[0] != -1) {
+				return true;
+			}
+			if (pipe(s_wakeup_pipe) != 0) {
+				return false;
+			}
+			// full pipe already wakes logger thread, writers must not block on it
+			for (const int fd : s_wakeup_pipe) {
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+				fcntl(fd, F_SETFD, FD_CLOEXEC);
+			}
+			return true;
+#endif
+		}
+
+		// any thread and signal handlers
+		void wake_logger() {
+#ifdef _WIN32
+			SetEvent(s_wakeup_event);
+#else
+			const char byte = 0;
+			[[maybe_unused]] const ssize_t written = write(s_wakeup_pipe[1], &byte, 1);
+#endif
+		}
+
+		// logger thread only, returns on wake_logger or after timeout
+		void wait_for_wakeup(const int timeout_ms) {
+#ifdef _WIN32
+			WaitForSingleObject(s_wakeup_event, static_cast<DWORD>(timeout_ms));
+#else
+			pollfd wakeup_fd{ s_wakeup_pipe[0], POLLIN, 0 };
+			if (poll(&wakeup_fd, 1, timeout_ms) > 0) {
+				char bytes[64];
+				while (read(s_wakeup_pipe[0], bytes, sizeof(bytes)) > 0) {
+				}
+			}
+#endif
+		}
+
+		// async signal safe sleep
+		void sleep_ms(const int milliseconds) {
+#ifdef _WIN32
+			Sleep(static_cast<DWORD>(milliseconds));
+#else
+			timespec duration{ 0, milliseconds * 1000000L };
+			nanosleep(&duration, nullptr);
+#endif
+		}
+
+		std::atomic<uint64_t> s_written{ 0 };
+		std::atomic<uint64_t> s_dropped{ 0 };
+		uint64_t s_reported_dropped = 0;	// logger thread only
+
+		std::terminate_handler s_previous_terminate = nullptr;
+		constexpr int s_crash_signals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+
+		spdlog::level::level_enum to_spdlog_level(const LogLevel level) {
+			switch (level) {
+			case LogLevel::Trace: return spdlog::level::trace;
+			case LogLevel::Debug: return spdlog::level::debug;
+			case LogLevel::Info: return spdlog::level::info;
+			case LogLevel::Warn: return spdlog::level::warn;
+			case LogLevel::Error: return spdlog::level::err;
+			case LogLevel::Critical: return spdlog::level::critical;
+			case LogLevel::Off: return spdlog::level::off;
+			}
+			return spdlog::level::info;
+		}
+
+		void write_record(const LogRecord& record) {
+			fmt::memory_buffer message;
+			message.push_back('[');
+			const char* category_name = Log::get_category_name(record.category);
+			message.append(category_name, category_name + std::strlen(category_name));
+			message.push_back(']');
+			message.push_back(' ');
+			// bad format string must not take logger thread down
+			try {
+				record.format_fn(record, message);
+			}
+			catch (const std::exception& exception) {
+				const char* format_error = "log format error: ";
+				message.append(format_error, format_error + std::strlen(format_error));
+				message.append(exception.what(), exception.what() + std::strlen(exception.what()));
+			}
+			spdlog::default_logger_raw()->log(record.time, spdlog::source_loc{}, to_spdlog_level(record.level),
+				spdlog::string_view_t(message.data(), message.size()));
+		}
+
+		// consumer side, only one thread at a time: logger thread or the thread which stopped it
+		bool write_front() {
+			LogRecord* record = s_ring.try_front();
+			if (record == nullptr) {
+				return false;
+			}
+			write_record(*record);
+			s_ring.pop();
+			return true;
+		}
+
+		void report_dropped() {
+			const uint64_t dropped = s_dropped.load(std::memory_order_relaxed);
+			if (dropped != s_reported_dropped) {
+				spdlog::warn("[core] {} log lines dropped, ring was full", dropped - s_reported_dropped);
+				s_reported_dropped = dropped;
+			}
+		}
+
+		void thread_loop() {
+			while (true) {
+				if (write_front()) {
+					continue;
+				}
+				report_dropped();
+				if (!s_running.load(std::memory_order_acquire)) {
+					break;
+				}
+				// everything crashed thread published is written, now it may re-raise the signal
+				if (s_crashing.load(std::memory_order_acquire) && !s_crash_flushed.load(std::memory_order_relaxed)) {
+					spdlog::default_logger_raw()->flush();
+					s_crash_flushed.store(true, std::memory_order_release);
+				}
+				s_sleeping.store(true, std::memory_order_seq_cst);
+				if (s_ring.empty()) {
+					wait_for_wakeup(s_wakeup_period_ms);
+				}
+				s_sleeping.store(false, std::memory_order_relaxed);
+			}
+			spdlog::default_logger_raw()->flush();
+		}
+
+		// async signal safe: wakes logger thread and waits until it wrote the ring out and flushed spdlog,
+		// line which crashed thread was writing is lost (and lines after it, ring is written in order)
+		// false if logger thread can't do it: it is not running, it is the crashed thread or it didn't make it in time
+		bool wait_for_crash_flush() {
+			if (!s_running.load(std::memory_order_acquire) || std::this_thread::get_id() == s_thread_id) {
+				return false;
+			}
+			wake_logger();
+			for (int waited_ms = 0; waited_ms < s_crash_flush_timeout_ms; ++waited_ms) {
+				if (s_crash_flushed.load(std::memory_order_acquire)) {
+					return true;
+				}
+				sleep_ms(1);
+			}
+			return s_crash_flushed.load(std::memory_order_acquire);
+		}
+
+		// whatever is in ring is written before process dies
+		void flush_on_crash() {
+			if (s_running.load(std::memory_order_acquire) && std::this_thread::get_id() != s_thread_id) {
+				wait_for_crash_flush();
+			}
+			else {
+				while (write_front()) {
+				}
+			}
+			spdlog::default_logger_raw()->flush();
+		}
+
+		// only async signal safe calls here: no formatting, no locks, no allocation
+		// logger thread writes and flushes the ring, we only wake it and wait for it
+		void on_crash_signal(const int signal_number) {
+			s_crashing.store(true, std::memory_order_release);
+			const char* message = "Fatal signal\n";
+			switch (signal_number) {
+			case SIGSEGV: message = "Fatal signal SIGSEGV\n"; break;
+			case SIGABRT: message = "Fatal signal SIGABRT\n"; break;
+			case SIGFPE: message = "Fatal signal SIGFPE\n"; break;
+			case SIGILL: message = "Fatal signal SIGILL\n"; break;
+			}
+			size_t length = 0;
+			while (message[length] != '\0') {
+				++length;
+			}
+#ifdef _WIN32
+			_write(2, message, static_cast<unsigned int>(length));
+#else
+			[[maybe_unused]] const ssize_t written = write(STDERR_FILENO, message, length);
+#endif
+			wait_for_crash_flush();
+			std::signal(signal_number, SIG_DFL);
+			std::raise(signal_number);
+		}
+
+		void on_terminate() {
+			s_crashing.store(true, std::memory_order_release);
+			LOG_CRIT("std::terminate called");
+			flush_on_crash();
+			if (s_previous_terminate != nullptr) {
+				s_previous_terminate();
+			}
+			std::abort();
+		}
+	}
+
+	void Log::init()
+	{
+		if (s_running.load(std::memory_order_acquire) || !open_wakeup()) {
+			return;
+		}
+		s_running.store(true, std::memory_order_release);
+		// filtering is done before lines get into ring
+		spdlog::set_level(spdlog::level::trace);
+		s_thread = std::thread(thread_loop);
+		s_thread_id = s_thread.get_id();
+
+		for (const int signal_number : s_crash_signals) {
+			std::signal(signal_number, on_crash_signal);
+		}
+		s_previous_terminate = std::set_terminate(on_terminate);
+	}
+
+	void Log::shutdown()
+	{
+		if (!s_running.exchange(false)) {
+			return;
+		}
+		wake_logger();
+		s_thread.join();
+		s_thread_id = std::thread::id();
+		// lines published after logger thread saw it has to stop
+		while (write_front()) {
+		}
+
+		for (const int signal_number : s_crash_signals) {
+			std::signal(signal_number, SIG_DFL);
+		}
+		std::set_terminate(s_previous_terminate);
+	}
+
+	void Log::flush()
+	{
+		if (s_running.load(std::memory_order_acquire) && std::this_thread::get_id() != s_thread_id) {
+			wake_logger();
+			while (!s_ring.empty()) {
+				std::this_thread::yield();
+			}
+		}
+		spdlog::default_logger_raw()->flush();
+	}
+
+	const char* Log::get_category_name(const LogCategory category)
+	{
+		switch (category) {
+		case LogCategory::Core: return "core";
+		case LogCategory::Render: return "render";
+		case LogCategory::Input: return "input";
+		case LogCategory::Assets: return "assets";
+		case LogCategory::GLDebug: return "gl-debug";
+		case LogCategory::Count: break;
+		}
+		return "unknown";
+	}
+
+	Log::Stats Log::get_stats()
+	{
+		Stats stats;
+		stats.written = s_written.load(std::memory_order_relaxed);
+		stats.dropped = s_dropped.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	LogRecord* Log::begin_record(size_t& ticket)
+	{
+		if (!s_running.load(std::memory_order_acquire)) {
+			thread_local LogRecord local_record;
+			ticket = s_local_ticket;
+			return &local_record;
+		}
+		LogRecord* record = s_ring.try_begin_push(ticket);
+		if (record == nullptr) {
+			s_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		return record;
+	}
+
+	void Log::end_record(LogRecord* record, const size_t ticket)
+	{
+		if (ticket == s_local_ticket) {
+			write_record(*record);
+			if (record->level >= LogLevel::Critical) {
+				spdlog::default_logger_raw()->flush();
+			}
+			return;
+		}
 
-}
\ No newline at end of file
+		const LogLevel level = record->level;
+		s_ring.end_push(ticket);
+		s_written.fetch_add(1, std::memory_order_relaxed);
+		if ((level >= LogLevel::Warn || ticket % s_wakeup_lines == 0) && s_sleeping.load(std::memory_order_seq_cst)) {
+			wake_logger();
+		}
+		// critical line usually comes right before the end, it has to reach the file
+		// crash handler flushes with timeout by itself, logger thread may be dead then
+		if (level >= LogLevel::Critical && !s_crashing.load(std::memory_order_relaxed)) {
+			flush();
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+// shared by SimdMath and per instruction set kernel files
+// kernel files are compiled with -mavx2 etc, so nothing with inline code (glm, std containers) is included here:
+// linker could pick AVX2 copy of such function for the whole program
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMPLE_ENGINE_SIMD_X86 1
+#endif
+
+namespace SimpleEngine {
+
+	// position, rotation (unit quaternion xyzw) and scale of objects, one array per component
+	struct TransformArrays {
+		const float* position[3];
+		const float* rotation[4];
+		const float* scale[3];
+	};
+
+	// boxes as center and half size
+	struct AabbArrays {
+		const float* center[3];
+		const float* extent[3];
+	};
+
+	struct AabbOutArrays {
+		float* center[3];
+		float* extent[3];
+	};
+
+	struct SphereArrays {
+		const float* center[3];
+		const float* radius;
+	};
+
+	// screen space triangle of occlusion rasterizer, functions are evaluated at pixel centers (x + 0.5, y + 0.5)
+	// edge i: edge_a[i] * x + edge_b[i] * y + edge_c[i] >= 0 inside, inverse w: depth_a * x + depth_b * y + depth_c
+	struct OcclusionTriangle {
+		float edge_a[3];
+		float edge_b[3];
+		float edge_c[3];
+		float depth_a;
+		float depth_b;
+		float depth_c;
+		int min_x, min_y, max_x, max_y;	// pixel bounds, inclusive
+	};
+
+	// part of occlusion depth buffer, depth is 1 / w: 0 - nothing drawn, bigger - closer
+	struct OcclusionTile {
+		float* depth;		// screen pixel (px, py) is depth[(py - y) * stride + px - x]
+		size_t stride;		// floats per row
+		int x, y;
+		int width, height;	// width is multiple of 8
+	};
+
+	// matrices are column major float[16] (mat4) or float[9] (mat3) like in glm, strides are in bytes
+	// count is always multiple of width, the rest is done by scalar kernels
+	struct SimdKernelTable {
+		size_t width;
+		void (*compose_model_matrices)(const TransformArrays& transforms, float* models, const size_t model_stride, const size_t count);
+		void (*compute_normal_matrices)(const float* models, const size_t model_stride, float* normals, const size_t normal_stride, const size_t count);
+		void (*compute_mvp_matrices)(const float* view_projection, const float* models, const size_t model_stride, float* mvps, const size_t mvp_stride, const size_t count);
+		void (*transform_aabbs)(const float* models, const size_t model_stride, const AabbArrays& local, const AabbOutArrays& world, const size_t count);
+		// planes are float[4] (normal, distance), visible[i] = 1 if sphere is not completely behind any plane
+		void (*test_spheres_planes)(const float* planes, const size_t planes_count, const SphereArrays& spheres, uint8_t* visible, const size_t count);
+		// box is float[3] min and max, visible[i] = 1 if sphere touches box
+		void (*test_spheres_aabb)(const float* box_min, const float* box_max, const SphereArrays& spheres, uint8_t* visible, const size_t count);
+		// keeps the closest depth of triangles[indices[i]] in tile, the whole tile is done by every kernel (width doesn't apply)
+		void (*rasterize_occluders)(const OcclusionTriangle* triangles, const uint32_t* indices, const size_t count, const OcclusionTile& tile);
+	};
+
+	const SimdKernelTable& get_scalar_kernels();
+#ifdef SIMPLE_ENGINE_SIMD_X86
+	const SimdKernelTable& get_sse4_kernels();
+	const SimdKernelTable& get_avx2_kernels();
+#endif
+}
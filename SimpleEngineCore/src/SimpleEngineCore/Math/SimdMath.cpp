@@ -0,0 +1,390 @@
+#include "SimdMath.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#ifdef SIMPLE_ENGINE_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace SimpleEngine {
+
+	namespace {
+
+		void compose_model_matrices_scalar(const TransformArrays& transforms, float* models, const size_t model_stride, const size_t count)
+		{
+			for (size_t i = 0; i < count; ++i) {
+				const float x = transforms.rotation[0][i];
+				const float y = transforms.rotation[1][i];
+				const float z = transforms.rotation[2][i];
+				const float w = transforms.rotation[3][i];
+				const float sx = transforms.scale[0][i];
+				const float sy = transforms.scale[1][i];
+				const float sz = transforms.scale[2][i];
+
+				glm::mat4& model = *reinterpret_cast<glm::mat4*>(reinterpret_cast<unsigned char*>(models) + i * model_stride);
+				model[0] = glm::vec4(1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y), 0.f) * sx;
+				model[1] = glm::vec4(2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x), 0.f) * sy;
+				model[2] = glm::vec4(2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y), 0.f) * sz;
+				model[3] = glm::vec4(transforms.position[0][i], transforms.position[1][i], transforms.position[2][i], 1.f);
+			}
+		}
+
+		void compute_normal_matrices_scalar(const float* models, const size_t model_stride, float* normals, const size_t normal_stride, const size_t count)
+		{
+			for (size_t i = 0; i < count; ++i) {
+				const glm::mat4& model = *reinterpret_cast<const glm::mat4*>(reinterpret_cast<const unsigned char*>(models) + i * model_stride);
+				glm::mat3& normal = *reinterpret_cast<glm::mat3*>(reinterpret_cast<unsigned char*>(normals) + i * normal_stride);
+				// inverse transpose of 3x3 is cofactor matrix / determinant, its columns are cross products of columns
+				const glm::vec3 a0(model[0]);
+				const glm::vec3 a1(model[1]);
+				const glm::vec3 a2(model[2]);
+				const glm::vec3 c0 = glm::cross(a1, a2);
+				const float inv_det = 1.f / glm::dot(a0, c0);
+				normal[0] = c0 * inv_det;
+				normal[1] = glm::cross(a2, a0) * inv_det;
+				normal[2] = glm::cross(a0, a1) * inv_det;
+			}
+		}
+
+		void compute_mvp_matrices_scalar(const float* view_projection, const float* models, const size_t model_stride, float* mvps, const size_t mvp_stride, const size_t count)
+		{
+			const glm::mat4& vp = *reinterpret_cast<const glm::mat4*>(view_projection);
+			for (size_t i = 0; i < count; ++i) {
+				const glm::mat4& model = *reinterpret_cast<const glm::mat4*>(reinterpret_cast<const unsigned char*>(models) + i * model_stride);
+				*reinterpret_cast<glm::mat4*>(reinterpret_cast<unsigned char*>(mvps) + i * mvp_stride) = vp * model;
+			}
+		}
+
+		void transform_aabbs_scalar(const float* models, const size_t model_stride, const AabbArrays& local, const AabbOutArrays& world, const size_t count)
+		{
+			for (size_t i = 0; i < count; ++i) {
+				const glm::mat4& model = *reinterpret_cast<const glm::mat4*>(reinterpret_cast<const unsigned char*>(models) + i * model_stride);
+				for (int row = 0; row < 3; ++row) {
+					float center = model[3][row];
+					float extent = 0.f;
+					for (int column = 0; column < 3; ++column) {
+						center += model[column][row] * local.center[column][i];
+						extent += std::abs(model[column][row]) * local.extent[column][i];
+					}
+					world.center[row][i] = center;
+					world.extent[row][i] = extent;
+				}
+			}
+		}
+
+		void test_spheres_planes_scalar(const float* planes, const size_t planes_count, const SphereArrays& spheres, uint8_t* visible, const size_t count)
+		{
+			for (size_t i = 0; i < count; ++i) {
+				bool inside = true;
+				for (size_t p = 0; p < planes_count && inside; ++p) {
+					const float* plane = planes + p * 4;
+					const float distance = plane[0] * spheres.center[0][i] + plane[1] * spheres.center[1][i] + plane[2] * spheres.center[2][i] + plane[3];
+					inside = distance >= -spheres.radius[i];
+				}
+				visible[i] = inside ? 1 : 0;
+			}
+		}
+
+		void test_spheres_aabb_scalar(const float* box_min, const float* box_max, const SphereArrays& spheres, uint8_t* visible, const size_t count)
+		{
+			for (size_t i = 0; i < count; ++i) {
+				// squared distance from center to the closest point of box
+				float distance_squared = 0.f;
+				for (int axis = 0; axis < 3; ++axis) {
+					const float center = spheres.center[axis][i];
+					const float closest = center < box_min[axis] ? box_min[axis] : (center > box_max[axis] ? box_max[axis] : center);
+					distance_squared += (center - closest) * (center - closest);
+				}
+				visible[i] = distance_squared <= spheres.radius[i] * spheres.radius[i] ? 1 : 0;
+			}
+		}
+
+		void rasterize_occluders_scalar(const OcclusionTriangle* triangles, const uint32_t* indices, const size_t count, const OcclusionTile& tile)
+		{
+			for (size_t t = 0; t < count; ++t) {
+				const OcclusionTriangle& triangle = triangles[indices[t]];
+				const int x0 = std::max(triangle.min_x, tile.x);
+				const int x1 = std::min(triangle.max_x, tile.x + tile.width - 1);
+				const int y0 = std::max(triangle.min_y, tile.y);
+				const int y1 = std::min(triangle.max_y, tile.y + tile.height - 1);
+				for (int y = y0; y <= y1; ++y) {
+					const float py = static_cast<float>(y) + 0.5f;
+					float row_edge[3];
+					for (int i = 0; i < 3; ++i) {
+						row_edge[i] = triangle.edge_b[i] * py + triangle.edge_c[i];
+					}
+					const float row_depth = triangle.depth_b * py + triangle.depth_c;
+					float* row = tile.depth + static_cast<size_t>(y - tile.y) * tile.stride;
+					for (int x = x0; x <= x1; ++x) {
+						const float px = static_cast<float>(x) + 0.5f;
+						if (triangle.edge_a[0] * px + row_edge[0] >= 0.f
+							&& triangle.edge_a[1] * px + row_edge[1] >= 0.f
+							&& triangle.edge_a[2] * px + row_edge[2] >= 0.f) {
+							float& depth = row[x - tile.x];
+							depth = std::max(depth, triangle.depth_a * px + row_depth);
+						}
+					}
+				}
+			}
+		}
+
+#ifdef SIMPLE_ENGINE_SIMD_X86
+		void cpuid(int info[4], const int function, const int subfunction)
+		{
+#ifdef _MSC_VER
+			__cpuidex(info, function, subfunction);
+#else
+			unsigned int a = 0, b = 0, c = 0, d = 0;
+			__cpuid_count(function, subfunction, a, b, c, d);
+			info[0] = static_cast<int>(a);
+			info[1] = static_cast<int>(b);
+			info[2] = static_cast<int>(c);
+			info[3] = static_cast<int>(d);
+#endif
+		}
+
+		// which registers OS saves on context switch
+		uint64_t read_xcr0()
+		{
+#ifdef _MSC_VER
+			return _xgetbv(0);
+#else
+			uint32_t eax = 0, edx = 0;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+		}
+#endif
+
+		SimdMath::Isa detect_isa()
+		{
+#ifdef SIMPLE_ENGINE_SIMD_X86
+			int info[4] = {};
+			cpuid(info, 0, 0);
+			const int max_function = info[0];
+			cpuid(info, 1, 0);
+			const bool sse41 = (info[2] & (1 << 19)) != 0;
+			const bool fma = (info[2] & (1 << 12)) != 0;
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			// ymm state has to be saved by OS, otherwise AVX instructions fault
+			const bool ymm_enabled = osxsave && (read_xcr0() & 6) == 6;
+			bool avx2 = false;
+			if (max_function >= 7) {
+				cpuid(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+			if (avx && avx2 && fma && ymm_enabled) {
+				return SimdMath::Isa::AVX2;
+			}
+			if (sse41) {
+				return SimdMath::Isa::SSE4;
+			}
+#endif
+			return SimdMath::Isa::Scalar;
+		}
+
+		const SimdKernelTable& get_kernels(const SimdMath::Isa isa)
+		{
+			switch (isa) {
+#ifdef SIMPLE_ENGINE_SIMD_X86
+			case SimdMath::Isa::AVX2: return get_avx2_kernels();
+			case SimdMath::Isa::SSE4: return get_sse4_kernels();
+#endif
+			default: return get_scalar_kernels();
+			}
+		}
+
+		struct Dispatch {
+			SimdMath::Isa best_isa;
+			std::atomic<SimdMath::Isa> isa;
+			std::atomic<const SimdKernelTable*> kernels;
+
+			Dispatch() : best_isa(detect_isa()), isa(best_isa), kernels(&get_kernels(best_isa)) {
+				LOG_INFO("SIMD math: {0}", SimdMath::get_isa_name(best_isa));
+			}
+		};
+
+		Dispatch& get_dispatch()
+		{
+			static Dispatch dispatch;
+			return dispatch;
+		}
+
+		TransformArrays offset_arrays(TransformArrays arrays, const size_t offset)
+		{
+			for (const float*& position : arrays.position) position += offset;
+			for (const float*& rotation : arrays.rotation) rotation += offset;
+			for (const float*& scale : arrays.scale) scale += offset;
+			return arrays;
+		}
+
+		AabbArrays offset_arrays(AabbArrays arrays, const size_t offset)
+		{
+			for (int i = 0; i < 3; ++i) {
+				arrays.center[i] += offset;
+				arrays.extent[i] += offset;
+			}
+			return arrays;
+		}
+
+		AabbOutArrays offset_arrays(AabbOutArrays arrays, const size_t offset)
+		{
+			for (int i = 0; i < 3; ++i) {
+				arrays.center[i] += offset;
+				arrays.extent[i] += offset;
+			}
+			return arrays;
+		}
+
+		SphereArrays offset_arrays(SphereArrays arrays, const size_t offset)
+		{
+			for (const float*& center : arrays.center) center += offset;
+			arrays.radius += offset;
+			return arrays;
+		}
+
+		// matrix arrays as floats for kernels, optionally skipping first objects
+		const float* as_floats(const void* matrices, const size_t stride = 0, const size_t skip = 0)
+		{
+			return reinterpret_cast<const float*>(static_cast<const unsigned char*>(matrices) + stride * skip);
+		}
+
+		float* as_floats(void* matrices, const size_t stride = 0, const size_t skip = 0)
+		{
+			return reinterpret_cast<float*>(static_cast<unsigned char*>(matrices) + stride * skip);
+		}
+	}
+
+	const SimdKernelTable& get_scalar_kernels()
+	{
+		static const SimdKernelTable kernels = {
+			1,
+			compose_model_matrices_scalar,
+			compute_normal_matrices_scalar,
+			compute_mvp_matrices_scalar,
+			transform_aabbs_scalar,
+			test_spheres_planes_scalar,
+			test_spheres_aabb_scalar,
+			rasterize_occluders_scalar
+		};
+		return kernels;
+	}
+
+	SimdMath::Isa SimdMath::get_isa()
+	{
+		return get_dispatch().isa.load(std::memory_order_relaxed);
+	}
+
+	SimdMath::Isa SimdMath::get_best_supported_isa()
+	{
+		return get_dispatch().best_isa;
+	}
+
+	void SimdMath::set_isa(const Isa isa)
+	{
+		Dispatch& dispatch = get_dispatch();
+		const Isa supported_isa = static_cast<int>(isa) > static_cast<int>(dispatch.best_isa) ? dispatch.best_isa : isa;
+		dispatch.isa.store(supported_isa, std::memory_order_relaxed);
+		dispatch.kernels.store(&get_kernels(supported_isa), std::memory_order_relaxed);
+	}
+
+	const char* SimdMath::get_isa_name(const Isa isa)
+	{
+		switch (isa) {
+		case Isa::AVX2: return "AVX2";
+		case Isa::SSE4: return "SSE4";
+		default: return "Scalar";
+		}
+	}
+
+	void SimdMath::compose_model_matrices(const TransformArrays& transforms, glm::mat4* models, const size_t count, const size_t model_stride)
+	{
+		const SimdKernelTable& kernels = *get_dispatch().kernels.load(std::memory_order_relaxed);
+		const size_t body = count - count % kernels.width;
+		kernels.compose_model_matrices(transforms, as_floats(models), model_stride, body);
+		compose_model_matrices_scalar(offset_arrays(transforms, body), as_floats(models, model_stride, body), model_stride, count - body);
+	}
+
+	void SimdMath::compute_normal_matrices(const glm::mat4* models, glm::mat3* normals, const size_t count, const size_t model_stride, const size_t normal_stride)
+	{
+		const SimdKernelTable& kernels = *get_dispatch().kernels.load(std::memory_order_relaxed);
+		const size_t body = count - count % kernels.width;
+		kernels.compute_normal_matrices(as_floats(models), model_stride, as_floats(normals), normal_stride, body);
+		compute_normal_matrices_scalar(as_floats(models, model_stride, body), model_stride,
+			as_floats(normals, normal_stride, body), normal_stride, count - body);
+	}
+
+	void SimdMath::compute_mvp_matrices(const glm::mat4& view_projection, const glm::mat4* models, glm::mat4* mvps, const size_t count,
+		const size_t model_stride, const size_t mvp_stride)
+	{
+		const SimdKernelTable& kernels = *get_dispatch().kernels.load(std::memory_order_relaxed);
+		const size_t body = count - count % kernels.width;
+		kernels.compute_mvp_matrices(as_floats(&view_projection), as_floats(models), model_stride, as_floats(mvps), mvp_stride, body);
+		compute_mvp_matrices_scalar(as_floats(&view_projection), as_floats(models, model_stride, body), model_stride,
+			as_floats(mvps, mvp_stride, body), mvp_stride, count - body);
+	}
+
+	void SimdMath::transform_aabbs(const glm::mat4* models, const AabbArrays& local, const AabbOutArrays& world, const size_t count,
+		const size_t model_stride)
+	{
+		const SimdKernelTable& kernels = *get_dispatch().kernels.load(std::memory_order_relaxed);
+		const size_t body = count - count % kernels.width;
+		kernels.transform_aabbs(as_floats(models), model_stride, local, world, body);
+		transform_aabbs_scalar(as_floats(models, model_stride, body), model_stride,
+			offset_arrays(local, body), offset_arrays(world, body), count - body);
+	}
+
+	void SimdMath::test_spheres_planes(const glm::vec4* planes, const size_t planes_count, const SphereArrays& spheres,
+		uint8_t* visible, const size_t count)
+	{
+		const SimdKernelTable& kernels = *get_dispatch().kernels.load(std::memory_order_relaxed);
+		const size_t body = count - count % kernels.width;
+		kernels.test_spheres_planes(as_floats(planes), planes_count, spheres, visible, body);
+		test_spheres_planes_scalar(as_floats(planes), planes_count, offset_arrays(spheres, body), visible + body, count - body);
+	}
+
+	void SimdMath::test_spheres_aabb(const glm::vec3& box_min, const glm::vec3& box_max, const SphereArrays& spheres,
+		uint8_t* visible, const size_t count)
+	{
+		const SimdKernelTable& kernels = *get_dispatch().kernels.load(std::memory_order_relaxed);
+		const size_t body = count - count % kernels.width;
+		kernels.test_spheres_aabb(&box_min.x, &box_max.x, spheres, visible, body);
+		test_spheres_aabb_scalar(&box_min.x, &box_max.x, offset_arrays(spheres, body), visible + body, count - body);
+	}
+
+	void SimdMath::rasterize_occluders(const OcclusionTriangle* triangles, const uint32_t* indices, const size_t count,
+		const OcclusionTile& tile)
+	{
+		get_dispatch().kernels.load(std::memory_order_relaxed)->rasterize_occluders(triangles, indices, count, tile);
+	}
+
+	void SimdMath::extract_frustum_planes(const glm::mat4& view_projection, glm::vec4 planes[6])
+	{
+		// rows of clip matrix: clip = vp * p, point is inside if -w <= x, y, z <= w
+		glm::vec4 rows[4];
+		for (int row = 0; row < 4; ++row) {
+			rows[row] = glm::vec4(view_projection[0][row], view_projection[1][row], view_projection[2][row], view_projection[3][row]);
+		}
+		planes[0] = rows[3] + rows[0];
+		planes[1] = rows[3] - rows[0];
+		planes[2] = rows[3] + rows[1];
+		planes[3] = rows[3] - rows[1];
+		planes[4] = rows[3] + rows[2];
+		planes[5] = rows[3] - rows[2];
+		for (int i = 0; i < 6; ++i) {
+			planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SimdKernels.h"
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace SimpleEngine {
+
+	// batch math for arrays of objects: SSE4 or AVX2 kernel is picked once from CPU features, scalar code otherwise
+	// results are the same as glm gives for every object (up to float rounding)
+	class SimdMath {
+	public:
+		enum class Isa {
+			Scalar,
+			SSE4,
+			AVX2
+		};
+
+		static Isa get_isa();
+		static Isa get_best_supported_isa();
+		// to compare implementations, isa which CPU doesn't support is clamped to the best supported one
+		static void set_isa(const Isa isa);
+		static const char* get_isa_name(const Isa isa);
+
+		// model = translate * rotate * scale
+		static void compose_model_matrices(const TransformArrays& transforms, glm::mat4* models, const size_t count,
+			const size_t model_stride = sizeof(glm::mat4));
+		// transpose(inverse(mat3(model)))
+		static void compute_normal_matrices(const glm::mat4* models, glm::mat3* normals, const size_t count,
+			const size_t model_stride = sizeof(glm::mat4), const size_t normal_stride = sizeof(glm::mat3));
+		// view_projection * model
+		static void compute_mvp_matrices(const glm::mat4& view_projection, const glm::mat4* models, glm::mat4* mvps, const size_t count,
+			const size_t model_stride = sizeof(glm::mat4), const size_t mvp_stride = sizeof(glm::mat4));
+		// smallest world space box around transformed local box
+		static void transform_aabbs(const glm::mat4* models, const AabbArrays& local, const AabbOutArrays& world, const size_t count,
+			const size_t model_stride = sizeof(glm::mat4));
+		// visible[i] = 1 if sphere i is at least partly in front of every plane
+		static void test_spheres_planes(const glm::vec4* planes, const size_t planes_count, const SphereArrays& spheres,
+			uint8_t* visible, const size_t count);
+		// visible[i] = 1 if sphere i touches box
+		static void test_spheres_aabb(const glm::vec3& box_min, const glm::vec3& box_max, const SphereArrays& spheres,
+			uint8_t* visible, const size_t count);
+		// depth of triangles[indices[i]] into tile, closer (bigger 1 / w) wins
+		static void rasterize_occluders(const OcclusionTriangle* triangles, const uint32_t* indices, const size_t count,
+			const OcclusionTile& tile);
+
+		// normalized planes (xyz - normal looking inside, w - distance): left, right, bottom, top, near, far
+		static void extract_frustum_planes(const glm::mat4& view_projection, glm::vec4 planes[6]);
+	};
+}
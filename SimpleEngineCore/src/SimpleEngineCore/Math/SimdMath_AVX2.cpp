@@ -0,0 +1,293 @@
+#include "SimdKernels.h"
+
+// built with -mavx2 -mfma (see CMakeLists.txt), called only after CPU check
+#ifdef SIMPLE_ENGINE_SIMD_X86
+
+#include <immintrin.h>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// not std::min/max: inline functions from headers could be shared with code built without this instruction set
+		inline int min_int(const int a, const int b) { return a < b ? a : b; }
+		inline int max_int(const int a, const int b) { return a > b ? a : b; }
+
+		inline const float* at(const float* base, const size_t stride, const size_t index) {
+			return reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(base) + stride * index);
+		}
+
+		inline float* at(float* base, const size_t stride, const size_t index) {
+			return reinterpret_cast<float*>(reinterpret_cast<unsigned char*>(base) + stride * index);
+		}
+
+		// 4x4 transpose inside of each 128 bit half
+		inline void transpose_halves(__m256& r0, __m256& r1, __m256& r2, __m256& r3) {
+			const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+			const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+			const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+			const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+			r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+			r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+			r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		inline __m256 load_pair(const float* low, const float* high) {
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+		}
+
+		inline void store_pair(float* low, float* high, const __m256 value) {
+			_mm_storeu_ps(low, _mm256_castps256_ps128(value));
+			_mm_storeu_ps(high, _mm256_extractf128_ps(value, 1));
+		}
+
+		// column of 8 matrices -> e[row] holds this element of all 8 matrices
+		inline void load_column_transposed(const float* models, const size_t stride, const size_t first, const int column, __m256 e[4]) {
+			for (size_t k = 0; k < 4; ++k) {
+				e[k] = load_pair(at(models, stride, first + k) + column * 4, at(models, stride, first + k + 4) + column * 4);
+			}
+			transpose_halves(e[0], e[1], e[2], e[3]);
+		}
+
+		// e[row] holds element of 8 matrices -> column of every matrix
+		inline void store_column_transposed(float* models, const size_t stride, const size_t first, const int column,
+			__m256 r0, __m256 r1, __m256 r2, __m256 r3) {
+			transpose_halves(r0, r1, r2, r3);
+			store_pair(at(models, stride, first + 0) + column * 4, at(models, stride, first + 4) + column * 4, r0);
+			store_pair(at(models, stride, first + 1) + column * 4, at(models, stride, first + 5) + column * 4, r1);
+			store_pair(at(models, stride, first + 2) + column * 4, at(models, stride, first + 6) + column * 4, r2);
+			store_pair(at(models, stride, first + 3) + column * 4, at(models, stride, first + 7) + column * 4, r3);
+		}
+
+		void compose_model_matrices(const TransformArrays& transforms, float* models, const size_t model_stride, const size_t count)
+		{
+			const __m256 one = _mm256_set1_ps(1.f);
+			const __m256 two = _mm256_set1_ps(2.f);
+			const __m256 zero = _mm256_setzero_ps();
+			for (size_t i = 0; i < count; i += 8) {
+				const __m256 x = _mm256_loadu_ps(transforms.rotation[0] + i);
+				const __m256 y = _mm256_loadu_ps(transforms.rotation[1] + i);
+				const __m256 z = _mm256_loadu_ps(transforms.rotation[2] + i);
+				const __m256 w = _mm256_loadu_ps(transforms.rotation[3] + i);
+				const __m256 sx = _mm256_loadu_ps(transforms.scale[0] + i);
+				const __m256 sy = _mm256_loadu_ps(transforms.scale[1] + i);
+				const __m256 sz = _mm256_loadu_ps(transforms.scale[2] + i);
+
+				const __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+				const __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+				const __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+				store_column_transposed(models, model_stride, i, 0,
+					_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+					_mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+					_mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+					zero);
+				store_column_transposed(models, model_stride, i, 1,
+					_mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+					_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+					_mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+					zero);
+				store_column_transposed(models, model_stride, i, 2,
+					_mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+					_mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+					_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+					zero);
+				store_column_transposed(models, model_stride, i, 3,
+					_mm256_loadu_ps(transforms.position[0] + i),
+					_mm256_loadu_ps(transforms.position[1] + i),
+					_mm256_loadu_ps(transforms.position[2] + i),
+					one);
+			}
+		}
+
+		void compute_normal_matrices(const float* models, const size_t model_stride, float* normals, const size_t normal_stride, const size_t count)
+		{
+			const __m256 one = _mm256_set1_ps(1.f);
+			for (size_t i = 0; i < count; i += 8) {
+				__m256 a0[4], a1[4], a2[4];
+				load_column_transposed(models, model_stride, i, 0, a0);
+				load_column_transposed(models, model_stride, i, 1, a1);
+				load_column_transposed(models, model_stride, i, 2, a2);
+
+				// columns of inverse transpose: cross(a1, a2), cross(a2, a0), cross(a0, a1) divided by determinant
+				__m256 e[9];
+				e[0] = _mm256_fmsub_ps(a1[1], a2[2], _mm256_mul_ps(a1[2], a2[1]));
+				e[1] = _mm256_fmsub_ps(a1[2], a2[0], _mm256_mul_ps(a1[0], a2[2]));
+				e[2] = _mm256_fmsub_ps(a1[0], a2[1], _mm256_mul_ps(a1[1], a2[0]));
+				e[3] = _mm256_fmsub_ps(a2[1], a0[2], _mm256_mul_ps(a2[2], a0[1]));
+				e[4] = _mm256_fmsub_ps(a2[2], a0[0], _mm256_mul_ps(a2[0], a0[2]));
+				e[5] = _mm256_fmsub_ps(a2[0], a0[1], _mm256_mul_ps(a2[1], a0[0]));
+				e[6] = _mm256_fmsub_ps(a0[1], a1[2], _mm256_mul_ps(a0[2], a1[1]));
+				e[7] = _mm256_fmsub_ps(a0[2], a1[0], _mm256_mul_ps(a0[0], a1[2]));
+				e[8] = _mm256_fmsub_ps(a0[0], a1[1], _mm256_mul_ps(a0[1], a1[0]));
+				const __m256 det = _mm256_fmadd_ps(a0[2], e[2], _mm256_fmadd_ps(a0[1], e[1], _mm256_mul_ps(a0[0], e[0])));
+				const __m256 inv_det = _mm256_div_ps(one, det);
+				for (__m256& element : e) {
+					element = _mm256_mul_ps(element, inv_det);
+				}
+
+				// mat3 is 9 floats: elements 0-3 and 4-7 are transposed as 4x4 blocks, the last one is stored alone
+				transpose_halves(e[0], e[1], e[2], e[3]);
+				transpose_halves(e[4], e[5], e[6], e[7]);
+				alignas(32) float last[8];
+				_mm256_store_ps(last, e[8]);
+				for (size_t k = 0; k < 4; ++k) {
+					float* low = at(normals, normal_stride, i + k);
+					float* high = at(normals, normal_stride, i + k + 4);
+					store_pair(low, high, e[k]);
+					store_pair(low + 4, high + 4, e[4 + k]);
+					low[8] = last[k];
+					high[8] = last[k + 4];
+				}
+			}
+		}
+
+		void compute_mvp_matrices(const float* view_projection, const float* models, const size_t model_stride, float* mvps, const size_t mvp_stride, const size_t count)
+		{
+			// the same view projection column in both halves, two model columns are multiplied at once
+			const __m256 vp0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_projection + 0));
+			const __m256 vp1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_projection + 4));
+			const __m256 vp2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_projection + 8));
+			const __m256 vp3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_projection + 12));
+			for (size_t i = 0; i < count; ++i) {
+				const float* model = at(models, model_stride, i);
+				float* mvp = at(mvps, mvp_stride, i);
+				for (int column = 0; column < 4; column += 2) {
+					const __m256 m = _mm256_loadu_ps(model + column * 4);
+					__m256 r = _mm256_mul_ps(vp0, _mm256_permute_ps(m, _MM_SHUFFLE(0, 0, 0, 0)));
+					r = _mm256_fmadd_ps(vp1, _mm256_permute_ps(m, _MM_SHUFFLE(1, 1, 1, 1)), r);
+					r = _mm256_fmadd_ps(vp2, _mm256_permute_ps(m, _MM_SHUFFLE(2, 2, 2, 2)), r);
+					r = _mm256_fmadd_ps(vp3, _mm256_permute_ps(m, _MM_SHUFFLE(3, 3, 3, 3)), r);
+					_mm256_storeu_ps(mvp + column * 4, r);
+				}
+			}
+		}
+
+		void transform_aabbs(const float* models, const size_t model_stride, const AabbArrays& local, const AabbOutArrays& world, const size_t count)
+		{
+			const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+			for (size_t i = 0; i < count; i += 8) {
+				__m256 m[4][4];
+				for (int column = 0; column < 4; ++column) {
+					load_column_transposed(models, model_stride, i, column, m[column]);
+				}
+				const __m256 cx = _mm256_loadu_ps(local.center[0] + i);
+				const __m256 cy = _mm256_loadu_ps(local.center[1] + i);
+				const __m256 cz = _mm256_loadu_ps(local.center[2] + i);
+				const __m256 ex = _mm256_loadu_ps(local.extent[0] + i);
+				const __m256 ey = _mm256_loadu_ps(local.extent[1] + i);
+				const __m256 ez = _mm256_loadu_ps(local.extent[2] + i);
+				for (int row = 0; row < 3; ++row) {
+					__m256 center = _mm256_fmadd_ps(m[0][row], cx, m[3][row]);
+					center = _mm256_fmadd_ps(m[1][row], cy, center);
+					center = _mm256_fmadd_ps(m[2][row], cz, center);
+					__m256 extent = _mm256_mul_ps(_mm256_and_ps(m[0][row], abs_mask), ex);
+					extent = _mm256_fmadd_ps(_mm256_and_ps(m[1][row], abs_mask), ey, extent);
+					extent = _mm256_fmadd_ps(_mm256_and_ps(m[2][row], abs_mask), ez, extent);
+					_mm256_storeu_ps(world.center[row] + i, center);
+					_mm256_storeu_ps(world.extent[row] + i, extent);
+				}
+			}
+		}
+
+		void test_spheres_planes(const float* planes, const size_t planes_count, const SphereArrays& spheres, uint8_t* visible, const size_t count)
+		{
+			for (size_t i = 0; i < count; i += 8) {
+				const __m256 cx = _mm256_loadu_ps(spheres.center[0] + i);
+				const __m256 cy = _mm256_loadu_ps(spheres.center[1] + i);
+				const __m256 cz = _mm256_loadu_ps(spheres.center[2] + i);
+				const __m256 negative_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (size_t p = 0; p < planes_count; ++p) {
+					const float* plane = planes + p * 4;
+					__m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(plane[0]), cx, _mm256_set1_ps(plane[3]));
+					distance = _mm256_fmadd_ps(_mm256_set1_ps(plane[1]), cy, distance);
+					distance = _mm256_fmadd_ps(_mm256_set1_ps(plane[2]), cz, distance);
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+				}
+				const int mask = _mm256_movemask_ps(inside);
+				for (size_t k = 0; k < 8; ++k) {
+					visible[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+				}
+			}
+		}
+
+		void test_spheres_aabb(const float* box_min, const float* box_max, const SphereArrays& spheres, uint8_t* visible, const size_t count)
+		{
+			const __m256 min_x = _mm256_set1_ps(box_min[0]), min_y = _mm256_set1_ps(box_min[1]), min_z = _mm256_set1_ps(box_min[2]);
+			const __m256 max_x = _mm256_set1_ps(box_max[0]), max_y = _mm256_set1_ps(box_max[1]), max_z = _mm256_set1_ps(box_max[2]);
+			for (size_t i = 0; i < count; i += 8) {
+				const __m256 cx = _mm256_loadu_ps(spheres.center[0] + i);
+				const __m256 cy = _mm256_loadu_ps(spheres.center[1] + i);
+				const __m256 cz = _mm256_loadu_ps(spheres.center[2] + i);
+				const __m256 r = _mm256_loadu_ps(spheres.radius + i);
+				// center minus closest point of box
+				const __m256 dx = _mm256_sub_ps(cx, _mm256_min_ps(_mm256_max_ps(cx, min_x), max_x));
+				const __m256 dy = _mm256_sub_ps(cy, _mm256_min_ps(_mm256_max_ps(cy, min_y), max_y));
+				const __m256 dz = _mm256_sub_ps(cz, _mm256_min_ps(_mm256_max_ps(cz, min_z), max_z));
+				__m256 distance_squared = _mm256_mul_ps(dx, dx);
+				distance_squared = _mm256_fmadd_ps(dy, dy, distance_squared);
+				distance_squared = _mm256_fmadd_ps(dz, dz, distance_squared);
+				const int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance_squared, _mm256_mul_ps(r, r), _CMP_LE_OQ));
+				for (size_t k = 0; k < 8; ++k) {
+					visible[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+				}
+			}
+		}
+		void rasterize_occluders(const OcclusionTriangle* triangles, const uint32_t* indices, const size_t count, const OcclusionTile& tile)
+		{
+			const __m256 pixel_offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			const __m256 zero = _mm256_setzero_ps();
+			for (size_t t = 0; t < count; ++t) {
+				const OcclusionTriangle& triangle = triangles[indices[t]];
+				const int x0 = max_int(triangle.min_x, tile.x);
+				const int x1 = min_int(triangle.max_x, tile.x + tile.width - 1);
+				const int y0 = max_int(triangle.min_y, tile.y);
+				const int y1 = min_int(triangle.max_y, tile.y + tile.height - 1);
+				// 8 pixels at once from aligned column, tile width is multiple of 8 so it never writes outside
+				const int first_x = tile.x + ((x0 - tile.x) & ~7);
+				const __m256 a0 = _mm256_set1_ps(triangle.edge_a[0]);
+				const __m256 a1 = _mm256_set1_ps(triangle.edge_a[1]);
+				const __m256 a2 = _mm256_set1_ps(triangle.edge_a[2]);
+				const __m256 depth_a = _mm256_set1_ps(triangle.depth_a);
+				for (int y = y0; y <= y1; ++y) {
+					const float py = static_cast<float>(y) + 0.5f;
+					const __m256 row0 = _mm256_set1_ps(triangle.edge_b[0] * py + triangle.edge_c[0]);
+					const __m256 row1 = _mm256_set1_ps(triangle.edge_b[1] * py + triangle.edge_c[1]);
+					const __m256 row2 = _mm256_set1_ps(triangle.edge_b[2] * py + triangle.edge_c[2]);
+					const __m256 row_depth = _mm256_set1_ps(triangle.depth_b * py + triangle.depth_c);
+					float* row = tile.depth + static_cast<size_t>(y - tile.y) * tile.stride;
+					for (int x = first_x; x <= x1; x += 8) {
+						const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), pixel_offsets);
+						const __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, px), row0);
+						const __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, px), row1);
+						const __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, px), row2);
+						const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_and_ps(_mm256_cmp_ps(e1, zero, _CMP_GE_OQ), _mm256_cmp_ps(e2, zero, _CMP_GE_OQ)));
+						// depth is positive, outside pixels get 0 and max keeps what was there
+						const __m256 depth = _mm256_and_ps(inside, _mm256_add_ps(_mm256_mul_ps(depth_a, px), row_depth));
+						float* pixels = row + (x - tile.x);
+						_mm256_storeu_ps(pixels, _mm256_max_ps(_mm256_loadu_ps(pixels), depth));
+					}
+				}
+			}
+		}
+	}
+
+	const SimdKernelTable& get_avx2_kernels()
+	{
+		static const SimdKernelTable kernels = {
+			8,
+			compose_model_matrices,
+			compute_normal_matrices,
+			compute_mvp_matrices,
+			transform_aabbs,
+			test_spheres_planes,
+			test_spheres_aabb,
+			rasterize_occluders
+		};
+		return kernels;
+	}
+}
+
+#endif
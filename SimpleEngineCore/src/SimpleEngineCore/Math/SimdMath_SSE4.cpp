@@ -0,0 +1,271 @@
+#include "SimdKernels.h"
+
+// built with -msse4.1 (see CMakeLists.txt), called only after CPU check
+#ifdef SIMPLE_ENGINE_SIMD_X86
+
+#include <smmintrin.h>
+
+namespace SimpleEngine {
+
+	namespace {
+
+		// not std::min/max: inline functions from headers could be shared with code built without this instruction set
+		inline int min_int(const int a, const int b) { return a < b ? a : b; }
+		inline int max_int(const int a, const int b) { return a > b ? a : b; }
+
+		inline const float* at(const float* base, const size_t stride, const size_t index) {
+			return reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(base) + stride * index);
+		}
+
+		inline float* at(float* base, const size_t stride, const size_t index) {
+			return reinterpret_cast<float*>(reinterpret_cast<unsigned char*>(base) + stride * index);
+		}
+
+		// column of 4 matrices -> e[row] holds this element of all 4 matrices
+		inline void load_column_transposed(const float* models, const size_t stride, const size_t first, const int column, __m128 e[4]) {
+			e[0] = _mm_loadu_ps(at(models, stride, first + 0) + column * 4);
+			e[1] = _mm_loadu_ps(at(models, stride, first + 1) + column * 4);
+			e[2] = _mm_loadu_ps(at(models, stride, first + 2) + column * 4);
+			e[3] = _mm_loadu_ps(at(models, stride, first + 3) + column * 4);
+			_MM_TRANSPOSE4_PS(e[0], e[1], e[2], e[3]);
+		}
+
+		// e[row] holds element of 4 matrices -> column of every matrix
+		inline void store_column_transposed(float* models, const size_t stride, const size_t first, const int column,
+			__m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(at(models, stride, first + 0) + column * 4, r0);
+			_mm_storeu_ps(at(models, stride, first + 1) + column * 4, r1);
+			_mm_storeu_ps(at(models, stride, first + 2) + column * 4, r2);
+			_mm_storeu_ps(at(models, stride, first + 3) + column * 4, r3);
+		}
+
+		void compose_model_matrices(const TransformArrays& transforms, float* models, const size_t model_stride, const size_t count)
+		{
+			const __m128 one = _mm_set1_ps(1.f);
+			const __m128 two = _mm_set1_ps(2.f);
+			const __m128 zero = _mm_setzero_ps();
+			for (size_t i = 0; i < count; i += 4) {
+				const __m128 x = _mm_loadu_ps(transforms.rotation[0] + i);
+				const __m128 y = _mm_loadu_ps(transforms.rotation[1] + i);
+				const __m128 z = _mm_loadu_ps(transforms.rotation[2] + i);
+				const __m128 w = _mm_loadu_ps(transforms.rotation[3] + i);
+				const __m128 sx = _mm_loadu_ps(transforms.scale[0] + i);
+				const __m128 sy = _mm_loadu_ps(transforms.scale[1] + i);
+				const __m128 sz = _mm_loadu_ps(transforms.scale[2] + i);
+
+				const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+				const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+				const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+				store_column_transposed(models, model_stride, i, 0,
+					_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+					_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+					_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+					zero);
+				store_column_transposed(models, model_stride, i, 1,
+					_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+					_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+					_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+					zero);
+				store_column_transposed(models, model_stride, i, 2,
+					_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+					_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+					_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+					zero);
+				store_column_transposed(models, model_stride, i, 3,
+					_mm_loadu_ps(transforms.position[0] + i),
+					_mm_loadu_ps(transforms.position[1] + i),
+					_mm_loadu_ps(transforms.position[2] + i),
+					one);
+			}
+		}
+
+		void compute_normal_matrices(const float* models, const size_t model_stride, float* normals, const size_t normal_stride, const size_t count)
+		{
+			const __m128 one = _mm_set1_ps(1.f);
+			for (size_t i = 0; i < count; i += 4) {
+				__m128 a0[4], a1[4], a2[4];
+				load_column_transposed(models, model_stride, i, 0, a0);
+				load_column_transposed(models, model_stride, i, 1, a1);
+				load_column_transposed(models, model_stride, i, 2, a2);
+
+				// columns of inverse transpose: cross(a1, a2), cross(a2, a0), cross(a0, a1) divided by determinant
+				__m128 e[9];
+				e[0] = _mm_sub_ps(_mm_mul_ps(a1[1], a2[2]), _mm_mul_ps(a1[2], a2[1]));
+				e[1] = _mm_sub_ps(_mm_mul_ps(a1[2], a2[0]), _mm_mul_ps(a1[0], a2[2]));
+				e[2] = _mm_sub_ps(_mm_mul_ps(a1[0], a2[1]), _mm_mul_ps(a1[1], a2[0]));
+				e[3] = _mm_sub_ps(_mm_mul_ps(a2[1], a0[2]), _mm_mul_ps(a2[2], a0[1]));
+				e[4] = _mm_sub_ps(_mm_mul_ps(a2[2], a0[0]), _mm_mul_ps(a2[0], a0[2]));
+				e[5] = _mm_sub_ps(_mm_mul_ps(a2[0], a0[1]), _mm_mul_ps(a2[1], a0[0]));
+				e[6] = _mm_sub_ps(_mm_mul_ps(a0[1], a1[2]), _mm_mul_ps(a0[2], a1[1]));
+				e[7] = _mm_sub_ps(_mm_mul_ps(a0[2], a1[0]), _mm_mul_ps(a0[0], a1[2]));
+				e[8] = _mm_sub_ps(_mm_mul_ps(a0[0], a1[1]), _mm_mul_ps(a0[1], a1[0]));
+				const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0[0], e[0]), _mm_mul_ps(a0[1], e[1])), _mm_mul_ps(a0[2], e[2]));
+				const __m128 inv_det = _mm_div_ps(one, det);
+				for (__m128& element : e) {
+					element = _mm_mul_ps(element, inv_det);
+				}
+
+				// mat3 is 9 floats: elements 0-3 and 4-7 are transposed as 4x4 blocks, the last one is stored alone
+				_MM_TRANSPOSE4_PS(e[0], e[1], e[2], e[3]);
+				_MM_TRANSPOSE4_PS(e[4], e[5], e[6], e[7]);
+				alignas(16) float last[4];
+				_mm_store_ps(last, e[8]);
+				for (size_t k = 0; k < 4; ++k) {
+					float* normal = at(normals, normal_stride, i + k);
+					_mm_storeu_ps(normal, e[k]);
+					_mm_storeu_ps(normal + 4, e[4 + k]);
+					normal[8] = last[k];
+				}
+			}
+		}
+
+		void compute_mvp_matrices(const float* view_projection, const float* models, const size_t model_stride, float* mvps, const size_t mvp_stride, const size_t count)
+		{
+			const __m128 vp0 = _mm_loadu_ps(view_projection + 0);
+			const __m128 vp1 = _mm_loadu_ps(view_projection + 4);
+			const __m128 vp2 = _mm_loadu_ps(view_projection + 8);
+			const __m128 vp3 = _mm_loadu_ps(view_projection + 12);
+			for (size_t i = 0; i < count; ++i) {
+				const float* model = at(models, model_stride, i);
+				float* mvp = at(mvps, mvp_stride, i);
+				for (int column = 0; column < 4; ++column) {
+					const __m128 m = _mm_loadu_ps(model + column * 4);
+					__m128 r = _mm_mul_ps(vp0, _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 0)));
+					r = _mm_add_ps(r, _mm_mul_ps(vp1, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1))));
+					r = _mm_add_ps(r, _mm_mul_ps(vp2, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2))));
+					r = _mm_add_ps(r, _mm_mul_ps(vp3, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3))));
+					_mm_storeu_ps(mvp + column * 4, r);
+				}
+			}
+		}
+
+		void transform_aabbs(const float* models, const size_t model_stride, const AabbArrays& local, const AabbOutArrays& world, const size_t count)
+		{
+			const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+			for (size_t i = 0; i < count; i += 4) {
+				__m128 m[4][4];
+				for (int column = 0; column < 4; ++column) {
+					load_column_transposed(models, model_stride, i, column, m[column]);
+				}
+				const __m128 cx = _mm_loadu_ps(local.center[0] + i);
+				const __m128 cy = _mm_loadu_ps(local.center[1] + i);
+				const __m128 cz = _mm_loadu_ps(local.center[2] + i);
+				const __m128 ex = _mm_loadu_ps(local.extent[0] + i);
+				const __m128 ey = _mm_loadu_ps(local.extent[1] + i);
+				const __m128 ez = _mm_loadu_ps(local.extent[2] + i);
+				for (int row = 0; row < 3; ++row) {
+					__m128 center = _mm_add_ps(m[3][row], _mm_mul_ps(m[0][row], cx));
+					center = _mm_add_ps(center, _mm_mul_ps(m[1][row], cy));
+					center = _mm_add_ps(center, _mm_mul_ps(m[2][row], cz));
+					__m128 extent = _mm_mul_ps(_mm_and_ps(m[0][row], abs_mask), ex);
+					extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(m[1][row], abs_mask), ey));
+					extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(m[2][row], abs_mask), ez));
+					_mm_storeu_ps(world.center[row] + i, center);
+					_mm_storeu_ps(world.extent[row] + i, extent);
+				}
+			}
+		}
+
+		void test_spheres_planes(const float* planes, const size_t planes_count, const SphereArrays& spheres, uint8_t* visible, const size_t count)
+		{
+			for (size_t i = 0; i < count; i += 4) {
+				const __m128 cx = _mm_loadu_ps(spheres.center[0] + i);
+				const __m128 cy = _mm_loadu_ps(spheres.center[1] + i);
+				const __m128 cz = _mm_loadu_ps(spheres.center[2] + i);
+				const __m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (size_t p = 0; p < planes_count; ++p) {
+					const float* plane = planes + p * 4;
+					__m128 distance = _mm_mul_ps(_mm_set1_ps(plane[0]), cx);
+					distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[1]), cy));
+					distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[2]), cz));
+					distance = _mm_add_ps(distance, _mm_set1_ps(plane[3]));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+				}
+				const int mask = _mm_movemask_ps(inside);
+				for (size_t k = 0; k < 4; ++k) {
+					visible[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+				}
+			}
+		}
+
+		void test_spheres_aabb(const float* box_min, const float* box_max, const SphereArrays& spheres, uint8_t* visible, const size_t count)
+		{
+			const __m128 min_x = _mm_set1_ps(box_min[0]), min_y = _mm_set1_ps(box_min[1]), min_z = _mm_set1_ps(box_min[2]);
+			const __m128 max_x = _mm_set1_ps(box_max[0]), max_y = _mm_set1_ps(box_max[1]), max_z = _mm_set1_ps(box_max[2]);
+			for (size_t i = 0; i < count; i += 4) {
+				const __m128 cx = _mm_loadu_ps(spheres.center[0] + i);
+				const __m128 cy = _mm_loadu_ps(spheres.center[1] + i);
+				const __m128 cz = _mm_loadu_ps(spheres.center[2] + i);
+				const __m128 r = _mm_loadu_ps(spheres.radius + i);
+				// center minus closest point of box
+				const __m128 dx = _mm_sub_ps(cx, _mm_min_ps(_mm_max_ps(cx, min_x), max_x));
+				const __m128 dy = _mm_sub_ps(cy, _mm_min_ps(_mm_max_ps(cy, min_y), max_y));
+				const __m128 dz = _mm_sub_ps(cz, _mm_min_ps(_mm_max_ps(cz, min_z), max_z));
+				__m128 distance_squared = _mm_mul_ps(dx, dx);
+				distance_squared = _mm_add_ps(distance_squared, _mm_mul_ps(dy, dy));
+				distance_squared = _mm_add_ps(distance_squared, _mm_mul_ps(dz, dz));
+				const int mask = _mm_movemask_ps(_mm_cmple_ps(distance_squared, _mm_mul_ps(r, r)));
+				for (size_t k = 0; k < 4; ++k) {
+					visible[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+				}
+			}
+		}
+		void rasterize_occluders(const OcclusionTriangle* triangles, const uint32_t* indices, const size_t count, const OcclusionTile& tile)
+		{
+			const __m128 pixel_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 zero = _mm_setzero_ps();
+			for (size_t t = 0; t < count; ++t) {
+				const OcclusionTriangle& triangle = triangles[indices[t]];
+				const int x0 = max_int(triangle.min_x, tile.x);
+				const int x1 = min_int(triangle.max_x, tile.x + tile.width - 1);
+				const int y0 = max_int(triangle.min_y, tile.y);
+				const int y1 = min_int(triangle.max_y, tile.y + tile.height - 1);
+				// 4 pixels at once from aligned column, tile width is multiple of 4 so it never writes outside
+				const int first_x = tile.x + ((x0 - tile.x) & ~3);
+				const __m128 a0 = _mm_set1_ps(triangle.edge_a[0]);
+				const __m128 a1 = _mm_set1_ps(triangle.edge_a[1]);
+				const __m128 a2 = _mm_set1_ps(triangle.edge_a[2]);
+				const __m128 depth_a = _mm_set1_ps(triangle.depth_a);
+				for (int y = y0; y <= y1; ++y) {
+					const float py = static_cast<float>(y) + 0.5f;
+					const __m128 row0 = _mm_set1_ps(triangle.edge_b[0] * py + triangle.edge_c[0]);
+					const __m128 row1 = _mm_set1_ps(triangle.edge_b[1] * py + triangle.edge_c[1]);
+					const __m128 row2 = _mm_set1_ps(triangle.edge_b[2] * py + triangle.edge_c[2]);
+					const __m128 row_depth = _mm_set1_ps(triangle.depth_b * py + triangle.depth_c);
+					float* row = tile.depth + static_cast<size_t>(y - tile.y) * tile.stride;
+					for (int x = first_x; x <= x1; x += 4) {
+						const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixel_offsets);
+						const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), row0);
+						const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), row1);
+						const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), row2);
+						const __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+						// depth is positive, outside pixels get 0 and max keeps what was there
+						const __m128 depth = _mm_and_ps(inside, _mm_add_ps(_mm_mul_ps(depth_a, px), row_depth));
+						float* pixels = row + (x - tile.x);
+						_mm_storeu_ps(pixels, _mm_max_ps(_mm_loadu_ps(pixels), depth));
+					}
+				}
+			}
+		}
+	}
+
+	const SimdKernelTable& get_sse4_kernels()
+	{
+		static const SimdKernelTable kernels = {
+			4,
+			compose_model_matrices,
+			compute_normal_matrices,
+			compute_mvp_matrices,
+			transform_aabbs,
+			test_spheres_planes,
+			test_spheres_aabb,
+			rasterize_occluders
+		};
+		return kernels;
+	}
+}
+
+#endif
@@ -0,0 +1,428 @@
+#include "AllocationTracker.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if SIMPLE_ENGINE_ALLOCATION_HOOKS
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <dbghelp.h>
+#include <malloc.h>
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+#else
+#include <cxxabi.h>
+#include <execinfo.h>
+#endif
+#endif
+
+namespace SimpleEngine {
+
+	namespace {
+		// trivial and constant initialized, so access from allocator never runs thread_local constructor
+		struct ThreadState {
+			uint64_t allocations;
+			uint64_t frees;
+			uint64_t allocated_bytes;
+			const char* zone;	// inside of no-alloc zone when not null
+			bool in_hook;		// heap calls of hook itself (stack capture, CRT inside operator new) are not counted
+		};
+		thread_local ThreadState t_state{};
+
+#if SIMPLE_ENGINE_ALLOCATION_HOOKS
+		constexpr size_t s_max_violations = 32;
+		constexpr int s_max_frames = 24;
+
+		// violations with the same call stack share one record
+		struct Violation {
+			std::atomic<bool> ready{ false };
+			std::atomic<uint64_t> hits{ 0 };
+			uint64_t stack_hash = 0;
+			const char* zone = nullptr;
+			size_t size = 0;
+			bool is_free = false;
+			int frames_count = 0;
+			void* frames[s_max_frames] = {};
+		};
+
+		Violation s_violations[s_max_violations];
+		std::atomic<size_t> s_claimed_violations{ 0 };
+		std::atomic<uint64_t> s_violations_count{ 0 };
+		size_t s_reported_violations = 0;	// report_violations only
+
+		class HookGuard {
+		public:
+			HookGuard() : m_previous(t_state.in_hook) { t_state.in_hook = true; }
+			~HookGuard() { t_state.in_hook = m_previous; }
+		private:
+			bool m_previous;
+		};
+
+		int capture_stack(void** frames, const int max_frames) {
+#if defined(_WIN32)
+			return static_cast<int>(CaptureStackBackTrace(0, static_cast<DWORD>(max_frames), frames, nullptr));
+#else
+			return backtrace(frames, max_frames);
+#endif
+		}
+
+		void record_violation(const size_t size, const bool is_free) {
+			s_violations_count.fetch_add(1, std::memory_order_relaxed);
+
+			HookGuard guard;
+			void* frames[s_max_frames];
+			const int frames_count = capture_stack(frames, s_max_frames);
+			uint64_t stack_hash = 14695981039346656037ull;
+			for (int i = 0; i < frames_count; ++i) {
+				stack_hash = (stack_hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+			}
+
+			const size_t claimed = s_claimed_violations.load(std::memory_order_acquire);
+			for (size_t i = 0; i < claimed && i < s_max_violations; ++i) {
+				Violation& violation = s_violations[i];
+				if (violation.ready.load(std::memory_order_acquire) && violation.stack_hash == stack_hash) {
+					violation.hits.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+			const size_t index = s_claimed_violations.fetch_add(1, std::memory_order_acq_rel);
+			if (index >= s_max_violations) {
+				return;
+			}
+			Violation& violation = s_violations[index];
+			violation.stack_hash = stack_hash;
+			violation.zone = t_state.zone;
+			violation.size = size;
+			violation.is_free = is_free;
+			violation.frames_count = frames_count;
+			for (int i = 0; i < frames_count; ++i) {
+				violation.frames[i] = frames[i];
+			}
+			violation.hits.store(1, std::memory_order_relaxed);
+			violation.ready.store(true, std::memory_order_release);
+		}
+
+		void on_allocate(const size_t size) {
+			ThreadState& state = t_state;
+			if (state.in_hook) {
+				return;
+			}
+			++state.allocations;
+			state.allocated_bytes += size;
+			if (state.zone != nullptr) {
+				record_violation(size, false);
+			}
+		}
+
+		void on_free(void* ptr) {
+			ThreadState& state = t_state;
+			if (ptr == nullptr || state.in_hook) {
+				return;
+			}
+			++state.frees;
+			if (state.zone != nullptr) {
+				record_violation(0, true);
+			}
+		}
+
+		// operator new goes to C runtime under guard, so malloc hook doesn't count it twice
+		void* allocate_counted(const size_t size) {
+			on_allocate(size);
+			HookGuard guard;
+			return std::malloc(size > 0 ? size : 1);
+		}
+
+		void* allocate_aligned_counted(const size_t size, const size_t alignment) {
+			on_allocate(size);
+			HookGuard guard;
+#if defined(_WIN32)
+			return _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+			void* ptr = nullptr;
+			return posix_memalign(&ptr, alignment < sizeof(void*) ? sizeof(void*) : alignment, size > 0 ? size : 1) == 0
+				? ptr : nullptr;
+#endif
+		}
+
+		void free_counted(void* ptr) {
+			on_free(ptr);
+			HookGuard guard;
+			std::free(ptr);
+		}
+
+		void free_aligned_counted(void* ptr) {
+			on_free(ptr);
+			HookGuard guard;
+#if defined(_WIN32)
+			_aligned_free(ptr);
+#else
+			std::free(ptr);
+#endif
+		}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+		// debug CRT reports every heap call, operator new above is already counted and skipped by in_hook
+		int crt_alloc_hook(const int alloc_type, void* user_data, const size_t size, const int block_type,
+			const long, const unsigned char*, const int) {
+			if (block_type == _CRT_BLOCK) {
+				return TRUE;
+			}
+			if (alloc_type == _HOOK_ALLOC || alloc_type == _HOOK_REALLOC) {
+				on_allocate(size);
+			}
+			else if (alloc_type == _HOOK_FREE) {
+				on_free(user_data);
+			}
+			return TRUE;
+		}
+#endif
+
+		void log_stack(void* const* frames, const int frames_count) {
+#if defined(_WIN32)
+			HANDLE process = GetCurrentProcess();
+			alignas(SYMBOL_INFO) char symbol_buffer[sizeof(SYMBOL_INFO) + 256];
+			SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(symbol_buffer);
+			for (int i = 0; i < frames_count; ++i) {
+				symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+				symbol->MaxNameLen = 255;
+				const DWORD64 address = reinterpret_cast<DWORD64>(frames[i]);
+				IMAGEHLP_LINE64 line = {};
+				line.SizeOfStruct = sizeof(line);
+				DWORD displacement = 0;
+				const bool has_symbol = SymFromAddr(process, address, nullptr, symbol) != FALSE;
+				const bool has_line = SymGetLineFromAddr64(process, address, &displacement, &line) != FALSE;
+				LOG_WARN("    #{0} {1} {2}:{3}", i, has_symbol ? symbol->Name : "?",
+					has_line ? line.FileName : "?", has_line ? line.LineNumber : 0);
+			}
+#else
+			char** symbols = backtrace_symbols(frames, frames_count);
+			for (int i = 0; i < frames_count; ++i) {
+				const char* text = symbols != nullptr ? symbols[i] : "?";
+				// binary(mangled+offset) [address]
+				const std::string_view line(text);
+				const size_t begin = line.find('(');
+				const size_t end = line.find('+', begin);
+				int status = -1;
+				char* demangled = nullptr;
+				if (begin != std::string_view::npos && end != std::string_view::npos && end > begin + 1) {
+					const std::string mangled(line.substr(begin + 1, end - begin - 1));
+					demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+				}
+				if (status == 0 && demangled != nullptr) {
+					LOG_WARN("    #{0} {1} {2}", i, demangled, line);
+				}
+				else {
+					LOG_WARN("    #{0} {1}", i, line);
+				}
+				std::free(demangled);
+			}
+			std::free(symbols);
+#endif
+		}
+#endif
+	}
+
+	void AllocationTracker::init()
+	{
+#if SIMPLE_ENGINE_ALLOCATION_HOOKS
+#if defined(_WIN32)
+		SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+		SymInitialize(GetCurrentProcess(), nullptr, TRUE);
+#if defined(_MSC_VER) && defined(_DEBUG)
+		_CrtSetAllocHook(crt_alloc_hook);
+#endif
+#else
+		// the first backtrace loads unwinder library and allocates
+		void* frames[1];
+		backtrace(frames, 1);
+#endif
+		LOG_INFO("Allocation hooks are on, heap calls inside of no-alloc zones are reported");
+#endif
+	}
+
+	AllocationTracker::ThreadCounters AllocationTracker::get_thread_counters()
+	{
+		ThreadCounters counters;
+		counters.allocations = t_state.allocations;
+		counters.frees = t_state.frees;
+		counters.allocated_bytes = t_state.allocated_bytes;
+		return counters;
+	}
+
+	uint64_t AllocationTracker::get_violations_count()
+	{
+#if SIMPLE_ENGINE_ALLOCATION_HOOKS
+		return s_violations_count.load(std::memory_order_relaxed);
+#else
+		return 0;
+#endif
+	}
+
+	void AllocationTracker::report_violations()
+	{
+#if SIMPLE_ENGINE_ALLOCATION_HOOKS
+		const size_t claimed = s_claimed_violations.load(std::memory_order_acquire);
+		for (; s_reported_violations < claimed && s_reported_violations < s_max_violations; ++s_reported_violations) {
+			const Violation& violation = s_violations[s_reported_violations];
+			// claimed but still being written
+			if (!violation.ready.load(std::memory_order_acquire)) {
+				break;
+			}
+			if (violation.is_free) {
+				LOG_WARN("Heap free in no-alloc zone {0}, {1} times so far:", violation.zone, violation.hits.load(std::memory_order_relaxed));
+			}
+			else {
+				LOG_WARN("Heap allocation of {0} bytes in no-alloc zone {1}, {2} times so far:",
+					violation.size, violation.zone, violation.hits.load(std::memory_order_relaxed));
+			}
+			log_stack(violation.frames, violation.frames_count);
+		}
+		if (claimed > s_max_violations && s_reported_violations == s_max_violations) {
+			LOG_WARN("More than {0} different call stacks allocated in no-alloc zones, the rest are only counted", s_max_violations);
+			++s_reported_violations;
+		}
+#endif
+	}
+
+	NoAllocScope::NoAllocScope(const char* zone, const bool active)
+	{
+		if (AllocationTracker::is_enabled() && active) {
+			m_active = true;
+			m_previous_zone = t_state.zone;
+			t_state.zone = zone;
+		}
+	}
+
+	NoAllocScope::~NoAllocScope()
+	{
+		if (m_active) {
+			t_state.zone = m_previous_zone;
+		}
+	}
+}
+
+#if SIMPLE_ENGINE_ALLOCATION_HOOKS
+// replaceable global allocation functions, they count calls and forward to C runtime
+void* operator new(const size_t size)
+{
+	void* ptr = SimpleEngine::allocate_counted(size);
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+void* operator new[](const size_t size)
+{
+	return operator new(size);
+}
+void* operator new(const size_t size, const std::nothrow_t&) noexcept
+{
+	return SimpleEngine::allocate_counted(size);
+}
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept
+{
+	return SimpleEngine::allocate_counted(size);
+}
+void* operator new(const size_t size, const std::align_val_t alignment)
+{
+	void* ptr = SimpleEngine::allocate_aligned_counted(size, static_cast<size_t>(alignment));
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+void* operator new[](const size_t size, const std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+void* operator new(const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return SimpleEngine::allocate_aligned_counted(size, static_cast<size_t>(alignment));
+}
+void* operator new[](const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return SimpleEngine::allocate_aligned_counted(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { SimpleEngine::free_counted(ptr); }
+void operator delete[](void* ptr) noexcept { SimpleEngine::free_counted(ptr); }
+void operator delete(void* ptr, size_t) noexcept { SimpleEngine::free_counted(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { SimpleEngine::free_counted(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { SimpleEngine::free_counted(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { SimpleEngine::free_counted(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { SimpleEngine::free_aligned_counted(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { SimpleEngine::free_aligned_counted(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { SimpleEngine::free_aligned_counted(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { SimpleEngine::free_aligned_counted(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { SimpleEngine::free_aligned_counted(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { SimpleEngine::free_aligned_counted(ptr); }
+
+#if defined(__GLIBC__)
+// glibc lets executable replace malloc family, real allocator stays reachable by __libc_ names
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void* ptr);
+
+	void* malloc(size_t size)
+	{
+		SimpleEngine::on_allocate(size);
+		return __libc_malloc(size);
+	}
+	void* calloc(size_t count, size_t size)
+	{
+		SimpleEngine::on_allocate(count * size);
+		return __libc_calloc(count, size);
+	}
+	void* realloc(void* ptr, size_t size)
+	{
+		SimpleEngine::on_allocate(size);
+		return __libc_realloc(ptr, size);
+	}
+	void free(void* ptr)
+	{
+		SimpleEngine::on_free(ptr);
+		__libc_free(ptr);
+	}
+
+	// aligned family has no __libc_ names of its own, all of them are memalign with checks of arguments
+	void* memalign(size_t alignment, size_t size)
+	{
+		SimpleEngine::on_allocate(size);
+		return __libc_memalign(alignment, size);
+	}
+	void* aligned_alloc(size_t alignment, size_t size)
+	{
+		if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+			errno = EINVAL;
+			return nullptr;
+		}
+		SimpleEngine::on_allocate(size);
+		return __libc_memalign(alignment, size);
+	}
+	int posix_memalign(void** ptr, size_t alignment, size_t size)
+	{
+		if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+			return EINVAL;
+		}
+		SimpleEngine::on_allocate(size);
+		void* result = __libc_memalign(alignment, size);
+		if (result == nullptr) {
+			return ENOMEM;
+		}
+		*ptr = result;
+		return 0;
+	}
+}
+#endif
+#endif
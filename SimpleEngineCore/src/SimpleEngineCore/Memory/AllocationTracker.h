@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// global operator new/delete (and malloc family where the C runtime allows it) count every heap call per thread
+// set by SIMPLE_ENGINE_ALLOCATION_HOOKS option, without it counters stay 0 and zones check nothing
+#ifndef SIMPLE_ENGINE_ALLOCATION_HOOKS
+#define SIMPLE_ENGINE_ALLOCATION_HOOKS 0
+#endif
+
+namespace SimpleEngine {
+
+	class AllocationTracker {
+	public:
+		// heap calls of one thread since it started
+		struct ThreadCounters {
+			uint64_t allocations = 0;
+			uint64_t frees = 0;
+			uint64_t allocated_bytes = 0;
+		};
+
+		static constexpr bool is_enabled() { return SIMPLE_ENGINE_ALLOCATION_HOOKS != 0; }
+
+		// call stacks are captured inside of allocator, whatever stack walker loads has to be loaded before
+		static void init();
+
+		static ThreadCounters get_thread_counters();
+		// heap calls inside of no-alloc zones on any thread, the first ones are kept with call stacks
+		static uint64_t get_violations_count();
+		// logs call stacks which were not logged yet, allocates itself so it can't run inside of zone
+		static void report_violations();
+	};
+
+	// heap calls of this thread until scope ends are violations, scopes nest
+	class NoAllocScope {
+	public:
+		// zone name has to be a string literal
+		explicit NoAllocScope(const char* zone, const bool active = true);
+		~NoAllocScope();
+
+		NoAllocScope(const NoAllocScope&) = delete;
+		NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+	private:
+		const char* m_previous_zone = nullptr;
+		bool m_active = false;
+	};
+}
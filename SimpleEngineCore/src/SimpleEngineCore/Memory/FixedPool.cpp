@@ -0,0 +1,59 @@
+#include "FixedPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace SimpleEngine {
+
+	namespace {
+		size_t align_up(const size_t value, const size_t alignment) {
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	FixedPool::FixedPool(const size_t block_size, const size_t block_alignment, const size_t blocks_per_page, const MemoryTag tag) :
+		m_block_alignment(std::max(block_alignment, alignof(FreeBlock))),
+		m_blocks_per_page(std::max<size_t>(blocks_per_page, 1)),
+		m_tag(tag)
+	{
+		assert((m_block_alignment & (m_block_alignment - 1)) == 0);
+		// every block keeps free list link when it's free, page link takes the first aligned slot
+		m_block_size = align_up(std::max(block_size, sizeof(FreeBlock)), m_block_alignment);
+		m_page_size = align_up(sizeof(Page), m_block_alignment) + m_block_size * m_blocks_per_page;
+	}
+
+	FixedPool::~FixedPool()
+	{
+		assert(m_live_blocks == 0 && "FixedPool destroyed with live blocks");
+		while (m_pPages != nullptr) {
+			Page* next = m_pPages->next;
+			MemoryTracker::deallocate(m_pPages, m_page_size, m_block_alignment, m_tag);
+			m_pPages = next;
+		}
+	}
+
+	FixedPool::Stats FixedPool::get_stats() const
+	{
+		Stats stats;
+		stats.live_blocks = m_live_blocks;
+		stats.pages = m_pages_count;
+		stats.free_blocks = m_pages_count * m_blocks_per_page - m_live_blocks;
+		return stats;
+	}
+
+	void FixedPool::add_page()
+	{
+		Page* page = static_cast<Page*>(MemoryTracker::allocate(m_page_size, m_block_alignment, m_tag));
+		page->next = m_pPages;
+		m_pPages = page;
+		++m_pages_count;
+
+		// blocks are linked in address order, so the first ones handed out are next to each other
+		unsigned char* blocks = reinterpret_cast<unsigned char*>(page) + align_up(sizeof(Page), m_block_alignment);
+		for (size_t i = m_blocks_per_page; i-- > 0;) {
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(blocks + i * m_block_size);
+			block->next = m_pFree;
+			m_pFree = block;
+		}
+	}
+}
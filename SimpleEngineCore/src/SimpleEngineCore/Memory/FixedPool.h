@@ -0,0 +1,104 @@
+#pragma once
+
+#include "MemoryTracker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace SimpleEngine {
+
+	// blocks of one size carved from bigger pages, freed blocks go to intrusive free list
+	// allocate and free are a couple of instructions, pages are given back only in destructor
+	// not thread-safe
+	class FixedPool {
+	public:
+		struct Stats {
+			size_t live_blocks = 0;
+			size_t free_blocks = 0;
+			size_t pages = 0;
+		};
+
+		FixedPool(const size_t block_size, const size_t block_alignment, const size_t blocks_per_page, const MemoryTag tag);
+		~FixedPool();
+
+		FixedPool(const FixedPool&) = delete;
+		FixedPool& operator=(const FixedPool&) = delete;
+
+		void* allocate() {
+			if (m_pFree == nullptr) {
+				add_page();
+			}
+			FreeBlock* block = m_pFree;
+			m_pFree = block->next;
+			++m_live_blocks;
+			return block;
+		}
+
+		// block has to come from this pool
+		void free(void* ptr) {
+			FreeBlock* block = static_cast<FreeBlock*>(ptr);
+			block->next = m_pFree;
+			m_pFree = block;
+			--m_live_blocks;
+		}
+
+		size_t get_block_size() const { return m_block_size; }
+		Stats get_stats() const;
+
+	private:
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+		struct Page {
+			Page* next;
+		};
+
+		void add_page();
+
+		size_t m_block_size;
+		size_t m_block_alignment;
+		size_t m_blocks_per_page;
+		size_t m_page_size;
+		MemoryTag m_tag;
+		FreeBlock* m_pFree = nullptr;
+		Page* m_pPages = nullptr;
+		size_t m_pages_count = 0;
+		size_t m_live_blocks = 0;
+	};
+
+	// pool of objects of one type
+	template<typename T>
+	class ObjectPool {
+	public:
+		ObjectPool(const size_t objects_per_page, const MemoryTag tag) :
+			m_pool(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T),
+				alignof(T) < alignof(void*) ? alignof(void*) : alignof(T), objects_per_page, tag) {}
+
+		template<typename... Args>
+		T* create(Args&&... args) {
+			void* memory = m_pool.allocate();
+			try {
+				return new (memory) T(std::forward<Args>(args)...);
+			}
+			catch (...) {
+				m_pool.free(memory);
+				throw;
+			}
+		}
+
+		void destroy(T* object) {
+			if (object == nullptr) {
+				return;
+			}
+			object->~T();
+			m_pool.free(object);
+		}
+
+		FixedPool::Stats get_stats() const { return m_pool.get_stats(); }
+
+	private:
+		FixedPool m_pool;
+	};
+}
@@ -0,0 +1,135 @@
+#include "LinearArena.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr size_t s_block_alignment = 64;
+		// blocks after first one are at least this big, so small arenas don't take block per allocation
+		constexpr size_t s_min_block_size = 4096;
+		constexpr size_t s_scratch_capacity = 1024 * 1024;
+
+		size_t align_up(const size_t value, const size_t alignment) {
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	// header at the start of every block, data starts at the next 64 bytes
+	struct LinearArena::Block {
+		Block* previous = nullptr;
+		size_t size = 0;
+		size_t offset = 0;
+
+		unsigned char* get_data() {
+			return reinterpret_cast<unsigned char*>(this) + align_up(sizeof(Block), s_block_alignment);
+		}
+	};
+
+	LinearArena::LinearArena(const size_t capacity, const MemoryTag tag) :
+		m_capacity(std::max(capacity, s_min_block_size)),
+		m_tag(tag)
+	{
+	}
+
+	LinearArena::~LinearArena()
+	{
+		rewind(Marker());
+		if (m_pFirst != nullptr) {
+			free_block(m_pFirst);
+		}
+	}
+
+	void* LinearArena::allocate(const size_t size, const size_t alignment)
+	{
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+		if (m_pCurrent == nullptr) {
+			m_pFirst = m_pCurrent = allocate_block(m_capacity, nullptr);
+		}
+
+		uintptr_t data = reinterpret_cast<uintptr_t>(m_pCurrent->get_data());
+		size_t begin = align_up(data + m_pCurrent->offset, alignment) - data;
+		if (begin + size > m_pCurrent->size) {
+			// the rest of full block is not counted as used
+			m_pCurrent = allocate_block(std::max({ m_capacity, size + alignment, s_min_block_size }), m_pCurrent);
+			++m_overflow_blocks;
+			data = reinterpret_cast<uintptr_t>(m_pCurrent->get_data());
+			begin = align_up(data, alignment) - data;
+		}
+
+		m_used += begin + size - m_pCurrent->offset;
+		m_pCurrent->offset = begin + size;
+		m_peak = std::max(m_peak, m_used);
+		m_peak_since_reset = std::max(m_peak_since_reset, m_used);
+		return m_pCurrent->get_data() + begin;
+	}
+
+	void LinearArena::rewind(const Marker& marker)
+	{
+		Block* target = marker.block != nullptr ? static_cast<Block*>(marker.block) : m_pFirst;
+		const size_t target_offset = marker.block != nullptr ? marker.offset : 0;
+		while (m_pCurrent != target && m_pCurrent != m_pFirst) {
+			Block* previous = m_pCurrent->previous;
+			free_block(m_pCurrent);
+			m_pCurrent = previous;
+		}
+		if (m_pCurrent == nullptr) {
+			return;
+		}
+		m_pCurrent->offset = target_offset;
+
+		m_used = 0;
+		for (const Block* block = m_pCurrent; block != nullptr; block = block->previous) {
+			m_used += block->offset;
+		}
+	}
+
+	void LinearArena::reset()
+	{
+		const size_t needed = m_peak_since_reset;
+		rewind(Marker());
+		m_peak_since_reset = 0;
+		if (m_pFirst != nullptr && needed > m_pFirst->size) {
+			// next frame takes one block again, with some room to grow
+			free_block(m_pFirst);
+			m_pFirst = m_pCurrent = nullptr;
+			m_capacity = align_up(needed + needed / 4, s_min_block_size);
+		}
+	}
+
+	size_t LinearArena::get_offset() const
+	{
+		return m_pCurrent->offset;
+	}
+
+	LinearArena::Block* LinearArena::allocate_block(const size_t size, Block* previous)
+	{
+		void* memory = MemoryTracker::allocate(align_up(sizeof(Block), s_block_alignment) + size, s_block_alignment, m_tag);
+		Block* block = new (memory) Block();
+		block->previous = previous;
+		block->size = size;
+		return block;
+	}
+
+	void LinearArena::free_block(Block* block)
+	{
+		const size_t size = align_up(sizeof(Block), s_block_alignment) + block->size;
+		block->~Block();
+		MemoryTracker::deallocate(block, size, s_block_alignment, m_tag);
+	}
+
+	ScratchScope::ScratchScope() :
+		m_arena([]() -> LinearArena& {
+			thread_local LinearArena scratch(s_scratch_capacity, MemoryTag::Scratch);
+			return scratch;
+		}()),
+		m_marker(m_arena.get_marker())
+	{
+	}
+
+	ScratchScope::~ScratchScope()
+	{
+		m_arena.rewind(m_marker);
+	}
+}
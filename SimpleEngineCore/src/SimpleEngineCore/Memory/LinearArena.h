@@ -0,0 +1,122 @@
+#pragma once
+
+#include "MemoryTracker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// bump allocator: allocation moves offset, single objects are never freed, everything goes at once on reset
+	// when block is full next block is taken from heap, they are freed on reset and first block grows to fit
+	// not thread-safe, every arena belongs to one thread at a time
+	class LinearArena {
+	public:
+		// position to rewind to, everything allocated after it is freed
+		struct Marker {
+			void* block = nullptr;
+			size_t offset = 0;
+		};
+
+		// first block is allocated on first allocate
+		explicit LinearArena(const size_t capacity, const MemoryTag tag = MemoryTag::Frame);
+		~LinearArena();
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		// alignment has to be power of two, memory is not initialized
+		void* allocate(const size_t size, const size_t alignment);
+
+		template<typename T>
+		T* allocate_array(const size_t count) {
+			if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+				throw std::bad_array_new_length();
+			}
+			return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		}
+
+		Marker get_marker() const { return { m_pCurrent, m_pCurrent != nullptr ? get_offset() : 0 }; }
+		// nothing is destructed, objects in arena have to be trivially destructible or destructed by owner
+		void rewind(const Marker& marker);
+		// rewinds to start, first block grows if frame didn't fit into it
+		void reset();
+
+		size_t get_capacity() const { return m_capacity; }
+		size_t get_used() const { return m_used; }
+		size_t get_peak() const { return m_peak; }
+		// blocks taken after first one was full, since construction
+		uint64_t get_overflow_blocks() const { return m_overflow_blocks; }
+
+	private:
+		struct Block;
+
+		size_t get_offset() const;
+		Block* allocate_block(const size_t size, Block* previous);
+		void free_block(Block* block);
+
+		Block* m_pFirst = nullptr;
+		Block* m_pCurrent = nullptr;
+		size_t m_capacity = 0;
+		size_t m_used = 0;			// bytes in all blocks, padding included
+		size_t m_peak = 0;
+		size_t m_peak_since_reset = 0;
+		uint64_t m_overflow_blocks = 0;
+		MemoryTag m_tag;
+	};
+
+	// STL allocator over arena, deallocate does nothing
+	// container must not outlive rewind of its arena
+	template<typename T>
+	class ArenaAllocator {
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind {
+			using other = ArenaAllocator<U>;
+		};
+
+		explicit ArenaAllocator(LinearArena& arena) : m_pArena(&arena) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : m_pArena(other.get_arena()) {}
+
+		T* allocate(const size_t count) { return m_pArena->allocate_array<T>(count); }
+		void deallocate(T*, const size_t) {}
+
+		LinearArena* get_arena() const { return m_pArena; }
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const { return m_pArena == other.get_arena(); }
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return m_pArena != other.get_arena(); }
+
+	private:
+		LinearArena* m_pArena;
+	};
+
+	template<typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+	// temporary memory of calling thread, it is given back when scope ends
+	// scopes nest, inner scope has to end first
+	class ScratchScope {
+	public:
+		ScratchScope();
+		~ScratchScope();
+
+		ScratchScope(const ScratchScope&) = delete;
+		ScratchScope& operator=(const ScratchScope&) = delete;
+
+		LinearArena& get_arena() { return m_arena; }
+		template<typename T>
+		ArenaAllocator<T> get_allocator() { return ArenaAllocator<T>(m_arena); }
+
+	private:
+		LinearArena& m_arena;
+		LinearArena::Marker m_marker;
+	};
+}
@@ -0,0 +1,65 @@
+#include "MemoryTracker.h"
+
+namespace SimpleEngine {
+
+	MemoryTracker::Counters MemoryTracker::s_counters[static_cast<size_t>(MemoryTag::Count)];
+
+	void* MemoryTracker::allocate(const size_t size, const size_t alignment, const MemoryTag tag)
+	{
+		void* ptr = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+			? ::operator new(size, std::align_val_t(alignment))
+			: ::operator new(size);
+
+		Counters& counters = s_counters[static_cast<size_t>(tag)];
+		const size_t live_bytes = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+		size_t peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+		while (live_bytes > peak_bytes &&
+			!counters.peak_bytes.compare_exchange_weak(peak_bytes, live_bytes, std::memory_order_relaxed)) {
+		}
+		counters.live_allocations.fetch_add(1, std::memory_order_relaxed);
+		counters.total_allocations.fetch_add(1, std::memory_order_relaxed);
+		return ptr;
+	}
+
+	void MemoryTracker::deallocate(void* ptr, const size_t size, const size_t alignment, const MemoryTag tag)
+	{
+		if (ptr == nullptr) {
+			return;
+		}
+		if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			::operator delete(ptr, std::align_val_t(alignment));
+		}
+		else {
+			::operator delete(ptr);
+		}
+
+		Counters& counters = s_counters[static_cast<size_t>(tag)];
+		counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+		counters.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	MemoryTracker::Stats MemoryTracker::get_stats(const MemoryTag tag)
+	{
+		const Counters& counters = s_counters[static_cast<size_t>(tag)];
+		Stats stats;
+		stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+		stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+		stats.live_allocations = counters.live_allocations.load(std::memory_order_relaxed);
+		stats.total_allocations = counters.total_allocations.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	const char* MemoryTracker::get_tag_name(const MemoryTag tag)
+	{
+		switch (tag) {
+		case MemoryTag::General: return "General";
+		case MemoryTag::Rendering: return "Rendering";
+		case MemoryTag::Assets: return "Assets";
+		case MemoryTag::ECS: return "ECS";
+		case MemoryTag::Frame: return "Frame";
+		case MemoryTag::Scratch: return "Scratch";
+		case MemoryTag::Count: break;
+		}
+		return "Unknown";
+	}
+}
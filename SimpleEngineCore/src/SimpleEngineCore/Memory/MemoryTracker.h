@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// subsystem which owns memory, engine allocators are created with one
+	enum class MemoryTag : uint8_t {
+		General,
+		Rendering,
+		Assets,
+		ECS,
+		Frame,		// per-frame arenas
+		Scratch,	// per-thread temporary arenas
+		Count
+	};
+
+	// live bytes and allocation counts per subsystem
+	// pools and arenas take big blocks here, so counts are of blocks and not of objects inside of them
+	class MemoryTracker {
+	public:
+		struct Stats {
+			size_t live_bytes = 0;
+			size_t peak_bytes = 0;
+			size_t live_allocations = 0;
+			uint64_t total_allocations = 0;
+		};
+
+		// any thread, size and alignment have to be passed to deallocate again
+		static void* allocate(const size_t size, const size_t alignment, const MemoryTag tag);
+		static void deallocate(void* ptr, const size_t size, const size_t alignment, const MemoryTag tag);
+
+		static Stats get_stats(const MemoryTag tag);
+		static const char* get_tag_name(const MemoryTag tag);
+
+	private:
+		struct alignas(64) Counters {
+			std::atomic<size_t> live_bytes{ 0 };
+			std::atomic<size_t> peak_bytes{ 0 };
+			std::atomic<size_t> live_allocations{ 0 };
+			std::atomic<uint64_t> total_allocations{ 0 };
+		};
+
+		static Counters s_counters[static_cast<size_t>(MemoryTag::Count)];
+	};
+
+	// STL allocator which counts container memory to a subsystem
+	template<typename T, MemoryTag Tag>
+	class TaggedAllocator {
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind {
+			using other = TaggedAllocator<U, Tag>;
+		};
+
+		TaggedAllocator() = default;
+		template<typename U>
+		TaggedAllocator(const TaggedAllocator<U, Tag>&) {}
+
+		T* allocate(const size_t count) {
+			if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+				throw std::bad_array_new_length();
+			}
+			return static_cast<T*>(MemoryTracker::allocate(count * sizeof(T), alignof(T), Tag));
+		}
+		void deallocate(T* ptr, const size_t count) {
+			MemoryTracker::deallocate(ptr, count * sizeof(T), alignof(T), Tag);
+		}
+
+		template<typename U>
+		bool operator==(const TaggedAllocator<U, Tag>&) const { return true; }
+		template<typename U>
+		bool operator!=(const TaggedAllocator<U, Tag>&) const { return false; }
+	};
+
+	template<typename T, MemoryTag Tag>
+	using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
+}
@@ -7,9 +7,59 @@
 
 #include <GLFW/glfw3.h>
 
+#include <cstring>
+
 namespace SimpleEngine {
 
-	void UIModule::on_window_create(GLFWwindow* pWindow)
+	namespace {
+		// ImVector assignment frees and allocates again, resize keeps capacity of previous frames
+		template<typename T>
+		void copy_vector(ImVector<T>& dst, const ImVector<T>& src) {
+			dst.resize(src.Size);
+			if (src.Size > 0) {
+				std::memcpy(dst.Data, src.Data, src.size_in_bytes());
+			}
+		}
+	}
+
+	UIDrawData::~UIDrawData()
+	{
+		for (ImDrawList* draw_list : m_draw_lists) {
+			IM_DELETE(draw_list);
+		}
+		IM_DELETE(m_pDrawData);
+	}
+
+	void UIDrawData::copy_from(const ImDrawData& draw_data)
+	{
+		if (!m_pDrawData) {
+			m_pDrawData = IM_NEW(ImDrawData)();
+		}
+		while (m_draw_lists.size() < static_cast<size_t>(draw_data.CmdListsCount)) {
+			m_draw_lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+		}
+
+		m_pDrawData->Clear();
+		for (int i = 0; i < draw_data.CmdListsCount; ++i) {
+			const ImDrawList* src = draw_data.CmdLists[i];
+			ImDrawList* dst = m_draw_lists[i];
+			copy_vector(dst->CmdBuffer, src->CmdBuffer);
+			copy_vector(dst->IdxBuffer, src->IdxBuffer);
+			copy_vector(dst->VtxBuffer, src->VtxBuffer);
+			dst->Flags = src->Flags;
+			m_pDrawData->CmdLists.push_back(dst);
+		}
+		m_pDrawData->Valid = draw_data.Valid;
+		m_pDrawData->CmdListsCount = draw_data.CmdListsCount;
+		m_pDrawData->TotalIdxCount = draw_data.TotalIdxCount;
+		m_pDrawData->TotalVtxCount = draw_data.TotalVtxCount;
+		m_pDrawData->DisplayPos = draw_data.DisplayPos;
+		m_pDrawData->DisplaySize = draw_data.DisplaySize;
+		m_pDrawData->FramebufferScale = draw_data.FramebufferScale;
+		m_pDrawData->OwnerViewport = draw_data.OwnerViewport;
+	}
+
+	void UIModule::on_window_create(GLFWwindow* pWindow, const bool enable_viewports)
 	{
 		IMGUI_CHECKVERSION();
 		ImGui::CreateContext();
@@ -20,10 +70,15 @@ namespace SimpleEngine {
 		font_config.SizePixels = 30.0f; //    
 		io.Fonts->AddFontDefault(&font_config);
 		io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_DockingEnable;
-		io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_ViewportsEnable;
+		// platform windows are created and rendered in one place, it doesn't work with separate render thread
+		if (enable_viewports) {
+			io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_ViewportsEnable;
+		}
 
 		ImGui_ImplOpenGL3_Init();
 		ImGui_ImplGlfw_InitForOpenGL(pWindow, true);
+		// font texture is created now while context is current on this thread
+		ImGui_ImplOpenGL3_NewFrame();
 	}
 
 	void UIModule::on_window_close()
@@ -62,4 +117,33 @@ namespace SimpleEngine {
 			glfwMakeContextCurrent(backup_current_context);
 		}
 	}
-}
+
+	void UIModule::on_ui_build_begin()
+	{
+		// no OpenGL here, renderer backend frame starts in render_draw_data
+		ImGui_ImplGlfw_NewFrame();
+		ImGui::NewFrame();
+	}
+
+	void UIModule::on_ui_build_end(UIDrawData& out_draw_data)
+	{
+		ImGui::Render();
+		out_draw_data.copy_from(*ImGui::GetDrawData());
+	}
+
+	void UIModule::render_draw_data(const UIDrawData& draw_data)
+	{
+		ImGui_ImplOpenGL3_NewFrame();
+		if (draw_data.get()) {
+			ImGui_ImplOpenGL3_RenderDrawData(draw_data.get());
+		}
+
+		// viewports are enabled only when UI is built and rendered on the same thread
+		if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+			GLFWwindow* backup_current_context = glfwGetCurrentContext();
+			ImGui::UpdatePlatformWindows();
+			ImGui::RenderPlatformWindowsDefault();
+			glfwMakeContextCurrent(backup_current_context);
+		}
+	}
+}
\ No newline at end of file
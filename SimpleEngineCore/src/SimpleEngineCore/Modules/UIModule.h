@@ -1,14 +1,41 @@
 #pragma once
 
+#include <vector>
+
 struct GLFWwindow;
+struct ImDrawData;
+struct ImDrawList;
 
 namespace SimpleEngine {
 
+	// copy of ImGui draw data, so UI of the next frame can be built while this one is rendered
+	// draw lists are kept between frames to reuse their memory
+	class UIDrawData {
+	public:
+		UIDrawData() = default;
+		~UIDrawData();
+
+		UIDrawData(const UIDrawData&) = delete;
+		UIDrawData& operator=(const UIDrawData&) = delete;
+
+		void copy_from(const ImDrawData& draw_data);
+		ImDrawData* get() const { return m_pDrawData; }
+
+	private:
+		ImDrawData* m_pDrawData = nullptr;
+		std::vector<ImDrawList*> m_draw_lists;
+	};
+
 	class UIModule {
 	public:
-		static void on_window_create(GLFWwindow* pWindow);
+		static void on_window_create(GLFWwindow* pWindow, const bool enable_viewports = true);
 		static void on_window_close();
 		static void on_ui_draw_begin();
 		static void on_ui_draw_end();
+
+		// for rendering on another thread: UI is built here and rendered from copy with render_draw_data
+		static void on_ui_build_begin();
+		static void on_ui_build_end(UIDrawData& out_draw_data);
+		static void render_draw_data(const UIDrawData& draw_data);
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,258 @@
+#include "ClusteredLighting.h"
+
+#include "OpenGL/ShaderStorageBuffer.h"
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace SimpleEngine {
+
+	namespace {
+		// light is cut where attenuated intensity can't change 8 bit color anymore
+		constexpr float s_min_light_intensity = 1.f / 256.f;
+
+		float get_light_range(const PointLight& light)
+		{
+			const glm::vec3 color = glm::max(light.get_diffuse(), light.get_specular());
+			const float intensity = std::max(color.x, std::max(color.y, color.z));
+			// solve constant + linear * d + quadratic * d^2 = intensity / min_intensity
+			const float c = light.constant - intensity / s_min_light_intensity;
+			if (c >= 0.f) {
+				return 0.f;
+			}
+			if (light.quadratic > 0.f) {
+				return (-light.linear + std::sqrt(light.linear * light.linear - 4.f * light.quadratic * c)) / (2.f * light.quadratic);
+			}
+			if (light.linear > 0.f) {
+				return -c / light.linear;
+			}
+			return std::numeric_limits<float>::max();
+		}
+
+		// cone is tested against bounding sphere of cluster
+		bool is_cone_outside_sphere(const glm::vec3& apex, const glm::vec3& direction, const float cos_angle, const float range,
+			const glm::vec4& sphere)
+		{
+			const float sin_angle = std::sqrt(std::max(0.f, 1.f - cos_angle * cos_angle));
+			const glm::vec3 to_center = glm::vec3(sphere) - apex;
+			const float length_squared = glm::dot(to_center, to_center);
+			const float along_axis = glm::dot(to_center, direction);
+			const float closest_distance = cos_angle * std::sqrt(std::max(0.f, length_squared - along_axis * along_axis)) - along_axis * sin_angle;
+			return closest_distance > sphere.w || along_axis > sphere.w + range || along_axis < -sphere.w;
+		}
+	}
+
+	ClusterLight ClusterLight::from_point_light(const PointLight& light)
+	{
+		ClusterLight result;
+		result.position_range = glm::vec4(light.position, get_light_range(light));
+		result.diffuse = glm::vec4(light.get_diffuse(), 0.f);
+		result.specular = glm::vec4(light.get_specular(), 0.f);
+		result.attenuation = glm::vec4(light.constant, light.linear, light.quadratic, 0.f);
+		return result;
+	}
+
+	ClusterLight ClusterLight::from_spot_light(const SpotLight& light)
+	{
+		ClusterLight result = from_point_light(light);
+		result.direction_cos_cutoff = glm::vec4(glm::normalize(light.direction), glm::cos(glm::radians(light.cutOff)));
+		return result;
+	}
+
+	void ClusterLightAssigner::assign(const Camera& camera, const unsigned int viewport_width, const unsigned int viewport_height,
+		const std::vector<ClusterLight>& lights, ClusterGrid& grid, ClusterLightLists& lists)
+	{
+		update_clusters(camera, viewport_width, viewport_height);
+		grid = m_grid;
+
+		// lights go to view space, where cluster boxes are
+		const glm::mat4 view = camera.get_view_matrix();
+		const glm::mat3 view_rotation(view);
+		m_light_x.resize(lights.size());
+		m_light_y.resize(lights.size());
+		m_light_z.resize(lights.size());
+		m_light_radius.resize(lights.size());
+		m_light_direction.resize(lights.size());
+		for (size_t i = 0; i < lights.size(); ++i) {
+			const glm::vec4 position = view * glm::vec4(glm::vec3(lights[i].position_range), 1.f);
+			m_light_x[i] = position.x;
+			m_light_y[i] = position.y;
+			m_light_z[i] = position.z;
+			m_light_radius[i] = lights[i].position_range.w;
+			m_light_direction[i] = view_rotation * glm::vec3(lights[i].direction_cos_cutoff);
+		}
+
+		lists.ranges.resize(ClusterGrid::s_clusters_count * 2);
+		JobSystem::parallel_for(ClusterGrid::s_slices, 1,
+			[this, &lights, &lists](const size_t begin, const size_t end) {
+				for (size_t slice = begin; slice < end; ++slice) {
+					assign_slice(static_cast<uint32_t>(slice), lights, lists);
+				}
+			});
+
+		// slices wrote offsets inside of own index list, now lists are joined
+		size_t indices_count = 0;
+		for (const SliceScratch& slice : m_slices) {
+			indices_count += slice.indices.size();
+		}
+		lists.indices.resize(indices_count);
+		uint32_t slice_offset = 0;
+		constexpr uint32_t clusters_in_slice = ClusterGrid::s_tiles_x * ClusterGrid::s_tiles_y;
+		for (uint32_t slice = 0; slice < ClusterGrid::s_slices; ++slice) {
+			const std::vector<uint32_t>& indices = m_slices[slice].indices;
+			if (!indices.empty()) {
+				std::memcpy(lists.indices.data() + slice_offset, indices.data(), indices.size() * sizeof(uint32_t));
+			}
+			for (uint32_t cluster = slice * clusters_in_slice; cluster < (slice + 1) * clusters_in_slice; ++cluster) {
+				lists.ranges[cluster * 2] += slice_offset;
+			}
+			slice_offset += static_cast<uint32_t>(indices.size());
+		}
+	}
+
+	void ClusterLightAssigner::update_clusters(const Camera& camera, const unsigned int viewport_width, const unsigned int viewport_height)
+	{
+		const glm::mat4 projection = camera.get_projection_matrix();
+		if (projection == m_projection && viewport_width == m_viewport_width && viewport_height == m_viewport_height
+			&& camera.get_near_clip_plane() == m_near && camera.get_far_clip_plane() == m_far) {
+			return;
+		}
+		m_projection = projection;
+		m_viewport_width = std::max(viewport_width, 1u);
+		m_viewport_height = std::max(viewport_height, 1u);
+		m_near = camera.get_near_clip_plane();
+		m_far = camera.get_far_clip_plane();
+
+		constexpr uint32_t tiles_x = ClusterGrid::s_tiles_x;
+		constexpr uint32_t tiles_y = ClusterGrid::s_tiles_y;
+		constexpr uint32_t slices = ClusterGrid::s_slices;
+		m_grid.tile_size = glm::vec2(
+			std::ceil(static_cast<float>(m_viewport_width) / tiles_x),
+			std::ceil(static_cast<float>(m_viewport_height) / tiles_y));
+		const float log_depth_ratio = std::log(m_far / m_near);
+		m_grid.z_scale = slices / log_depth_ratio;
+		m_grid.z_bias = -(slices * std::log(m_near)) / log_depth_ratio;
+		for (uint32_t slice = 0; slice <= slices; ++slice) {
+			m_slice_depth[slice] = m_near * std::pow(m_far / m_near, static_cast<float>(slice) / slices);
+		}
+
+		// view space point with given NDC x, y and depth, from projection equations (perspective and orthographic)
+		const auto unproject = [&projection](const float ndc_x, const float ndc_y, const float depth) {
+			const float z = -depth;
+			const float w = projection[2][3] * z + projection[3][3];
+			return glm::vec3(
+				(ndc_x * w - projection[2][0] * z - projection[3][0]) / projection[0][0],
+				(ndc_y * w - projection[2][1] * z - projection[3][1]) / projection[1][1],
+				z);
+		};
+
+		m_cluster_min.resize(ClusterGrid::s_clusters_count);
+		m_cluster_max.resize(ClusterGrid::s_clusters_count);
+		m_cluster_spheres.resize(ClusterGrid::s_clusters_count);
+		for (uint32_t slice = 0; slice < slices; ++slice) {
+			for (uint32_t y = 0; y < tiles_y; ++y) {
+				for (uint32_t x = 0; x < tiles_x; ++x) {
+					const float ndc_x[2] = {
+						std::min(x * m_grid.tile_size.x / m_viewport_width * 2.f - 1.f, 1.f),
+						std::min((x + 1) * m_grid.tile_size.x / m_viewport_width * 2.f - 1.f, 1.f) };
+					const float ndc_y[2] = {
+						std::min(y * m_grid.tile_size.y / m_viewport_height * 2.f - 1.f, 1.f),
+						std::min((y + 1) * m_grid.tile_size.y / m_viewport_height * 2.f - 1.f, 1.f) };
+					glm::vec3 box_min(std::numeric_limits<float>::max());
+					glm::vec3 box_max(-std::numeric_limits<float>::max());
+					for (int corner = 0; corner < 8; ++corner) {
+						const glm::vec3 point = unproject(ndc_x[corner & 1], ndc_y[(corner >> 1) & 1], m_slice_depth[slice + ((corner >> 2) & 1)]);
+						box_min = glm::min(box_min, point);
+						box_max = glm::max(box_max, point);
+					}
+					const uint32_t cluster = x + y * tiles_x + slice * tiles_x * tiles_y;
+					m_cluster_min[cluster] = box_min;
+					m_cluster_max[cluster] = box_max;
+					m_cluster_spheres[cluster] = glm::vec4((box_min + box_max) * 0.5f, glm::length(box_max - box_min) * 0.5f);
+				}
+			}
+		}
+		m_slices.resize(slices);
+	}
+
+	void ClusterLightAssigner::assign_slice(const uint32_t slice, const std::vector<ClusterLight>& lights, ClusterLightLists& lists)
+	{
+		SliceScratch& scratch = m_slices[slice];
+		scratch.x.clear();
+		scratch.y.clear();
+		scratch.z.clear();
+		scratch.radius.clear();
+		scratch.lights.clear();
+		scratch.indices.clear();
+
+		// only lights which reach depth range of slice are tested against its clusters
+		const float slice_near = m_slice_depth[slice];
+		const float slice_far = m_slice_depth[slice + 1];
+		for (uint32_t i = 0; i < static_cast<uint32_t>(lights.size()); ++i) {
+			const float depth = -m_light_z[i];
+			if (depth + m_light_radius[i] >= slice_near && depth - m_light_radius[i] <= slice_far) {
+				scratch.x.push_back(m_light_x[i]);
+				scratch.y.push_back(m_light_y[i]);
+				scratch.z.push_back(m_light_z[i]);
+				scratch.radius.push_back(m_light_radius[i]);
+				scratch.lights.push_back(i);
+			}
+		}
+		const size_t candidates_count = scratch.lights.size();
+		scratch.visible.resize(candidates_count);
+		const SphereArrays spheres = { { scratch.x.data(), scratch.y.data(), scratch.z.data() }, scratch.radius.data() };
+
+		constexpr uint32_t clusters_in_slice = ClusterGrid::s_tiles_x * ClusterGrid::s_tiles_y;
+		for (uint32_t cluster = slice * clusters_in_slice; cluster < (slice + 1) * clusters_in_slice; ++cluster) {
+			const uint32_t offset = static_cast<uint32_t>(scratch.indices.size());
+			if (candidates_count > 0) {
+				SimdMath::test_spheres_aabb(m_cluster_min[cluster], m_cluster_max[cluster], spheres, scratch.visible.data(), candidates_count);
+			}
+			for (size_t k = 0; k < candidates_count; ++k) {
+				if (!scratch.visible[k]) {
+					continue;
+				}
+				const uint32_t light = scratch.lights[k];
+				if (lights[light].is_spot() && is_cone_outside_sphere(
+					glm::vec3(scratch.x[k], scratch.y[k], scratch.z[k]), m_light_direction[light],
+					lights[light].direction_cos_cutoff.w, scratch.radius[k], m_cluster_spheres[cluster])) {
+					continue;
+				}
+				scratch.indices.push_back(light);
+			}
+			lists.ranges[cluster * 2] = offset;
+			lists.ranges[cluster * 2 + 1] = static_cast<uint32_t>(scratch.indices.size()) - offset;
+		}
+	}
+
+	ClusterLightBuffers::ClusterLightBuffers()
+		: m_lights(std::make_unique<ShaderStorageBuffer>(nullptr, 0, VertexBuffer::EUsage::Stream))
+		, m_ranges(std::make_unique<ShaderStorageBuffer>(nullptr, ClusterGrid::s_clusters_count * 2 * sizeof(uint32_t), VertexBuffer::EUsage::Stream))
+		, m_indices(std::make_unique<ShaderStorageBuffer>(nullptr, 0, VertexBuffer::EUsage::Stream))
+	{
+	}
+
+	ClusterLightBuffers::~ClusterLightBuffers() = default;
+
+	void ClusterLightBuffers::upload(const std::vector<ClusterLight>& lights, const ClusterLightLists& lists)
+	{
+		m_lights->set_data(lights.data(), lights.size() * sizeof(ClusterLight));
+		m_ranges->set_data(lists.ranges.data(), lists.ranges.size() * sizeof(uint32_t));
+		m_indices->set_data(lists.indices.data(), lists.indices.size() * sizeof(uint32_t));
+	}
+
+	void ClusterLightBuffers::bind() const
+	{
+		m_lights->bind_base(s_lights_binding);
+		m_ranges->bind_base(s_ranges_binding);
+		m_indices->bind_base(s_indices_binding);
+	}
+}
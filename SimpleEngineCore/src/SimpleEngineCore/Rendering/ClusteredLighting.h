@@ -0,0 +1,106 @@
+#pragma once
+
+#include "OpenGL/Light.h"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class Camera;
+	class ShaderStorageBuffer;
+
+	// point or spot light as phong shader reads it (std430, 80 bytes)
+	struct ClusterLight {
+		glm::vec4 position_range{ 0.f };						// world position, distance after which light is invisible
+		glm::vec4 direction_cos_cutoff{ 0.f, 0.f, -1.f, -2.f };	// spot direction and cos of cut off angle, less than -1 for point light
+		glm::vec4 diffuse{ 0.f };								// color * intensity
+		glm::vec4 specular{ 0.f };
+		glm::vec4 attenuation{ 1.f, 0.f, 0.f, 0.f };			// constant, linear, quadratic
+
+		static ClusterLight from_point_light(const PointLight& light);
+		static ClusterLight from_spot_light(const SpotLight& light);
+		bool is_spot() const { return direction_cos_cutoff.w >= -1.f; }
+	};
+
+	// view frustum split into tiles on the screen and exponential depth slices (froxels)
+	// fragment finds its cluster from gl_FragCoord and view depth with these values
+	struct ClusterGrid {
+		static constexpr uint32_t s_tiles_x = 16;
+		static constexpr uint32_t s_tiles_y = 9;
+		static constexpr uint32_t s_slices = 24;
+		static constexpr uint32_t s_clusters_count = s_tiles_x * s_tiles_y * s_slices;
+
+		glm::vec2 tile_size{ 1.f };	// in pixels
+		float z_scale = 0.f;		// slice = log(view depth) * z_scale + z_bias
+		float z_bias = 0.f;
+	};
+
+	// cluster index is x + y * tiles_x + slice * tiles_x * tiles_y
+	struct ClusterLightLists {
+		std::vector<uint32_t> ranges;	// offset and count in indices for every cluster
+		std::vector<uint32_t> indices;	// into lights array
+	};
+
+	// main thread: finds lights which touch every cluster, slices are spread over job system threads
+	class ClusterLightAssigner {
+	public:
+		void assign(const Camera& camera, const unsigned int viewport_width, const unsigned int viewport_height,
+			const std::vector<ClusterLight>& lights, ClusterGrid& grid, ClusterLightLists& lists);
+
+	private:
+		// lights which overlap depth range of one slice, SoA for SIMD sphere-box test
+		struct SliceScratch {
+			std::vector<float> x, y, z, radius;
+			std::vector<uint32_t> lights;
+			std::vector<uint8_t> visible;
+			std::vector<uint32_t> indices;
+		};
+
+		void update_clusters(const Camera& camera, const unsigned int viewport_width, const unsigned int viewport_height);
+		void assign_slice(const uint32_t slice, const std::vector<ClusterLight>& lights, ClusterLightLists& lists);
+
+		// cluster boxes are in view space and change only with projection or viewport
+		glm::mat4 m_projection{ 0.f };
+		unsigned int m_viewport_width = 0;
+		unsigned int m_viewport_height = 0;
+		float m_near = 0.f;
+		float m_far = 0.f;
+		ClusterGrid m_grid;
+		float m_slice_depth[ClusterGrid::s_slices + 1] = {};
+		std::vector<glm::vec3> m_cluster_min;
+		std::vector<glm::vec3> m_cluster_max;
+		std::vector<glm::vec4> m_cluster_spheres;	// bounding spheres for spot cone test
+
+		// lights in view space
+		std::vector<float> m_light_x, m_light_y, m_light_z, m_light_radius;
+		std::vector<glm::vec3> m_light_direction;
+
+		std::vector<SliceScratch> m_slices;
+	};
+
+	// render thread: GPU copies of lights and lists, bound once for all phong draws of the frame
+	class ClusterLightBuffers {
+	public:
+		static constexpr unsigned int s_lights_binding = 0;
+		static constexpr unsigned int s_ranges_binding = 1;
+		static constexpr unsigned int s_indices_binding = 2;
+
+		ClusterLightBuffers();
+		~ClusterLightBuffers();
+
+		void upload(const std::vector<ClusterLight>& lights, const ClusterLightLists& lists);
+		void bind() const;
+
+	private:
+		std::unique_ptr<ShaderStorageBuffer> m_lights;
+		std::unique_ptr<ShaderStorageBuffer> m_ranges;
+		std::unique_ptr<ShaderStorageBuffer> m_indices;
+	};
+}
@@ -0,0 +1,113 @@
+#include "DepthPyramid.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr unsigned int s_group_size = 8;
+	}
+
+	DepthPyramid::DepthPyramid()
+	{
+		m_program = std::make_unique<ComputeProgram>(
+			"shaders/depth_pyramid_compute_shader.glsl");
+		if (!m_program->is_compiled()) {
+			LOG_CRIT_TO(Render, "Depth pyramid shader is not compiled");
+		}
+	}
+
+	DepthPyramid::~DepthPyramid()
+	{
+		glDeleteTextures(1, &m_texture);
+		GpuMemory::remove_allocation(m_gpu_memory);
+	}
+
+	void DepthPyramid::resize(const unsigned int source_width, const unsigned int source_height)
+	{
+		if (source_width == m_source_width && source_height == m_source_height && m_texture != 0) {
+			return;
+		}
+		m_source_width = source_width;
+		m_source_height = source_height;
+		m_valid = false;
+
+		glDeleteTextures(1, &m_texture);
+		GpuMemoryScope gpu_memory_owner("Depth pyramid");
+		const unsigned int width = std::max(source_width / 2, 1u);
+		const unsigned int height = std::max(source_height / 2, 1u);
+		m_levels = 1;
+		while ((std::max(width, height) >> m_levels) > 0) {
+			++m_levels;
+		}
+
+		glCreateTextures(GL_TEXTURE_2D, 1, &m_texture);
+		glTextureStorage2D(m_texture, m_levels, GL_R32F, width, height);
+		size_t bytes = 0;
+		for (int level = 0; level < m_levels; ++level) {
+			bytes += static_cast<size_t>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * sizeof(float);
+		}
+		if (m_gpu_memory == GpuMemory::s_invalid_handle) {
+			m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::RenderTargets, bytes);
+		}
+		else {
+			GpuMemory::resize_allocation(m_gpu_memory, bytes);
+		}
+		glTextureParameteri(m_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTextureParameteri(m_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTextureParameteri(m_texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(m_texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	void DepthPyramid::build(const unsigned int depth_texture, const unsigned int width, const unsigned int height, const bool reverse_z)
+	{
+		if (!m_program->is_compiled()) {
+			return;
+		}
+		resize(width, height);
+
+		m_program->bind();
+		m_program->set_int("sourceDepth", 0);
+		m_program->set_bool("reverseZ", reverse_z);
+
+		int source_width = static_cast<int>(width);
+		int source_height = static_cast<int>(height);
+		for (int level = 0; level < m_levels; ++level) {
+			// level 0 reads scene depth, others read previous level of the same texture
+			const bool from_scene = level == 0;
+			glBindTextureUnit(0, from_scene ? depth_texture : m_texture);
+			m_program->set_int("sourceLevel", from_scene ? 0 : level - 1);
+			m_program->set_ivec2("sourceSize", glm::ivec2(source_width, source_height));
+
+			const int destination_width = std::max(source_width / 2, 1);
+			const int destination_height = std::max(source_height / 2, 1);
+			m_program->set_ivec2("destinationSize", glm::ivec2(destination_width, destination_height));
+			glBindImageTexture(0, m_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+			ComputeProgram::dispatch(
+				ComputeProgram::get_groups_count(destination_width, s_group_size),
+				ComputeProgram::get_groups_count(destination_height, s_group_size));
+			// next level fetches what this one stored
+			ComputeProgram::memory_barrier(ComputeProgram::TextureFetch);
+
+			source_width = destination_width;
+			source_height = destination_height;
+		}
+
+		glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glBindTextureUnit(0, 0);
+		ComputeProgram::unbind();
+
+		m_reverse_z = reverse_z;
+		m_valid = true;
+	}
+
+	void DepthPyramid::bind(const unsigned int texture_unit) const
+	{
+		glBindTextureUnit(texture_unit, m_texture);
+	}
+}
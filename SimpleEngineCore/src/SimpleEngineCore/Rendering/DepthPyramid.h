@@ -0,0 +1,45 @@
+#pragma once
+
+#include "OpenGL/ComputeProgram.h"
+#include "OpenGL/GpuMemory.h"
+
+#include <memory>
+
+namespace SimpleEngine {
+
+	// render thread: mip chain of the farthest scene depth for GPU Hi-Z occlusion tests
+	// level 0 is half of depth texture, every next level halves again down to 1 x 1
+	class DepthPyramid {
+	public:
+		DepthPyramid();
+		~DepthPyramid();
+
+		DepthPyramid(const DepthPyramid&) = delete;
+		DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+		// reduces depth texture of given size, reverse_z selects min instead of max as the farthest
+		void build(const unsigned int depth_texture, const unsigned int width, const unsigned int height, const bool reverse_z);
+		void invalidate() { m_valid = false; }
+
+		void bind(const unsigned int texture_unit) const;
+
+		bool is_valid() const { return m_valid; }
+		bool is_reverse_z() const { return m_reverse_z; }
+		int get_levels() const { return m_levels; }
+		// size of depth texture it was built from
+		unsigned int get_source_width() const { return m_source_width; }
+		unsigned int get_source_height() const { return m_source_height; }
+
+	private:
+		void resize(const unsigned int source_width, const unsigned int source_height);
+
+		std::unique_ptr<ComputeProgram> m_program;
+		unsigned int m_texture = 0;
+		int m_levels = 0;
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
+		unsigned int m_source_width = 0;
+		unsigned int m_source_height = 0;
+		bool m_reverse_z = false;
+		bool m_valid = false;
+	};
+}
@@ -0,0 +1,81 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+namespace SimpleEngine {
+
+	FramePacer::FramePacer()
+	{
+#ifdef _WIN32
+		// default timer tick is 15.6 ms, sleep would overshoot the whole frame
+		timeBeginPeriod(1);
+#endif
+	}
+
+	FramePacer::~FramePacer()
+	{
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+	}
+
+	void FramePacer::set_target_rate(const float frames_per_second)
+	{
+		if (frames_per_second == m_target_rate) {
+			return;
+		}
+		m_target_rate = frames_per_second;
+		m_period = frames_per_second > 0.f
+			? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / frames_per_second))
+			: Clock::duration(0);
+		m_next_frame = Clock::time_point();
+	}
+
+	float FramePacer::wait()
+	{
+		if (m_period == Clock::duration(0)) {
+			return 0.f;
+		}
+
+		const Clock::time_point begin = Clock::now();
+		if (m_next_frame == Clock::time_point() || begin > m_next_frame + m_period) {
+			if (m_next_frame != Clock::time_point()) {
+				++m_missed_frames;
+			}
+			m_next_frame = begin + m_period;
+			return 0.f;
+		}
+
+		const Clock::time_point wake_up = m_next_frame - m_sleep_margin;
+		if (begin < wake_up) {
+			std::this_thread::sleep_until(wake_up);
+			const Clock::duration oversleep = std::max(Clock::now() - wake_up, Clock::duration(0));
+			m_average_oversleep += (oversleep - m_average_oversleep) / 8;
+			// twice the average covers usual jitter, single late wake up widens margin at once
+			m_sleep_margin = std::clamp(std::max(m_average_oversleep * 2, oversleep), s_min_sleep_margin, s_max_sleep_margin);
+		}
+		while (Clock::now() < m_next_frame) {
+			std::this_thread::yield();
+		}
+		m_next_frame += m_period;
+
+		return std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+	}
+
+	float FramePacer::get_sleep_margin_ms() const
+	{
+		return std::chrono::duration<float, std::milli>(m_sleep_margin).count();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace SimpleEngine {
+
+	// starts frames at fixed rate without vsync, main thread waits in it before polling input
+	// sleep wakes up late by up to a scheduler tick, so it sleeps until a margin before deadline and spins the rest,
+	// margin follows measured oversleep
+	class FramePacer {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		FramePacer();
+		~FramePacer();
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		// 0 or less - no limit
+		void set_target_rate(const float frames_per_second);
+		float get_target_rate() const { return m_target_rate; }
+
+		// returns how long it waited in ms
+		// frame late by less than a period is caught up by the next one, later than that restarts the schedule
+		float wait();
+
+		// frames which started later than a whole period after their deadline
+		size_t get_missed_frames() const { return m_missed_frames; }
+		float get_sleep_margin_ms() const;
+
+	private:
+		static constexpr Clock::duration s_min_sleep_margin = std::chrono::microseconds(100);
+		static constexpr Clock::duration s_max_sleep_margin = std::chrono::milliseconds(4);
+
+		float m_target_rate = 0.f;
+		Clock::duration m_period{ 0 };
+		Clock::time_point m_next_frame;
+		Clock::duration m_sleep_margin = std::chrono::milliseconds(1);
+		Clock::duration m_average_oversleep{ 0 };
+		size_t m_missed_frames = 0;
+	};
+}
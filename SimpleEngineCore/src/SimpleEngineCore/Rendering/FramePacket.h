@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Modules/UIModule.h"
+#include "OpenGL/Light.h"
+#include "OpenGL/DrawContext.h"
+#include "ClusteredLighting.h"
+#include "ShadowCascades.h"
+#include "GpuDrivenRenderer.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// built from ECS entities, render thread only uploads it
+	struct DrawItem {
+		Drawable* drawable = nullptr;
+		DrawInstance instance;
+	};
+
+	// everything render thread needs for one frame
+	// main thread fills it and after submit doesn't touch it until render thread gives slot back
+	struct FramePacket {
+		using Clock = std::chrono::steady_clock;
+		static constexpr size_t s_arena_capacity = 64 * 1024;
+		// main thread fills one packet while render thread draws the other
+		// drawables referenced by a packet have to live this many rendered frames after their last use
+		static constexpr uint64_t s_frames_in_flight = 2;
+
+		uint64_t frame_index = 0;
+		// when input for this frame was polled, latency is measured from here to the end of swap
+		Clock::time_point input_time;
+		// the oldest input event handled in this frame, input latency probe measures from it
+		Clock::time_point input_event_time;
+		bool has_input_event = false;
+		// render thread draws with the newest camera published by main thread instead of this one
+		bool late_latch_camera = false;
+
+		// applied by render thread before swap when it changes, see Window::set_swap_interval
+		int swap_interval = 1;
+		// steady-state frame, render thread draws it in no-alloc zone
+		bool check_allocations = false;
+
+		unsigned int viewport_width = 0;
+		unsigned int viewport_height = 0;
+		float background_color[4] = { 0, 0, 0, 1 };
+
+		Camera camera;
+
+		DirectionalLight directional_light;
+		PointLight point_light;
+		bool use_directional_light = true;
+		glm::vec3 ambient_light{ 0.f };
+
+		// point and spot lights with their lists per cluster, assigned on main thread
+		std::vector<ClusterLight> lights;
+		ClusterGrid cluster_grid;
+		ClusterLightLists cluster_lists;
+
+		// directional light shadow, static casters are redrawn only when static_shadow_version changes
+		ShadowCascades shadow_cascades;
+		std::vector<ShadowCaster> static_shadow_casters;
+		std::vector<ShadowCaster> dynamic_shadow_casters;
+		uint64_t static_shadow_version = 0;
+
+		bool use_depth_prepass = true;
+		bool reverse_z = false;	// camera projection is made for it
+
+		// cleared every frame, capacity stays
+		std::vector<DrawItem> draws;
+		// entities culled and drawn by GPU driven renderer, they are not in draws
+		std::vector<GpuInstance> gpu_instances;
+		bool use_gpu_driven = false;
+
+		UIDrawData ui_draw_data;
+
+		// temporaries of this frame, reset when slot is taken for the next frame
+		// every slot has own arena, so main thread fills one while render thread reads the other
+		LinearArena arena{ s_arena_capacity, MemoryTag::Frame };
+	};
+}
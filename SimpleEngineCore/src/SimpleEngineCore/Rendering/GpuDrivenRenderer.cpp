@@ -0,0 +1,194 @@
+#include "GpuDrivenRenderer.h"
+
+#include "OpenGL/Mesh.h"
+#include "OpenGL/Renderer_OpenGL.h"
+#include "SimpleEngineCore/Log.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr unsigned int s_group_size = 64;
+		// DrawElementsIndirectCommand
+		constexpr size_t s_command_size = 5 * sizeof(uint32_t);
+
+		constexpr unsigned int s_instances_binding = 3;
+		constexpr unsigned int s_commands_binding = 4;
+		constexpr unsigned int s_draw_count_binding = 5;
+
+		ShaderStorageBuffer make_buffer(const size_t size)
+		{
+			return ShaderStorageBuffer(nullptr, size);
+		}
+	}
+
+	GpuDrivenRenderer::GpuDrivenRenderer(Mesh& mesh)
+		: m_mesh(mesh)
+		, m_instances(make_buffer(s_max_instances * sizeof(GpuInstance)))
+		, m_commands(make_buffer(s_max_instances * s_command_size))
+		, m_draw_count(make_buffer(sizeof(uint32_t)))
+		, m_readback{ make_buffer(sizeof(uint32_t)), make_buffer(sizeof(uint32_t)),
+			make_buffer(sizeof(uint32_t)), make_buffer(sizeof(uint32_t)) }
+	{
+		const std::filesystem::path shader_path = "shaders";
+		m_cull_program = std::make_unique<ComputeProgram>((shader_path / "gpu_cull_compute_shader.glsl").string());
+		m_color_program = std::make_unique<ShaderProgram>(
+			(shader_path / "phong_instanced_vertex_shader.glsl").string(),
+			(shader_path / "phong_cube_fragment_shader.glsl").string());
+		m_depth_program = std::make_unique<ShaderProgram>(
+			(shader_path / "depth_only_instanced_vertex_shader.glsl").string(),
+			(shader_path / "depth_only_fragment_shader.glsl").string());
+		if (!is_ready()) {
+			LOG_CRIT_TO(Render, "GPU driven rendering shaders are not compiled");
+		}
+
+		// own vertex array with one more attribute: instance index at location 3
+		// GPU only geometry is never evicted, so its buffers are shared, evictable one is copied from its arrays
+		const MeshGeometry& geometry = mesh.GetGeometry();
+		m_vao = std::make_unique<VertexArray>();
+		if (geometry.has_cpu_data()) {
+			const std::vector<GLfloat>& vertices = geometry.get_vertices();
+			m_vbo = std::make_unique<VertexBuffer>(vertices.data(), vertices.size() * sizeof(GLfloat),
+				BufferLayout{ ShaderDataType::Float3, ShaderDataType::Float3, ShaderDataType::Float2 });
+			m_vao->add_vertex_buffer(*m_vbo);
+		}
+		else {
+			m_vao->add_vertex_buffer(geometry.get_vertex_buffer());
+		}
+
+		std::vector<int32_t> instance_indices(s_max_instances);
+		std::iota(instance_indices.begin(), instance_indices.end(), 0);
+		m_instance_index_vbo = std::make_unique<VertexBuffer>(instance_indices.data(), instance_indices.size() * sizeof(int32_t),
+			BufferLayout{ ShaderDataType::Int });
+		m_vao->add_instance_buffer(*m_instance_index_vbo);
+
+		if (geometry.has_cpu_data()) {
+			m_index_buffer = std::make_unique<IndexBuffer>(geometry.get_indices(), geometry.get_vertices_count());
+			m_vao->set_index_buffer(*m_index_buffer);
+		}
+		else {
+			m_vao->set_index_buffer(geometry.get_index_buffer());
+		}
+		VertexArray::unbind();
+	}
+
+	GpuDrivenRenderer::~GpuDrivenRenderer() = default;
+
+	bool GpuDrivenRenderer::is_ready() const
+	{
+		return m_cull_program->is_compiled() && m_color_program->is_compiled() && m_depth_program->is_compiled();
+	}
+
+	void GpuDrivenRenderer::cull(const std::vector<GpuInstance>& instances, const glm::mat4& view_projection, const bool reverse_z)
+	{
+		if (instances.size() > s_max_instances && m_instances_count != s_max_instances) {
+			LOG_WARN_TO(Render, "GPU driven renderer: {0} instances, only {1} are drawn", instances.size(), s_max_instances);
+		}
+		m_instances_count = static_cast<uint32_t>(std::min<size_t>(instances.size(), s_max_instances));
+		m_stats.instances = m_instances_count;
+
+		// count which GPU wrote s_readback_count - 1 frames ago
+		const size_t slot = m_readback_frame % s_readback_count;
+		if (m_readback_frame >= s_readback_count) {
+			uint32_t visible = 0;
+			m_readback[slot].read(&visible, sizeof(visible));
+			m_stats.visible_instances = visible;
+		}
+
+		m_draw_count.clear();
+		if (!is_ready() || m_instances_count == 0) {
+			m_draw_count.copy_to(m_readback[slot], sizeof(uint32_t));
+			++m_readback_frame;
+			return;
+		}
+
+		m_instances.set_data(instances.data(), m_instances_count * sizeof(GpuInstance));
+		if (!Renderer_OpenGL::supports_indirect_count()) {
+			// all commands are issued, the ones not written this frame must draw nothing
+			m_commands.clear();
+		}
+
+		m_instances.bind_base(s_instances_binding);
+		m_commands.bind_base(s_commands_binding);
+		m_draw_count.bind_base(s_draw_count_binding);
+
+		// pyramid is valid only for the same depth convention it was built with
+		const bool use_hiz = m_pyramid.is_valid() && m_pyramid.is_reverse_z() == reverse_z;
+
+		m_timer.begin();
+		m_cull_program->bind();
+		m_cull_program->set_uint("instanceCount", m_instances_count);
+		m_cull_program->set_uint("indexCount", static_cast<unsigned int>(m_vao->get_indices_count()));
+		m_cull_program->set_matrix4("viewProjection", view_projection);
+		m_cull_program->set_bool("reverseZ", reverse_z);
+		m_cull_program->set_bool("hizEnabled", use_hiz);
+		m_cull_program->set_int("hiz", static_cast<int>(s_pyramid_texture_unit));
+		m_cull_program->set_int("hizLevels", m_pyramid.get_levels());
+		m_cull_program->set_matrix4("previousViewProjection", m_pyramid_view_projection);
+		glUniform2f(m_cull_program->get_uniform_location("viewportSize"),
+			static_cast<float>(m_pyramid.get_source_width()), static_cast<float>(m_pyramid.get_source_height()));
+		if (use_hiz) {
+			m_pyramid.bind(s_pyramid_texture_unit);
+		}
+
+		ComputeProgram::dispatch(ComputeProgram::get_groups_count(m_instances_count, s_group_size));
+		// commands and count feed indirect draw, instances are read by vertex shaders
+		ComputeProgram::memory_barrier(ComputeProgram::Command | ComputeProgram::ShaderStorage);
+		ComputeProgram::unbind();
+		m_timer.end();
+		m_stats.cull_ms = m_timer.get_ms();
+
+		m_draw_count.copy_to(m_readback[slot], sizeof(uint32_t));
+		++m_readback_frame;
+	}
+
+	void GpuDrivenRenderer::draw_depth(const glm::mat4& view_projection) const
+	{
+		if (!is_ready() || m_instances_count == 0) {
+			return;
+		}
+		m_depth_program->bind();
+		m_depth_program->set_matrix4("view_projection", view_projection);
+
+		m_instances.bind_base(s_instances_binding);
+		m_commands.bind_as_draw_indirect();
+		m_draw_count.bind_as_parameter();
+		Renderer_OpenGL::multi_draw_indirect_count(*m_vao, m_instances_count);
+		ShaderStorageBuffer::unbind_draw_indirect();
+		ShaderStorageBuffer::unbind_parameter();
+	}
+
+	void GpuDrivenRenderer::draw(const DrawContext& context, const glm::mat4& view_projection) const
+	{
+		if (!is_ready() || m_instances_count == 0) {
+			return;
+		}
+		m_color_program->bind();
+		m_mesh.BindTextures(*m_color_program);
+		Cube::SetFrameUniforms(*m_color_program, context);
+		m_material.UseMaterial(
+			m_color_program->get_uniform_location("material.ambient"),
+			m_color_program->get_uniform_location("material.shininess"));
+		m_color_program->set_matrix4("view_projection", view_projection);
+
+		m_instances.bind_base(s_instances_binding);
+		m_commands.bind_as_draw_indirect();
+		m_draw_count.bind_as_parameter();
+		Renderer_OpenGL::multi_draw_indirect_count(*m_vao, m_instances_count);
+		ShaderStorageBuffer::unbind_draw_indirect();
+		ShaderStorageBuffer::unbind_parameter();
+	}
+
+	void GpuDrivenRenderer::update_depth_pyramid(const unsigned int depth_texture, const unsigned int width, const unsigned int height,
+		const glm::mat4& view_projection, const bool reverse_z)
+	{
+		if (!is_ready()) {
+			return;
+		}
+		// previous view projection goes with pyramid, so after resize old pyramid is still consistent
+		m_pyramid.build(depth_texture, width, height, reverse_z);
+		m_pyramid_view_projection = view_projection;
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "DepthPyramid.h"
+#include "OpenGL/ComputeProgram.h"
+#include "OpenGL/ShaderStorageBuffer.h"
+#include "OpenGL/GpuQuery.h"
+#include "OpenGL/Material.h"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class Mesh;
+	class ShaderProgram;
+	class VertexArray;
+	class VertexBuffer;
+	class IndexBuffer;
+	struct DrawContext;
+
+	// std430 layout of GpuInstance in gpu_cull_compute_shader and *_instanced_vertex_shader
+	struct GpuInstance {
+		glm::mat4 model{ 1.f };
+		glm::vec4 normal[3] = { { 1.f, 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f, 0.f }, { 0.f, 0.f, 1.f, 0.f } };
+		glm::vec4 bounds_center{ 0.f };	// local box
+		glm::vec4 bounds_extent{ 0.f };
+	};
+	static_assert(sizeof(GpuInstance) == 144, "GpuInstance has to match std430 layout");
+
+	// render thread: many instances of one mesh culled by compute shader and drawn by one indirect call
+	// frustum test uses current camera, occlusion test uses depth pyramid of previous frame,
+	// so objects appearing from behind occluders show up one frame late
+	class GpuDrivenRenderer {
+	public:
+		static constexpr uint32_t s_max_instances = 16384;
+		static constexpr unsigned int s_pyramid_texture_unit = 6;
+
+		struct Stats {
+			uint32_t instances = 0;
+			uint32_t visible_instances = 0;	// read back a few frames later
+			float cull_ms = 0.f;
+		};
+
+		// mesh gives vertices and textures, it has to outlive renderer
+		explicit GpuDrivenRenderer(Mesh& mesh);
+		~GpuDrivenRenderer();
+
+		GpuDrivenRenderer(const GpuDrivenRenderer&) = delete;
+		GpuDrivenRenderer& operator=(const GpuDrivenRenderer&) = delete;
+
+		bool is_ready() const;
+		void set_material(const Material& material) { m_material = material; }
+
+		// uploads instances and builds draw commands of visible ones
+		void cull(const std::vector<GpuInstance>& instances, const glm::mat4& view_projection, const bool reverse_z);
+		// depth program state (color write, depth func) is set by caller
+		void draw_depth(const glm::mat4& view_projection) const;
+		void draw(const DrawContext& context, const glm::mat4& view_projection) const;
+		// after scene is drawn: its depth becomes occluders of the next frame
+		void update_depth_pyramid(const unsigned int depth_texture, const unsigned int width, const unsigned int height,
+			const glm::mat4& view_projection, const bool reverse_z);
+
+		// pyramid of old frames would hide what is visible now, call when frames were drawn without it
+		void invalidate_depth_pyramid() { m_pyramid.invalidate(); }
+
+		const Stats& get_stats() const { return m_stats; }
+
+	private:
+		static constexpr size_t s_readback_count = 4;
+
+		Mesh& m_mesh;
+		Material m_material;
+
+		std::unique_ptr<ComputeProgram> m_cull_program;
+		std::unique_ptr<ShaderProgram> m_color_program;
+		std::unique_ptr<ShaderProgram> m_depth_program;
+
+		std::unique_ptr<VertexArray> m_vao;
+		// m_vbo and m_index_buffer are null when buffers of GPU only geometry are shared
+		std::unique_ptr<VertexBuffer> m_vbo;
+		std::unique_ptr<VertexBuffer> m_instance_index_vbo;	// 0, 1, 2, ... picked by baseInstance
+		std::unique_ptr<IndexBuffer> m_index_buffer;
+
+		ShaderStorageBuffer m_instances;
+		ShaderStorageBuffer m_commands;
+		ShaderStorageBuffer m_draw_count;
+		// draw count copies, read when GPU is surely done with them
+		ShaderStorageBuffer m_readback[s_readback_count];
+		size_t m_readback_frame = 0;
+
+		DepthPyramid m_pyramid;
+		glm::mat4 m_pyramid_view_projection{ 1.f };
+
+		uint32_t m_instances_count = 0;
+		GpuTimer m_timer;
+		Stats m_stats;
+	};
+}
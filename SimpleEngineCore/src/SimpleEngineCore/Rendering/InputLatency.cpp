@@ -0,0 +1,81 @@
+#include "InputLatency.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimpleEngine {
+
+	void LatencyProbe::record(const float latency_ms)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_history[m_next] = latency_ms;
+		m_next = (m_next + 1) % s_history_size;
+		m_count = std::min(m_count + 1, s_history_size);
+	}
+
+	size_t LatencyProbe::get_history(float* out, const size_t capacity) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const size_t count = std::min(m_count, capacity);
+		// the last count samples, oldest first
+		const size_t first = (m_next + s_history_size - count) % s_history_size;
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = m_history[(first + i) % s_history_size];
+		}
+		return count;
+	}
+
+	LatencyProbe::Summary LatencyProbe::get_summary() const
+	{
+		std::array<float, s_history_size> sorted;
+		const size_t count = get_history(sorted.data(), sorted.size());
+
+		Summary summary;
+		summary.samples = count;
+		if (count == 0) {
+			return summary;
+		}
+		double sum = 0.0;
+		double sum_squares = 0.0;
+		for (size_t i = 0; i < count; ++i) {
+			sum += sorted[i];
+			sum_squares += static_cast<double>(sorted[i]) * sorted[i];
+		}
+		const double mean = sum / static_cast<double>(count);
+		summary.mean_ms = static_cast<float>(mean);
+		summary.stddev_ms = static_cast<float>(std::sqrt(std::max(0.0, sum_squares / static_cast<double>(count) - mean * mean)));
+
+		std::sort(sorted.begin(), sorted.begin() + count);
+		// nearest rank
+		const auto percentile = [&](const float p) {
+			const size_t rank = static_cast<size_t>(p * static_cast<float>(count - 1) + 0.5f);
+			return sorted[std::min(rank, count - 1)];
+		};
+		summary.p50_ms = percentile(0.5f);
+		summary.p95_ms = percentile(0.95f);
+		summary.p99_ms = percentile(0.99f);
+		summary.max_ms = sorted[count - 1];
+		return summary;
+	}
+
+	void CameraLatch::publish(const Camera& camera, const bool has_input, const Clock::time_point input_time)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_camera = camera;
+		m_published = true;
+		m_has_input = has_input;
+		m_input_time = input_time;
+	}
+
+	bool CameraLatch::get(Camera& camera, bool& has_input, Clock::time_point& input_time) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_published) {
+			return false;
+		}
+		camera = m_camera;
+		has_input = m_has_input;
+		input_time = m_input_time;
+		return true;
+	}
+}
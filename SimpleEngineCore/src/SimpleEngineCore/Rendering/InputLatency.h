@@ -0,0 +1,59 @@
+#pragma once
+
+#include "SimpleEngineCore/Camera.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace SimpleEngine {
+
+	// timings of the last frames (input event to end of swap, swap to swap), written by render thread and read by main thread
+	class LatencyProbe {
+	public:
+		static constexpr size_t s_history_size = 240;
+
+		struct Summary {
+			size_t samples = 0;
+			float p50_ms = 0.f;
+			float p95_ms = 0.f;
+			float p99_ms = 0.f;
+			float max_ms = 0.f;
+			float mean_ms = 0.f;
+			float stddev_ms = 0.f;	// frame time variance shows stutter which mean hides
+		};
+
+		void record(const float latency_ms);
+		// oldest first, returns how many were written
+		size_t get_history(float* out, const size_t capacity) const;
+		// over samples in history
+		Summary get_summary() const;
+
+	private:
+		mutable std::mutex m_mutex;
+		std::array<float, s_history_size> m_history{};
+		size_t m_next = 0;
+		size_t m_count = 0;
+	};
+
+	// the newest camera moved by input, main thread publishes it every frame
+	// render thread draws with it instead of camera of packet built earlier (late-latch),
+	// with render thread that is input of the frame which is being built while this one is drawn
+	class CameraLatch {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// input_time is the oldest input event which moved camera, has_input = false when there was none
+		void publish(const Camera& camera, const bool has_input, const Clock::time_point input_time);
+		// false when nothing was published yet
+		bool get(Camera& camera, bool& has_input, Clock::time_point& input_time) const;
+
+	private:
+		mutable std::mutex m_mutex;
+		Camera m_camera;
+		bool m_published = false;
+		bool m_has_input = false;
+		Clock::time_point m_input_time;
+	};
+}
@@ -0,0 +1,62 @@
+#include "LodSelection.h"
+
+#include "SimpleEngineCore/Camera.h"
+
+#include <glm/glm.hpp>
+
+#include <limits>
+
+namespace SimpleEngine {
+
+	float LodSelector::get_projected_radius(const Camera& camera, const glm::vec3& world_center, const float world_radius)
+	{
+		// proj[1][1] = 1 / tan(fov / 2) for perspective, 1 / top for orthographic
+		const float half_height = camera.get_viewport_h() * 0.5f;
+		const float projection_scale = camera.get_projection_matrix()[1][1];
+
+		const glm::mat4 view = camera.get_view_matrix();
+		const glm::vec4 view_pos = view * glm::vec4(world_center, 1.f);
+		// orthographic projection has w = 1
+		if (camera.get_projection_matrix()[3][3] == 1.f) {
+			return world_radius * projection_scale * half_height;
+		}
+		const float distance = -view_pos.z;
+		if (distance <= world_radius) {
+			return std::numeric_limits<float>::max(); // we are inside of the sphere
+		}
+		return world_radius * projection_scale * half_height / distance;
+	}
+
+	size_t LodSelector::select(
+		const std::vector<LodLevel>& lods,
+		const float bounding_radius,
+		const float projected_radius,
+		const size_t current_lod) const
+	{
+		if (lods.size() < 2 || bounding_radius <= 0.f) {
+			return 0;
+		}
+		// model space error -> pixels
+		const float pixels_per_unit = projected_radius / bounding_radius;
+		auto screen_error = [&](const size_t lod) { return lods[lod].error * pixels_per_unit; };
+
+		size_t target = 0;
+		for (size_t i = 1; i < lods.size(); ++i) {
+			if (screen_error(i) <= pixel_error) {
+				target = i;
+			}
+		}
+		if (target <= current_lod) {
+			// going to finer level (or stay) as soon as current one is not good enough
+			return screen_error(current_lod) > pixel_error ? target : current_lod;
+		}
+		// going to coarser level only with margin
+		size_t result = current_lod;
+		for (size_t i = current_lod + 1; i <= target; ++i) {
+			if (screen_error(i) <= pixel_error * (1.f - hysteresis)) {
+				result = i;
+			}
+		}
+		return result;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshSimplifier.h"
+
+#include <glm/vec3.hpp>
+
+#include <vector>
+
+namespace SimpleEngine {
+
+	class Camera;
+
+	// picks LOD from size of bounding sphere on the screen
+	// level is fine while its error projected on the screen is less than pixel_error
+	class LodSelector {
+	public:
+		float pixel_error = 1.f;	// LodLevel::error projected to pixels we accept, it is RMS estimate, not a strict max
+		float hysteresis = 0.25f;	// coarser level has to be this part better than threshold, no popping on the border
+
+		// radius of world space sphere on the screen in pixels
+		static float get_projected_radius(const Camera& camera, const glm::vec3& world_center, const float world_radius);
+
+		size_t select(
+			const std::vector<LodLevel>& lods,
+			const float bounding_radius,
+			const float projected_radius,
+			const size_t current_lod) const;
+	};
+}
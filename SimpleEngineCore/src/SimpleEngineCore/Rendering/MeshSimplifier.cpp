@@ -0,0 +1,311 @@
+#include "MeshSimplifier.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	namespace {
+		// symmetric 4x4 matrix, only 10 values are stored
+		// planes are weighted by triangle area, w keeps sum of weights to get back to distance
+		struct Quadric {
+			double a2 = 0, ab = 0, ac = 0, ad = 0;
+			double b2 = 0, bc = 0, bd = 0;
+			double c2 = 0, cd = 0;
+			double d2 = 0;
+			double w = 0;
+
+			static Quadric from_plane(const double a, const double b, const double c, const double d, const double weight) {
+				Quadric q;
+				q.a2 = a * a * weight; q.ab = a * b * weight; q.ac = a * c * weight; q.ad = a * d * weight;
+				q.b2 = b * b * weight; q.bc = b * c * weight; q.bd = b * d * weight;
+				q.c2 = c * c * weight; q.cd = c * d * weight;
+				q.d2 = d * d * weight;
+				q.w = weight;
+				return q;
+			}
+
+			Quadric& operator+=(const Quadric& o) {
+				a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+				b2 += o.b2; bc += o.bc; bd += o.bd;
+				c2 += o.c2; cd += o.cd;
+				d2 += o.d2;
+				w += o.w;
+				return *this;
+			}
+
+			// v^T * Q * v / w = weighted mean of squared distances to all planes
+			double error(const glm::vec3& p) const {
+				const double x = p.x, y = p.y, z = p.z;
+				const double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+					+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+					+ c2 * z * z + 2 * cd * z
+					+ d2;
+				return w > 0 ? std::abs(e) / w : 0.0;
+			}
+		};
+
+		struct Collapse {
+			double cost;
+			uint32_t from;
+			uint32_t to;
+			uint32_t from_version;
+			uint32_t to_version;
+
+			bool operator>(const Collapse& o) const { return cost > o.cost; }
+		};
+
+		uint64_t edge_key(uint32_t a, uint32_t b) {
+			if (a > b) std::swap(a, b);
+			return (static_cast<uint64_t>(a) << 32) | b;
+		}
+	}
+
+	float MeshSimplifier::get_mesh_extent(const std::vector<glm::vec3>& positions)
+	{
+		if (positions.empty()) {
+			return 0.f;
+		}
+		glm::vec3 min_pos = positions[0];
+		glm::vec3 max_pos = positions[0];
+		for (const glm::vec3& p : positions) {
+			min_pos = glm::min(min_pos, p);
+			max_pos = glm::max(max_pos, p);
+		}
+		return glm::length(max_pos - min_pos) * 0.5f;
+	}
+
+	MeshSimplifier::Result MeshSimplifier::simplify(
+		const std::vector<glm::vec3>& positions,
+		const std::vector<uint32_t>& indices,
+		const size_t target_index_count,
+		const float target_error)
+	{
+		Result result;
+		const size_t vertices_count = positions.size();
+		const size_t triangles_count = indices.size() / 3;
+
+		const float extent = get_mesh_extent(positions);
+		const double max_error = static_cast<double>(target_error) * extent;
+		const double max_cost = max_error * max_error;
+
+		// everything except result is temporary, it goes to scratch arena of this thread and is freed at once
+		ScratchScope scratch;
+		const ArenaAllocator<uint32_t> index_allocator = scratch.get_allocator<uint32_t>();
+
+		// 1. quadric for every vertex from planes of its triangles
+		ArenaVector<Quadric> quadrics(vertices_count, Quadric(), index_allocator);
+		ArenaVector<ArenaVector<uint32_t>> vertex_triangles(vertices_count, ArenaVector<uint32_t>(index_allocator), index_allocator);
+		std::unordered_map<uint64_t, uint32_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+			ArenaAllocator<std::pair<const uint64_t, uint32_t>>> edge_uses(index_allocator);
+		edge_uses.reserve(indices.size());
+
+		for (uint32_t t = 0; t < triangles_count; ++t) {
+			const uint32_t i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+			const glm::vec3 n = glm::cross(positions[i1] - positions[i0], positions[i2] - positions[i0]);
+			const float area2 = glm::length(n);
+			if (area2 > 0.f) {
+				const glm::vec3 un = n / area2;
+				const Quadric q = Quadric::from_plane(un.x, un.y, un.z, -glm::dot(un, positions[i0]), area2 * 0.5);
+				quadrics[i0] += q;
+				quadrics[i1] += q;
+				quadrics[i2] += q;
+			}
+			vertex_triangles[i0].push_back(t);
+			vertex_triangles[i1].push_back(t);
+			vertex_triangles[i2].push_back(t);
+			++edge_uses[edge_key(i0, i1)];
+			++edge_uses[edge_key(i1, i2)];
+			++edge_uses[edge_key(i2, i0)];
+		}
+
+		// 2. border edges (used by one triangle) get a plane perpendicular to the triangle
+		// otherwise holes and silhouettes of open meshes shrink very fast
+		ArenaVector<bool> is_border(vertices_count, false, index_allocator);
+		for (uint32_t t = 0; t < triangles_count; ++t) {
+			const uint32_t tri[3] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+			const glm::vec3 n = glm::cross(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+			if (glm::length(n) == 0.f) {
+				continue;
+			}
+			for (int e = 0; e < 3; ++e) {
+				const uint32_t a = tri[e], b = tri[(e + 1) % 3];
+				if (edge_uses[edge_key(a, b)] != 1) {
+					continue;
+				}
+				const glm::vec3 edge = positions[b] - positions[a];
+				glm::vec3 border_normal = glm::cross(edge, n);
+				const float len = glm::length(border_normal);
+				if (len == 0.f) {
+					continue;
+				}
+				border_normal /= len;
+				const double weight = glm::dot(edge, edge) * 10.0;
+				const Quadric q = Quadric::from_plane(border_normal.x, border_normal.y, border_normal.z, -glm::dot(border_normal, positions[a]), weight);
+				quadrics[a] += q;
+				quadrics[b] += q;
+				is_border[a] = true;
+				is_border[b] = true;
+			}
+		}
+
+		// 3. candidates for every edge, we collapse into endpoint with smaller error
+		ArenaVector<uint32_t> versions(vertices_count, 0, index_allocator);
+		ArenaVector<uint32_t> remap(vertices_count, 0, index_allocator);
+		for (uint32_t v = 0; v < vertices_count; ++v) {
+			remap[v] = v;
+		}
+		ArenaVector<bool> triangle_alive(triangles_count, true, index_allocator);
+		ArenaVector<uint32_t> tris(indices.begin(), indices.end(), index_allocator);
+
+		// every edge is pushed at least once
+		ArenaVector<Collapse> heap_storage(index_allocator);
+		heap_storage.reserve(indices.size());
+		std::priority_queue<Collapse, ArenaVector<Collapse>, std::greater<Collapse>> heap(std::greater<Collapse>(), std::move(heap_storage));
+		auto push_edge = [&](const uint32_t a, const uint32_t b) {
+			Quadric q = quadrics[a];
+			q += quadrics[b];
+			const double cost_ab = q.error(positions[b]); // a -> b
+			const double cost_ba = q.error(positions[a]); // b -> a
+			// don't move border vertices inside
+			const bool can_ab = !is_border[a] || is_border[b];
+			const bool can_ba = !is_border[b] || is_border[a];
+			if (can_ab && (!can_ba || cost_ab <= cost_ba)) {
+				heap.push({ cost_ab, a, b, versions[a], versions[b] });
+			}
+			else if (can_ba) {
+				heap.push({ cost_ba, b, a, versions[b], versions[a] });
+			}
+		};
+		for (const auto& [key, uses] : edge_uses) {
+			push_edge(static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFFu));
+		}
+
+		size_t alive_triangles = triangles_count;
+		double worst_cost = 0.0;
+
+		// collapse would flip some triangle around from vertex -> rejected
+		auto flips = [&](const uint32_t from, const uint32_t to) {
+			for (const uint32_t t : vertex_triangles[from]) {
+				if (!triangle_alive[t]) continue;
+				uint32_t* tri = &tris[t * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to) continue; // will be removed
+				glm::vec3 p[3];
+				glm::vec3 moved[3];
+				for (int k = 0; k < 3; ++k) {
+					p[k] = positions[tri[k]];
+					moved[k] = tri[k] == from ? positions[to] : p[k];
+				}
+				const glm::vec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+				const glm::vec3 n1 = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				if (glm::dot(n0, n1) <= 0.f) return true;
+			}
+			return false;
+		};
+
+		while (alive_triangles * 3 > target_index_count && !heap.empty()) {
+			const Collapse c = heap.top();
+			heap.pop();
+
+			// stale entry - one of vertices was changed after we pushed it
+			if (remap[c.from] != c.from || remap[c.to] != c.to ||
+				versions[c.from] != c.from_version || versions[c.to] != c.to_version) {
+				continue;
+			}
+			if (c.cost > max_cost) {
+				break;
+			}
+			if (flips(c.from, c.to)) {
+				continue;
+			}
+
+			worst_cost = std::max(worst_cost, c.cost);
+			remap[c.from] = c.to;
+			quadrics[c.to] += quadrics[c.from];
+			++versions[c.to];
+
+			for (const uint32_t t : vertex_triangles[c.from]) {
+				if (!triangle_alive[t]) continue;
+				uint32_t* tri = &tris[t * 3];
+				for (int k = 0; k < 3; ++k) {
+					if (tri[k] == c.from) tri[k] = c.to;
+				}
+				if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+					triangle_alive[t] = false;
+					--alive_triangles;
+				}
+				else {
+					vertex_triangles[c.to].push_back(t);
+				}
+			}
+			vertex_triangles[c.from].clear();
+
+			// new costs for all edges around the vertex we kept
+			auto& to_triangles = vertex_triangles[c.to];
+			to_triangles.erase(std::remove_if(to_triangles.begin(), to_triangles.end(),
+				[&](const uint32_t t) { return !triangle_alive[t]; }), to_triangles.end());
+			for (const uint32_t t : to_triangles) {
+				const uint32_t* tri = &tris[t * 3];
+				for (int k = 0; k < 3; ++k) {
+					if (tri[k] != c.to) {
+						push_edge(c.to, tri[k]);
+					}
+				}
+			}
+		}
+
+		result.indices.reserve(alive_triangles * 3);
+		for (uint32_t t = 0; t < triangles_count; ++t) {
+			if (triangle_alive[t]) {
+				result.indices.insert(result.indices.end(), tris.begin() + t * 3, tris.begin() + t * 3 + 3);
+			}
+		}
+		result.error = static_cast<float>(std::sqrt(worst_cost));
+		return result;
+	}
+
+	std::vector<LodLevel> generate_lod_chain(
+		const std::vector<glm::vec3>& positions,
+		std::vector<uint32_t>& indices,
+		const LodSettings& settings)
+	{
+		std::vector<LodLevel> lods;
+		lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.f });
+
+		const size_t original_count = indices.size();
+		std::vector<uint32_t> source(indices.begin(), indices.end());
+		float accumulated_error = 0.f;
+
+		for (uint32_t level = 1; level < settings.levels_count; ++level) {
+			const size_t target = static_cast<size_t>(source.size() * settings.triangle_ratio) / 3 * 3;
+			if (target < 3) {
+				break;
+			}
+			MeshSimplifier::Result simplified = MeshSimplifier::simplify(positions, source, target, settings.max_error);
+			// can't go lower without breaking error limit
+			if (simplified.indices.size() >= source.size() || simplified.indices.empty()) {
+				break;
+			}
+			// every level starts from the previous one so errors add up
+			accumulated_error += simplified.error;
+
+			lods.push_back({
+				static_cast<uint32_t>(indices.size()),
+				static_cast<uint32_t>(simplified.indices.size()),
+				accumulated_error });
+			indices.insert(indices.end(), simplified.indices.begin(), simplified.indices.end());
+			source = std::move(simplified.indices);
+		}
+
+		LOG_INFO_TO(Render, "LOD chain: {0} levels, {1} -> {2} triangles",
+			lods.size(), original_count / 3, lods.back().index_count / 3);
+		return lods;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// Quadric error metric simplifier (Garland & Heckbert)
+	// Edges are collapsed into one of their vertices so simplified indices still point
+	// into the original vertex array and every LOD can share one vertex buffer
+	class MeshSimplifier {
+	public:
+		struct Result {
+			std::vector<uint32_t> indices;
+			// in model units, sqrt of the biggest quadric cost of all collapses:
+			// area weighted RMS distance from the kept vertex to the original planes around it,
+			// an estimate of the deviation, single points may be further away
+			float error = 0.f;
+		};
+
+		// target_index_count - stop when we have so many indices or less
+		// target_error - stop before collapse with bigger RMS error (see Result::error), relative to mesh size (0.01 = 1%)
+		static Result simplify(
+			const std::vector<glm::vec3>& positions,
+			const std::vector<uint32_t>& indices,
+			const size_t target_index_count,
+			const float target_error);
+
+		// radius of sphere around bounds center, used to make error relative
+		static float get_mesh_extent(const std::vector<glm::vec3>& positions);
+	};
+
+	struct LodSettings {
+		uint32_t levels_count = 4;		// including original mesh (LOD0)
+		float triangle_ratio = 0.5f;	// every level keeps this part of previous level triangles
+		float max_error = 0.05f;		// RMS error of one level relative to mesh size, we stop generating levels after that
+	};
+
+	struct LodLevel {
+		uint32_t first_index = 0;	// offset in shared index buffer
+		uint32_t index_count = 0;
+		float error = 0.f;			// RMS error estimate in model units, sum of errors of all previous levels
+	};
+
+	// all levels are written into one index array one by one
+	std::vector<LodLevel> generate_lod_chain(
+		const std::vector<glm::vec3>& positions,
+		std::vector<uint32_t>& indices,
+		const LodSettings& settings);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace SimpleEngine {
+
+	// kind of meshes of a Model, names are keys of meshRegistry in Mesh.h
+	enum class MeshType {
+		LightCube,
+		MeshNew		// phong lit, vertex stage is always phong_packed_vertex_shader
+	};
+}
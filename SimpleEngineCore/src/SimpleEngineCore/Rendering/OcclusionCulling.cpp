@@ -0,0 +1,344 @@
+#include "OcclusionCulling.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+
+#include <glm/vec4.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace SimpleEngine {
+
+	namespace {
+		// rounding of plane equations must not hide object which touches occluder
+		constexpr float s_depth_epsilon = 1e-3f;
+
+		// clip space vertex after near plane clipping
+		struct ClipVertex {
+			double x, y, w;
+		};
+
+		// cuts polygon by near plane, keeps part with w >= near_w
+		int clip_polygon_near(const ClipVertex* input, const int input_count, const double near_w, ClipVertex* output)
+		{
+			int output_count = 0;
+			for (int i = 0; i < input_count; ++i) {
+				const ClipVertex& a = input[i];
+				const ClipVertex& b = input[(i + 1) % input_count];
+				const bool a_inside = a.w >= near_w;
+				const bool b_inside = b.w >= near_w;
+				if (a_inside) {
+					output[output_count++] = a;
+				}
+				if (a_inside != b_inside) {
+					const double t = (near_w - a.w) / (b.w - a.w);
+					output[output_count++] = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, near_w };
+				}
+			}
+			return output_count;
+		}
+
+		// false if triangle has no pixel centers on the screen or no area
+		bool setup_triangle(const ClipVertex& c0, const ClipVertex& c1, const ClipVertex& c2, const int width, const int height,
+			OcclusionTriangle& triangle)
+		{
+			const ClipVertex* clip[3] = { &c0, &c1, &c2 };
+			double x[3], y[3], inverse_w[3];
+			for (int i = 0; i < 3; ++i) {
+				inverse_w[i] = 1.0 / clip[i]->w;
+				x[i] = (clip[i]->x * inverse_w[i] * 0.5 + 0.5) * width;
+				y[i] = (clip[i]->y * inverse_w[i] * 0.5 + 0.5) * height;
+			}
+			double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+			if (std::abs(area) < 1e-8) {
+				return false;
+			}
+			// both sides are drawn (closest depth wins anyway), edges are made for counter clockwise order
+			if (area < 0.0) {
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				std::swap(inverse_w[1], inverse_w[2]);
+				area = -area;
+			}
+
+			// pixel centers inside of bounds, clamped before conversion to int
+			const double min_x = std::max(std::min({ x[0], x[1], x[2] }), -1.0);
+			const double max_x = std::min(std::max({ x[0], x[1], x[2] }), static_cast<double>(width));
+			const double min_y = std::max(std::min({ y[0], y[1], y[2] }), -1.0);
+			const double max_y = std::min(std::max({ y[0], y[1], y[2] }), static_cast<double>(height));
+			triangle.min_x = std::max(static_cast<int>(std::ceil(min_x - 0.5)), 0);
+			triangle.max_x = std::min(static_cast<int>(std::floor(max_x - 0.5)), width - 1);
+			triangle.min_y = std::max(static_cast<int>(std::ceil(min_y - 0.5)), 0);
+			triangle.max_y = std::min(static_cast<int>(std::floor(max_y - 0.5)), height - 1);
+			if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+				return false;
+			}
+
+			// edge i is opposite to vertex i, so it is also barycentric weight of vertex i (times area)
+			double a[3], b[3], c[3];
+			for (int i = 0; i < 3; ++i) {
+				const int from = (i + 1) % 3;
+				const int to = (i + 2) % 3;
+				a[i] = y[from] - y[to];
+				b[i] = x[to] - x[from];
+				c[i] = x[from] * y[to] - y[from] * x[to];
+				triangle.edge_a[i] = static_cast<float>(a[i]);
+				triangle.edge_b[i] = static_cast<float>(b[i]);
+				triangle.edge_c[i] = static_cast<float>(c[i]);
+			}
+			// 1 / w is linear in screen space
+			triangle.depth_a = static_cast<float>((a[0] * inverse_w[0] + a[1] * inverse_w[1] + a[2] * inverse_w[2]) / area);
+			triangle.depth_b = static_cast<float>((b[0] * inverse_w[0] + b[1] * inverse_w[1] + b[2] * inverse_w[2]) / area);
+			triangle.depth_c = static_cast<float>((c[0] * inverse_w[0] + c[1] * inverse_w[1] + c[2] * inverse_w[2]) / area);
+			return true;
+		}
+
+		// all 4 corners of rectangle are outside of the same edge
+		bool is_rect_outside_triangle(const OcclusionTriangle& triangle, const float x0, const float y0, const float x1, const float y1)
+		{
+			for (int i = 0; i < 3; ++i) {
+				// the corner where edge function is the biggest
+				const float x = triangle.edge_a[i] > 0.f ? x1 : x0;
+				const float y = triangle.edge_b[i] > 0.f ? y1 : y0;
+				if (triangle.edge_a[i] * x + triangle.edge_b[i] * y + triangle.edge_c[i] < 0.f) {
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	OccluderMesh OccluderMesh::make_box()
+	{
+		OccluderMesh mesh;
+		for (int i = 0; i < 8; ++i) {
+			mesh.positions.emplace_back((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : -1.f);
+		}
+		mesh.indices = {
+			0, 2, 3, 3, 1, 0,	// -Z
+			4, 5, 7, 7, 6, 4,	// +Z
+			0, 1, 5, 5, 4, 0,	// -Y
+			2, 6, 7, 7, 3, 2,	// +Y
+			0, 4, 6, 6, 2, 0,	// -X
+			1, 3, 7, 7, 5, 1	// +X
+		};
+		return mesh;
+	}
+
+	void OcclusionBuffer::render(const Camera& camera, const ArenaVector<Occluder>& occluders)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		m_stats = Stats();
+
+		const glm::mat4 projection = camera.get_projection_matrix();
+		const float viewport_width = camera.get_viewport_w();
+		const float viewport_height = camera.get_viewport_h();
+		m_empty = projection[3][3] == 1.f || viewport_width <= 0.f || viewport_height <= 0.f;
+		if (m_empty) {
+			return;
+		}
+
+		// the same aspect as viewport, height is rounded to whole tiles
+		const int tiles_y = std::max(1, static_cast<int>(std::ceil(s_width * viewport_height / viewport_width / s_tile_size)));
+		resize(tiles_y * s_tile_size);
+		m_near_w = camera.get_near_clip_plane();
+
+		setup_triangles(occluders, projection * camera.get_view_matrix(), m_near_w);
+		bin_triangles();
+
+		JobSystem::parallel_for(static_cast<size_t>(m_tiles_x * m_tiles_y), 1,
+			[this](const size_t begin, const size_t end) {
+				for (size_t tile = begin; tile < end; ++tile) {
+					render_tile(static_cast<int>(tile));
+				}
+			});
+
+		m_stats.render_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	OcclusionBuffer::EVisibility OcclusionBuffer::test_box(const glm::mat4& mvp_matrix, const glm::vec3& center, const glm::vec3& extent) const
+	{
+		glm::vec4 corners[8];
+		for (int i = 0; i < 8; ++i) {
+			const glm::vec3 corner(
+				(i & 1) ? center.x + extent.x : center.x - extent.x,
+				(i & 2) ? center.y + extent.y : center.y - extent.y,
+				(i & 4) ? center.z + extent.z : center.z - extent.z);
+			corners[i] = mvp_matrix * glm::vec4(corner, 1.f);
+		}
+
+		// -w <= x, y <= w, box is outside if all corners are behind the same plane
+		int outside_left = 0, outside_right = 0, outside_bottom = 0, outside_top = 0, outside_near = 0;
+		for (const glm::vec4& corner : corners) {
+			outside_left += corner.x < -corner.w;
+			outside_right += corner.x > corner.w;
+			outside_bottom += corner.y < -corner.w;
+			outside_top += corner.y > corner.w;
+			outside_near += corner.w < m_near_w;
+		}
+		if (outside_left == 8 || outside_right == 8 || outside_bottom == 8 || outside_top == 8) {
+			return EVisibility::OutsideFrustum;
+		}
+		if (m_empty) {
+			return EVisibility::Visible;
+		}
+		if (outside_near == 8) {
+			return EVisibility::OutsideFrustum;
+		}
+		// camera is inside or very close, projected rectangle is not reliable
+		if (outside_near > 0) {
+			return EVisibility::Visible;
+		}
+
+		// w is linear in world space, so the closest point of box is one of corners
+		float min_x = 1.f, max_x = -1.f, min_y = 1.f, max_y = -1.f, max_depth = 0.f;
+		for (const glm::vec4& corner : corners) {
+			const float inverse_w = 1.f / corner.w;
+			min_x = std::min(min_x, corner.x * inverse_w);
+			max_x = std::max(max_x, corner.x * inverse_w);
+			min_y = std::min(min_y, corner.y * inverse_w);
+			max_y = std::max(max_y, corner.y * inverse_w);
+			max_depth = std::max(max_depth, inverse_w);
+		}
+		const int x0 = std::clamp(static_cast<int>((min_x * 0.5f + 0.5f) * s_width), 0, s_width - 1);
+		const int x1 = std::clamp(static_cast<int>((max_x * 0.5f + 0.5f) * s_width), 0, s_width - 1);
+		const int y0 = std::clamp(static_cast<int>((min_y * 0.5f + 0.5f) * m_height), 0, m_height - 1);
+		const int y1 = std::clamp(static_cast<int>((max_y * 0.5f + 0.5f) * m_height), 0, m_height - 1);
+
+		// level where rectangle covers only a few texels
+		const int size = std::max(x1 - x0, y1 - y0) + 1;
+		int level = 0;
+		while (level < s_levels - 1 && (size >> level) > 2) {
+			++level;
+		}
+		const int level_width = s_width >> level;
+		const float* depth = m_levels[level].data();
+		const float occluded_depth = max_depth * (1.f + s_depth_epsilon);
+		for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+			for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+				// some pixel of texel has occluder behind object or no occluder at all
+				if (depth[y * level_width + x] <= occluded_depth) {
+					return EVisibility::Visible;
+				}
+			}
+		}
+		return EVisibility::Occluded;
+	}
+
+	void OcclusionBuffer::resize(const int height)
+	{
+		if (height == m_height) {
+			return;
+		}
+		m_height = height;
+		m_tiles_x = s_width / s_tile_size;
+		m_tiles_y = height / s_tile_size;
+		for (int level = 0; level < s_levels; ++level) {
+			m_levels[level].assign(static_cast<size_t>(s_width >> level) * static_cast<size_t>(height >> level), 0.f);
+		}
+		m_bins.resize(static_cast<size_t>(m_tiles_x * m_tiles_y));
+	}
+
+	void OcclusionBuffer::setup_triangles(const ArenaVector<Occluder>& occluders, const glm::mat4& view_projection, const float near_w)
+	{
+		// near plane cuts triangle into at most 2, every source triangle has 2 slots so occluders are set up in parallel
+		m_first_triangle.resize(occluders.size() + 1);
+		m_first_triangle[0] = 0;
+		for (size_t i = 0; i < occluders.size(); ++i) {
+			m_first_triangle[i + 1] = m_first_triangle[i] + occluders[i].mesh->indices.size() / 3 * 2;
+		}
+		m_triangles.resize(m_first_triangle.back());
+		m_triangle_valid.resize(m_first_triangle.back());
+
+		const int width = s_width;
+		const int height = m_height;
+		JobSystem::parallel_for(occluders.size(), 1,
+			[this, &occluders, &view_projection, near_w, width, height](const size_t begin, const size_t end) {
+				for (size_t o = begin; o < end; ++o) {
+					const OccluderMesh& mesh = *occluders[o].mesh;
+					const glm::mat4 mvp = view_projection * occluders[o].model_matrix;
+					size_t slot = m_first_triangle[o];
+					for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3, slot += 2) {
+						ClipVertex polygon[3];
+						for (int k = 0; k < 3; ++k) {
+							const glm::vec4 clip = mvp * glm::vec4(mesh.positions[mesh.indices[i + k]], 1.f);
+							polygon[k] = { clip.x, clip.y, clip.w };
+						}
+						ClipVertex clipped[4];
+						const int clipped_count = clip_polygon_near(polygon, 3, near_w, clipped);
+						m_triangle_valid[slot] = clipped_count >= 3
+							&& setup_triangle(clipped[0], clipped[1], clipped[2], width, height, m_triangles[slot]);
+						m_triangle_valid[slot + 1] = clipped_count == 4
+							&& setup_triangle(clipped[0], clipped[2], clipped[3], width, height, m_triangles[slot + 1]);
+					}
+				}
+			});
+	}
+
+	void OcclusionBuffer::bin_triangles()
+	{
+		for (std::vector<uint32_t>& bin : m_bins) {
+			bin.clear();
+		}
+		for (size_t i = 0; i < m_triangles.size(); ++i) {
+			if (!m_triangle_valid[i]) {
+				continue;
+			}
+			++m_stats.occluder_triangles;
+			const OcclusionTriangle& triangle = m_triangles[i];
+			for (int ty = triangle.min_y / s_tile_size; ty <= triangle.max_y / s_tile_size; ++ty) {
+				for (int tx = triangle.min_x / s_tile_size; tx <= triangle.max_x / s_tile_size; ++tx) {
+					// big triangles (ground) have bounds over many tiles which they don't touch
+					const float x0 = static_cast<float>(tx * s_tile_size) + 0.5f;
+					const float y0 = static_cast<float>(ty * s_tile_size) + 0.5f;
+					if (is_rect_outside_triangle(triangle, x0, y0, x0 + s_tile_size - 1, y0 + s_tile_size - 1)) {
+						continue;
+					}
+					m_bins[static_cast<size_t>(ty * m_tiles_x + tx)].push_back(static_cast<uint32_t>(i));
+				}
+			}
+		}
+	}
+
+	void OcclusionBuffer::render_tile(const int tile_index)
+	{
+		const int tile_x = (tile_index % m_tiles_x) * s_tile_size;
+		const int tile_y = (tile_index / m_tiles_x) * s_tile_size;
+
+		OcclusionTile tile;
+		tile.depth = m_levels[0].data() + static_cast<size_t>(tile_y) * s_width + tile_x;
+		tile.stride = s_width;
+		tile.x = tile_x;
+		tile.y = tile_y;
+		tile.width = s_tile_size;
+		tile.height = s_tile_size;
+		for (int y = 0; y < s_tile_size; ++y) {
+			std::fill_n(tile.depth + static_cast<size_t>(y) * s_width, s_tile_size, 0.f);
+		}
+		const std::vector<uint32_t>& bin = m_bins[static_cast<size_t>(tile_index)];
+		SimdMath::rasterize_occluders(m_triangles.data(), bin.data(), bin.size(), tile);
+
+		// tile is aligned to the last level, so its pyramid doesn't need neighbours
+		for (int level = 1; level < s_levels; ++level) {
+			const int size = s_tile_size >> level;
+			const int source_width = s_width >> (level - 1);
+			const int target_width = s_width >> level;
+			const float* source = m_levels[level - 1].data();
+			float* target = m_levels[level].data();
+			const int x_begin = tile_x >> level;
+			const int y_begin = tile_y >> level;
+			for (int y = y_begin; y < y_begin + size; ++y) {
+				const float* row0 = source + static_cast<size_t>(y * 2) * source_width;
+				const float* row1 = row0 + source_width;
+				for (int x = x_begin; x < x_begin + size; ++x) {
+					target[static_cast<size_t>(y) * target_width + x] = std::min(
+						std::min(row0[x * 2], row0[x * 2 + 1]),
+						std::min(row1[x * 2], row1[x * 2 + 1]));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "SimpleEngineCore/Math/SimdKernels.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class Camera;
+
+	// simplified closed mesh which hides what is behind it, it must not be bigger than what is drawn
+	struct OccluderMesh {
+		std::vector<glm::vec3> positions;
+		std::vector<uint32_t> indices;
+
+		// [-1, 1] box, the same as Cube
+		static OccluderMesh make_box();
+	};
+
+	struct Occluder {
+		const OccluderMesh* mesh = nullptr;
+		glm::mat4 model_matrix{ 1.f };
+	};
+
+	// low resolution depth of occluders rasterized on CPU, objects are tested against max depth pyramid (Hi-Z)
+	// depth is 1 / w of perspective camera, so it doesn't depend on depth range or reverse-Z
+	// screen is split into tiles, every tile is rasterized and reduced by own job
+	class OcclusionBuffer {
+	public:
+		static constexpr int s_width = 320;
+		static constexpr int s_tile_size = 32;
+		// level i texel is the farthest depth of 2^i x 2^i pixels, the last level is one texel per tile
+		static constexpr int s_levels = 6;
+
+		enum class EVisibility {
+			Visible,
+			OutsideFrustum,
+			Occluded
+		};
+
+		struct Stats {
+			size_t occluder_triangles = 0;	// after near plane clipping
+			float render_ms = 0.f;
+		};
+
+		// orthographic camera is not supported, buffer stays empty and everything is visible
+		void render(const Camera& camera, const ArenaVector<Occluder>& occluders);
+
+		// local box (center, half size) transformed by model view projection
+		EVisibility test_box(const glm::mat4& mvp_matrix, const glm::vec3& center, const glm::vec3& extent) const;
+
+		bool is_empty() const { return m_empty; }
+		int get_height() const { return m_height; }
+		// level 0 is full resolution, 1 / w or 0 where nothing was drawn
+		const float* get_depth(const int level) const { return m_levels[level].data(); }
+		const Stats& get_stats() const { return m_stats; }
+
+	private:
+		void resize(const int height);
+		void setup_triangles(const ArenaVector<Occluder>& occluders, const glm::mat4& view_projection, const float near_w);
+		void bin_triangles();
+		void render_tile(const int tile_index);
+
+		int m_height = 0;
+		int m_tiles_x = 0;
+		int m_tiles_y = 0;
+		float m_near_w = 0.f;
+		bool m_empty = true;
+		std::vector<float> m_levels[s_levels];
+
+		std::vector<OcclusionTriangle> m_triangles;
+		std::vector<size_t> m_first_triangle;		// of every occluder
+		std::vector<uint8_t> m_triangle_valid;		// clipped away or degenerate triangles stay in array
+		std::vector<std::vector<uint32_t>> m_bins;	// triangles touching every tile, capacity is reused
+
+		Stats m_stats;
+	};
+}
@@ -0,0 +1,119 @@
+#include "ComputeProgram.h"
+
+#include "ShaderProgram.h"
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+
+#include <glad/glad.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <string>
+
+namespace SimpleEngine {
+
+	ComputeProgram::ComputeProgram(const std::string& file_compute_shader)
+	{
+		std::string source;
+		if (!FileSystem::read_text(file_compute_shader, source)) {
+			LOG_CRIT_TO(Render, "Compute shader file open failed {0}", file_compute_shader);
+			return;
+		}
+
+		GLuint shader_id = 0;
+		if (!create_shader(source.c_str(), GL_COMPUTE_SHADER, shader_id)) {
+			LOG_CRIT_TO(Render, "Compute shader: compile-time error! {0}", file_compute_shader);
+			glDeleteShader(shader_id);
+			return;
+		}
+
+		m_id = glCreateProgram();
+		glAttachShader(m_id, shader_id);
+		glLinkProgram(m_id);
+
+		GLint success;
+		glGetProgramiv(m_id, GL_LINK_STATUS, &success);
+		if (success == GL_FALSE) {
+			GLchar info_log[1024];
+			glGetProgramInfoLog(m_id, 1024, nullptr, info_log);
+			LOG_CRIT_TO(Render, "COMPUTE PROGRAM: Link-time error:\n{0}", info_log);
+			glDeleteProgram(m_id);
+			m_id = 0;
+		}
+		else {
+			m_is_compiled = true;
+			glDetachShader(m_id, shader_id);
+		}
+		glDeleteShader(shader_id);
+	}
+
+	ComputeProgram::~ComputeProgram()
+	{
+		glDeleteProgram(m_id);
+	}
+
+	void ComputeProgram::bind() const
+	{
+		glUseProgram(m_id);
+	}
+
+	void ComputeProgram::unbind()
+	{
+		glUseProgram(0);
+	}
+
+	void ComputeProgram::dispatch(const unsigned int groups_x, const unsigned int groups_y, const unsigned int groups_z)
+	{
+		if (groups_x == 0 || groups_y == 0 || groups_z == 0) {
+			return;
+		}
+		glDispatchCompute(groups_x, groups_y, groups_z);
+	}
+
+	void ComputeProgram::memory_barrier(const unsigned int barriers)
+	{
+		GLbitfield bits = 0;
+		if (barriers & ShaderStorage) bits |= GL_SHADER_STORAGE_BARRIER_BIT;
+		if (barriers & Command) bits |= GL_COMMAND_BARRIER_BIT;
+		if (barriers & TextureFetch) bits |= GL_TEXTURE_FETCH_BARRIER_BIT;
+		if (barriers & ShaderImage) bits |= GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+		if (bits != 0) {
+			glMemoryBarrier(bits);
+		}
+	}
+
+	int ComputeProgram::get_uniform_location(const char* name) const
+	{
+		return glGetUniformLocation(m_id, name);
+	}
+
+	void ComputeProgram::set_matrix4(const char* name, const glm::mat4& matrix) const
+	{
+		glUniformMatrix4fv(get_uniform_location(name), 1, GL_FALSE, glm::value_ptr(matrix));
+	}
+
+	void ComputeProgram::set_int(const char* name, const int value) const
+	{
+		glUniform1i(get_uniform_location(name), value);
+	}
+
+	void ComputeProgram::set_uint(const char* name, const unsigned int value) const
+	{
+		glUniform1ui(get_uniform_location(name), value);
+	}
+
+	void ComputeProgram::set_bool(const char* name, const bool value) const
+	{
+		glUniform1i(get_uniform_location(name), static_cast<int>(value));
+	}
+
+	void ComputeProgram::set_float(const char* name, const float value) const
+	{
+		glUniform1f(get_uniform_location(name), value);
+	}
+
+	void ComputeProgram::set_ivec2(const char* name, const glm::ivec2& v) const
+	{
+		glUniform2i(get_uniform_location(name), v.x, v.y);
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <string>
+
+namespace SimpleEngine {
+
+	// single compute shader, works on buffers and images bound by caller
+	class ComputeProgram {
+	public:
+		// what later commands read from what compute shader wrote, can be combined with |
+		enum EBarrier : unsigned int {
+			ShaderStorage = 1 << 0,	// SSBO reads in shaders
+			Command = 1 << 1,		// indirect draw commands and counts
+			TextureFetch = 1 << 2,	// texture sampling of image writes
+			ShaderImage = 1 << 3	// image loads
+		};
+
+		explicit ComputeProgram(const std::string& file_compute_shader);
+		~ComputeProgram();
+
+		ComputeProgram(const ComputeProgram&) = delete;
+		ComputeProgram& operator=(const ComputeProgram&) = delete;
+
+		bool is_compiled() const { return m_is_compiled; }
+
+		void bind() const;
+		static void unbind();
+		// program has to be bound
+		static void dispatch(const unsigned int groups_x, const unsigned int groups_y = 1, const unsigned int groups_z = 1);
+		static void memory_barrier(const unsigned int barriers);
+		// enough groups of group_size for count items
+		static unsigned int get_groups_count(const size_t count, const unsigned int group_size) {
+			return static_cast<unsigned int>((count + group_size - 1) / group_size);
+		}
+
+		void set_matrix4(const char* name, const glm::mat4& matrix) const;
+		void set_int(const char* name, const int value) const;
+		void set_uint(const char* name, const unsigned int value) const;
+		void set_bool(const char* name, const bool value) const;
+		void set_float(const char* name, const float value) const;
+		void set_ivec2(const char* name, const glm::ivec2& v) const;
+
+		int get_uniform_location(const char* name) const;
+
+	private:
+		bool m_is_compiled = false;
+		unsigned int m_id = 0;
+	};
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SimpleEngineCore/Rendering/OpenGL/Light.h"
+#include "SimpleEngineCore/Rendering/OpenGL/Material.h"
+#include "SimpleEngineCore/Rendering/ClusteredLighting.h"
+#include "SimpleEngineCore/Rendering/ShadowCascades.h"
+#include "SimpleEngineCore/Camera.h"
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// the same for every draw of the frame
+	struct DrawContext {
+		const Camera& camera;
+		const DirectionalLight& directional_light;
+		const PointLight& point_light;	// color of light cubes
+		bool use_directional_light;
+		glm::vec3 ambient_light;		// global ambient + ambient of all point and spot lights
+		const ClusterGrid& cluster_grid;	// point and spot lights are in cluster buffers
+		const ShadowCascades& shadow_cascades;	// shadow map is bound for the whole frame
+	};
+
+	// what differs between entities drawn with the same mesh
+	struct DrawInstance {
+		glm::mat4 model_matrix{ 1.f };
+		glm::mat3 normal_matrix{ 1.f };
+		glm::mat4 mvp_matrix{ 1.f };	// projection * view * model, computed for all draws in batch
+		Material material;
+		uint32_t lod = 0;	// chosen when packet was built, depth pre-pass and color pass draw the same level
+	};
+
+	class ShaderProgram;
+
+	// GPU resource (shader, buffers, textures) shared by all entities which reference it
+	class Drawable {
+	public:
+		virtual ~Drawable() = default;
+		virtual void Draw(const DrawContext& context, const DrawInstance& instance) = 0;
+		// only positions with depth program which is already bound (shadow maps), mvp_mat has to be set
+		virtual void DrawDepth(const ShaderProgram& depth_program, const glm::mat4& mvp_matrix, const uint32_t lod) {}
+		// depth pre-pass of scene camera
+		virtual void DrawDepthPrepass(const DrawContext& context, const DrawInstance& instance, const ShaderProgram& depth_program) {
+			DrawDepth(depth_program, instance.mvp_matrix, instance.lod);
+		}
+		// level of detail for one entity, drawable is shared so the previous level (for hysteresis) is kept by entity
+		virtual uint32_t SelectLod(const Camera& camera, const glm::mat4& model_matrix, const float pixel_error,
+			const uint32_t current_lod) const {
+			return 0;
+		}
+	};
+}
@@ -0,0 +1,87 @@
+#include "FrameBuffer.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	FrameBuffer::FrameBuffer(const unsigned int width, const unsigned int height)
+		: m_width(std::max(width, 1u))
+		, m_height(std::max(height, 1u))
+	{
+		glCreateFramebuffers(1, &m_id);
+		create_attachments();
+		// RGBA8 color and 32 bit depth
+		m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::RenderTargets, static_cast<size_t>(m_width) * m_height * 8);
+	}
+
+	FrameBuffer::~FrameBuffer()
+	{
+		delete_attachments();
+		glDeleteFramebuffers(1, &m_id);
+		GpuMemory::remove_allocation(m_gpu_memory);
+	}
+
+	void FrameBuffer::resize(const unsigned int width, const unsigned int height)
+	{
+		// minimized window has zero size
+		const unsigned int new_width = std::max(width, 1u);
+		const unsigned int new_height = std::max(height, 1u);
+		if (new_width == m_width && new_height == m_height) {
+			return;
+		}
+		m_width = new_width;
+		m_height = new_height;
+		delete_attachments();
+		create_attachments();
+		GpuMemory::resize_allocation(m_gpu_memory, static_cast<size_t>(m_width) * m_height * 8);
+	}
+
+	void FrameBuffer::bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+	}
+
+	void FrameBuffer::unbind()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void FrameBuffer::blit_to_default() const
+	{
+		glBlitNamedFramebuffer(m_id, 0,
+			0, 0, m_width, m_height,
+			0, 0, m_width, m_height,
+			GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+
+	void FrameBuffer::create_attachments()
+	{
+		glCreateTextures(GL_TEXTURE_2D, 1, &m_color);
+		glTextureStorage2D(m_color, 1, GL_RGBA8, m_width, m_height);
+		glTextureParameteri(m_color, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(m_color, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glCreateTextures(GL_TEXTURE_2D, 1, &m_depth);
+		glTextureStorage2D(m_depth, 1, GL_DEPTH_COMPONENT32F, m_width, m_height);
+		glTextureParameteri(m_depth, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTextureParameteri(m_depth, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glNamedFramebufferTexture(m_id, GL_COLOR_ATTACHMENT0, m_color, 0);
+		glNamedFramebufferTexture(m_id, GL_DEPTH_ATTACHMENT, m_depth, 0);
+		if (glCheckNamedFramebufferStatus(m_id, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			LOG_CRIT_TO(Render, "Framebuffer {0}x{1} is not complete", m_width, m_height);
+		}
+	}
+
+	void FrameBuffer::delete_attachments()
+	{
+		glDeleteTextures(1, &m_color);
+		glDeleteTextures(1, &m_depth);
+		m_color = 0;
+		m_depth = 0;
+	}
+}
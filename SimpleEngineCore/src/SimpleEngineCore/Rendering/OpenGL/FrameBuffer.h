@@ -0,0 +1,40 @@
+#pragma once
+
+#include "GpuMemory.h"
+
+namespace SimpleEngine {
+
+	// offscreen color (RGBA8) + float depth target, scene is drawn here and copied to the window
+	// default framebuffer depth is usually 24 bit fixed point, reverse-Z needs float depth to gain precision
+	class FrameBuffer {
+	public:
+		FrameBuffer(const unsigned int width, const unsigned int height);
+		~FrameBuffer();
+
+		FrameBuffer(const FrameBuffer&) = delete;
+		FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+		// recreates attachments only when size changes
+		void resize(const unsigned int width, const unsigned int height);
+
+		void bind() const;
+		static void unbind();
+		// color to the window framebuffer, same size
+		void blit_to_default() const;
+
+		unsigned int get_depth_texture() const { return m_depth; }
+		unsigned int get_width() const { return m_width; }
+		unsigned int get_height() const { return m_height; }
+
+	private:
+		void create_attachments();
+		void delete_attachments();
+
+		unsigned int m_id = 0;
+		unsigned int m_color = 0;
+		unsigned int m_depth = 0;
+		unsigned int m_width = 0;
+		unsigned int m_height = 0;
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
+	};
+}
@@ -0,0 +1,389 @@
+#include "GpuMemory.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+#include "SimpleEngineCore/Memory/MemoryTracker.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+// glad is generated without extensions, values are from the extension specs
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX			0x9047
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX	0x9049
+#define GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX			0x904B
+#define GL_TEXTURE_FREE_MEMORY_ATI						0x87FC
+
+namespace SimpleEngine {
+
+	namespace {
+		// resources of this and the previous frame are kept even above budget, they would be uploaded again right away
+		constexpr uint64_t s_min_unused_frames = 2;
+		// driver query can sync with driver thread, once a second is enough for the panel
+		constexpr uint64_t s_driver_query_period = 60;
+		// driver reports less free memory than this part of total
+		constexpr size_t s_low_memory_divisor = 10;
+
+		enum class DriverApi {
+			None,
+			Nvx,
+			Ati
+		};
+
+		struct Allocation {
+			const char* owner = nullptr;
+			size_t bytes = 0;
+			GpuMemoryCategory category = GpuMemoryCategory::VertexBuffers;
+		};
+
+		struct Evictable {
+			GpuEvictable* resource = nullptr;
+			const char* owner = nullptr;
+			uint64_t last_used_frame = 0;
+			bool resident = false;
+		};
+
+		constexpr size_t s_categories_count = static_cast<size_t>(GpuMemoryCategory::Count);
+
+		// allocation records and stats are read from main thread
+		std::mutex s_mutex;
+		TaggedVector<Allocation, MemoryTag::Rendering> s_allocations;
+		TaggedVector<GpuMemory::Handle, MemoryTag::Rendering> s_free_allocations;
+		GpuMemory::CategoryStats s_categories[s_categories_count];
+		size_t s_total_bytes = 0;
+		GpuMemory::DriverInfo s_driver_info;
+		GpuMemory::ResidencyStats s_residency;
+
+		// only thread with OpenGL context
+		TaggedVector<Evictable, MemoryTag::Rendering> s_evictables;
+		TaggedVector<GpuMemory::Handle, MemoryTag::Rendering> s_free_evictables;
+		uint64_t s_frame = 0;
+		DriverApi s_driver_api = DriverApi::None;
+		bool s_low_memory_warned = false;
+		bool s_over_budget_warned = false;
+
+		thread_local const char* t_owner = nullptr;
+
+		bool has_extension(const char* name)
+		{
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint i = 0; i < count; ++i) {
+				const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+				if (extension != nullptr && std::strcmp(extension, name) == 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		GpuMemory::DriverInfo query_driver_info()
+		{
+			// both extensions report kilobytes
+			GpuMemory::DriverInfo info;
+			if (s_driver_api == DriverApi::Nvx) {
+				GLint total = 0;
+				GLint available = 0;
+				GLint evicted = 0;
+				glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &total);
+				glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+				glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &evicted);
+				info.available = true;
+				info.total_bytes = static_cast<size_t>(total) * 1024;
+				info.free_bytes = static_cast<size_t>(available) * 1024;
+				info.evicted_bytes = static_cast<size_t>(evicted) * 1024;
+			}
+			else if (s_driver_api == DriverApi::Ati) {
+				// free in pool, largest free block, free auxiliary memory, largest auxiliary block
+				GLint texture_memory[4] = {};
+				glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, texture_memory);
+				info.available = true;
+				info.free_bytes = static_cast<size_t>(texture_memory[0]) * 1024;
+			}
+			return info;
+		}
+
+		template<typename Record>
+		GpuMemory::Handle add_record(TaggedVector<Record, MemoryTag::Rendering>& records,
+			TaggedVector<GpuMemory::Handle, MemoryTag::Rendering>& free_handles, const Record& record)
+		{
+			if (!free_handles.empty()) {
+				const GpuMemory::Handle handle = free_handles.back();
+				free_handles.pop_back();
+				records[handle - 1] = record;
+				return handle;
+			}
+			records.push_back(record);
+			return static_cast<GpuMemory::Handle>(records.size());
+		}
+	}
+
+	std::atomic<size_t> GpuMemory::s_budget{ 0 };
+
+	void GpuMemory::init()
+	{
+		if (has_extension("GL_NVX_gpu_memory_info")) {
+			s_driver_api = DriverApi::Nvx;
+		}
+		else if (has_extension("GL_ATI_meminfo")) {
+			s_driver_api = DriverApi::Ati;
+		}
+
+		const DriverInfo info = query_driver_info();
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_driver_info = info;
+		}
+		if (!info.available) {
+			LOG_INFO_TO(Render, "GPU memory info is not available, only engine allocations are counted");
+		}
+		else if (info.total_bytes > 0) {
+			LOG_INFO_TO(Render, "GPU memory: {0} MB, {1} MB free", info.total_bytes >> 20, info.free_bytes >> 20);
+		}
+		else {
+			LOG_INFO_TO(Render, "GPU memory: {0} MB free for textures", info.free_bytes >> 20);
+		}
+	}
+
+	GpuMemory::Handle GpuMemory::add_allocation(const GpuMemoryCategory category, const size_t bytes)
+	{
+		Allocation allocation;
+		allocation.owner = t_owner != nullptr ? t_owner : "Other";
+		allocation.bytes = bytes;
+		allocation.category = category;
+
+		std::lock_guard<std::mutex> lock(s_mutex);
+		CategoryStats& stats = s_categories[static_cast<size_t>(category)];
+		stats.bytes += bytes;
+		stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+		++stats.allocations;
+		s_total_bytes += bytes;
+		return add_record(s_allocations, s_free_allocations, allocation);
+	}
+
+	void GpuMemory::resize_allocation(const Handle handle, const size_t bytes)
+	{
+		if (handle == s_invalid_handle) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(s_mutex);
+		Allocation& allocation = s_allocations[handle - 1];
+		CategoryStats& stats = s_categories[static_cast<size_t>(allocation.category)];
+		stats.bytes = stats.bytes - allocation.bytes + bytes;
+		stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+		s_total_bytes = s_total_bytes - allocation.bytes + bytes;
+		allocation.bytes = bytes;
+	}
+
+	void GpuMemory::remove_allocation(Handle& handle)
+	{
+		if (handle == s_invalid_handle) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(s_mutex);
+		Allocation& allocation = s_allocations[handle - 1];
+		CategoryStats& stats = s_categories[static_cast<size_t>(allocation.category)];
+		stats.bytes -= allocation.bytes;
+		--stats.allocations;
+		s_total_bytes -= allocation.bytes;
+		allocation = Allocation();
+		s_free_allocations.push_back(handle);
+		handle = s_invalid_handle;
+	}
+
+	GpuMemory::Handle GpuMemory::add_evictable(GpuEvictable* resource)
+	{
+		Evictable evictable;
+		evictable.resource = resource;
+		evictable.owner = t_owner;
+		evictable.last_used_frame = s_frame;
+		evictable.resident = true;
+		return add_record(s_evictables, s_free_evictables, evictable);
+	}
+
+	void GpuMemory::move_evictable(const Handle handle, GpuEvictable* resource)
+	{
+		if (handle != s_invalid_handle) {
+			s_evictables[handle - 1].resource = resource;
+		}
+	}
+
+	void GpuMemory::remove_evictable(Handle& handle)
+	{
+		if (handle == s_invalid_handle) {
+			return;
+		}
+		s_evictables[handle - 1] = Evictable();
+		s_free_evictables.push_back(handle);
+		handle = s_invalid_handle;
+	}
+
+	void GpuMemory::mark_used(const Handle handle)
+	{
+		if (handle != s_invalid_handle) {
+			Evictable& evictable = s_evictables[handle - 1];
+			evictable.last_used_frame = s_frame;
+			evictable.resident = true;
+		}
+	}
+
+	const char* GpuMemory::get_evictable_owner(const Handle handle)
+	{
+		return handle != s_invalid_handle ? s_evictables[handle - 1].owner : nullptr;
+	}
+
+	void GpuMemory::end_frame()
+	{
+		const uint64_t frame = s_frame++;
+		if (s_driver_api != DriverApi::None && frame % s_driver_query_period == 0) {
+			const DriverInfo info = query_driver_info();
+			{
+				std::lock_guard<std::mutex> lock(s_mutex);
+				s_driver_info = info;
+			}
+			const bool low_memory = info.total_bytes > 0 && info.free_bytes < info.total_bytes / s_low_memory_divisor;
+			if (low_memory && !s_low_memory_warned) {
+				LOG_WARN_TO(Render, "GPU memory is low: {0} MB of {1} MB free, engine uses {2} MB",
+					info.free_bytes >> 20, info.total_bytes >> 20, get_total_bytes() >> 20);
+			}
+			s_low_memory_warned = low_memory;
+		}
+
+		struct Candidate {
+			Handle handle;
+			uint64_t last_used_frame;
+		};
+		ScratchScope scratch;
+		ArenaVector<Candidate> candidates{ scratch.get_allocator<Candidate>() };
+		size_t resident = 0;
+		for (size_t i = 0; i < s_evictables.size(); ++i) {
+			const Evictable& evictable = s_evictables[i];
+			if (evictable.resource == nullptr || !evictable.resident) {
+				continue;
+			}
+			++resident;
+			if (frame - evictable.last_used_frame >= s_min_unused_frames) {
+				candidates.push_back({ static_cast<Handle>(i + 1), evictable.last_used_frame });
+			}
+		}
+
+		const size_t budget = get_budget();
+		uint64_t evictions = 0;
+		if (budget > 0 && get_total_bytes() > budget) {
+			// least recently used first
+			std::sort(candidates.begin(), candidates.end(),
+				[](const Candidate& a, const Candidate& b) { return a.last_used_frame < b.last_used_frame; });
+			for (const Candidate& candidate : candidates) {
+				if (get_total_bytes() <= budget) {
+					break;
+				}
+				// resource frees its buffers and textures, they remove own allocations
+				Evictable& evictable = s_evictables[candidate.handle - 1];
+				evictable.resident = false;
+				evictable.resource->evict();
+				--resident;
+				++evictions;
+			}
+			const bool over_budget = get_total_bytes() > budget;
+			if (over_budget && !s_over_budget_warned) {
+				LOG_WARN_TO(Render, "GPU memory {0} MB is over budget of {1} MB, everything left is in use",
+					get_total_bytes() >> 20, budget >> 20);
+			}
+			s_over_budget_warned = over_budget;
+		}
+		else {
+			s_over_budget_warned = false;
+		}
+
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_residency.evictables = s_evictables.size() - s_free_evictables.size();
+		s_residency.resident = resident;
+		s_residency.evictions += evictions;
+	}
+
+	size_t GpuMemory::get_total_bytes()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		return s_total_bytes;
+	}
+
+	GpuMemory::CategoryStats GpuMemory::get_category_stats(const GpuMemoryCategory category)
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		return s_categories[static_cast<size_t>(category)];
+	}
+
+	const char* GpuMemory::get_category_name(const GpuMemoryCategory category)
+	{
+		switch (category)
+		{
+		case GpuMemoryCategory::VertexBuffers: return "Vertices";
+		case GpuMemoryCategory::IndexBuffers: return "Indices";
+		case GpuMemoryCategory::StorageBuffers: return "Storage";
+		case GpuMemoryCategory::Textures: return "Textures";
+		case GpuMemoryCategory::RenderTargets: return "Targets";
+		case GpuMemoryCategory::Count: break;
+		}
+		return "Unknown";
+	}
+
+	size_t GpuMemory::get_owner_stats(OwnerStats* stats, const size_t max_count)
+	{
+		ScratchScope scratch;
+		ArenaVector<OwnerStats> owners{ scratch.get_allocator<OwnerStats>() };
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			for (const Allocation& allocation : s_allocations) {
+				if (allocation.owner == nullptr) {
+					continue;
+				}
+				// the same literal can have different addresses in different translation units
+				auto it = std::find_if(owners.begin(), owners.end(), [&allocation](const OwnerStats& owner) {
+					return owner.owner == allocation.owner || std::strcmp(owner.owner, allocation.owner) == 0;
+					});
+				if (it == owners.end()) {
+					owners.push_back({ allocation.owner, 0, 0 });
+					it = owners.end() - 1;
+				}
+				it->bytes += allocation.bytes;
+				++it->allocations;
+			}
+		}
+
+		const size_t count = std::min(max_count, owners.size());
+		std::partial_sort(owners.begin(), owners.begin() + count, owners.end(),
+			[](const OwnerStats& a, const OwnerStats& b) { return a.bytes > b.bytes; });
+		std::copy(owners.begin(), owners.begin() + count, stats);
+		return count;
+	}
+
+	GpuMemory::DriverInfo GpuMemory::get_driver_info()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		return s_driver_info;
+	}
+
+	GpuMemory::ResidencyStats GpuMemory::get_residency_stats()
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		return s_residency;
+	}
+
+	GpuMemoryScope::GpuMemoryScope(const char* owner) :
+		m_previous_owner(t_owner)
+	{
+		t_owner = owner;
+	}
+
+	GpuMemoryScope::~GpuMemoryScope()
+	{
+		t_owner = m_previous_owner;
+	}
+
+	const char* GpuMemoryScope::get_current_owner()
+	{
+		return t_owner;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	enum class GpuMemoryCategory : uint8_t {
+		VertexBuffers,
+		IndexBuffers,
+		StorageBuffers,
+		Textures,
+		RenderTargets,	// framebuffer attachments, shadow maps, depth pyramid
+		Count
+	};
+
+	// resource which can give its GPU memory back when budget is exceeded
+	// and uploads it again from CPU side data the next time it's drawn
+	class GpuEvictable {
+	public:
+		virtual void evict() = 0;
+	protected:
+		~GpuEvictable() = default;
+	};
+
+	// bytes of every buffer and texture by category and owner, budget with LRU eviction
+	// allocations, eviction and residency are from the thread with OpenGL context, stats from any thread
+	class GpuMemory {
+	public:
+		using Handle = uint32_t;
+		static constexpr Handle s_invalid_handle = 0;
+
+		struct CategoryStats {
+			size_t bytes = 0;
+			size_t peak_bytes = 0;
+			size_t allocations = 0;
+		};
+
+		struct OwnerStats {
+			const char* owner = nullptr;
+			size_t bytes = 0;
+			size_t allocations = 0;
+		};
+
+		// GL_NVX_gpu_memory_info or GL_ATI_meminfo, whole GPU and not only this process
+		struct DriverInfo {
+			bool available = false;
+			size_t total_bytes = 0;		// 0 when driver doesn't report it (ATI)
+			size_t free_bytes = 0;
+			size_t evicted_bytes = 0;	// driver paged out to system memory (NVX)
+		};
+
+		struct ResidencyStats {
+			size_t evictables = 0;
+			size_t resident = 0;
+			uint64_t evictions = 0;
+		};
+
+		// after OpenGL functions are loaded, finds memory info extensions
+		static void init();
+
+		static Handle add_allocation(const GpuMemoryCategory category, const size_t bytes);
+		// storage was created again with other size, owner and category stay
+		static void resize_allocation(const Handle handle, const size_t bytes);
+		static void remove_allocation(Handle& handle);
+
+		static Handle add_evictable(GpuEvictable* resource);
+		// evictable object was moved
+		static void move_evictable(const Handle handle, GpuEvictable* resource);
+		static void remove_evictable(Handle& handle);
+		// resource is drawn this frame and it is resident, it's not evicted until next frame
+		static void mark_used(const Handle handle);
+		// owner scope of the thread which created resource, uploads after eviction go to the same owner
+		static const char* get_evictable_owner(const Handle handle);
+
+		// 0 is no budget, allocations above budget evict resources which were not used for the longest time
+		static void set_budget(const size_t bytes) { s_budget.store(bytes, std::memory_order_relaxed); }
+		static size_t get_budget() { return s_budget.load(std::memory_order_relaxed); }
+
+		// after the frame is drawn: evicts over budget and queries driver info from time to time
+		static void end_frame();
+
+		static size_t get_total_bytes();
+		static CategoryStats get_category_stats(const GpuMemoryCategory category);
+		static const char* get_category_name(const GpuMemoryCategory category);
+		// biggest owners first, returns how many were written
+		static size_t get_owner_stats(OwnerStats* stats, const size_t max_count);
+		static DriverInfo get_driver_info();
+		static ResidencyStats get_residency_stats();
+
+	private:
+		static std::atomic<size_t> s_budget;
+	};
+
+	// allocations of this thread until scope ends are counted to owner, scopes nest
+	class GpuMemoryScope {
+	public:
+		// owner name has to be a string literal
+		explicit GpuMemoryScope(const char* owner);
+		~GpuMemoryScope();
+
+		// nullptr outside of any scope, work finished on other thread opens a scope with it
+		static const char* get_current_owner();
+
+		GpuMemoryScope(const GpuMemoryScope&) = delete;
+		GpuMemoryScope& operator=(const GpuMemoryScope&) = delete;
+
+	private:
+		const char* m_previous_owner;
+	};
+}
@@ -0,0 +1,66 @@
+#include "GpuQuery.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+	constexpr GLenum type_to_GLenum(const GpuQuery::EType type) {
+		switch (type)
+		{
+			case GpuQuery::EType::TimeElapsed: return GL_TIME_ELAPSED;
+			case GpuQuery::EType::SamplesPassed: return GL_SAMPLES_PASSED;
+			case GpuQuery::EType::FragmentShaderInvocations: return GL_FRAGMENT_SHADER_INVOCATIONS;
+		}
+
+		LOG_ERROR_TO(Render, "Unknown GpuQuery type");
+		return GL_TIME_ELAPSED;
+	}
+
+	GpuQuery::GpuQuery(const EType type)
+		: m_target(type_to_GLenum(type))
+	{
+		glGenQueries(static_cast<GLsizei>(s_queries_count), m_queries);
+	}
+
+	GpuQuery::~GpuQuery()
+	{
+		glDeleteQueries(static_cast<GLsizei>(s_queries_count), m_queries);
+	}
+
+	void GpuQuery::begin()
+	{
+		collect();
+		// the oldest query is still not ready - drop it instead of waiting
+		m_pending[m_current] = false;
+		glBeginQuery(m_target, m_queries[m_current]);
+	}
+
+	void GpuQuery::end()
+	{
+		glEndQuery(m_target);
+		m_pending[m_current] = true;
+		m_current = (m_current + 1) % s_queries_count;
+	}
+
+	void GpuQuery::collect()
+	{
+		// from the oldest to the newest, so the last read value is the latest
+		for (size_t i = 0; i < s_queries_count; ++i) {
+			const size_t index = (m_current + i) % s_queries_count;
+			if (!m_pending[index]) {
+				continue;
+			}
+			GLint available = 0;
+			glGetQueryObjectiv(m_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) {
+				break;
+			}
+			GLuint64 result = 0;
+			glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &result);
+			m_last_result = static_cast<uint64_t>(result);
+			m_pending[index] = false;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	// GPU counter of commands between begin and end
+	// result comes a few frames later, queries are reused in a ring so reading never stalls
+	class GpuQuery {
+	public:
+		enum class EType {
+			TimeElapsed,				// nanoseconds
+			SamplesPassed,				// samples which passed depth test
+			FragmentShaderInvocations	// fragment shader runs, including ones killed later by depth test
+		};
+
+		explicit GpuQuery(const EType type);
+		~GpuQuery();
+
+		GpuQuery(const GpuQuery&) = delete;
+		GpuQuery& operator=(const GpuQuery&) = delete;
+
+		// begin and end once per frame, must not be nested with other query of the same type
+		void begin();
+		void end();
+
+		// the latest finished measurement
+		uint64_t get_result() const { return m_last_result; }
+
+	private:
+		static constexpr size_t s_queries_count = 4;
+
+		void collect();
+
+		unsigned int m_target = 0;
+		unsigned int m_queries[s_queries_count] = {};
+		bool m_pending[s_queries_count] = {};
+		size_t m_current = 0;
+		uint64_t m_last_result = 0;
+	};
+
+	// GPU time of commands between begin and end
+	class GpuTimer : public GpuQuery {
+	public:
+		GpuTimer() : GpuQuery(EType::TimeElapsed) {}
+
+		float get_ms() const { return static_cast<float>(get_result()) / 1e6f; }
+	};
+}
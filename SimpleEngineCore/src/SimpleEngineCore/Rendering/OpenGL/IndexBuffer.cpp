@@ -14,22 +14,42 @@ namespace SimpleEngine {
 			case VertexBuffer::EUsage::Stream: return GL_STREAM_DRAW;
 		}
 
-		LOG_ERROR("Unknown VertexBuffer usage");
+		LOG_ERROR_TO(Render, "Unknown VertexBuffer usage");
 		return GL_STREAM_DRAW;
 	}
 
-	IndexBuffer::IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage)
+	IndexBuffer::IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage, const EType type)
 		: m_count(count)
+		, m_type(type)
+	{
+		create(data, usage);
+	}
+
+	IndexBuffer::IndexBuffer(const std::vector<uint32_t>& indices, const size_t vertices_count, const VertexBuffer::EUsage usage)
+		: m_count(indices.size())
+		, m_type(fits_unsigned_short(vertices_count) ? EType::UnsignedShort : EType::UnsignedInt)
+	{
+		if (m_type == EType::UnsignedInt) {
+			create(indices.data(), usage);
+			return;
+		}
+		// narrow to 16 bit, only temporary copy on cpu side
+		std::vector<uint16_t> short_indices(indices.begin(), indices.end());
+		create(short_indices.data(), usage);
+	}
+
+	void IndexBuffer::create(const void* data, const VertexBuffer::EUsage usage)
 	{
 		glGenBuffers(1, &m_id);
 		if (m_id == 0) {
-			LOG_ERROR("Failed to generate an index buffer");
+			LOG_ERROR_TO(Render, "Failed to generate an index buffer");
 		}
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, usage_to_GLenum1(usage));
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, get_size(), data, usage_to_GLenum1(usage));
+		m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::IndexBuffers, get_size());
 		GLenum error = glGetError();
 		if (error != GL_NO_ERROR) {
-			LOG_ERROR("OpenGL error occurred: {0}", error);
+			LOG_ERROR_TO(Render, "OpenGL error occurred: {0}", error);
 		}
 	}
 
@@ -38,30 +58,48 @@ namespace SimpleEngine {
 		if (m_id != 0) {
 			glDeleteBuffers(1, &m_id);
 		}
+		GpuMemory::remove_allocation(m_gpu_memory);
 	}
 
 	IndexBuffer::IndexBuffer(IndexBuffer&& indexBuffer) noexcept
 		: m_id(indexBuffer.m_id)
 		, m_count(indexBuffer.m_count)
+		, m_type(indexBuffer.m_type)
+		, m_gpu_memory(indexBuffer.m_gpu_memory)
 	{
 		indexBuffer.m_id = 0;
 		indexBuffer.m_count = 0;
+		indexBuffer.m_gpu_memory = GpuMemory::s_invalid_handle;
 	}
 
 	IndexBuffer& IndexBuffer::operator=(IndexBuffer&& indexBuffer) noexcept
 	{
 		if (this != &indexBuffer) {
 			glDeleteBuffers(1, &m_id);  // Clean up the current buffer if needed
+			GpuMemory::remove_allocation(m_gpu_memory);
 
 			m_id = indexBuffer.m_id;
 			m_count = indexBuffer.m_count;
+			m_type = indexBuffer.m_type;
+			m_gpu_memory = indexBuffer.m_gpu_memory;
 
 			indexBuffer.m_id = 0;
 			indexBuffer.m_count = 0;
+			indexBuffer.m_gpu_memory = GpuMemory::s_invalid_handle;
 		}
 		return *this;
 	}
 
+	unsigned int IndexBuffer::get_gl_type() const
+	{
+		return m_type == EType::UnsignedShort ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+
+	size_t IndexBuffer::get_size() const
+	{
+		return m_count * (m_type == EType::UnsignedShort ? sizeof(GLushort) : sizeof(GLuint));
+	}
+
 	void IndexBuffer::bind() const
 	{
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
@@ -2,12 +2,20 @@
 
 #include "VertexBuffer.h"
 
+#include <cstdint>
+
 namespace SimpleEngine {
 
 	class IndexBuffer {
 	public:
-
-		IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static);
+		enum class EType {
+			UnsignedShort, // enough for meshes with less than 65k vertices, half of the memory
+			UnsignedInt
+		};
+
+		IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static, const EType type = EType::UnsignedInt);
+		// picks 16 bit indices automatically if every index fits into them
+		IndexBuffer(const std::vector<uint32_t>& indices, const size_t vertices_count, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static);
 		~IndexBuffer();
 
 		IndexBuffer(const IndexBuffer&) = delete;
@@ -19,9 +27,18 @@ namespace SimpleEngine {
 		void bind() const;
 		static void unbind();
 		size_t get_count() const { return m_count; }
+		EType get_type() const { return m_type; }
+		unsigned int get_gl_type() const;
+		size_t get_size() const;
+
+		static bool fits_unsigned_short(const size_t vertices_count) { return vertices_count <= 0xFFFF + 1; }
 
 	private:
+		void create(const void* data, const VertexBuffer::EUsage usage);
+
 		unsigned int m_id = 0;
 		size_t m_count;
+		EType m_type = EType::UnsignedInt;
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
 	};
-}
\ No newline at end of file
+}
@@ -36,6 +36,11 @@ namespace SimpleEngine {
 			glUniform1f(specularIntensityLoc, specularIntensity);
 		}
 
+		// colors multiplied by intensity
+		glm::vec3 get_ambient() const { return ambient * ambientIntensity; }
+		glm::vec3 get_diffuse() const { return diffuse * diffuseIntensity; }
+		glm::vec3 get_specular() const { return specular * specularIntensity; }
+
 	protected:
 		glm::vec3 ambient;
 		float ambientIntensity;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/vec3.hpp>
+#include <glad/glad.h>
 
 namespace SimpleEngine {
 
@@ -8,15 +8,28 @@
 #include <vector>
 #include <map>
 #include <cstring>  // for memcpy
+#include <algorithm>
 
 #include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.h"
 #include "SimpleEngineCore/Rendering/OpenGL/VertexArray.h"
 #include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.h"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexPacking.h"
 #include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.h"
 #include "SimpleEngineCore/Rendering/OpenGL/Texture2D.h"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuMemory.h"
+#include "SimpleEngineCore/Rendering/OpenGL/MeshGeometry.h"
 #include "SimpleEngineCore/Rendering/OpenGL/Material.h"
 #include "SimpleEngineCore/Rendering/OpenGL/Light.h"
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.h"
+#include "SimpleEngineCore/Rendering/OpenGL/DrawContext.h"
+#include "SimpleEngineCore/Rendering/MeshSimplifier.h"
+#include "SimpleEngineCore/Rendering/LodSelection.h"
+#include "SimpleEngineCore/Rendering/MeshType.h"
+#include "SimpleEngineCore/Rendering/Primitives.h"
+#include "SimpleEngineCore/Assets/AssetManager.h"
+#include "SimpleEngineCore/Assets/CookedFormats.h"
+#include "SimpleEngineCore/IO/AssimpIOSystem.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
 #include "SimpleEngineCore/Camera.h"
 #include "SimpleEngineCore/Utils.h"
 #include "SimpleEngineCore/Log.h"
@@ -34,7 +47,6 @@
 
 #include <unordered_map>
 #include <functional>
-#include <iostream>
 
 namespace SimpleEngine {
 
@@ -44,89 +56,131 @@ namespace SimpleEngine {
 			: std::runtime_error(message) {}
 	};
 
-	struct Vertex {
-		glm::vec3 Position;
-		glm::vec3 Normal;
-		glm::vec2 TexCoords;
-	};
-
-	class Mesh {
+	// geometry, shader and textures are assets shared with every mesh which uses the same vertices and files
+	// geometry keeps CPU arrays only with GeometryAccess::CpuAndGpu, then it can be evicted under GPU memory budget
+	class Mesh : public Drawable {
 	public:
 		Mesh(
-			const Camera& camera,
 			std::vector<GLfloat> vertices,
 			std::vector<GLuint> indices,
 			std::filesystem::path vertex_shader_path,
 			std::filesystem::path frag_shader_path,
+			std::vector<std::filesystem::path> v_texturePaths = {},
+			const GeometryAccess access = GeometryAccess::GpuOnly) :
+			Mesh(AssetRef<MeshGeometry>(AssetManager::add_geometry("", std::move(vertices), std::move(indices), access)),
+				vertex_shader_path, frag_shader_path, v_texturePaths)
+		{
+		}
+		Mesh(
+			AssetRef<MeshGeometry> geometry,
+			std::filesystem::path vertex_shader_path,
+			std::filesystem::path frag_shader_path,
 			std::vector<std::filesystem::path> v_texturePaths = {}) :
-			camera(camera),
-			vertices(vertices), indices(indices)/*, m_texture(m_texture)*/
+			m_geometry(std::move(geometry))
 		{
-			p_shader_program = std::make_unique<ShaderProgram>(
-				vertex_shader_path.string(), frag_shader_path.string());
-			if (!p_shader_program->is_compiled())
+			p_shader_program = AssetRef<ShaderProgram>(AssetManager::load_shader(vertex_shader_path, frag_shader_path));
+			AssetManager::wait(p_shader_program.get_handle());
+			if (!p_shader_program.get())
 				throw ShaderCompilationException("Shader compilation failed");
+			// textures are bound when they are decoded and uploaded, until then mesh is drawn without them
 			for (const auto& tp : v_texturePaths) {
-				const unsigned int w = 1000;
-				const unsigned int h = 1000;
-				m_texture.emplace(std::make_pair(tp.stem().string(), Texture2D(tp.string(), w, h)));
+				m_texture.emplace(tp.stem().string(), AssetRef<Texture2D>(AssetManager::load_texture(tp)));
 			}
-			SetupMesh();
-		}
-		virtual void Draw() {
 		}
 
-		void UpdateCamera(const Camera& cam) {
-			this->camera = cam;
+		void DrawDepth(const ShaderProgram& depth_program, const glm::mat4& mvp_matrix, const uint32_t lod) override {
+			MakeResident();
+			depth_program.set_matrix4("mvp_mat", mvp_matrix);
+			Renderer_OpenGL::draw(GetVertexArray());
 		}
 
-	private:
-		void SetupMesh() {
-			// VAO
-			p_vao = std::make_unique<VertexArray>();
-			p_vao->bind();
-			// Depends on struct Vertex 
-			BufferLayout buffer_layout_vec3_vec3_vec2
-			{
-				ShaderDataType::Float3,
-				ShaderDataType::Float3,
-				ShaderDataType::Float2
-			};
-			// VBO
-			if (sizeof(vertices) > 0) {
-				p_vbo = std::make_unique<VertexBuffer>(vertices.data(), vertices.size() * sizeof(GLfloat), buffer_layout_vec3_vec3_vec2);
-				p_vao->add_vertex_buffer(*p_vbo);
+		// diffuse to unit 0 and specular to unit 1 of bound program
+		void BindTextures(const ShaderProgram& program) {
+			auto it = m_texture.find("material.diffuse");
+			if (it != m_texture.end() && it->second.get()) {
+				program.set_int("material.diffuse", 0);
+				it->second->bind(0);
 			}
-			// INDEX BUFFER
-			if (sizeof(indices) > 0) {
-				p_index_buffer = std::make_unique<IndexBuffer>(indices.data(), indices.size());
-				p_vao->set_index_buffer(*p_index_buffer);
+			auto it1 = m_texture.find("material.specular");
+			if (it1 != m_texture.end() && it1->second.get()) {
+				program.set_int("material.specular", 1);
+				it1->second->bind(1);
 			}
 		}
+
+		// 8 floats per vertex: position, normal, uv, arrays are empty unless geometry is CpuAndGpu
+		const MeshGeometry& GetGeometry() const { return *m_geometry; }
+
 	protected:
-		std::unique_ptr<ShaderProgram> p_shader_program;
-		std::unique_ptr<VertexArray> p_vao;
-		std::unique_ptr<VertexBuffer> p_vbo;
-		std::unique_ptr<IndexBuffer> p_index_buffer;
-		std::map<std::string, Texture2D> m_texture;
-		// mesh data
-		std::vector<GLfloat> vertices;
-		std::vector<GLuint> indices;
-		Camera camera;
+		// uploads evicted buffers again, has to be called before vertex array is drawn
+		void MakeResident() {
+			m_geometry->make_resident();
+		}
+		const VertexArray& GetVertexArray() const { return m_geometry->get_vertex_array(); }
+
+		AssetRef<MeshGeometry> m_geometry;
+		AssetRef<ShaderProgram> p_shader_program;
+		// transparent comparator: find by string literal doesn't build std::string (longer names don't fit SSO)
+		std::map<std::string, AssetRef<Texture2D>, std::less<>> m_texture;
 	};
 
-	enum class MeshType {
-		LightCube
+	// CPU side of MeshNew, prepared on any thread so OpenGL thread only creates buffers from it
+	struct MeshData {
+		std::vector<Vertex> vertices;
+		std::vector<GLuint> indices; // all LOD levels one after another
+		std::vector<PackedVertex> packed_vertices;
+		VertexQuantization quantization;
+		std::vector<LodLevel> lods;
+		glm::vec3 bounding_center{ 0.f };
+		float bounding_radius = 0.f;
+
+		// what buffers of the mesh take, indices are 16 bit when vertices fit them
+		size_t get_gpu_bytes() const {
+			const size_t index_size = IndexBuffer::fits_unsigned_short(packed_vertices.size()) ? sizeof(uint16_t) : sizeof(uint32_t);
+			return packed_vertices.size() * sizeof(PackedVertex) + indices.size() * index_size;
+		}
 	};
 
+	// packs vertices of mesh whose indices already hold every level of lods (cooked mesh)
+	inline MeshData prepare_mesh_data(std::vector<Vertex>&& vertices, std::vector<GLuint>&& indices, std::vector<LodLevel>&& lods) {
+		MeshData data;
+		// vertices are compressed from 32 to 16 bytes before upload
+		// position goes back to model space with quantization matrix in Draw
+		// normal is octahedral encoded so shader has to decode it (phong_packed_vertex_shader)
+		data.quantization = compute_vertex_quantization(vertices);
+		data.packed_vertices = pack_vertices(vertices, data.quantization);
+		std::vector<glm::vec3> positions(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			positions[i] = vertices[i].Position;
+		}
+		data.bounding_center = data.quantization.bounds_min + data.quantization.bounds_extent * 0.5f;
+		data.bounding_radius = MeshSimplifier::get_mesh_extent(positions);
+		data.vertices = std::move(vertices);
+		data.indices = std::move(indices);
+		data.lods = std::move(lods);
+		return data;
+	}
+
+	// generates LOD chain first, QEM takes a while on big meshes so this runs on workers
+	inline MeshData prepare_mesh_data(std::vector<Vertex>&& vertices, std::vector<GLuint>&& indices, const LodSettings& lod_settings) {
+		// simplified levels reuse the same vertices so they are only appended to indices
+		std::vector<glm::vec3> positions(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			positions[i] = vertices[i].Position;
+		}
+		std::vector<LodLevel> lods = generate_lod_chain(positions, indices, lod_settings);
+		return prepare_mesh_data(std::move(vertices), std::move(indices), std::move(lods));
+	}
+
 	class MeshNew {
 	public:
 		MeshNew(
-			std::vector<Vertex>&& vertices,
-			std::vector<unsigned int>&& indices,
-			std::map<std::string, Texture2D>&& textures) :
-			vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)) {
-			SetupMesh();
+			MeshData&& data,
+			std::map<std::string, AssetRef<Texture2D>>&& textures) :
+			vertices(std::move(data.vertices)), indices(std::move(data.indices)), textures(std::move(textures)),
+			quantization(data.quantization), lods(std::move(data.lods)),
+			bounding_center(data.bounding_center), bounding_radius(data.bounding_radius) {
+			SetupMesh(data.packed_vertices);
 		}
 
 		// Explicitly delete the copy constructor and copy assignment operator
@@ -139,10 +193,14 @@ namespace SimpleEngine {
 			vao(std::move(other.vao)),
 			vbo(std::move(other.vbo)),
 			index_buffer(std::move(other.index_buffer)),
-			textures(std::move(other.textures)),
 			vertices(std::move(other.vertices)),
 			indices(std::move(other.indices)),
-			camera(std::move(other.camera)) {
+			textures(std::move(other.textures)),
+			quantization(other.quantization),
+			lods(std::move(other.lods)),
+			lod_selector(other.lod_selector),
+			bounding_center(other.bounding_center),
+			bounding_radius(other.bounding_radius) {
 			// After moving, `other` should not be used except for destruction
 		}
 
@@ -153,48 +211,76 @@ namespace SimpleEngine {
 				vao = std::move(other.vao);
 				vbo = std::move(other.vbo);
 				index_buffer = std::move(other.index_buffer);
-				textures = std::move(other.textures);
 				vertices = std::move(other.vertices);
 				indices = std::move(other.indices);
-				camera = std::move(other.camera);
+				textures = std::move(other.textures);
+				quantization = other.quantization;
+				lods = std::move(other.lods);
+				lod_selector = other.lod_selector;
+				bounding_center = other.bounding_center;
+				bounding_radius = other.bounding_radius;
 			}
 			return *this;
 		}
 
-		virtual void Draw() {
-		}
-
-		virtual void UpdateLight(const PointLight& light) {
+		virtual ~MeshNew() = default;
 
+		// phong lit with lights and shadows of the frame, defined after Cube which sets them
+		virtual void Draw(const DrawContext& context, const DrawInstance& instance);
+		void DrawDepth(const ShaderProgram& depth_program, const glm::mat4& mvp_matrix, const size_t lod) const {
+			depth_program.set_matrix4("mvp_mat", mvp_matrix * quantization.get_dequantization_matrix());
+			DrawLod(lod);
 		}
-		virtual void UpdateCamera(const Camera& cam) {
-			this->camera = cam;
-		}
-		void SetupShaderProgram(std::filesystem::path vertex_shader_path, std::filesystem::path frag_shader_path) {
-			shader_program = std::make_unique<ShaderProgram>(
-				vertex_shader_path.string(), frag_shader_path.string());
-			if (!shader_program->is_compiled())
-				throw ShaderCompilationException("Shader compilation failed");
-		}
-		void SetupMesh() {
+
+		// level for instance with model matrix, nothing is stored in mesh, it is shared by all instances
+		// current_lod is the level instance had in previous frame, coarser level has to be better by hysteresis margin
+		size_t SelectLod(const glm::mat4& model_mat, const Camera& camera, const float pixel_error, const size_t current_lod) const {
+			if (lods.size() < 2) {
+				return 0;
+			}
+			// bounds are in model space, take the biggest scale for the radius
+			const glm::vec3 world_center = glm::vec3(model_mat * glm::vec4(bounding_center, 1.f));
+			const float max_scale = std::max({
+				glm::length(glm::vec3(model_mat[0])),
+				glm::length(glm::vec3(model_mat[1])),
+				glm::length(glm::vec3(model_mat[2])) });
+			const float world_radius = bounding_radius * max_scale;
+			const float projected_radius = LodSelector::get_projected_radius(camera, world_center, world_radius);
+			LodSelector selector = lod_selector;
+			selector.pixel_error = pixel_error;
+			return selector.select(lods, bounding_radius, projected_radius, std::min(current_lod, lods.size() - 1));
+		}
+
+		// model space bounding sphere
+		const glm::vec3& GetBoundingCenter() const { return bounding_center; }
+		float GetBoundingRadius() const { return bounding_radius; }
+		size_t GetLodsCount() const { return lods.size(); }
+		// after upload and LOD chain nothing reads arrays, unless mesh is used for collision or picking
+		void ReleaseCpuData() {
+			std::vector<Vertex>().swap(vertices);
+			std::vector<GLuint>().swap(indices);
+		}
+		bool HasCpuData() const { return !vertices.empty(); }
+		// vertices are packed, so normals can be read only by phong_packed_vertex_shader, it replaces given vertex shader
+		virtual void SetupShaderProgram(const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path) {
+			LoadShaderProgram(s_packed_vertex_shader_path, frag_shader_path);
+		}
+		// only buffers are created here, vertices were packed and LODs generated by prepare_mesh_data
+		void SetupMesh(const std::vector<PackedVertex>& packed_vertices) {
 			// VAO
 			vao = std::make_unique<VertexArray>();
 			vao->bind();
-			// Depends on struct Vertex 
-			BufferLayout buffer_layout_vec3_vec3_vec2
-			{
-				ShaderDataType::Float3,
-				ShaderDataType::Float3,
-				ShaderDataType::Float2
-			};
 			// VBO
-			if (sizeof(vertices) > 0) {
-				vbo = std::make_unique<VertexBuffer>(vertices.data(), vertices.size() * sizeof(GLfloat), buffer_layout_vec3_vec3_vec2);
+			if (!packed_vertices.empty()) {
+				vbo = std::make_unique<VertexBuffer>(
+					packed_vertices.data(), packed_vertices.size() * sizeof(PackedVertex),
+					get_packed_vertex_layout(quantization.position_format));
 				vao->add_vertex_buffer(*vbo);
 			}
 			// INDEX BUFFER
-			if (sizeof(indices) > 0) {
-				index_buffer = std::make_unique<IndexBuffer>(indices.data(), indices.size());
+			// less than 65k vertices -> GL_UNSIGNED_SHORT
+			if (!indices.empty()) {
+				index_buffer = std::make_unique<IndexBuffer>(indices, packed_vertices.size());
 				vao->set_index_buffer(*index_buffer);
 			}
 			// Textures
@@ -205,25 +291,46 @@ namespace SimpleEngine {
 			//}
 		}
 	protected:
-		std::unique_ptr<ShaderProgram> shader_program;
+		static constexpr const char* s_packed_vertex_shader_path = "shaders/phong_packed_vertex_shader.glsl";
+
+		void LoadShaderProgram(const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path) {
+			shader_program = AssetRef<ShaderProgram>(AssetManager::load_shader(vertex_shader_path, frag_shader_path));
+			AssetManager::wait(shader_program.get_handle());
+			if (!shader_program.get())
+				throw ShaderCompilationException("Shader compilation failed");
+		}
+
+		// model with several meshes gives one level to all of them, mesh with shorter chain draws its last one
+		void DrawLod(const size_t lod) const {
+			if (lods.empty()) {
+				Renderer_OpenGL::draw(*vao);
+				return;
+			}
+			const LodLevel& level = lods[std::min(lod, lods.size() - 1)];
+			Renderer_OpenGL::draw_range(*vao, level.first_index, level.index_count);
+		}
+
+		AssetRef<ShaderProgram> shader_program;
 		std::unique_ptr<VertexArray> vao;
 		std::unique_ptr<VertexBuffer> vbo;
 		std::unique_ptr<IndexBuffer> index_buffer;
-		std::map<std::string, Texture2D> textures;
 		// mesh data
 		std::vector<Vertex> vertices;
-		std::vector<GLuint> indices;
-		Camera camera;
+		std::vector<GLuint> indices; // all LOD levels one after another
+		std::map<std::string, AssetRef<Texture2D>> textures;
+		VertexQuantization quantization;
+		std::vector<LodLevel> lods;
+		LodSelector lod_selector;
+		glm::vec3 bounding_center{ 0.f };
+		float bounding_radius = 0.f;
 	};
 
 	class LightCubeNew : public MeshNew {
 	public:
 		LightCubeNew(
-			std::vector<Vertex>&& vertices,
-			std::vector<unsigned int>&& indices,
-			std::map<std::string, Texture2D>&& textures) :
-			MeshNew(std::move(vertices), std::move(indices), std::move(textures)) {
-			SetupMesh();
+			MeshData&& data,
+			std::map<std::string, AssetRef<Texture2D>>&& textures) :
+			MeshNew(std::move(data), std::move(textures)) {
 		}
 
 		// Explicitly delete the copy constructor and copy assignment operator
@@ -243,32 +350,30 @@ namespace SimpleEngine {
 				vao = std::move(other.vao);
 				vbo = std::move(other.vbo);
 				index_buffer = std::move(other.index_buffer);
-				textures = std::move(other.textures);
 				vertices = std::move(other.vertices);
 				indices = std::move(other.indices);
-				camera = std::move(other.camera);
+				textures = std::move(other.textures);
+				quantization = other.quantization;
+				lods = std::move(other.lods);
+				lod_selector = other.lod_selector;
+				bounding_center = other.bounding_center;
+				bounding_radius = other.bounding_radius;
 			}
 			return *this;
 		}
-		void UpdateLight(const PointLight& light) {
-			this->light = light;
+		// light cube shader reads only position, packed layout keeps it at location 0
+		void SetupShaderProgram(const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path) override {
+			LoadShaderProgram(vertex_shader_path, frag_shader_path);
 		}
-		void Draw() {
+		void Draw(const DrawContext& context, const DrawInstance& instance) override {
 			shader_program->bind();
 
 			// draw light cube
 			{
-				glm::mat4 rotateMat = glm::rotate(glm::mat4(1.0f), glm::radians(90.f), glm::vec3(1.f, 0.f, 0.f));
-				glm::mat4 translate_mat(
-					1, 0, 0, 0,
-					0, 1, 0, 0,
-					0, 0, 1, 0,
-					light.position[0], light.position[1], light.position[2], 1);
-				glm::mat4 scale_mat = glm::scale(glm::mat4(1.0f), glm::vec3(3));
-				shader_program->set_matrix4("mvp_mat",
-					camera.get_projection_matrix() * camera.get_view_matrix() * rotateMat * translate_mat * scale_mat);
-
-				light.UseLight(
+				// positions are quantized, restore them before model matrix
+				shader_program->set_matrix4("mvp_mat", instance.mvp_matrix * quantization.get_dequantization_matrix());
+
+				context.point_light.UseLight(
 					shader_program->get_uniform_location("light_ambient"),
 					shader_program->get_uniform_location("light_diffuse"),
 					shader_program->get_uniform_location("light_specular"),
@@ -279,113 +384,208 @@ namespace SimpleEngine {
 					shader_program->get_uniform_location("pointLight.constant"),
 					shader_program->get_uniform_location("pointLight.linear"),
 					shader_program->get_uniform_location("pointLight.quadratic"));
-				Renderer_OpenGL::draw(*vao);
+				DrawLod(instance.lod);
 			}
 		}
-	private:
-		PointLight light;
 	};
 
 	// Factory registry type
 	using MeshFactory = std::function<std::unique_ptr<MeshNew>(
-		std::vector<Vertex>&&,
-		std::vector<unsigned int>&&,
-		std::map<std::string, Texture2D>&&)>;
+		MeshData&&,
+		std::map<std::string, AssetRef<Texture2D>>&&)>;
 
 
 
-	std::unordered_map<std::string, MeshFactory> meshRegistry = {
-	{"LightCube", [](auto&& vertices, auto&& indices, auto&& textures) -> std::unique_ptr<MeshNew> {
-		return std::make_unique<LightCubeNew>(
-			std::move(vertices), std::move(indices), std::move(textures));
+	inline std::unordered_map<std::string, MeshFactory> meshRegistry = {
+	{"LightCube", [](auto&& data, auto&& textures) -> std::unique_ptr<MeshNew> {
+		return std::make_unique<LightCubeNew>(std::move(data), std::move(textures));
 	}},
-	{"MeshNew", [](auto&& vertices, auto&& indices, auto&& textures) -> std::unique_ptr<MeshNew> {
-		return std::make_unique<MeshNew>(
-			std::move(vertices), std::move(indices), std::move(textures));
+	{"MeshNew", [](auto&& data, auto&& textures) -> std::unique_ptr<MeshNew> {
+		return std::make_unique<MeshNew>(std::move(data), std::move(textures));
 	}}
 		// Add more models here...
 	};
 
 
 	// Factory function
-	std::unique_ptr<MeshNew> CreateMesh(
-		std::vector<Vertex>&& vertices,
-		std::vector<unsigned int>&& indices,
-		std::map<std::string, Texture2D>&& textures,
+	inline std::unique_ptr<MeshNew> CreateMesh(
+		MeshData&& data,
+		std::map<std::string, AssetRef<Texture2D>>&& textures,
 		const std::string& type)
 	{
 		auto it = meshRegistry.find(type);
 		if (it != meshRegistry.end()) {
-			return it->second(std::move(vertices), std::move(indices), std::move(textures));
+			return it->second(std::move(data), std::move(textures));
 		}
 		throw std::runtime_error("Unknown mesh type: " + type);
 	}
 
-	class Model {
+	class Model : public Drawable {
 	public:
 		Model(MeshType meshType = MeshType::LightCube,
 			std::filesystem::path path = "",
 			std::filesystem::path vertex_shader_path = "",
-			std::filesystem::path frag_shader_path = "")
+			std::filesystem::path frag_shader_path = "",
+			const LodSettings& lod_settings = LodSettings(),
+			const GeometryAccess access = GeometryAccess::GpuOnly)
 			: meshType(meshType)
 		{
-			LoadModel(path.string());
-			for (const auto& mesh : meshes) {
-				mesh->SetupShaderProgram(vertex_shader_path, frag_shader_path);
+			FileData file;
+			FileSystem::read(path.string(), file);
+			std::vector<MeshData> meshes_data;
+			Import(path.string(), file, lod_settings, meshes_data);
+			SetupMeshes(path.string(), std::move(meshes_data), vertex_shader_path, frag_shader_path, access);
+		}
+
+		// meshes were imported by Import in the background, so only buffers are created here
+		Model(const MeshType meshType, const std::string& path, std::vector<MeshData>&& meshes_data,
+			const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path,
+			const GeometryAccess access = GeometryAccess::GpuOnly)
+			: meshType(meshType)
+		{
+			SetupMeshes(path, std::move(meshes_data), vertex_shader_path, frag_shader_path, access);
+		}
+
+		// any thread: file is what FileSystem gives for path, cooked or source model
+		// cooked model has LOD chains made by AssetCooker, lod_settings are used only for source one
+		// meshes_data stays empty when file was not imported
+		static void Import(const std::string& path, const FileData& file, const LodSettings& lod_settings,
+			std::vector<MeshData>& meshes_data) {
+			// manifest gives cooked file for source path, its meshes are copied without importer
+			if (is_cooked_model(file.data(), file.size())) {
+				LoadCookedModel(path, file, meshes_data);
+				return;
+			}
+
+			Assimp::Importer import;
+			// model and its materials are found in mounted directories and archives
+			import.SetIOHandler(new AssimpIOSystem());
+			const aiScene* scene = import.ReadFile(path,
+				aiProcess_Triangulate | aiProcess_FlipUVs);
+
+			if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
+				LOG_ERROR_TO(Assets, "ERROR::ASSIMP::{0}", import.GetErrorString());
+				return;
 			}
+
+			ProcessNode(scene->mRootNode, scene, lod_settings, meshes_data);
 		}
 
-		void Draw() {
+		void Draw(const DrawContext& context, const DrawInstance& instance) override {
 			for (const auto& mesh : meshes) {
-				mesh->Draw();
+				mesh->Draw(context, instance);
 			}
 		}
 
-		void UpdateCamera(const Camera& cam) {
+		void DrawDepth(const ShaderProgram& depth_program, const glm::mat4& mvp_matrix, const uint32_t lod) override {
 			for (const auto& mesh : meshes) {
-				mesh->UpdateCamera(cam);
+				mesh->DrawDepth(depth_program, mvp_matrix, lod);
 			}
 		}
 
-		void UpdateLight(const PointLight& light) {
+		// the finest level any mesh needs, so none of them goes over pixel error
+		uint32_t SelectLod(const Camera& camera, const glm::mat4& model_matrix, const float pixel_error,
+			const uint32_t current_lod) const override {
+			size_t lod = 0;
+			bool has_lods = false;
 			for (const auto& mesh : meshes) {
-				mesh->UpdateLight(light);
+				if (mesh->GetLodsCount() < 2) {
+					continue;
+				}
+				const size_t mesh_lod = mesh->SelectLod(model_matrix, camera, pixel_error, current_lod);
+				lod = has_lods ? std::min(lod, mesh_lod) : mesh_lod;
+				has_lods = true;
 			}
+			return static_cast<uint32_t>(lod);
 		}
 
-	private:
-		void LoadModel(const std::string& path) {
-			Assimp::Importer import;
-			const aiScene* scene = import.ReadFile(path,
-				aiProcess_Triangulate | aiProcess_FlipUVs);
+		// model space sphere around all meshes
+		// false when file was not imported
+		bool IsLoaded() const { return !meshes.empty(); }
 
-			if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
-				LOG_INFO("ERROR::ASSIMP::{0}", import.GetErrorString());
+		void GetBoundingSphere(glm::vec3& center, float& radius) const {
+			if (meshes.empty()) {
+				center = glm::vec3(0.f);
+				radius = 0.f;
 				return;
 			}
+			glm::vec3 min = meshes[0]->GetBoundingCenter() - glm::vec3(meshes[0]->GetBoundingRadius());
+			glm::vec3 max = meshes[0]->GetBoundingCenter() + glm::vec3(meshes[0]->GetBoundingRadius());
+			for (const auto& mesh : meshes) {
+				min = glm::min(min, mesh->GetBoundingCenter() - glm::vec3(mesh->GetBoundingRadius()));
+				max = glm::max(max, mesh->GetBoundingCenter() + glm::vec3(mesh->GetBoundingRadius()));
+			}
+			center = (min + max) * 0.5f;
+			radius = glm::length(max - min) * 0.5f;
+		}
 
+	private:
+		void SetupMeshes(const std::string& path, std::vector<MeshData>&& meshes_data,
+			const std::filesystem::path& vertex_shader_path, const std::filesystem::path& frag_shader_path,
+			const GeometryAccess access) {
+			if (meshes_data.empty()) {
+				return;
+			}
 			directory = path.substr(0, path.find_last_of('/'));
-			ProcessNode(scene->mRootNode, scene);
+			const std::string type = (meshType == MeshType::LightCube) ? "LightCube" : "MeshNew";
+			for (MeshData& data : meshes_data) {
+				meshes.emplace_back(CreateMesh(std::move(data), std::map<std::string, AssetRef<Texture2D>>(), type));
+			}
+			for (const auto& mesh : meshes) {
+				mesh->SetupShaderProgram(vertex_shader_path, frag_shader_path);
+				if (access == GeometryAccess::GpuOnly) {
+					mesh->ReleaseCpuData();
+				}
+			}
 		}
 
-		void ProcessNode(aiNode* node, const aiScene* scene) {
+		static void LoadCookedModel(const std::string& path, const FileData& file, std::vector<MeshData>& meshes_data) {
+			static_assert(sizeof(Vertex) == s_cooked_vertex_size, "cooked vertices are copied as Vertex");
+			static_assert(sizeof(unsigned int) == sizeof(uint32_t), "cooked indices are copied as unsigned int");
+			std::vector<CookedMeshView> cooked_meshes;
+			if (!read_cooked_model(file.data(), file.size(), cooked_meshes)) {
+				LOG_ERROR_TO(Assets, "Cooked model {0} is damaged", path);
+				return;
+			}
+			for (const CookedMeshView& cooked : cooked_meshes) {
+				std::vector<Vertex> vertices(cooked.vertices_count);
+				std::memcpy(vertices.data(), cooked.vertices, vertices.size() * sizeof(Vertex));
+				std::vector<unsigned int> indices(cooked.indices_count);
+				std::memcpy(indices.data(), cooked.indices, indices.size() * sizeof(unsigned int));
+				std::vector<LodLevel> lods(cooked.lods_count);
+				for (uint32_t i = 0; i < cooked.lods_count; ++i) {
+					CookedMeshLod lod;
+					std::memcpy(&lod, cooked.lods + i * sizeof(lod), sizeof(lod));
+					lods[i] = LodLevel{ lod.first_index, lod.index_count, lod.error };
+				}
+				meshes_data.push_back(prepare_mesh_data(std::move(vertices), std::move(indices), std::move(lods)));
+			}
+		}
+
+		static void ProcessNode(aiNode* node, const aiScene* scene, const LodSettings& lod_settings,
+			std::vector<MeshData>& meshes_data) {
 			// Process all the node’s meshes (if any)
-			std::cout << "mNumMeshes:" << node->mNumMeshes << std::endl;
 			for (unsigned int i = 0; i < node->mNumMeshes; i++) {
 				aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-				meshes.emplace_back(ProcessMesh(mesh, scene));
+				meshes_data.push_back(ProcessMesh(mesh, scene, lod_settings));
 			}
 
 			// Process each of the children
 			for (unsigned int i = 0; i < node->mNumChildren; i++) {
-				ProcessNode(node->mChildren[i], scene);
+				ProcessNode(node->mChildren[i], scene, lod_settings, meshes_data);
 			}
 		}
 
-		std::unique_ptr<MeshNew> ProcessMesh(aiMesh* mesh, const aiScene* scene) {
+		static MeshData ProcessMesh(aiMesh* mesh, const aiScene* scene, const LodSettings& lod_settings) {
 			std::vector<Vertex> vertices;
 			std::vector<unsigned int> indices;
-			std::map<std::string, Texture2D> textures;
+			// arrays are moved into mesh, so they are sized once instead of growing
+			vertices.reserve(mesh->mNumVertices);
+			size_t indices_count = 0;
+			for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+				indices_count += mesh->mFaces[i].mNumIndices;
+			}
+			indices.reserve(indices_count);
 
 			// Process vertex positions, normals, and texture coordinates
 			for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -420,7 +620,7 @@ namespace SimpleEngine {
 
 			// Process indices
 			for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-				aiFace face = mesh->mFaces[i];
+				const aiFace& face = mesh->mFaces[i];
 				for (unsigned int j = 0; j < face.mNumIndices; j++) {
 					indices.push_back(face.mIndices[j]);
 				}
@@ -442,22 +642,13 @@ namespace SimpleEngine {
 			}*/
 
 
-			// Determine the mesh type and create the mesh
-			std::string type = (meshType == MeshType::LightCube) ? "LightCube" : "MeshNew";
-			for (const auto v : vertices) {
-				std::cout << v.Normal.x << ", " << v.Normal.y << ", " << v.Normal.z << std::endl;
-				std::cout << v.Position.x << ", " << v.Position.y << ", " << v.Position.z << std::endl;
-				std::cout << v.TexCoords.x << ", " << v.TexCoords.y << std::endl;
-			}
-			for (const auto ind : indices) {
-				std::cout << ind << ", ";
-			}
-			return CreateMesh(std::move(vertices), std::move(indices), std::move(textures), type);
+			LOG_TRACE_TO(Assets, "Mesh of {0} vertices, {1} indices", vertices.size(), indices.size());
+			return prepare_mesh_data(std::move(vertices), std::move(indices), lod_settings);
 		}
 
-		std::map<std::string, Texture2D> LoadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName)
+		static std::map<std::string, AssetRef<Texture2D>> LoadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName)
 		{
-			std::map<std::string, Texture2D> textures;
+			std::map<std::string, AssetRef<Texture2D>> textures;
 			// Uncomment and implement if material textures are needed
 			/*
 			for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
@@ -482,29 +673,19 @@ namespace SimpleEngine {
 	class LightCube : public Mesh {
 	public:
 		LightCube(const std::vector<GLfloat> vertices, const std::vector<GLuint> indices,
-			std::filesystem::path vertex_shader_path, std::filesystem::path frag_shader_path,
-			const Camera& camera, const PointLight& light) :
-			Mesh(camera, vertices, indices, vertex_shader_path, frag_shader_path),
-			light(light)
+			std::filesystem::path vertex_shader_path, std::filesystem::path frag_shader_path) :
+			Mesh(vertices, indices, vertex_shader_path, frag_shader_path)
 		{
 		}
-		void UpdateLight(const PointLight& light) {
-			this->light = light;
-		}
-		void Draw() {
+		void Draw(const DrawContext& context, const DrawInstance& instance) override {
+			MakeResident();
 			p_shader_program->bind();
 
 			// draw light cube
 			{
-				glm::mat4 translate_mat(
-					1, 0, 0, 0,
-					0, 1, 0, 0,
-					0, 0, 1, 0,
-					light.position[0], light.position[1], light.position[2], 1);
-				p_shader_program->set_matrix4("mvp_mat",
-					camera.get_projection_matrix() * camera.get_view_matrix() * translate_mat);
-
-				light.UseLight(
+				p_shader_program->set_matrix4("mvp_mat", instance.mvp_matrix);
+
+				context.point_light.UseLight(
 					p_shader_program->get_uniform_location("light_ambient"),
 					p_shader_program->get_uniform_location("light_diffuse"),
 					p_shader_program->get_uniform_location("light_specular"),
@@ -515,181 +696,98 @@ namespace SimpleEngine {
 					p_shader_program->get_uniform_location("pointLight.constant"),
 					p_shader_program->get_uniform_location("pointLight.linear"),
 					p_shader_program->get_uniform_location("pointLight.quadratic"));
-				Renderer_OpenGL::draw(*p_vao);
+				Renderer_OpenGL::draw(GetVertexArray());
 			}
 		}
-	private:
-		PointLight light;
 	};
 
+	// textured phong mesh, shape is one of shared primitives
 	class Cube : public Mesh {
 	public:
-		Cube(const Material& material,
-			std::filesystem::path vertex_shader_path = "", std::filesystem::path frag_shader_path = "",
-			glm::vec3 position = glm::vec3{ -2.f, -2.f, 40.f },
+		Cube(std::filesystem::path vertex_shader_path = "", std::filesystem::path frag_shader_path = "",
 			std::vector<std::filesystem::path> v_texture = {},
-			const std::vector<GLfloat>& vertices = {},
-			const std::vector<GLuint>& indices = {},
-			const Camera& camera = Camera(),
-			const DirectionalLight& dirLight = DirectionalLight(), bool useDirLight = false,
-			const PointLight& pointLight = PointLight(), bool usePointLight = false,
-			const SpotLight& spotLight = SpotLight(), bool useSpotLight = false,
-			const glm::vec3 dirVector = glm::vec3(1),
-			const glm::vec3 scale_factor = glm::vec3(1)
-		) : Mesh(camera, vertices, indices, vertex_shader_path, frag_shader_path, v_texture),
-			dirLight(dirLight), useDirLight(useDirLight),
-			pointLight(pointLight), usePointLight(usePointLight),
-			spotLight(spotLight), useSpotLight(useSpotLight),
-			dirVector(dirVector),
-			scale_factor(scale_factor),
-			material(material), position(position)
+			const Primitive primitive = Primitive::Cube
+		) : Mesh(AssetRef<MeshGeometry>(AssetManager::get_primitive(primitive)), vertex_shader_path, frag_shader_path, v_texture)
 		{
 		}
 
-		void UpdateLight(
-			const DirectionalLight& dirLight, bool useDirLight,
-			const PointLight& pointLight, bool usePointLight,
-			const SpotLight& spotLight, bool useSpotLight
-		) {
-			this->dirLight = dirLight;
-			this->useDirLight = useDirLight;
-
-			this->pointLight = pointLight;
-			this->usePointLight = usePointLight;
-
-			this->spotLight = spotLight;
-			this->useSpotLight = useSpotLight;
-		}
-
-		void UpdateDirVector(const glm::vec3& dirVector) {
-			this->dirVector = dirVector;
-		}
-
-		void Draw()
+		void Draw(const DrawContext& context, const DrawInstance& instance) override
 		{
+			MakeResident();
 			p_shader_program->bind();
 
 			// Textures
-			auto it = m_texture.find("material.diffuse");
-			if (it != m_texture.end()) {
-				p_shader_program->set_int("material.diffuse", 0);
-				it->second.bind(0);
-			}
-			auto it1 = m_texture.find("material.specular");
-			if (it != m_texture.end()) {
-				p_shader_program->set_int("material.specular", 0);
-				it->second.bind(1);
-			}
-
-			p_shader_program->set_vec3("globalAmbient", glm::vec3{ 0.2,0.2,0.2 });
-
-			dirLight.UseLight(
-				p_shader_program->get_uniform_location("directionalLight.ambient"),
-				p_shader_program->get_uniform_location("directionalLight.diffuse"),
-				p_shader_program->get_uniform_location("directionalLight.specular"),
-				p_shader_program->get_uniform_location("directionalLight.direction"),
-				p_shader_program->get_uniform_location("directionalLight.ambientIntensity"),
-				p_shader_program->get_uniform_location("directionalLight.diffuseIntensity"),
-				p_shader_program->get_uniform_location("directionalLight.specularIntensity")
-			);
+			BindTextures(*p_shader_program);
 
-			pointLight.UseLight(
-				p_shader_program->get_uniform_location("pointLight.ambient"),
-				p_shader_program->get_uniform_location("pointLight.diffuse"),
-				p_shader_program->get_uniform_location("pointLight.specular"),
-				p_shader_program->get_uniform_location("pointLight.position"),
-				p_shader_program->get_uniform_location("pointLight.ambientIntensity"),
-				p_shader_program->get_uniform_location("pointLight.diffuseIntensity"),
-				p_shader_program->get_uniform_location("pointLight.specularIntensity"),
-				p_shader_program->get_uniform_location("pointLight.constant"),
-				p_shader_program->get_uniform_location("pointLight.linear"),
-				p_shader_program->get_uniform_location("pointLight.quadratic")
-			);
-
-			spotLight.UseLight(
-				p_shader_program->get_uniform_location("spotLight.ambient"),
-				p_shader_program->get_uniform_location("spotLight.diffuse"),
-				p_shader_program->get_uniform_location("spotLight.specular"),
-				p_shader_program->get_uniform_location("spotLight.position"),
-				p_shader_program->get_uniform_location("spotLight.direction"),
-				p_shader_program->get_uniform_location("spotLight.ambientIntensity"),
-				p_shader_program->get_uniform_location("spotLight.diffuseIntensity"),
-				p_shader_program->get_uniform_location("spotLight.specularIntensity"),
-				p_shader_program->get_uniform_location("spotLight.constant"),
-				p_shader_program->get_uniform_location("spotLight.linear"),
-				p_shader_program->get_uniform_location("spotLight.quadratic"),
-				p_shader_program->get_uniform_location("spotLight.cutOff")
-			);
-
-			// Cam 
-			p_shader_program->set_vec3("cam_pos", camera.get_camera_pos());
-
-			// Use light
-			p_shader_program->set_int("useDirLight", useDirLight);
-			p_shader_program->set_int("usePointLight", usePointLight);
-			p_shader_program->set_int("useSpotLight", useSpotLight);
+			SetFrameUniforms(*p_shader_program, context);
 
 			// material
-			material.UseMaterial(
+			instance.material.UseMaterial(
 				p_shader_program->get_uniform_location("material.ambient"),
 				p_shader_program->get_uniform_location("material.shininess"));
 
 			// draw cubes
 			{
-				glm::mat4 rotateMat = glm::mat4(1.0f);  // Identity matrix
-				if (dirVector != glm::vec3(0)) {
-					// Normalize the light direction
-					glm::vec3 lightDirection = glm::normalize(dirVector);
+				p_shader_program->set_matrix4("m_mat", instance.model_matrix);
+				p_shader_program->set_matrix3("normal_mat", instance.normal_matrix);
+				p_shader_program->set_matrix4("mvp_mat", instance.mvp_matrix);
 
-					// Define the forward vector of the rectangle (usually along the Z-axis)
-					glm::vec3 forward = glm::vec3(0.0f, 0.0f, 1.0f);
+				Renderer_OpenGL::draw(GetVertexArray());
+			}
+		}
 
-					// Compute the axis of rotation (cross product)
-					glm::vec3 axis = glm::cross(forward, lightDirection);
+		// lights, shadows and camera of phong_cube_fragment_shader, the same for every instance
+		static void SetFrameUniforms(const ShaderProgram& program, const DrawContext& context)
+		{
+			program.set_vec3("globalAmbient", context.ambient_light);
+
+			context.directional_light.UseLight(
+				program.get_uniform_location("directionalLight.ambient"),
+				program.get_uniform_location("directionalLight.diffuse"),
+				program.get_uniform_location("directionalLight.specular"),
+				program.get_uniform_location("directionalLight.direction"),
+				program.get_uniform_location("directionalLight.ambientIntensity"),
+				program.get_uniform_location("directionalLight.diffuseIntensity"),
+				program.get_uniform_location("directionalLight.specularIntensity")
+			);
 
-					// If the axis is near zero, the vectors are collinear and no rotation is needed
-					if (glm::length(axis) > 0.0f) {
-						// Compute the angle between the two vectors (dot product)
-						float angle = glm::acos(glm::dot(forward, lightDirection));
+			// point and spot lights come from cluster buffers bound for the whole frame
+			program.set_matrix4("view_mat", context.camera.get_view_matrix());
+			program.set_ivec3("clusterGrid",
+				glm::ivec3(ClusterGrid::s_tiles_x, ClusterGrid::s_tiles_y, ClusterGrid::s_slices));
+			program.set_vec2("clusterTileSize", context.cluster_grid.tile_size);
+			program.set_vec2("clusterZParams", glm::vec2(context.cluster_grid.z_scale, context.cluster_grid.z_bias));
+
+			// directional light shadow
+			const ShadowCascades& shadows = context.shadow_cascades;
+			program.set_int("shadowMap", static_cast<int>(ShadowCascades::s_texture_unit));
+			program.set_int("shadowCascadesCount", static_cast<int>(shadows.count));
+			glUniformMatrix4fv(program.get_uniform_location("shadowMatrices"),
+				ShadowCascades::s_max_cascades, GL_FALSE, &shadows.view_projection[0][0][0]);
+			glUniform1fv(program.get_uniform_location("shadowSplits"),
+				ShadowCascades::s_max_cascades, shadows.split_depth);
 
-						// Create the rotation matrix using glm::rotate (which uses axis-angle rotation)
-						rotateMat = glm::rotate(glm::mat4(1.0f), angle, axis);
-					}
-				}
-				glm::mat4 scale_mat = glm::scale(glm::mat4(1.0f), scale_factor);
-				glm::mat4 translate_mat(
-					1, 0, 0, 0,
-					0, 1, 0, 0,
-					0, 0, 1, 0,
-					position[0], position[1], position[2], 1);
-
-				const glm::mat4 m_mat =
-					translate_mat * rotateMat * scale_mat;
-				p_shader_program->set_matrix4("m_mat", m_mat);
-
-				const glm::mat4 normal_mat =
-					glm::mat3(transpose(inverse(m_mat)));
-				p_shader_program->set_matrix3("normal_mat", normal_mat);
-
-				const glm::mat4 mvp_mat =
-					camera.get_projection_matrix() * camera.get_view_matrix() * m_mat;
-				p_shader_program->set_matrix4("mvp_mat", mvp_mat);
-
-				Renderer_OpenGL::draw(*p_vao);
-			}
-		}
+			// Cam 
+			program.set_vec3("cam_pos", context.camera.get_camera_pos());
 
-	private:
-		DirectionalLight dirLight;
-		bool useDirLight;
-		PointLight pointLight;
-		bool usePointLight;
-		SpotLight spotLight;
-		bool useSpotLight;
-		glm::vec3 dirVector;
-		const glm::vec3 scale_factor;
-		Material material;
-		glm::vec3 position;
+			// Use light
+			program.set_int("useDirLight", context.use_directional_light);
+		}
 	};
 
+	inline void MeshNew::Draw(const DrawContext& context, const DrawInstance& instance) {
+		shader_program->bind();
+		Cube::SetFrameUniforms(*shader_program, context);
+		instance.material.UseMaterial(
+			shader_program->get_uniform_location("material.ambient"),
+			shader_program->get_uniform_location("material.shininess"));
+
+		// positions are quantized, restore them before model matrix, normals are not
+		const glm::mat4 dequantization = quantization.get_dequantization_matrix();
+		shader_program->set_matrix4("m_mat", instance.model_matrix * dequantization);
+		shader_program->set_matrix3("normal_mat", instance.normal_matrix);
+		shader_program->set_matrix4("mvp_mat", instance.mvp_matrix * dequantization);
+		DrawLod(instance.lod);
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "MeshGeometry.h"
+
+namespace SimpleEngine {
+
+	MeshGeometry::MeshGeometry(std::vector<float> vertices, std::vector<uint32_t> indices, const GeometryAccess access)
+		: m_vertices_count(vertices.size() / 8)
+		, m_indices_count(indices.size())
+		, m_access(access)
+	{
+		upload(vertices, indices);
+		if (has_cpu_data()) {
+			m_vertices = std::move(vertices);
+			m_indices = std::move(indices);
+			m_residency = GpuMemory::add_evictable(this);
+		}
+		// GpuOnly: arguments are destroyed here, driver has its own copy
+	}
+
+	MeshGeometry::~MeshGeometry()
+	{
+		GpuMemory::remove_evictable(m_residency);
+	}
+
+	void MeshGeometry::upload(const std::vector<float>& vertices, const std::vector<uint32_t>& indices)
+	{
+		m_vao = std::make_unique<VertexArray>();
+		m_vao->bind();
+		m_vbo = std::make_unique<VertexBuffer>(vertices.data(), vertices.size() * sizeof(float),
+			BufferLayout{ ShaderDataType::Float3, ShaderDataType::Float3, ShaderDataType::Float2 });
+		m_vao->add_vertex_buffer(*m_vbo);
+		// 16 bit indices if it fits
+		m_index_buffer = std::make_unique<IndexBuffer>(indices, m_vertices_count);
+		m_vao->set_index_buffer(*m_index_buffer);
+		VertexArray::unbind();
+		m_gpu_bytes = vertices.size() * sizeof(float) + m_index_buffer->get_size();
+	}
+
+	void MeshGeometry::make_resident()
+	{
+		if (!m_vao) {
+			GpuMemoryScope gpu_memory_owner(GpuMemory::get_evictable_owner(m_residency));
+			upload(m_vertices, m_indices);
+		}
+		GpuMemory::mark_used(m_residency);
+	}
+
+	void MeshGeometry::evict()
+	{
+		m_vao = nullptr;
+		m_vbo = nullptr;
+		m_index_buffer = nullptr;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "GpuMemory.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+	enum class GeometryAccess : uint8_t {
+		GpuOnly,	// arrays are freed after upload, buffers are never evicted because there is nothing to upload again
+		CpuAndGpu	// collision and picking read arrays, buffers can be evicted under budget and uploaded again from them
+	};
+
+	// vertex and index buffers of one mesh, 8 floats per vertex: position, normal, uv
+	// shared through AssetManager by every mesh drawing the same vertices
+	class MeshGeometry : public GpuEvictable {
+	public:
+		MeshGeometry(std::vector<float> vertices, std::vector<uint32_t> indices, const GeometryAccess access);
+		~MeshGeometry();
+
+		MeshGeometry(const MeshGeometry&) = delete;
+		MeshGeometry& operator=(const MeshGeometry&) = delete;
+
+		// uploads evicted buffers again, has to be called before vertex array is drawn
+		void make_resident();
+		void evict() override;
+
+		const VertexArray& get_vertex_array() const { return *m_vao; }
+		const VertexBuffer& get_vertex_buffer() const { return *m_vbo; }
+		const IndexBuffer& get_index_buffer() const { return *m_index_buffer; }
+
+		GeometryAccess get_access() const { return m_access; }
+		bool has_cpu_data() const { return m_access == GeometryAccess::CpuAndGpu; }
+		// empty for GpuOnly geometry
+		const std::vector<float>& get_vertices() const { return m_vertices; }
+		const std::vector<uint32_t>& get_indices() const { return m_indices; }
+		size_t get_vertices_count() const { return m_vertices_count; }
+		size_t get_indices_count() const { return m_indices_count; }
+		// vertex and index buffers, counted while evicted too
+		size_t get_gpu_bytes() const { return m_gpu_bytes; }
+
+	private:
+		void upload(const std::vector<float>& vertices, const std::vector<uint32_t>& indices);
+
+		std::unique_ptr<VertexArray> m_vao;
+		std::unique_ptr<VertexBuffer> m_vbo;
+		std::unique_ptr<IndexBuffer> m_index_buffer;
+		std::vector<float> m_vertices;
+		std::vector<uint32_t> m_indices;
+		size_t m_vertices_count = 0;
+		size_t m_indices_count = 0;
+		size_t m_gpu_bytes = 0;
+		GeometryAccess m_access;
+		GpuMemory::Handle m_residency = GpuMemory::s_invalid_handle;
+	};
+}
@@ -4,8 +4,12 @@
 #include <GLFW/glfw3.h>
 
 #include "VertexArray.h"
+#include "GpuMemory.h"
 #include "SimpleEngineCore/Log.h"
 
+#include <chrono>
+#include <mutex>
+
 namespace SimpleEngine {
 
 	const char* gl_source_to_string(const GLenum source)
@@ -38,13 +42,83 @@ namespace SimpleEngine {
 		}
 	}
 
+	namespace {
+		// driver repeats the same debug message every draw call, that floods the log and costs a line per call
+		// every message (source, type, id) is written at most s_burst times per window, the rest is only counted
+		class GLDebugRateLimiter {
+		public:
+			using Clock = std::chrono::steady_clock;
+
+			// false - drop message, suppressed - how many of it were dropped in the previous window
+			bool allow(const GLenum source, const GLenum type, const GLuint id, uint32_t& suppressed) {
+				const uint64_t key = (static_cast<uint64_t>(source) << 48) ^ (static_cast<uint64_t>(type) << 32) ^ id;
+				const Clock::time_point now = Clock::now();
+				suppressed = 0;
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				Entry* entry = find(key);
+				if (entry == nullptr) {
+					// table is full, unknown messages are not limited
+					return true;
+				}
+				if (now - entry->window_begin >= s_window) {
+					suppressed = entry->suppressed;
+					entry->window_begin = now;
+					entry->count = 0;
+					entry->suppressed = 0;
+				}
+				if (entry->count < s_burst) {
+					++entry->count;
+					return true;
+				}
+				++entry->suppressed;
+				return false;
+			}
+
+		private:
+			static constexpr uint32_t s_burst = 3;
+			static constexpr Clock::duration s_window = std::chrono::seconds(1);
+			static constexpr size_t s_entries = 64;
+
+			struct Entry {
+				uint64_t key = 0;
+				bool used = false;
+				Clock::time_point window_begin;
+				uint32_t count = 0;
+				uint32_t suppressed = 0;
+			};
+
+			// open addressing, entries are never removed
+			Entry* find(const uint64_t key) {
+				const size_t start = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 58);
+				for (size_t i = 0; i < s_entries; ++i) {
+					Entry& entry = m_entries[(start + i) % s_entries];
+					if (!entry.used) {
+						entry.used = true;
+						entry.key = key;
+						return &entry;
+					}
+					if (entry.key == key) {
+						return &entry;
+					}
+				}
+				return nullptr;
+			}
+
+			std::mutex m_mutex;
+			Entry m_entries[s_entries];
+		};
+
+		GLDebugRateLimiter glDebugRateLimiter;
+	}
+
 	bool Renderer_OpenGL::init(GLFWwindow* pWindow)
 	{
 		/* Make the window's context current */
 		glfwMakeContextCurrent(pWindow);
 
 		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-			LOG_CRIT("Failed to init GLAD");
+			LOG_CRIT_TO(Render, "Failed to init GLAD");
 			return false;
 		}
 		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
@@ -57,38 +131,46 @@ namespace SimpleEngine {
 			const GLchar* message,
 			const void* userParam)
 			{
+				uint32_t suppressed = 0;
+				if (!glDebugRateLimiter.allow(source, type, id, suppressed)) {
+					return;
+				}
+				if (suppressed > 0) {
+					LOG_WARN_TO(GLDebug, "OpenGL message ({0}) was repeated {1} more times in the last second", id, suppressed);
+				}
+
 				switch (severity)
 				{
 				case GL_DEBUG_SEVERITY_HIGH:
-					LOG_ERROR("OpenGL Error: [{0}:{1}]({2}): {3}",
+					LOG_ERROR_TO(GLDebug, "OpenGL Error: [{0}:{1}]({2}): {3}",
 						gl_source_to_string(source),
 						gl_type_to_string(type),
 						id,
 						message);
 					break;
 				case GL_DEBUG_SEVERITY_MEDIUM:
-					LOG_WARN("OpenGL Warning: [{0}:{1}]({2}): {3}",
+					LOG_WARN_TO(GLDebug, "OpenGL Warning: [{0}:{1}]({2}): {3}",
 						gl_source_to_string(source),
 						gl_type_to_string(type),
 						id,
 						message);
 					break;
 				case GL_DEBUG_SEVERITY_LOW:
-					LOG_INFO("OpenGL Info: [{0}:{1}]({2}): {3}",
+					LOG_INFO_TO(GLDebug, "OpenGL Info: [{0}:{1}]({2}): {3}",
 						gl_source_to_string(source),
 						gl_type_to_string(type),
 						id,
 						message);
 					break;
 				case GL_DEBUG_SEVERITY_NOTIFICATION:
-					LOG_INFO("OpenGL Notificaton: [{0}:{1}]({2}): {3}",
+					LOG_INFO_TO(GLDebug, "OpenGL Notificaton: [{0}:{1}]({2}): {3}",
 						gl_source_to_string(source),
 						gl_type_to_string(type),
 						id,
 						message);
 					break;
 				default:
-					LOG_ERROR("OpenGL Error: [{0}:{1}] ({2}) : {3}",
+					LOG_ERROR_TO(GLDebug, "OpenGL Error: [{0}:{1}] ({2}) : {3}",
 						gl_source_to_string(source),
 						gl_type_to_string(type),
 						id,
@@ -96,13 +178,49 @@ namespace SimpleEngine {
 				}
 			}, nullptr
 		);
+		GpuMemory::init();
 		return true;
 	}
+	Renderer_OpenGL::FrameStats Renderer_OpenGL::s_frame_stats;
+
 	void Renderer_OpenGL::draw(const VertexArray& v_arr)
 	{
+		draw_range(v_arr, 0, v_arr.get_indices_count());
+	}
+	void Renderer_OpenGL::draw_range(const VertexArray& v_arr, const size_t first_index, const size_t indices_count)
+	{
+		const size_t index_size = v_arr.get_index_type() == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
 		v_arr.bind();
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(v_arr.get_indices_count()), GL_UNSIGNED_INT, nullptr);
+		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_count), v_arr.get_index_type(),
+			reinterpret_cast<const void*>(first_index * index_size));
 		v_arr.unbind();
+
+		++s_frame_stats.draw_calls;
+		s_frame_stats.triangles += indices_count / 3;
+	}
+	void Renderer_OpenGL::multi_draw_indirect_count(const VertexArray& v_arr, const size_t max_draws)
+	{
+		if (max_draws == 0) {
+			return;
+		}
+		v_arr.bind();
+		if (supports_indirect_count()) {
+			glMultiDrawElementsIndirectCount(GL_TRIANGLES, v_arr.get_index_type(), nullptr, 0,
+				static_cast<GLsizei>(max_draws), 0);
+		}
+		else {
+			glMultiDrawElementsIndirect(GL_TRIANGLES, v_arr.get_index_type(), nullptr,
+				static_cast<GLsizei>(max_draws), 0);
+		}
+		v_arr.unbind();
+
+		++s_frame_stats.draw_calls;
+		++s_frame_stats.indirect_draws;
+	}
+	bool Renderer_OpenGL::supports_indirect_count()
+	{
+		// Mesa llvmpipe reports 4.5, there indirect count is emulated by zeroed commands
+		return GLAD_GL_VERSION_4_6 != 0;
 	}
 	void Renderer_OpenGL::draw_arrays(const VertexArray& v_arr)
 	{
@@ -127,6 +245,31 @@ namespace SimpleEngine {
 	{
 		glDisable(GL_DEPTH_TEST);
 	}
+	void Renderer_OpenGL::set_depth_func(const EDepthFunc depth_func)
+	{
+		switch (depth_func)
+		{
+		case EDepthFunc::Less: glDepthFunc(GL_LESS); break;
+		case EDepthFunc::LessEqual: glDepthFunc(GL_LEQUAL); break;
+		case EDepthFunc::Equal: glDepthFunc(GL_EQUAL); break;
+		case EDepthFunc::Greater: glDepthFunc(GL_GREATER); break;
+		case EDepthFunc::GreaterEqual: glDepthFunc(GL_GEQUAL); break;
+		}
+	}
+	void Renderer_OpenGL::set_depth_write(const bool enable)
+	{
+		glDepthMask(enable ? GL_TRUE : GL_FALSE);
+	}
+	void Renderer_OpenGL::set_color_write(const bool enable)
+	{
+		const GLboolean mask = enable ? GL_TRUE : GL_FALSE;
+		glColorMask(mask, mask, mask, mask);
+	}
+	void Renderer_OpenGL::set_reverse_z(const bool reverse_z)
+	{
+		glClipControl(GL_LOWER_LEFT, reverse_z ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
+		glClearDepth(reverse_z ? 0.0 : 1.0);
+	}
 	void Renderer_OpenGL::set_viewport(const unsigned int w, const unsigned int h, const unsigned int left_offset, const unsigned int bottom_offset)
 	{
 		glViewport(left_offset, bottom_offset, w, h);
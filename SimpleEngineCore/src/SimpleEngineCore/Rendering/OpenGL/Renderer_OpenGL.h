@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 struct GLFWwindow;
 
 namespace SimpleEngine {
@@ -8,18 +10,51 @@ namespace SimpleEngine {
 
 	class Renderer_OpenGL {
 	public:
+		enum class EDepthFunc {
+			Less,
+			LessEqual,
+			Equal,
+			Greater,
+			GreaterEqual
+		};
+
+		struct FrameStats {
+			size_t draw_calls = 0;
+			size_t triangles = 0;		// indirect draws are not counted, only GPU knows how many
+			size_t indirect_draws = 0;
+		};
+
 		static bool init(GLFWwindow* pWindow);
 
 		static void draw(const VertexArray& v_arr);
+		// draw only part of index buffer (LOD levels share one index buffer)
+		static void draw_range(const VertexArray& v_arr, const size_t first_index, const size_t indices_count);
 		static void draw_arrays(const VertexArray& v_arr);
+		// draws commands (DrawElementsIndirectCommand) from bound draw indirect buffer,
+		// count is the first uint of bound parameter buffer and can't be bigger than max_draws
+		// without GL 4.6 all max_draws commands are issued, unused ones have to be zeroed
+		static void multi_draw_indirect_count(const VertexArray& v_arr, const size_t max_draws);
+		static bool supports_indirect_count();
 		static void set_clear_color(const float r, const float g, const float b, const float a);
 		static void clear();
 		static void enable_depth_testing();
 		static void disable_depth_testing();
+		static void set_depth_func(const EDepthFunc depth_func);
+		static void set_depth_write(const bool enable);
+		static void set_color_write(const bool enable);
+		// reverse-Z: clip depth in [0, 1] with near plane at 1 and far at 0, depth is cleared to 0
+		// projection has to be made for it (Camera::set_reverse_z) and depth test has to be Greater
+		static void set_reverse_z(const bool reverse_z);
 		static void set_viewport(const unsigned int w, const unsigned int h, const unsigned int left_offset = 0, const unsigned int bottom_offset = 0);
 
 		static const char* get_vendor_str();
 		static const char* get_renderer_str();
 		static const char* get_version_str();
+
+		static const FrameStats& get_frame_stats() { return s_frame_stats; }
+		static void reset_frame_stats() { s_frame_stats = FrameStats(); }
+
+	private:
+		static FrameStats s_frame_stats;
 	};
 }
\ No newline at end of file
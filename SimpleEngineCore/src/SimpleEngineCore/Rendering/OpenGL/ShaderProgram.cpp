@@ -1,6 +1,7 @@
 #include "ShaderProgram.h"
 
 #include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -8,8 +9,6 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
-#include <fstream>
-#include <sstream>
 
 namespace SimpleEngine {
 	bool create_shader(const char* source, const GLenum shader_type, GLuint& shader_id) {
@@ -23,7 +22,7 @@ namespace SimpleEngine {
 		if (success == GL_FALSE) {
 			char info_log[1024];
 			glGetShaderInfoLog(shader_id, 1024, nullptr, info_log);
-			LOG_CRIT("Shader compilation error:\n{}", info_log);
+			LOG_CRIT_TO(Render, "Shader compilation error:\n{}", info_log);
 			return false;
 		}
 		return true;
@@ -33,14 +32,14 @@ namespace SimpleEngine {
 	{
 		GLuint vertex_shader_id = 0;
 		if (!create_shader(ReadFile(file_vertex_shader).c_str(), GL_VERTEX_SHADER, vertex_shader_id)) {
-			LOG_CRIT("Vertex shader: compile-time error!");
+			LOG_CRIT_TO(Render, "Vertex shader: compile-time error!");
 			glDeleteShader(vertex_shader_id);
 			return;
 		}
 
 		GLuint frag_shader_id = 0;
 		if (!create_shader(ReadFile(file_frag_shader).c_str(), GL_FRAGMENT_SHADER, frag_shader_id)) {
-			LOG_CRIT("Frag shader: compile-time error!");
+			LOG_CRIT_TO(Render, "Frag shader: compile-time error!");
 			glDeleteShader(vertex_shader_id);
 			glDeleteShader(frag_shader_id);
 			return;
@@ -57,7 +56,7 @@ namespace SimpleEngine {
 		if (success == GL_FALSE) {
 			GLchar info_log[1024];
 			glGetProgramInfoLog(m_id, 1024, nullptr, info_log);
-			LOG_CRIT("SHADER PROGRAM: Link-time error:\n{0}", info_log);
+			LOG_CRIT_TO(Render, "SHADER PROGRAM: Link-time error:\n{0}", info_log);
 			glDeleteProgram(m_id);
 			m_id = 0;
 			glDeleteShader(vertex_shader_id);
@@ -102,20 +101,13 @@ namespace SimpleEngine {
 
 	std::string ShaderProgram::ReadFile(const std::string& fileLocation)
 	{
-		// TODO using file is bad practice because of raii
-		std::ifstream file(fileLocation);
-		if (!file.is_open()) {
+		// virtual path, from mounted directory or archive
+		std::string source;
+		if (!FileSystem::read_text(fileLocation, source)) {
 			std::string msg = "File open failed " + std::string(fileLocation);
 			throw std::exception(msg.c_str());
 		}
-
-		std::stringstream stream;
-		std::string str;
-		while (std::getline(file, str)) {
-			stream << str << '\n';;
-		}
-		file.close();
-		return stream.str();
+		return source;
 	}
 
 	void ShaderProgram::bind() const
@@ -159,4 +151,14 @@ namespace SimpleEngine {
 	{
 		glUniform3f(get_uniform_location(name), v.x, v.y, v.z);
 	}
+
+	void ShaderProgram::set_vec2(const char* name, const glm::vec2& v) const
+	{
+		glUniform2f(get_uniform_location(name), v.x, v.y);
+	}
+
+	void ShaderProgram::set_ivec3(const char* name, const glm::ivec3& v) const
+	{
+		glUniform3i(get_uniform_location(name), v.x, v.y, v.z);
+	}
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 
 #include <string>
 
@@ -8,6 +10,9 @@
 
 namespace SimpleEngine {
 
+	// compiles one stage, logs errors, shared with ComputeProgram
+	bool create_shader(const char* source, const GLenum shader_type, GLuint& shader_id);
+
 	class ShaderProgram {
 	public:
 		ShaderProgram(const std::string& file_vertex_shader, const std::string& file_frag_shader);
@@ -31,6 +36,8 @@ namespace SimpleEngine {
 		void set_bool(const char* name, const bool value) const;
 		void set_float(const char* name, const float value) const;
 		void set_vec3(const char* name, const glm::vec3& v) const;
+		void set_vec2(const char* name, const glm::vec2& v) const;
+		void set_ivec3(const char* name, const glm::ivec3& v) const;
 
 		GLint get_uniform_location(const char* name) const;
 
@@ -0,0 +1,157 @@
+#include "ShaderStorageBuffer.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	constexpr GLenum usage_to_GLenum2(const VertexBuffer::EUsage usage) {
+		switch (usage)
+		{
+			case VertexBuffer::EUsage::Static: return GL_STATIC_DRAW;
+			case VertexBuffer::EUsage::Dynamic: return GL_DYNAMIC_DRAW;
+			case VertexBuffer::EUsage::Stream: return GL_STREAM_DRAW;
+		}
+
+		LOG_ERROR_TO(Render, "Unknown VertexBuffer usage");
+		return GL_STREAM_DRAW;
+	}
+
+	// zero sized buffer can't be bound to binding point
+	constexpr size_t s_min_capacity = 16;
+
+	ShaderStorageBuffer::ShaderStorageBuffer(const void* data, const size_t size, const VertexBuffer::EUsage usage)
+		: m_size(size)
+		, m_capacity(std::max(size, s_min_capacity))
+		, m_usage(usage)
+	{
+		glGenBuffers(1, &m_id);
+		bind();
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_capacity, nullptr, usage_to_GLenum2(m_usage));
+		if (data != nullptr && size > 0) {
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+		}
+		m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::StorageBuffers, m_capacity);
+	}
+
+	ShaderStorageBuffer::~ShaderStorageBuffer()
+	{
+		if (m_id != 0) {
+			glDeleteBuffers(1, &m_id);
+		}
+		GpuMemory::remove_allocation(m_gpu_memory);
+	}
+
+	ShaderStorageBuffer::ShaderStorageBuffer(ShaderStorageBuffer&& buffer) noexcept
+		: m_id(buffer.m_id)
+		, m_size(buffer.m_size)
+		, m_capacity(buffer.m_capacity)
+		, m_usage(buffer.m_usage)
+		, m_gpu_memory(buffer.m_gpu_memory)
+	{
+		buffer.m_id = 0;
+		buffer.m_size = 0;
+		buffer.m_capacity = 0;
+		buffer.m_gpu_memory = GpuMemory::s_invalid_handle;
+	}
+
+	ShaderStorageBuffer& ShaderStorageBuffer::operator=(ShaderStorageBuffer&& buffer) noexcept
+	{
+		if (this != &buffer) {
+			glDeleteBuffers(1, &m_id);
+			GpuMemory::remove_allocation(m_gpu_memory);
+
+			m_id = buffer.m_id;
+			m_size = buffer.m_size;
+			m_capacity = buffer.m_capacity;
+			m_usage = buffer.m_usage;
+			m_gpu_memory = buffer.m_gpu_memory;
+
+			buffer.m_id = 0;
+			buffer.m_size = 0;
+			buffer.m_capacity = 0;
+			buffer.m_gpu_memory = GpuMemory::s_invalid_handle;
+		}
+		return *this;
+	}
+
+	void ShaderStorageBuffer::set_data(const void* data, const size_t size)
+	{
+		bind();
+		if (size > m_capacity) {
+			m_capacity = std::max(size, m_capacity * 2);
+			GpuMemory::resize_allocation(m_gpu_memory, m_capacity);
+		}
+		// orphaning: driver gives new memory instead of waiting for draws which use old content
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_capacity, nullptr, usage_to_GLenum2(m_usage));
+		if (data != nullptr && size > 0) {
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+		}
+		m_size = size;
+	}
+
+	void ShaderStorageBuffer::bind() const
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_id);
+	}
+
+	void ShaderStorageBuffer::unbind()
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	void ShaderStorageBuffer::bind_base(const unsigned int binding) const
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_id);
+	}
+
+	void ShaderStorageBuffer::bind_as_draw_indirect() const
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_id);
+	}
+
+	void ShaderStorageBuffer::unbind_draw_indirect()
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	void ShaderStorageBuffer::bind_as_parameter() const
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER, m_id);
+	}
+
+	void ShaderStorageBuffer::unbind_parameter()
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	}
+
+	void ShaderStorageBuffer::clear()
+	{
+		// capacity is always a multiple of 4 bytes
+		bind();
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	}
+
+	void ShaderStorageBuffer::copy_to(ShaderStorageBuffer& destination, const size_t size) const
+	{
+		if (size > destination.m_capacity) {
+			LOG_ERROR_TO(Render, "ShaderStorageBuffer copy of {0} bytes doesn't fit into {1}", size, destination.m_capacity);
+			return;
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, m_id);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, destination.m_id);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		destination.m_size = std::max(destination.m_size, size);
+	}
+
+	void ShaderStorageBuffer::read(void* data, const size_t size) const
+	{
+		bind();
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, std::min(size, m_capacity), data);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+	// buffer which shaders read (and write) as `layout(std430, binding = N) buffer`
+	class ShaderStorageBuffer {
+	public:
+		ShaderStorageBuffer(const void* data, const size_t size, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Dynamic);
+		~ShaderStorageBuffer();
+
+		ShaderStorageBuffer(const ShaderStorageBuffer&) = delete;
+		ShaderStorageBuffer& operator=(const ShaderStorageBuffer&) = delete;
+
+		ShaderStorageBuffer(ShaderStorageBuffer&& buffer) noexcept;
+		ShaderStorageBuffer& operator=(ShaderStorageBuffer&& buffer) noexcept;
+
+		// replaces whole content, storage is orphaned so GPU can still read previous frame data
+		// grows when data doesn't fit and never shrinks
+		void set_data(const void* data, const size_t size);
+
+		void bind() const;
+		static void unbind();
+		// makes buffer visible to shaders at binding point
+		void bind_base(const unsigned int binding) const;
+		// source of indirect draw commands written by compute shader
+		void bind_as_draw_indirect() const;
+		static void unbind_draw_indirect();
+		// source of draw count for multi_draw_indirect_count
+		void bind_as_parameter() const;
+		static void unbind_parameter();
+
+		// fills whole capacity with zeros on GPU, size stays
+		void clear();
+		// GPU side copy of first size bytes, destination has to be big enough
+		void copy_to(ShaderStorageBuffer& destination, const size_t size) const;
+		// reads back first size bytes, stalls until GPU wrote them
+		void read(void* data, const size_t size) const;
+
+		size_t get_size() const { return m_size; }
+		size_t get_capacity() const { return m_capacity; }
+
+	private:
+		unsigned int m_id = 0;
+		size_t m_size = 0;
+		size_t m_capacity = 0;
+		VertexBuffer::EUsage m_usage;
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
+	};
+}
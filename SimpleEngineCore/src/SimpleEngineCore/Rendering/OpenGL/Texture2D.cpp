@@ -1,24 +1,72 @@
 #include "Texture2D.h"
 
 #include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/Assets/AssetManager.h"
+#include "SimpleEngineCore/Assets/CookedFormats.h"
 
 #include <algorithm>
 #include <cmath>
 #include <glad/glad.h>
 
 namespace SimpleEngine {
+	namespace {
+		// 1x1 grey, bound instead of texture which is not resident, lives as long as the context
+		unsigned int get_fallback_texture()
+		{
+			static unsigned int s_fallback = 0;
+			if (s_fallback == 0) {
+				const unsigned char pixel[4] = { 128, 128, 128, 255 };
+				glCreateTextures(GL_TEXTURE_2D, 1, &s_fallback);
+				glTextureStorage2D(s_fallback, 1, GL_RGBA8, 1, 1);
+				glTextureSubImage2D(s_fallback, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+			}
+			return s_fallback;
+		}
+	}
+
 	Texture2D::Texture2D(const std::string& fileLocation, const int w, const int h)
 		: m_width(w)
 		, m_height(h)
+		, fileLocation(fileLocation)
+	{
+		if (!upload()) {
+			this->fileLocation.clear();
+			return;
+		}
+		m_residency = GpuMemory::add_evictable(this);
+	}
+
+	Texture2D::Texture2D(const std::string& fileLocation, const unsigned char* pixels, const int w, const int h)
+		: m_width(w)
+		, m_height(h)
+		, nrChannels(4)
+		, fileLocation(fileLocation)
 	{
-		unsigned char* texData = stbi_load(
-			fileLocation.c_str(), &m_width, &m_height, &nrChannels, 0);
+		upload(pixels);
+		m_residency = GpuMemory::add_evictable(this);
+	}
+
+	bool Texture2D::upload()
+	{
+		FileData file;
+		unsigned char* texData = nullptr;
+		if (FileSystem::read(fileLocation, file)) {
+			texData = load_texture_pixels(file.data(), file.size(), m_width, m_height);
+			nrChannels = 4;
+		}
 		if (!texData)
 		{
-			LOG_ERROR("Failed to find: {0}", fileLocation);
-			return;
+			LOG_ERROR_TO(Assets, "Failed to find: {0}", fileLocation);
+			return false;
 		}
+		upload(texData);
+		free_texture_pixels(texData);
+		return true;
+	}
 
+	void Texture2D::upload(const unsigned char* texData)
+	{
 		const GLsizei mip_levels = static_cast<GLsizei>(floor(log2(std::max(m_width, m_height)))) + 1;
 
 		// TODO update to use texture units load 2 texture 
@@ -85,35 +133,113 @@ namespace SimpleEngine {
 			glGenerateTextureMipmap(m_id);
 		}
 
-		stbi_image_free(texData);
+		// RGBA8 with full mip chain
+		size_t bytes = 0;
+		for (GLsizei level = 0; level < mip_levels; ++level) {
+			bytes += static_cast<size_t>(std::max(m_width >> level, 1)) * std::max(m_height >> level, 1) * 4;
+		}
+		m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::Textures, bytes);
 	}
 
-	Texture2D::~Texture2D()
+	void Texture2D::destroy()
 	{
 		// clear memory (how many, handle)
 		glDeleteTextures(1, &m_id);
+		m_id = 0;
+		GpuMemory::remove_allocation(m_gpu_memory);
+	}
+
+	Texture2D::~Texture2D()
+	{
+		destroy();
+		GpuMemory::remove_evictable(m_residency);
+		if (m_reload) {
+			m_reload->texture = nullptr;
+		}
 	}
 
 	Texture2D& Texture2D::operator=(Texture2D&& texture) noexcept
 	{
-		glDeleteTextures(1, &m_id);
-		m_id = texture.m_id;
-		m_width = texture.m_width;
-		m_height = texture.m_height;
-		texture.m_id = 0;
+		if (this != &texture) {
+			destroy();
+			GpuMemory::remove_evictable(m_residency);
+			if (m_reload) {
+				m_reload->texture = nullptr;
+			}
+			m_id = texture.m_id;
+			m_width = texture.m_width;
+			m_height = texture.m_height;
+			nrChannels = texture.nrChannels;
+			fileLocation = std::move(texture.fileLocation);
+			m_gpu_memory = texture.m_gpu_memory;
+			m_residency = texture.m_residency;
+			GpuMemory::move_evictable(m_residency, this);
+			m_reload = std::move(texture.m_reload);
+			if (m_reload) {
+				m_reload->texture = this;
+			}
+			texture.m_id = 0;
+			texture.m_gpu_memory = GpuMemory::s_invalid_handle;
+			texture.m_residency = GpuMemory::s_invalid_handle;
+		}
 		return *this;
 	}
 
 	Texture2D::Texture2D(Texture2D&& texture) noexcept
+		: m_id(texture.m_id)
+		, m_width(texture.m_width)
+		, m_height(texture.m_height)
+		, nrChannels(texture.nrChannels)
+		, fileLocation(std::move(texture.fileLocation))
+		, m_gpu_memory(texture.m_gpu_memory)
+		, m_residency(texture.m_residency)
+		, m_reload(std::move(texture.m_reload))
 	{
-		m_id = texture.m_id;
-		m_width = texture.m_width;
-		m_height = texture.m_height;
+		GpuMemory::move_evictable(m_residency, this);
+		if (m_reload) {
+			m_reload->texture = this;
+		}
 		texture.m_id = 0;
+		texture.m_gpu_memory = GpuMemory::s_invalid_handle;
+		texture.m_residency = GpuMemory::s_invalid_handle;
+	}
+
+	void Texture2D::evict()
+	{
+		destroy();
+	}
+
+	void Texture2D::finish_reload(const unsigned char* pixels, const int w, const int h)
+	{
+		m_reload = nullptr;
+		if (m_id != 0) {
+			return;
+		}
+		if (!pixels) {
+			// file is gone, fallback stays
+			fileLocation.clear();
+			return;
+		}
+		m_width = w;
+		m_height = h;
+		GpuMemoryScope gpu_memory_owner(GpuMemory::get_evictable_owner(m_residency));
+		upload(pixels);
+		GpuMemory::mark_used(m_residency);
 	}
 
-	void Texture2D::bind(const unsigned int unit) const
+	void Texture2D::bind(const unsigned int unit)
 	{
+		// evicted under GPU memory budget, frame doesn't wait for the file, fallback is drawn until it is uploaded
+		if (m_id == 0) {
+			if (!fileLocation.empty() && !m_reload) {
+				m_reload = std::make_shared<TextureReload>();
+				m_reload->texture = this;
+				AssetManager::reload_texture(m_reload, fileLocation);
+			}
+			glBindTextureUnit(unit, get_fallback_texture());
+			return;
+		}
+		GpuMemory::mark_used(m_residency);
 		// use texture
 		// is newer function introduced in OpenGL 4.5
 		// that binds a texture to a specific texture unit directly in one step, 
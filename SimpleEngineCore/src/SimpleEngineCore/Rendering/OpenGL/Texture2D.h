@@ -1,27 +1,51 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "stb_image.h"
+#include "GpuMemory.h"
 
 namespace SimpleEngine {
 
-	class Texture2D {
+	class Texture2D;
+
+	// reload of evicted texture in flight, texture is nullptr when it was destroyed meanwhile
+	// moved texture points it to the new place, only the thread with OpenGL context touches it
+	struct TextureReload {
+		Texture2D* texture = nullptr;
+	};
+
+	// evicted texture is read and decoded again by AssetManager when it's bound
+	// and uploaded within upload budget, fallback texture is bound until then
+	class Texture2D : public GpuEvictable {
 	public:
 		Texture2D(const std::string& fileLocation, const int w, const int h);
+		// RGBA8 pixels decoded somewhere else, file is read only to upload it again after eviction
+		Texture2D(const std::string& fileLocation, const unsigned char* pixels, const int w, const int h);
 		~Texture2D();
 		Texture2D(const Texture2D&) = delete;
 		Texture2D& operator=(const Texture2D&) = delete;
 		Texture2D& operator=(Texture2D&& texture) noexcept;
 		Texture2D(Texture2D&& texture) noexcept;
-		void bind(const unsigned int unit) const;
+		void bind(const unsigned int unit);
+		void evict() override;
+		// AssetManager upload of reloaded file, pixels are nullptr when it failed
+		void finish_reload(const unsigned char* pixels, const int w, const int h);
 	private:
+		bool upload();
+		void upload(const unsigned char* pixels);
+		void destroy();
+
 		unsigned int m_id = 0;
 		int m_width = 0;
 		int m_height = 0;
-		int nrChannels = 0; // rgba
+		int nrChannels = 0; // of file, pixels are always rgba
 
-		char* fileLocation;
+		std::string fileLocation;	// empty when file failed to load, nothing to evict then
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
+		GpuMemory::Handle m_residency = GpuMemory::s_invalid_handle;
+		std::shared_ptr<TextureReload> m_reload;	// while reload is queued
 	};
 
 }
\ No newline at end of file
@@ -3,7 +3,8 @@
 #include <glad/glad.h>
 
 namespace SimpleEngine {
-	VertexArray::VertexArray()
+	VertexArray::VertexArray() :
+		m_index_type(GL_UNSIGNED_INT)
 	{
 		glGenVertexArrays(1, &m_id);
 	}
@@ -23,6 +24,7 @@ namespace SimpleEngine {
 			m_id = vertex_array.m_id;
 			m_elements_count = vertex_array.m_elements_count;
 			m_indices_count = vertex_array.m_indices_count;
+			m_index_type = vertex_array.m_index_type;
 
 			vertex_array.m_id = 0;
 			vertex_array.m_elements_count = 0;
@@ -32,10 +34,12 @@ namespace SimpleEngine {
 	}
 
 	VertexArray::VertexArray(VertexArray&& vertex_array) noexcept :
-		m_id(vertex_array.m_id), m_elements_count(vertex_array.m_elements_count)
+		m_id(vertex_array.m_id), m_elements_count(vertex_array.m_elements_count),
+		m_indices_count(vertex_array.m_indices_count), m_index_type(vertex_array.m_index_type)
 	{
 		vertex_array.m_id = 0;
 		vertex_array.m_elements_count = 0;
+		vertex_array.m_indices_count = 0;
 	}
 
 	// We have to BIND data from buffers with our shaders
@@ -56,7 +60,7 @@ namespace SimpleEngine {
 				m_elements_count, // location
 				static_cast<GLint>(current_el.components_count), // number of components in Float or FLOAT2
 				current_el.component_type, // Float or INT or ...
-				GL_FALSE, // do we have to normalize? 
+				current_el.normalized ? GL_TRUE : GL_FALSE, // do we have to normalize? (compressed formats do)
 				static_cast<GLsizei>(vertex_buffer.get_layout().get_stride()), // stride 
 				reinterpret_cast<const void*>(current_el.offset) // shift 
 			);
@@ -64,11 +68,36 @@ namespace SimpleEngine {
 		}
 	}
 
+	void VertexArray::add_instance_buffer(const VertexBuffer& vertex_buffer)
+	{
+		bind();
+		vertex_buffer.bind();
+
+		const GLsizei stride = static_cast<GLsizei>(vertex_buffer.get_layout().get_stride());
+		for (const BufferElement& current_el : vertex_buffer.get_layout().get_elements()) {
+			glEnableVertexAttribArray(m_elements_count);
+			const bool is_integer = !current_el.normalized &&
+				(current_el.component_type == GL_INT || current_el.component_type == GL_UNSIGNED_INT);
+			if (is_integer) {
+				glVertexAttribIPointer(m_elements_count, static_cast<GLint>(current_el.components_count),
+					current_el.component_type, stride, reinterpret_cast<const void*>(current_el.offset));
+			}
+			else {
+				glVertexAttribPointer(m_elements_count, static_cast<GLint>(current_el.components_count),
+					current_el.component_type, current_el.normalized ? GL_TRUE : GL_FALSE, stride,
+					reinterpret_cast<const void*>(current_el.offset));
+			}
+			glVertexAttribDivisor(m_elements_count, 1);
+			++m_elements_count;
+		}
+	}
+
 	void VertexArray::set_index_buffer(const IndexBuffer& index_buffer) {
 		// again have to make our vbo for points first active since currently for colors is active
 		bind();
 		index_buffer.bind();
 		m_indices_count = index_buffer.get_count();
+		m_index_type = index_buffer.get_gl_type();
 	}
 
 	void VertexArray::bind() const
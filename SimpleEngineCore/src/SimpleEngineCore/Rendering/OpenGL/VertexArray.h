@@ -16,15 +16,19 @@ namespace SimpleEngine {
 		VertexArray(VertexArray&& vertex_array) noexcept;
 
 		void add_vertex_buffer(const VertexBuffer& vertex_buffer);
+		// attributes advance once per instance, integer types stay integers in shader (`in int`)
+		void add_instance_buffer(const VertexBuffer& vertex_buffer);
 		void set_index_buffer(const IndexBuffer& index_buffer);
 		void bind() const;
 		static void unbind();
 		size_t get_indices_count() const { return m_indices_count; }
+		unsigned int get_index_type() const { return m_index_type; } // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
 
 	private:
 		unsigned int m_id = 0;
 		unsigned int m_elements_count = 0; // amount of vertex attrib pointers we are calling
 		size_t m_indices_count = 0;
+		unsigned int m_index_type;
 	};
 
 }
\ No newline at end of file
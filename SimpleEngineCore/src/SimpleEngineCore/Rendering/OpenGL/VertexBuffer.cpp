@@ -13,15 +13,24 @@ namespace SimpleEngine {
 			return 1;
 		case ShaderDataType::Float2:
 		case ShaderDataType::Int2:
+		case ShaderDataType::Half2:
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::UShort2Norm:
 			return 2;
 		case ShaderDataType::Float3:
 		case ShaderDataType::Int3:
 			return 3;
 		case ShaderDataType::Float4:
 		case ShaderDataType::Int4:
+		case ShaderDataType::Half4:
+		case ShaderDataType::Byte4Norm:
+		case ShaderDataType::UByte4Norm:
+		case ShaderDataType::Short4Norm:
+		case ShaderDataType::UShort4Norm:
+		case ShaderDataType::Int2_10_10_10_Norm: // 4 components in a single int
 			return 4;
 		}
-		LOG_ERROR("shader data type to components type: unknown shader type!");
+		LOG_ERROR_TO(Render, "shader data type to components type: unknown shader type!");
 		return 0;
 	}
 
@@ -37,8 +46,21 @@ namespace SimpleEngine {
 		case ShaderDataType::Int3:
 		case ShaderDataType::Int4:
 			return sizeof(GLint) * shader_data_type_to_components_count(type);
+		case ShaderDataType::Half2:
+		case ShaderDataType::Half4:
+			return sizeof(GLhalf) * shader_data_type_to_components_count(type);
+		case ShaderDataType::Byte4Norm:
+		case ShaderDataType::UByte4Norm:
+			return sizeof(GLbyte) * shader_data_type_to_components_count(type);
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::Short4Norm:
+		case ShaderDataType::UShort2Norm:
+		case ShaderDataType::UShort4Norm:
+			return sizeof(GLshort) * shader_data_type_to_components_count(type);
+		case ShaderDataType::Int2_10_10_10_Norm:
+			return sizeof(GLuint);
 		}
-		LOG_ERROR("shader data type size: unknown shader type!");
+		LOG_ERROR_TO(Render, "shader data type size: unknown shader type!");
 		return 0;
 	}
 
@@ -54,11 +76,41 @@ namespace SimpleEngine {
 		case ShaderDataType::Int3:
 		case ShaderDataType::Int4:
 			return GL_INT;
+		case ShaderDataType::Half2:
+		case ShaderDataType::Half4:
+			return GL_HALF_FLOAT;
+		case ShaderDataType::Byte4Norm:
+			return GL_BYTE;
+		case ShaderDataType::UByte4Norm:
+			return GL_UNSIGNED_BYTE;
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::Short4Norm:
+			return GL_SHORT;
+		case ShaderDataType::UShort2Norm:
+		case ShaderDataType::UShort4Norm:
+			return GL_UNSIGNED_SHORT;
+		case ShaderDataType::Int2_10_10_10_Norm:
+			return GL_INT_2_10_10_10_REV;
 		}
-		LOG_ERROR("shader_data_type_to_component_type: unknown shader type!");
+		LOG_ERROR_TO(Render, "shader_data_type_to_component_type: unknown shader type!");
 		return GL_FLOAT;
 	}
 
+	constexpr bool shader_data_type_is_normalized(const ShaderDataType type) {
+		switch (type) {
+		case ShaderDataType::Byte4Norm:
+		case ShaderDataType::UByte4Norm:
+		case ShaderDataType::Short2Norm:
+		case ShaderDataType::Short4Norm:
+		case ShaderDataType::UShort2Norm:
+		case ShaderDataType::UShort4Norm:
+		case ShaderDataType::Int2_10_10_10_Norm:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	constexpr GLenum usage_to_GLenum(const VertexBuffer::EUsage usage) {
 		switch (usage)
 		{
@@ -67,7 +119,7 @@ namespace SimpleEngine {
 		case VertexBuffer::EUsage::Stream: return GL_STREAM_DRAW;
 		}
 
-		LOG_ERROR("Unknown VertexBuffer usage");
+		LOG_ERROR_TO(Render, "Unknown VertexBuffer usage");
 		return GL_STREAM_DRAW;
 	}
 
@@ -83,22 +135,32 @@ namespace SimpleEngine {
 		// fill buffer by transfering data from cpu to gpu memory
 		// static means data in buffer do not change
 		glBufferData(GL_ARRAY_BUFFER, size, data, usage_to_GLenum(usage));
-
+		m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::VertexBuffers, size);
 	}
 	VertexBuffer::~VertexBuffer() {
 		glDeleteBuffers(1, &m_id);
+		GpuMemory::remove_allocation(m_gpu_memory);
 	}
 
 
 	VertexBuffer::VertexBuffer(VertexBuffer&& vertexBuffer) noexcept :
-		m_id(vertexBuffer.m_id), m_buffer_layout(std::move(vertexBuffer.m_buffer_layout))
+		m_id(vertexBuffer.m_id), m_buffer_layout(std::move(vertexBuffer.m_buffer_layout)),
+		m_gpu_memory(vertexBuffer.m_gpu_memory)
 	{
 		vertexBuffer.m_id = 0;
+		vertexBuffer.m_gpu_memory = GpuMemory::s_invalid_handle;
 	}
 
 	VertexBuffer& VertexBuffer::operator= (VertexBuffer&& vertexBuffer) noexcept {
-		m_id = vertexBuffer.m_id;
-		vertexBuffer.m_id = 0;
+		if (this != &vertexBuffer) {
+			glDeleteBuffers(1, &m_id);
+			GpuMemory::remove_allocation(m_gpu_memory);
+			m_id = vertexBuffer.m_id;
+			m_buffer_layout = std::move(vertexBuffer.m_buffer_layout);
+			m_gpu_memory = vertexBuffer.m_gpu_memory;
+			vertexBuffer.m_id = 0;
+			vertexBuffer.m_gpu_memory = GpuMemory::s_invalid_handle;
+		}
 		return *this;
 	}
 
@@ -117,6 +179,7 @@ namespace SimpleEngine {
 		, component_type(shader_data_type_to_component_type(type))
 		, size(shader_data_type_size(type))
 		, offset(0)
+		, normalized(shader_data_type_is_normalized(type))
 	{
 	}
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once 
 
+#include "GpuMemory.h"
+
 #include <vector>
 
 namespace SimpleEngine {
@@ -13,7 +15,17 @@ namespace SimpleEngine {
 		Int,
 		Int2,
 		Int3,
-		Int4
+		Int4,
+		// compressed formats
+		Half2,			// 2 x 16 bit float
+		Half4,			// 4 x 16 bit float
+		Byte4Norm,		// 4 x int8 mapped to [-1, 1]
+		UByte4Norm,		// 4 x uint8 mapped to [0, 1]
+		Short2Norm,		// 2 x int16 mapped to [-1, 1] (octahedral normals)
+		Short4Norm,		// 4 x int16 mapped to [-1, 1]
+		UShort2Norm,	// 2 x uint16 mapped to [0, 1]
+		UShort4Norm,	// 4 x uint16 mapped to [0, 1] (quantized positions)
+		Int2_10_10_10_Norm // xyz 10 bit + w 2 bit packed into one 32 bit value
 	};
 
 	struct BufferElement
@@ -23,6 +35,7 @@ namespace SimpleEngine {
 		size_t components_count; // Float2 -> 2 components 
 		size_t size;			 // size in bytes 
 		size_t offset; 
+		bool normalized;		 // integer data is mapped to [0, 1] or [-1, 1] by gpu
 		// ( )       . 
 		//    , 
 		//         .
@@ -84,5 +97,6 @@ namespace SimpleEngine {
 	private:
 		unsigned int m_id = 0;
 		BufferLayout m_buffer_layout;
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "VertexPacking.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	glm::mat4 VertexQuantization::get_dequantization_matrix() const
+	{
+		// column major: scale on diagonal and offset in last column
+		return glm::mat4(
+			bounds_extent.x, 0, 0, 0,
+			0, bounds_extent.y, 0, 0,
+			0, 0, bounds_extent.z, 0,
+			bounds_min.x, bounds_min.y, bounds_min.z, 1);
+	}
+
+	uint16_t float_to_half(const float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const uint32_t sign = (bits >> 16) & 0x8000u;
+		const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFFu;
+
+		// NaN and Inf
+		if (((bits >> 23) & 0xFFu) == 0xFFu) {
+			return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+		}
+		// too big for half -> Inf
+		if (exponent >= 0x1F) {
+			return static_cast<uint16_t>(sign | 0x7C00u);
+		}
+		// too small -> denormal or zero
+		if (exponent <= 0) {
+			if (exponent < -10) {
+				return static_cast<uint16_t>(sign);
+			}
+			mantissa |= 0x800000u;
+			const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+			uint32_t half_mantissa = mantissa >> shift;
+			// round to nearest even
+			const uint32_t rest = mantissa & ((1u << shift) - 1u);
+			const uint32_t halfway = 1u << (shift - 1u);
+			if (rest > halfway || (rest == halfway && (half_mantissa & 1u))) {
+				++half_mantissa;
+			}
+			return static_cast<uint16_t>(sign | half_mantissa);
+		}
+
+		uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+		// round to nearest even, carry into exponent is fine
+		const uint32_t rest = mantissa & 0x1FFFu;
+		if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+			++half;
+		}
+		return static_cast<uint16_t>(half);
+	}
+
+	float half_to_float(const uint16_t value)
+	{
+		const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+		uint32_t exponent = (value >> 10) & 0x1Fu;
+		uint32_t mantissa = value & 0x3FFu;
+
+		uint32_t bits;
+		if (exponent == 0x1Fu) {
+			bits = sign | 0x7F800000u | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) {
+			// denormal -> normalize it
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400u) == 0) {
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+		}
+		else {
+			bits = sign;
+		}
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	static float sign_not_zero(const float v) {
+		return v >= 0.f ? 1.f : -1.f;
+	}
+
+	glm::vec2 oct_encode(const glm::vec3& normal)
+	{
+		const float l1_norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (l1_norm == 0.f) {
+			return glm::vec2(0.f);
+		}
+		glm::vec2 p(normal.x / l1_norm, normal.y / l1_norm);
+		// lower hemisphere is folded over the diagonals
+		if (normal.z < 0.f) {
+			p = glm::vec2(
+				(1.f - std::abs(p.y)) * sign_not_zero(p.x),
+				(1.f - std::abs(p.x)) * sign_not_zero(p.y));
+		}
+		return p;
+	}
+
+	glm::vec3 oct_decode(const glm::vec2& encoded)
+	{
+		glm::vec3 n(encoded.x, encoded.y, 1.f - std::abs(encoded.x) - std::abs(encoded.y));
+		if (n.z < 0.f) {
+			const float x = n.x;
+			n.x = (1.f - std::abs(n.y)) * sign_not_zero(x);
+			n.y = (1.f - std::abs(x)) * sign_not_zero(n.y);
+		}
+		return glm::normalize(n);
+	}
+
+	static uint16_t to_unorm16(const float v) {
+		return static_cast<uint16_t>(std::lround(std::clamp(v, 0.f, 1.f) * 65535.f));
+	}
+
+	static int16_t to_snorm16(const float v) {
+		return static_cast<int16_t>(std::lround(std::clamp(v, -1.f, 1.f) * 32767.f));
+	}
+
+	VertexQuantization compute_vertex_quantization(const std::vector<Vertex>& vertices, const EPositionFormat position_format)
+	{
+		VertexQuantization quantization;
+		quantization.position_format = position_format;
+		if (vertices.empty()) {
+			return quantization;
+		}
+
+		glm::vec3 min_pos = vertices[0].Position;
+		glm::vec3 max_pos = vertices[0].Position;
+		for (const Vertex& v : vertices) {
+			min_pos = glm::min(min_pos, v.Position);
+			max_pos = glm::max(max_pos, v.Position);
+		}
+
+		if (position_format == EPositionFormat::UNorm16) {
+			quantization.bounds_min = min_pos;
+			quantization.bounds_extent = max_pos - min_pos;
+			// flat meshes (plane) - avoid division by zero, any value works
+			for (int i = 0; i < 3; ++i) {
+				if (quantization.bounds_extent[i] <= 0.f) {
+					quantization.bounds_extent[i] = 1.f;
+				}
+			}
+		}
+		else {
+			// half keeps more precision close to zero so we center the mesh
+			quantization.bounds_min = (min_pos + max_pos) * 0.5f;
+			quantization.bounds_extent = glm::vec3(1.f);
+		}
+		return quantization;
+	}
+
+	std::vector<PackedVertex> pack_vertices(const std::vector<Vertex>& vertices, const VertexQuantization& quantization)
+	{
+		std::vector<PackedVertex> packed(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			const Vertex& v = vertices[i];
+			PackedVertex& p = packed[i];
+
+			const glm::vec3 local = (v.Position - quantization.bounds_min) / quantization.bounds_extent;
+			for (int c = 0; c < 3; ++c) {
+				p.Position[c] = quantization.position_format == EPositionFormat::UNorm16
+					? to_unorm16(local[c])
+					: float_to_half(local[c]);
+			}
+			p.Position[3] = quantization.position_format == EPositionFormat::UNorm16
+				? to_unorm16(1.f)
+				: float_to_half(1.f);
+
+			const glm::vec2 oct = oct_encode(v.Normal);
+			p.Normal[0] = to_snorm16(oct.x);
+			p.Normal[1] = to_snorm16(oct.y);
+
+			p.TexCoords[0] = float_to_half(v.TexCoords.x);
+			p.TexCoords[1] = float_to_half(v.TexCoords.y);
+		}
+		return packed;
+	}
+
+	BufferLayout get_packed_vertex_layout(const EPositionFormat position_format)
+	{
+		return BufferLayout{
+			position_format == EPositionFormat::UNorm16 ? ShaderDataType::UShort4Norm : ShaderDataType::Half4,
+			ShaderDataType::Short2Norm,
+			ShaderDataType::Half2
+		};
+	}
+}
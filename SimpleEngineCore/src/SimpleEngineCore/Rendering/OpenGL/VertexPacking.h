@@ -0,0 +1,59 @@
+#pragma once
+
+#include "VertexBuffer.h"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// full precision vertex, what we get from loader (32 bytes)
+	struct Vertex {
+		glm::vec3 Position;
+		glm::vec3 Normal;
+		glm::vec2 TexCoords;
+	};
+
+	// compressed vertex which goes to gpu (16 bytes)
+	// position - quantized relative to mesh bounds (unorm16) or half relative to bounds center
+	// normal   - octahedral encoding in 2 x snorm16
+	// uv       - 2 x half (uv could be outside of [0, 1] so we can't use unorm here)
+	struct PackedVertex {
+		uint16_t Position[4]; // w is padding to keep 8 bytes alignment
+		int16_t Normal[2];
+		uint16_t TexCoords[2];
+	};
+	static_assert(sizeof(PackedVertex) == 16, "PackedVertex has to be 16 bytes");
+
+	enum class EPositionFormat {
+		UNorm16, // 16 bit normalized inside of bounds, uniform precision over the whole mesh
+		Half     // 16 bit float relative to center, better precision near the center
+	};
+
+	// what we need to restore position in the shader: pos = bounds_min + packed * bounds_extent
+	// it is affine so it can be folded into model matrix and vertex shader stays the same
+	struct VertexQuantization {
+		EPositionFormat position_format = EPositionFormat::UNorm16;
+		glm::vec3 bounds_min{ 0.f };
+		glm::vec3 bounds_extent{ 1.f };
+
+		glm::mat4 get_dequantization_matrix() const;
+	};
+
+	uint16_t float_to_half(const float value);
+	float half_to_float(const uint16_t value);
+
+	// maps unit vector to the square [-1, 1]^2 (octahedron unfolded on the plane)
+	glm::vec2 oct_encode(const glm::vec3& normal);
+	glm::vec3 oct_decode(const glm::vec2& encoded);
+
+	VertexQuantization compute_vertex_quantization(const std::vector<Vertex>& vertices, const EPositionFormat position_format = EPositionFormat::UNorm16);
+	std::vector<PackedVertex> pack_vertices(const std::vector<Vertex>& vertices, const VertexQuantization& quantization);
+
+	// Depends on struct PackedVertex
+	BufferLayout get_packed_vertex_layout(const EPositionFormat position_format);
+}
@@ -0,0 +1,118 @@
+#include "Primitives.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <iterator>
+
+namespace SimpleEngine {
+
+	namespace {
+		constexpr float s_cube_vertices[] = {
+			//    position             normal            UV                  index
+			// FRONT
+			-1.0f, -1.f, -1.f,    -1.f,  0.f,  0.f,     0.f, 0.f,              // 0
+			-1.0f,  1.f, -1.f,    -1.f,  0.f,  0.f,     1.f, 0.f,              // 1
+			-1.0f,  1.f,  1.f,    -1.f,  0.f,  0.f,     1.f, 1.f,              // 2
+			-1.0f, -1.f,  1.f,    -1.f,  0.f,  0.f,     0.f, 1.f,              // 3
+			// BACK                                  
+			 1.0f, -1.f, -1.f,     1.f,  0.f,  0.f,     1.f, 0.f,              // 4
+			 1.0f,  1.f, -1.f,     1.f,  0.f,  0.f,     0.f, 0.f,              // 5
+			 1.0f,  1.f,  1.f,     1.f,  0.f,  0.f,     0.f, 1.f,              // 6
+			 1.0f, -1.f,  1.f,     1.f,  0.f,  0.f,     1.f, 1.f,              // 7
+			 // RIGHT
+			 -1.0f,  1.f, -1.f,     0.f,  1.f,  0.f,     0.f, 0.f,              // 8
+			  1.0f,  1.f, -1.f,     0.f,  1.f,  0.f,     1.f, 0.f,              // 9
+			  1.0f,  1.f,  1.f,     0.f,  1.f,  0.f,     1.f, 1.f,              // 10
+			 -1.0f,  1.f,  1.f,     0.f,  1.f,  0.f,     0.f, 1.f,              // 11
+			 // LEFT
+			 -1.0f, -1.f, -1.f,     0.f, -1.f,  0.f,     1.f, 0.f,              // 12
+			  1.0f, -1.f, -1.f,     0.f, -1.f,  0.f,     0.f, 0.f,              // 13
+			  1.0f, -1.f,  1.f,     0.f, -1.f,  0.f,     0.f, 1.f,              // 14
+			 -1.0f, -1.f,  1.f,     0.f, -1.f,  0.f,     1.f, 1.f,              // 15
+			 // TOP
+			 -1.0f, -1.f,  1.f,     0.f,  0.f,  1.f,     0.f, 0.f,              // 16
+			 -1.0f,  1.f,  1.f,     0.f,  0.f,  1.f,     1.f, 0.f,              // 17
+			  1.0f,  1.f,  1.f,     0.f,  0.f,  1.f,     1.f, 1.f,              // 18
+			  1.0f, -1.f,  1.f,     0.f,  0.f,  1.f,     0.f, 1.f,              // 19
+			  // BOTTOM
+			  -1.0f, -1.f, -1.f,    0.f,  0.f, -1.f,     0.f, 1.f,              // 20
+			  -1.0f,  1.f, -1.f,    0.f,  0.f, -1.f,     1.f, 1.f,              // 21
+			   1.0f,  1.f, -1.f,    0.f,  0.f, -1.f,     1.f, 0.f,              // 22
+			   1.0f, -1.f, -1.f,    0.f,  0.f, -1.f,     0.f, 0.f,              // 23
+		};
+
+		constexpr uint32_t s_cube_indices[] = {
+			0,   1,  2,  2,  3,  0, // front
+			4,   5,  6,  6,  7,  4, // back
+			8,   9, 10, 10, 11,  8, // right
+			12, 13, 14, 14, 15, 12, // left
+			16, 17, 18, 18, 19, 16, // top
+			20, 21, 22, 22, 23, 20  // bottom
+		};
+
+		constexpr uint32_t s_sphere_rings = 16;
+		constexpr uint32_t s_sphere_segments = 32;
+
+		void generate_sphere(std::vector<float>& vertices, std::vector<uint32_t>& indices)
+		{
+			// seam and poles have duplicated vertices, uvs don't wrap
+			vertices.reserve((s_sphere_rings + 1) * (s_sphere_segments + 1) * 8);
+			for (uint32_t ring = 0; ring <= s_sphere_rings; ++ring) {
+				const float v = static_cast<float>(ring) / s_sphere_rings;
+				const float theta = v * glm::pi<float>();
+				for (uint32_t segment = 0; segment <= s_sphere_segments; ++segment) {
+					const float u = static_cast<float>(segment) / s_sphere_segments;
+					const float phi = u * glm::two_pi<float>();
+					const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+					vertices.insert(vertices.end(), { normal.x, normal.y, normal.z, normal.x, normal.y, normal.z, u, v });
+				}
+			}
+			indices.reserve(s_sphere_rings * s_sphere_segments * 6);
+			for (uint32_t ring = 0; ring < s_sphere_rings; ++ring) {
+				for (uint32_t segment = 0; segment < s_sphere_segments; ++segment) {
+					const uint32_t a = ring * (s_sphere_segments + 1) + segment;
+					const uint32_t b = a + s_sphere_segments + 1;
+					indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+				}
+			}
+		}
+	}
+
+	void generate_primitive(const Primitive primitive, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+		switch (primitive) {
+		case Primitive::Cube:
+			vertices.assign(std::begin(s_cube_vertices), std::end(s_cube_vertices));
+			indices.assign(std::begin(s_cube_indices), std::end(s_cube_indices));
+			break;
+		case Primitive::Sphere:
+			generate_sphere(vertices, indices);
+			break;
+		case Primitive::Plane:
+			vertices = {
+				-1.f, -1.f, 0.f,    0.f, 0.f, 1.f,    0.f, 0.f,
+				 1.f, -1.f, 0.f,    0.f, 0.f, 1.f,    1.f, 0.f,
+				 1.f,  1.f, 0.f,    0.f, 0.f, 1.f,    1.f, 1.f,
+				-1.f,  1.f, 0.f,    0.f, 0.f, 1.f,    0.f, 1.f,
+			};
+			indices = { 0, 1, 2, 2, 3, 0 };
+			break;
+		default:
+			break;
+		}
+	}
+
+	const char* get_primitive_name(const Primitive primitive)
+	{
+		switch (primitive) {
+		case Primitive::Cube: return "Cube";
+		case Primitive::Sphere: return "Sphere";
+		case Primitive::Plane: return "Plane";
+		default: return "Unknown";
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// built-in shapes, each one is uploaded once and shared through AssetManager::get_primitive
+	enum class Primitive : uint8_t {
+		Cube,	// [-1, 1] box, 4 vertices per face so every face has its own normal and uvs
+		Sphere,	// radius 1, latitude and longitude rings
+		Plane,	// [-1, 1] square at z = 0 facing +z
+		Count
+	};
+
+	// 8 floats per vertex: position, normal, uv (layout of Mesh)
+	void generate_primitive(const Primitive primitive, std::vector<float>& vertices, std::vector<uint32_t>& indices);
+	const char* get_primitive_name(const Primitive primitive);
+}
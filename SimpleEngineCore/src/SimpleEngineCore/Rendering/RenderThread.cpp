@@ -0,0 +1,151 @@
+#include "RenderThread.h"
+
+#include "SimpleEngineCore/Window.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Log.h"
+
+namespace SimpleEngine {
+
+	namespace {
+		// spin first since next packet usually comes soon, then sleep to not burn a core
+		class Backoff {
+		public:
+			void wait() {
+				if (m_count < 64) {
+					std::this_thread::yield();
+				}
+				else {
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+				}
+				++m_count;
+			}
+			void reset() { m_count = 0; }
+		private:
+			uint32_t m_count = 0;
+		};
+
+		float get_ms(const FramePacket::Clock::duration duration) {
+			return std::chrono::duration<float, std::milli>(duration).count();
+		}
+	}
+
+	RenderThread::~RenderThread()
+	{
+		stop();
+	}
+
+	void RenderThread::start(Window& window, RenderFn&& render_fn, const bool threaded)
+	{
+		m_pWindow = &window;
+		m_render_fn = std::move(render_fn);
+		if (!threaded) {
+			return;
+		}
+
+		// context can be current only on one thread
+		m_pWindow->release_context();
+		m_running = true;
+		m_thread = std::thread([this]() { thread_loop(); });
+		// set before this thread can get to jobs which need OpenGL (uploads) without a context
+		JobSystem::set_gl_thread(m_thread.get_id());
+		LOG_INFO_TO(Render, "Render thread started");
+	}
+
+	void RenderThread::stop()
+	{
+		if (!m_thread.joinable()) {
+			return;
+		}
+		// render thread finishes submitted packets before exit
+		m_running = false;
+		m_thread.join();
+		m_pWindow->make_context_current();
+		JobSystem::set_gl_thread(std::this_thread::get_id());
+		LOG_INFO_TO(Render, "Render thread stopped");
+	}
+
+	FramePacket& RenderThread::begin_frame()
+	{
+		m_frame_begin_time = FramePacket::Clock::now();
+
+		Backoff backoff;
+		while ((m_pWritePacket = m_packets.try_begin_push()) == nullptr) {
+			backoff.wait();
+		}
+		m_pWritePacket->arena.reset();
+		m_pWritePacket->frame_index = m_frame_index++;
+		m_pWritePacket->input_time = m_frame_begin_time;
+		return *m_pWritePacket;
+	}
+
+	void RenderThread::submit_frame()
+	{
+		m_cpu_frame_ms.store(get_ms(FramePacket::Clock::now() - m_frame_begin_time), std::memory_order_relaxed);
+		m_packets.end_push();
+		m_pWritePacket = nullptr;
+
+		if (!is_threaded()) {
+			FramePacket* packet = m_packets.try_front();
+			render(*packet);
+			m_packets.pop();
+		}
+	}
+
+	RenderThread::Stats RenderThread::get_stats() const
+	{
+		Stats stats;
+		stats.cpu_frame_ms = m_cpu_frame_ms.load(std::memory_order_relaxed);
+		stats.render_ms = m_render_ms.load(std::memory_order_relaxed);
+		stats.latency_ms = m_latency_ms.load(std::memory_order_relaxed);
+		stats.swap_interval = m_applied_swap_interval.load(std::memory_order_relaxed);
+		stats.frames = m_rendered_frames.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void RenderThread::thread_loop()
+	{
+		m_pWindow->make_context_current();
+
+		Backoff backoff;
+		while (true) {
+			FramePacket* packet = m_packets.try_front();
+			if (!packet) {
+				if (!m_running.load(std::memory_order_acquire)) {
+					break;
+				}
+				backoff.wait();
+				continue;
+			}
+			render(*packet);
+			m_packets.pop();
+			backoff.reset();
+		}
+
+		m_pWindow->release_context();
+	}
+
+	void RenderThread::render(const FramePacket& packet)
+	{
+		const FramePacket::Clock::time_point render_begin = FramePacket::Clock::now();
+		m_presented_input_time = packet.has_input_event ? packet.input_event_time : FramePacket::Clock::time_point();
+		m_render_fn(packet);
+		if (packet.swap_interval != m_swap_interval) {
+			m_swap_interval = packet.swap_interval;
+			m_applied_swap_interval.store(m_pWindow->set_swap_interval(m_swap_interval), std::memory_order_relaxed);
+		}
+		m_pWindow->swap_buffers();
+
+		const FramePacket::Clock::time_point render_end = FramePacket::Clock::now();
+		m_render_ms.store(get_ms(render_end - render_begin), std::memory_order_relaxed);
+		m_latency_ms.store(get_ms(render_end - packet.input_time), std::memory_order_relaxed);
+		// end of swap is when frame is queued for display, scanout comes after it
+		if (m_presented_input_time != FramePacket::Clock::time_point()) {
+			m_input_latency.record(get_ms(render_end - m_presented_input_time));
+		}
+		if (m_last_swap_end != FramePacket::Clock::time_point()) {
+			m_frame_intervals.record(get_ms(render_end - m_last_swap_end));
+		}
+		m_last_swap_end = render_end;
+		m_rendered_frames.fetch_add(1, std::memory_order_relaxed);
+	}
+}
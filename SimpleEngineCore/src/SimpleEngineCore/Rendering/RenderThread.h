@@ -0,0 +1,82 @@
+#pragma once
+
+#include "FramePacket.h"
+#include "InputLatency.h"
+#include "SimpleEngineCore/Delegate.h"
+#include "SimpleEngineCore/Jobs/SpscRing.h"
+
+#include <atomic>
+#include <limits>
+#include <thread>
+
+namespace SimpleEngine {
+
+	class Window;
+
+	// owns OpenGL context and renders frame packets built by main thread
+	// two packets in flight: main thread simulates frame N+1 while frame N is submitted to GPU
+	class RenderThread {
+	public:
+		using RenderFn = Delegate<void(const FramePacket&)>;
+
+		struct Stats {
+			float cpu_frame_ms = 0.f;	// main thread: input, simulation and packet build
+			float render_ms = 0.f;		// render thread: submission and swap
+			float latency_ms = 0.f;		// input poll to end of swap
+			int swap_interval = 0;		// applied, differs from requested when adaptive vsync is not supported
+			uint64_t frames = 0;
+		};
+
+		RenderThread() = default;
+		~RenderThread();
+
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		// threaded = false renders inside of submit_frame on caller thread (same packets, no overlap)
+		void start(Window& window, RenderFn&& render_fn, const bool threaded);
+		void stop();
+		bool is_threaded() const { return m_thread.joinable(); }
+
+		// main thread: waits for free packet, it can be filled until submit_frame
+		FramePacket& begin_frame();
+		void submit_frame();
+
+		Stats get_stats() const;
+		const LatencyProbe& get_input_latency() const { return m_input_latency; }
+		// end of swap to end of the next swap, what is seen on the screen
+		const LatencyProbe& get_frame_intervals() const { return m_frame_intervals; }
+
+		// render thread, inside of render function: input event shown by this frame when camera was late-latched
+		void set_presented_input_time(const FramePacket::Clock::time_point input_time) { m_presented_input_time = input_time; }
+
+	private:
+		void thread_loop();
+		void render(const FramePacket& packet);
+
+		static constexpr size_t s_packets_count = FramePacket::s_frames_in_flight;
+
+		SpscRing<FramePacket, s_packets_count> m_packets;
+		FramePacket* m_pWritePacket = nullptr;
+		uint64_t m_frame_index = 0;
+		FramePacket::Clock::time_point m_frame_begin_time;
+
+		Window* m_pWindow = nullptr;
+		RenderFn m_render_fn;
+		std::thread m_thread;
+		std::atomic<bool> m_running{ false };
+
+		std::atomic<float> m_cpu_frame_ms{ 0.f };
+		std::atomic<float> m_render_ms{ 0.f };
+		std::atomic<float> m_latency_ms{ 0.f };
+		std::atomic<int> m_applied_swap_interval{ 0 };
+		std::atomic<uint64_t> m_rendered_frames{ 0 };
+
+		// render thread only
+		FramePacket::Clock::time_point m_presented_input_time;
+		LatencyProbe m_input_latency;
+		int m_swap_interval = std::numeric_limits<int>::min();	// requested by the last packet, nothing is set at start
+		FramePacket::Clock::time_point m_last_swap_end;
+		LatencyProbe m_frame_intervals;
+	};
+}
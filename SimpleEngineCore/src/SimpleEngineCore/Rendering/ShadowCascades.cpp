@@ -0,0 +1,92 @@
+#include "ShadowCascades.h"
+
+#include "SimpleEngineCore/Camera.h"
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimpleEngine {
+
+	namespace {
+		// view space point with given NDC x, y and view depth, works for perspective and orthographic projection
+		glm::vec3 unproject(const glm::mat4& projection, const float ndc_x, const float ndc_y, const float depth)
+		{
+			const float z = -depth;
+			const float w = projection[2][3] * z + projection[3][3];
+			return glm::vec3(
+				(ndc_x * w - projection[2][0] * z - projection[3][0]) / projection[0][0],
+				(ndc_y * w - projection[2][1] * z - projection[3][1]) / projection[1][1],
+				z);
+		}
+
+		float snap(const float value, const float step)
+		{
+			return std::floor(value / step + 0.5f) * step;
+		}
+	}
+
+	void ShadowCascades::build(const Camera& camera, const glm::vec3& light_direction, const ShadowSettings& settings, ShadowCascades& cascades)
+	{
+		cascades.count = std::min(settings.cascades_count, s_max_cascades);
+		if (cascades.count == 0 || glm::length(light_direction) == 0.f) {
+			cascades.count = 0;
+			return;
+		}
+
+		const float near = camera.get_near_clip_plane();
+		const float far = std::max(near * 1.01f, std::min(camera.get_far_clip_plane(), settings.max_distance));
+		const glm::mat4 projection = camera.get_projection_matrix();
+		const glm::mat4 inverse_view = glm::inverse(camera.get_view_matrix());
+
+		// light rotation doesn't depend on camera, only translation is snapped
+		const glm::vec3 direction = glm::normalize(light_direction);
+		const glm::vec3 up = std::abs(direction.z) < 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+		const glm::mat4 light_rotation = glm::lookAt(glm::vec3(0.f), direction, up);
+
+		float split_near = near;
+		for (uint32_t i = 0; i < cascades.count; ++i) {
+			// practical split scheme: blend of logarithmic and uniform split
+			const float part = static_cast<float>(i + 1) / cascades.count;
+			const float log_split = near * std::pow(far / near, part);
+			const float uniform_split = near + (far - near) * part;
+			const float split_far = settings.split_lambda * log_split + (1.f - settings.split_lambda) * uniform_split;
+
+			glm::vec3 corners[8];
+			glm::vec3 center(0.f);
+			for (int corner = 0; corner < 8; ++corner) {
+				const glm::vec3 view_point = unproject(projection,
+					(corner & 1) ? 1.f : -1.f, (corner & 2) ? 1.f : -1.f, (corner & 4) ? split_far : split_near);
+				corners[corner] = glm::vec3(inverse_view * glm::vec4(view_point, 1.f));
+				center += corners[corner];
+			}
+			center /= 8.f;
+			float radius = 0.f;
+			for (const glm::vec3& corner : corners) {
+				radius = std::max(radius, glm::length(corner - center));
+			}
+			// sphere doesn't change with camera rotation, rounding removes float noise
+			radius = std::ceil(radius * 16.f) / 16.f;
+
+			const float half_extent = radius * (1.f + settings.cache_margin);
+			const float texel = 2.f * half_extent / s_resolution;
+			const float step = std::max(texel, std::floor(settings.cache_margin * radius / texel) * texel);
+			glm::vec3 light_center = glm::vec3(light_rotation * glm::vec4(center, 1.f));
+			light_center = glm::vec3(snap(light_center.x, step), snap(light_center.y, step), snap(light_center.z, step));
+
+			// camera of cascade looks at snapped center from caster distance behind it
+			const float back = half_extent + settings.caster_distance;
+			const glm::mat4 light_view = glm::translate(glm::mat4(1.f),
+				glm::vec3(-light_center.x, -light_center.y, -light_center.z - back)) * light_rotation;
+			const glm::mat4 light_projection = glm::ortho(-half_extent, half_extent, -half_extent, half_extent, 0.f, back + half_extent);
+
+			cascades.view_projection[i] = light_projection * light_view;
+			cascades.split_depth[i] = split_far;
+			split_near = split_far;
+		}
+	}
+}
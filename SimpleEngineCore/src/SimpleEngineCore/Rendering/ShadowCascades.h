@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+	class Camera;
+	class Drawable;
+
+	// entity which is drawn into shadow map, static casters are cached between frames
+	struct ShadowCaster {
+		Drawable* drawable = nullptr;
+		glm::mat4 model_matrix{ 1.f };
+		uint32_t lod = 0;
+	};
+
+	struct ShadowSettings {
+		uint32_t cascades_count = 4;
+		float max_distance = 50.f;	// no shadows further from camera (view depth)
+		float split_lambda = 0.75f;	// 0 - uniform splits, 1 - logarithmic splits
+		// cascade is this part bigger than its frustum slice and moves in steps of this part,
+		// while camera stays inside of step cascade matrix doesn't change and cached static casters are reused
+		float cache_margin = 0.25f;
+		// casters between light and cascade, which are out of view, still cast shadows into it
+		float caster_distance = 50.f;
+	};
+
+	// light space matrices for directional light shadow, computed on main thread
+	struct ShadowCascades {
+		static constexpr uint32_t s_max_cascades = 4;
+		static constexpr uint32_t s_resolution = 2048;
+		static constexpr unsigned int s_texture_unit = 2;	// material textures use 0 and 1
+
+		uint32_t count = 0;	// 0 - shadows are off
+		glm::mat4 view_projection[s_max_cascades];
+		float split_depth[s_max_cascades] = {};	// view depth where cascade ends
+
+		// each cascade bounds sphere of its slice of camera frustum, sphere radius is rounded and
+		// center is snapped to texels in light space, so shadow edges don't shimmer when camera moves or rotates
+		static void build(const Camera& camera, const glm::vec3& light_direction, const ShadowSettings& settings, ShadowCascades& cascades);
+	};
+}
@@ -0,0 +1,130 @@
+#include "ShadowRenderer.h"
+
+#include "OpenGL/DrawContext.h"
+#include "OpenGL/Renderer_OpenGL.h"
+#include "OpenGL/ShaderProgram.h"
+#include "SimpleEngineCore/Log.h"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+	namespace {
+		unsigned int create_depth_array()
+		{
+			unsigned int texture = 0;
+			glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture);
+			glTextureStorage3D(texture, 1, GL_DEPTH_COMPONENT32F,
+				ShadowCascades::s_resolution, ShadowCascades::s_resolution, ShadowCascades::s_max_cascades);
+			glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			// outside of cascade is lit
+			glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+			glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+			const float border[4] = { 1.f, 1.f, 1.f, 1.f };
+			glTextureParameterfv(texture, GL_TEXTURE_BORDER_COLOR, border);
+			// hardware depth compare and 2x2 filtering for sampler2DArrayShadow
+			glTextureParameteri(texture, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+			glTextureParameteri(texture, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+			return texture;
+		}
+	}
+
+	ShadowRenderer::ShadowRenderer()
+	{
+		m_depth_program = std::make_unique<ShaderProgram>(
+			"shaders/depth_only_vertex_shader.glsl",
+			"shaders/depth_only_fragment_shader.glsl");
+		if (!m_depth_program->is_compiled()) {
+			LOG_CRIT_TO(Render, "Shadow depth shader is not compiled");
+		}
+
+		m_shadow_map = create_depth_array();
+		m_static_map = create_depth_array();
+		// two arrays of 32 bit depth
+		m_gpu_memory = GpuMemory::add_allocation(GpuMemoryCategory::RenderTargets, 2 * sizeof(float) *
+			ShadowCascades::s_resolution * ShadowCascades::s_resolution * ShadowCascades::s_max_cascades);
+		glCreateFramebuffers(1, &m_framebuffer);
+		glNamedFramebufferDrawBuffer(m_framebuffer, GL_NONE);
+		glNamedFramebufferReadBuffer(m_framebuffer, GL_NONE);
+	}
+
+	ShadowRenderer::~ShadowRenderer()
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteTextures(1, &m_shadow_map);
+		glDeleteTextures(1, &m_static_map);
+		GpuMemory::remove_allocation(m_gpu_memory);
+	}
+
+	void ShadowRenderer::render(const ShadowCascades& cascades,
+		const std::vector<ShadowCaster>& static_casters, const std::vector<ShadowCaster>& dynamic_casters,
+		const uint64_t static_version)
+	{
+		m_stats.static_redraws = 0;
+		if (cascades.count == 0) {
+			return;
+		}
+		if (static_version != m_static_version) {
+			m_static_version = static_version;
+			for (bool& valid : m_static_valid) {
+				valid = false;
+			}
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+		glViewport(0, 0, ShadowCascades::s_resolution, ShadowCascades::s_resolution);
+		// cascade matrices are standard ortho and shader compares with standard depth, scene pass may be reverse-Z
+		Renderer_OpenGL::set_reverse_z(false);
+		Renderer_OpenGL::set_depth_func(Renderer_OpenGL::EDepthFunc::Less);
+		Renderer_OpenGL::set_depth_write(true);
+		// slope scaled bias against shadow acne
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(2.f, 4.f);
+		m_depth_program->bind();
+
+		for (uint32_t i = 0; i < cascades.count; ++i) {
+			m_timers[i].begin();
+			if (!m_static_valid[i] || m_static_view_projection[i] != cascades.view_projection[i]) {
+				attach_layer(m_static_map, i);
+				glClear(GL_DEPTH_BUFFER_BIT);
+				draw_casters(static_casters, cascades.view_projection[i]);
+				m_static_view_projection[i] = cascades.view_projection[i];
+				m_static_valid[i] = true;
+				++m_stats.static_redraws;
+			}
+			// dynamic casters are depth tested against copy of static layer
+			glCopyImageSubData(
+				m_static_map, GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(i),
+				m_shadow_map, GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(i),
+				ShadowCascades::s_resolution, ShadowCascades::s_resolution, 1);
+			attach_layer(m_shadow_map, i);
+			draw_casters(dynamic_casters, cascades.view_projection[i]);
+			m_timers[i].end();
+			m_stats.cascade_ms[i] = m_timers[i].get_ms();
+		}
+		for (uint32_t i = cascades.count; i < ShadowCascades::s_max_cascades; ++i) {
+			m_stats.cascade_ms[i] = 0.f;
+		}
+
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void ShadowRenderer::bind_shadow_map() const
+	{
+		glBindTextureUnit(ShadowCascades::s_texture_unit, m_shadow_map);
+	}
+
+	void ShadowRenderer::draw_casters(const std::vector<ShadowCaster>& casters, const glm::mat4& view_projection) const
+	{
+		for (const ShadowCaster& caster : casters) {
+			caster.drawable->DrawDepth(*m_depth_program, view_projection * caster.model_matrix, caster.lod);
+		}
+	}
+
+	void ShadowRenderer::attach_layer(const unsigned int texture, const uint32_t layer) const
+	{
+		glNamedFramebufferTextureLayer(m_framebuffer, GL_DEPTH_ATTACHMENT, texture, 0, static_cast<GLint>(layer));
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ShadowCascades.h"
+#include "OpenGL/GpuQuery.h"
+#include "OpenGL/GpuMemory.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+	class ShaderProgram;
+
+	// render thread: depth of casters into texture array, one layer per cascade
+	// static casters are drawn into own array which is redrawn only when cascade matrix, light or static geometry changes,
+	// every frame the static layer is copied to the shadow map and dynamic casters are drawn on top of it
+	class ShadowRenderer {
+	public:
+		struct Stats {
+			float cascade_ms[ShadowCascades::s_max_cascades] = {};	// GPU time of shadow pass per cascade
+			uint32_t static_redraws = 0;	// cascades whose static layer was redrawn in the last frame
+		};
+
+		ShadowRenderer();
+		~ShadowRenderer();
+
+		ShadowRenderer(const ShadowRenderer&) = delete;
+		ShadowRenderer& operator=(const ShadowRenderer&) = delete;
+
+		// static_version has to change when any static caster is added, removed or moved
+		void render(const ShadowCascades& cascades,
+			const std::vector<ShadowCaster>& static_casters, const std::vector<ShadowCaster>& dynamic_casters,
+			const uint64_t static_version);
+		// shadow map for sampler2DArrayShadow at ShadowCascades::s_texture_unit
+		void bind_shadow_map() const;
+
+		const Stats& get_stats() const { return m_stats; }
+
+	private:
+		void draw_casters(const std::vector<ShadowCaster>& casters, const glm::mat4& view_projection) const;
+		void attach_layer(const unsigned int texture, const uint32_t layer) const;
+
+		std::unique_ptr<ShaderProgram> m_depth_program;
+		unsigned int m_framebuffer = 0;
+		unsigned int m_shadow_map = 0;
+		unsigned int m_static_map = 0;
+		GpuMemory::Handle m_gpu_memory = GpuMemory::s_invalid_handle;
+
+		// what static layers were drawn with
+		glm::mat4 m_static_view_projection[ShadowCascades::s_max_cascades];
+		bool m_static_valid[ShadowCascades::s_max_cascades] = {};
+		uint64_t m_static_version = 0;
+
+		GpuTimer m_timers[ShadowCascades::s_max_cascades];
+		Stats m_stats;
+	};
+}
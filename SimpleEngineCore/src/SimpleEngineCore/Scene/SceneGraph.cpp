@@ -0,0 +1,206 @@
+#include "SceneGraph.h"
+
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	namespace {
+		// subtrees bigger than this are split to children before going to workers
+		constexpr uint32_t s_max_range_size = 4096;
+	}
+
+	void SceneGraph::reserve(const size_t nodes_count)
+	{
+		m_local.reserve(nodes_count);
+		m_world.reserve(nodes_count);
+		m_normal.reserve(nodes_count);
+		m_parent.reserve(nodes_count);
+		m_subtree_size.reserve(nodes_count);
+		m_index_to_id.reserve(nodes_count);
+		m_id_to_index.reserve(nodes_count);
+		m_is_dirty.reserve(nodes_count);
+	}
+
+	SceneGraph::NodeId SceneGraph::create_node(const NodeId parent, const glm::mat4& local)
+	{
+		NodeId id;
+		if (!m_free_ids.empty()) {
+			id = m_free_ids.back();
+			m_free_ids.pop_back();
+		}
+		else {
+			id = static_cast<NodeId>(m_id_to_index.size());
+			m_id_to_index.push_back(s_invalid_index);
+			m_is_dirty.push_back(0);
+		}
+
+		uint32_t index = static_cast<uint32_t>(m_local.size());
+		int32_t parent_index = -1;
+		if (parent != s_invalid_node) {
+			parent_index = static_cast<int32_t>(m_id_to_index[parent]);
+			// after the last node of parent subtree
+			index = static_cast<uint32_t>(parent_index) + m_subtree_size[parent_index];
+			for (int32_t ancestor = parent_index; ancestor >= 0; ancestor = m_parent[ancestor]) {
+				++m_subtree_size[ancestor];
+			}
+		}
+		insert_at(index, id, parent_index, local);
+		mark_dirty(index);
+		return id;
+	}
+
+	void SceneGraph::insert_at(const uint32_t index, const NodeId id, const int32_t parent_index, const glm::mat4& local)
+	{
+		const bool is_append = index == m_local.size();
+		m_local.insert(m_local.begin() + index, local);
+		m_world.insert(m_world.begin() + index, local);
+		m_normal.insert(m_normal.begin() + index, glm::mat3(1.f));
+		m_parent.insert(m_parent.begin() + index, parent_index);
+		m_subtree_size.insert(m_subtree_size.begin() + index, 1);
+		m_index_to_id.insert(m_index_to_id.begin() + index, id);
+		m_id_to_index[id] = index;
+		if (is_append) {
+			return;
+		}
+
+		// everything after new node moved by one
+		for (size_t i = index + 1; i < m_local.size(); ++i) {
+			m_id_to_index[m_index_to_id[i]] = static_cast<uint32_t>(i);
+			if (m_parent[i] >= static_cast<int32_t>(index)) {
+				++m_parent[i];
+			}
+		}
+	}
+
+	void SceneGraph::remove_node(const NodeId node)
+	{
+		if (!is_node_valid(node)) {
+			return;
+		}
+		const uint32_t begin = m_id_to_index[node];
+		const uint32_t count = m_subtree_size[begin];
+		const uint32_t end = begin + count;
+
+		for (int32_t ancestor = m_parent[begin]; ancestor >= 0; ancestor = m_parent[ancestor]) {
+			m_subtree_size[ancestor] -= count;
+		}
+		for (uint32_t i = begin; i < end; ++i) {
+			const NodeId id = m_index_to_id[i];
+			m_id_to_index[id] = s_invalid_index;
+			m_is_dirty[id] = 0;
+			m_free_ids.push_back(id);
+		}
+
+		m_local.erase(m_local.begin() + begin, m_local.begin() + end);
+		m_world.erase(m_world.begin() + begin, m_world.begin() + end);
+		m_normal.erase(m_normal.begin() + begin, m_normal.begin() + end);
+		m_parent.erase(m_parent.begin() + begin, m_parent.begin() + end);
+		m_subtree_size.erase(m_subtree_size.begin() + begin, m_subtree_size.begin() + end);
+		m_index_to_id.erase(m_index_to_id.begin() + begin, m_index_to_id.begin() + end);
+
+		for (size_t i = begin; i < m_local.size(); ++i) {
+			m_id_to_index[m_index_to_id[i]] = static_cast<uint32_t>(i);
+			if (m_parent[i] >= static_cast<int32_t>(end)) {
+				m_parent[i] -= static_cast<int32_t>(count);
+			}
+		}
+	}
+
+	void SceneGraph::set_local_matrix(const NodeId node, const glm::mat4& local)
+	{
+		const uint32_t index = m_id_to_index[node];
+		m_local[index] = local;
+		mark_dirty(index);
+	}
+
+	SceneGraph::NodeId SceneGraph::get_parent(const NodeId node) const
+	{
+		const int32_t parent_index = m_parent[m_id_to_index[node]];
+		return parent_index >= 0 ? m_index_to_id[parent_index] : s_invalid_node;
+	}
+
+	void SceneGraph::mark_dirty(const uint32_t index)
+	{
+		const NodeId id = m_index_to_id[index];
+		if (!m_is_dirty[id]) {
+			m_is_dirty[id] = 1;
+			m_dirty_nodes.push_back(id);
+		}
+	}
+
+	size_t SceneGraph::update()
+	{
+		if (m_dirty_nodes.empty()) {
+			return 0;
+		}
+
+		// dirty nodes to sorted ranges, nodes inside of already dirty subtree are skipped
+		m_dirty_ranges.clear();
+		for (const NodeId id : m_dirty_nodes) {
+			if (m_is_dirty[id] && is_node_valid(id)) {
+				const uint32_t index = m_id_to_index[id];
+				m_dirty_ranges.push_back({ index, index + m_subtree_size[index] });
+			}
+			m_is_dirty[id] = 0;
+		}
+		m_dirty_nodes.clear();
+		std::sort(m_dirty_ranges.begin(), m_dirty_ranges.end(),
+			[](const DirtyRange& a, const DirtyRange& b) { return a.begin < b.begin; });
+
+		size_t covered_end = 0;
+		size_t ranges_count = 0;
+		size_t nodes_count = 0;
+		for (const DirtyRange& range : m_dirty_ranges) {
+			if (range.begin < covered_end) {
+				continue;
+			}
+			m_dirty_ranges[ranges_count++] = range;
+			covered_end = range.end;
+			nodes_count += range.end - range.begin;
+		}
+		m_dirty_ranges.resize(ranges_count);
+
+		split_dirty_ranges();
+
+		const size_t batch_size = JobSystem::get_batch_size(m_update_ranges.size(), 1);
+		JobSystem::parallel_for(m_update_ranges.size(), batch_size, [this](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				update_range(m_update_ranges[i].begin, m_update_ranges[i].end);
+			}
+		});
+		return nodes_count;
+	}
+
+	void SceneGraph::split_dirty_ranges()
+	{
+		// big subtree: root is computed here, its children subtrees become independent ranges
+		m_update_ranges.clear();
+		while (!m_dirty_ranges.empty()) {
+			const DirtyRange range = m_dirty_ranges.back();
+			m_dirty_ranges.pop_back();
+			if (range.end - range.begin <= s_max_range_size) {
+				m_update_ranges.push_back(range);
+				continue;
+			}
+			update_range(range.begin, range.begin + 1);
+			for (uint32_t child = range.begin + 1; child < range.end; child += m_subtree_size[child]) {
+				m_dirty_ranges.push_back({ child, child + m_subtree_size[child] });
+			}
+		}
+	}
+
+	void SceneGraph::update_range(const uint32_t begin, const uint32_t end)
+	{
+		// parents are before children, so parent world matrix is always ready
+		for (uint32_t i = begin; i < end; ++i) {
+			const int32_t parent = m_parent[i];
+			m_world[i] = parent >= 0 ? m_world[parent] * m_local[i] : m_local[i];
+		}
+		SimdMath::compute_normal_matrices(&m_world[begin], &m_normal[begin], end - begin);
+	}
+}
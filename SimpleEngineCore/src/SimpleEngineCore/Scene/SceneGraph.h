@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// transform hierarchy stored in depth first order:
+	// parent is always before its children and whole subtree is one range [index, index + subtree_size)
+	// so world matrices are computed in one linear pass and independent subtrees go to different threads
+	// node ids are stable, indices in arrays change when nodes are added or removed
+	class SceneGraph {
+	public:
+		using NodeId = uint32_t;
+		static constexpr NodeId s_invalid_node = UINT32_MAX;
+
+		SceneGraph() = default;
+
+		SceneGraph(const SceneGraph&) = delete;
+		SceneGraph& operator=(const SceneGraph&) = delete;
+
+		// new node is the last child of parent (s_invalid_node - new root)
+		NodeId create_node(const NodeId parent = s_invalid_node, const glm::mat4& local = glm::mat4(1.f));
+		// removes node with all children
+		void remove_node(const NodeId node);
+		void reserve(const size_t nodes_count);
+
+		void set_local_matrix(const NodeId node, const glm::mat4& local);
+		const glm::mat4& get_local_matrix(const NodeId node) const { return m_local[m_id_to_index[node]]; }
+		// valid after update
+		const glm::mat4& get_world_matrix(const NodeId node) const { return m_world[m_id_to_index[node]]; }
+		const glm::mat3& get_normal_matrix(const NodeId node) const { return m_normal[m_id_to_index[node]]; }
+		NodeId get_parent(const NodeId node) const;
+
+		// recomputes world and normal matrices only for subtrees which were changed since last update
+		// returns how many nodes were recomputed
+		size_t update();
+
+		size_t get_nodes_count() const { return m_local.size(); }
+		bool is_node_valid(const NodeId node) const {
+			return node < m_id_to_index.size() && m_id_to_index[node] != s_invalid_index;
+		}
+
+	private:
+		static constexpr uint32_t s_invalid_index = UINT32_MAX;
+
+		// subtree which has to be recomputed, root is recomputed with parent world matrix
+		struct DirtyRange {
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		void mark_dirty(const uint32_t index);
+		void split_dirty_ranges();
+		void update_range(const uint32_t begin, const uint32_t end);
+		void insert_at(const uint32_t index, const NodeId id, const int32_t parent_index, const glm::mat4& local);
+
+		// SoA, all arrays are indexed by position in depth first order
+		std::vector<glm::mat4> m_local;
+		std::vector<glm::mat4> m_world;
+		std::vector<glm::mat3> m_normal;
+		std::vector<int32_t> m_parent;			// -1 for roots
+		std::vector<uint32_t> m_subtree_size;	// node itself + all descendants
+		std::vector<NodeId> m_index_to_id;
+
+		std::vector<uint32_t> m_id_to_index;
+		std::vector<NodeId> m_free_ids;
+
+		// ids of changed nodes, turned into ranges on update
+		std::vector<NodeId> m_dirty_nodes;
+		std::vector<uint8_t> m_is_dirty;		// by id, to not add node twice
+		std::vector<DirtyRange> m_dirty_ranges;
+		std::vector<DirtyRange> m_update_ranges;	// dirty ranges split to parts for workers
+	};
+}
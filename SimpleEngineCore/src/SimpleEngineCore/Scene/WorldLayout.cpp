@@ -0,0 +1,336 @@
+#include "WorldLayout.h"
+
+#include "SimpleEngineCore/Assets/CookedFormats.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <utility>
+
+namespace SimpleEngine {
+
+	namespace {
+		std::vector<std::string_view> split_words(const std::string_view line)
+		{
+			std::vector<std::string_view> words;
+			size_t begin = 0;
+			while (true) {
+				begin = line.find_first_not_of(" \t\r", begin);
+				if (begin == std::string_view::npos) {
+					return words;
+				}
+				const size_t end = line.find_first_of(" \t\r", begin);
+				words.push_back(line.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin));
+				if (end == std::string_view::npos) {
+					return words;
+				}
+				begin = end;
+			}
+		}
+
+		bool parse_index(const std::string_view text, uint32_t& value)
+		{
+			const std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+			return result.ec == std::errc() && result.ptr == text.data() + text.size();
+		}
+
+		bool parse_float(const std::string_view text, float& value)
+		{
+			const std::string terminated(text);
+			char* end = nullptr;
+			value = std::strtof(terminated.c_str(), &end);
+			return end == terminated.c_str() + terminated.size() && std::isfinite(value);
+		}
+
+		bool parse_mesh_type(const std::string_view text, MeshType& mesh_type)
+		{
+			if (text == "MeshNew") {
+				mesh_type = MeshType::MeshNew;
+				return true;
+			}
+			if (text == "LightCube") {
+				mesh_type = MeshType::LightCube;
+				return true;
+			}
+			return false;
+		}
+
+		uint32_t add_string(std::vector<char>& strings, const std::string& text)
+		{
+			const uint32_t offset = static_cast<uint32_t>(strings.size());
+			strings.insert(strings.end(), text.begin(), text.end());
+			strings.push_back('\0');
+			return offset;
+		}
+
+		template<typename T>
+		void append(std::vector<uint8_t>& bytes, const T* items, const size_t count)
+		{
+			const size_t offset = bytes.size();
+			bytes.resize(offset + sizeof(T) * count);
+			if (count > 0) {
+				std::memcpy(bytes.data() + offset, items, sizeof(T) * count);
+			}
+		}
+
+		template<typename T>
+		bool read_array(const uint8_t* data, const size_t size, size_t& offset, const size_t count, std::vector<T>& items)
+		{
+			if (count > (size - offset) / sizeof(T)) {
+				return false;
+			}
+			items.resize(count);
+			if (count > 0) {
+				std::memcpy(items.data(), data + offset, sizeof(T) * count);
+			}
+			offset += sizeof(T) * count;
+			return true;
+		}
+	}
+
+	int32_t get_world_cell(const float coordinate, const float cell_size)
+	{
+		return static_cast<int32_t>(std::floor(coordinate / cell_size));
+	}
+
+	bool parse_world_source(const uint8_t* data, const size_t size, WorldLayout& layout, std::string& error)
+	{
+		layout = WorldLayout();
+		std::vector<WorldObject> objects;
+		const std::string_view text(reinterpret_cast<const char*>(data), size);
+		size_t line_begin = 0;
+		size_t line_number = 0;
+		while (line_begin < text.size()) {
+			size_t line_end = text.find('\n', line_begin);
+			if (line_end == std::string_view::npos) {
+				line_end = text.size();
+			}
+			std::string_view line = text.substr(line_begin, line_end - line_begin);
+			line_begin = line_end + 1;
+			++line_number;
+			line = line.substr(0, line.find('#'));
+			const std::vector<std::string_view> words = split_words(line);
+			if (words.empty()) {
+				continue;
+			}
+			bool valid = false;
+			if (words[0] == "cell_size" && words.size() == 2) {
+				valid = parse_float(words[1], layout.cell_size) && layout.cell_size > 0.f;
+			}
+			else if (words[0] == "model" && (words.size() == 4 || words.size() == 5)) {
+				WorldModel model{ std::string(words[1]), std::string(words[2]), std::string(words[3]) };
+				valid = words.size() == 4 || parse_mesh_type(words[4], model.mesh_type);
+				if (valid) {
+					layout.models.push_back(std::move(model));
+				}
+			}
+			else if (words[0] == "object" && (words.size() == 5 || words.size() == 6)) {
+				WorldObject object;
+				valid = parse_index(words[1], object.model) && object.model < layout.models.size() &&
+					parse_float(words[2], object.position.x) && parse_float(words[3], object.position.y) &&
+					parse_float(words[4], object.position.z) && (words.size() == 5 || parse_float(words[5], object.scale));
+				if (valid) {
+					objects.push_back(object);
+				}
+			}
+			if (!valid) {
+				error = "line " + std::to_string(line_number) + ": " + std::string(line);
+				return false;
+			}
+		}
+
+		// cell size may be declared after objects, so cells are made at the end
+		std::map<std::pair<int32_t, int32_t>, WorldCell> cells;
+		for (const WorldObject& object : objects) {
+			const int32_t x = get_world_cell(object.position.x, layout.cell_size);
+			const int32_t y = get_world_cell(object.position.y, layout.cell_size);
+			WorldCell& cell = cells[{ y, x }];
+			cell.x = x;
+			cell.y = y;
+			cell.objects.push_back(object);
+			cell.models.push_back(object.model);
+		}
+		layout.cells.reserve(cells.size());
+		for (auto& [coordinates, cell] : cells) {
+			std::sort(cell.models.begin(), cell.models.end());
+			cell.models.erase(std::unique(cell.models.begin(), cell.models.end()), cell.models.end());
+			layout.cells.push_back(std::move(cell));
+		}
+		return true;
+	}
+
+	bool write_cooked_world(const WorldLayout& layout, std::vector<uint8_t>& bytes)
+	{
+		bytes.clear();
+		const size_t models_count = layout.models.size();
+		for (const WorldCell& cell : layout.cells) {
+			if (std::any_of(cell.models.begin(), cell.models.end(), [models_count](const uint32_t model) { return model >= models_count; }) ||
+				std::any_of(cell.objects.begin(), cell.objects.end(), [models_count](const WorldObject& object) { return object.model >= models_count; })) {
+				return false;
+			}
+		}
+
+		std::vector<char> strings;
+		std::vector<CookedWorldModel> models;
+		models.reserve(layout.models.size());
+		for (const WorldModel& model : layout.models) {
+			CookedWorldModel cooked;
+			cooked.path = add_string(strings, model.path);
+			cooked.vertex_shader_path = add_string(strings, model.vertex_shader_path);
+			cooked.frag_shader_path = add_string(strings, model.frag_shader_path);
+			cooked.mesh_type = static_cast<uint32_t>(model.mesh_type);
+			models.push_back(cooked);
+		}
+		std::vector<CookedWorldCell> cells;
+		std::vector<uint32_t> cell_models;
+		std::vector<CookedWorldObject> objects;
+		cells.reserve(layout.cells.size());
+		for (const WorldCell& cell : layout.cells) {
+			CookedWorldCell cooked;
+			cooked.x = cell.x;
+			cooked.y = cell.y;
+			cooked.first_model = static_cast<uint32_t>(cell_models.size());
+			cooked.models_count = static_cast<uint32_t>(cell.models.size());
+			cooked.first_object = static_cast<uint32_t>(objects.size());
+			cooked.objects_count = static_cast<uint32_t>(cell.objects.size());
+			cells.push_back(cooked);
+			cell_models.insert(cell_models.end(), cell.models.begin(), cell.models.end());
+			for (const WorldObject& object : cell.objects) {
+				CookedWorldObject cooked_object;
+				cooked_object.model = object.model;
+				cooked_object.position[0] = object.position.x;
+				cooked_object.position[1] = object.position.y;
+				cooked_object.position[2] = object.position.z;
+				cooked_object.scale = object.scale;
+				objects.push_back(cooked_object);
+			}
+		}
+		// strings are the last part, padding keeps the file size 4 byte aligned
+		while (strings.size() % 4 != 0) {
+			strings.push_back('\0');
+		}
+
+		CookedWorldHeader header;
+		header.cell_size = layout.cell_size;
+		header.models_count = static_cast<uint32_t>(models.size());
+		header.cells_count = static_cast<uint32_t>(cells.size());
+		header.cell_models_count = static_cast<uint32_t>(cell_models.size());
+		header.objects_count = static_cast<uint32_t>(objects.size());
+		header.strings_size = static_cast<uint32_t>(strings.size());
+		append(bytes, &header, 1);
+		append(bytes, models.data(), models.size());
+		append(bytes, cells.data(), cells.size());
+		append(bytes, cell_models.data(), cell_models.size());
+		append(bytes, objects.data(), objects.size());
+		append(bytes, strings.data(), strings.size());
+		return true;
+	}
+
+	bool is_cooked_world(const uint8_t* data, const size_t size)
+	{
+		// magic alone, so cooked world cut inside of header is reported as damaged, not parsed as text
+		uint32_t magic = 0;
+		if (size < sizeof(magic)) {
+			return false;
+		}
+		std::memcpy(&magic, data, sizeof(magic));
+		return magic == CookedWorldHeader::s_magic;
+	}
+
+	bool read_cooked_world(const uint8_t* data, const size_t size, WorldLayout& layout)
+	{
+		layout = WorldLayout();
+		CookedWorldHeader header;
+		if (size < sizeof(header)) {
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (header.magic != CookedWorldHeader::s_magic || header.version != CookedWorldHeader::s_version ||
+			!(header.cell_size > 0.f)) {
+			return false;
+		}
+		size_t offset = sizeof(header);
+		std::vector<CookedWorldModel> models;
+		std::vector<CookedWorldCell> cells;
+		std::vector<uint32_t> cell_models;
+		std::vector<CookedWorldObject> objects;
+		std::vector<char> strings;
+		if (!read_array(data, size, offset, header.models_count, models) ||
+			!read_array(data, size, offset, header.cells_count, cells) ||
+			!read_array(data, size, offset, header.cell_models_count, cell_models) ||
+			!read_array(data, size, offset, header.objects_count, objects) ||
+			!read_array(data, size, offset, header.strings_size, strings)) {
+			return false;
+		}
+		// every string has to end inside of strings
+		const auto get_string = [&strings](const uint32_t string_offset, std::string& text) {
+			if (string_offset >= strings.size()) {
+				return false;
+			}
+			const char* begin = strings.data() + string_offset;
+			const void* end = std::memchr(begin, '\0', strings.size() - string_offset);
+			if (end == nullptr) {
+				return false;
+			}
+			text.assign(begin, static_cast<const char*>(end));
+			return true;
+		};
+
+		layout.cell_size = header.cell_size;
+		layout.models.resize(models.size());
+		for (size_t i = 0; i < models.size(); ++i) {
+			if (!get_string(models[i].path, layout.models[i].path) ||
+				!get_string(models[i].vertex_shader_path, layout.models[i].vertex_shader_path) ||
+				!get_string(models[i].frag_shader_path, layout.models[i].frag_shader_path) ||
+				models[i].mesh_type > static_cast<uint32_t>(MeshType::MeshNew)) {
+				return false;
+			}
+			layout.models[i].mesh_type = static_cast<MeshType>(models[i].mesh_type);
+		}
+		layout.cells.resize(cells.size());
+		for (size_t i = 0; i < cells.size(); ++i) {
+			const CookedWorldCell& cooked = cells[i];
+			if (cooked.first_model > cell_models.size() || cooked.models_count > cell_models.size() - cooked.first_model ||
+				cooked.first_object > objects.size() || cooked.objects_count > objects.size() - cooked.first_object) {
+				return false;
+			}
+			WorldCell& cell = layout.cells[i];
+			cell.x = cooked.x;
+			cell.y = cooked.y;
+			cell.models.assign(cell_models.begin() + cooked.first_model,
+				cell_models.begin() + cooked.first_model + cooked.models_count);
+			cell.objects.reserve(cooked.objects_count);
+			for (uint32_t j = 0; j < cooked.objects_count; ++j) {
+				const CookedWorldObject& cooked_object = objects[cooked.first_object + j];
+				if (cooked_object.model >= models.size()) {
+					return false;
+				}
+				WorldObject object;
+				object.model = cooked_object.model;
+				object.position = glm::vec3(cooked_object.position[0], cooked_object.position[1], cooked_object.position[2]);
+				object.scale = cooked_object.scale;
+				cell.objects.push_back(object);
+			}
+			if (std::any_of(cell.models.begin(), cell.models.end(), [&models](const uint32_t model) { return model >= models.size(); })) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool load_world_layout(const uint8_t* data, const size_t size, WorldLayout& layout, std::string& error)
+	{
+		if (is_cooked_world(data, size)) {
+			if (!read_cooked_world(data, size, layout)) {
+				error = "cooked world is damaged or of other version";
+				return false;
+			}
+			return true;
+		}
+		return parse_world_source(data, size, layout, error);
+	}
+}
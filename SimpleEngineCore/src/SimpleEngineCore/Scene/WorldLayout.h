@@ -0,0 +1,60 @@
+#pragma once
+
+#include "SimpleEngineCore/Rendering/MeshType.h"
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct WorldModel {
+		std::string path;
+		std::string vertex_shader_path;
+		std::string frag_shader_path;
+		MeshType mesh_type = MeshType::MeshNew;
+	};
+
+	struct WorldObject {
+		uint32_t model = 0;		// index in WorldLayout::models
+		glm::vec3 position{ 0.f };
+		float scale = 1.f;
+	};
+
+	// square on XY plane (z is up) from (x, y) * cell_size to (x + 1, y + 1) * cell_size
+	struct WorldCell {
+		int32_t x = 0;
+		int32_t y = 0;
+		std::vector<uint32_t> models;	// what objects of the cell use, sorted, each once
+		std::vector<WorldObject> objects;
+	};
+
+	// objects of world grouped by cells they stand in, cells are sorted by y, then x
+	struct WorldLayout {
+		float cell_size = 32.f;
+		std::vector<WorldModel> models;
+		std::vector<WorldCell> cells;
+	};
+
+	// cell of coordinate, negative coordinates go to negative cells
+	int32_t get_world_cell(const float coordinate, const float cell_size);
+
+	// .world text, one declaration per line, '#' starts a comment, paths are virtual and without spaces:
+	//   cell_size <size>
+	//   model <path> <vertex shader path> <fragment shader path> [MeshNew or LightCube, MeshNew when omitted]
+	//   object <index of model declared above> <x> <y> <z> [scale]
+	// error tells line which is wrong
+	bool parse_world_source(const uint8_t* data, const size_t size, WorldLayout& layout, std::string& error);
+
+	// false when a cell or an object points to a model which is not in layout, then nothing is written
+	bool write_cooked_world(const WorldLayout& layout, std::vector<uint8_t>& bytes);
+	bool is_cooked_world(const uint8_t* data, const size_t size);
+	// false when bytes are not a cooked world of this version, it is cut short or indices are out of range
+	bool read_cooked_world(const uint8_t* data, const size_t size, WorldLayout& layout);
+
+	// cooked world or .world text, manifest decides which one a path gives
+	bool load_world_layout(const uint8_t* data, const size_t size, WorldLayout& layout, std::string& error);
+}
@@ -0,0 +1,220 @@
+#include "WorldStreamer.h"
+
+#include "SimpleEngineCore/Log.h"
+#include "SimpleEngineCore/ECS/Components.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuMemory.h"
+#include "SimpleEngineCore/Rendering/OpenGL/Mesh.h"
+
+#include <glm/matrix.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimpleEngine {
+
+	namespace {
+		uint64_t get_cell_key(const int32_t x, const int32_t y)
+		{
+			return (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x);
+		}
+	}
+
+	bool WorldStreamer::open(const std::filesystem::path& path, World& world)
+	{
+		close(world);
+		FileData file;
+		if (!FileSystem::read(path, file)) {
+			LOG_ERROR_TO(Assets, "Failed to find world {0}", path.string());
+			return false;
+		}
+		std::string error;
+		if (!load_world_layout(file.data(), file.size(), m_layout, error)) {
+			LOG_ERROR_TO(Assets, "World {0} is not loaded: {1}", path.string(), error);
+			m_layout = WorldLayout();
+			return false;
+		}
+		m_cells.resize(m_layout.cells.size());
+		m_cell_by_coordinates.reserve(m_layout.cells.size());
+		for (uint32_t i = 0; i < m_layout.cells.size(); ++i) {
+			m_cell_by_coordinates.emplace(get_cell_key(m_layout.cells[i].x, m_layout.cells[i].y), i);
+		}
+		m_stats = Stats();
+		m_stats.cells = m_cells.size();
+		m_stream_in_total_ms = 0.0;
+		LOG_INFO_TO(Assets, "World {0}: {1} cells of {2}, {3} models", path.string(), m_layout.cells.size(),
+			m_layout.cell_size, m_layout.models.size());
+		return true;
+	}
+
+	void WorldStreamer::close(World& world)
+	{
+		for (const uint32_t cell : m_active_cells) {
+			unload(world, cell);
+		}
+		m_active_cells.clear();
+		m_cells.clear();
+		m_cell_by_coordinates.clear();
+		m_candidates.clear();
+		m_layout = WorldLayout();
+		m_stats.cells = 0;
+		m_stats.loaded_cells = 0;
+		m_stats.loading_cells = 0;
+		m_stats.entities = 0;
+	}
+
+	void WorldStreamer::set_settings(const Settings& settings)
+	{
+		m_settings = settings;
+		m_settings.load_radius = std::max(m_settings.load_radius, 0.f);
+		m_settings.unload_radius = std::max(m_settings.unload_radius, m_settings.load_radius);
+		m_settings.max_loading_cells = std::max<size_t>(m_settings.max_loading_cells, 1);
+	}
+
+	void WorldStreamer::update(World& world, const glm::vec3& camera_position)
+	{
+		if (m_cells.empty()) {
+			return;
+		}
+		// cells which camera left are evicted, loaded models let the rest become entities
+		for (size_t i = 0; i < m_active_cells.size();) {
+			const uint32_t cell = m_active_cells[i];
+			if (get_distance(cell, camera_position) > m_settings.unload_radius) {
+				unload(world, cell);
+				m_active_cells[i] = m_active_cells.back();
+				m_active_cells.pop_back();
+				continue;
+			}
+			if (m_cells[cell].state == CellState::Loading) {
+				try_finish_loading(world, cell);
+			}
+			++i;
+		}
+
+		// only cells of the square around camera are looked at, not the whole world
+		const float cell_size = m_layout.cell_size;
+		const float radius = m_settings.load_radius;
+		const int32_t min_x = get_world_cell(camera_position.x - radius, cell_size);
+		const int32_t max_x = get_world_cell(camera_position.x + radius, cell_size);
+		const int32_t min_y = get_world_cell(camera_position.y - radius, cell_size);
+		const int32_t max_y = get_world_cell(camera_position.y + radius, cell_size);
+		m_candidates.clear();
+		for (int32_t y = min_y; y <= max_y; ++y) {
+			for (int32_t x = min_x; x <= max_x; ++x) {
+				const auto it = m_cell_by_coordinates.find(get_cell_key(x, y));
+				if (it == m_cell_by_coordinates.end() || m_cells[it->second].state != CellState::Unloaded) {
+					continue;
+				}
+				const float distance = get_distance(it->second, camera_position);
+				if (distance < radius) {
+					m_candidates.push_back(Candidate{ distance, it->second });
+				}
+			}
+		}
+		size_t loading = 0;
+		for (const uint32_t cell : m_active_cells) {
+			loading += m_cells[cell].state == CellState::Loading ? 1 : 0;
+		}
+		if (!m_candidates.empty() && loading < m_settings.max_loading_cells) {
+			const size_t count = std::min(m_candidates.size(), m_settings.max_loading_cells - loading);
+			std::partial_sort(m_candidates.begin(), m_candidates.begin() + count, m_candidates.end(),
+				[](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+			for (size_t i = 0; i < count; ++i) {
+				start_loading(m_candidates[i].cell);
+				m_active_cells.push_back(m_candidates[i].cell);
+				// cell of cached models is done at once
+				try_finish_loading(world, m_candidates[i].cell);
+			}
+		}
+
+		m_stats.loaded_cells = 0;
+		m_stats.loading_cells = 0;
+		m_stats.entities = 0;
+		for (const uint32_t cell : m_active_cells) {
+			const bool loaded = m_cells[cell].state == CellState::Loaded;
+			m_stats.loaded_cells += loaded ? 1 : 0;
+			m_stats.loading_cells += loaded ? 0 : 1;
+			m_stats.entities += m_cells[cell].entities.size();
+		}
+		m_stats.peak_loaded_cells = std::max(m_stats.peak_loaded_cells, m_stats.loaded_cells);
+		m_stats.gpu_bytes = GpuMemory::get_total_bytes();
+		m_stats.peak_gpu_bytes = std::max(m_stats.peak_gpu_bytes, m_stats.gpu_bytes);
+	}
+
+	float WorldStreamer::get_distance(const uint32_t cell, const glm::vec3& position) const
+	{
+		const WorldCell& layout_cell = m_layout.cells[cell];
+		const float size = m_layout.cell_size;
+		const float min_x = layout_cell.x * size;
+		const float min_y = layout_cell.y * size;
+		const float dx = std::max({ min_x - position.x, 0.f, position.x - (min_x + size) });
+		const float dy = std::max({ min_y - position.y, 0.f, position.y - (min_y + size) });
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	void WorldStreamer::start_loading(const uint32_t cell)
+	{
+		CellRuntime& runtime = m_cells[cell];
+		runtime.state = CellState::Loading;
+		runtime.requested = std::chrono::steady_clock::now();
+		GpuMemoryScope gpu_memory_owner("World cells");
+		for (const uint32_t model : m_layout.cells[cell].models) {
+			const WorldModel& world_model = m_layout.models[model];
+			runtime.models.emplace_back(AssetManager::load_model(world_model.path, world_model.mesh_type,
+				world_model.vertex_shader_path, world_model.frag_shader_path));
+		}
+	}
+
+	bool WorldStreamer::try_finish_loading(World& world, const uint32_t cell)
+	{
+		CellRuntime& runtime = m_cells[cell];
+		const auto loading = [](const AssetRef<Model>& model) { return model.get_state() == AssetState::Loading; };
+		if (std::any_of(runtime.models.begin(), runtime.models.end(), loading)) {
+			return false;
+		}
+		const WorldCell& layout_cell = m_layout.cells[cell];
+		runtime.entities.reserve(layout_cell.objects.size());
+		for (const WorldObject& object : layout_cell.objects) {
+			// models of cell are sorted, object finds its one by index of world model
+			const auto it = std::lower_bound(layout_cell.models.begin(), layout_cell.models.end(), object.model);
+			Model* model = runtime.models[it - layout_cell.models.begin()].get();
+			if (model == nullptr) {
+				continue;	// failed, AssetManager logged it
+			}
+			BoundsComponent bounds;
+			float radius = 0.f;
+			model->GetBoundingSphere(bounds.center, radius);
+			bounds.extent = glm::vec3(radius);
+			TransformComponent transform;
+			transform.model_matrix = make_local_matrix(object.position, glm::vec3(0), glm::vec3(object.scale));
+			transform.normal_matrix = glm::transpose(glm::inverse(glm::mat3(transform.model_matrix)));
+			runtime.entities.push_back(world.create(std::move(transform),
+				MeshComponent{ model }, MaterialComponent{ Material() },
+				ShadowCasterComponent{ true }, std::move(bounds)));
+		}
+		runtime.state = CellState::Loaded;
+
+		const double stream_in_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - runtime.requested).count();
+		++m_stats.stream_ins;
+		m_stream_in_total_ms += stream_in_ms;
+		m_stats.last_stream_in_ms = stream_in_ms;
+		m_stats.average_stream_in_ms = m_stream_in_total_ms / static_cast<double>(m_stats.stream_ins);
+		m_stats.max_stream_in_ms = std::max(m_stats.max_stream_in_ms, stream_in_ms);
+		return true;
+	}
+
+	void WorldStreamer::unload(World& world, const uint32_t cell)
+	{
+		CellRuntime& runtime = m_cells[cell];
+		for (const Entity entity : runtime.entities) {
+			world.destroy(entity);
+		}
+		runtime.entities.clear();
+		// models nothing else uses are unloaded by AssetManager after grace period and never while frame packets in flight
+		// may still draw them, coming back soon is a hit
+		runtime.models.clear();
+		runtime.state = CellState::Unloaded;
+		++m_stats.evictions;
+	}
+}
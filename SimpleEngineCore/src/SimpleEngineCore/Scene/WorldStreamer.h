@@ -0,0 +1,98 @@
+#pragma once
+
+#include "WorldLayout.h"
+#include "SimpleEngineCore/Assets/AssetManager.h"
+#include "SimpleEngineCore/ECS/World.h"
+
+#include <glm/vec3.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// cells of world layout around camera: models of a cell are loaded (read, decoded and uploaded in the background
+	// within upload budget of AssetManager) and its objects become entities when all of them are ready
+	// cells are evicted farther than they are loaded, so camera moving along a cell border doesn't reload it every frame
+	// everything is on main thread, between frames
+	class WorldStreamer {
+	public:
+		struct Settings {
+			float load_radius = 64.f;		// from camera to the nearest point of cell on XY plane
+			float unload_radius = 96.f;		// not below load radius
+			size_t max_loading_cells = 4;	// the nearest go first
+		};
+
+		struct Stats {
+			size_t cells = 0;
+			size_t loaded_cells = 0;
+			size_t loading_cells = 0;
+			size_t peak_loaded_cells = 0;
+			size_t entities = 0;
+			uint64_t stream_ins = 0;
+			uint64_t evictions = 0;			// loading cells left before they were done are counted too
+			// from the frame cell was requested to the frame its entities were created
+			double last_stream_in_ms = 0.0;
+			double average_stream_in_ms = 0.0;
+			double max_stream_in_ms = 0.0;
+			size_t gpu_bytes = 0;			// of all GPU memory while world is open
+			size_t peak_gpu_bytes = 0;
+		};
+
+		WorldStreamer() = default;
+		~WorldStreamer() = default;
+
+		WorldStreamer(const WorldStreamer&) = delete;
+		WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+		// reads cooked world (or .world text when it is not cooked) through FileSystem, nothing is loaded yet
+		bool open(const std::filesystem::path& path, World& world);
+		// entities of loaded cells are destroyed and models released, before AssetManager::shutdown
+		void close(World& world);
+		bool is_open() const { return !m_cells.empty(); }
+
+		void update(World& world, const glm::vec3& camera_position);
+
+		void set_settings(const Settings& settings);
+		const Settings& get_settings() const { return m_settings; }
+		const Stats& get_stats() const { return m_stats; }
+
+	private:
+		enum class CellState : uint8_t {
+			Unloaded,
+			Loading,
+			Loaded
+		};
+
+		struct CellRuntime {
+			CellState state = CellState::Unloaded;
+			std::vector<AssetRef<Model>> models;	// the same order as models of layout cell
+			std::vector<Entity> entities;
+			std::chrono::steady_clock::time_point requested;
+		};
+
+		struct Candidate {
+			float distance = 0.f;
+			uint32_t cell = 0;
+		};
+
+		float get_distance(const uint32_t cell, const glm::vec3& position) const;
+		void start_loading(const uint32_t cell);
+		// false while some model is still loading
+		bool try_finish_loading(World& world, const uint32_t cell);
+		void unload(World& world, const uint32_t cell);
+
+		Settings m_settings;
+		Stats m_stats;
+		WorldLayout m_layout;
+		std::vector<CellRuntime> m_cells;
+		std::unordered_map<uint64_t, uint32_t> m_cell_by_coordinates;
+		std::vector<uint32_t> m_active_cells;	// loading or loaded
+		std::vector<Candidate> m_candidates;
+		double m_stream_in_total_ms = 0.0;
+	};
+}
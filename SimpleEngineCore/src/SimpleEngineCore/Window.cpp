@@ -3,14 +3,15 @@
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.h"
 #include "SimpleEngineCore/Modules/UIModule.h"
 
+#include <chrono>
 #include <memory>
 
 #include <GLFW/glfw3.h>
 
 namespace SimpleEngine {
 
-	Window::Window(std::string title, const unsigned int width, const unsigned int height)
-		: m_data({ std::move(title), width, height }) {
+	Window::Window(std::string title, const unsigned int width, const unsigned int height, const bool enable_ui_viewports)
+		: m_data({ std::move(title), width, height, width, height }), m_enable_ui_viewports(enable_ui_viewports) {
 
 		int resCode = init();
 	}
@@ -60,19 +61,19 @@ namespace SimpleEngine {
 				case GLFW_PRESS:
 				{
 					EventKeyPressed event(static_cast<KeyCode>(key), false);
-					data.eventCallbackFn(event);
+					send_event(data, event);
 					break;
 				}
 				case GLFW_RELEASE:
 				{
 					EventKeyReleased event(static_cast<KeyCode>(key));
-					data.eventCallbackFn(event);
+					send_event(data, event);
 					break;
 				}
 				case GLFW_REPEAT:
 				{
 					EventKeyPressed event(static_cast<KeyCode>(key), true);
-					data.eventCallbackFn(event);
+					send_event(data, event);
 					break;
 				}
 				}
@@ -95,7 +96,7 @@ namespace SimpleEngine {
 				EventWindowResize event(width, height);
 
 				// actually call our own callback to handle event
-				data.eventCallbackFn(event);
+				send_event(data, event);
 			}
 		);
 
@@ -111,7 +112,7 @@ namespace SimpleEngine {
 				EventMouseMoved event(x, y);
 
 				// actually call our own callback to handle event
-				data.eventCallbackFn(event);
+				send_event(data, event);
 			}
 		);
 
@@ -123,13 +124,21 @@ namespace SimpleEngine {
 				EventWindowClosed event;
 
 				// actually call our own callback to handle event
-				data.eventCallbackFn(event);
+				send_event(data, event);
 			}
 		);
 
+		// viewport is set by renderer from this size, callback may come on thread without OpenGL context
+		int framebuffer_width = 0;
+		int framebuffer_height = 0;
+		glfwGetFramebufferSize(m_pWindow, &framebuffer_width, &framebuffer_height);
+		m_data.framebuffer_width = framebuffer_width;
+		m_data.framebuffer_height = framebuffer_height;
 		glfwSetFramebufferSizeCallback(m_pWindow, [](GLFWwindow* pWindow, int w, int h)
 			{
-				Renderer_OpenGL::set_viewport(w, h);
+				WindowData& data = *(WindowData*)glfwGetWindowUserPointer(pWindow);
+				data.framebuffer_width = w;
+				data.framebuffer_height = h;
 			}
 		);
 
@@ -140,7 +149,7 @@ namespace SimpleEngine {
 
 				EventMouseScroll event(xoffset, yoffset);
 
-				data.eventCallbackFn(event);
+				send_event(data, event);
 			});
 
 		glfwSetMouseButtonCallback(m_pWindow,
@@ -156,29 +165,61 @@ namespace SimpleEngine {
 				case GLFW_PRESS:
 				{
 					EventMouseButtonPressed event(static_cast<MouseButtonCode>(button), x_pos, y_pos);
-					data.eventCallbackFn(event);
+					send_event(data, event);
 					break;
 				}
 				case GLFW_RELEASE:
 				{
 					EventMouseButtonReleased event(static_cast<MouseButtonCode>(button), x_pos, y_pos);
-					data.eventCallbackFn(event);
+					send_event(data, event);
 					break;
 				}
 				}
 			}
 		);
 
-		UIModule::on_window_create(m_pWindow);
+		UIModule::on_window_create(m_pWindow, m_enable_ui_viewports);
 
 		return 0;
 	}
 
+	void Window::send_event(WindowData& data, BaseEvent& event) {
+		// GLFW has no event time, callbacks run inside of glfwPollEvents right after OS delivered events
+		event.timestamp = std::chrono::steady_clock::now();
+		data.eventCallbackFn(event);
+	}
+
 	void Window::on_update() {
+		swap_buffers();
+		poll_events();
+	}
+
+	void Window::swap_buffers() {
 		glfwSwapBuffers(m_pWindow);
+	}
+
+	void Window::poll_events() {
 		glfwPollEvents();
 	}
 
+	void Window::make_context_current() {
+		glfwMakeContextCurrent(m_pWindow);
+	}
+
+	void Window::release_context() {
+		glfwMakeContextCurrent(nullptr);
+	}
+
+	int Window::set_swap_interval(const int interval) {
+		int applied_interval = interval;
+		if (interval < 0 && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+			LOG_WARN("Adaptive vsync is not supported, using vsync");
+			applied_interval = -interval;
+		}
+		glfwSwapInterval(applied_interval);
+		return applied_interval;
+	}
+
 	glm::vec2 Window::get_current_cursor_pos() const {
 		double x_pos;
 		double y_pos;
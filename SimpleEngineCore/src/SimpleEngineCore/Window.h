@@ -1,9 +1,9 @@
 #pragma once
 
 #include "SimpleEngineCore/Event.h"
+#include "SimpleEngineCore/Delegate.h"
 
 #include <string>
-#include <functional>
 #include <glm/ext/vector_float2.hpp>
 
 struct GLFWwindow;
@@ -12,9 +12,9 @@ namespace SimpleEngine {
 
 	class Window {
 	public:
-		using EventCallbackFn = std::function<void(BaseEvent&)>;
+		using EventCallbackFn = Delegate<void(BaseEvent&)>;
 
-		Window(std::string title, const unsigned int width, const unsigned int height);
+		Window(std::string title, const unsigned int width, const unsigned int height, const bool enable_ui_viewports = true);
 		~Window();
 
 		Window(const Window&) = delete;
@@ -23,24 +23,40 @@ namespace SimpleEngine {
 		Window& operator=(Window&&) = delete;
 
 		void on_update();
+		// on_update split for separate render thread: swap on thread with context, events on main thread
+		void swap_buffers();
+		void poll_events();
+		// OpenGL context can be current only on one thread at a time
+		void make_context_current();
+		void release_context();
+		// on thread with current context: 0 - no vsync, 1 - every vblank, negative - adaptive (late frame tears instead of waiting)
+		// adaptive falls back to vsync when driver doesn't support it, returns applied interval
+		int set_swap_interval(const int interval);
 
 		unsigned int get_width() const { return m_data.width; }
 		unsigned int get_height() const { return m_data.height; }
+		unsigned int get_framebuffer_width() const { return m_data.framebuffer_width; }
+		unsigned int get_framebuffer_height() const { return m_data.framebuffer_height; }
 		glm::vec2 get_current_cursor_pos() const;
-		void set_event_callback(const EventCallbackFn& callback) { m_data.eventCallbackFn = callback; }
+		void set_event_callback(EventCallbackFn&& callback) { m_data.eventCallbackFn = std::move(callback); }
 
 	private:
 		struct WindowData {
 			std::string title;
 			unsigned int width;
 			unsigned int height;
+			unsigned int framebuffer_width;
+			unsigned int framebuffer_height;
 			EventCallbackFn eventCallbackFn;
 		};
 
 		int init();
 		void shutdown();
+		// stamps event with current time and passes it to callback
+		static void send_event(WindowData& data, BaseEvent& event);
 
 		GLFWwindow* m_pWindow = nullptr;
 		WindowData m_data;
+		bool m_enable_ui_viewports = true;
 	};
 }
\ No newline at end of file
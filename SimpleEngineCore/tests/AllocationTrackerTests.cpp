@@ -0,0 +1,136 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Event.h"
+#include "SimpleEngineCore/ECS/Components.h"
+#include "SimpleEngineCore/ECS/Systems.h"
+#include "SimpleEngineCore/ECS/World.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Memory/AllocationTracker.h"
+#include "SimpleEngineCore/Rendering/FramePacket.h"
+
+#include <glm/ext/matrix_transform.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace SimpleEngine;
+
+namespace {
+	class NullDrawable : public Drawable {
+	public:
+		void Draw(const DrawContext&, const DrawInstance&) override {}
+	};
+
+	// results of allocations go through it, so compiler can't drop unused malloc and free pairs
+	void* volatile s_sink = nullptr;
+
+	// CPU side of a frame without window and GL: queued input, jobs and draw list of a few thousand entities
+	void test_warm_frames_do_not_allocate()
+	{
+		JobSystem::init();
+		World world;
+		NullDrawable drawable;
+		for (int i = 0; i < 4096; ++i) {
+			TransformComponent transform;
+			transform.model_matrix = glm::translate(glm::mat4(1.f), glm::vec3(5.f + static_cast<float>(i % 64), static_cast<float>(i / 64) - 32.f, 0.f));
+			world.create(std::move(transform), MeshComponent{ &drawable }, MaterialComponent{}, BoundsComponent{ glm::vec3(0.f), glm::vec3(0.5f) });
+		}
+		Camera camera;
+		EventDispatcher dispatcher;
+		double cursor_x = 0.0;
+		int keys = 0;
+		dispatcher.add_event_listener<EventMouseMoved>([&cursor_x](EventMouseMoved& event) { cursor_x = event.x; });
+		dispatcher.add_event_listener<EventKeyPressed>([&keys](EventKeyPressed&) { ++keys; });
+		std::vector<DrawItem> draws;
+		std::vector<float> distances(world.get_entities_count());
+
+		const int warmup_frames = 8;
+		const int test_frames = 64;
+		const uint64_t violations_before = AllocationTracker::get_violations_count();
+		for (int frame = 0; frame < warmup_frames + test_frames; ++frame) {
+			NoAllocScope no_alloc_scope("test_frame", frame >= warmup_frames);
+			for (int i = 0; i < 16; ++i) {
+				dispatcher.queue(EventMouseMoved(static_cast<double>(frame * 16 + i), 0.0));
+			}
+			dispatcher.queue(EventKeyPressed(KeyCode::KEY_A, false));
+			dispatcher.flush();
+			JobSystem::parallel_for(distances.size(), 256, [&distances](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					distances[i] = static_cast<float>(i) * 0.5f;
+				}
+			});
+			camera.set_position(glm::vec3(0.f, 0.f, static_cast<float>(frame % 2) * 0.01f));
+			Systems::build_draw_list(world, camera, 1.f, draws);
+		}
+		CHECK(keys == warmup_frames + test_frames);
+		CHECK(cursor_x == static_cast<double>((warmup_frames + test_frames) * 16 - 1));
+		CHECK(!draws.empty());
+		if (!AllocationTracker::is_enabled()) {
+			std::printf("engine is built without SIMPLE_ENGINE_ALLOCATION_HOOKS, heap calls are not counted\n");
+		}
+		const uint64_t violations = AllocationTracker::get_violations_count() - violations_before;
+		if (violations > 0) {
+			AllocationTracker::report_violations();
+		}
+		CHECK(violations == 0);
+		JobSystem::shutdown();
+	}
+
+	// every way to the heap is counted, not only operator new and malloc
+	void test_aligned_allocations_are_counted()
+	{
+		if (!AllocationTracker::is_enabled()) {
+			return;
+		}
+		const auto count_allocations = [](const auto& allocate) {
+			const AllocationTracker::ThreadCounters before = AllocationTracker::get_thread_counters();
+			void* ptr = allocate();
+			s_sink = ptr;
+			const AllocationTracker::ThreadCounters allocated = AllocationTracker::get_thread_counters();
+			std::free(ptr);
+			CHECK(ptr != nullptr);
+			CHECK(allocated.allocations == before.allocations + 1);
+			CHECK(allocated.allocated_bytes == before.allocated_bytes + 100);
+			CHECK(AllocationTracker::get_thread_counters().frees == before.frees + 1);
+		};
+		count_allocations([]() { return std::malloc(100); });
+		count_allocations([]() { return std::aligned_alloc(64, 100); });
+		count_allocations([]() {
+			void* ptr = nullptr;
+			return posix_memalign(&ptr, 64, 100) == 0 ? ptr : nullptr;
+		});
+#if defined(__GLIBC__)
+		count_allocations([]() { return memalign(64, 100); });
+#endif
+
+		// aligned new goes to posix_memalign, counted once
+		const AllocationTracker::ThreadCounters before = AllocationTracker::get_thread_counters();
+		void* ptr = ::operator new(100, std::align_val_t(64));
+		s_sink = ptr;
+		CHECK(AllocationTracker::get_thread_counters().allocations == before.allocations + 1);
+		::operator delete(ptr, std::align_val_t(64));
+
+		const uint64_t violations_before = AllocationTracker::get_violations_count();
+		{
+			NoAllocScope no_alloc_scope("test_aligned_alloc");
+			s_sink = std::aligned_alloc(64, 100);
+		}
+		CHECK(AllocationTracker::get_violations_count() == violations_before + 1);
+		std::free(s_sink);
+	}
+}
+
+int main()
+{
+	AllocationTracker::init();
+	test_warm_frames_do_not_allocate();
+	test_aligned_allocations_are_counted();
+	return Tests::get_test_result();
+}
@@ -0,0 +1,190 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Assets/AssetCooker.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	const std::filesystem::path s_directories[] = { "shaders", "textures", "models", "worlds" };
+
+	void write_file(const std::filesystem::path& path, const std::string& text)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	std::string read_file(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// 2x2 24 bit bmp, stb decodes it without any other library
+	std::string make_bmp()
+	{
+		const uint8_t header[54] = {
+			'B', 'M', 70, 0, 0, 0, 0, 0, 0, 0, 54, 0, 0, 0,
+			40, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 1, 0, 24, 0, 0, 0, 0, 0, 16, 0, 0, 0,
+			0x13, 0x0B, 0, 0, 0x13, 0x0B, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		};
+		// rows are padded to 4 bytes
+		const uint8_t pixels[16] = { 0, 0, 255, 0, 255, 0, 0, 0, 255, 0, 0, 255, 255, 255, 0, 0 };
+		return std::string(reinterpret_cast<const char*>(header), sizeof(header)) +
+			std::string(reinterpret_cast<const char*>(pixels), sizeof(pixels));
+	}
+
+	struct Project {
+		std::filesystem::path root;
+		std::filesystem::path output;
+
+		AssetCooker::Stats cook(const AssetCooker::Settings& settings = AssetCooker::Settings()) const {
+			AssetCooker::Stats stats;
+			CHECK(AssetCooker::cook(root, std::vector<std::filesystem::path>(std::begin(s_directories), std::end(s_directories)),
+				output, settings, &stats));
+			return stats;
+		}
+
+		// source path -> cooked path lines
+		int count_manifest_lines() const {
+			const std::string manifest = read_file(output / AssetCooker::s_manifest_name);
+			int count = 0;
+			for (const char c : manifest) {
+				count += c == '\t' ? 1 : 0;
+			}
+			return count;
+		}
+	};
+
+	Project make_project(const std::filesystem::path& directory)
+	{
+		Project project;
+		project.root = directory;
+		project.output = directory / "cooked";
+		write_file(directory / "shaders/a.vert", "#version 330 core\n// comment\nvoid main() {}\n");
+		write_file(directory / "shaders/b.frag", "#version 330 core\n/* comment */\nvoid main() {}\n");
+		write_file(directory / "textures/t.bmp", make_bmp());
+		// material file is not an asset, it is a dependency of the model
+		write_file(directory / "models/tri.obj", "mtllib tri.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl red\nf 1 2 3\n");
+		write_file(directory / "models/tri.mtl", "newmtl red\nKd 1 0 0\n");
+		write_file(directory / "worlds/w.world", "model models/tri.obj shaders/a.vert shaders/b.frag\nobject 0 0 0 0\n");
+		return project;
+	}
+
+	void test_incremental_cook(const std::filesystem::path& directory)
+	{
+		const Project project = make_project(directory);
+
+		// the first cook makes everything
+		AssetCooker::Stats stats = project.cook();
+		CHECK(stats.assets == 5);
+		CHECK(stats.cooked == 5);
+		CHECK(stats.failed == 0);
+		CHECK(project.count_manifest_lines() == 5);
+		CHECK(read_file(project.output / "shaders/a.vert").find("comment") == std::string::npos);
+		CHECK(std::filesystem::is_regular_file(project.output / "models/tri.obj.mesh"));
+		CHECK(std::filesystem::is_regular_file(project.output / "worlds/w.world.cells"));
+
+		// nothing changed: nothing is read or written
+		const auto state_time = std::filesystem::last_write_time(project.output / "cook_state.txt");
+		stats = project.cook();
+		CHECK(stats.cooked == 0);
+		CHECK(stats.up_to_date == 5);
+		CHECK(stats.hashed_files == 0);
+		CHECK(std::filesystem::last_write_time(project.output / "cook_state.txt") == state_time);
+
+		// the same content with other write time is hashed, but not cooked again
+		const std::filesystem::path touched = directory / "shaders/a.vert";
+		std::filesystem::last_write_time(touched, std::filesystem::last_write_time(touched) + std::chrono::seconds(10));
+		stats = project.cook();
+		CHECK(stats.hashed_files == 1);
+		CHECK(stats.cooked == 0);
+
+		// settings are a part of cook key, only assets which use them are cooked again
+		AssetCooker::Settings keep_comments;
+		keep_comments.strip_shader_comments = false;
+		stats = project.cook(keep_comments);
+		CHECK(stats.cooked == 2);
+		CHECK(stats.up_to_date == 3);
+		CHECK(read_file(project.output / "shaders/a.vert").find("comment") != std::string::npos);
+		stats = project.cook(keep_comments);
+		CHECK(stats.cooked == 0);
+		stats = project.cook();
+		CHECK(stats.cooked == 2);
+
+		// dependency found while cooking: changed material cooks the model which reads it
+		write_file(directory / "models/tri.mtl", "newmtl red\nKd 1 0.5 0\n");
+		stats = project.cook();
+		CHECK(stats.cooked == 1);
+		CHECK(stats.up_to_date == 4);
+		CHECK(stats.hashed_files == 1);
+
+		// removed source takes its cooked file and manifest line with it
+		std::filesystem::remove(directory / "shaders/b.frag");
+		stats = project.cook();
+		CHECK(stats.assets == 4);
+		CHECK(stats.removed == 1);
+		CHECK(stats.cooked == 0);
+		CHECK(!std::filesystem::exists(project.output / "shaders/b.frag"));
+		CHECK(project.count_manifest_lines() == 4);
+		CHECK(read_file(project.output / AssetCooker::s_manifest_name).find("b.frag") == std::string::npos);
+
+		// cooked file deleted by hand is made again
+		std::filesystem::remove(project.output / "textures/t.bmp.tex");
+		stats = project.cook();
+		CHECK(stats.cooked == 1);
+		CHECK(std::filesystem::is_regular_file(project.output / "textures/t.bmp.tex"));
+	}
+
+	void test_failed_asset(const std::filesystem::path& directory)
+	{
+		const Project project = make_project(directory);
+		write_file(directory / "textures/broken.png", "not a png");
+		AssetCooker::Stats stats = project.cook();
+		CHECK(stats.assets == 6);
+		CHECK(stats.cooked == 5);
+		CHECK(stats.failed == 1);
+		CHECK(project.count_manifest_lines() == 5);
+
+		// failed asset is not tried again until its source changes
+		stats = project.cook();
+		CHECK(stats.cooked == 0);
+		CHECK(stats.failed == 1);
+		write_file(directory / "textures/broken.png", "still not a png");
+		stats = project.cook();
+		CHECK(stats.cooked == 0);
+		CHECK(stats.failed == 1);
+		CHECK(stats.hashed_files == 1);
+
+		// with decoding off the same bytes are copied as they are
+		AssetCooker::Settings copy_textures;
+		copy_textures.decode_textures = false;
+		stats = project.cook(copy_textures);
+		CHECK(stats.cooked == 2);
+		CHECK(stats.failed == 0);
+		CHECK(read_file(project.output / "textures/broken.png.tex") == "still not a png");
+	}
+}
+
+int main()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "simple_engine_cooker_tests";
+	std::filesystem::remove_all(directory);
+
+	JobSystem::init();
+	test_incremental_cook(directory / "incremental");
+	test_failed_asset(directory / "failed");
+	JobSystem::shutdown();
+
+	std::filesystem::remove_all(directory);
+	return Tests::get_test_result();
+}
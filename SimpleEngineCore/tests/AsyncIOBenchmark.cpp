@@ -0,0 +1,184 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/IO/AsyncIO.h"
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace SimpleEngine;
+
+namespace {
+	struct FileSet {
+		const char* name = "";
+		std::vector<std::filesystem::path> paths;
+		uint64_t bytes = 0;
+		uint64_t checksum = 0;
+	};
+
+	// the same work on read bytes for every path, so the difference is only in how they are read
+	uint64_t get_checksum(const uint8_t* data, const size_t size)
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i + 8 <= size; i += 8) {
+			uint64_t word;
+			std::memcpy(&word, data + i, 8);
+			sum += word;
+		}
+		return sum;
+	}
+
+	FileSet write_files(const std::filesystem::path& directory, const char* name, const size_t count, const size_t size)
+	{
+		FileSet set;
+		set.name = name;
+		std::vector<uint8_t> bytes(size);
+		uint32_t random = 1;
+		for (size_t i = 0; i < count; ++i) {
+			for (uint8_t& byte : bytes) {
+				random = random * 1664525u + 1013904223u;
+				byte = static_cast<uint8_t>(random >> 24);
+			}
+			set.paths.push_back(directory / (std::string(name) + std::to_string(i) + ".bin"));
+			std::ofstream file(set.paths.back(), std::ios::binary);
+			file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+			set.bytes += size;
+			set.checksum += get_checksum(bytes.data(), bytes.size());
+		}
+		return set;
+	}
+
+	// cold reads go to disk, where page cache can't be dropped (tmpfs, other systems) they are the same as warm ones
+	void drop_cache(const FileSet& set)
+	{
+#if defined(__linux__)
+		for (const std::filesystem::path& path : set.paths) {
+			const int fd = open(path.c_str(), O_RDONLY);
+			if (fd >= 0) {
+				fdatasync(fd);
+				posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+				close(fd);
+			}
+		}
+#else
+		(void)set;
+#endif
+	}
+
+	struct Totals {
+		std::atomic<uint64_t> bytes{ 0 };
+		std::atomic<uint64_t> checksum{ 0 };
+		std::atomic<uint64_t> failed{ 0 };
+	};
+
+	void read_sequential(const FileSet& set, Totals& totals)
+	{
+		FileData data;
+		for (const std::filesystem::path& path : set.paths) {
+			if (!FileSystem::read(path, data)) {
+				totals.failed.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			totals.bytes.fetch_add(data.size(), std::memory_order_relaxed);
+			totals.checksum.fetch_add(get_checksum(data.data(), data.size()), std::memory_order_relaxed);
+		}
+	}
+
+	// every read is queued at once, checksum runs as completion job while other reads are in flight
+	void read_async(const FileSet& set, Totals& totals)
+	{
+		JobCounter counter;
+		for (const std::filesystem::path& path : set.paths) {
+			AsyncIO::read(path, IoPriority::Normal, [](const IoStatus status, FileData& data, void* user_data) {
+				Totals& totals = *static_cast<Totals*>(user_data);
+				if (status != IoStatus::Done) {
+					totals.failed.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				totals.bytes.fetch_add(data.size(), std::memory_order_relaxed);
+				totals.checksum.fetch_add(get_checksum(data.data(), data.size()), std::memory_order_relaxed);
+				data.reset();	// registered buffer goes back to pool
+			}, &totals, &counter);
+		}
+		JobSystem::wait(counter);
+	}
+
+	template<typename F>
+	void measure(const FileSet& set, const char* method, const bool cold, const F& read)
+	{
+		double best_ms = 1e30;
+		for (int run = 0; run < 3; ++run) {
+			if (cold) {
+				drop_cache(set);
+			}
+			Totals totals;
+			const auto start = std::chrono::steady_clock::now();
+			read(set, totals);
+			best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			CHECK(totals.failed.load() == 0);
+			CHECK(totals.bytes.load() == set.bytes);
+			CHECK(totals.checksum.load() == set.checksum);
+		}
+		const std::string label = std::string(set.name) + ", " + method + (cold ? ", cold" : ", warm");
+		std::printf("%-40s %8.1f MB/s %9.0f files/s\n", label.c_str(),
+			static_cast<double>(set.bytes) / (1024.0 * 1024.0) / (best_ms / 1000.0),
+			static_cast<double>(set.paths.size()) / (best_ms / 1000.0));
+	}
+
+	void measure_all(const std::vector<FileSet>& sets, const char* method, const bool cold)
+	{
+		for (const FileSet& set : sets) {
+			if (AsyncIO::is_initialized()) {
+				measure(set, method, cold, read_async);
+			}
+			else {
+				measure(set, method, cold, read_sequential);
+			}
+		}
+	}
+}
+
+// whole file reads of many small files (models, textures of a streamed cell) and of a few big ones
+int main()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "simple_engine_io_benchmark";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	std::vector<FileSet> sets;
+	sets.push_back(write_files(directory, "512 x 16 KB", 512, 16 * 1024));
+	sets.push_back(write_files(directory, "16 x 4 MB", 16, 4 * 1024 * 1024));
+
+	JobSystem::init();
+	for (const bool cold : { false, true }) {
+		measure_all(sets, "sequential", cold);
+
+		AsyncIO::init();
+		const bool has_io_uring = AsyncIO::get_backend() == AsyncIO::Backend::IoUring;
+		measure_all(sets, AsyncIO::get_backend_name(AsyncIO::get_backend()), cold);
+		AsyncIO::shutdown();
+
+		if (has_io_uring) {
+			AsyncIO::Settings settings;
+			settings.use_io_uring = false;
+			AsyncIO::init(settings);
+			measure_all(sets, AsyncIO::get_backend_name(AsyncIO::get_backend()), cold);
+			AsyncIO::shutdown();
+		}
+	}
+	JobSystem::shutdown();
+
+	std::filesystem::remove_all(directory);
+	return Tests::get_test_result();
+}
@@ -0,0 +1,85 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+#include "SimpleEngineCore/Rendering/ClusteredLighting.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// point and spot lights scattered in front of camera, a part of them is out of view
+	std::vector<ClusterLight> make_lights(const size_t count)
+	{
+		std::vector<ClusterLight> lights;
+		uint32_t random = 1;
+		const auto next = [&random](const float min, const float max) {
+			random = random * 1664525u + 1013904223u;
+			return min + (max - min) * static_cast<float>(random >> 8) / static_cast<float>(1u << 24);
+		};
+		for (size_t i = 0; i < count; ++i) {
+			const glm::vec3 position(next(1.f, 100.f), next(-50.f, 50.f), next(-10.f, 10.f));
+			// range of about 10 units, so a light touches a few tiles of a few slices
+			if (i % 4 == 3) {
+				const SpotLight light(position, glm::vec3(next(-1.f, 1.f), next(-1.f, 1.f), -1.f),
+					glm::vec3(1.f), glm::vec3(1.f), glm::vec3(1.f), 0.1f, 0.4f, 0.6f, 1.f, 0.2f, 1.5f, 30.f);
+				lights.push_back(ClusterLight::from_spot_light(light));
+			}
+			else {
+				const PointLight light(position, glm::vec3(1.f), glm::vec3(1.f), glm::vec3(1.f), 0.1f, 0.4f, 0.6f, 1.f, 0.2f, 1.5f);
+				lights.push_back(ClusterLight::from_point_light(light));
+			}
+		}
+		return lights;
+	}
+}
+
+// CPU side of clustered shading: lights to view space and sphere/cone tests against every cluster
+// this runs on main thread every frame, GPU shading cost needs a context and is shown by the editor
+int main()
+{
+	JobSystem::init();
+	Camera camera(glm::vec3(0.f, 0.f, 1.7f));
+	camera.set_viewport_size(1920.f, 1080.f);
+	camera.get_updated_view_matrix();
+
+	std::printf("lights  assign ms (scalar/best)  lights per cluster (avg/max)\n");
+	for (const size_t lights_count : { size_t(10), size_t(100), size_t(1000) }) {
+		const std::vector<ClusterLight> lights = make_lights(lights_count);
+		ClusterLightAssigner assigner;
+		ClusterGrid grid;
+		ClusterLightLists lists;
+
+		SimdMath::set_isa(SimdMath::Isa::Scalar);
+		const double scalar_ms = Tests::measure_ms(20, [&]() { assigner.assign(camera, 1920, 1080, lights, grid, lists); });
+		const ClusterLightLists scalar_lists = lists;
+		SimdMath::set_isa(SimdMath::get_best_supported_isa());
+		const double best_ms = Tests::measure_ms(20, [&]() { assigner.assign(camera, 1920, 1080, lights, grid, lists); });
+
+		// every ISA gives the same lists, and they point inside of lights and indices
+		CHECK(lists.ranges == scalar_lists.ranges);
+		CHECK(lists.indices == scalar_lists.indices);
+		CHECK(lists.ranges.size() == ClusterGrid::s_clusters_count * 2);
+		CHECK(!lists.indices.empty());
+		uint32_t max_lights = 0;
+		for (uint32_t cluster = 0; cluster < ClusterGrid::s_clusters_count; ++cluster) {
+			const uint32_t offset = lists.ranges[cluster * 2];
+			const uint32_t count = lists.ranges[cluster * 2 + 1];
+			CHECK(offset + count <= lists.indices.size());
+			max_lights = std::max(max_lights, count);
+		}
+		for (const uint32_t index : lists.indices) {
+			CHECK(index < lights_count);
+		}
+		std::printf("%6zu  %8.3f / %8.3f           %6.2f / %u\n", lights_count, scalar_ms, best_ms,
+			static_cast<double>(lists.indices.size()) / ClusterGrid::s_clusters_count, max_lights);
+	}
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
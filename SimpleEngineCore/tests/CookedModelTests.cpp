@@ -0,0 +1,143 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Assets/CookedFormats.h"
+#include "SimpleEngineCore/Rendering/MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+
+#include <cstring>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// flat grid of quads with normal up, enough triangles for a few levels
+	void make_grid(const uint32_t size, std::vector<float>& vertices, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+	{
+		for (uint32_t y = 0; y <= size; ++y) {
+			for (uint32_t x = 0; x <= size; ++x) {
+				// a little bump so simplifier has some error to report
+				const float z = 0.1f * std::sin(static_cast<float>(x) * 0.3f) * std::cos(static_cast<float>(y) * 0.3f);
+				positions.emplace_back(static_cast<float>(x), static_cast<float>(y), z);
+				vertices.insert(vertices.end(), { static_cast<float>(x), static_cast<float>(y), z, 0.f, 0.f, 1.f,
+					static_cast<float>(x) / size, static_cast<float>(y) / size });
+			}
+		}
+		for (uint32_t y = 0; y < size; ++y) {
+			for (uint32_t x = 0; x < size; ++x) {
+				const uint32_t a = y * (size + 1) + x;
+				const uint32_t b = a + size + 1;
+				indices.insert(indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+			}
+		}
+	}
+
+	// model of one grid mesh, as AssetCooker writes it
+	struct CookedGrid {
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<CookedMeshLod> lods;
+		std::vector<uint8_t> bytes;
+	};
+
+	CookedGrid cook_grid()
+	{
+		CookedGrid grid;
+		std::vector<glm::vec3> positions;
+		make_grid(32, grid.vertices, positions, grid.indices);
+		for (const LodLevel& lod : generate_lod_chain(positions, grid.indices, LodSettings())) {
+			grid.lods.push_back(CookedMeshLod{ lod.first_index, lod.index_count, lod.error });
+		}
+
+		CookedModelHeader header;
+		header.meshes_count = 1;
+		grid.bytes.assign(reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header + 1));
+		CookedMeshView mesh;
+		mesh.vertices = reinterpret_cast<const uint8_t*>(grid.vertices.data());
+		mesh.vertices_count = static_cast<uint32_t>(grid.vertices.size() / 8);
+		mesh.indices = reinterpret_cast<const uint8_t*>(grid.indices.data());
+		mesh.indices_count = static_cast<uint32_t>(grid.indices.size());
+		mesh.lods = reinterpret_cast<const uint8_t*>(grid.lods.data());
+		mesh.lods_count = static_cast<uint32_t>(grid.lods.size());
+		write_cooked_mesh(mesh, grid.bytes);
+		return grid;
+	}
+
+	void test_lods_round_trip()
+	{
+		const CookedGrid grid = cook_grid();
+		CHECK(grid.lods.size() > 1);
+		CHECK(grid.bytes.size() % 4 == 0);
+		CHECK(is_cooked_model(grid.bytes.data(), grid.bytes.size()));
+
+		std::vector<CookedMeshView> meshes;
+		CHECK(read_cooked_model(grid.bytes.data(), grid.bytes.size(), meshes));
+		CHECK(meshes.size() == 1);
+		if (meshes.size() != 1) {
+			return;
+		}
+		const CookedMeshView& mesh = meshes[0];
+		CHECK(mesh.vertices_count * 8 == grid.vertices.size());
+		CHECK(mesh.indices_count == grid.indices.size());
+		CHECK(std::memcmp(mesh.vertices, grid.vertices.data(), grid.vertices.size() * sizeof(float)) == 0);
+		CHECK(std::memcmp(mesh.indices, grid.indices.data(), grid.indices.size() * sizeof(uint32_t)) == 0);
+		CHECK(mesh.lods_count == grid.lods.size());
+		for (uint32_t i = 0; i < mesh.lods_count && i < grid.lods.size(); ++i) {
+			CookedMeshLod lod;
+			std::memcpy(&lod, mesh.lods + i * sizeof(lod), sizeof(lod));
+			CHECK(lod.first_index == grid.lods[i].first_index);
+			CHECK(lod.index_count == grid.lods[i].index_count);
+			CHECK(lod.error == grid.lods[i].error);
+		}
+		// levels follow one another, coarser ones have fewer triangles and bigger error
+		for (size_t i = 1; i < grid.lods.size(); ++i) {
+			CHECK(grid.lods[i].first_index == grid.lods[i - 1].first_index + grid.lods[i - 1].index_count);
+			CHECK(grid.lods[i].index_count < grid.lods[i - 1].index_count);
+			CHECK(grid.lods[i].error >= grid.lods[i - 1].error);
+		}
+	}
+
+	void test_damaged_model_is_rejected()
+	{
+		const CookedGrid grid = cook_grid();
+		std::vector<CookedMeshView> meshes;
+		// cuts every 7 bytes, none reads out of bounds (run under ASan)
+		int accepted = 0;
+		for (size_t size = 0; size < grid.bytes.size(); size += 7) {
+			const std::vector<uint8_t> cut(grid.bytes.begin(), grid.bytes.begin() + size);
+			accepted += read_cooked_model(cut.data(), cut.size(), meshes) ? 1 : 0;
+		}
+		CHECK(accepted == 0);
+		CHECK(meshes.empty());
+
+		// level which is not inside of indices
+		const size_t lods_offset = grid.bytes.size() - grid.lods.size() * sizeof(CookedMeshLod);
+		const auto rejects_lod = [&grid, lods_offset](const CookedMeshLod& lod) {
+			std::vector<uint8_t> damaged = grid.bytes;
+			std::memcpy(damaged.data() + lods_offset + sizeof(CookedMeshLod), &lod, sizeof(lod));
+			std::vector<CookedMeshView> meshes;
+			return !read_cooked_model(damaged.data(), damaged.size(), meshes) && meshes.empty();
+		};
+		const uint32_t indices_count = static_cast<uint32_t>(grid.indices.size());
+		CHECK(rejects_lod(CookedMeshLod{ indices_count + 3, 0, 0.f }));
+		CHECK(rejects_lod(CookedMeshLod{ indices_count - 3, 6, 0.f }));
+		CHECK(rejects_lod(CookedMeshLod{ 3, 0xFFFFFFFFu, 0.f }));
+		CHECK(!rejects_lod(CookedMeshLod{ indices_count - 3, 3, 0.f }));
+
+		// model of the first version has no levels, cooker makes it again
+		std::vector<uint8_t> old_version = grid.bytes;
+		CookedModelHeader header;
+		std::memcpy(&header, old_version.data(), sizeof(header));
+		header.version = 1;
+		std::memcpy(old_version.data(), &header, sizeof(header));
+		CHECK(is_cooked_model(old_version.data(), old_version.size()));
+		CHECK(!read_cooked_model(old_version.data(), old_version.size(), meshes));
+	}
+}
+
+int main()
+{
+	test_lods_round_trip();
+	test_damaged_model_is_rejected();
+	return Tests::get_test_result();
+}
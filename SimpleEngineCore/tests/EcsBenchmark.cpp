@@ -0,0 +1,86 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/ECS/World.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	struct Transform { glm::mat4 model_matrix{ 1.f }; };
+	struct Velocity { glm::vec3 value{ 0.f }; };
+
+	// what the engine had before: every object on the heap with everything in it
+	struct GameObject {
+		glm::mat4 model_matrix{ 1.f };
+		glm::vec3 velocity{ 0.f };
+		char other_state[192] = {};
+	};
+}
+
+// 1M entities with transform + velocity
+int main()
+{
+	JobSystem::init();
+	std::printf("%u threads\n", JobSystem::get_threads_count());
+	const size_t entities_count = 1000000;
+	const float dt = 0.016f;
+
+	std::vector<Entity> entities;
+	entities.reserve(entities_count);
+	std::unique_ptr<World> world;
+	const double spawn_ms = Tests::measure_ms(3, [&]() {
+		world = std::make_unique<World>();
+		entities.clear();
+		for (size_t i = 0; i < entities_count; ++i) {
+			entities.push_back(world->create(Transform{}, Velocity{ glm::vec3(1.f, 0.f, 0.f) }));
+		}
+	});
+	CHECK(world->get_entities_count() == entities_count);
+
+	const double for_each_ms = Tests::measure_ms(10, [&]() {
+		world->for_each<Transform, Velocity>([dt](Entity, Transform& transform, const Velocity& velocity) {
+			transform.model_matrix[3] += glm::vec4(velocity.value * dt, 0.f);
+		});
+	});
+	const double parallel_ms = Tests::measure_ms(10, [&]() {
+		world->parallel_for_each<Transform, Velocity>([dt](Entity, Transform& transform, const Velocity& velocity) {
+			transform.model_matrix[3] += glm::vec4(velocity.value * dt, 0.f);
+		});
+	});
+
+	std::vector<std::unique_ptr<GameObject>> objects;
+	for (size_t i = 0; i < entities_count; ++i) {
+		objects.push_back(std::make_unique<GameObject>());
+		objects.back()->velocity = glm::vec3(1.f, 0.f, 0.f);
+	}
+	const double objects_ms = Tests::measure_ms(10, [&]() {
+		for (const std::unique_ptr<GameObject>& object : objects) {
+			object->model_matrix[3] += glm::vec4(object->velocity * dt, 0.f);
+		}
+	});
+
+	// every other entity, holes are filled by the last rows
+	const auto despawn_start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < entities_count; i += 2) {
+		world->destroy(entities[i]);
+	}
+	const double despawn_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - despawn_start).count();
+	CHECK(world->get_entities_count() == entities_count / 2);
+	CHECK(world->count<Transform, Velocity>() == entities_count / 2);
+
+	std::printf("spawn 1M: %.1f ms\n", spawn_ms);
+	std::printf("for_each: %.2f ms\n", for_each_ms);
+	std::printf("parallel_for_each: %.2f ms\n", parallel_ms);
+	std::printf("heap objects loop (old layout): %.2f ms\n", objects_ms);
+	std::printf("despawn 500k: %.1f ms\n", despawn_ms);
+
+	world.reset();
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
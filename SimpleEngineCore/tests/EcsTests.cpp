@@ -0,0 +1,120 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/ECS/World.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	struct Position { float x = 0.f, y = 0.f, z = 0.f; };
+	struct Velocity { float x = 0.f, y = 0.f, z = 0.f; };
+	// not trivially movable, entity moves between archetypes have to move it properly
+	struct Name { std::string value; };
+
+	void test_create_get_destroy()
+	{
+		World world;
+		const Entity a = world.create(Position{ 1.f, 2.f, 3.f }, Velocity{ 1.f, 0.f, 0.f });
+		const Entity b = world.create(Position{ 4.f, 5.f, 6.f });
+		CHECK(world.get_entities_count() == 2);
+		CHECK(world.get_archetypes_count() == 2);
+		CHECK(world.get<Position>(a)->y == 2.f);
+		CHECK(world.get<Velocity>(b) == nullptr);
+		CHECK(world.has<Velocity>(a));
+		CHECK(world.count<Position>() == 2);
+		CHECK(world.count<Position, Velocity>() == 1);
+
+		world.destroy(a);
+		CHECK(!world.is_alive(a));
+		CHECK(world.get<Position>(a) == nullptr);
+		CHECK(world.get<Position>(b)->z == 6.f);
+
+		// index is reused with new generation, old handle stays dead
+		const Entity c = world.create(Position{ 7.f, 8.f, 9.f });
+		CHECK(c.index == a.index);
+		CHECK(!world.is_alive(a));
+		CHECK(world.get<Position>(c)->x == 7.f);
+	}
+
+	void test_add_remove_moves_between_archetypes()
+	{
+		World world;
+		std::vector<Entity> entities;
+		for (int i = 0; i < 2000; ++i) {
+			entities.push_back(world.create(Position{ static_cast<float>(i), 0.f, 0.f }, Name{ "entity " + std::to_string(i) }));
+		}
+		for (int i = 0; i < 2000; i += 2) {
+			world.add(entities[i], Velocity{ 0.f, static_cast<float>(i), 0.f });
+		}
+		for (int i = 0; i < 2000; i += 3) {
+			world.remove<Name>(entities[i]);
+		}
+		for (int i = 0; i < 2000; i += 5) {
+			world.destroy(entities[i]);
+		}
+
+		size_t wrong = 0;
+		for (int i = 0; i < 2000; ++i) {
+			const Entity entity = entities[i];
+			if (i % 5 == 0) {
+				wrong += world.is_alive(entity) ? 1 : 0;
+				continue;
+			}
+			wrong += world.get<Position>(entity)->x != static_cast<float>(i) ? 1 : 0;
+			wrong += world.has<Velocity>(entity) != (i % 2 == 0) ? 1 : 0;
+			if (i % 2 == 0) {
+				wrong += world.get<Velocity>(entity)->y != static_cast<float>(i) ? 1 : 0;
+			}
+			const Name* name = world.get<Name>(entity);
+			wrong += (name != nullptr) != (i % 3 != 0) ? 1 : 0;
+			if (name) {
+				wrong += name->value != "entity " + std::to_string(i) ? 1 : 0;
+			}
+		}
+		CHECK(wrong == 0);
+		CHECK(world.get_entities_count() == 1600);
+	}
+
+	void test_queries_visit_every_entity_once()
+	{
+		World world;
+		for (int i = 0; i < 50000; ++i) {
+			if (i % 4 == 0) {
+				world.create(Position{}, Velocity{ 1.f, 0.f, 0.f }, Name{});
+			}
+			else {
+				world.create(Position{}, Velocity{ 1.f, 0.f, 0.f });
+			}
+		}
+		world.create(Position{});
+
+		world.for_each<Position, Velocity>([](Entity, Position& position, Velocity& velocity) { position.x += velocity.x; });
+		world.parallel_for_each<Position, Velocity>([](Entity, Position& position, Velocity& velocity) { position.x += velocity.x; });
+		std::atomic<size_t> visited{ 0 };
+		world.parallel_for_each_chunk<Position>([&visited](const size_t, const size_t count, const Entity*, Position*) {
+			visited.fetch_add(count, std::memory_order_relaxed);
+		});
+		CHECK(visited.load() == 50001);
+
+		size_t wrong = 0;
+		world.for_each<Position>([&world, &wrong](const Entity entity, Position& position) {
+			const float expected = world.has<Velocity>(entity) ? 2.f : 0.f;
+			wrong += position.x != expected ? 1 : 0;
+		});
+		CHECK(wrong == 0);
+	}
+}
+
+int main()
+{
+	JobSystem::init();
+	test_create_get_destroy();
+	test_add_remove_moves_between_archetypes();
+	test_queries_visit_every_entity_once();
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
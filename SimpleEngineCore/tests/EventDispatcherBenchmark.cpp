@@ -0,0 +1,92 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Event.h"
+
+#include <cstdio>
+#include <functional>
+
+using namespace SimpleEngine;
+
+namespace {
+	// what EventDispatcher was before: one std::function per event type
+	class FunctionDispatcher {
+	public:
+		template<typename TEvent>
+		void add_event_listener(std::function<void(TEvent&)> callback) {
+			m_callbacks[static_cast<size_t>(TEvent::type)] = [callback = std::move(callback)](BaseEvent& event) {
+				callback(static_cast<TEvent&>(event));
+			};
+		}
+
+		void dispatch(BaseEvent& event) {
+			const auto& callback = m_callbacks[static_cast<size_t>(event.get_type())];
+			if (callback) {
+				callback(event);
+			}
+		}
+
+	private:
+		std::array<std::function<void(BaseEvent&)>, static_cast<size_t>(EventType::EventsCount)> m_callbacks;
+	};
+
+	constexpr int s_events_count = 10000000;
+
+	void print(const char* name, const double ms)
+	{
+		std::printf("%-36s %6.2f ns/event\n", name, ms * 1e6 / s_events_count);
+	}
+}
+
+// one listener, 10M events
+int main()
+{
+	volatile double sink = 0.0;
+
+	FunctionDispatcher old_dispatcher;
+	old_dispatcher.add_event_listener<EventMouseMoved>([&sink](EventMouseMoved& event) { sink = sink + event.x; });
+	EventMouseMoved moved(1.0, 2.0);
+	print("std::function dispatch (old)", Tests::measure_ms(3, [&]() {
+		for (int i = 0; i < s_events_count; ++i) {
+			old_dispatcher.dispatch(moved);
+		}
+	}));
+
+	EventDispatcher dispatcher;
+	dispatcher.add_event_listener<EventMouseMoved>([&sink](EventMouseMoved& event) { sink = sink + event.x; });
+	dispatcher.add_event_listener<EventKeyPressed>([&sink](EventKeyPressed& event) { sink = sink + static_cast<int>(event.key_code); });
+	print("dispatch (BaseEvent&)", Tests::measure_ms(3, [&]() {
+		for (int i = 0; i < s_events_count; ++i) {
+			dispatcher.dispatch(static_cast<BaseEvent&>(moved));
+		}
+	}));
+	print("dispatch (typed)", Tests::measure_ms(3, [&]() {
+		for (int i = 0; i < s_events_count; ++i) {
+			dispatcher.dispatch(moved);
+		}
+	}));
+
+	// a frame worth of events, then flush
+	const int batch = 64;
+	const uint64_t dispatched_before = dispatcher.get_stats().dispatched;
+	print("queue + flush, mouse moves", Tests::measure_ms(3, [&]() {
+		for (int i = 0; i < s_events_count; i += batch) {
+			for (int j = 0; j < batch; ++j) {
+				dispatcher.queue(EventMouseMoved(static_cast<double>(j), 0.0));
+			}
+			dispatcher.flush();
+		}
+	}));
+	// moves of one frame are one dispatch, measure_ms runs 4 times
+	CHECK(dispatcher.get_stats().dispatched - dispatched_before == static_cast<uint64_t>(4 * (s_events_count / batch)));
+
+	print("queue + flush, key events", Tests::measure_ms(3, [&]() {
+		for (int i = 0; i < s_events_count; i += batch) {
+			for (int j = 0; j < batch; ++j) {
+				dispatcher.queue(EventKeyPressed(KeyCode::KEY_A, false));
+			}
+			dispatcher.flush();
+		}
+	}));
+	CHECK(dispatcher.get_queued_count() == 0);
+	return Tests::get_test_result();
+}
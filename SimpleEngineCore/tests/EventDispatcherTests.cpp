@@ -0,0 +1,181 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Event.h"
+
+#include <string>
+#include <utility>
+
+using namespace SimpleEngine;
+
+namespace {
+	void test_priorities_and_handled()
+	{
+		EventDispatcher dispatcher;
+		std::string order;
+		dispatcher.add_event_listener<EventKeyPressed>([&order](EventKeyPressed&) { order += "b"; }, 1);
+		dispatcher.add_event_listener<EventKeyPressed>([&order](EventKeyPressed&) { order += "a"; }, 5);
+		dispatcher.add_event_listener<EventKeyPressed>([&order](EventKeyPressed&) { order += "c"; }, 1);
+		dispatcher.add_event_listener<EventKeyPressed>([&order](EventKeyPressed& event) {
+			order += "d";
+			event.handled = event.key_code == KeyCode::KEY_B;
+		}, 0);
+		dispatcher.add_event_listener<EventKeyPressed>([&order](EventKeyPressed&) { order += "e"; }, -1);
+
+		EventKeyPressed a(KeyCode::KEY_A, false);
+		dispatcher.dispatch(a);
+		CHECK(order == "abcde");
+
+		// handled stops listeners with lower priority, also through BaseEvent&
+		order.clear();
+		EventKeyPressed b(KeyCode::KEY_B, false);
+		dispatcher.dispatch(static_cast<BaseEvent&>(b));
+		CHECK(order == "abcd");
+	}
+
+	void test_remove_listeners()
+	{
+		EventDispatcher dispatcher;
+		int first = 0;
+		int second = 0;
+		EventDispatcher::ListenerHandle second_handle = 0;
+		const EventDispatcher::ListenerHandle first_handle = dispatcher.add_event_listener<EventMouseMoved>(
+			[&](EventMouseMoved&) {
+				++first;
+				// removing other listener during dispatch skips it already in this dispatch
+				dispatcher.remove_event_listener(second_handle);
+			}, 1);
+		second_handle = dispatcher.add_event_listener<EventMouseMoved>([&second](EventMouseMoved&) { ++second; });
+		CHECK(first_handle != 0 && second_handle != 0);
+
+		EventMouseMoved moved(1.0, 2.0);
+		dispatcher.dispatch(moved);
+		dispatcher.dispatch(moved);
+		CHECK(first == 2);
+		CHECK(second == 0);
+		CHECK(!dispatcher.remove_event_listener(second_handle));
+		CHECK(dispatcher.remove_event_listener(first_handle));
+		dispatcher.dispatch(moved);
+		CHECK(first == 2);
+		CHECK(!dispatcher.remove_event_listener(0));
+	}
+
+	// capture which tells when listener storage destroyed it
+	struct Capture {
+		bool* alive;
+		explicit Capture(bool* alive) : alive(alive) {}
+		Capture(Capture&& other) noexcept : alive(std::exchange(other.alive, nullptr)) {}
+		~Capture() {
+			if (alive) {
+				*alive = false;
+			}
+		}
+	};
+
+	// captures of a listener which removes itself live until its callback returns
+	void test_remove_self_during_dispatch()
+	{
+		EventDispatcher dispatcher;
+		EventDispatcher::ListenerHandle handle = 0;
+		int calls = 0;
+		bool alive = true;
+		handle = dispatcher.add_event_listener<EventMouseMoved>(
+			[&dispatcher, &handle, &calls, capture = Capture(&alive)](EventMouseMoved&) {
+				CHECK(dispatcher.remove_event_listener(handle));
+				CHECK(*capture.alive);
+				++calls;
+			});
+		EventMouseMoved moved(1.0, 2.0);
+		dispatcher.dispatch(moved);
+		dispatcher.dispatch(moved);
+		CHECK(calls == 1);
+		// compact after the dispatch dropped the callback with its capture
+		CHECK(!alive);
+	}
+
+	void test_listeners_limit()
+	{
+		EventDispatcher dispatcher;
+		for (size_t i = 0; i < EventDispatcher::s_max_listeners; ++i) {
+			CHECK(dispatcher.add_event_listener<EventWindowClosed>([](EventWindowClosed&) {}) != 0);
+		}
+		CHECK(dispatcher.add_event_listener<EventWindowClosed>([](EventWindowClosed&) {}) == 0);
+		// other event types have own slots
+		CHECK(dispatcher.add_event_listener<EventWindowResize>([](EventWindowResize&) {}) != 0);
+	}
+
+	// consecutive moves keep the last position, scrolls are summed, other events split runs
+	void test_queue_coalescing()
+	{
+		EventDispatcher dispatcher;
+		std::string log;
+		dispatcher.add_event_listener<EventMouseMoved>([&log](EventMouseMoved& event) {
+			log += "m" + std::to_string(static_cast<int>(event.x)) + " ";
+		});
+		dispatcher.add_event_listener<EventMouseScroll>([&log](EventMouseScroll& event) {
+			log += "s" + std::to_string(static_cast<int>(event.yoffset)) + " ";
+		});
+		dispatcher.add_event_listener<EventMouseButtonPressed>([&log](EventMouseButtonPressed&) { log += "b "; });
+
+		dispatcher.queue(EventMouseMoved(1.0, 0.0));
+		dispatcher.queue(EventMouseMoved(2.0, 0.0));
+		dispatcher.queue(EventMouseMoved(3.0, 0.0));
+		dispatcher.queue(EventMouseButtonPressed(MouseButtonCode::MOUSE_BUTTON_1, 3.0, 0.0));
+		dispatcher.queue(EventMouseMoved(4.0, 0.0));
+		dispatcher.queue(static_cast<const BaseEvent&>(EventMouseScroll(0.0, 1.0)));
+		dispatcher.queue(EventMouseScroll(0.0, 2.0));
+		CHECK(dispatcher.get_queued_count() == 4);
+		CHECK(log.empty());
+		dispatcher.flush();
+		CHECK(log == "m3 b m4 s3 ");
+		CHECK(dispatcher.get_queued_count() == 0);
+		CHECK(dispatcher.get_stats().queued == 7);
+		CHECK(dispatcher.get_stats().coalesced == 3);
+	}
+
+	// full queue is flushed before the next event, order stays the same
+	void test_queue_overflow_keeps_order()
+	{
+		EventDispatcher dispatcher;
+		int expected = 0;
+		int wrong = 0;
+		dispatcher.add_event_listener<EventWindowResize>([&](EventWindowResize& event) {
+			wrong += static_cast<int>(event.w) != expected ? 1 : 0;
+			++expected;
+		});
+		const int count = static_cast<int>(EventDispatcher::s_queue_capacity) * 3 + 7;
+		for (int i = 0; i < count; ++i) {
+			dispatcher.queue(EventWindowResize(static_cast<unsigned int>(i), 0));
+		}
+		dispatcher.flush();
+		CHECK(expected == count);
+		CHECK(wrong == 0);
+		CHECK(dispatcher.get_stats().overflow_flushes == 3);
+	}
+
+	// listener queues event while flushing, it goes out in the same flush
+	void test_events_queued_by_listeners()
+	{
+		EventDispatcher dispatcher;
+		int resizes = 0;
+		dispatcher.add_event_listener<EventWindowClosed>([&dispatcher](EventWindowClosed&) {
+			dispatcher.queue(EventWindowResize(0, 0));
+		});
+		dispatcher.add_event_listener<EventWindowResize>([&resizes](EventWindowResize&) { ++resizes; });
+		dispatcher.queue(EventWindowClosed());
+		dispatcher.flush();
+		CHECK(resizes == 1);
+		CHECK(dispatcher.get_queued_count() == 0);
+	}
+}
+
+int main()
+{
+	test_priorities_and_handled();
+	test_remove_listeners();
+	test_remove_self_during_dispatch();
+	test_listeners_limit();
+	test_queue_coalescing();
+	test_queue_overflow_keeps_order();
+	test_events_queued_by_listeners();
+	return Tests::get_test_result();
+}
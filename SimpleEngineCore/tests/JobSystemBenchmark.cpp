@@ -0,0 +1,67 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// a little of math per element, enough to be compute bound
+	void update_range(std::vector<float>& values, const size_t begin, const size_t end)
+	{
+		for (size_t i = begin; i < end; ++i) {
+			float x = values[i];
+			for (int step = 0; step < 32; ++step) {
+				x = x * 0.999f + std::sqrt(x + 1.f) * 0.001f;
+			}
+			values[i] = x;
+		}
+	}
+}
+
+// the same parallel_for on 1..N threads, 1 thread is the sequential path without JobSystem
+int main()
+{
+	// at least 2, so the job path is measured even on one core
+	const uint32_t max_threads = std::max(2u, std::thread::hardware_concurrency());
+	std::vector<float> values(1 << 22, 1.f);
+
+	std::printf("threads  parallel_for ms  speedup  empty jobs/s\n");
+	double sequential_ms = 0.0;
+	for (uint32_t threads = 1; threads <= max_threads; ++threads) {
+		if (threads > 1) {
+			JobSystem::Settings settings;
+			settings.workers_count = threads - 1;
+			JobSystem::init(settings);
+			CHECK(JobSystem::get_threads_count() == threads);
+		}
+		const double ms = Tests::measure_ms(5, [&values]() {
+			JobSystem::parallel_for(values.size(), JobSystem::get_batch_size(values.size(), 1024),
+				[&values](const size_t begin, const size_t end) { update_range(values, begin, end); });
+		});
+		if (threads == 1) {
+			sequential_ms = ms;
+		}
+
+		// scheduling cost: jobs which do nothing
+		const int jobs_count = 200000;
+		std::atomic<int> runs{ 0 };
+		const double jobs_ms = Tests::measure_ms(3, [&runs]() {
+			JobCounter counter;
+			for (int i = 0; i < jobs_count; ++i) {
+				std::atomic<int>* pruns = &runs;
+				JobSystem::run([pruns]() { pruns->fetch_add(1, std::memory_order_relaxed); }, &counter);
+			}
+			JobSystem::wait(counter);
+		});
+		CHECK(runs.load() == jobs_count * 4);
+
+		std::printf("%7u  %15.2f  %7.2f  %12.0f\n", threads, ms, sequential_ms / ms, jobs_count / jobs_ms * 1000.0);
+		JobSystem::shutdown();
+	}
+	return Tests::get_test_result();
+}
@@ -0,0 +1,183 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// many more jobs than one ring holds, slots are reused only after their jobs ran
+	void test_more_jobs_than_ring_slots()
+	{
+		const int jobs_count = 100000;
+		std::atomic<int> sum{ 0 };
+		std::vector<int> runs(jobs_count, 0);
+		JobCounter counter;
+		for (int i = 0; i < jobs_count; ++i) {
+			int* run = &runs[i];
+			std::atomic<int>* psum = &sum;
+			JobSystem::run([run, psum, i]() { ++*run; psum->fetch_add(i % 7, std::memory_order_relaxed); }, &counter);
+		}
+		JobSystem::wait(counter);
+		int expected = 0;
+		int wrong_runs = 0;
+		for (int i = 0; i < jobs_count; ++i) {
+			expected += i % 7;
+			wrong_runs += runs[i] != 1 ? 1 : 0;
+		}
+		CHECK(wrong_runs == 0);
+		CHECK(sum.load() == expected);
+	}
+
+	// jobs spawn jobs and wait for them on workers
+	void test_nested_jobs()
+	{
+		std::atomic<int> leaves{ 0 };
+		JobCounter counter;
+		for (int i = 0; i < 64; ++i) {
+			std::atomic<int>* pleaves = &leaves;
+			JobSystem::run([pleaves]() {
+				JobCounter inner;
+				for (int j = 0; j < 256; ++j) {
+					JobSystem::run([pleaves]() { pleaves->fetch_add(1, std::memory_order_relaxed); }, &inner);
+				}
+				JobSystem::wait(inner);
+			}, &counter);
+		}
+		JobSystem::wait(counter);
+		CHECK(leaves.load() == 64 * 256);
+	}
+
+	// continuation starts only after all jobs of its dependency
+	void test_continuations()
+	{
+		for (int round = 0; round < 200; ++round) {
+			std::atomic<int> done{ 0 };
+			std::atomic<int> seen_by_continuation{ -1 };
+			JobCounter first;
+			JobCounter second;
+			for (int i = 0; i < 32; ++i) {
+				std::atomic<int>* pdone = &done;
+				JobSystem::run([pdone]() { pdone->fetch_add(1, std::memory_order_relaxed); }, &first);
+			}
+			std::atomic<int>* pdone = &done;
+			std::atomic<int>* pseen = &seen_by_continuation;
+			JobSystem::run_after(first, [pdone, pseen]() { pseen->store(pdone->load()); }, &second);
+			JobSystem::wait(second);
+			JobSystem::wait(first);
+			CHECK(seen_by_continuation.load() == 32);
+		}
+	}
+
+	// threads which are not workers schedule jobs and may exit before the jobs run
+	void test_jobs_from_other_threads()
+	{
+		std::atomic<int> runs{ 0 };
+		JobCounter counter;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t) {
+			threads.emplace_back([&runs, &counter]() {
+				for (int i = 0; i < 10000; ++i) {
+					std::atomic<int>* pruns = &runs;
+					JobSystem::run([pruns]() { pruns->fetch_add(1, std::memory_order_relaxed); }, &counter);
+				}
+			});
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+		JobSystem::wait(counter);
+		CHECK(runs.load() == 4 * 10000);
+	}
+
+	void test_parallel_for_covers_range_once()
+	{
+		std::vector<int> hits(1000003, 0);
+		JobSystem::parallel_for(hits.size(), JobSystem::get_batch_size(hits.size()), [&hits](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				++hits[i];
+			}
+		});
+		size_t wrong = 0;
+		for (const int hit : hits) {
+			wrong += hit != 1 ? 1 : 0;
+		}
+		CHECK(wrong == 0);
+	}
+
+	void test_main_thread_jobs()
+	{
+		int runs = 0;
+		bool on_main = true;
+		JobCounter counter;
+		for (int i = 0; i < 100; ++i) {
+			JobSystem::run([&runs, &on_main, &counter]() {
+				JobSystem::run_on_main_thread([&runs, &on_main]() {
+					on_main = on_main && JobSystem::is_main_thread() && JobSystem::is_gl_thread();
+					++runs;
+				}, &counter);
+			}, &counter);
+		}
+		while (!counter.is_done()) {
+			JobSystem::process_main_thread_jobs();
+			JobSystem::execute_one_job();
+		}
+		JobSystem::wait(counter);
+		CHECK(runs == 100);
+		CHECK(on_main);
+	}
+
+	// with a render thread main thread jobs run only there, main thread doesn't touch OpenGL anymore
+	void test_main_thread_jobs_only_on_gl_thread()
+	{
+		std::atomic<int> runs{ 0 };
+		std::atomic<bool> on_gl_thread{ true };
+		std::atomic<bool> stop{ false };
+		JobCounter counter;
+		std::thread render_thread([&stop]() {
+			while (!stop.load(std::memory_order_acquire)) {
+				JobSystem::process_main_thread_jobs();
+				std::this_thread::yield();
+			}
+		});
+		JobSystem::set_gl_thread(render_thread.get_id());
+		for (int i = 0; i < 100; ++i) {
+			JobSystem::run_on_main_thread([&runs, &on_gl_thread]() {
+				on_gl_thread = on_gl_thread && JobSystem::is_gl_thread() && !JobSystem::is_main_thread();
+				++runs;
+			}, &counter);
+		}
+		while (!counter.is_done()) {
+			JobSystem::process_main_thread_jobs();
+			std::this_thread::yield();
+		}
+		JobSystem::wait(counter);
+		stop = true;
+		render_thread.join();
+		JobSystem::set_gl_thread(std::this_thread::get_id());
+		CHECK(runs == 100);
+		CHECK(on_gl_thread);
+	}
+}
+
+int main()
+{
+	// a few workers even on small machines, so stealing and wrap around really happen in parallel
+	JobSystem::Settings settings;
+	settings.workers_count = std::max(3u, std::thread::hardware_concurrency());
+	JobSystem::init(settings);
+	for (int repeat = 0; repeat < 5; ++repeat) {
+		test_more_jobs_than_ring_slots();
+		test_nested_jobs();
+		test_continuations();
+		test_jobs_from_other_threads();
+		test_parallel_for_covers_range_once();
+		test_main_thread_jobs();
+		test_main_thread_jobs_only_on_gl_thread();
+	}
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
@@ -0,0 +1,114 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Rendering/LodSelection.h"
+#include "SimpleEngineCore/Rendering/MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// UV sphere of radius 1, segments x rings quads
+	void make_sphere(const uint32_t segments, const uint32_t rings, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+	{
+		const float pi = 3.14159265f;
+		for (uint32_t ring = 0; ring <= rings; ++ring) {
+			const float theta = pi * static_cast<float>(ring) / static_cast<float>(rings);
+			for (uint32_t segment = 0; segment <= segments; ++segment) {
+				const float phi = 2.f * pi * static_cast<float>(segment) / static_cast<float>(segments);
+				positions.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+			}
+		}
+		for (uint32_t ring = 0; ring < rings; ++ring) {
+			for (uint32_t segment = 0; segment < segments; ++segment) {
+				const uint32_t a = ring * (segments + 1) + segment;
+				const uint32_t b = a + segments + 1;
+				indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+			}
+		}
+	}
+}
+
+// large scene: one model with LOD chain drawn as 100 x 100 instances in front of camera
+// numbers are what CPU side decides, GPU frame time needs a context and is shown by the editor
+int main()
+{
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+	make_sphere(128, 64, positions, indices);
+	const size_t source_triangles = indices.size() / 3;
+
+	LodSettings settings;
+	settings.levels_count = 5;
+	std::vector<LodLevel> lods;
+	const double simplify_ms = Tests::measure_ms(1, [&]() {
+		std::vector<uint32_t> chain_indices = indices;
+		lods = generate_lod_chain(positions, chain_indices, settings);
+	});
+	std::printf("LOD chain of %zu triangles: %.1f ms\n", source_triangles, simplify_ms);
+	for (size_t i = 0; i < lods.size(); ++i) {
+		std::printf("  LOD%zu: %u triangles, error %.4f\n", i, lods[i].index_count / 3, lods[i].error);
+	}
+	CHECK(lods.size() >= 2);
+	for (size_t i = 1; i < lods.size(); ++i) {
+		CHECK(lods[i].index_count < lods[i - 1].index_count);
+		CHECK(lods[i].error >= lods[i - 1].error);
+	}
+
+	Camera camera(glm::vec3(0.f, 0.f, 2.f));
+	camera.set_viewport_size(1920.f, 1080.f);
+	const size_t grid = 100;
+	const float spacing = 4.f;
+	std::vector<glm::vec3> centers;
+	for (size_t y = 0; y < grid; ++y) {
+		for (size_t x = 0; x < grid; ++x) {
+			centers.emplace_back(5.f + spacing * static_cast<float>(x), spacing * (static_cast<float>(y) - grid * 0.5f), 0.f);
+		}
+	}
+	const float radius = MeshSimplifier::get_mesh_extent(positions);
+
+	// every instance keeps own level for hysteresis, as MeshComponent does
+	std::vector<size_t> levels(centers.size(), 0);
+	LodSelector selector;
+	const auto select_all = [&]() {
+		for (size_t i = 0; i < centers.size(); ++i) {
+			const float projected_radius = LodSelector::get_projected_radius(camera, centers[i], radius);
+			levels[i] = selector.select(lods, radius, projected_radius, levels[i]);
+		}
+	};
+	const double select_ms = Tests::measure_ms(20, select_all);
+
+	std::vector<size_t> histogram(lods.size(), 0);
+	uint64_t triangles = 0;
+	for (const size_t level : levels) {
+		++histogram[level];
+		triangles += lods[level].index_count / 3;
+	}
+	const uint64_t full_triangles = static_cast<uint64_t>(source_triangles) * centers.size();
+	std::printf("%zu instances: %llu triangles without LOD, %llu with LOD (%.1f%%), selection %.3f ms per frame\n",
+		centers.size(), static_cast<unsigned long long>(full_triangles), static_cast<unsigned long long>(triangles),
+		100.0 * static_cast<double>(triangles) / static_cast<double>(full_triangles), select_ms);
+	for (size_t i = 0; i < histogram.size(); ++i) {
+		std::printf("  LOD%zu: %zu instances\n", i, histogram[i]);
+	}
+	CHECK(triangles < full_triangles / 4);
+
+	// camera shaking by a few centimeters doesn't change any level
+	const std::vector<size_t> settled = levels;
+	size_t switches = 0;
+	for (int frame = 0; frame < 60; ++frame) {
+		camera.set_position(glm::vec3((frame % 2) * 0.02f, 0.f, 2.f));
+		select_all();
+		for (size_t i = 0; i < levels.size(); ++i) {
+			switches += levels[i] != settled[i] ? 1 : 0;
+		}
+	}
+	std::printf("level switches while camera shakes: %zu\n", switches);
+	CHECK(switches == 0);
+	return Tests::get_test_result();
+}
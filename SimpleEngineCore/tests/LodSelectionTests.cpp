@@ -0,0 +1,114 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/ECS/Components.h"
+#include "SimpleEngineCore/ECS/Systems.h"
+#include "SimpleEngineCore/ECS/World.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Rendering/FramePacket.h"
+#include "SimpleEngineCore/Rendering/LodSelection.h"
+
+#include <glm/ext/matrix_transform.hpp>
+
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// selects like MeshNew, but without GL: unit sphere at model origin with fixed chain
+	class LodDrawable : public Drawable {
+	public:
+		LodDrawable()
+		{
+			lods = { { 0, 3, 0.f }, { 3, 3, 0.01f }, { 6, 3, 0.04f }, { 9, 3, 0.16f } };
+		}
+
+		void Draw(const DrawContext&, const DrawInstance&) override {}
+
+		uint32_t SelectLod(const Camera& camera, const glm::mat4& model_matrix, const float pixel_error,
+			const uint32_t current_lod) const override
+		{
+			LodSelector selector;
+			selector.pixel_error = pixel_error;
+			const float projected_radius = LodSelector::get_projected_radius(camera, glm::vec3(model_matrix[3]), 1.f);
+			return static_cast<uint32_t>(selector.select(lods, 1.f, projected_radius, current_lod));
+		}
+
+		std::vector<LodLevel> lods;
+	};
+
+	Entity create_entity(World& world, Drawable& drawable, const float distance, const uint32_t lod)
+	{
+		TransformComponent transform;
+		transform.model_matrix = glm::translate(glm::mat4(1.f), glm::vec3(distance, 0.f, 0.f));
+		return world.create(std::move(transform), MeshComponent{ &drawable, lod }, MaterialComponent{});
+	}
+
+	uint32_t get_item_lod(const std::vector<DrawItem>& draws, const float distance)
+	{
+		for (const DrawItem& item : draws) {
+			if (item.instance.model_matrix[3].x == distance) {
+				return item.instance.lod;
+			}
+		}
+		CHECK(false);
+		return 0;
+	}
+
+	// camera at origin looks along +X, 1 pixel of error: level 1 from 5.2, level 2 from 20.8, level 3 from 83 units
+	void test_entities_sharing_drawable_get_own_levels()
+	{
+		World world;
+		LodDrawable drawable;
+		Camera camera;
+		const Entity near = create_entity(world, drawable, 3.f, 0);
+		const Entity far = create_entity(world, drawable, 150.f, 0);
+		// at 95 level 3 is still good enough but not by hysteresis margin: who has it keeps it, who doesn't won't get it
+		const Entity kept_coarse = create_entity(world, drawable, 95.f, 3);
+		const Entity kept_fine = create_entity(world, drawable, 95.5f, 2);
+
+		std::vector<DrawItem> draws;
+		for (int frame = 0; frame < 3; ++frame) {
+			Systems::build_draw_list(world, camera, 1.f, draws);
+			CHECK(draws.size() == 4);
+			CHECK(get_item_lod(draws, 3.f) == 0);
+			CHECK(get_item_lod(draws, 150.f) == 3);
+			CHECK(get_item_lod(draws, 95.f) == 3);
+			CHECK(get_item_lod(draws, 95.5f) == 2);
+		}
+		CHECK(world.get<MeshComponent>(near)->lod == 0);
+		CHECK(world.get<MeshComponent>(far)->lod == 3);
+		CHECK(world.get<MeshComponent>(kept_coarse)->lod == 3);
+		CHECK(world.get<MeshComponent>(kept_fine)->lod == 2);
+	}
+
+	// entity coming closer gets finer levels at once, going away it becomes coarser only past the margin
+	void test_level_follows_distance_with_hysteresis()
+	{
+		World world;
+		LodDrawable drawable;
+		Camera camera;
+		const Entity entity = create_entity(world, drawable, 200.f, 0);
+		std::vector<DrawItem> draws;
+		const auto level_at = [&](const float distance) {
+			world.get<TransformComponent>(entity)->model_matrix = glm::translate(glm::mat4(1.f), glm::vec3(distance, 0.f, 0.f));
+			Systems::build_draw_list(world, camera, 1.f, draws);
+			return draws.empty() ? 99u : draws[0].instance.lod;
+		};
+		CHECK(level_at(200.f) == 3);
+		CHECK(level_at(90.f) == 3);		// still under 1 pixel
+		CHECK(level_at(80.f) == 2);		// over it, finer at once
+		CHECK(level_at(90.f) == 2);		// coarser only under 0.75 pixel (110 units)
+		CHECK(level_at(115.f) == 3);
+		CHECK(level_at(2.f) == 0);
+	}
+}
+
+int main()
+{
+	JobSystem::init();
+	test_entities_sharing_drawable_get_own_levels();
+	test_level_follows_distance_with_hysteresis();
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
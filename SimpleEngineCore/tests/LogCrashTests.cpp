@@ -0,0 +1,69 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Log.h"
+
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace SimpleEngine;
+
+// the test runs itself again in crash mode: the child logs into a file and dies,
+// the parent checks that every line the child logged before dying reached the file
+namespace {
+	constexpr int s_lines_count = 100;
+
+	// child process, never returns
+	void crash(const std::string& mode, const std::string& path)
+	{
+		spdlog::set_default_logger(spdlog::basic_logger_mt("crash", path, true));
+		Log::init();
+		// info lines don't wake logger thread, they are still in ring when we crash
+		for (int i = 0; i < s_lines_count; ++i) {
+			LOG_INFO("crash test line {}", i);
+		}
+		if (mode == "signal") {
+			std::raise(SIGSEGV);
+		}
+		std::terminate();
+	}
+
+	int count_lines(const std::filesystem::path& path)
+	{
+		std::ifstream file(path);
+		int count = 0;
+		std::string line;
+		while (std::getline(file, line)) {
+			count += line.find("crash test line") != std::string::npos ? 1 : 0;
+		}
+		return count;
+	}
+
+	void test_lines_are_flushed_on_crash(const char* self, const char* mode)
+	{
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / (std::string("simple_engine_crash_") + mode + ".log");
+		std::filesystem::remove(path);
+		const std::string command = std::string("\"") + self + "\" " + mode + " \"" + path.string() + "\"";
+		const int status = std::system(command.c_str());
+		CHECK(status != 0);
+		CHECK(count_lines(path) == s_lines_count);
+		std::filesystem::remove(path);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 3) {
+		crash(argv[1], argv[2]);
+	}
+	test_lines_are_flushed_on_crash(argv[0], "signal");
+	test_lines_are_flushed_on_crash(argv[0], "terminate");
+	return Tests::get_test_result();
+}
@@ -0,0 +1,140 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Memory/FixedPool.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	constexpr size_t s_frame_allocations = 10000;
+	constexpr int s_frames = 50;
+	constexpr size_t s_pool_live = 4096;
+	constexpr size_t s_pool_operations = 2000000;
+
+	// results go through it, so compiler can't drop unused malloc and free pairs
+	void* volatile s_sink = nullptr;
+
+	// the same pseudo random sizes and slots every run
+	uint32_t next_random(uint32_t& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+
+	void print_result(const char* name, const double ms, const size_t operations)
+	{
+		std::printf("%-36s %6.2f ns/alloc\n", name, ms * 1e6 / static_cast<double>(operations));
+	}
+}
+
+// what frame arenas and pools replace: many small short lived allocations on one thread
+int main()
+{
+	// frame of small allocations of 16 to 256 bytes, all of them die at the end of frame
+	std::vector<size_t> sizes(s_frame_allocations);
+	uint32_t random = 1;
+	for (size_t& size : sizes) {
+		size = 16 + next_random(random) % 241;
+	}
+	std::vector<void*> pointers(s_frame_allocations);
+	const double malloc_frame_ms = Tests::measure_ms(3, [&]() {
+		for (int frame = 0; frame < s_frames; ++frame) {
+			for (size_t i = 0; i < s_frame_allocations; ++i) {
+				pointers[i] = std::malloc(sizes[i]);
+			}
+			s_sink = pointers[frame];
+			for (void* ptr : pointers) {
+				std::free(ptr);
+			}
+		}
+	});
+	LinearArena arena(64 * 1024, MemoryTag::Frame);
+	const double arena_frame_ms = Tests::measure_ms(3, [&]() {
+		for (int frame = 0; frame < s_frames; ++frame) {
+			for (size_t i = 0; i < s_frame_allocations; ++i) {
+				pointers[i] = arena.allocate(sizes[i], 16);
+			}
+			s_sink = pointers[frame];
+			arena.reset();
+		}
+	});
+	const uint64_t overflow_blocks = arena.get_overflow_blocks();
+	print_result("malloc + free, frame", malloc_frame_ms, s_frames * s_frame_allocations);
+	print_result("LinearArena + reset, frame", arena_frame_ms, s_frames * s_frame_allocations);
+	std::printf("arena grew to %zu KB, %llu overflow blocks in the first frame only\n", arena.get_capacity() / 1024,
+		static_cast<unsigned long long>(overflow_blocks));
+	// after the first frame everything fits into the first block
+	for (size_t i = 0; i < s_frame_allocations; ++i) {
+		arena.allocate(sizes[i], 16);
+	}
+	arena.reset();
+	CHECK(arena.get_overflow_blocks() == overflow_blocks);
+
+	// churn of 64 byte objects: random slot of a few thousand live ones is freed and allocated again
+	std::vector<uint32_t> slots(s_pool_operations);
+	for (uint32_t& slot : slots) {
+		slot = next_random(random) % s_pool_live;
+	}
+	std::vector<void*> live(s_pool_live);
+	const double malloc_churn_ms = Tests::measure_ms(3, [&]() {
+		for (void*& ptr : live) {
+			ptr = std::malloc(64);
+		}
+		for (const uint32_t slot : slots) {
+			std::free(live[slot]);
+			live[slot] = std::malloc(64);
+		}
+		s_sink = live[0];
+		for (void* ptr : live) {
+			std::free(ptr);
+		}
+	});
+	FixedPool pool(64, 16, 1024, MemoryTag::General);
+	const double pool_churn_ms = Tests::measure_ms(3, [&]() {
+		for (void*& ptr : live) {
+			ptr = pool.allocate();
+		}
+		for (const uint32_t slot : slots) {
+			pool.free(live[slot]);
+			live[slot] = pool.allocate();
+		}
+		s_sink = live[0];
+		for (void* ptr : live) {
+			pool.free(ptr);
+		}
+	});
+	print_result("malloc + free, 64 byte churn", malloc_churn_ms, s_pool_operations + s_pool_live);
+	print_result("FixedPool, 64 byte churn", pool_churn_ms, s_pool_operations + s_pool_live);
+	const FixedPool::Stats pool_stats = pool.get_stats();
+	CHECK(pool_stats.live_blocks == 0);
+	CHECK(pool_stats.pages == s_pool_live / 1024);
+
+	// temporary array of a frame, the way systems gather lights and occluders
+	const double vector_ms = Tests::measure_ms(3, [&]() {
+		for (int frame = 0; frame < s_frames * 10; ++frame) {
+			std::vector<uint32_t> values;
+			for (uint32_t i = 0; i < 1000; ++i) {
+				values.push_back(i);
+			}
+			s_sink = values.data();
+		}
+	});
+	const double arena_vector_ms = Tests::measure_ms(3, [&]() {
+		for (int frame = 0; frame < s_frames * 10; ++frame) {
+			ScratchScope scratch;
+			ArenaVector<uint32_t> values(scratch.get_allocator<uint32_t>());
+			for (uint32_t i = 0; i < 1000; ++i) {
+				values.push_back(i);
+			}
+			s_sink = values.data();
+		}
+	});
+	std::printf("%-36s %6.2f us/frame\n", "std::vector, 1000 push_back", vector_ms * 1e3 / (s_frames * 10));
+	std::printf("%-36s %6.2f us/frame\n", "ArenaVector, 1000 push_back", arena_vector_ms * 1e3 / (s_frames * 10));
+	return Tests::get_test_result();
+}
@@ -0,0 +1,145 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Memory/FixedPool.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+#include "SimpleEngineCore/Memory/MemoryTracker.h"
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	bool is_aligned(const void* ptr, const size_t alignment)
+	{
+		return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+	}
+
+	void test_arena_alignment_and_rewind()
+	{
+		LinearArena arena(4096, MemoryTag::General);
+		for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+			void* ptr = arena.allocate(3, alignment);
+			CHECK(is_aligned(ptr, alignment));
+		}
+		const LinearArena::Marker marker = arena.get_marker();
+		const size_t used = arena.get_used();
+		void* first = arena.allocate(100, 16);
+		arena.allocate(200, 16);
+		CHECK(arena.get_used() >= used + 300);
+		arena.rewind(marker);
+		CHECK(arena.get_used() == used);
+		// the same memory is given again after rewind
+		CHECK(arena.allocate(100, 16) == first);
+	}
+
+	// frame which didn't fit takes overflow blocks once, after reset first block is big enough for it
+	void test_arena_grows_to_fit_frame()
+	{
+		const MemoryTracker::Stats before = MemoryTracker::get_stats(MemoryTag::General);
+		{
+			LinearArena arena(4096, MemoryTag::General);
+			const auto frame = [&arena]() {
+				for (int i = 0; i < 100; ++i) {
+					arena.allocate(256, 16);
+				}
+				arena.reset();
+			};
+			frame();
+			const uint64_t overflow_blocks = arena.get_overflow_blocks();
+			CHECK(overflow_blocks > 0);
+			CHECK(arena.get_capacity() >= 100 * 256);
+			for (int i = 0; i < 10; ++i) {
+				frame();
+			}
+			CHECK(arena.get_overflow_blocks() == overflow_blocks);
+			CHECK(arena.get_used() == 0);
+			CHECK(arena.get_peak() >= 100 * 256);
+		}
+		const MemoryTracker::Stats after = MemoryTracker::get_stats(MemoryTag::General);
+		CHECK(after.live_bytes == before.live_bytes);
+		CHECK(after.live_allocations == before.live_allocations);
+	}
+
+	void test_arena_vector_and_scratch()
+	{
+		ScratchScope outer;
+		ArenaVector<int> values(outer.get_allocator<int>());
+		for (int i = 0; i < 1000; ++i) {
+			values.push_back(i);
+		}
+		CHECK(values.size() == 1000 && values[999] == 999);
+		const size_t used = outer.get_arena().get_used();
+		{
+			ScratchScope inner;
+			CHECK(&inner.get_arena() == &outer.get_arena());
+			inner.get_arena().allocate(1000, 8);
+			CHECK(outer.get_arena().get_used() > used);
+		}
+		CHECK(outer.get_arena().get_used() == used);
+	}
+
+	void test_pool_reuses_blocks()
+	{
+		FixedPool pool(24, 32, 16, MemoryTag::General);
+		CHECK(pool.get_block_size() == 32);
+		std::vector<void*> blocks;
+		std::set<void*> unique;
+		for (int i = 0; i < 40; ++i) {
+			blocks.push_back(pool.allocate());
+			unique.insert(blocks.back());
+			CHECK(is_aligned(blocks.back(), 32));
+		}
+		CHECK(unique.size() == 40);
+		FixedPool::Stats stats = pool.get_stats();
+		CHECK(stats.live_blocks == 40 && stats.pages == 3 && stats.free_blocks == 8);
+
+		// the last freed block is the next one given
+		pool.free(blocks[7]);
+		CHECK(pool.allocate() == blocks[7]);
+		for (void* block : blocks) {
+			pool.free(block);
+		}
+		stats = pool.get_stats();
+		CHECK(stats.live_blocks == 0 && stats.pages == 3 && stats.free_blocks == 48);
+		// freed blocks are enough, no page is added
+		blocks.clear();
+		for (int i = 0; i < 48; ++i) {
+			blocks.push_back(pool.allocate());
+		}
+		CHECK(pool.get_stats().pages == 3);
+		for (void* block : blocks) {
+			pool.free(block);
+		}
+	}
+
+	void test_object_pool_constructs_and_destructs()
+	{
+		struct Counted {
+			explicit Counted(int& alive) : alive(alive) { ++alive; }
+			~Counted() { --alive; }
+			int& alive;
+		};
+		int alive = 0;
+		ObjectPool<Counted> pool(8, MemoryTag::General);
+		Counted* a = pool.create(alive);
+		Counted* b = pool.create(alive);
+		CHECK(alive == 2 && a != b);
+		pool.destroy(a);
+		pool.destroy(nullptr);
+		CHECK(alive == 1 && pool.get_stats().live_blocks == 1);
+		pool.destroy(b);
+		CHECK(alive == 0 && pool.get_stats().live_blocks == 0);
+	}
+}
+
+int main()
+{
+	test_arena_alignment_and_rewind();
+	test_arena_grows_to_fit_frame();
+	test_arena_vector_and_scratch();
+	test_pool_reuses_blocks();
+	test_object_pool_constructs_and_destructs();
+	return Tests::get_test_result();
+}
@@ -0,0 +1,92 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/ECS/Components.h"
+#include "SimpleEngineCore/ECS/Systems.h"
+#include "SimpleEngineCore/ECS/World.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+#include "SimpleEngineCore/Rendering/FramePacket.h"
+#include "SimpleEngineCore/Rendering/OcclusionCulling.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	class NullDrawable : public Drawable {
+	public:
+		void Draw(const DrawContext&, const DrawInstance&) override {}
+	};
+
+	glm::mat4 make_box_matrix(const glm::vec3& position, const glm::vec3& half_size)
+	{
+		return glm::scale(glm::translate(glm::mat4(1.f), position), half_size);
+	}
+}
+
+// 5000 small cubes on the ground between walls, camera in the middle turns around in 8 steps
+// culled share and what culling costs: occluder rendering and draw list build with and without tests
+int main()
+{
+	JobSystem::init();
+	std::printf("%u threads\n", JobSystem::get_threads_count());
+
+	World world;
+	NullDrawable drawable;
+	const OccluderMesh box = OccluderMesh::make_box();
+	std::minstd_rand random(1);
+	std::uniform_real_distribution<float> coordinate(-45.f, 45.f);
+	for (int i = 0; i < 16; ++i) {
+		const glm::vec3 half_size = i % 2 == 0 ? glm::vec3(8.f, 0.4f, 3.f) : glm::vec3(0.4f, 8.f, 3.f);
+		TransformComponent transform;
+		transform.model_matrix = make_box_matrix(glm::vec3(coordinate(random), coordinate(random), 3.f), half_size);
+		world.create(std::move(transform), MeshComponent{ &drawable }, MaterialComponent{},
+			BoundsComponent{ glm::vec3(0.f), glm::vec3(1.f) }, OccluderComponent{ &box });
+	}
+	for (int i = 0; i < 5000; ++i) {
+		TransformComponent transform;
+		transform.model_matrix = make_box_matrix(glm::vec3(coordinate(random), coordinate(random), 0.5f), glm::vec3(0.5f));
+		world.create(std::move(transform), MeshComponent{ &drawable }, MaterialComponent{},
+			BoundsComponent{ glm::vec3(0.f), glm::vec3(1.f) });
+	}
+
+	LinearArena arena(FramePacket::s_arena_capacity);
+	OcclusionBuffer buffer;
+	std::vector<DrawItem> draws;
+	const SimdMath::Isa isas[] = { SimdMath::Isa::Scalar, SimdMath::Isa::SSE4, SimdMath::Isa::AVX2 };
+	std::printf("heading  culled  frustum  occluded  render ms (scalar/best)  draw list ms (no culling/culling)\n");
+	for (int heading = 0; heading < 8; ++heading) {
+		Camera camera(glm::vec3(0.f, 0.f, 1.7f), glm::vec3(0.f, 0.f, heading * 45.f));
+		arena.reset();
+		ArenaVector<Occluder> occluders{ ArenaAllocator<Occluder>(arena) };
+		Systems::gather_occluders(world, occluders);
+
+		double render_ms[3] = {};
+		for (const SimdMath::Isa isa : isas) {
+			SimdMath::set_isa(isa);
+			render_ms[static_cast<int>(isa)] = Tests::measure_ms(10, [&]() { buffer.render(camera, occluders); });
+		}
+		SimdMath::set_isa(SimdMath::get_best_supported_isa());
+		buffer.render(camera, occluders);
+
+		const double plain_ms = Tests::measure_ms(10, [&]() { Systems::build_draw_list(world, camera, 1.f, draws); });
+		CullingStats stats;
+		const double culled_ms = Tests::measure_ms(10, [&]() { stats = Systems::build_draw_list(world, camera, 1.f, draws, &buffer); });
+		const double culled = 100.0 * (stats.outside_frustum + stats.occluded) / stats.tested;
+		std::printf("%7d  %5.1f%%  %7zu  %8zu  %11.3f / %.3f  %19.3f / %.3f\n", heading * 45, culled,
+			stats.outside_frustum, stats.occluded, render_ms[0], render_ms[static_cast<int>(SimdMath::get_best_supported_isa())],
+			plain_ms, culled_ms);
+		CHECK(stats.tested == world.count<BoundsComponent>());
+		CHECK(draws.size() == stats.tested - stats.outside_frustum - stats.occluded);
+		CHECK(stats.occluded > 0);
+	}
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
@@ -0,0 +1,189 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Camera.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Math/SimdMath.h"
+#include "SimpleEngineCore/Memory/LinearArena.h"
+#include "SimpleEngineCore/Rendering/OcclusionCulling.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	using EVisibility = OcclusionBuffer::EVisibility;
+
+	glm::mat4 make_box_matrix(const glm::vec3& position, const glm::vec3& half_size)
+	{
+		return glm::scale(glm::translate(glm::mat4(1.f), position), half_size);
+	}
+
+	EVisibility test_unit_box(const OcclusionBuffer& buffer, const Camera& camera, const glm::mat4& model)
+	{
+		const glm::mat4 mvp = camera.get_projection_matrix() * camera.get_view_matrix() * model;
+		return buffer.test_box(mvp, glm::vec3(0.f), glm::vec3(1.f));
+	}
+
+	// segment from..to crosses [-1, 1] box of occluder before reaching to
+	bool is_segment_blocked(const glm::mat4& inverse_model, const glm::vec3& from, const glm::vec3& to)
+	{
+		const glm::vec3 origin(inverse_model * glm::vec4(from, 1.f));
+		const glm::vec3 direction = glm::vec3(inverse_model * glm::vec4(to, 1.f)) - origin;
+		float t_min = 0.f;
+		float t_max = 0.999f;
+		for (int axis = 0; axis < 3; ++axis) {
+			if (std::fabs(direction[axis]) < 1e-8f) {
+				if (std::fabs(origin[axis]) > 1.f) {
+					return false;
+				}
+				continue;
+			}
+			float t0 = (-1.f - origin[axis]) / direction[axis];
+			float t1 = (1.f - origin[axis]) / direction[axis];
+			if (t0 > t1) {
+				std::swap(t0, t1);
+			}
+			t_min = std::max(t_min, t0);
+			t_max = std::min(t_max, t1);
+			if (t_min > t_max) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// every sample of box surface which is on the screen is hidden from camera by some occluder
+	bool is_really_hidden(const glm::mat4& model, const Camera& camera, const std::vector<glm::mat4>& inverse_occluders)
+	{
+		const glm::vec3 eye = camera.get_position();
+		const glm::mat4 view_projection = camera.get_projection_matrix() * camera.get_view_matrix();
+		const int samples = 8;
+		for (int face = 0; face < 6; ++face) {
+			const int axis = face / 2;
+			const float side = (face % 2) ? 1.f : -1.f;
+			for (int u = 0; u < samples; ++u) {
+				for (int v = 0; v < samples; ++v) {
+					glm::vec3 local;
+					local[axis] = side;
+					local[(axis + 1) % 3] = -1.f + 2.f * (u + 0.5f) / samples;
+					local[(axis + 2) % 3] = -1.f + 2.f * (v + 0.5f) / samples;
+					const glm::vec3 point(model * glm::vec4(local, 1.f));
+					const glm::vec4 clip = view_projection * glm::vec4(point, 1.f);
+					if (clip.w < camera.get_near_clip_plane() || std::fabs(clip.x) > clip.w || std::fabs(clip.y) > clip.w) {
+						continue;
+					}
+					bool blocked = false;
+					for (const glm::mat4& inverse_occluder : inverse_occluders) {
+						blocked = blocked || is_segment_blocked(inverse_occluder, eye, point);
+					}
+					if (!blocked) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	// camera at origin looks along +X, wall 10 units ahead covers y and z in [-3, 3]
+	void test_simple_cases()
+	{
+		Camera camera;
+		LinearArena arena(64 * 1024);
+		ArenaVector<Occluder> occluders{ ArenaAllocator<Occluder>(arena) };
+		const OccluderMesh box = OccluderMesh::make_box();
+		occluders.push_back({ &box, make_box_matrix(glm::vec3(10.f, 0.f, 0.f), glm::vec3(0.5f, 3.f, 3.f)) });
+
+		OcclusionBuffer buffer;
+		buffer.render(camera, occluders);
+		CHECK(!buffer.is_empty());
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(20.f, 0.f, 0.f), glm::vec3(1.f))) == EVisibility::Occluded);
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(5.f, 0.f, 0.f), glm::vec3(1.f))) == EVisibility::Visible);
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(20.f, 10.f, 0.f), glm::vec3(1.f))) == EVisibility::Visible);
+		// partly behind the edge of the wall
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(20.f, 6.f, 0.f), glm::vec3(1.f))) == EVisibility::Visible);
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(-5.f, 0.f, 0.f), glm::vec3(1.f))) == EVisibility::OutsideFrustum);
+		// box around the camera is never culled
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(0.f), glm::vec3(1.f))) == EVisibility::Visible);
+
+		// nothing rendered - nothing occluded
+		occluders.clear();
+		buffer.render(camera, occluders);
+		CHECK(test_unit_box(buffer, camera, make_box_matrix(glm::vec3(20.f, 0.f, 0.f), glm::vec3(1.f))) == EVisibility::Visible);
+	}
+
+	// random walls and boxes, culled box must be hidden for every ray sample and every isa gives the same depth
+	void test_culling_is_conservative()
+	{
+		std::minstd_rand random(21);
+		std::uniform_real_distribution<float> coordinate(-40.f, 40.f);
+		std::uniform_real_distribution<float> size(0.2f, 1.5f);
+		const OccluderMesh box = OccluderMesh::make_box();
+		LinearArena arena(64 * 1024);
+		ArenaVector<Occluder> occluders{ ArenaAllocator<Occluder>(arena) };
+		std::vector<glm::mat4> inverse_occluders;
+		for (int i = 0; i < 12; ++i) {
+			const bool along_x = i % 2 == 0;
+			const glm::vec3 half_size = along_x ? glm::vec3(6.f, 0.3f, 3.f) : glm::vec3(0.3f, 6.f, 3.f);
+			const glm::mat4 model = make_box_matrix(glm::vec3(coordinate(random), coordinate(random), 2.f), half_size);
+			occluders.push_back({ &box, model });
+			inverse_occluders.push_back(glm::inverse(model));
+		}
+		std::vector<glm::mat4> boxes;
+		for (int i = 0; i < 1500; ++i) {
+			const float s = size(random);
+			boxes.push_back(make_box_matrix(glm::vec3(coordinate(random), coordinate(random), s), glm::vec3(s)));
+		}
+
+		size_t wrongly_culled = 0;
+		size_t occluded = 0;
+		size_t different_depth = 0;
+		for (int heading = 0; heading < 8; ++heading) {
+			Camera camera(glm::vec3(0.f, 0.f, 1.5f), glm::vec3(0.f, 0.f, heading * 45.f));
+			std::vector<float> reference_depth;
+			const SimdMath::Isa isas[] = { SimdMath::Isa::Scalar, SimdMath::Isa::SSE4, SimdMath::Isa::AVX2 };
+			for (const SimdMath::Isa isa : isas) {
+				SimdMath::set_isa(isa);
+				OcclusionBuffer buffer;
+				buffer.render(camera, occluders);
+				const size_t pixels = static_cast<size_t>(OcclusionBuffer::s_width) * buffer.get_height();
+				const float* depth = buffer.get_depth(0);
+				if (reference_depth.empty()) {
+					reference_depth.assign(depth, depth + pixels);
+				}
+				else {
+					for (size_t p = 0; p < pixels; ++p) {
+						different_depth += depth[p] != reference_depth[p] ? 1 : 0;
+					}
+				}
+				if (isa != SimdMath::Isa::Scalar) {
+					continue;
+				}
+				for (const glm::mat4& model : boxes) {
+					if (test_unit_box(buffer, camera, model) == EVisibility::Occluded) {
+						++occluded;
+						wrongly_culled += is_really_hidden(model, camera, inverse_occluders) ? 0 : 1;
+					}
+				}
+			}
+		}
+		SimdMath::set_isa(SimdMath::get_best_supported_isa());
+		std::printf("occluded %zu of %zu tested boxes, wrongly culled %zu\n", occluded, boxes.size() * 8, wrongly_culled);
+		CHECK(occluded > 0);
+		CHECK(wrongly_culled == 0);
+		CHECK(different_depth == 0);
+	}
+}
+
+int main()
+{
+	JobSystem::init();
+	test_simple_cases();
+	test_culling_is_conservative();
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
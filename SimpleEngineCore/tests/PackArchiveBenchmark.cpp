@@ -0,0 +1,147 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/IO/PackArchive.h"
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace SimpleEngine;
+
+namespace {
+	struct AssetSet {
+		std::vector<std::filesystem::path> virtual_paths;
+		std::vector<std::filesystem::path> disk_paths;
+		uint64_t bytes = 0;
+		uint64_t checksum = 0;
+	};
+
+	uint64_t get_checksum(const uint8_t* data, const size_t size)
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i < size; ++i) {
+			sum = sum * 31 + data[i];
+		}
+		return sum;
+	}
+
+	// like assets of a level: half are text (models, shaders) which compress, half are random (compressed textures)
+	AssetSet write_assets(const std::filesystem::path& root, const size_t count, const size_t size)
+	{
+		AssetSet set;
+		const char* words[] = { "v ", "vn ", "vt ", "f ", "0.125 ", "-1.0 ", "\n" };
+		std::vector<uint8_t> bytes(size);
+		uint32_t random = 1;
+		for (size_t i = 0; i < count; ++i) {
+			const bool text = i % 2 == 0;
+			for (size_t b = 0; b < size;) {
+				random = random * 1664525u + 1013904223u;
+				if (text) {
+					for (const char* c = words[(random >> 24) % 7]; *c != '\0' && b < size; ++c) {
+						bytes[b++] = static_cast<uint8_t>(*c);
+					}
+				}
+				else {
+					bytes[b++] = static_cast<uint8_t>(random >> 24);
+				}
+			}
+			const std::string name = std::string("assets/") + (text ? "models/" : "textures/") + std::to_string(i) + ".bin";
+			set.virtual_paths.push_back(name);
+			set.disk_paths.push_back(root / name);
+			std::filesystem::create_directories(set.disk_paths.back().parent_path());
+			std::ofstream file(set.disk_paths.back(), std::ios::binary);
+			file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+			set.bytes += size;
+			set.checksum += get_checksum(bytes.data(), bytes.size());
+		}
+		return set;
+	}
+
+	// cold reads go to disk, where page cache can't be dropped (tmpfs, other systems) they are the same as warm ones
+	void drop_cache(const std::vector<std::filesystem::path>& paths)
+	{
+#if defined(__linux__)
+		for (const std::filesystem::path& path : paths) {
+			const int fd = open(path.c_str(), O_RDONLY);
+			if (fd >= 0) {
+				fdatasync(fd);
+				posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+				close(fd);
+			}
+		}
+#else
+		(void)paths;
+#endif
+	}
+
+	// cold start of a level: mount, then read every asset in one batch
+	template<typename Mount>
+	void measure(const AssetSet& set, const char* method, const std::vector<std::filesystem::path>& cached_files, const bool cold,
+		const Mount& mount)
+	{
+		double best_ms = 1e30;
+		for (int run = 0; run < 3; ++run) {
+			FileSystem::unmount_all();
+			if (cold) {
+				drop_cache(cached_files);
+			}
+			std::vector<FileData> data(set.virtual_paths.size());
+			const auto start = std::chrono::steady_clock::now();
+			CHECK(mount());
+			const size_t read = FileSystem::read_batch(set.virtual_paths.data(), data.data(), data.size());
+			best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+			CHECK(read == set.virtual_paths.size());
+			uint64_t bytes = 0;
+			uint64_t checksum = 0;
+			for (const FileData& file : data) {
+				bytes += file.size();
+				checksum += get_checksum(file.data(), file.size());
+			}
+			CHECK(bytes == set.bytes);
+			CHECK(checksum == set.checksum);
+		}
+		const std::string label = std::string(method) + (cold ? ", cold" : ", warm");
+		std::printf("%-24s %8.2f ms %9.0f files/s\n", label.c_str(), best_ms,
+			static_cast<double>(set.virtual_paths.size()) / (best_ms / 1000.0));
+	}
+}
+
+// loose files against one archive: fewer opens and one mapping against file per asset, lz4 against bigger reads
+int main()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "simple_engine_pack_benchmark";
+	const std::filesystem::path root = directory / "loose";
+	const std::filesystem::path archive_path = directory / "assets.pak";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(root);
+
+	const AssetSet set = write_assets(root, 2000, 16 * 1024);
+	PackArchive::BuildStats stats;
+	CHECK(PackArchive::build(root, { "assets" }, archive_path, PackArchive::BuildSettings(), &stats));
+	std::printf("%zu files, %.1f MB loose, %.1f MB packed, %zu compressed\n", stats.files,
+		static_cast<double>(stats.bytes) / (1024.0 * 1024.0), static_cast<double>(stats.archive_bytes) / (1024.0 * 1024.0),
+		stats.compressed_files);
+
+	JobSystem::init();
+	for (const bool cold : { true, false }) {
+		measure(set, "loose", set.disk_paths, cold, [&root]() { return FileSystem::mount_directory("", root); });
+		measure(set, "archive", { archive_path }, cold, [&archive_path]() { return FileSystem::mount_archive("", archive_path); });
+	}
+	FileSystem::unmount_all();
+	JobSystem::shutdown();
+
+	std::filesystem::remove_all(directory);
+	return Tests::get_test_result();
+}
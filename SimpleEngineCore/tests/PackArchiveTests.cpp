@@ -0,0 +1,282 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/IO/FileSystem.h"
+#include "SimpleEngineCore/IO/Lz4.h"
+#include "SimpleEngineCore/IO/PackArchive.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// text-like bytes which compress well and random ones which don't
+	std::vector<uint8_t> make_bytes(const size_t size, const bool compressible, uint32_t seed)
+	{
+		std::vector<uint8_t> bytes(size);
+		const char* words[] = { "vertex ", "normal ", "texcoord ", "face ", "0.125 ", "-1.0 ", "\n" };
+		size_t i = 0;
+		while (i < size) {
+			seed = seed * 1664525u + 1013904223u;
+			if (compressible) {
+				const char* word = words[(seed >> 24) % 7];
+				for (size_t c = 0; word[c] != '\0' && i < size; ++c) {
+					bytes[i++] = static_cast<uint8_t>(word[c]);
+				}
+			}
+			else {
+				bytes[i++] = static_cast<uint8_t>(seed >> 24);
+			}
+		}
+		return bytes;
+	}
+
+	std::vector<uint8_t> compress(const std::vector<uint8_t>& bytes)
+	{
+		std::vector<uint8_t> compressed(lz4_get_compress_bound(bytes.size()));
+		compressed.resize(lz4_compress(bytes.data(), bytes.size(), compressed.data(), compressed.size()));
+		return compressed;
+	}
+
+	void write_file(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	void write_file(const std::filesystem::path& path, const std::string& text)
+	{
+		write_file(path, std::vector<uint8_t>(text.begin(), text.end()));
+	}
+
+	std::string read_virtual(const std::string& path)
+	{
+		std::string text;
+		return FileSystem::read_text(path, text) ? text : std::string("<missing>");
+	}
+
+	void test_lz4_round_trip()
+	{
+		// short blocks are literals only, long ones have matches of every length and overlapping ones
+		const size_t sizes[] = { 1, 7, 16, 100, 4096, 100000 };
+		for (const size_t size : sizes) {
+			for (const bool compressible : { true, false }) {
+				const std::vector<uint8_t> bytes = make_bytes(size, compressible, static_cast<uint32_t>(size));
+				const std::vector<uint8_t> compressed = compress(bytes);
+				CHECK(!compressed.empty());
+				CHECK(compressed.size() <= lz4_get_compress_bound(size));
+				if (compressible && size >= 4096) {
+					CHECK(compressed.size() < size / 2);
+				}
+				std::vector<uint8_t> decompressed(size);
+				CHECK(lz4_decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()));
+				CHECK(decompressed == bytes);
+			}
+		}
+		// one byte repeated is a match which overlaps bytes it writes
+		const std::vector<uint8_t> zeros(10000, 0);
+		const std::vector<uint8_t> compressed = compress(zeros);
+		CHECK(compressed.size() < 100);
+		std::vector<uint8_t> decompressed(zeros.size(), 1);
+		CHECK(lz4_decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()));
+		CHECK(decompressed == zeros);
+
+		// output which doesn't fit into capacity is not written
+		const std::vector<uint8_t> random = make_bytes(1000, false, 3);
+		std::vector<uint8_t> small(500);
+		CHECK(lz4_compress(random.data(), random.size(), small.data(), small.size()) == 0);
+	}
+
+	void test_lz4_damaged_block()
+	{
+		const std::vector<uint8_t> bytes = make_bytes(20000, true, 7);
+		const std::vector<uint8_t> compressed = compress(bytes);
+		std::vector<uint8_t> decompressed(bytes.size());
+
+		// block has to give exactly the size from archive entry
+		CHECK(!lz4_decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1));
+		std::vector<uint8_t> bigger(bytes.size() + 1);
+		CHECK(!lz4_decompress(compressed.data(), compressed.size(), bigger.data(), bigger.size()));
+
+		// every cut is rejected, none reads or writes out of bounds (run under ASan)
+		int accepted = 0;
+		for (size_t size = 0; size < compressed.size(); size += 3) {
+			const std::vector<uint8_t> cut(compressed.begin(), compressed.begin() + size);
+			accepted += lz4_decompress(cut.data(), cut.size(), decompressed.data(), decompressed.size()) ? 1 : 0;
+		}
+		CHECK(accepted == 0);
+
+		// changed bytes may still decode to something, but never out of bounds
+		uint32_t seed = 11;
+		for (int i = 0; i < 2000; ++i) {
+			std::vector<uint8_t> damaged = compressed;
+			seed = seed * 1664525u + 1013904223u;
+			damaged[(seed >> 8) % damaged.size()] ^= static_cast<uint8_t>(seed >> 24 | 1);
+			lz4_decompress(damaged.data(), damaged.size(), decompressed.data(), decompressed.size());
+		}
+	}
+
+	void test_archive_round_trip(const std::filesystem::path& directory)
+	{
+		const std::filesystem::path root = directory / "round_trip";
+		const std::vector<uint8_t> text = make_bytes(30000, true, 1);
+		const std::vector<uint8_t> random = make_bytes(30000, false, 2);
+		write_file(root / "assets/models/cube.obj", text);
+		write_file(root / "assets/textures/noise.png", random);
+		write_file(root / "assets/empty.txt", std::vector<uint8_t>());
+
+		const std::filesystem::path archive_path = directory / "round_trip.pak";
+		PackArchive::BuildStats stats;
+		CHECK(PackArchive::build(root, { "assets" }, archive_path, PackArchive::BuildSettings(), &stats));
+		CHECK(stats.files == 3);
+		CHECK(stats.compressed_files == 1);
+		CHECK(std::filesystem::file_size(archive_path) % s_pack_alignment == 0);
+
+		PackArchive archive;
+		CHECK(archive.open(archive_path));
+		CHECK(archive.get_entries_count() == 3);
+		CHECK(archive.find("assets/models/cube.obj") != nullptr);
+		CHECK(archive.find("assets/models") == nullptr);
+		CHECK(archive.find("models/cube.obj") == nullptr);
+
+		const PackEntry* packed_text = archive.find("assets/models/cube.obj");
+		const PackEntry* packed_random = archive.find("assets/textures/noise.png");
+		if (packed_text == nullptr || packed_random == nullptr) {
+			return;
+		}
+		// random bytes don't save enough, they are stored and read from mapping
+		CHECK(packed_text->compression == PackCompression::Lz4);
+		CHECK(packed_random->compression == PackCompression::None);
+		CHECK(packed_text->offset % s_pack_alignment == 0 && packed_random->offset % s_pack_alignment == 0);
+		std::vector<uint8_t> bytes;
+		CHECK(archive.decompress(*packed_text, bytes));
+		CHECK(bytes == text);
+		CHECK(archive.get_stored_data(*packed_text) == nullptr);
+		const uint8_t* stored = archive.get_stored_data(*packed_random);
+		CHECK(stored != nullptr && std::memcmp(stored, random.data(), random.size()) == 0);
+		CHECK(archive.decompress(*archive.find("assets/empty.txt"), bytes));
+		CHECK(bytes.empty());
+	}
+
+	void test_damaged_archive(const std::filesystem::path& directory)
+	{
+		const std::filesystem::path root = directory / "damaged";
+		const std::vector<uint8_t> text = make_bytes(30000, true, 5);
+		write_file(root / "assets/a.txt", text);
+		write_file(root / "assets/b.txt", text);
+		const std::filesystem::path archive_path = directory / "damaged.pak";
+		CHECK(PackArchive::build(root, { "assets" }, archive_path, PackArchive::BuildSettings()));
+
+		std::vector<uint8_t> original;
+		{
+			std::ifstream file(archive_path, std::ios::binary);
+			original.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+		const std::filesystem::path damaged_path = directory / "damaged_copy.pak";
+		const auto opens = [&damaged_path](const std::vector<uint8_t>& bytes) {
+			write_file(damaged_path, bytes);
+			PackArchive archive;
+			return archive.open(damaged_path);
+		};
+		CHECK(opens(original));
+
+		PackEntry entry;
+		std::memcpy(&entry, original.data() + sizeof(PackHeader), sizeof(entry));
+		const auto patch_entry = [&original](const PackEntry& patched) {
+			std::vector<uint8_t> bytes = original;
+			std::memcpy(bytes.data() + sizeof(PackHeader), &patched, sizeof(patched));
+			return bytes;
+		};
+		// table of contents out of file, entry out of file, bad name and unknown compression are rejected at open
+		PackEntry out_of_file = entry;
+		out_of_file.offset = original.size();
+		out_of_file.stored_size = 1;
+		CHECK(!opens(patch_entry(out_of_file)));
+		PackEntry bad_name = entry;
+		bad_name.name_length = 1000;
+		CHECK(!opens(patch_entry(bad_name)));
+		PackEntry bad_compression = entry;
+		bad_compression.compression = static_cast<PackCompression>(7);
+		CHECK(!opens(patch_entry(bad_compression)));
+		std::vector<uint8_t> toc_out_of_file = original;
+		PackHeader header;
+		std::memcpy(&header, original.data(), sizeof(header));
+		header.entries_count = 100000;
+		std::memcpy(toc_out_of_file.data(), &header, sizeof(header));
+		CHECK(!opens(toc_out_of_file));
+		CHECK(!opens(std::vector<uint8_t>(original.begin(), original.begin() + 8)));
+
+		// damaged block of compressed entry opens, but doesn't decompress
+		std::vector<uint8_t> damaged_block = original;
+		std::memset(damaged_block.data() + entry.offset, 0xFF, 16);
+		write_file(damaged_path, damaged_block);
+		PackArchive archive;
+		CHECK(archive.open(damaged_path));
+		const PackEntry* damaged = archive.find("assets/a.txt");
+		const PackEntry* intact = archive.find("assets/b.txt");
+		std::vector<uint8_t> bytes;
+		CHECK(damaged != nullptr && damaged->compression == PackCompression::Lz4 && !archive.decompress(*damaged, bytes));
+		CHECK(bytes.empty());
+		CHECK(intact != nullptr && archive.decompress(*intact, bytes) && bytes == text);
+	}
+
+	void test_overlay_order(const std::filesystem::path& directory)
+	{
+		const std::filesystem::path loose = directory / "overlay_loose";
+		const std::filesystem::path packed = directory / "overlay_packed";
+		write_file(loose / "shaders/a.glsl", "loose a");
+		write_file(loose / "shaders/only_loose.glsl", "loose only");
+		write_file(packed / "shaders/a.glsl", "packed a");
+		write_file(packed / "shaders/only_packed.glsl", "packed only");
+		const std::filesystem::path archive_path = directory / "overlay.pak";
+		CHECK(PackArchive::build(packed, { "shaders" }, archive_path, PackArchive::BuildSettings()));
+
+		// archive mounted over directory gives packed files and directory gives the rest
+		FileSystem::unmount_all();
+		CHECK(FileSystem::mount_directory("", loose));
+		CHECK(FileSystem::mount_archive("", archive_path));
+		CHECK(read_virtual("shaders/a.glsl") == "packed a");
+		CHECK(read_virtual("shaders/only_loose.glsl") == "loose only");
+		CHECK(read_virtual("./shaders/../shaders/only_packed.glsl") == "packed only");
+		CHECK(FileSystem::get_disk_path("shaders/a.glsl").empty());
+		CHECK(!FileSystem::get_disk_path("shaders/only_loose.glsl").empty());
+		CHECK(!FileSystem::exists("shaders/none.glsl"));
+
+		// mounted later is searched first, so directory over archive wins
+		FileSystem::unmount_all();
+		CHECK(FileSystem::mount_archive("", archive_path));
+		CHECK(FileSystem::mount_directory("", loose));
+		CHECK(read_virtual("shaders/a.glsl") == "loose a");
+		CHECK(read_virtual("shaders/only_packed.glsl") == "packed only");
+
+		// mount point is a prefix of virtual paths
+		FileSystem::unmount_all();
+		CHECK(FileSystem::mount_directory("", loose));
+		CHECK(FileSystem::mount_archive("mods/", archive_path));
+		CHECK(read_virtual("shaders/a.glsl") == "loose a");
+		CHECK(read_virtual("mods/shaders/a.glsl") == "packed a");
+		CHECK(read_virtual("shaders/only_packed.glsl") == "<missing>");
+		FileSystem::unmount_all();
+	}
+}
+
+int main()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "simple_engine_pack_tests";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	test_lz4_round_trip();
+	test_lz4_damaged_block();
+	test_archive_round_trip(directory);
+	test_damaged_archive(directory);
+	test_overlay_order(directory);
+
+	std::filesystem::remove_all(directory);
+	return Tests::get_test_result();
+}
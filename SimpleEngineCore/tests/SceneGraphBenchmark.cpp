@@ -0,0 +1,80 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Scene/SceneGraph.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// children are created right after their parent, so every node is appended
+	void build_subtree(SceneGraph& graph, const SceneGraph::NodeId parent, const int depth, const int branching,
+		std::vector<SceneGraph::NodeId>& ids)
+	{
+		for (int i = 0; i < branching; ++i) {
+			const glm::mat4 local = glm::translate(glm::mat4(1.f), glm::vec3(static_cast<float>(i), 0.f, 1.f));
+			const SceneGraph::NodeId node = graph.create_node(parent, glm::rotate(local, 0.1f, glm::vec3(0.f, 0.f, 1.f)));
+			ids.push_back(node);
+			if (depth > 1) {
+				build_subtree(graph, node, depth - 1, branching, ids);
+			}
+		}
+	}
+}
+
+// 1.1M nodes: 10 roots, 10 children per node, 6 levels
+int main()
+{
+	JobSystem::init();
+	std::printf("%u threads\n", JobSystem::get_threads_count());
+
+	SceneGraph graph;
+	std::vector<SceneGraph::NodeId> ids;
+	const auto build_start = std::chrono::steady_clock::now();
+	graph.reserve(1111110);
+	ids.reserve(1111110);
+	build_subtree(graph, SceneGraph::s_invalid_node, 6, 10, ids);
+	const double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+	const size_t nodes_count = graph.get_nodes_count();
+	std::printf("build %zu nodes: %.1f ms\n", nodes_count, build_ms);
+
+	size_t updated = graph.update();
+	CHECK(updated == nodes_count);
+
+	// every root changes - whole hierarchy
+	const double full_ms = Tests::measure_ms(5, [&]() {
+		for (const SceneGraph::NodeId id : ids) {
+			if (graph.get_parent(id) == SceneGraph::s_invalid_node) {
+				graph.set_local_matrix(id, graph.get_local_matrix(id));
+			}
+		}
+		updated = graph.update();
+	});
+	CHECK(updated == nodes_count);
+	std::printf("full update: %.2f ms, %.1f M nodes/s\n", full_ms, nodes_count / full_ms / 1000.0);
+
+	// a few scattered nodes move, their subtrees follow
+	std::minstd_rand random(3);
+	const double partial_ms = Tests::measure_ms(5, [&]() {
+		for (int i = 0; i < 10000; ++i) {
+			const SceneGraph::NodeId id = ids[random() % ids.size()];
+			graph.set_local_matrix(id, graph.get_local_matrix(id));
+		}
+		updated = graph.update();
+	});
+	std::printf("10000 changed nodes: %.2f ms, %zu nodes recomputed\n", partial_ms, updated);
+	CHECK(updated < nodes_count);
+
+	const double idle_ms = Tests::measure_ms(100, [&]() { updated = graph.update(); });
+	CHECK(updated == 0);
+	std::printf("nothing changed: %.4f ms\n", idle_ms);
+
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
@@ -0,0 +1,146 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Jobs/JobSystem.h"
+#include "SimpleEngineCore/Scene/SceneGraph.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	glm::mat4 random_local(std::minstd_rand& random)
+	{
+		std::uniform_real_distribution<float> offset(-2.f, 2.f);
+		std::uniform_real_distribution<float> angle(-3.f, 3.f);
+		std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+		glm::mat4 local = glm::translate(glm::mat4(1.f), glm::vec3(offset(random), offset(random), offset(random)));
+		local = glm::rotate(local, angle(random), glm::normalize(glm::vec3(offset(random), offset(random), 1.f)));
+		return glm::scale(local, glm::vec3(scale(random), scale(random), scale(random)));
+	}
+
+	float get_max_difference(const glm::mat4& a, const glm::mat4& b)
+	{
+		float difference = 0.f;
+		for (int column = 0; column < 4; ++column) {
+			for (int row = 0; row < 4; ++row) {
+				difference = std::max(difference, std::fabs(a[column][row] - b[column][row]));
+			}
+		}
+		return difference;
+	}
+
+	// world matrices of every valid node against product of locals along parent chain
+	void check_against_parent_chain(const SceneGraph& graph, const std::vector<SceneGraph::NodeId>& ids)
+	{
+		size_t wrong_world = 0;
+		size_t wrong_normal = 0;
+		for (const SceneGraph::NodeId id : ids) {
+			if (!graph.is_node_valid(id)) {
+				continue;
+			}
+			glm::mat4 expected = graph.get_local_matrix(id);
+			for (SceneGraph::NodeId parent = graph.get_parent(id); parent != SceneGraph::s_invalid_node; parent = graph.get_parent(parent)) {
+				expected = graph.get_local_matrix(parent) * expected;
+			}
+			const glm::mat4& world = graph.get_world_matrix(id);
+			// relative, deep chains of scaled nodes grow big
+			const float magnitude = std::max(1.f, get_max_difference(expected, glm::mat4(0.f)));
+			wrong_world += get_max_difference(world, expected) > 1e-4f * magnitude ? 1 : 0;
+
+			const glm::mat3 expected_normal = glm::transpose(glm::inverse(glm::mat3(world)));
+			const glm::mat3& normal = graph.get_normal_matrix(id);
+			for (int column = 0; column < 3; ++column) {
+				const glm::vec3 d = normal[column] - expected_normal[column];
+				wrong_normal += glm::length(d) > 1e-3f * std::max(1.f, glm::length(expected_normal[column])) ? 1 : 0;
+			}
+		}
+		CHECK(wrong_world == 0);
+		CHECK(wrong_normal == 0);
+	}
+
+	// random inserts, removes and changes, big enough so subtrees are split for workers
+	void test_random_edits_match_parent_chain()
+	{
+		std::minstd_rand random(7);
+		SceneGraph graph;
+		std::vector<SceneGraph::NodeId> ids;
+		for (int round = 0; round < 4; ++round) {
+			for (int i = 0; i < 6000; ++i) {
+				SceneGraph::NodeId parent = SceneGraph::s_invalid_node;
+				if (!ids.empty() && random() % 50 != 0) {
+					parent = ids[random() % ids.size()];
+				}
+				if (parent != SceneGraph::s_invalid_node && !graph.is_node_valid(parent)) {
+					parent = SceneGraph::s_invalid_node;
+				}
+				ids.push_back(graph.create_node(parent, random_local(random)));
+			}
+			for (int i = 0; i < 20; ++i) {
+				const SceneGraph::NodeId node = ids[random() % ids.size()];
+				if (graph.is_node_valid(node)) {
+					graph.remove_node(node);
+				}
+			}
+			for (int i = 0; i < 500; ++i) {
+				const SceneGraph::NodeId node = ids[random() % ids.size()];
+				if (graph.is_node_valid(node)) {
+					graph.set_local_matrix(node, random_local(random));
+				}
+			}
+			graph.update();
+			check_against_parent_chain(graph, ids);
+			// ids of removed nodes are reused, keep only valid ones
+			std::vector<SceneGraph::NodeId> valid;
+			for (const SceneGraph::NodeId id : ids) {
+				if (graph.is_node_valid(id)) {
+					valid.push_back(id);
+				}
+			}
+			ids.swap(valid);
+			CHECK(ids.size() == graph.get_nodes_count());
+		}
+	}
+
+	void test_only_changed_subtree_is_updated()
+	{
+		SceneGraph graph;
+		const SceneGraph::NodeId root = graph.create_node();
+		const SceneGraph::NodeId left = graph.create_node(root);
+		const SceneGraph::NodeId right = graph.create_node(root);
+		const SceneGraph::NodeId left_leaf = graph.create_node(left);
+		graph.create_node(left);
+		graph.create_node(right);
+		CHECK(graph.update() == 6);
+		CHECK(graph.update() == 0);
+
+		graph.set_local_matrix(left_leaf, glm::translate(glm::mat4(1.f), glm::vec3(1.f, 0.f, 0.f)));
+		CHECK(graph.update() == 1);
+		graph.set_local_matrix(left, glm::translate(glm::mat4(1.f), glm::vec3(0.f, 2.f, 0.f)));
+		graph.set_local_matrix(left_leaf, glm::translate(glm::mat4(1.f), glm::vec3(3.f, 0.f, 0.f)));
+		CHECK(graph.update() == 3);
+		CHECK_NEAR(graph.get_world_matrix(left_leaf)[3].x, 3.f, 1e-6);
+		CHECK_NEAR(graph.get_world_matrix(left_leaf)[3].y, 2.f, 1e-6);
+
+		graph.set_local_matrix(root, glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 5.f)));
+		CHECK(graph.update() == 6);
+		CHECK_NEAR(graph.get_world_matrix(left_leaf)[3].z, 5.f, 1e-6);
+
+		graph.remove_node(left);
+		CHECK(graph.get_nodes_count() == 3);
+		CHECK(!graph.is_node_valid(left_leaf));
+		CHECK(graph.get_parent(right) == root);
+	}
+}
+
+int main()
+{
+	JobSystem::init();
+	test_only_changed_subtree_is_updated();
+	test_random_edits_match_parent_chain();
+	JobSystem::shutdown();
+	return Tests::get_test_result();
+}
@@ -0,0 +1,70 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Math/SimdMath.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdio>
+#include <vector>
+
+using namespace SimpleEngine;
+
+// millions of matrices per second of every kernel and isa, in cache (2048) and out of it (65536 objects)
+int main()
+{
+	const SimdMath::Isa isas[] = { SimdMath::Isa::Scalar, SimdMath::Isa::SSE4, SimdMath::Isa::AVX2 };
+	const size_t counts[] = { 2048, 65536 };
+
+	std::printf("M matrices/s    objects  model  normal    mvp\n");
+	for (const size_t count : counts) {
+		std::vector<float> position[3];
+		std::vector<float> rotation[4];
+		std::vector<float> scale[3];
+		for (int c = 0; c < 3; ++c) {
+			position[c].assign(count, static_cast<float>(c));
+			scale[c].assign(count, 1.5f);
+		}
+		const float quaternion[4] = { 0.1f, 0.2f, 0.3f, std::sqrt(1.f - 0.14f) };
+		for (int c = 0; c < 4; ++c) {
+			rotation[c].assign(count, quaternion[c]);
+		}
+		const TransformArrays transforms = {
+			{ position[0].data(), position[1].data(), position[2].data() },
+			{ rotation[0].data(), rotation[1].data(), rotation[2].data(), rotation[3].data() },
+			{ scale[0].data(), scale[1].data(), scale[2].data() } };
+		std::vector<glm::mat4> models(count);
+		std::vector<glm::mat3> normals(count);
+		std::vector<glm::mat4> mvps(count);
+		const glm::mat4 view_projection(0.5f);
+
+		for (const SimdMath::Isa isa : isas) {
+			SimdMath::set_isa(isa);
+			if (SimdMath::get_isa() != isa) {
+				continue;
+			}
+			// enough repeats to run for a few milliseconds
+			const int repeats = static_cast<int>(4000000 / count);
+			const auto per_second = [count, repeats](const double ms) { return count * repeats / ms / 1000.0; };
+			const double model_ms = Tests::measure_ms(5, [&]() {
+				for (int r = 0; r < repeats; ++r) {
+					SimdMath::compose_model_matrices(transforms, models.data(), count);
+				}
+			});
+			const double normal_ms = Tests::measure_ms(5, [&]() {
+				for (int r = 0; r < repeats; ++r) {
+					SimdMath::compute_normal_matrices(models.data(), normals.data(), count);
+				}
+			});
+			const double mvp_ms = Tests::measure_ms(5, [&]() {
+				for (int r = 0; r < repeats; ++r) {
+					SimdMath::compute_mvp_matrices(view_projection, models.data(), mvps.data(), count);
+				}
+			});
+			std::printf("%-6s %18zu %6.0f %7.0f %6.0f\n", SimdMath::get_isa_name(isa), count,
+				per_second(model_ms), per_second(normal_ms), per_second(mvp_ms));
+			CHECK(normals[count - 1][0][0] != 0.f);
+		}
+	}
+	SimdMath::set_isa(SimdMath::get_best_supported_isa());
+	return Tests::get_test_result();
+}
@@ -0,0 +1,230 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Math/SimdMath.h"
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	// not a multiple of 4 or 8, scalar tail runs too
+	constexpr size_t s_count = 1003;
+
+	// outputs with padding between objects, kernels have to respect strides
+	struct PaddedMat4 {
+		glm::mat4 value;
+		float padding[3];
+	};
+	struct PaddedMat3 {
+		glm::mat3 value;
+		float padding[5];
+	};
+
+	struct Objects {
+		std::vector<float> position[3];
+		std::vector<float> rotation[4];
+		std::vector<float> scale[3];
+		std::vector<glm::mat4> reference_models;
+
+		TransformArrays get_arrays() const
+		{
+			return {
+				{ position[0].data(), position[1].data(), position[2].data() },
+				{ rotation[0].data(), rotation[1].data(), rotation[2].data(), rotation[3].data() },
+				{ scale[0].data(), scale[1].data(), scale[2].data() } };
+		}
+	};
+
+	// the same objects for every isa, reference model is built with glm from axis and angle
+	Objects make_objects()
+	{
+		std::minstd_rand random(11);
+		std::uniform_real_distribution<float> any(-10.f, 10.f);
+		std::uniform_real_distribution<float> positive(0.2f, 3.f);
+		Objects objects;
+		for (size_t i = 0; i < s_count; ++i) {
+			const glm::vec3 position(any(random), any(random), any(random));
+			const glm::vec3 axis = glm::normalize(glm::vec3(any(random), any(random), any(random) + 0.01f));
+			const float angle = any(random);
+			const glm::vec3 scale(positive(random), positive(random), positive(random));
+			const float s = std::sin(angle * 0.5f);
+			const float quaternion[4] = { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+			for (int c = 0; c < 3; ++c) {
+				objects.position[c].push_back(position[c]);
+				objects.scale[c].push_back(scale[c]);
+			}
+			for (int c = 0; c < 4; ++c) {
+				objects.rotation[c].push_back(quaternion[c]);
+			}
+			const glm::mat4 model = glm::translate(glm::mat4(1.f), position) * glm::rotate(glm::mat4(1.f), angle, axis)
+				* glm::scale(glm::mat4(1.f), scale);
+			objects.reference_models.push_back(model);
+		}
+		return objects;
+	}
+
+	float get_relative_difference(const float* a, const float* b, const size_t count)
+	{
+		float difference = 0.f;
+		for (size_t i = 0; i < count; ++i) {
+			difference = std::max(difference, std::fabs(a[i] - b[i]) / std::max(1.f, std::fabs(b[i])));
+		}
+		return difference;
+	}
+
+	void test_matrices(const Objects& objects)
+	{
+		std::vector<PaddedMat4> models(s_count);
+		SimdMath::compose_model_matrices(objects.get_arrays(), &models[0].value, s_count, sizeof(PaddedMat4));
+		size_t wrong_models = 0;
+		for (size_t i = 0; i < s_count; ++i) {
+			wrong_models += get_relative_difference(&models[i].value[0][0], &objects.reference_models[i][0][0], 16) > 1e-5f ? 1 : 0;
+		}
+		CHECK(wrong_models == 0);
+
+		std::vector<PaddedMat3> normals(s_count);
+		SimdMath::compute_normal_matrices(&models[0].value, &normals[0].value, s_count, sizeof(PaddedMat4), sizeof(PaddedMat3));
+		size_t wrong_normals = 0;
+		for (size_t i = 0; i < s_count; ++i) {
+			const glm::mat3 expected = glm::transpose(glm::inverse(glm::mat3(objects.reference_models[i])));
+			wrong_normals += get_relative_difference(&normals[i].value[0][0], &expected[0][0], 9) > 1e-4f ? 1 : 0;
+		}
+		CHECK(wrong_normals == 0);
+
+		const glm::mat4 view_projection = glm::perspective(glm::radians(60.f), 1.5f, 0.1f, 100.f)
+			* glm::lookAt(glm::vec3(-20.f, 3.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f));
+		std::vector<PaddedMat4> mvps(s_count);
+		SimdMath::compute_mvp_matrices(view_projection, &models[0].value, &mvps[0].value, s_count, sizeof(PaddedMat4), sizeof(PaddedMat4));
+		size_t wrong_mvps = 0;
+		for (size_t i = 0; i < s_count; ++i) {
+			const glm::mat4 expected = view_projection * models[i].value;
+			wrong_mvps += get_relative_difference(&mvps[i].value[0][0], &expected[0][0], 16) > 1e-5f ? 1 : 0;
+		}
+		CHECK(wrong_mvps == 0);
+	}
+
+	// world box has to contain all 8 transformed corners and touch them on every axis
+	void test_aabbs(const Objects& objects)
+	{
+		std::minstd_rand random(5);
+		std::uniform_real_distribution<float> any(-2.f, 2.f);
+		std::uniform_real_distribution<float> positive(0.1f, 2.f);
+		std::vector<float> center[3];
+		std::vector<float> extent[3];
+		std::vector<float> world_center[3];
+		std::vector<float> world_extent[3];
+		for (int c = 0; c < 3; ++c) {
+			for (size_t i = 0; i < s_count; ++i) {
+				center[c].push_back(any(random));
+				extent[c].push_back(positive(random));
+			}
+			world_center[c].resize(s_count);
+			world_extent[c].resize(s_count);
+		}
+		const AabbArrays local = { { center[0].data(), center[1].data(), center[2].data() },
+			{ extent[0].data(), extent[1].data(), extent[2].data() } };
+		const AabbOutArrays world = { { world_center[0].data(), world_center[1].data(), world_center[2].data() },
+			{ world_extent[0].data(), world_extent[1].data(), world_extent[2].data() } };
+		SimdMath::transform_aabbs(objects.reference_models.data(), local, world, s_count);
+
+		size_t wrong = 0;
+		for (size_t i = 0; i < s_count; ++i) {
+			glm::vec3 min(1e30f);
+			glm::vec3 max(-1e30f);
+			for (int corner = 0; corner < 8; ++corner) {
+				const glm::vec3 point(
+					center[0][i] + ((corner & 1) ? extent[0][i] : -extent[0][i]),
+					center[1][i] + ((corner & 2) ? extent[1][i] : -extent[1][i]),
+					center[2][i] + ((corner & 4) ? extent[2][i] : -extent[2][i]));
+				const glm::vec3 transformed(objects.reference_models[i] * glm::vec4(point, 1.f));
+				min = glm::min(min, transformed);
+				max = glm::max(max, transformed);
+			}
+			for (int c = 0; c < 3; ++c) {
+				const float tolerance = 1e-4f * std::max(1.f, std::fabs(max[c]) + std::fabs(min[c]));
+				wrong += std::fabs(world_center[c][i] - world_extent[c][i] - min[c]) > tolerance ? 1 : 0;
+				wrong += std::fabs(world_center[c][i] + world_extent[c][i] - max[c]) > tolerance ? 1 : 0;
+			}
+		}
+		CHECK(wrong == 0);
+	}
+
+	void test_spheres()
+	{
+		std::minstd_rand random(9);
+		std::uniform_real_distribution<float> any(-60.f, 60.f);
+		std::uniform_real_distribution<float> positive(0.1f, 5.f);
+		std::vector<float> center[3];
+		std::vector<float> radius;
+		for (size_t i = 0; i < s_count; ++i) {
+			for (int c = 0; c < 3; ++c) {
+				center[c].push_back(any(random));
+			}
+			radius.push_back(positive(random));
+		}
+		const SphereArrays spheres = { { center[0].data(), center[1].data(), center[2].data() }, radius.data() };
+
+		glm::vec4 planes[6];
+		SimdMath::extract_frustum_planes(glm::perspective(glm::radians(60.f), 1.5f, 0.1f, 100.f)
+			* glm::lookAt(glm::vec3(0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f)), planes);
+		std::vector<uint8_t> visible(s_count, 7);
+		SimdMath::test_spheres_planes(planes, 6, spheres, visible.data(), s_count);
+		size_t wrong = 0;
+		size_t visible_count = 0;
+		for (size_t i = 0; i < s_count; ++i) {
+			const glm::vec3 c(center[0][i], center[1][i], center[2][i]);
+			bool expected = true;
+			bool on_border = false;
+			for (const glm::vec4& plane : planes) {
+				const float distance = glm::dot(glm::vec3(plane), c) + plane.w;
+				expected = expected && distance >= -radius[i];
+				on_border = on_border || std::fabs(distance + radius[i]) < 1e-3f;
+			}
+			wrong += !on_border && visible[i] != (expected ? 1 : 0) ? 1 : 0;
+			visible_count += visible[i];
+		}
+		CHECK(wrong == 0);
+		// both outcomes are really tested
+		CHECK(visible_count > 0 && visible_count < s_count);
+
+		const glm::vec3 box_min(-20.f, -10.f, -5.f);
+		const glm::vec3 box_max(10.f, 25.f, 15.f);
+		SimdMath::test_spheres_aabb(box_min, box_max, spheres, visible.data(), s_count);
+		wrong = 0;
+		for (size_t i = 0; i < s_count; ++i) {
+			const glm::vec3 c(center[0][i], center[1][i], center[2][i]);
+			const glm::vec3 closest = glm::min(glm::max(c, box_min), box_max);
+			const float distance = glm::length(c - closest);
+			if (std::fabs(distance - radius[i]) > 1e-3f) {
+				wrong += visible[i] != (distance <= radius[i] ? 1 : 0) ? 1 : 0;
+			}
+		}
+		CHECK(wrong == 0);
+	}
+}
+
+// every kernel on every isa this CPU has against glm
+int main()
+{
+	const Objects objects = make_objects();
+	const SimdMath::Isa isas[] = { SimdMath::Isa::Scalar, SimdMath::Isa::SSE4, SimdMath::Isa::AVX2 };
+	for (const SimdMath::Isa isa : isas) {
+		SimdMath::set_isa(isa);
+		if (SimdMath::get_isa() != isa) {
+			std::printf("%s is not supported, skipped\n", SimdMath::get_isa_name(isa));
+			continue;
+		}
+		const int failures_before = Tests::get_failures_count();
+		test_matrices(objects);
+		test_aabbs(objects);
+		test_spheres();
+		std::printf("%s: %s\n", SimdMath::get_isa_name(isa), Tests::get_failures_count() == failures_before ? "ok" : "FAILED");
+	}
+	SimdMath::set_isa(SimdMath::get_best_supported_isa());
+	return Tests::get_test_result();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// tests are plain executables: failed CHECK prints where it is and main returns get_test_result()
+// benchmarks print their numbers and check only what has to hold on any machine
+namespace SimpleEngine {
+
+	namespace Tests {
+		inline int& get_failures_count()
+		{
+			static int failures = 0;
+			return failures;
+		}
+
+		inline void report_failure(const char* file, const int line, const char* condition)
+		{
+			std::printf("%s:%d: CHECK(%s) failed\n", file, line, condition);
+			++get_failures_count();
+		}
+
+		inline int get_test_result()
+		{
+			if (get_failures_count() > 0) {
+				std::printf("%d checks failed\n", get_failures_count());
+				return EXIT_FAILURE;
+			}
+			return EXIT_SUCCESS;
+		}
+
+		// the best of repeats in milliseconds, the first run warms caches up
+		template<typename F>
+		double measure_ms(const int repeats, const F& f)
+		{
+			f();
+			double best = 1e30;
+			for (int i = 0; i < repeats; ++i) {
+				const auto start = std::chrono::steady_clock::now();
+				f();
+				best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
+			return best;
+		}
+	}
+}
+
+// variadic so conditions with template arguments need no extra parentheses
+#define CHECK(...) \
+	do { \
+		if (!(__VA_ARGS__)) { \
+			::SimpleEngine::Tests::report_failure(__FILE__, __LINE__, #__VA_ARGS__); \
+		} \
+	} while (false)
+
+#define CHECK_NEAR(a, b, epsilon) CHECK(std::fabs(static_cast<double>(a) - static_cast<double>(b)) <= (epsilon))
@@ -0,0 +1,231 @@
+#include "TestCommon.h"
+
+#include "SimpleEngineCore/Scene/WorldLayout.h"
+#include "SimpleEngineCore/Assets/CookedFormats.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace SimpleEngine;
+
+namespace {
+	const char* s_world_source =
+		"# two models in three cells\n"
+		"cell_size 16\n"
+		"model models/cube/cube.obj shaders/v.glsl shaders/f.glsl LightCube\n"
+		"model models/cow/cow.obj shaders/v.glsl shaders/f.glsl\n"
+		"object 0 1 2 0\n"
+		"object 1 3 4 0 0.5   # the same cell as the first one\n"
+		"object 1 -1 2 0\n"
+		"object 0 20 -40 1 2\n";
+
+	bool parse(const std::string& text, WorldLayout& layout, std::string& error)
+	{
+		return parse_world_source(reinterpret_cast<const uint8_t*>(text.data()), text.size(), layout, error);
+	}
+
+	bool same_layouts(const WorldLayout& a, const WorldLayout& b)
+	{
+		if (a.cell_size != b.cell_size || a.models.size() != b.models.size() || a.cells.size() != b.cells.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < a.models.size(); ++i) {
+			if (a.models[i].path != b.models[i].path || a.models[i].vertex_shader_path != b.models[i].vertex_shader_path ||
+				a.models[i].frag_shader_path != b.models[i].frag_shader_path || a.models[i].mesh_type != b.models[i].mesh_type) {
+				return false;
+			}
+		}
+		for (size_t i = 0; i < a.cells.size(); ++i) {
+			const WorldCell& ca = a.cells[i];
+			const WorldCell& cb = b.cells[i];
+			if (ca.x != cb.x || ca.y != cb.y || ca.models != cb.models || ca.objects.size() != cb.objects.size()) {
+				return false;
+			}
+			for (size_t j = 0; j < ca.objects.size(); ++j) {
+				if (ca.objects[j].model != cb.objects[j].model || ca.objects[j].position != cb.objects[j].position ||
+					ca.objects[j].scale != cb.objects[j].scale) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void test_parse_source()
+	{
+		WorldLayout layout;
+		std::string error;
+		CHECK(parse(s_world_source, layout, error));
+		CHECK(layout.cell_size == 16.f);
+		CHECK(layout.models.size() == 2);
+		CHECK(layout.models[0].mesh_type == MeshType::LightCube);
+		CHECK(layout.models[1].mesh_type == MeshType::MeshNew);
+		// cells are sorted by y, then x, negative coordinates go to negative cells
+		CHECK(layout.cells.size() == 3);
+		CHECK(layout.cells[0].x == 1 && layout.cells[0].y == -3);
+		CHECK(layout.cells[1].x == -1 && layout.cells[1].y == 0);
+		CHECK(layout.cells[2].x == 0 && layout.cells[2].y == 0);
+		CHECK(layout.cells[2].objects.size() == 2);
+		CHECK((layout.cells[2].models == std::vector<uint32_t>{ 0, 1 }));
+		CHECK(layout.cells[2].objects[1].scale == 0.5f);
+	}
+
+	void test_cooked_round_trip()
+	{
+		WorldLayout source;
+		std::string error;
+		CHECK(parse(s_world_source, source, error));
+		std::vector<uint8_t> cooked;
+		CHECK(write_cooked_world(source, cooked));
+		CHECK(cooked.size() % 4 == 0);
+		CHECK(is_cooked_world(cooked.data(), cooked.size()));
+
+		WorldLayout read;
+		CHECK(read_cooked_world(cooked.data(), cooked.size(), read));
+		CHECK(same_layouts(source, read));
+		// loader takes cooked and text alike
+		WorldLayout loaded;
+		CHECK(load_world_layout(cooked.data(), cooked.size(), loaded, error));
+		CHECK(same_layouts(source, loaded));
+		const std::string text(s_world_source);
+		CHECK(load_world_layout(reinterpret_cast<const uint8_t*>(text.data()), text.size(), loaded, error));
+		CHECK(same_layouts(source, loaded));
+	}
+
+	void test_bad_source_lines()
+	{
+		const char* bad_sources[] = {
+			"model a.obj v.glsl f.glsl\nobject 1 0 0 0\n",		// model which is not declared yet
+			"object 0 0 0 0\n",									// no models at all
+			"model a.obj v.glsl f.glsl\nobject -1 0 0 0\n",
+			"model a.obj v.glsl f.glsl\nobject 0 0 0\n",		// missing coordinate
+			"model a.obj v.glsl f.glsl\nobject 0 0 0 nan\n",
+			"model a.obj v.glsl f.glsl Cube\n",					// unknown mesh type
+			"model a.obj v.glsl\n",
+			"cell_size 0\n",
+			"cell_size -4\n",
+			"cells 4\n",
+		};
+		for (const char* source : bad_sources) {
+			WorldLayout layout;
+			std::string error;
+			CHECK(!parse(source, layout, error));
+			CHECK(!error.empty());
+			CHECK(!load_world_layout(reinterpret_cast<const uint8_t*>(source), std::strlen(source), layout, error));
+		}
+		// error tells the line
+		WorldLayout layout;
+		std::string error;
+		CHECK(!parse("cell_size 8\n\nmodel a.obj v.glsl f.glsl\nobject 2 0 0 0\n", layout, error));
+		CHECK(error.rfind("line 4:", 0) == 0);
+	}
+
+	void test_truncated_cooked_world()
+	{
+		WorldLayout source;
+		std::string error;
+		CHECK(parse(s_world_source, source, error));
+		std::vector<uint8_t> cooked;
+		CHECK(write_cooked_world(source, cooked));
+		// every cut is rejected, none reads out of bounds (run under ASan)
+		// no bytes at all is an empty text world
+		int accepted = 0;
+		for (size_t size = 1; size < cooked.size(); ++size) {
+			const std::vector<uint8_t> cut(cooked.begin(), cooked.begin() + size);
+			WorldLayout layout;
+			accepted += read_cooked_world(cut.data(), cut.size(), layout) ? 1 : 0;
+			accepted += load_world_layout(cut.data(), cut.size(), layout, error) ? 1 : 0;
+		}
+		CHECK(accepted == 0);
+
+		// other version is not read as this one
+		std::vector<uint8_t> other_version = cooked;
+		CookedWorldHeader header;
+		std::memcpy(&header, other_version.data(), sizeof(header));
+		++header.version;
+		std::memcpy(other_version.data(), &header, sizeof(header));
+		WorldLayout layout;
+		CHECK(!load_world_layout(other_version.data(), other_version.size(), layout, error));
+		CHECK(!error.empty());
+	}
+
+	void test_bad_indices_in_cooked_world()
+	{
+		WorldLayout source;
+		std::string error;
+		CHECK(parse(s_world_source, source, error));
+		std::vector<uint8_t> cooked;
+		CHECK(write_cooked_world(source, cooked));
+
+		CookedWorldHeader header;
+		std::memcpy(&header, cooked.data(), sizeof(header));
+		const size_t models_offset = sizeof(header);
+		const size_t cells_offset = models_offset + header.models_count * sizeof(CookedWorldModel);
+		const size_t cell_models_offset = cells_offset + header.cells_count * sizeof(CookedWorldCell);
+		const size_t objects_offset = cell_models_offset + header.cell_models_count * sizeof(uint32_t);
+
+		// patch is applied to a copy, every one of them alone makes file invalid
+		const auto rejects = [&cooked](const size_t offset, const uint32_t value) {
+			std::vector<uint8_t> damaged = cooked;
+			std::memcpy(damaged.data() + offset, &value, sizeof(value));
+			WorldLayout layout;
+			std::string error;
+			return !read_cooked_world(damaged.data(), damaged.size(), layout) &&
+				!load_world_layout(damaged.data(), damaged.size(), layout, error);
+		};
+		CHECK(rejects(objects_offset + offsetof(CookedWorldObject, model), header.models_count));
+		CHECK(rejects(cell_models_offset, header.models_count));
+		CHECK(rejects(cells_offset + offsetof(CookedWorldCell, first_object), header.objects_count + 1));
+		CHECK(rejects(cells_offset + offsetof(CookedWorldCell, objects_count), header.objects_count + 1));
+		CHECK(rejects(cells_offset + offsetof(CookedWorldCell, first_model), 0xFFFFFFFFu));
+		CHECK(rejects(cells_offset + offsetof(CookedWorldCell, models_count), header.cell_models_count + 1));
+		CHECK(rejects(models_offset + offsetof(CookedWorldModel, path), header.strings_size));
+		CHECK(rejects(models_offset + offsetof(CookedWorldModel, mesh_type), static_cast<uint32_t>(MeshType::MeshNew) + 1));
+		// string without terminator inside of strings
+		std::vector<uint8_t> unterminated = cooked;
+		std::memset(unterminated.data() + unterminated.size() - header.strings_size, 'a', header.strings_size);
+		WorldLayout layout;
+		CHECK(!read_cooked_world(unterminated.data(), unterminated.size(), layout));
+	}
+
+	void test_write_rejects_bad_indices()
+	{
+		WorldLayout source;
+		std::string error;
+		CHECK(parse(s_world_source, source, error));
+		std::vector<uint8_t> cooked;
+
+		WorldLayout bad_object = source;
+		bad_object.cells[0].objects[0].model = static_cast<uint32_t>(source.models.size());
+		CHECK(!write_cooked_world(bad_object, cooked));
+		CHECK(cooked.empty());
+
+		WorldLayout bad_cell_model = source;
+		bad_cell_model.cells[1].models.push_back(7);
+		CHECK(!write_cooked_world(bad_cell_model, cooked));
+		CHECK(cooked.empty());
+
+		WorldLayout no_models = source;
+		no_models.models.clear();
+		CHECK(!write_cooked_world(no_models, cooked));
+
+		// empty world is fine
+		CHECK(write_cooked_world(WorldLayout(), cooked));
+		WorldLayout layout;
+		CHECK(read_cooked_world(cooked.data(), cooked.size(), layout));
+		CHECK(layout.cells.empty() && layout.models.empty());
+	}
+}
+
+int main()
+{
+	test_parse_source();
+	test_cooked_round_trip();
+	test_bad_source_lines();
+	test_truncated_cooked_world();
+	test_bad_indices_in_cooked_world();
+	test_write_rejects_bad_indices();
+	return Tests::get_test_result();
+}
@@ -1,3 +1,4 @@
+#include <cfloat>
 #include <iostream>
 #include <memory>
 #include <imgui/imgui.h>
@@ -205,7 +206,193 @@ class SimpleEngineEditor : public SimpleEngine::Application {
 		if (ImGui::SliderFloat("Cam far clip plane", &camera_far_plane, 1.f, 100.f)) {
 			camera.set_far_clip_plane(camera_far_plane);
 		}
+		ImGui::SliderFloat("LOD pixel error", &lod_pixel_error, 0.1f, 16.f);
+		ImGui::Checkbox("Depth pre-pass", &use_depth_prepass);
+		ImGui::Checkbox("Reverse-Z", &use_reverse_z);
+		ImGui::Checkbox("Camera late-latch", &use_camera_late_latch);
+		ImGui::Checkbox("Shadows", &use_shadows);
+		ImGui::SliderFloat("Shadow distance", &shadow_distance, 5.f, 100.f);
+		ImGui::SliderFloat("Shadow split lambda", &shadow_split_lambda, 0.f, 1.f);
+		int lights_count = static_cast<int>(demo_lights_count);
+		if (ImGui::SliderInt("Demo lights", &lights_count, 0, 1000)) {
+			demo_lights_count = static_cast<size_t>(lights_count);
+		}
+		ImGui::Checkbox("Occlusion culling", &use_occlusion_culling);
+		int objects_count = static_cast<int>(demo_objects_count);
+		if (ImGui::SliderInt("Demo objects", &objects_count, 0, 5000)) {
+			demo_objects_count = static_cast<size_t>(objects_count);
+		}
+		ImGui::Checkbox("GPU driven demo objects", &use_gpu_driven);
+		const char* pacing_names[] = { "VSync", "Adaptive VSync", "Uncapped", "Fixed rate" };
+		int pacing = static_cast<int>(frame_pacing);
+		if (ImGui::Combo("Frame pacing", &pacing, pacing_names, IM_ARRAYSIZE(pacing_names))) {
+			frame_pacing = static_cast<SimpleEngine::FramePacing>(pacing);
+		}
+		if (frame_pacing == SimpleEngine::FramePacing::FixedRate) {
+			ImGui::SliderFloat("Frame rate limit", &frame_rate_limit, 10.f, 240.f, "%.0f FPS");
+		}
+
+		ImGui::Separator();
+		ImGui::Text("Frame time: %.3f ms (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		ImGui::Text("CPU frame: %.3f ms, render thread: %.3f ms", frame_cpu_time_ms, frame_render_time_ms);
+		ImGui::Text("Input to present latency: %.3f ms", frame_latency_ms);
+		ImGui::Text("Draw calls: %zu", frame_draw_calls);
+		ImGui::Text("Triangles: %zu", frame_triangles);
+		ImGui::Text("Lights: %zu, cluster assignment: %.3f ms", frame_lights, frame_light_culling_ms);
+		ImGui::Text("Shadow cascades: %.3f %.3f %.3f %.3f ms, static redraws: %zu",
+			frame_shadow_cascade_ms[0], frame_shadow_cascade_ms[1], frame_shadow_cascade_ms[2], frame_shadow_cascade_ms[3],
+			frame_shadow_static_redraws);
+		ImGui::Text("Culling: %zu tested, %zu outside frustum, %zu occluded (%.1f%%), %.3f ms",
+			frame_culling_tested, frame_frustum_culled, frame_occlusion_culled,
+			frame_culling_tested > 0 ? 100.f * (frame_frustum_culled + frame_occlusion_culled) / frame_culling_tested : 0.f,
+			frame_occlusion_ms);
+		ImGui::Text("GPU culling: %zu instances, %zu visible, %.3f ms",
+			frame_gpu_instances, frame_gpu_visible_instances, frame_gpu_cull_ms);
+		ImGui::Text("Fragment shader invocations: pre-pass %llu, color %llu",
+			static_cast<unsigned long long>(frame_prepass_fragments), static_cast<unsigned long long>(frame_color_fragments));
+
+		ImGui::End();
+
+		draw_input_latency_overlay();
+		draw_frame_pacing_overlay();
+		draw_memory_overlay();
+		draw_gpu_memory_overlay();
+		draw_assets_overlay();
+		draw_world_streaming_overlay();
+	}
+
+	// engine allocators, live and peak bytes per subsystem
+	void draw_memory_overlay()
+	{
+		ImGui::Begin("Memory");
+		for (size_t i = 0; i < s_memory_tags_count; ++i) {
+			ImGui::Text("%-10s %9.1f KB live, %9.1f KB peak, %zu allocations, %llu total",
+				memory_tag_names[i] != nullptr ? memory_tag_names[i] : "",
+				memory_live_bytes[i] / 1024.f, memory_peak_bytes[i] / 1024.f, memory_live_allocations[i],
+				static_cast<unsigned long long>(memory_total_allocations[i]));
+		}
+		ImGui::Separator();
+		ImGui::Text("Frame arena: %.1f of %.1f KB", frame_arena_used / 1024.f, frame_arena_capacity / 1024.f);
+		ImGui::Text("ECS chunks: %zu in %zu pages", ecs_chunks, ecs_chunk_pages);
+		ImGui::Text("Heap calls: %llu last frame, %llu in checked frames",
+			static_cast<unsigned long long>(frame_heap_allocations), static_cast<unsigned long long>(zero_alloc_violations));
+		ImGui::End();
+	}
 
+	// buffers and textures by category and owner, budget evicts what wasn't drawn recently
+	void draw_gpu_memory_overlay()
+	{
+		ImGui::Begin("GPU memory");
+		ImGui::Text("Engine: %.1f MB", gpu_memory_total_bytes / (1024.f * 1024.f));
+		if (!gpu_memory_driver_info) {
+			ImGui::Text("Driver: no GL_NVX_gpu_memory_info or GL_ATI_meminfo");
+		}
+		else if (gpu_memory_driver_total_bytes > 0) {
+			ImGui::Text("Driver: %.1f of %.1f MB free, %.1f MB evicted",
+				gpu_memory_driver_free_bytes / (1024.f * 1024.f), gpu_memory_driver_total_bytes / (1024.f * 1024.f),
+				gpu_memory_driver_evicted_bytes / (1024.f * 1024.f));
+		}
+		else {
+			ImGui::Text("Driver: %.1f MB free for textures", gpu_memory_driver_free_bytes / (1024.f * 1024.f));
+		}
+		ImGui::SliderInt("Budget MB (0 - none)", &gpu_memory_budget_mb, 0, 4096);
+		ImGui::Text("Evictable: %zu resident of %zu, %llu evictions",
+			gpu_memory_resident, gpu_memory_evictables, static_cast<unsigned long long>(gpu_memory_evictions));
+		ImGui::Separator();
+		for (size_t i = 0; i < s_gpu_memory_categories_count; ++i) {
+			ImGui::Text("%-10s %9.1f KB, %9.1f KB peak, %zu allocations",
+				gpu_memory_category_names[i] != nullptr ? gpu_memory_category_names[i] : "",
+				gpu_memory_category_bytes[i] / 1024.f, gpu_memory_category_peak_bytes[i] / 1024.f,
+				gpu_memory_category_allocations[i]);
+		}
+		ImGui::Separator();
+		for (size_t i = 0; i < gpu_memory_owners_count; ++i) {
+			ImGui::Text("%-20s %9.1f KB", gpu_memory_owner_names[i], gpu_memory_owner_bytes[i] / 1024.f);
+		}
+		ImGui::End();
+	}
+
+	// every file is loaded once, hits are loads which got an asset already in memory
+	void draw_assets_overlay()
+	{
+		ImGui::Begin("Assets");
+		for (size_t i = 0; i < s_asset_types_count; ++i) {
+			ImGui::Text("%-9s %zu ready, %zu loading, %zu failed, %zu unused, %llu hits",
+				asset_type_names[i] != nullptr ? asset_type_names[i] : "",
+				asset_ready[i], asset_loading[i], asset_failed[i], asset_unused[i],
+				static_cast<unsigned long long>(asset_hits[i]));
+			if (asset_bytes[i] > 0 || asset_saved_bytes[i] > 0) {
+				ImGui::Text("          %.1f KB, %.1f KB saved by hits", asset_bytes[i] / 1024.f, asset_saved_bytes[i] / 1024.f);
+			}
+		}
+		ImGui::Separator();
+		ImGui::SliderInt("Upload KB per frame (0 - none)", &upload_budget_kb, 0, 65536);
+		ImGui::SliderFloat("Upload ms per frame (0 - none)", &upload_budget_ms, 0.f, 16.f);
+		ImGui::Text("Uploads: %zu, %.1f KB, %.2f ms last frame, %llu frames deferred",
+			upload_frame_count, upload_frame_bytes / 1024.f, upload_frame_ms,
+			static_cast<unsigned long long>(upload_deferred_frames));
+		ImGui::Text("Queued: %zu, %.1f KB, %.1f KB peak",
+			upload_queued, upload_queued_bytes / 1024.f, upload_peak_queued_bytes / 1024.f);
+		ImGui::End();
+	}
+
+	// cells around camera are streamed in and evicted, latency is from request of cell to its entities
+	void draw_world_streaming_overlay()
+	{
+		ImGui::Begin("World streaming");
+		if (!world_streaming) {
+			ImGui::Text("No world, SIMPLE_ENGINE_WORLD names one");
+			ImGui::End();
+			return;
+		}
+		ImGui::SliderFloat("Load radius", &world_load_radius, 0.f, 512.f);
+		ImGui::SliderFloat("Unload radius", &world_unload_radius, 0.f, 512.f);
+		ImGui::SliderInt("Cells loading at once", &world_max_loading_cells, 1, 32);
+		ImGui::Text("Cells: %zu loaded (%zu peak), %zu loading of %zu, %zu entities",
+			world_loaded_cells, world_peak_loaded_cells, world_loading_cells, world_cells, world_entities);
+		ImGui::Text("Stream ins %llu, evictions %llu",
+			static_cast<unsigned long long>(world_stream_ins), static_cast<unsigned long long>(world_evictions));
+		ImGui::Text("Stream in: %.1f ms last, %.1f ms average, %.1f ms max",
+			world_stream_in_last_ms, world_stream_in_average_ms, world_stream_in_max_ms);
+		ImGui::Text("Peak GPU memory: %.1f MB", world_peak_gpu_bytes / (1024.f * 1024.f));
+		ImGui::End();
+	}
+
+	// swap to swap intervals, a flat line is smooth, spikes are stutter
+	void draw_frame_pacing_overlay()
+	{
+		ImGui::Begin("Frame pacing");
+		ImGui::Text("Swap interval %d, limiter wait %.2f ms, missed %zu",
+			frame_swap_interval, frame_limiter_wait_ms, frame_limiter_missed);
+		ImGui::Text("%zu frames, mean %.2f ms, stddev %.3f ms, p99 %.2f ms, max %.2f ms",
+			frame_interval_samples, frame_interval_mean_ms, frame_interval_stddev_ms, frame_interval_p99_ms, frame_interval_max_ms);
+		if (frame_interval_samples > 0) {
+			ImGui::PlotLines("##frame_intervals", frame_interval_history, static_cast<int>(frame_interval_samples),
+				0, "per frame", 0.f, frame_interval_max_ms, ImVec2(0, 60));
+		}
+		ImGui::End();
+	}
+
+	// distribution of input event to swap latency of the last frames with input
+	void draw_input_latency_overlay()
+	{
+		ImGui::Begin("Input latency");
+		ImGui::Text("%zu samples, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms",
+			input_latency_samples, input_latency_p50_ms, input_latency_p95_ms, input_latency_p99_ms, input_latency_max_ms);
+		if (input_latency_samples > 0) {
+			ImGui::PlotLines("##latency_history", input_latency_history, static_cast<int>(input_latency_samples),
+				0, "per frame", 0.f, input_latency_max_ms, ImVec2(0, 60));
+
+			// 1 ms buckets up to max
+			constexpr int buckets_count = 32;
+			float buckets[buckets_count] = {};
+			for (size_t i = 0; i < input_latency_samples; ++i) {
+				const int bucket = static_cast<int>(input_latency_history[i]);
+				++buckets[bucket < buckets_count ? bucket : buckets_count - 1];
+			}
+			ImGui::PlotHistogram("##latency_histogram", buckets, buckets_count,
+				0, "0 - 31+ ms", 0.f, FLT_MAX, ImVec2(0, 80));
+		}
 		ImGui::End();
 	}
 